@@ -0,0 +1,26 @@
+# Macro which creates the 'benchmark' target. It runs the savegames in the
+# benchmark folder headless for a number of ticks, and writes a machine
+# readable report of the timings and the final state of each of them. The
+# savegames are not part of the repository; put the reference savegames in
+# the folder given by BENCHMARK_SAVES_DIR. Unlike the regression, this is not
+# part of 'ctest', as the timings depend on the machine.
+#
+# create_benchmark()
+#
+macro(create_benchmark)
+    set(BENCHMARK_SAVES_DIR "${CMAKE_SOURCE_DIR}/benchmark" CACHE PATH "Folder with the savegames run by the benchmark target")
+    set(BENCHMARK_TICKS 10000 CACHE STRING "Number of ticks each savegame is run by the benchmark target")
+
+    add_custom_target(benchmark
+            COMMAND ${CMAKE_COMMAND}
+                    -DOPENTTD_EXECUTABLE=$<TARGET_FILE:openttd>
+                    -DEDITBIN_EXECUTABLE=${EDITBIN_EXECUTABLE}
+                    -DBENCHMARK_SAVES_DIR=${BENCHMARK_SAVES_DIR}
+                    -DBENCHMARK_TICKS=${BENCHMARK_TICKS}
+                    -P "${CMAKE_SOURCE_DIR}/cmake/scripts/Benchmark.cmake"
+            DEPENDS openttd
+            WORKING_DIRECTORY ${CMAKE_BINARY_DIR}
+            COMMENT "Running benchmark"
+            USES_TERMINAL
+    )
+endmacro()
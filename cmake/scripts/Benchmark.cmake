@@ -0,0 +1,61 @@
+cmake_minimum_required(VERSION 3.5)
+
+#
+# Runs all benchmark savegames, and collects their reports
+#
+
+if(NOT OPENTTD_EXECUTABLE)
+    message(FATAL_ERROR "Script needs OPENTTD_EXECUTABLE defined (tip: use -DOPENTTD_EXECUTABLE=..)")
+endif()
+if(NOT BENCHMARK_SAVES_DIR)
+    message(FATAL_ERROR "Script needs BENCHMARK_SAVES_DIR defined (tip: use -DBENCHMARK_SAVES_DIR=..)")
+endif()
+if(NOT BENCHMARK_TICKS)
+    set(BENCHMARK_TICKS 10000)
+endif()
+
+file(GLOB BENCHMARK_SAVES ${BENCHMARK_SAVES_DIR}/*.sav)
+if(NOT BENCHMARK_SAVES)
+    message(FATAL_ERROR "No savegames found in ${BENCHMARK_SAVES_DIR} (tip: use -DBENCHMARK_SAVES_DIR=..)")
+endif()
+
+# If editbin is given, copy the executable to a new folder, and change the
+# subsystem to console, so the report can be written to the standard output.
+if(EDITBIN_EXECUTABLE)
+    execute_process(COMMAND ${CMAKE_COMMAND} -E copy ${OPENTTD_EXECUTABLE} benchmark.exe)
+    set(OPENTTD_EXECUTABLE "benchmark.exe")
+
+    execute_process(COMMAND ${EDITBIN_EXECUTABLE} /nologo /subsystem:console ${OPENTTD_EXECUTABLE})
+endif()
+
+# Use a configuration of our own, so the benchmark does not depend on the
+# configuration of the user, and does not autosave in between.
+file(MAKE_DIRECTORY benchmark)
+if(NOT EXISTS benchmark/benchmark.cfg)
+    file(WRITE benchmark/benchmark.cfg "[gui]\nautosave = off\n")
+endif()
+
+foreach(BENCHMARK_SAVE IN LISTS BENCHMARK_SAVES)
+    get_filename_component(BENCHMARK_NAME "${BENCHMARK_SAVE}" NAME_WE)
+    set(BENCHMARK_REPORT "${CMAKE_CURRENT_BINARY_DIR}/benchmark/${BENCHMARK_NAME}.txt")
+
+    execute_process(COMMAND ${OPENTTD_EXECUTABLE}
+                            -x
+                            -c benchmark/benchmark.cfg
+                            -g ${BENCHMARK_SAVE}
+                            -snull
+                            -mnull
+                            -vnull:ticks=${BENCHMARK_TICKS},benchmark=${BENCHMARK_REPORT}
+                            -Q
+                    RESULT_VARIABLE BENCHMARK_RESULT
+                    OUTPUT_QUIET
+                    ERROR_QUIET
+    )
+
+    if(NOT BENCHMARK_RESULT EQUAL 0 OR NOT EXISTS ${BENCHMARK_REPORT})
+        message(FATAL_ERROR "Benchmark of ${BENCHMARK_NAME} failed")
+    endif()
+
+    file(READ ${BENCHMARK_REPORT} BENCHMARK_OUTPUT)
+    message("${BENCHMARK_NAME}:\n${BENCHMARK_OUTPUT}")
+endforeach()
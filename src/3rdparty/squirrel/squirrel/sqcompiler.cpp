@@ -23,7 +23,7 @@
 #define DEREF_NO_DEREF	-1
 #define DEREF_FIELD		-2
 
-SQInteger _last_stacksize;
+thread_local SQInteger _last_stacksize;
 
 struct ExpState
 {
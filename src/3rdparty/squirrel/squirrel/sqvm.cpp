@@ -112,6 +112,7 @@ SQVM::SQVM(SQSharedState *ss)
 	_lasterror = _null_;
 	_errorhandler = _null_;
 	_debughook = _null_;
+	_profiler = nullptr;
 	_can_suspend = false;
 	_in_stackoverflow = false;
 	_ops_till_suspend = 0;
@@ -333,6 +334,7 @@ bool SQVM::Init(SQVM *friendvm, SQInteger stacksize)
 		_roottable = friendvm->_roottable;
 		_errorhandler = friendvm->_errorhandler;
 		_debughook = friendvm->_debughook;
+		_profiler = friendvm->_profiler;
 	}
 
 	sq_base_register(this);
@@ -405,6 +407,7 @@ bool SQVM::StartCall(SQClosure *closure,SQInteger target,SQInteger args,SQIntege
 	_stackbase = stackbase;
 	if (type(_debughook) != OT_NULL && _rawval(_debughook) != _rawval(ci->_closure))
 		CallDebugHook('c');
+	if (_profiler != nullptr) _profiler->OnCall(func);
 	return true;
 }
 
@@ -745,6 +748,7 @@ exception_restore:
 		{
 			DecreaseOps(1);
 			if (ShouldSuspend()) { _suspended = SQTrue; _suspended_traps = traps; return true; }
+			if (_profiler != nullptr) _profiler->OnInstruction(_funcproto(_closure(ci->_closure)->_function));
 
 			const SQInstruction &_i_ = *ci->_ip++;
 			//dumpstack(_stackbase);
@@ -1184,9 +1188,12 @@ bool SQVM::CallNative(SQNativeClosure *nclosure,SQInteger nargs,SQInteger stackb
 	try {
 		SQBool can_suspend = this->_can_suspend;
 		this->_can_suspend = false;
+		if (_profiler != nullptr) _profiler->OnNativeEnter(nclosure);
 		ret = (nclosure->_function)(this);
+		if (_profiler != nullptr) _profiler->OnNativeLeave(nclosure);
 		this->_can_suspend = can_suspend;
 	} catch (...) {
+		if (_profiler != nullptr) _profiler->OnNativeLeave(nclosure);
 		_nnativecalls--;
 		suspend = false;
 
@@ -27,6 +27,25 @@ struct SQExceptionTrap{
 
 typedef sqvector<SQExceptionTrap> ExceptionsTraps;
 
+/* Native profiling hook, which is much cheaper than a debug hook closure and also sees opcodes and native calls (OpenTTD addition). */
+struct SQProfiler {
+	SQFunctionProto *_current = nullptr;
+	SQUnsignedInteger *_current_ops = nullptr;
+
+	virtual ~SQProfiler() {}
+	/* Called when an instruction of a function other than _current is executed, must update _current and _current_ops. */
+	virtual void SwitchFunction(SQFunctionProto *func) = 0;
+	virtual void OnCall(SQFunctionProto *func) = 0;
+	virtual void OnNativeEnter(SQNativeClosure *closure) = 0;
+	virtual void OnNativeLeave(SQNativeClosure *closure) = 0;
+
+	inline void OnInstruction(SQFunctionProto *func)
+	{
+		if (func != _current) SwitchFunction(func);
+		(*_current_ops)++;
+	}
+};
+
 struct SQVM : public CHAINABLE_OBJ
 {
 	struct VarArgs {
@@ -145,6 +164,7 @@ public:
 	SQObjectPtr _lasterror;
 	SQObjectPtr _errorhandler;
 	SQObjectPtr _debughook;
+	SQProfiler *_profiler;
 
 	SQObjectPtr temp_reg;
 
@@ -167,6 +167,7 @@ public:
 	static bool HasAILibrary(const ContentInfo *ci, bool md5sum);
 private:
 	static uint frame_counter;                      ///< Tick counter for the AI code
+	static CompanyID next_company;                  ///< First company to run the AI of, when the previous game loop ran out of time
 	static class AIScannerInfo *scanner_info;       ///< ScriptScanner instance that is used to find AIs
 	static class AIScannerLibrary *scanner_library; ///< ScriptScanner instance that is used to find AI Libraries
 };
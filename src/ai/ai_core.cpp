@@ -23,9 +23,14 @@
 #include "ai_info.hpp"
 #include "ai.hpp"
 
+#include <chrono>
+
 #include "../safeguards.h"
 
 /* static */ uint AI::frame_counter = 0;
+/* static */ CompanyID AI::next_company = COMPANY_FIRST;
+
+uint _config_ai_tick_time_budget = 0; ///< Time in milliseconds after which no further AIs are started in a game loop, 0 for no limit.
 /* static */ AIScannerInfo *AI::scanner_info = nullptr;
 /* static */ AIScannerLibrary *AI::scanner_library = nullptr;
 
@@ -76,13 +81,28 @@
 	assert(_settings_game.difficulty.competitor_speed <= 4);
 	if ((AI::frame_counter & ((1 << (4 - _settings_game.difficulty.competitor_speed)) - 1)) != 0) return;
 
+	/* With a time budget, the AIs are run round-robin, starting with the first AI which did not get to run last time. */
+	const uint budget = _config_ai_tick_time_budget;
+	if (budget == 0) AI::next_company = COMPANY_FIRST;
+	const auto start_time = std::chrono::steady_clock::now();
+
 	Backup<CompanyID> cur_company(_current_company, FILE_LINE);
-	for (const Company *c : Company::Iterate()) {
+	bool ran_ai = false;
+	for (uint i = 0; i < MAX_COMPANIES; i++) {
+		const CompanyID cid = (CompanyID)((AI::next_company + i) % MAX_COMPANIES);
+		const Company *c = Company::GetIfValid(cid);
+		if (c == nullptr) continue;
 		if (c->is_ai) {
+			if (budget != 0 && ran_ai && std::chrono::steady_clock::now() - start_time >= std::chrono::milliseconds(budget)) {
+				/* Out of time, continue with this AI next time */
+				AI::next_company = cid;
+				break;
+			}
 			SCOPE_INFO_FMT([&], "AI::GameLoop: %i: %s (v%d)\n", (int)c->index, c->ai_info->GetName(), c->ai_info->GetVersion());
 			PerformanceMeasurer framerate((PerformanceElement)(PFE_AI0 + c->index));
 			cur_company.Change(c->index);
 			c->ai_instance->GameLoop();
+			ran_ai = true;
 		} else {
 			PerformanceMeasurer::SetInactive((PerformanceElement)(PFE_AI0 + c->index));
 		}
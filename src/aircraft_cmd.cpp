@@ -31,6 +31,7 @@
 #include "company_func.h"
 #include "effectvehicle_func.h"
 #include "station_base.h"
+#include "station_kdtree.h"
 #include "engine_base.h"
 #include "core/random_func.hpp"
 #include "core/backup_type.hpp"
@@ -122,8 +123,6 @@ enum HelicopterRotorStates {
  */
 static StationID FindNearestHangar(const Aircraft *v)
 {
-	uint best = 0;
-	StationID index = INVALID_STATION;
 	TileIndex vtile = TileVirtXYClampedToMap(v->x_pos, v->y_pos);
 	const AircraftVehicleInfo *avi = AircraftVehInfo(v->engine_type);
 	uint max_range = v->acache.cached_max_range_sqr;
@@ -142,31 +141,47 @@ static StationID FindNearestHangar(const Aircraft *v)
 		}
 	}
 
-	for (const Station *st : Station::Iterate()) {
-		if (!IsInfraUsageAllowed(VEH_AIRCRAFT, v->owner, st->owner) || !(st->facilities & FACIL_AIRPORT) || !st->airport.HasHangar()) continue;
+	auto is_suitable = [&](StationID id) -> bool {
+		const Station *st = Station::Get(id);
+		if (!IsInfraUsageAllowed(VEH_AIRCRAFT, v->owner, st->owner) || !st->airport.HasHangar()) return false;
 
 		const AirportFTAClass *afc = st->airport.GetFTA();
 
 		/* don't crash the plane if we know it can't land at the airport */
-		if ((afc->flags & AirportFTAClass::SHORT_STRIP) && (avi->subtype & AIR_FAST) && !_cheats.no_jetcrash.value) continue;
+		if ((afc->flags & AirportFTAClass::SHORT_STRIP) && (avi->subtype & AIR_FAST) && !_cheats.no_jetcrash.value) return false;
 
 		/* the plane won't land at any helicopter station */
-		if (!(afc->flags & AirportFTAClass::AIRPLANES) && (avi->subtype & AIR_CTOL)) continue;
+		if (!(afc->flags & AirportFTAClass::AIRPLANES) && (avi->subtype & AIR_CTOL)) return false;
 
 		/* Check if our last and next destinations can be reached from the depot airport. */
 		if (max_range != 0) {
 			uint last_dist = (last_dest != nullptr && last_dest->airport.tile != INVALID_TILE) ? DistanceSquare(st->airport.tile, last_dest->airport.tile) : 0;
 			uint next_dist = (next_dest != nullptr && next_dest->airport.tile != INVALID_TILE) ? DistanceSquare(st->airport.tile, next_dest->airport.tile) : 0;
-			if (last_dist > max_range || next_dist > max_range) continue;
+			if (last_dist > max_range || next_dist > max_range) return false;
 		}
 
-		/* v->tile can't be used here, when aircraft is flying v->tile is set to 0 */
-		uint distance = DistanceSquare(vtile, st->airport.tile);
-		if (distance < best || index == INVALID_STATION) {
+		return true;
+	};
+
+	/* v->tile can't be used here, when aircraft is flying v->tile is set to 0 */
+	StationID index = _airport_kdtree.FindNearestFiltered(TileX(vtile), TileY(vtile), is_suitable, INVALID_STATION);
+	if (index == INVALID_STATION) return INVALID_STATION;
+
+	/* The nearest hangar by Manhattan distance is not necessarily the nearest by straight line distance,
+	 * but any nearer one is within the square which contains the circle through that hangar. */
+	uint best = DistanceSquare(vtile, Station::Get(index)->airport.tile);
+	uint radius = IntSqrt(best);
+	uint x1 = (uint)std::max<int>(0, TileX(vtile) - radius);
+	uint x2 = std::min<uint>(TileX(vtile) + radius + 1, MapSizeX());
+	uint y1 = (uint)std::max<int>(0, TileY(vtile) - radius);
+	uint y2 = std::min<uint>(TileY(vtile) + radius + 1, MapSizeY());
+	_airport_kdtree.FindContained(x1, y1, x2, y2, [&](StationID id) {
+		uint distance = DistanceSquare(vtile, Station::Get(id)->airport.tile);
+		if ((distance < best || (distance == best && id < index)) && is_suitable(id)) {
 			best = distance;
-			index = st->index;
+			index = id;
 		}
-	}
+	});
 	return index;
 }
 
@@ -406,8 +421,6 @@ CommandCost CmdBuildAircraft(TileIndex tile, DoCommandFlag flags, const Engine *
 			u->SetNext(w);
 			w->UpdatePosition();
 		}
-
-		InvalidateVehicleTickCaches();
 	}
 
 	return CommandCost();
@@ -1922,30 +1935,18 @@ static bool AirportMove(Aircraft *v, const AirportFTAClass *apc)
 
 	v->previous_pos = v->pos; // save previous location
 
-	/* there is only one choice to move to */
-	if (current->next == nullptr) {
-		if (AirportSetBlocks(v, current, apc)) {
-			v->pos = current->next_position;
-			UpdateAircraftCache(v);
-		} // move to next position
-		return false;
+	/* choose the element to move on with, that matches our heading */
+	current = apc->GetTransition(v->pos, v->state);
+	if (current == nullptr) {
+		DEBUG(misc, 0, "[Ap] cannot move further on Airport! (pos %d state %d) for vehicle %d", v->pos, v->state, v->index);
+		NOT_REACHED();
 	}
 
-	/* there are more choices to choose from, choose the one that
-	 * matches our heading */
-	do {
-		if (v->state == current->heading || current->heading == TO_ALL) {
-			if (AirportSetBlocks(v, current, apc)) {
-				v->pos = current->next_position;
-				UpdateAircraftCache(v);
-			} // move to next position
-			return false;
-		}
-		current = current->next;
-	} while (current != nullptr);
-
-	DEBUG(misc, 0, "[Ap] cannot move further on Airport! (pos %d state %d) for vehicle %d", v->pos, v->state, v->index);
-	NOT_REACHED();
+	if (AirportSetBlocks(v, current, apc)) {
+		v->pos = current->next_position;
+		UpdateAircraftCache(v);
+	} // move to next position
+	return false;
 }
 
 /** returns true if the road ahead is busy, eg. you must wait before proceeding. */
@@ -1982,28 +1983,9 @@ static bool AirportHasBlock(Aircraft *v, const AirportFTA *current_pos, const Ai
  */
 static bool AirportSetBlocks(Aircraft *v, const AirportFTA *current_pos, const AirportFTAClass *apc)
 {
-	const AirportFTA *next = &apc->layout[current_pos->next_position];
-	const AirportFTA *reference = &apc->layout[v->pos];
-
 	/* if the next position is in another block, check it and wait until it is free */
-	if ((apc->layout[current_pos->position].block & next->block) != next->block) {
-		uint64 airport_flags = next->block;
-		/* search for all all elements in the list with the same state, and blocks != N
-		 * this means more blocks should be checked/set */
-		const AirportFTA *current = current_pos;
-		if (current == reference) current = current->next;
-		while (current != nullptr) {
-			if (current->heading == current_pos->heading && current->block != 0) {
-				airport_flags |= current->block;
-				break;
-			}
-			current = current->next;
-		}
-
-		/* if the block to be checked is in the next position, then exclude that from
-		 * checking, because it has been set by the airplane before */
-		if (current_pos->block == next->block) airport_flags ^= next->block;
-
+	uint64 airport_flags = current_pos->reserve_block;
+	if (airport_flags != 0) {
 		Station *st = Station::Get(v->targetairport);
 		if (st->airport.flags & airport_flags) {
 			v->cur_speed = 0;
@@ -2011,7 +1993,7 @@ static bool AirportSetBlocks(Aircraft *v, const AirportFTA *current_pos, const A
 			return false;
 		}
 
-		if (next->block != NOTHING_block) {
+		if (apc->layout[current_pos->next_position].block != NOTHING_block) {
 			SETBITS(st->airport.flags, airport_flags); // occupy next block
 		}
 	}
@@ -2064,20 +2046,6 @@ static bool FreeTerminal(Aircraft *v, byte i, byte last_terminal)
 	return false;
 }
 
-/**
- * Get the number of terminals at the airport.
- * @param apc Airport description.
- * @return Number of terminals.
- */
-static uint GetNumTerminals(const AirportFTAClass *apc)
-{
-	uint num = 0;
-
-	for (uint i = apc->terminals[0]; i > 0; i--) num += apc->terminals[i];
-
-	return num;
-}
-
 /**
  * Find a free terminal, and assign it if available.
  * @param v Aircraft to handle.
@@ -2128,7 +2096,7 @@ static bool AirportFindFreeTerminal(Aircraft *v, const AirportFTAClass *apc)
 	}
 
 	/* if there is only 1 terminalgroup, all terminals are checked (starting from 0 to max) */
-	return FreeTerminal(v, 0, GetNumTerminals(apc));
+	return FreeTerminal(v, 0, apc->num_terminals);
 }
 
 /**
@@ -2231,7 +2199,7 @@ static bool AircraftEventHandler(Aircraft *v, int loop)
 bool Aircraft::Tick()
 {
 	DEBUG_UPDATESTATECHECKSUM("Aircraft::Tick: v: %u, x: %d, y: %d", this->index, this->x_pos, this->y_pos);
-	UpdateStateChecksum((((uint64) this->x_pos) << 32) | this->y_pos);
+	UpdateStateChecksum((((uint64) this->x_pos) << 32) | this->y_pos, SCP_VEHICLES);
 	if (!this->IsNormalAircraft()) return true;
 
 	this->tick_counter++;
@@ -67,6 +67,8 @@ AIRPORT_GENERIC(dummy, nullptr, 0, AirportFTAClass::ALL, 0)
 
 static uint16 AirportGetNofElements(const AirportFTAbuildup *apFA);
 static AirportFTA *AirportBuildAutomata(uint nofelements, const AirportFTAbuildup *apFA);
+static uint64 AirportGetReserveBlock(const AirportFTA *layout, uint nofelements, const AirportFTA *current_pos);
+static const AirportFTA *AirportFindTransition(const AirportFTA *head, byte state);
 
 
 /**
@@ -127,6 +129,22 @@ AirportFTAClass::AirportFTAClass(
 {
 	/* Build the state machine itself */
 	this->layout = AirportBuildAutomata(this->nofelements, apFA);
+
+	/* Precompute the blocks to reserve and the element to move on with, for each position and movement state */
+	this->transitions.resize(this->nofelements * (MAX_HEADINGS + 1));
+	for (uint i = 0; i < this->nofelements; i++) {
+		for (AirportFTA *current = &this->layout[i]; current != nullptr; current = current->next) {
+			current->reserve_block = AirportGetReserveBlock(this->layout, this->nofelements, current);
+		}
+		for (uint state = 0; state <= MAX_HEADINGS; state++) {
+			this->transitions[(i * (MAX_HEADINGS + 1)) + state] = AirportFindTransition(&this->layout[i], state);
+		}
+	}
+
+	this->num_terminals = 0;
+	if (this->terminals != nullptr) {
+		for (uint i = this->terminals[0]; i > 0; i--) this->num_terminals += this->terminals[i];
+	}
 }
 
 AirportFTAClass::~AirportFTAClass()
@@ -199,6 +217,63 @@ static AirportFTA *AirportBuildAutomata(uint nofelements, const AirportFTAbuildu
 	return FAutomata;
 }
 
+/**
+ * Get the blocks an aircraft has to check and reserve when moving on from an element of the FTA.
+ * @param layout The FTA.
+ * @param nofelements The number of elements in the FTA.
+ * @param current_pos The element to move on from.
+ * @return The blocks to reserve, or 0 if the next position is in the same block.
+ */
+static uint64 AirportGetReserveBlock(const AirportFTA *layout, uint nofelements, const AirportFTA *current_pos)
+{
+	/* Terminal groups do not refer to a position */
+	if (current_pos->next_position >= nofelements) return 0;
+
+	const AirportFTA *next = &layout[current_pos->next_position];
+	const AirportFTA *reference = &layout[current_pos->position];
+
+	/* if the next position is in the same block, there is nothing to reserve */
+	if ((reference->block & next->block) == next->block) return 0;
+
+	uint64 airport_flags = next->block;
+	/* search for all all elements in the list with the same state, and blocks != N
+	 * this means more blocks should be checked/set */
+	const AirportFTA *current = current_pos;
+	if (current == reference) current = current->next;
+	while (current != nullptr) {
+		if (current->heading == current_pos->heading && current->block != 0) {
+			airport_flags |= current->block;
+			break;
+		}
+		current = current->next;
+	}
+
+	/* if the block to be checked is in the next position, then exclude that from
+	 * checking, because it has been set by the airplane before */
+	if (current_pos->block == next->block) airport_flags ^= next->block;
+
+	return airport_flags;
+}
+
+/**
+ * Find the element an aircraft moves on with from a position of the FTA.
+ * @param head The first element of the position.
+ * @param state The movement state (heading) of the aircraft.
+ * @return The element, or \c nullptr if the aircraft cannot move on.
+ */
+static const AirportFTA *AirportFindTransition(const AirportFTA *head, byte state)
+{
+	/* there is only one choice to move to */
+	if (head->next == nullptr) return head;
+
+	/* there are more choices to choose from, choose the one that
+	 * matches our heading */
+	for (const AirportFTA *current = head; current != nullptr; current = current->next) {
+		if (state == current->heading || current->heading == TO_ALL) return current;
+	}
+	return nullptr;
+}
+
 /**
  * Get the finite state machine of an airport type.
  * @param airport_type %Airport type to query FTA from. @see AirportTypes
@@ -12,6 +12,7 @@
 
 #include "direction_type.h"
 #include "tile_type.h"
+#include <vector>
 
 /** Some airport-related constants */
 static const uint MAX_TERMINALS =   8;                       ///< maximum number of terminals per airport
@@ -138,6 +139,7 @@ struct AirportMovingData {
 AirportMovingData RotateAirportMovingData(const AirportMovingData *orig, Direction rotation, uint num_tiles_x, uint num_tiles_y);
 
 struct AirportFTAbuildup;
+struct AirportFTA;
 
 /** Finite sTate mAchine (FTA) of an airport. */
 struct AirportFTAClass {
@@ -173,6 +175,18 @@ public:
 		return &moving_data[position];
 	}
 
+	/**
+	 * Get the element of the state machine an aircraft moves on with from a position.
+	 * @param position Element number the aircraft is at.
+	 * @param state Movement state (heading) of the aircraft.
+	 * @return Element to move on with, or \c nullptr if the aircraft cannot move on.
+	 */
+	const AirportFTA *GetTransition(byte position, byte state) const
+	{
+		assert(position < nofelements && state <= MAX_HEADINGS);
+		return this->transitions[(position * (MAX_HEADINGS + 1)) + state];
+	}
+
 	const AirportMovingData *moving_data; ///< Movement data.
 	struct AirportFTA *layout;            ///< state machine for airport
 	const byte *terminals;                ///< %Array with the number of terminal groups, followed by the number of terminals in each group.
@@ -181,6 +195,10 @@ public:
 	byte nofelements;                     ///< number of positions the airport consists of
 	const byte *entry_points;             ///< when an airplane arrives at this airport, enter it at position entry_point, index depends on direction
 	byte delta_z;                         ///< Z adjustment for helicopter pads
+	byte num_terminals;                   ///< Total number of terminals in all terminal groups.
+
+private:
+	std::vector<const AirportFTA *> transitions; ///< Element to move on with, for each position and movement state, see #GetTransition.
 };
 
 DECLARE_ENUM_AS_BIT_SET(AirportFTAClass::Flags)
@@ -190,6 +208,7 @@ DECLARE_ENUM_AS_BIT_SET(AirportFTAClass::Flags)
 struct AirportFTA {
 	AirportFTA *next;        ///< possible extra movement choices from this position
 	uint64 block;            ///< 64 bit blocks (st->airport.flags), should be enough for the most complex airports
+	uint64 reserve_block;    ///< blocks to check and reserve when moving on to the next position from here, 0 if there is no need to
 	byte position;           ///< the position that an airplane is at
 	byte next_position;      ///< next position from this position
 	byte heading;            ///< heading (current orders), guiding an airplane to its target on an airport
@@ -14,14 +14,41 @@
 #include "tile_cmd.h"
 #include "viewport_func.h"
 #include "framerate_type.h"
+#include "trace.h"
 #include "date_func.h"
 #include "3rdparty/cpp-btree/btree_map.h"
+#include "3rdparty/cpp-btree/btree_set.h"
+
+#include <algorithm>
+#include <vector>
 
 #include "safeguards.h"
 
 /** The table/list with animated tiles. */
 btree::btree_map<TileIndex, AnimatedTileInfo> _animated_tiles;
 
+/**
+ * Number of buckets of #_animated_tile_buckets.
+ * A tile with speed s animates every 2^s ticks, so speeds above 32 never animate and share the last bucket.
+ */
+static const uint ANIMATED_TILE_BUCKET_COUNT = 34;
+
+/** The animated tiles by animation speed, each tile of #_animated_tiles is in the bucket of its speed. */
+static btree::btree_set<TileIndex> _animated_tile_buckets[ANIMATED_TILE_BUCKET_COUNT];
+
+/** The animated tiles which are due in the current tick. */
+static std::vector<TileIndex> _animated_tiles_due;
+
+/**
+ * Get the bucket of animated tiles with the given animation speed.
+ * @param speed the animation speed
+ * @return the bucket
+ */
+static btree::btree_set<TileIndex> &GetAnimatedTileBucket(uint8 speed)
+{
+	return _animated_tile_buckets[std::min<uint>(speed, ANIMATED_TILE_BUCKET_COUNT - 1)];
+}
+
 /**
  * Removes the given tile from the animated tile table.
  * @param tile the tile to remove
@@ -73,9 +100,19 @@ static void UpdateAnimatedTileSpeed(TileIndex tile, AnimatedTileInfo &info)
 void AddAnimatedTile(TileIndex tile)
 {
 	MarkTileDirtyByTile(tile, VMDF_NOT_MAP_MODE);
-	AnimatedTileInfo &info = _animated_tiles[tile];
+	auto result = _animated_tiles.insert({ tile, {} });
+	AnimatedTileInfo &info = result.first->second;
+	const uint8 old_speed = info.speed;
 	UpdateAnimatedTileSpeed(tile, info);
 	info.pending_deletion = false;
+
+	btree::btree_set<TileIndex> &bucket = GetAnimatedTileBucket(info.speed);
+	if (result.second) {
+		bucket.insert(tile);
+	} else if (&bucket != &GetAnimatedTileBucket(old_speed)) {
+		GetAnimatedTileBucket(old_speed).erase(tile);
+		bucket.insert(tile);
+	}
 }
 
 int GetAnimatedTileSpeed(TileIndex tile)
@@ -92,6 +129,8 @@ int GetAnimatedTileSpeed(TileIndex tile)
  */
 void AnimateAnimatedTiles()
 {
+	TRACE_ZONE("AnimateAnimatedTiles");
+
 	extern void AnimateTile_Town(TileIndex tile);
 	extern void AnimateTile_Station(TileIndex tile);
 	extern void AnimateTile_Industry(TileIndex tile);
@@ -102,15 +141,26 @@ void AnimateAnimatedTiles()
 	const uint32 ticks = (uint) _scaled_tick_counter;
 	const uint8 max_speed = (ticks == 0) ? 32 : FindFirstBit(ticks);
 
-	auto iter = _animated_tiles.begin();
-	while (iter != _animated_tiles.end()) {
+	/* Only the buckets of the speeds which are due this tick need to be looked at.
+	 * Copy the tiles first, as animating a tile may add or change other animated tiles. */
+	_animated_tiles_due.clear();
+	for (uint speed = 0; speed <= max_speed; speed++) {
+		const btree::btree_set<TileIndex> &bucket = _animated_tile_buckets[speed];
+		_animated_tiles_due.insert(_animated_tiles_due.end(), bucket.begin(), bucket.end());
+	}
+	std::sort(_animated_tiles_due.begin(), _animated_tiles_due.end());
+
+	for (const TileIndex curr : _animated_tiles_due) {
+		auto iter = _animated_tiles.find(curr);
+		if (iter == _animated_tiles.end()) continue;
+
 		if (iter->second.pending_deletion) {
-			iter = _animated_tiles.erase(iter);
+			GetAnimatedTileBucket(iter->second.speed).erase(curr);
+			_animated_tiles.erase(iter);
 			continue;
 		}
 
 		if (iter->second.speed <= max_speed) {
-			const TileIndex curr = iter->first;
 			switch (GetTileType(curr)) {
 				case MP_HOUSE:
 					AnimateTile_Town(curr);
@@ -132,7 +182,17 @@ void AnimateAnimatedTiles()
 					NOT_REACHED();
 			}
 		}
-		++iter;
+	}
+}
+
+/**
+ * Rebuild the buckets of animated tiles by speed, after the animated tile table was loaded.
+ */
+void RebuildAnimatedTileBuckets()
+{
+	for (btree::btree_set<TileIndex> &bucket : _animated_tile_buckets) bucket.clear();
+	for (const auto &it : _animated_tiles) {
+		GetAnimatedTileBucket(it.second.speed).insert(it.first);
 	}
 }
 
@@ -147,6 +207,7 @@ void UpdateAllAnimatedTileSpeeds()
 		UpdateAnimatedTileSpeed(iter->first, iter->second);
 		++iter;
 	}
+	RebuildAnimatedTileBuckets();
 }
 
 /**
@@ -155,4 +216,5 @@ void UpdateAllAnimatedTileSpeeds()
 void InitializeAnimatedTiles()
 {
 	_animated_tiles.clear();
+	for (btree::btree_set<TileIndex> &bucket : _animated_tile_buckets) bucket.clear();
 }
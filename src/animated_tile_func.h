@@ -16,6 +16,7 @@ void AddAnimatedTile(TileIndex tile);
 void DeleteAnimatedTile(TileIndex tile);
 void AnimateAnimatedTiles();
 void UpdateAllAnimatedTileSpeeds();
+void RebuildAnimatedTileBuckets();
 void InitializeAnimatedTiles();
 
 #endif /* ANIMATED_TILE_FUNC_H */
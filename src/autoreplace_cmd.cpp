@@ -785,19 +785,32 @@ CommandCost CmdAutoreplaceVehicle(TileIndex tile, DoCommandFlag flags, uint32 p1
 
 		assert(free_wagon || v->IsStoppedInDepot());
 
-		/* We have to construct the new vehicle chain to test whether it is valid.
-		 * Vehicle construction needs random bits, so we have to save the random seeds
-		 * to prevent desyncs and to replay newgrf callbacks during DC_EXEC */
-		SavedRandomSeeds saved_seeds;
-		SaveRandomSeeds(&saved_seeds);
-		if (free_wagon) {
-			cost.AddCost(ReplaceFreeUnit(&v, flags & ~DC_EXEC, &nothing_to_do, same_type_only));
+		/* When executing a top-level command, the test run of this command immediately before has already
+		 * constructed the new vehicle chain with the same random seeds, and it succeeded. */
+		const bool already_tested = (flags & DC_EXEC) != 0 && IsTopLevelCommand();
+
+		if (already_tested) {
+			if (free_wagon) {
+				cost.AddCost(ReplaceFreeUnit(&v, flags, &nothing_to_do, same_type_only));
+			} else {
+				cost.AddCost(ReplaceChain(&v, flags, wagon_removal, &nothing_to_do, same_type_only));
+			}
+			assert(cost.Succeeded());
 		} else {
-			cost.AddCost(ReplaceChain(&v, flags & ~DC_EXEC, wagon_removal, &nothing_to_do, same_type_only));
+			/* We have to construct the new vehicle chain to test whether it is valid.
+			 * Vehicle construction needs random bits, so we have to save the random seeds
+			 * to prevent desyncs and to replay newgrf callbacks during DC_EXEC */
+			SavedRandomSeeds saved_seeds;
+			SaveRandomSeeds(&saved_seeds);
+			if (free_wagon) {
+				cost.AddCost(ReplaceFreeUnit(&v, flags & ~DC_EXEC, &nothing_to_do, same_type_only));
+			} else {
+				cost.AddCost(ReplaceChain(&v, flags & ~DC_EXEC, wagon_removal, &nothing_to_do, same_type_only));
+			}
+			RestoreRandomSeeds(saved_seeds);
 		}
-		RestoreRandomSeeds(saved_seeds);
 
-		if (cost.Succeeded() && (flags & DC_EXEC) != 0) {
+		if (!already_tested && cost.Succeeded() && (flags & DC_EXEC) != 0) {
 			CommandCost ret;
 			if (free_wagon) {
 				ret = ReplaceFreeUnit(&v, flags, &nothing_to_do, same_type_only);
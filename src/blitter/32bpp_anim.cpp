@@ -643,23 +643,41 @@ void Blitter_32bppAnim::PaletteAnimate(const Palette &palette)
 	const int width = this->anim_buf_width;
 	const int pitch_offset = _screen.pitch - width;
 	const int anim_pitch_offset = this->anim_buf_pitch - width;
-	for (int y = this->anim_buf_height; y != 0 ; y--) {
-		for (int x = width; x != 0 ; x--) {
+
+	/* Bounding box of the updated pixels, only that needs to be redrawn by the backend. */
+	int dirty_left = width;
+	int dirty_right = 0;
+	int dirty_top = this->anim_buf_height;
+	int dirty_bottom = 0;
+
+	for (int y = 0; y < this->anim_buf_height; y++) {
+		int row_left = -1;
+		int row_right = -1;
+		for (int x = 0; x < width; x++) {
 			uint16 value = *anim;
 			uint8 colour = GB(value, 0, 8);
 			if (colour >= PALETTE_ANIM_START) {
 				/* Update this pixel */
 				*dst = this->AdjustBrightness(LookupColourInPalette(colour), GB(value, 8, 8));
+				if (row_left < 0) row_left = x;
+				row_right = x;
 			}
 			dst++;
 			anim++;
 		}
+		if (row_left >= 0) {
+			dirty_left = std::min(dirty_left, row_left);
+			dirty_right = std::max(dirty_right, row_right + 1);
+			dirty_top = std::min(dirty_top, y);
+			dirty_bottom = y + 1;
+		}
 		dst += pitch_offset;
 		anim += anim_pitch_offset;
 	}
 
-	/* Make sure the backend redraws the whole screen */
-	VideoDriver::GetInstance()->MakeDirty(0, 0, _screen.width, _screen.height);
+	if (dirty_left < dirty_right) {
+		VideoDriver::GetInstance()->MakeDirty(dirty_left, dirty_top, dirty_right - dirty_left, dirty_bottom - dirty_top);
+	}
 }
 
 Blitter::PaletteAnimation Blitter_32bppAnim::UsePaletteAnimation()
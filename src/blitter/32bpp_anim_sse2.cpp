@@ -33,7 +33,11 @@ void Blitter_32bppSSE2_Anim::PaletteAnimate(const Palette &palette)
 	const uint16 *anim = this->anim_buf;
 	Colour *dst = (Colour *)_screen.dst_ptr;
 
-	bool screen_dirty = false;
+	/* Bounding box of the updated pixels, in blocks of 8 pixels horizontally, only that needs to be redrawn by the backend. */
+	int dirty_left = INT_MAX;
+	int dirty_right = 0;
+	int dirty_top = INT_MAX;
+	int dirty_bottom = 0;
 
 	/* Let's walk the anim buffer and try to find the pixels */
 	const int width = this->anim_buf_width;
@@ -42,9 +46,10 @@ void Blitter_32bppSSE2_Anim::PaletteAnimate(const Palette &palette)
 	__m128i anim_cmp = _mm_set1_epi16(PALETTE_ANIM_START - 1);
 	__m128i brightness_cmp = _mm_set1_epi16(Blitter_32bppBase::DEFAULT_BRIGHTNESS);
 	__m128i colour_mask = _mm_set1_epi16(0xFF);
-	for (int y = this->anim_buf_height; y != 0 ; y--) {
+	for (int y = 0; y < this->anim_buf_height; y++) {
 		Colour *next_dst_ln = dst + screen_pitch;
 		const uint16 *next_anim_ln = anim + anim_pitch;
+		bool row_dirty = false;
 		int x = width;
 		while (x > 0) {
 			__m128i data = _mm_load_si128((const __m128i *) anim);
@@ -65,7 +70,7 @@ void Blitter_32bppSSE2_Anim::PaletteAnimate(const Palette &palette)
 						if (colour >= PALETTE_ANIM_START) {
 							/* Update this pixel */
 							*dst = AdjustBrightneSSE(LookupColourInPalette(colour), GB(value, 8, 8));
-							screen_dirty = true;
+							row_dirty = true;
 						}
 						data = _mm_srli_si128(data, 2);
 						dst++;
@@ -77,7 +82,11 @@ void Blitter_32bppSSE2_Anim::PaletteAnimate(const Palette &palette)
 						colour_data = _mm_srli_si128(colour_data, 2);
 						dst++;
 					}
-					screen_dirty = true;
+					row_dirty = true;
+				}
+				if (row_dirty) {
+					dirty_left = std::min(dirty_left, width - x);
+					dirty_right = std::max(dirty_right, std::min(width, width - x + 8));
 				}
 			} else {
 				/* fast path, no animation */
@@ -86,13 +95,16 @@ void Blitter_32bppSSE2_Anim::PaletteAnimate(const Palette &palette)
 			anim += 8;
 			x -= 8;
 		}
+		if (row_dirty) {
+			dirty_top = std::min(dirty_top, y);
+			dirty_bottom = y + 1;
+		}
 		dst = next_dst_ln;
 		anim = next_anim_ln;
 	}
 
-	if (screen_dirty) {
-		/* Make sure the backend redraws the whole screen */
-		VideoDriver::GetInstance()->MakeDirty(0, 0, _screen.width, _screen.height);
+	if (dirty_left < dirty_right) {
+		VideoDriver::GetInstance()->MakeDirty(dirty_left, dirty_top, dirty_right - dirty_left, dirty_bottom - dirty_top);
 	}
 }
 
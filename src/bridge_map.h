@@ -43,7 +43,7 @@ static inline bool IsBridgeTile(TileIndex t)
  */
 static inline bool IsBridgeAbove(TileIndex t)
 {
-	return GB(_m[t].type, 2, 2) != 0;
+	return GB(_mth[t].type, 2, 2) != 0;
 }
 
 /**
@@ -67,7 +67,7 @@ static inline BridgeType GetBridgeType(TileIndex t)
 static inline Axis GetBridgeAxis(TileIndex t)
 {
 	assert_tile(IsBridgeAbove(t), t);
-	return (Axis)(GB(_m[t].type, 2, 2) - 1);
+	return (Axis)(GB(_mth[t].type, 2, 2) - 1);
 }
 
 TileIndex GetNorthernBridgeEnd(TileIndex t);
@@ -92,7 +92,7 @@ static inline int GetBridgePixelHeight(TileIndex tile)
  */
 static inline void ClearSingleBridgeMiddle(TileIndex t, Axis a)
 {
-	ClrBit(_m[t].type, 2 + a);
+	ClrBit(_mth[t].type, 2 + a);
 }
 
 /**
@@ -112,7 +112,7 @@ static inline void ClearBridgeMiddle(TileIndex t)
  */
 static inline void SetBridgeMiddle(TileIndex t, Axis a)
 {
-	SetBit(_m[t].type, 2 + a);
+	SetBit(_mth[t].type, 2 + a);
 }
 
 /**
@@ -379,6 +379,7 @@ static inline void SetBridgeReservationTrackBits(TileIndex t, TrackBits b)
 	Track track = RemoveFirstTrack(&b);
 	SB(_m[t].m2, 0, 3, track == INVALID_TRACK ? 0 : track + 1);
 	SB(_m[t].m2, 3, 1, (byte)(b != TRACK_BIT_NONE));
+	_rail_state_generation++;
 }
 
 
@@ -37,6 +37,8 @@
 
 #include "table/strings.h"
 
+#include <unordered_map>
+
 #include "safeguards.h"
 
 /**
@@ -241,8 +243,79 @@ static bool EngineVehicleCountSorter(const EngineID &a, const EngineID &b)
 	return _engine_sort_direction ? r > 0 : r < 0;
 }
 
-/* cached values for EngineNameSorter to spare many GetString() calls */
-static EngineID _last_engine[2] = { INVALID_ENGINE, INVALID_ENGINE };
+/* Sort keys which are expensive to compute, such as through NewGRF callbacks, cached for the duration of a single sort of an engine list.
+ * These are unordered maps as references to the keys must stay valid while other keys are inserted. */
+static std::unordered_map<EngineID, std::string> _engine_sort_name;
+static std::unordered_map<EngineID, Money> _engine_sort_cost;
+static std::unordered_map<EngineID, Money> _engine_sort_running_cost;
+static std::unordered_map<EngineID, uint> _engine_sort_power;
+static std::unordered_map<EngineID, uint> _engine_sort_articulated_capacity;
+static std::unordered_map<EngineID, std::pair<uint, uint16>> _engine_sort_default_capacity; ///< Default capacity and mail capacity.
+
+/**
+ * Get a sort key of an engine, computing it only the first time during a sort.
+ * @param cache The cached keys of the sort key type.
+ * @param engine The engine.
+ * @param compute Function computing the key of the engine.
+ * @return The sort key.
+ */
+template <typename T, typename F>
+static const T &GetEngineSortKey(std::unordered_map<EngineID, T> &cache, EngineID engine, F compute)
+{
+	auto res = cache.insert({ engine, T() });
+	if (res.second) res.first->second = compute(Engine::Get(engine));
+	return res.first->second;
+}
+
+/** Forget the cached sort keys of engines, as names, costs and callback results could change before the next sort. */
+void InvalidateEngineSortKeys()
+{
+	_engine_sort_name.clear();
+	_engine_sort_cost.clear();
+	_engine_sort_running_cost.clear();
+	_engine_sort_power.clear();
+	_engine_sort_articulated_capacity.clear();
+	_engine_sort_default_capacity.clear();
+}
+
+static const std::string &GetEngineSortName(EngineID engine)
+{
+	return GetEngineSortKey(_engine_sort_name, engine, [](const Engine *e) -> std::string {
+		SetDParam(0, e->index);
+		return GetString(STR_ENGINE_NAME);
+	});
+}
+
+static Money GetEngineSortCost(EngineID engine)
+{
+	return GetEngineSortKey(_engine_sort_cost, engine, [](const Engine *e) { return e->GetCost(); });
+}
+
+static Money GetEngineSortRunningCost(EngineID engine)
+{
+	return GetEngineSortKey(_engine_sort_running_cost, engine, [](const Engine *e) { return e->GetRunningCost(); });
+}
+
+static uint GetEngineSortPower(EngineID engine)
+{
+	return GetEngineSortKey(_engine_sort_power, engine, [](const Engine *e) { return e->GetPower(); });
+}
+
+static uint GetEngineSortArticulatedCapacity(EngineID engine)
+{
+	return GetEngineSortKey(_engine_sort_articulated_capacity, engine, [](const Engine *e) { return GetTotalCapacityOfArticulatedParts(e->index); });
+}
+
+static uint GetEngineSortDefaultCapacity(EngineID engine, uint16 *mail_capacity = nullptr)
+{
+	const std::pair<uint, uint16> &capacity = GetEngineSortKey(_engine_sort_default_capacity, engine, [](const Engine *e) {
+		uint16 mail = 0;
+		uint capacity = e->GetDisplayDefaultCapacity(&mail);
+		return std::pair<uint, uint16>(capacity, mail);
+	});
+	if (mail_capacity != nullptr) *mail_capacity = capacity.second;
+	return capacity.first;
+}
 
 /**
  * Determines order of engines by name
@@ -252,21 +325,7 @@ static EngineID _last_engine[2] = { INVALID_ENGINE, INVALID_ENGINE };
  */
 static bool EngineNameSorter(const EngineID &a, const EngineID &b)
 {
-	static char     last_name[2][64] = { "", "" };
-
-	if (a != _last_engine[0]) {
-		_last_engine[0] = a;
-		SetDParam(0, a);
-		GetString(last_name[0], STR_ENGINE_NAME, lastof(last_name[0]));
-	}
-
-	if (b != _last_engine[1]) {
-		_last_engine[1] = b;
-		SetDParam(0, b);
-		GetString(last_name[1], STR_ENGINE_NAME, lastof(last_name[1]));
-	}
-
-	int r = strnatcmp(last_name[0], last_name[1]); // Sort by name (natural sorting).
+	int r = strnatcmp(GetEngineSortName(a).c_str(), GetEngineSortName(b).c_str()); // Sort by name (natural sorting).
 
 	/* Use EngineID to sort instead since we want consistent sorting */
 	if (r == 0) return EngineNumberSorter(a, b);
@@ -298,8 +357,8 @@ static bool EngineReliabilitySorter(const EngineID &a, const EngineID &b)
  */
 static bool EngineCostSorter(const EngineID &a, const EngineID &b)
 {
-	Money va = Engine::Get(a)->GetCost();
-	Money vb = Engine::Get(b)->GetCost();
+	Money va = GetEngineSortCost(a);
+	Money vb = GetEngineSortCost(b);
 	int r = ClampToI32(va - vb);
 
 	/* Use EngineID to sort instead since we want consistent sorting */
@@ -332,8 +391,8 @@ static bool EngineSpeedSorter(const EngineID &a, const EngineID &b)
  */
 static bool EnginePowerSorter(const EngineID &a, const EngineID &b)
 {
-	int va = Engine::Get(a)->GetPower();
-	int vb = Engine::Get(b)->GetPower();
+	int va = GetEngineSortPower(a);
+	int vb = GetEngineSortPower(b);
 	int r = va - vb;
 
 	/* Use EngineID to sort instead since we want consistent sorting */
@@ -366,8 +425,8 @@ static bool EngineTractiveEffortSorter(const EngineID &a, const EngineID &b)
  */
 static bool EngineRunningCostSorter(const EngineID &a, const EngineID &b)
 {
-	Money va = Engine::Get(a)->GetRunningCost();
-	Money vb = Engine::Get(b)->GetRunningCost();
+	Money va = GetEngineSortRunningCost(a);
+	Money vb = GetEngineSortRunningCost(b);
 	int r = ClampToI32(va - vb);
 
 	/* Use EngineID to sort instead since we want consistent sorting */
@@ -377,10 +436,8 @@ static bool EngineRunningCostSorter(const EngineID &a, const EngineID &b)
 
 static bool GenericEngineValueVsRunningCostSorter(const EngineID &a, const uint value_a, const EngineID &b, const uint value_b)
 {
-	const Engine *e_a = Engine::Get(a);
-	const Engine *e_b = Engine::Get(b);
-	Money r_a = e_a->GetRunningCost();
-	Money r_b = e_b->GetRunningCost();
+	Money r_a = GetEngineSortRunningCost(a);
+	Money r_b = GetEngineSortRunningCost(b);
 	/* Check if running cost is zero in one or both engines.
 	 * If only one of them is zero then that one has higher value,
 	 * else if both have zero cost then compare powers. */
@@ -415,7 +472,7 @@ static bool GenericEngineValueVsRunningCostSorter(const EngineID &a, const uint
  */
 static bool EnginePowerVsRunningCostSorter(const EngineID &a, const EngineID &b)
 {
-	return GenericEngineValueVsRunningCostSorter(a, Engine::Get(a)->GetPower(), b, Engine::Get(b)->GetPower());
+	return GenericEngineValueVsRunningCostSorter(a, GetEngineSortPower(a), b, GetEngineSortPower(b));
 }
 
 /* Train sorting functions */
@@ -431,8 +488,8 @@ static bool TrainEngineCapacitySorter(const EngineID &a, const EngineID &b)
 	const RailVehicleInfo *rvi_a = RailVehInfo(a);
 	const RailVehicleInfo *rvi_b = RailVehInfo(b);
 
-	int va = GetTotalCapacityOfArticulatedParts(a) * (rvi_a->railveh_type == RAILVEH_MULTIHEAD ? 2 : 1);
-	int vb = GetTotalCapacityOfArticulatedParts(b) * (rvi_b->railveh_type == RAILVEH_MULTIHEAD ? 2 : 1);
+	int va = GetEngineSortArticulatedCapacity(a) * (rvi_a->railveh_type == RAILVEH_MULTIHEAD ? 2 : 1);
+	int vb = GetEngineSortArticulatedCapacity(b) * (rvi_b->railveh_type == RAILVEH_MULTIHEAD ? 2 : 1);
 	int r = va - vb;
 
 	/* Use EngineID to sort instead since we want consistent sorting */
@@ -451,8 +508,8 @@ static bool TrainEngineCapacityVsRunningCostSorter(const EngineID &a, const Engi
 	const RailVehicleInfo *rvi_a = RailVehInfo(a);
 	const RailVehicleInfo *rvi_b = RailVehInfo(b);
 
-	uint va = GetTotalCapacityOfArticulatedParts(a) * (rvi_a->railveh_type == RAILVEH_MULTIHEAD ? 2 : 1);
-	uint vb = GetTotalCapacityOfArticulatedParts(b) * (rvi_b->railveh_type == RAILVEH_MULTIHEAD ? 2 : 1);
+	uint va = GetEngineSortArticulatedCapacity(a) * (rvi_a->railveh_type == RAILVEH_MULTIHEAD ? 2 : 1);
+	uint vb = GetEngineSortArticulatedCapacity(b) * (rvi_b->railveh_type == RAILVEH_MULTIHEAD ? 2 : 1);
 
 	return GenericEngineValueVsRunningCostSorter(a, va, b, vb);
 }
@@ -484,8 +541,8 @@ static bool TrainEnginesThenWagonsSorter(const EngineID &a, const EngineID &b)
  */
 static bool RoadVehEngineCapacitySorter(const EngineID &a, const EngineID &b)
 {
-	int va = GetTotalCapacityOfArticulatedParts(a);
-	int vb = GetTotalCapacityOfArticulatedParts(b);
+	int va = GetEngineSortArticulatedCapacity(a);
+	int vb = GetEngineSortArticulatedCapacity(b);
 	int r = va - vb;
 
 	/* Use EngineID to sort instead since we want consistent sorting */
@@ -501,7 +558,7 @@ static bool RoadVehEngineCapacitySorter(const EngineID &a, const EngineID &b)
  */
 static bool RoadVehEngineCapacityVsRunningCostSorter(const EngineID &a, const EngineID &b)
 {
-	return GenericEngineValueVsRunningCostSorter(a, GetTotalCapacityOfArticulatedParts(a), b, GetTotalCapacityOfArticulatedParts(b));
+	return GenericEngineValueVsRunningCostSorter(a, GetEngineSortArticulatedCapacity(a), b, GetEngineSortArticulatedCapacity(b));
 }
 
 /* Ship vehicle sorting functions */
@@ -514,11 +571,8 @@ static bool RoadVehEngineCapacityVsRunningCostSorter(const EngineID &a, const En
  */
 static bool ShipEngineCapacitySorter(const EngineID &a, const EngineID &b)
 {
-	const Engine *e_a = Engine::Get(a);
-	const Engine *e_b = Engine::Get(b);
-
-	int va = e_a->GetDisplayDefaultCapacity();
-	int vb = e_b->GetDisplayDefaultCapacity();
+	int va = GetEngineSortDefaultCapacity(a);
+	int vb = GetEngineSortDefaultCapacity(b);
 	int r = va - vb;
 
 	/* Use EngineID to sort instead since we want consistent sorting */
@@ -534,7 +588,7 @@ static bool ShipEngineCapacitySorter(const EngineID &a, const EngineID &b)
  */
 static bool ShipEngineCapacityVsRunningCostSorter(const EngineID &a, const EngineID &b)
 {
-	return GenericEngineValueVsRunningCostSorter(a, Engine::Get(a)->GetDisplayDefaultCapacity(), b, Engine::Get(b)->GetDisplayDefaultCapacity());
+	return GenericEngineValueVsRunningCostSorter(a, GetEngineSortDefaultCapacity(a), b, GetEngineSortDefaultCapacity(b));
 }
 
 /* Aircraft sorting functions */
@@ -547,12 +601,9 @@ static bool ShipEngineCapacityVsRunningCostSorter(const EngineID &a, const Engin
  */
 static bool AircraftEngineCargoSorter(const EngineID &a, const EngineID &b)
 {
-	const Engine *e_a = Engine::Get(a);
-	const Engine *e_b = Engine::Get(b);
-
 	uint16 mail_a, mail_b;
-	int va = e_a->GetDisplayDefaultCapacity(&mail_a);
-	int vb = e_b->GetDisplayDefaultCapacity(&mail_b);
+	int va = GetEngineSortDefaultCapacity(a, &mail_a);
+	int vb = GetEngineSortDefaultCapacity(b, &mail_b);
 	int r = va - vb;
 
 	if (r == 0) {
@@ -575,12 +626,9 @@ static bool AircraftEngineCargoSorter(const EngineID &a, const EngineID &b)
  */
 static bool AircraftEngineCapacityVsRunningCostSorter(const EngineID &a, const EngineID &b)
 {
-	const Engine *e_a = Engine::Get(a);
-	const Engine *e_b = Engine::Get(b);
-
 	uint16 mail_a, mail_b;
-	int va = e_a->GetDisplayDefaultCapacity(&mail_a);
-	int vb = e_b->GetDisplayDefaultCapacity(&mail_b);
+	int va = GetEngineSortDefaultCapacity(a, &mail_a);
+	int vb = GetEngineSortDefaultCapacity(b, &mail_b);
 
 	return GenericEngineValueVsRunningCostSorter(a, va + mail_a, b, vb + mail_b);
 }
@@ -1567,9 +1615,6 @@ struct BuildVehicleWindow : BuildVehicleWindowBase {
 
 		this->SelectEngine(sel_id);
 
-		/* invalidate cached values for name sorter - engine names could change */
-		_last_engine[0] = _last_engine[1] = INVALID_ENGINE;
-
 		/* make engines first, and then wagons, sorted by selected sort_criteria */
 		_engine_sort_direction = false;
 		EngList_Sort(&this->eng_list, TrainEnginesThenWagonsSorter);
@@ -2334,9 +2379,6 @@ struct BuildVehicleWindowTrainAdvanced final : BuildVehicleWindowBase {
 
 		this->SelectEngine(state, sel_id);
 
-		/* invalidate cached values for name sorter - engine names could change */
-		_last_engine[0] = _last_engine[1] = INVALID_ENGINE;
-
 		/* Sort */
 		_engine_sort_direction = state.descending_sort_order;
 		EngList_Sort(&state.eng_list, sorters[state.sort_criteria]);
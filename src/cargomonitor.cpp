@@ -16,15 +16,60 @@
 CargoMonitorMap _cargo_pickups;    ///< Map of monitored pick-ups   to the amount since last query/activation.
 CargoMonitorMap _cargo_deliveries; ///< Map of monitored deliveries to the amount since last query/activation.
 
+/**
+ * Cargo types which may have monitors, per company, for one cargo monitor map.
+ * Monitors being removed are not taken out, so this may report cargo types which are no longer monitored.
+ */
+struct CargoMonitorFilter {
+	CargoTypes cargoes[1 << CCB_COMPANY_LENGTH]; ///< Cargo types which may have monitors, by company.
+	bool valid = false;                          ///< Whether #cargoes is up to date with the monitor map.
+
+	/**
+	 * Check whether there may be monitors for a company and cargo type.
+	 * @param monitor_map The monitor map this filter is for.
+	 * @param company The company.
+	 * @param cargo_type The cargo type.
+	 * @return False if there is definitely no monitor for the company and cargo type.
+	 */
+	bool MayBeMonitored(const CargoMonitorMap &monitor_map, CompanyID company, CargoID cargo_type)
+	{
+		if (monitor_map.empty()) return false;
+		if (!this->valid) {
+			for (CargoTypes &cargoes : this->cargoes) cargoes = 0;
+			for (const auto &it : monitor_map) {
+				SetBit(this->cargoes[DecodeMonitorCompany(it.first)], DecodeMonitorCargoType(it.first));
+			}
+			this->valid = true;
+		}
+		return HasBit(this->cargoes[company], cargo_type);
+	}
+
+	/**
+	 * Note that a monitor was added.
+	 * @param monitor The added monitor.
+	 */
+	void Add(CargoMonitorID monitor)
+	{
+		if (this->valid) SetBit(this->cargoes[DecodeMonitorCompany(monitor)], DecodeMonitorCargoType(monitor));
+	}
+};
+
+static CargoMonitorFilter _cargo_pickups_filter;    ///< Filter of #_cargo_pickups.
+static CargoMonitorFilter _cargo_deliveries_filter; ///< Filter of #_cargo_deliveries.
+
 /**
  * Helper method for #ClearCargoPickupMonitoring and #ClearCargoDeliveryMonitoring.
  * Clears all monitors that belong to the specified company or all if #INVALID_OWNER
  * is specified as company.
  * @param cargo_monitor_map reference to the cargo monitor map to operate on.
+ * @param filter the filter of the cargo monitor map.
  * @param company company to clear cargo monitors for or #INVALID_OWNER if all cargo monitors should be cleared.
  */
-static void ClearCargoMonitoring(CargoMonitorMap &cargo_monitor_map, CompanyID company = INVALID_OWNER)
+static void ClearCargoMonitoring(CargoMonitorMap &cargo_monitor_map, CargoMonitorFilter &filter, CompanyID company = INVALID_OWNER)
 {
+	/* Monitors may be inserted directly afterwards when loading, rebuild the filter when next used. */
+	filter.valid = false;
+
 	if (company == INVALID_OWNER) {
 		cargo_monitor_map.clear();
 		return;
@@ -46,7 +91,7 @@ static void ClearCargoMonitoring(CargoMonitorMap &cargo_monitor_map, CompanyID c
  */
 void ClearCargoPickupMonitoring(CompanyID company)
 {
-	ClearCargoMonitoring(_cargo_pickups, company);
+	ClearCargoMonitoring(_cargo_pickups, _cargo_pickups_filter, company);
 }
 
 /**
@@ -56,23 +101,25 @@ void ClearCargoPickupMonitoring(CompanyID company)
  */
 void ClearCargoDeliveryMonitoring(CompanyID company)
 {
-	ClearCargoMonitoring(_cargo_deliveries, company);
+	ClearCargoMonitoring(_cargo_deliveries, _cargo_deliveries_filter, company);
 }
 
 /**
  * Get and reset the amount associated with a cargo monitor.
  * @param[in,out] monitor_map Monitoring map to search (and reset for the queried entry).
+ * @param[in,out] filter Filter of the monitoring map.
  * @param monitor Cargo monitor to query/reset.
  * @param keep_monitoring After returning from this call, continue monitoring.
  * @return Amount collected since last query/activation for the monitored combination.
  */
-static int32 GetAmount(CargoMonitorMap &monitor_map, CargoMonitorID monitor, bool keep_monitoring)
+static int32 GetAmount(CargoMonitorMap &monitor_map, CargoMonitorFilter &filter, CargoMonitorID monitor, bool keep_monitoring)
 {
 	CargoMonitorMap::iterator iter = monitor_map.find(monitor);
 	if (iter == monitor_map.end()) {
 		if (keep_monitoring) {
 			std::pair<CargoMonitorID, uint32> p(monitor, 0);
 			monitor_map.insert(p);
+			filter.Add(monitor);
 		}
 		return 0;
 	} else {
@@ -91,7 +138,7 @@ static int32 GetAmount(CargoMonitorMap &monitor_map, CargoMonitorID monitor, boo
  */
 int32 GetDeliveryAmount(CargoMonitorID monitor, bool keep_monitoring)
 {
-	return GetAmount(_cargo_deliveries, monitor, keep_monitoring);
+	return GetAmount(_cargo_deliveries, _cargo_deliveries_filter, monitor, keep_monitoring);
 }
 
 /**
@@ -103,7 +150,7 @@ int32 GetDeliveryAmount(CargoMonitorID monitor, bool keep_monitoring)
  */
 int32 GetPickupAmount(CargoMonitorID monitor, bool keep_monitoring)
 {
-	return GetAmount(_cargo_pickups, monitor, keep_monitoring);
+	return GetAmount(_cargo_pickups, _cargo_pickups_filter, monitor, keep_monitoring);
 }
 
 /**
@@ -120,7 +167,7 @@ void AddCargoDelivery(CargoID cargo_type, CompanyID company, uint32 amount, Sour
 {
 	if (amount == 0) return;
 
-	if (src != INVALID_SOURCE) {
+	if (src != INVALID_SOURCE && _cargo_pickups_filter.MayBeMonitored(_cargo_pickups, company, cargo_type)) {
 		/* Handle pickup update. */
 		switch (src_type) {
 			case ST_INDUSTRY: {
@@ -139,6 +186,8 @@ void AddCargoDelivery(CargoID cargo_type, CompanyID company, uint32 amount, Sour
 		}
 	}
 
+	if (!_cargo_deliveries_filter.MayBeMonitored(_cargo_deliveries, company, cargo_type)) return;
+
 	/* Handle delivery.
 	 * Note that delivery in the right area is sufficient to prevent trouble with neighbouring industries or houses. */
 
@@ -20,6 +20,7 @@
 #include "strings_func.h"
 #include "3rdparty/cpp-btree/btree_map.h"
 
+#include <unordered_map>
 #include <vector>
 
 #include "safeguards.h"
@@ -409,6 +410,7 @@ void VehicleCargoList::Append(CargoPacket *cp, MoveToAction action)
 	assert(cp != nullptr);
 	assert(action == MTA_LOAD ||
 			(action == MTA_KEEP && this->action_counts[MTA_LOAD] == 0));
+	this->ApplyPendingAge();
 	this->AddToMeta(cp, action);
 
 	if (this->count == cp->count) {
@@ -562,18 +564,38 @@ void VehicleCargoList::AddToMeta(const CargoPacket *cp, MoveToAction action)
 }
 
 /**
- * Ages the all cargo in this list.
+ * Applies the aging periods which have passed since the packets were last
+ * aged, so that their days in transit are up to date again. This must be
+ * done before any packet of the list is moved, split or inspected.
  */
-void VehicleCargoList::AgeCargo()
+void VehicleCargoList::ApplyPendingAge()
 {
+	if (this->pending_age == 0) return;
 	for (ConstIterator it(this->packets.begin()); it != this->packets.end(); it++) {
 		CargoPacket *cp = *it;
 		/* If we're at the maximum, then we can't increase no more. */
-		if (cp->days_in_transit == 0xFF) continue;
+		uint age = std::min<uint>(this->pending_age, 0xFF - cp->days_in_transit);
+		cp->days_in_transit += age;
+		this->cargo_days_in_transit += cp->count * age;
+	}
+	this->pending_age = 0;
+}
+
+/**
+ * Returns average number of days in transit for a cargo entity, including
+ * the aging periods which have not been applied to the packets yet.
+ * @return The before mentioned number.
+ */
+uint VehicleCargoList::DaysInTransit() const
+{
+	if (this->count == 0) return 0;
+	if (this->pending_age == 0) return this->cargo_days_in_transit / this->count;
 
-		cp->days_in_transit++;
-		this->cargo_days_in_transit += cp->count;
+	uint days_in_transit = this->cargo_days_in_transit;
+	for (const CargoPacket *cp : this->packets) {
+		days_in_transit += cp->count * std::min<uint>(this->pending_age, 0xFF - cp->days_in_transit);
 	}
+	return days_in_transit / this->count;
 }
 
 /**
@@ -633,6 +655,7 @@ bool VehicleCargoList::Stage(bool accepted, StationID current_station, StationID
 {
 	this->AssertCountConsistency();
 	assert(this->action_counts[MTA_LOAD] == 0);
+	this->ApplyPendingAge();
 	this->action_counts[MTA_TRANSFER] = this->action_counts[MTA_DELIVER] = this->action_counts[MTA_KEEP] = 0;
 	Iterator it = this->packets.begin();
 	uint sum = 0;
@@ -726,6 +749,7 @@ bool VehicleCargoList::Stage(bool accepted, StationID current_station, StationID
 /** Invalidates the cached data and rebuild it. */
 void VehicleCargoList::InvalidateCache()
 {
+	this->ApplyPendingAge();
 	this->feeder_share = 0;
 	this->Parent::InvalidateCache();
 }
@@ -764,6 +788,7 @@ template<>
 uint VehicleCargoList::Reassign<VehicleCargoList::MTA_DELIVER, VehicleCargoList::MTA_TRANSFER>(uint max_move, TileOrStationID next_station)
 {
 	max_move = std::min(this->action_counts[MTA_DELIVER], max_move);
+	this->ApplyPendingAge();
 
 	uint sum = 0;
 	for (Iterator it(this->packets.begin()); sum < this->action_counts[MTA_TRANSFER] + max_move;) {
@@ -797,6 +822,7 @@ uint VehicleCargoList::Reassign<VehicleCargoList::MTA_DELIVER, VehicleCargoList:
 uint VehicleCargoList::Return(uint max_move, StationCargoList *dest, StationID next)
 {
 	max_move = std::min(this->action_counts[MTA_LOAD], max_move);
+	this->ApplyPendingAge();
 	this->PopCargo(CargoReturn(this, dest, max_move, next));
 	return max_move;
 }
@@ -810,10 +836,64 @@ uint VehicleCargoList::Return(uint max_move, StationCargoList *dest, StationID n
 uint VehicleCargoList::Shift(uint max_move, VehicleCargoList *dest)
 {
 	max_move = std::min(this->count, max_move);
-	this->PopCargo(CargoShift(this, dest, max_move));
+	assert(dest->action_counts[MTA_LOAD] == 0);
+	this->ApplyPendingAge();
+	dest->ApplyPendingAge();
+
+	/* Move the whole packets at the back of the list in one go, without trying to merge them. */
+	uint moved = 0;
+	Iterator first = this->packets.end();
+	while (first != this->packets.begin()) {
+		const CargoPacket *cp = *(first - 1);
+		if (moved + cp->count > max_move) break;
+		moved += cp->count;
+		--first;
+	}
+	if (first != this->packets.end()) {
+		for (Iterator it = first; it != this->packets.end(); ++it) {
+			this->RemoveFromMeta(*it, MTA_KEEP, (*it)->count);
+			dest->AddToMeta(*it, MTA_KEEP);
+		}
+		dest->packets.insert(dest->packets.end(), first, this->packets.end());
+		this->packets.erase(first, this->packets.end());
+	}
+
+	/* Split off the remainder from the packet which is now at the back. */
+	if (moved < max_move) this->PopCargo(CargoShift(this, dest, max_move - moved));
 	return max_move;
 }
 
+/**
+ * Transfers the whole packets at the front of the list to a station, as long
+ * as they fit within the given amount. Runs of packets with the same next hop
+ * are appended to the station's list in one go.
+ * No transfer credits are paid here, as they were already granted during Stage().
+ * @param max_move Maximum amount of cargo to transfer.
+ * @param dest Station cargo list to transfer the cargo to.
+ * @return Amount of cargo actually transferred.
+ */
+uint VehicleCargoList::TransferRange(uint max_move, StationCargoList *dest)
+{
+	uint moved = 0;
+	Iterator last = this->packets.begin();
+	while (last != this->packets.end() && moved + (*last)->count <= max_move) {
+		CargoPacket *cp = *last;
+		this->RemoveFromMeta(cp, MTA_TRANSFER, cp->count);
+		moved += cp->count;
+		++last;
+	}
+
+	for (Iterator run = this->packets.begin(); run != last;) {
+		StationID next = (*run)->next_station;
+		Iterator run_end = run + 1;
+		while (run_end != last && (*run_end)->next_station == next) ++run_end;
+		dest->AppendRange(run, run_end, next);
+		run = run_end;
+	}
+	this->packets.erase(this->packets.begin(), last);
+	return moved;
+}
+
 /**
  * Unloads cargo at the given station. Deliver or transfer, depending on the
  * ranges defined by designation_counts.
@@ -824,10 +904,12 @@ uint VehicleCargoList::Shift(uint max_move, VehicleCargoList *dest)
  */
 uint VehicleCargoList::Unload(uint max_move, StationCargoList *dest, CargoPayment *payment)
 {
+	this->ApplyPendingAge();
 	uint moved = 0;
 	if (this->action_counts[MTA_TRANSFER] > 0) {
 		uint move = std::min(this->action_counts[MTA_TRANSFER], max_move);
-		this->ShiftCargo(CargoTransfer(this, dest, move));
+		uint transferred = this->TransferRange(move, dest);
+		if (transferred < move) this->ShiftCargo(CargoTransfer(this, dest, move - transferred));
 		moved += move;
 	}
 	if (this->action_counts[MTA_TRANSFER] == 0 && this->action_counts[MTA_DELIVER] > 0 && moved < max_move) {
@@ -848,6 +930,7 @@ uint VehicleCargoList::Truncate(uint max_move)
 {
 	max_move = std::min(this->count, max_move);
 	if (max_move > this->ActionCount(MTA_KEEP)) this->KeepAll();
+	this->ApplyPendingAge();
 	this->PopCargo(CargoRemoval<VehicleCargoList>(this, max_move));
 	return max_move;
 }
@@ -863,6 +946,8 @@ uint VehicleCargoList::Truncate(uint max_move)
 uint VehicleCargoList::Reroute(uint max_move, VehicleCargoList *dest, StationID avoid, StationID avoid2, const GoodsEntry *ge)
 {
 	max_move = std::min(this->action_counts[MTA_TRANSFER], max_move);
+	this->ApplyPendingAge();
+	dest->ApplyPendingAge();
 	this->ShiftCargoWithFrontInsert(VehicleCargoReroute(this, dest, max_move, avoid, avoid2, ge), [](CargoPacket *cp) { return true; });
 	return max_move;
 }
@@ -879,6 +964,8 @@ uint VehicleCargoList::Reroute(uint max_move, VehicleCargoList *dest, StationID
 uint VehicleCargoList::RerouteFromSource(uint max_move, VehicleCargoList *dest, StationID source, StationID avoid, StationID avoid2, const GoodsEntry *ge)
 {
 	max_move = std::min(this->action_counts[MTA_TRANSFER], max_move);
+	this->ApplyPendingAge();
+	dest->ApplyPendingAge();
 	this->ShiftCargoWithFrontInsert(VehicleCargoReroute(this, dest, max_move, avoid, avoid2, ge), [source](CargoPacket *cp) { return cp->SourceStation() == source; });
 	return max_move;
 }
@@ -912,6 +999,46 @@ void StationCargoList::Append(CargoPacket *cp, StationID next)
 	list.push_back(cp);
 }
 
+/**
+ * Appends a range of cargo packets to the packets with the same next station.
+ * For longer ranges the packets the range could be merged with are looked up
+ * in an index, instead of searching the whole list for each packet of the range.
+ * @warning After appending the packets may not exist anymore!
+ * @param first First packet to add.
+ * @param last End of the range of packets to add.
+ * @param next The next hop.
+ */
+void StationCargoList::AppendRange(CargoPacketList::const_iterator first, CargoPacketList::const_iterator last, StationID next)
+{
+	/* Below this length, it is not worth building the index. */
+	static const ptrdiff_t MERGE_INDEX_THRESHOLD = 4;
+
+	if (last - first < MERGE_INDEX_THRESHOLD) {
+		for (; first != last; ++first) this->Append(*first, next);
+		return;
+	}
+
+	StationCargoPacketMap::List &list = this->packets[next];
+
+	/* Index of the last packet in the list for each merge key. */
+	std::unordered_map<uint64, size_t> merge_index;
+	for (size_t i = 0; i < list.size(); i++) {
+		merge_index[StationCargoList::GetMergeKey(list[i])] = i;
+	}
+
+	for (; first != last; ++first) {
+		CargoPacket *cp = *first;
+		assert(cp != nullptr);
+		this->AddToCache(cp);
+
+		auto iter = merge_index.find(StationCargoList::GetMergeKey(cp));
+		if (iter != merge_index.end() && StationCargoList::TryMerge(list[iter->second], cp)) continue;
+
+		merge_index[StationCargoList::GetMergeKey(cp)] = list.size();
+		list.push_back(cp);
+	}
+}
+
 /**
  * Shifts cargo from the front of the packet list for a specific station and
  * applies some action to it.
@@ -1128,6 +1255,65 @@ uint StationCargoList::Load(uint max_move, VehicleCargoList *dest, TileIndex loa
 	}
 }
 
+/**
+ * Routes all packets with station "avoid" as next hop, which pass a filter, to a
+ * different place in this list. Instead of erasing and inserting the packets one by
+ * one, the bucket of "avoid" is taken out of the list as a whole and the packets are
+ * collected per new next hop, which are then appended to their buckets in one go.
+ * The packets are visited in the same order as by ShiftCargo, so that the same
+ * random next hops are chosen.
+ * @param avoid Station to exclude from routing and current next hop of packets to reroute.
+ * @param avoid2 Additional station to exclude from routing.
+ * @param ge GoodsEntry to get the routing info from.
+ * @param filter Predicate selecting the packets to reroute.
+ * @return Amount of cargo rerouted.
+ */
+template <class Tfilter>
+uint StationCargoList::RerouteInPlace(StationID avoid, StationID avoid2, const GoodsEntry *ge, Tfilter filter)
+{
+	auto bucket = this->packets.find(avoid);
+	if (bucket == this->packets.end()) return 0;
+
+	CargoPacketList stale;
+	stale.swap(bucket->second);
+	this->packets.erase(bucket);
+
+	CargoPacketList kept;
+	std::vector<std::pair<StationID, CargoPacketList>> rerouted;
+	StationID last_source = INVALID_STATION;
+	FlowStatMap::const_iterator flow_it = ge->flows.end();
+	uint moved = 0;
+	for (CargoPacket *cp : stale) {
+		if (!filter(cp)) {
+			kept.push_back(cp);
+			continue;
+		}
+
+		/* Packets from the same source tend to be adjacent, avoid looking up their flows again. */
+		if (cp->SourceStation() != last_source) {
+			last_source = cp->SourceStation();
+			flow_it = ge->flows.find(last_source);
+		}
+		StationID next = flow_it != ge->flows.end() ? flow_it->GetVia(avoid, avoid2) : INVALID_STATION;
+		assert(next != avoid && next != avoid2);
+
+		auto group = std::find_if(rerouted.begin(), rerouted.end(), [next](const auto &item) { return item.first == next; });
+		if (group == rerouted.end()) {
+			rerouted.emplace_back(next, CargoPacketList());
+			group = rerouted.end() - 1;
+		}
+		group->second.push_back(cp);
+		moved += cp->Count();
+	}
+
+	if (!kept.empty()) this->packets[avoid].swap(kept);
+	for (auto &group : rerouted) {
+		CargoPacketList &list = this->packets[group.first];
+		list.insert(list.end(), group.second.begin(), group.second.end());
+	}
+	return moved;
+}
+
 /**
  * Routes packets with station "avoid" as next hop to a different place.
  * @param max_move Maximum amount of cargo to move.
@@ -1138,6 +1324,9 @@ uint StationCargoList::Load(uint max_move, VehicleCargoList *dest, TileIndex loa
  */
 uint StationCargoList::Reroute(uint max_move, StationCargoList *dest, StationID avoid, StationID avoid2, const GoodsEntry *ge)
 {
+	if (dest == this && max_move >= this->count) {
+		return this->RerouteInPlace(avoid, avoid2, ge, [](const CargoPacket *) { return true; });
+	}
 	return this->ShiftCargo(StationCargoReroute(this, dest, max_move, avoid, avoid2, ge), avoid, false);
 }
 
@@ -1151,6 +1340,9 @@ uint StationCargoList::Reroute(uint max_move, StationCargoList *dest, StationID
  */
 uint StationCargoList::RerouteFromSource(uint max_move, StationCargoList *dest, StationID source, StationID avoid, StationID avoid2, const GoodsEntry *ge)
 {
+	if (dest == this && max_move >= this->count) {
+		return this->RerouteInPlace(avoid, avoid2, ge, [source](const CargoPacket *cp) { return cp->SourceStation() == source; });
+	}
 	return this->ShiftCargoFromSource(StationCargoReroute(this, dest, max_move, avoid, avoid2, ge), source, avoid, false);
 }
 
@@ -298,6 +298,7 @@ protected:
 
 	Money feeder_share;                     ///< Cache for the feeder share.
 	uint action_counts[NUM_MOVE_TO_ACTION]; ///< Counts of cargo to be transferred, delivered, kept and loaded.
+	uint8 pending_age = 0;                  ///< Number of aging periods which have not been applied to the packets yet.
 
 	template<class Taction>
 	void ShiftCargo(Taction action);
@@ -308,6 +309,8 @@ protected:
 	template<class Taction>
 	void PopCargo(Taction action);
 
+	uint TransferRange(uint max_move, StationCargoList *dest);
+
 	inline uint RecalculateCargoTotal() const
 	{
 		uint total = 0;
@@ -441,7 +444,29 @@ public:
 
 	void Append(CargoPacket *cp, MoveToAction action = MTA_KEEP);
 
-	void AgeCargo();
+	/**
+	 * Ages all cargo in this list by one aging period. The packets themselves
+	 * are only aged when they are next moved or inspected, see ApplyPendingAge().
+	 */
+	inline void AgeCargo()
+	{
+		if (this->count != 0 && this->pending_age < 0xFF) this->pending_age++;
+	}
+
+	void ApplyPendingAge();
+
+	/**
+	 * Returns a pointer to the cargo packet list (so you can iterate over it etc).
+	 * @return Pointer to the packet list.
+	 * @pre There is no pending age, otherwise the days in transit of the packets are outdated.
+	 */
+	inline const CargoPacketList *Packets() const
+	{
+		assert(this->pending_age == 0);
+		return this->Parent::Packets();
+	}
+
+	uint DaysInTransit() const;
 
 	void InvalidateCache();
 
@@ -532,7 +557,11 @@ public:
 	template<class Taction>
 	uint ShiftCargoFromSource(Taction action, StationID source, StationIDStack next, bool include_invalid);
 
+	template <class Tfilter>
+	uint RerouteInPlace(StationID avoid, StationID avoid2, const GoodsEntry *ge, Tfilter filter);
+
 	void Append(CargoPacket *cp, StationID next);
+	void AppendRange(CargoPacketList::const_iterator first, CargoPacketList::const_iterator last, StationID next);
 
 	/**
 	 * Check for cargo headed for a specific station.
@@ -617,6 +646,17 @@ public:
 				cp1->source_type     == cp2->source_type &&
 				cp1->source_id       == cp2->source_id;
 	}
+
+	/**
+	 * Get a key which is equal for two CargoPackets if and only if they are
+	 * mergeable in the context of a list of CargoPackets for a Station.
+	 * @param cp CargoPacket.
+	 * @return Merge key.
+	 */
+	static uint64 GetMergeKey(const CargoPacket *cp)
+	{
+		return ((uint64)cp->source_xy << 32) | ((uint64)cp->days_in_transit << 24) | ((uint64)cp->source_type << 16) | cp->source_id;
+	}
 };
 
 #endif /* CARGOPACKET_H */
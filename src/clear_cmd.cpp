@@ -308,6 +308,7 @@ static void TileLoopClearDesert(TileIndex tile)
 	MarkTileDirtyByTile(tile);
 }
 
+/* Keep IsClearTileLoopIdle in landscape.cpp up to date when changing this. */
 static void TileLoop_Clear(TileIndex tile)
 {
 	/* If the tile is at any edge flood it to prevent maps without water. */
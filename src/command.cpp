@@ -733,6 +733,16 @@ bool IsCommandAllowedWhilePaused(uint32 cmd)
 
 static int _docommand_recursive = 0;
 
+/**
+ * Check whether the command being run is a top-level command, instead of a command issued by another command.
+ * Top-level commands are always tested with the same parameters immediately before being executed.
+ * @return True if the command being run is a top-level command.
+ */
+bool IsTopLevelCommand()
+{
+	return _docommand_recursive == 1;
+}
+
 struct cmd_text_info_dumper {
 	const char *CommandTextInfo(const char *text, uint32 binary_length)
 	{
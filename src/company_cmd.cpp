@@ -39,6 +39,7 @@
 #include "widgets/statusbar_widget.h"
 #include "core/backup_type.hpp"
 #include "debug_desync.h"
+#include "trace.h"
 
 #include "table/strings.h"
 
@@ -749,6 +750,8 @@ static void HandleBankruptcyTakeover(Company *c)
 /** Called every tick for updating some company info. */
 void OnTick_Companies(bool main_tick)
 {
+	TRACE_ZONE("OnTick_Companies");
+
 	if (_game_mode == GM_EDITOR) return;
 
 	if (main_tick) {
@@ -790,8 +793,8 @@ void CompaniesYearlyLoop()
 	for (Company *c : Company::Iterate()) {
 		memmove(&c->yearly_expenses[1], &c->yearly_expenses[0], sizeof(c->yearly_expenses) - sizeof(c->yearly_expenses[0]));
 		memset(&c->yearly_expenses[0], 0, sizeof(c->yearly_expenses[0]));
-		SetWindowDirty(WC_FINANCES, c->index);
 	}
+	SetWindowClassesDirty(WC_FINANCES);
 
 	if (_settings_client.gui.show_finances && _local_company != COMPANY_SPECTATOR) {
 		ShowCompanyFinances(_local_company);
@@ -34,6 +34,7 @@
 #include "gamelog.h"
 #include "ai/ai.hpp"
 #include "ai/ai_config.hpp"
+#include "ai/ai_instance.hpp"
 #include "newgrf.h"
 #include "newgrf_profiling.h"
 #include "console_func.h"
@@ -41,6 +42,7 @@
 #include "road.h"
 #include "rail.h"
 #include "game/game.hpp"
+#include "game/game_instance.hpp"
 #include "table/strings.h"
 #include "aircraft.h"
 #include "airport.h"
@@ -53,6 +55,7 @@
 #include "industry.h"
 #include "string_func_extra.h"
 #include "linkgraph/linkgraphjob.h"
+#include "linkgraph/linkgraphschedule.h"
 #include "base_media_base.h"
 #include "debug_settings.h"
 #include "walltime_func.h"
@@ -61,6 +64,11 @@
 #include "event_logs.h"
 #include "tile_cmd.h"
 #include "object_base.h"
+#include "framerate_type.h"
+#include "spritecache.h"
+#include "fontcache.h"
+#include "microbenchmark.h"
+#include "trace.h"
 #include <time.h>
 
 #include <set>
@@ -1514,6 +1522,101 @@ DEF_CONSOLE_CMD(ConStopAI)
 	return true;
 }
 
+/**
+ * Find the script instance of an AI company or the game script.
+ * @param arg Company id of the AI, or "gs" for the game script.
+ * @param[out] label Short name of the script, for file names.
+ * @return The script instance, or nullptr if there is none.
+ */
+static ScriptInstance *GetConsoleScriptInstance(const char *arg, std::string &label)
+{
+	if (strcasecmp(arg, "gs") == 0) {
+		label = "gs";
+		return Game::GetInstance();
+	}
+
+	CompanyID company_id = (CompanyID)(atoi(arg) - 1);
+	const Company *c = Company::GetIfValid(company_id);
+	if (c == nullptr || !c->is_ai || c->ai_instance == nullptr) return nullptr;
+	label = stdstr_fmt("ai%d", company_id + 1);
+	return c->ai_instance;
+}
+
+DEF_CONSOLE_CMD(ConScriptProfile)
+{
+	if (argc < 3) {
+		IConsoleHelp("Collect per function opcode counts and timings of an AI or the game script. Sub-commands can be abbreviated.");
+		IConsoleHelp("Usage: script_profile start <company-id | gs>");
+		IConsoleHelp("  Begin profiling the AI of the given company, or the game script, discarding any previously collected data.");
+		IConsoleHelp("Usage: script_profile report <company-id | gs> [<count>]");
+		IConsoleHelp("  Show the <count> most expensive script functions and API methods (default: 20).");
+		IConsoleHelp("Usage: script_profile stop <company-id | gs>");
+		IConsoleHelp("  End profiling and write the collected data to a CSV file.");
+		IConsoleHelp("Usage: script_profile abort <company-id | gs>");
+		IConsoleHelp("  End profiling and discard all collected data.");
+		return true;
+	}
+
+	if (_networking && !_network_server) {
+		IConsoleWarning("Only the server can profile scripts.");
+		return true;
+	}
+
+	std::string label;
+	ScriptInstance *instance = GetConsoleScriptInstance(argv[2], label);
+	if (instance == nullptr) {
+		IConsoleWarning("No AI or game script found to profile.");
+		return true;
+	}
+
+	/* "start" sub-command */
+	if (strncasecmp(argv[1], "sta", 3) == 0) {
+		if (instance->StartProfiling()) {
+			IConsolePrintF(CC_DEBUG, "Started profiling %s", label.c_str());
+		} else {
+			IConsoleWarning("The script is not running.");
+		}
+		return true;
+	}
+
+	if (!instance->IsProfiling()) {
+		IConsolePrintF(CC_WARNING, "Not profiling %s, use 'script_profile start' to start profiling.", label.c_str());
+		return true;
+	}
+
+	/* "report" sub-command */
+	if (strncasecmp(argv[1], "rep", 3) == 0) {
+		uint count = 20;
+		if (argc >= 4 && !GetArgumentInteger(&count, argv[3])) return false;
+		instance->PrintProfile(count);
+		return true;
+	}
+
+	/* "stop" sub-command */
+	if (strncasecmp(argv[1], "sto", 3) == 0) {
+		char timestamp[16] = {};
+		LocalTime::Format(timestamp, lastof(timestamp), "%Y%m%d-%H%M%S");
+
+		char filepath[MAX_PATH] = {};
+		seprintf(filepath, lastof(filepath), "%sscriptprofile-%s-%s.csv", FiosGetScreenshotDir(), timestamp, label.c_str());
+		if (instance->WriteProfile(filepath)) {
+			IConsolePrintF(CC_DEBUG, "Finished profiling %s, wrote profile to %s", label.c_str(), filepath);
+		} else {
+			IConsolePrintF(CC_ERROR, "Failed to write profile to %s", filepath);
+		}
+		instance->StopProfiling();
+		return true;
+	}
+
+	/* "abort" sub-command */
+	if (strncasecmp(argv[1], "abo", 3) == 0) {
+		instance->StopProfiling();
+		return true;
+	}
+
+	return false;
+}
+
 DEF_CONSOLE_CMD(ConRescanAI)
 {
 	if (argc == 0) {
@@ -2607,6 +2710,123 @@ DEF_CONSOLE_CMD(ConDumpLoadDebugConfig)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConDumpSavegameProfile)
+{
+	if (argc == 0 || argc > 2 || (argc == 2 && strcmp(argv[1], "csv") != 0)) {
+		IConsoleHelp("Dump the size and time of each chunk and stage of the last savegame which was saved or loaded.");
+		IConsoleHelp("Usage: dump_savegame_profile [csv]");
+		IConsoleHelp("  csv: also write the profile to a CSV file in the screenshot directory.");
+		return true;
+	}
+
+	SaveLoadProfile profile = GetLastSaveLoadProfile();
+	PrintSaveLoadProfile(profile, [](const char *line) {
+		IConsolePrint(CC_DEFAULT, line);
+	});
+
+	if (argc == 2 && profile.operation != nullptr) {
+		char timestamp[16] = {};
+		LocalTime::Format(timestamp, lastof(timestamp), "%Y%m%d-%H%M%S");
+
+		char filepath[MAX_PATH] = {};
+		seprintf(filepath, lastof(filepath), "%ssaveprofile-%s.csv", FiosGetScreenshotDir(), timestamp);
+		if (WriteSaveLoadProfileCSV(profile, filepath)) {
+			IConsolePrintF(CC_DEFAULT, "Wrote profile to %s", filepath);
+		} else {
+			IConsolePrintF(CC_ERROR, "Failed to write profile to %s", filepath);
+		}
+	}
+	return true;
+}
+
+
+DEF_CONSOLE_CMD(ConMicrobenchmark)
+{
+	if (argc < 2 || argc > 3) {
+		IConsoleHelp("Time a hot kernel in isolation, on synthetic input or on the loaded game.");
+		IConsoleHelp("Usage: microbenchmark <name | all> [<iterations>]");
+		IConsoleHelp("Microbenchmarks:");
+		IterateMicrobenchmarks([](const Microbenchmark &mb) {
+			IConsoleHelp(stdstr_fmt("  %s: %s", mb.name, mb.description).c_str());
+		});
+		return true;
+	}
+
+	uint iterations = 100;
+	if (argc == 3 && (!GetArgumentInteger(&iterations, argv[2]) || iterations == 0)) {
+		IConsolePrintF(CC_ERROR, "Invalid number of iterations: %s", argv[2]);
+		return true;
+	}
+
+	auto run = [&](const Microbenchmark &mb) {
+		MicrobenchmarkResult result;
+		result.iterations = iterations;
+		if (!mb.proc(iterations, result)) {
+			IConsolePrintF(CC_WARNING, "%s: no input to run on", mb.name);
+			return;
+		}
+		IConsolePrintF(CC_DEFAULT, "%s: iterations=%u items=" OTTD_PRINTF64U " total_ms=%.3f per_iteration_us=%.3f per_item_ns=%.1f",
+				mb.name, result.iterations, result.items, result.nanoseconds / 1000000.0, result.nanoseconds / 1000.0 / result.iterations,
+				result.items > 0 ? (double)result.nanoseconds / result.items : 0.0);
+	};
+
+	if (strcmp(argv[1], "all") == 0) {
+		IterateMicrobenchmarks(run);
+	} else {
+		const Microbenchmark *mb = GetMicrobenchmark(argv[1]);
+		if (mb == nullptr) {
+			IConsolePrintF(CC_ERROR, "Unknown microbenchmark: %s", argv[1]);
+			return true;
+		}
+		run(*mb);
+	}
+	return true;
+}
+
+
+DEF_CONSOLE_CMD(ConTrace)
+{
+	if (argc < 2 || argc > 3) {
+		IConsoleHelp("Record a trace of the nested zones of the game loop and drawing, per thread.");
+		IConsoleHelp("Usage: trace start [<events per thread>]");
+		IConsoleHelp("Usage: trace stop");
+		IConsoleHelp("Usage: trace dump [<file>]");
+		IConsoleHelp("  dump: write the trace in the Chrome trace event format, which can be opened in Perfetto or chrome://tracing.");
+		IConsoleHelp("        The default file is trace-<timestamp>.json in the screenshot directory.");
+		return true;
+	}
+
+	if (strcmp(argv[1], "start") == 0) {
+		uint events = 1 << 20;
+		if (argc == 3 && (!GetArgumentInteger(&events, argv[2]) || events == 0)) {
+			IConsolePrintF(CC_ERROR, "Invalid number of events: %s", argv[2]);
+			return true;
+		}
+		StartTrace(events);
+		IConsolePrintF(CC_DEFAULT, "Started trace, keeping the last %u events per thread", events);
+	} else if (strcmp(argv[1], "stop") == 0) {
+		StopTrace();
+		IConsolePrintF(CC_DEFAULT, "Stopped trace, " OTTD_PRINTF64U " events recorded", GetTraceEventCount());
+	} else if (strcmp(argv[1], "dump") == 0) {
+		char filepath[MAX_PATH] = {};
+		if (argc == 3) {
+			strecpy(filepath, argv[2], lastof(filepath));
+		} else {
+			char timestamp[16] = {};
+			LocalTime::Format(timestamp, lastof(timestamp), "%Y%m%d-%H%M%S");
+			seprintf(filepath, lastof(filepath), "%strace-%s.json", FiosGetScreenshotDir(), timestamp);
+		}
+		if (WriteTrace(filepath)) {
+			IConsolePrintF(CC_DEFAULT, "Wrote " OTTD_PRINTF64U " events to %s", GetTraceEventCount(), filepath);
+		} else {
+			IConsolePrintF(CC_ERROR, "Failed to write trace to %s", filepath);
+		}
+	} else {
+		IConsolePrintF(CC_ERROR, "Unknown trace action: %s", argv[1]);
+	}
+	return true;
+}
+
 
 DEF_CONSOLE_CMD(ConDumpLinkgraphJobs)
 {
@@ -2630,6 +2850,89 @@ DEF_CONSOLE_CMD(ConDumpLinkgraphJobs)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConDumpMemoryStats)
+{
+	if (argc == 0) {
+		IConsoleHelp("Dump memory usage of the pools, map arrays, sprite cache, script VMs and font caches.");
+		IConsoleHelp("Pool bytes count each item at the size of the pool's item type, derived types can be larger.");
+		return true;
+	}
+
+	std::vector<PoolMemoryStats> pools;
+	for (const PoolBase *pool : *PoolBase::GetPools()) {
+		pools.push_back(pool->GetMemoryStats());
+	}
+	std::sort(pools.begin(), pools.end(), [](const PoolMemoryStats &a, const PoolMemoryStats &b) { return a.bytes > b.bytes; });
+
+	size_t total = 0;
+	IConsolePrint(CC_DEFAULT, "Pools:");
+	for (const PoolMemoryStats &ps : pools) {
+		if (ps.peak_items == 0 && ps.capacity == 0) continue;
+		IConsolePrintF(CC_DEFAULT, "  %-24s items: %7u, peak: %7u, capacity: %7u, item size: %4u, %8u KiB",
+				ps.name, (uint)ps.items, (uint)ps.peak_items, (uint)ps.capacity, (uint)ps.item_size, (uint)(ps.bytes / 1024));
+		total += ps.bytes;
+	}
+
+	const size_t map_bytes = (size_t)MapSize() * (sizeof(TileTypeHeight) + sizeof(Tile) + sizeof(TileExtended));
+	IConsolePrintF(CC_DEFAULT, "Map arrays: %u tiles, %u KiB", MapSize(), (uint)(map_bytes / 1024));
+	total += map_bytes;
+
+	IConsolePrintF(CC_DEFAULT, "Sprite cache: %u KiB, peak: %u KiB, target: %u KiB",
+			(uint)(GetSpriteCacheUsage() / 1024), (uint)(GetSpriteCachePeakUsage() / 1024), (uint)(GetSpriteCacheTargetSize() / 1024));
+	total += GetSpriteCacheUsage();
+
+	if (Game::GetInstance() != nullptr) {
+		IConsolePrintF(CC_DEFAULT, "Game script VM: %u KiB", (uint)(Game::GetInstance()->GetAllocatedMemory() / 1024));
+		total += Game::GetInstance()->GetAllocatedMemory();
+	}
+	for (const Company *c : Company::Iterate()) {
+		if (c->ai_instance == nullptr) continue;
+		IConsolePrintF(CC_DEFAULT, "AI VM, company %u: %u KiB", (uint)c->index, (uint)(c->ai_instance->GetAllocatedMemory() / 1024));
+		total += c->ai_instance->GetAllocatedMemory();
+	}
+
+	for (FontSize fs = FS_BEGIN; fs < FS_END; fs++) {
+		const FontCache *fc = FontCache::Get(fs);
+		if (fc == nullptr) continue;
+		uint glyphs;
+		size_t bytes = fc->GetMemoryUsage(glyphs);
+		IConsolePrintF(CC_DEFAULT, "Font cache %u: %u glyphs, %u KiB excluding glyph sprites", (uint)fs, glyphs, (uint)(bytes / 1024));
+		total += bytes;
+	}
+
+	IConsolePrintF(CC_DEFAULT, "Total: %u KiB", (uint)(total / 1024));
+	return true;
+}
+
+DEF_CONSOLE_CMD(ConDumpLinkgraphJobStats)
+{
+	if (argc == 0) {
+		IConsoleHelp("Dump sizes and timings of recently joined link-graph jobs. Usage: 'dump_linkgraph_job_stats [<count>]'");
+		IConsoleHelp("  Times are in milliseconds: queue wait, total run time, run time of each stage, join lateness and finalisation.");
+		return true;
+	}
+
+	const std::deque<LinkGraphJobTelemetry> &history = LinkGraphSchedule::instance.GetTelemetryHistory();
+	size_t count = history.size();
+	if (argc > 1) count = std::min<size_t>(count, atoi(argv[1]));
+
+	auto ms = [](TimingMeasurement t) -> double { return t / 1000.0; };
+
+	IConsolePrintF(CC_DEFAULT, PRINTF_SIZE " of " PRINTF_SIZE " recent link graph jobs", count, history.size());
+	for (auto it = history.end() - count; it != history.end(); ++it) {
+		const LinkGraphJobTelemetry &t = *it;
+		CargoLabel label = CargoSpec::Get(t.cargo)->label;
+		IConsolePrintF(CC_DEFAULT, "  Link graph: %5u, cargo: %2u %c%c%c%c, nodes: %u, edges: %u",
+				t.link_graph, t.cargo, label >> 24, label >> 16, label >> 8, label, t.nodes, t.edges);
+		IConsolePrintF(CC_DEFAULT, "    queue: %.2f, run: %.2f (init: %.2f, demands: %.2f, mcf1: %.2f, flows1: %.2f, mcf2: %.2f, flows2: %.2f), late: %.2f, finalise: %.2f",
+				ms(t.QueueWait()), ms(t.RunTime()),
+				ms(t.stage_durations[LGJS_INIT]), ms(t.stage_durations[LGJS_DEMANDS]), ms(t.stage_durations[LGJS_MCF1]),
+				ms(t.stage_durations[LGJS_FLOWMAPPER1]), ms(t.stage_durations[LGJS_MCF2]), ms(t.stage_durations[LGJS_FLOWMAPPER2]),
+				ms(t.JoinLateness()), ms(t.FinaliseTime()));
+	}
+	return true;
+}
+
 DEF_CONSOLE_CMD(ConDumpRoadTypes)
 {
 	if (argc == 0) {
@@ -3021,6 +3324,9 @@ DEF_CONSOLE_CMD(ConViewportDebug)
 		IConsoleHelp("   8: VDF_DISABLE_DRAW_SPLIT");
 		IConsoleHelp("  10: VDF_SHOW_NO_LANDSCAPE_MAP_DRAW");
 		IConsoleHelp("  20: VDF_DISABLE_LANDSCAPE_CACHE");
+		IConsoleHelp("  40: VDF_DISABLE_THREADED_MAP_DRAW");
+		IConsoleHelp("  80: VDF_LEGACY_SPRITE_SORTER");
+		IConsoleHelp(" 100: VDF_DISABLE_TILE_DRAW_CACHE");
 		return true;
 	}
 
@@ -3051,6 +3357,7 @@ DEF_CONSOLE_CMD(ConViewportMarkDirty)
 			vp->dirty_blocks[(x * vp->dirty_blocks_per_column) + y] = true;
 		}
 	}
+	if (b > t) vp->MarkDirtyBlockColumns(l, r);
 	vp->is_dirty = true;
 
 	return true;
@@ -3261,6 +3568,10 @@ DEF_CONSOLE_CMD(ConNewGRFProfile)
 		IConsoleHelp("  End profiling and write the collected data to CSV files.");
 		IConsoleHelp("Usage: newgrf_profile abort");
 		IConsoleHelp("  End profiling and discard all collected data.");
+		IConsoleHelp("Usage: newgrf_profile sample [<interval> | off]");
+		IConsoleHelp("  Begin sampling every <interval>th resolution of all GRFs (default: 64), discarding any previous samples, or stop sampling.");
+		IConsoleHelp("Usage: newgrf_profile report [<count>]");
+		IConsoleHelp("  Show the per GRF totals and the <count> most expensive callbacks/sprite groups from the collected samples (default: 20).");
 		return true;
 	}
 
@@ -3371,6 +3682,76 @@ DEF_CONSOLE_CMD(ConNewGRFProfile)
 		return true;
 	}
 
+	/* "sample" sub-command */
+	if (strncasecmp(argv[1], "sam", 3) == 0) {
+		if (argc >= 3 && strcasecmp(argv[2], "off") == 0) {
+			NewGRFSampleProfiler::Stop();
+			IConsolePrintF(CC_DEBUG, "Stopped NewGRF sampling, " OTTD_PRINTF64U " samples collected", NewGRFSampleProfiler::total_samples);
+			return true;
+		}
+		uint interval = 64;
+		if (argc >= 3 && (!GetArgumentInteger(&interval, argv[2]) || interval == 0)) return false;
+		NewGRFSampleProfiler::Start(interval);
+		IConsolePrintF(CC_DEBUG, "Started sampling 1 in %u NewGRF resolutions", interval);
+		return true;
+	}
+
+	/* "report" sub-command */
+	if (strncasecmp(argv[1], "rep", 3) == 0) {
+		uint count = 20;
+		if (argc >= 3 && !GetArgumentInteger(&count, argv[2])) return false;
+
+		if (NewGRFSampleProfiler::total_samples == 0) {
+			IConsolePrintF(CC_WARNING, "No NewGRF samples collected, use 'newgrf_profile sample' to start sampling.");
+			return true;
+		}
+
+		const uint interval = NewGRFSampleProfiler::sample_interval;
+		const double total_ns = std::max<double>(1, (double)NewGRFSampleProfiler::total_ns);
+		IConsolePrintF(CC_INFO, OTTD_PRINTF64U " samples over " OTTD_PRINTF64U " ticks (1 in %u%s), estimated %.3f ms per tick",
+				NewGRFSampleProfiler::total_samples, NewGRFSampleProfiler::GetSampledTicks(), interval,
+				NewGRFSampleProfiler::IsActive() ? ", active" : "", NewGRFSampleProfiler::GetEstimatedMillisecondsPerTick());
+
+		struct GRFTotal {
+			uint64 samples = 0;
+			uint64 cache_hits = 0;
+			uint64 total_ns = 0;
+		};
+		std::map<const GRFFile *, GRFTotal> grf_totals;
+		std::vector<const std::pair<const NewGRFSampleProfiler::Key, NewGRFSampleProfiler::Stats> *> entries;
+		for (const auto &it : NewGRFSampleProfiler::stats) {
+			GRFTotal &total = grf_totals[it.first.grffile];
+			total.samples += it.second.samples;
+			total.cache_hits += it.second.cache_hits;
+			total.total_ns += it.second.total_ns;
+			entries.push_back(&it);
+		}
+
+		std::vector<std::pair<const GRFFile *, GRFTotal>> grfs(grf_totals.begin(), grf_totals.end());
+		std::sort(grfs.begin(), grfs.end(), [](const auto &a, const auto &b) { return a.second.total_ns > b.second.total_ns; });
+		IConsolePrint(CC_INFO, "Per GRF:");
+		for (const auto &it : grfs) {
+			IConsolePrintF(CC_DEFAULT, "  [%08X] %s: ~" OTTD_PRINTF64U " calls, %.1f%% of time, %.0f%% cache hits",
+					it.first != nullptr ? BSWAP32(it.first->grfid) : 0, it.first != nullptr ? it.first->filename : "(none)",
+					(it.second.samples + it.second.cache_hits) * interval, 100.0 * it.second.total_ns / total_ns,
+					100.0 * it.second.cache_hits / (it.second.samples + it.second.cache_hits));
+		}
+
+		std::sort(entries.begin(), entries.end(), [](const auto *a, const auto *b) { return a->second.total_ns > b->second.total_ns; });
+		if (entries.size() > count) entries.resize(count);
+		IConsolePrint(CC_INFO, "Most expensive callbacks/sprite groups:");
+		for (const auto *it : entries) {
+			const NewGRFSampleProfiler::Key &key = it->first;
+			const NewGRFSampleProfiler::Stats &s = it->second;
+			IConsolePrintF(CC_DEFAULT, "  [%08X] %s, callback 0x%X, sprite %u: ~" OTTD_PRINTF64U " calls, avg %.1f us, max %.1f us, %.1f%% of time, %.0f%% cache hits",
+					key.grffile != nullptr ? BSWAP32(key.grffile->grfid) : 0, GetFeatureString(key.feat), (uint)key.cb,
+					key.root_group != nullptr ? key.root_group->nfo_line : 0, (s.samples + s.cache_hits) * interval,
+					s.samples > 0 ? s.total_ns / (1000.0 * s.samples) : 0.0, s.max_ns / 1000.0, 100.0 * s.total_ns / total_ns,
+					100.0 * s.cache_hits / (s.samples + s.cache_hits));
+		}
+		return true;
+	}
+
 	return false;
 }
 
@@ -3510,6 +3891,25 @@ DEF_CONSOLE_CMD(ConFramerate)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConFramerateStream)
+{
+	if (argc == 0 || argc > 3) {
+		IConsoleHelp("Print the average and percentiles of the recent performance measurements in a machine readable format.");
+		IConsoleHelp("Usage: 'framerate_stream [<interval seconds> [<data points>]]'");
+		IConsoleHelp("Without an interval, or with an interval of 0, the statistics are printed once and periodic printing is stopped.");
+		return true;
+	}
+
+	uint interval = 0;
+	uint count = GetPerformanceDataPointCount();
+	if (argc >= 2 && !GetArgumentInteger(&interval, argv[1])) return false;
+	if (argc >= 3 && !GetArgumentInteger(&count, argv[2])) return false;
+
+	SetFramerateStream(interval, count);
+	if (interval != 0) IConsolePrintF(CC_DEFAULT, "Printing performance statistics every %u seconds", interval);
+	return true;
+}
+
 DEF_CONSOLE_CMD(ConFramerateWindow)
 {
 	extern void ShowFramerateWindow();
@@ -3528,6 +3928,28 @@ DEF_CONSOLE_CMD(ConFramerateWindow)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConSpriteCacheStats)
+{
+	if (argc == 0 || argc > 2) {
+		IConsoleHelp("Show sprite cache statistics. Usage: 'sprite_cache_stats [reset]'");
+		IConsoleHelp("  reset: reset the hit, miss, eviction and prefetch counters.");
+		return true;
+	}
+
+	if (argc == 2) {
+		if (strcmp(argv[1], "reset") != 0) return false;
+		_sprite_cache_stats = {};
+		return true;
+	}
+
+	const uint64 requests = _sprite_cache_stats.hits + _sprite_cache_stats.misses;
+	IConsolePrintF(CC_DEFAULT, "Sprite cache: " PRINTF_SIZE " KiB used, target: " PRINTF_SIZE " KiB (sprite_cache_size_px)", GetSpriteCacheUsage() / 1024, GetSpriteCacheTargetSize() / 1024);
+	IConsolePrintF(CC_DEFAULT, "Hits: " OTTD_PRINTF64U ", misses: " OTTD_PRINTF64U " (%.2f%% hits), evictions: " OTTD_PRINTF64U ", prefetched: " OTTD_PRINTF64U " (sprite_prefetch_ahead: %u)",
+			_sprite_cache_stats.hits, _sprite_cache_stats.misses, requests > 0 ? (100.0 * _sprite_cache_stats.hits) / requests : 100.0, _sprite_cache_stats.evictions,
+			_sprite_cache_stats.prefetches, _sprite_prefetch_ahead);
+	return true;
+}
+
 DEF_CONSOLE_CMD(ConFindNonRealisticBrakingSignal)
 {
 	if (argc == 0) {
@@ -3679,6 +4101,7 @@ void IConsoleStdLibRegister()
 	IConsole::CmdRegister("rescan_ai",               ConRescanAI);
 	IConsole::CmdRegister("start_ai",                ConStartAI);
 	IConsole::CmdRegister("stop_ai",                 ConStopAI);
+	IConsole::CmdRegister("script_profile",          ConScriptProfile);
 
 	IConsole::CmdRegister("list_game",               ConListGame);
 	IConsole::CmdRegister("list_game_libs",          ConListGameLibs);
@@ -3767,7 +4190,9 @@ void IConsoleStdLibRegister()
 	IConsoleDebugLibRegister();
 #endif
 	IConsole::CmdRegister("fps",                     ConFramerate);
+	IConsole::CmdRegister("framerate_stream",        ConFramerateStream);
 	IConsole::CmdRegister("fps_wnd",                 ConFramerateWindow);
+	IConsole::CmdRegister("sprite_cache_stats",      ConSpriteCacheStats);
 
 	IConsole::CmdRegister("find_non_realistic_braking_signal", ConFindNonRealisticBrakingSignal);
 	IConsole::CmdRegister("create_town", ConCreateTown);
@@ -3780,11 +4205,16 @@ void IConsoleStdLibRegister()
 	IConsole::CmdRegister("dump_cpdp_stats",         ConDumpCpdpStats,    nullptr, true);
 	IConsole::CmdRegister("dump_veh_stats",          ConVehicleStats,     nullptr, true);
 	IConsole::CmdRegister("dump_map_stats",          ConMapStats,         nullptr, true);
+	IConsole::CmdRegister("dump_memory_stats",       ConDumpMemoryStats,  nullptr, true);
 	IConsole::CmdRegister("dump_st_flow_stats",      ConStFlowStats,      nullptr, true);
 	IConsole::CmdRegister("dump_game_events",        ConDumpGameEvents,   nullptr, true);
 	IConsole::CmdRegister("dump_load_debug_log",     ConDumpLoadDebugLog, nullptr, true);
 	IConsole::CmdRegister("dump_load_debug_config",  ConDumpLoadDebugConfig, nullptr, true);
+	IConsole::CmdRegister("dump_savegame_profile",   ConDumpSavegameProfile, nullptr, true);
+	IConsole::CmdRegister("microbenchmark",          ConMicrobenchmark,   ConHookNoNetwork, true);
+	IConsole::CmdRegister("trace",                   ConTrace,            nullptr, true);
 	IConsole::CmdRegister("dump_linkgraph_jobs",     ConDumpLinkgraphJobs, nullptr, true);
+	IConsole::CmdRegister("dump_linkgraph_job_stats", ConDumpLinkgraphJobStats, nullptr, true);
 	IConsole::CmdRegister("dump_road_types",         ConDumpRoadTypes,    nullptr, true);
 	IConsole::CmdRegister("dump_rail_types",         ConDumpRailTypes,    nullptr, true);
 	IConsole::CmdRegister("dump_bridge_types",       ConDumpBridgeTypes,  nullptr, true);
@@ -31,11 +31,41 @@ struct SimpleChecksum64 {
 	}
 };
 
+/** Parts of the game state with their own checksum, to be able to tell which part diverged on a desync. */
+enum StateChecksumPart : uint8 {
+	SCP_VEHICLES,   ///< Vehicle movement and path finding.
+	SCP_COMPANIES,  ///< Company finances.
+	SCP_COMMANDS,   ///< Executed commands and whether they succeeded.
+	SCP_TOWNS,      ///< Town growth.
+	SCP_STATIONS,   ///< Station cargo and ratings.
+	SCP_INDUSTRIES, ///< Industry production.
+	SCP_END,        ///< End marker.
+};
+
 extern SimpleChecksum64 _state_checksum;
+extern SimpleChecksum64 _state_checksum_parts[SCP_END];
 
-inline void UpdateStateChecksum(uint64 input)
+const char *GetStateChecksumPartName(StateChecksumPart part);
+
+/**
+ * Update the state checksum and the checksum of the part of the state.
+ * @param input The state to add.
+ * @param part The part of the state.
+ */
+inline void UpdateStateChecksum(uint64 input, StateChecksumPart part)
 {
 	_state_checksum.Update(input);
+	_state_checksum_parts[part].Update(input);
+}
+
+/**
+ * Update only the checksum of the part of the state, for state which is not part of the state checksum itself.
+ * @param input The state to add.
+ * @param part The part of the state.
+ */
+inline void UpdateStateSubChecksum(uint64 input, StateChecksumPart part)
+{
+	_state_checksum_parts[part].Update(input);
 }
 
 #ifdef RANDOM_DEBUG
@@ -122,29 +122,78 @@ class Kdtree {
 		return true;
 	}
 
-	/** Insert one element in the tree somewhere below node_idx */
-	void InsertRecursive(const T &element, size_t node_idx, int level)
+	/** Count the elements in a sub-tree */
+	size_t CountSubtree(size_t node_idx) const
 	{
-		/* Dimension index of current level */
-		int dim = level % 2;
-		/* Node reference */
-		node &n = this->nodes[node_idx];
+		if (node_idx == INVALID_NODE) return 0;
+		const node &n = this->nodes[node_idx];
+		return 1 + this->CountSubtree(n.left) + this->CountSubtree(n.right);
+	}
 
-		/* Coordinate of element splitting at this node */
-		CoordT nc = this->xyfunc(n.element, dim);
-		/* Coordinate of the new element */
-		CoordT ec = this->xyfunc(element, dim);
-		/* Which side to insert on */
-		size_t &next = (ec < nc) ? n.left : n.right;
-
-		if (next == INVALID_NODE) {
-			/* New leaf */
-			size_t newidx = this->AddNode(element);
-			/* Vector may have been reallocated at this point, n and next are invalid */
-			node &nn = this->nodes[node_idx];
-			if (ec < nc) nn.left = newidx; else nn.right = newidx;
-		} else {
-			this->InsertRecursive(element, next, level + 1);
+	/** Get the maximum depth of an element in a tree of the given size before it is considered unbalanced */
+	static int MaxBalancedDepth(size_t count)
+	{
+		/* log base 4/3 of count, matching the weight balance checked for in InsertBalanced */
+		int depth = 0;
+		for (; count > 1; count = count * 3 / 4) depth++;
+		return depth;
+	}
+
+	/** Rebuild a sub-tree at the given level to be fully balanced, return the new index of its root */
+	size_t RebuildSubtree(size_t node_idx, int level)
+	{
+		T element = this->nodes[node_idx].element;
+		std::vector<T> elements = this->FreeSubtree(node_idx);
+		elements.push_back(element);
+		this->free_list.push_back(node_idx);
+		return this->BuildSubtree(elements.begin(), elements.end(), level);
+	}
+
+	/**
+	 * Insert one element in the tree as a new leaf.
+	 * If the new leaf is too deep, the sub-tree of an ancestor which is too unbalanced by weight is rebuilt (as in a scapegoat tree),
+	 * which keeps the depth of the tree logarithmic without ever having to rebuild the entire tree on insertion.
+	 */
+	void InsertBalanced(const T &element)
+	{
+		/* Descend to the position of the new leaf, recording the path to it */
+		std::vector<size_t> path;
+		size_t node_idx = this->root;
+		int level = 0;
+		while (node_idx != INVALID_NODE) {
+			path.push_back(node_idx);
+			const node &n = this->nodes[node_idx];
+			int dim = level % 2;
+			node_idx = (this->xyfunc(element, dim) < this->xyfunc(n.element, dim)) ? n.left : n.right;
+			level++;
+		}
+
+		size_t newidx = this->AddNode(element);
+		/* Vector may have been reallocated at this point */
+		node &parent = this->nodes[path.back()];
+		int parent_dim = (level - 1) % 2;
+		if (this->xyfunc(element, parent_dim) < this->xyfunc(parent.element, parent_dim)) parent.left = newidx; else parent.right = newidx;
+
+		if (level <= MaxBalancedDepth(this->Count())) return;
+
+		/* Walk back up to find the scapegoat, an ancestor of which the child on the path holds more than 3/4 of the elements */
+		size_t child_idx = newidx;
+		size_t child_size = 1;
+		for (size_t i = path.size(); i-- > 0;) {
+			const node &n = this->nodes[path[i]];
+			size_t size = child_size + 1 + this->CountSubtree(n.left == child_idx ? n.right : n.left);
+			if (child_size * 4 > size * 3) {
+				size_t rebuilt = this->RebuildSubtree(path[i], (int)i);
+				if (i == 0) {
+					this->root = rebuilt;
+				} else {
+					node &p = this->nodes[path[i - 1]];
+					if (p.left == path[i]) p.left = rebuilt; else p.right = rebuilt;
+				}
+				return;
+			}
+			child_idx = path[i];
+			child_size = size;
 		}
 	}
 
@@ -273,6 +322,35 @@ class Kdtree {
 		return best;
 	}
 
+	/** Search a sub-tree for the element nearest to a given point which is accepted by a filter, updating the best element found so far */
+	template <typename Filter>
+	void FindNearestFilteredRecursive(CoordT xy[2], size_t node_idx, int level, const Filter &filter, node_distance &best, bool &found) const
+	{
+		/* Dimension index of current level */
+		int dim = level % 2;
+		/* Node reference */
+		const node &n = this->nodes[node_idx];
+
+		/* Coordinate of element splitting at this node */
+		CoordT c = this->xyfunc(n.element, dim);
+		/* This node's distance to target */
+		DistT thisdist = ManhattanDistance(n.element, xy[0], xy[1]);
+		if ((thisdist < best.second || (found && thisdist == best.second && n.element < best.first)) && filter(n.element)) {
+			best = std::make_pair(n.element, thisdist);
+			found = true;
+		}
+
+		/* Next node to visit */
+		size_t next = (xy[dim] < c) ? n.left : n.right;
+		if (next != INVALID_NODE) this->FindNearestFilteredRecursive(xy, next, level + 1, filter, best, found);
+
+		/* Check the other side of the split if it may contain a better element */
+		size_t opposite = (xy[dim] >= c) ? n.left : n.right; // reverse of above
+		if (opposite != INVALID_NODE && best.second >= abs((int)xy[dim] - (int)c)) {
+			this->FindNearestFilteredRecursive(xy, opposite, level + 1, filter, best, found);
+		}
+	}
+
 	template <typename Outputter>
 	void FindContainedRecursive(CoordT p1[2], CoordT p2[2], size_t node_idx, int level, const Outputter &outputter) const
 	{
@@ -394,7 +472,7 @@ public:
 
 	/**
 	 * Insert a single element in the tree.
-	 * Repeatedly inserting single elements may cause the tree to become unbalanced.
+	 * Sub-trees which become unbalanced by insertions are rebuilt locally.
 	 * Undefined behaviour if the element already exists in the tree.
 	 */
 	void Insert(const T &element)
@@ -403,8 +481,7 @@ public:
 			this->root = this->AddNode(element);
 		} else {
 			if (!this->IsUnbalanced() || !this->Rebuild(&element, nullptr)) {
-				this->InsertRecursive(element, this->root, 0);
-				this->IncrementUnbalanced();
+				this->InsertBalanced(element);
 			}
 			CheckInvariant();
 		}
@@ -448,6 +525,29 @@ public:
 		return this->FindNearestRecursive(xy, this->root, 0).first;
 	}
 
+	/**
+	 * Find the element closest to given coordinate, in Manhattan distance, which is accepted by a filter.
+	 * For multiple elements with the same distance, the one comparing smaller with
+	 * a less-than comparison is chosen.
+	 * @param x First coordinate.
+	 * @param y Second coordinate.
+	 * @param filter Callback returning whether an element may be chosen.
+	 * @param none Element to return if no element is found.
+	 * @param limit Only elements with a distance less than this are found.
+	 * @return The element found, or \a none.
+	 */
+	template <typename Filter>
+	T FindNearestFiltered(CoordT x, CoordT y, const Filter &filter, T none, DistT limit = std::numeric_limits<DistT>::max()) const
+	{
+		if (this->Count() == 0) return none;
+
+		CoordT xy[2] = { x, y };
+		node_distance best = std::make_pair(none, limit);
+		bool found = false;
+		this->FindNearestFilteredRecursive(xy, this->root, 0, filter, best, found);
+		return found ? best.first : none;
+	}
+
 	/**
 	* Find all items contained within the given rectangle.
 	* @note Start coordinates are inclusive, end coordinates are exclusive. x1<x2 && y1<y2 is a precondition.
@@ -35,12 +35,14 @@ DEFINE_POOL_METHOD(inline)::Pool(const char *name) :
 		first_free(0),
 		first_unused(0),
 		items(0),
+		peak_items(0),
 #ifdef WITH_ASSERT
 		checked(0),
 #endif /* WITH_ASSERT */
 		cleaning(false),
 		data(nullptr),
 		free_bitmap(nullptr),
+		used_word_bitmap(nullptr),
 		alloc_cache(nullptr)
 { }
 
@@ -60,10 +62,17 @@ DEFINE_POOL_METHOD(inline void)::ResizeFor(size_t index)
 	this->data = ReallocT(this->data, new_size);
 	MemSetT(this->data + this->size, 0, new_size - this->size);
 
-	this->free_bitmap = ReallocT(this->free_bitmap, CeilDivT<size_t>(new_size, 64));
-	MemSetT(this->free_bitmap + CeilDivT<size_t>(this->size, 64), 0, CeilDivT<size_t>(new_size, 64) - CeilDivT<size_t>(this->size, 64));
+	const size_t old_words = CeilDivT<size_t>(this->size, 64);
+	const size_t new_words = CeilDivT<size_t>(new_size, 64);
+	this->free_bitmap = ReallocT(this->free_bitmap, new_words);
+	MemSetT(this->free_bitmap + old_words, 0, new_words - old_words);
+
+	this->used_word_bitmap = ReallocT(this->used_word_bitmap, CeilDivT<size_t>(new_words, 64));
+	MemSetT(this->used_word_bitmap + CeilDivT<size_t>(old_words, 64), 0, CeilDivT<size_t>(new_words, 64) - CeilDivT<size_t>(old_words, 64));
+
 	if (new_size % 64 != 0) {
 		this->free_bitmap[new_size / 64] |= (~((uint64) 0)) << (new_size % 64);
+		SetBit(this->used_word_bitmap[new_size / (64 * 64)], (new_size / 64) % 64);
 	}
 
 	this->size = new_size;
@@ -113,6 +122,7 @@ DEFINE_POOL_METHOD(inline void *)::AllocateItem(size_t size, size_t index)
 
 	this->first_unused = std::max(this->first_unused, index + 1);
 	this->items++;
+	this->peak_items = std::max(this->peak_items, this->items);
 
 	Titem *item;
 	if (Tcache && this->alloc_cache != nullptr) {
@@ -131,6 +141,7 @@ DEFINE_POOL_METHOD(inline void *)::AllocateItem(size_t size, size_t index)
 	}
 	this->data[index] = item;
 	SetBit(this->free_bitmap[index / 64], index % 64);
+	SetBit(this->used_word_bitmap[index / (64 * 64)], (index / 64) % 64);
 	item->index = (Tindex)(uint)index;
 	return item;
 }
@@ -200,6 +211,7 @@ DEFINE_POOL_METHOD(void)::FreeItem(size_t index)
 	}
 	this->data[index] = nullptr;
 	ClrBit(this->free_bitmap[index / 64], index % 64);
+	if (this->free_bitmap[index / 64] == 0) ClrBit(this->used_word_bitmap[index / (64 * 64)], (index / 64) % 64);
 	this->first_free = std::min(this->first_free, index);
 	this->items--;
 	if (!this->cleaning) Titem::PostDestructor(index);
@@ -216,9 +228,11 @@ DEFINE_POOL_METHOD(void)::CleanPool()
 	assert(this->items == 0);
 	free(this->data);
 	free(this->free_bitmap);
+	free(this->used_word_bitmap);
 	this->first_unused = this->first_free = this->size = 0;
 	this->data = nullptr;
 	this->free_bitmap = nullptr;
+	this->used_word_bitmap = nullptr;
 	this->cleaning = false;
 
 	if (Tcache) {
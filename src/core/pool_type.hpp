@@ -12,6 +12,8 @@
 
 #include "smallvec_type.hpp"
 #include "enum_type.hpp"
+#include "bitmath_func.hpp"
+#include "math_func.hpp"
 
 /** Various types of a pool. */
 enum PoolType {
@@ -26,6 +28,16 @@ DECLARE_ENUM_AS_BIT_SET(PoolType)
 
 typedef std::vector<struct PoolBase *> PoolVector; ///< Vector of pointers to PoolBase
 
+/** Memory usage of a pool. */
+struct PoolMemoryStats {
+	const char *name;  ///< Name of the pool.
+	size_t items;      ///< Number of items in the pool.
+	size_t peak_items; ///< Highest number of items in the pool since it was created.
+	size_t capacity;   ///< Number of indexes the pool has allocated space for.
+	size_t item_size;  ///< Size of the item type, items of derived types may be larger.
+	size_t bytes;      ///< Bytes used by the items, counted at #item_size each, and the index arrays.
+};
+
 /** Base class for base of all pools. */
 struct PoolBase {
 	const PoolType type; ///< Type of this pool.
@@ -58,6 +70,12 @@ struct PoolBase {
 	 */
 	virtual void CleanPool() = 0;
 
+	/**
+	 * Virtual method that gets the memory usage of the pool.
+	 * @return The memory usage.
+	 */
+	virtual PoolMemoryStats GetMemoryStats() const = 0;
+
 private:
 	/**
 	 * Dummy private copy constructor to prevent compilers from
@@ -90,6 +108,7 @@ struct Pool : PoolBase {
 	size_t first_free;   ///< No item with index lower than this is free (doesn't say anything about this one!)
 	size_t first_unused; ///< This and all higher indexes are free (doesn't say anything about first_unused-1 !)
 	size_t items;        ///< Number of used indexes (non-nullptr)
+	size_t peak_items;   ///< Highest number of used indexes since the pool was created
 #ifdef WITH_ASSERT
 	size_t checked;      ///< Number of items we checked for
 #endif /* WITH_ASSERT */
@@ -97,10 +116,18 @@ struct Pool : PoolBase {
 
 	Titem **data;        ///< Pointer to array of pointers to Titem
 	uint64 *free_bitmap; ///< Pointer to free bitmap
+	uint64 *used_word_bitmap; ///< Pointer to bitmap with a bit for each word of #free_bitmap, set when any of its bits is set
 
 	Pool(const char *name);
 	virtual void CleanPool();
 
+	PoolMemoryStats GetMemoryStats() const override
+	{
+		size_t words = CeilDivT<size_t>(this->size, 64);
+		size_t bytes = this->items * sizeof(Titem) + this->size * sizeof(Titem *) + (words + CeilDivT<size_t>(words, 64)) * sizeof(uint64);
+		return { this->name, this->items, this->peak_items, this->size, sizeof(Titem), bytes };
+	}
+
 	/**
 	 * Returns Titem with given index
 	 * @param index of item to get
@@ -123,6 +150,33 @@ struct Pool : PoolBase {
 		return index < this->first_unused && this->Get(index) != nullptr;
 	}
 
+	/**
+	 * Searches for the first used index, skipping unused indexes using the bitmaps.
+	 * The cost is proportional to the number of used indexes skipped over, not the number of unused ones.
+	 * @param from index to start searching at
+	 * @return first used index at or after \a from, or first_unused if there is none
+	 */
+	inline size_t FindFirstUsed(size_t from) const
+	{
+		if (from >= this->first_unused) return this->first_unused;
+
+		/* Check the remainder of the word containing from */
+		size_t word = from / 64;
+		uint64 used = this->free_bitmap[word] >> (from % 64);
+		if (used != 0) return std::min(from + FindFirstBit(used), this->first_unused);
+
+		/* Find the next word with any used index */
+		const size_t word_end = CeilDivT<size_t>(this->first_unused, 64);
+		for (word++; word < word_end; word = Align(word + 1, 64)) {
+			uint64 used_words = this->used_word_bitmap[word / 64] >> (word % 64);
+			if (used_words == 0) continue;
+			word += FindFirstBit(used_words);
+			if (word >= word_end) break;
+			return std::min((word * 64) + FindFirstBit(this->free_bitmap[word]), this->first_unused);
+		}
+		return this->first_unused;
+	}
+
 	/**
 	 * Tests whether we can allocate 'n' items
 	 * @param n number of items we want to allocate
@@ -163,7 +217,8 @@ struct Pool : PoolBase {
 		size_t index;
 		void ValidateIndex()
 		{
-			while (this->index < T::GetPoolSize() && !(T::IsValidID(this->index))) this->index++;
+			this->index = T::FindFirstUsedIndex(this->index);
+			while (this->index < T::GetPoolSize() && !(T::IsValidID(this->index))) this->index = T::FindFirstUsedIndex(this->index + 1);
 			if (this->index >= T::GetPoolSize()) this->index = T::Pool::MAX_SIZE;
 		}
 	};
@@ -208,7 +263,8 @@ struct Pool : PoolBase {
 		F filter;
 		void ValidateIndex()
 		{
-			while (this->index < T::GetPoolSize() && !(T::IsValidID(this->index) && this->filter(this->index))) this->index++;
+			this->index = T::FindFirstUsedIndex(this->index);
+			while (this->index < T::GetPoolSize() && !(T::IsValidID(this->index) && this->filter(this->index))) this->index = T::FindFirstUsedIndex(this->index + 1);
 			if (this->index >= T::GetPoolSize()) this->index = T::Pool::MAX_SIZE;
 		}
 	};
@@ -361,6 +417,16 @@ struct Pool : PoolBase {
 			return Tpool->first_unused;
 		}
 
+		/**
+		 * Returns the first index at or after the given index which is in use.
+		 * @param from index to start searching at
+		 * @return first used index, or GetPoolSize() if there is none
+		 */
+		static inline size_t FindFirstUsedIndex(size_t from)
+		{
+			return Tpool->FindFirstUsed(from);
+		}
+
 		/**
 		 * Returns number of valid items in the pool
 		 * @return number of valid items in the pool
@@ -0,0 +1,152 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file ring_buffer.hpp Double-ended queue stored in a single growing power of two sized buffer. */
+
+#ifndef RING_BUFFER_HPP
+#define RING_BUFFER_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+/**
+ * Double-ended queue, with the items stored in a single contiguous buffer which wraps around.
+ * Unlike std::deque, items which are repeatedly added at one end and removed at the other
+ * do not cause any allocations once the buffer is large enough.
+ * The buffer only grows, its size is always a power of two.
+ * @tparam T Type of the items, this must be default constructible and copyable.
+ *           Slots which do not hold an item keep a stale or default constructed value.
+ */
+template <class T>
+class ring_buffer {
+	std::vector<T> data; ///< Buffer of the items, the size is zero or a power of two.
+	uint32 head = 0;     ///< Index in the buffer of the first item.
+	uint32 count = 0;    ///< Number of items.
+
+	/**
+	 * Get the item at an index from the front.
+	 * @param index Index from the front, may be out of range for end iterators.
+	 * @return Reference to the slot of the item.
+	 */
+	inline T &Slot(uint32 index) { return this->data[(this->head + index) & (this->data.size() - 1)]; }
+	inline const T &Slot(uint32 index) const { return this->data[(this->head + index) & (this->data.size() - 1)]; }
+
+	/**
+	 * Make room for at least one more item.
+	 */
+	void Grow()
+	{
+		std::vector<T> new_data(std::max<size_t>(4, this->data.size() * 2));
+		for (uint32 i = 0; i < this->count; i++) {
+			new_data[i] = std::move(this->Slot(i));
+		}
+		this->data = std::move(new_data);
+		this->head = 0;
+	}
+
+	/** Iterator over the items, from front to back. */
+	template <class RB, class V>
+	class iterator_base {
+		RB *ring;     ///< The ring buffer.
+		uint32 index; ///< Index from the front.
+
+	public:
+		typedef V value_type;
+		typedef V *pointer;
+		typedef V &reference;
+		typedef std::ptrdiff_t difference_type;
+		typedef std::bidirectional_iterator_tag iterator_category;
+
+		iterator_base(RB *ring, uint32 index) : ring(ring), index(index) {}
+
+		reference operator*() const { return this->ring->Slot(this->index); }
+		pointer operator->() const { return &this->ring->Slot(this->index); }
+
+		bool operator==(const iterator_base &other) const { return this->index == other.index; }
+		bool operator!=(const iterator_base &other) const { return this->index != other.index; }
+
+		iterator_base &operator++() { this->index++; return *this; }
+		iterator_base operator++(int) { iterator_base result = *this; this->index++; return result; }
+		iterator_base &operator--() { this->index--; return *this; }
+		iterator_base operator--(int) { iterator_base result = *this; this->index--; return result; }
+	};
+
+public:
+	typedef T value_type;
+	typedef iterator_base<ring_buffer<T>, T> iterator;
+	typedef iterator_base<const ring_buffer<T>, const T> const_iterator;
+	typedef std::reverse_iterator<iterator> reverse_iterator;
+	typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+	inline bool empty() const { return this->count == 0; }
+	inline size_t size() const { return this->count; }
+
+	inline T &operator[](size_t index) { return this->Slot((uint32)index); }
+	inline const T &operator[](size_t index) const { return this->Slot((uint32)index); }
+
+	inline T &front() { return this->Slot(0); }
+	inline const T &front() const { return this->Slot(0); }
+	inline T &back() { return this->Slot(this->count - 1); }
+	inline const T &back() const { return this->Slot(this->count - 1); }
+
+	void push_back(const T &item)
+	{
+		if (this->count == this->data.size()) this->Grow();
+		this->Slot(this->count) = item;
+		this->count++;
+	}
+
+	void push_front(const T &item)
+	{
+		if (this->count == this->data.size()) this->Grow();
+		this->head = (this->head - 1) & (this->data.size() - 1);
+		this->count++;
+		this->Slot(0) = item;
+	}
+
+	void pop_front()
+	{
+		this->head = (this->head + 1) & (this->data.size() - 1);
+		this->count--;
+	}
+
+	void pop_back()
+	{
+		this->count--;
+	}
+
+	void clear()
+	{
+		this->head = 0;
+		this->count = 0;
+	}
+
+	/**
+	 * Change the number of items, new items at the back are default constructed.
+	 * @param new_count The new number of items.
+	 */
+	void resize(size_t new_count)
+	{
+		while (this->data.size() < new_count) this->Grow();
+		for (uint32 i = this->count; i < new_count; i++) {
+			this->Slot(i) = T();
+		}
+		this->count = (uint32)new_count;
+	}
+
+	iterator begin() { return iterator(this, 0); }
+	iterator end() { return iterator(this, this->count); }
+	const_iterator begin() const { return const_iterator(this, 0); }
+	const_iterator end() const { return const_iterator(this, this->count); }
+	reverse_iterator rbegin() { return reverse_iterator(this->end()); }
+	reverse_iterator rend() { return reverse_iterator(this->begin()); }
+	const_reverse_iterator rbegin() const { return const_reverse_iterator(this->end()); }
+	const_reverse_iterator rend() const { return const_reverse_iterator(this->begin()); }
+};
+
+#endif /* RING_BUFFER_HPP */
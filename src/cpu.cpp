@@ -13,6 +13,7 @@
 #include "safeguards.h"
 
 #undef RDTSC_AVAILABLE
+#undef XGETBV_AVAILABLE
 
 /* rdtsc for MSC_VER, uses simple inline assembly, or _rdtsc
  * from external win64.asm because VS2005 does not support inline assembly */
@@ -122,9 +123,21 @@ uint64 ottd_rdtsc() {return 0;}
  * most (if not all) of the features are set as if they do not exist.
  */
 #if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <immintrin.h>
 void ottd_cpuid(int info[4], int type)
 {
-	__cpuid(info, type);
+	__cpuidex(info, type, 0);
+}
+
+/**
+ * Get the XCR0 register, which states which register sets are saved by the OS.
+ * @pre OSXSAVE is set.
+ * @return The value of XCR0.
+ */
+#define XGETBV_AVAILABLE
+static uint64 ottd_xgetbv0()
+{
+	return _xgetbv(0);
 }
 #elif defined(__x86_64__) || defined(__i386)
 void ottd_cpuid(int info[4], int type)
@@ -144,16 +157,33 @@ void ottd_cpuid(int info[4], int type)
 			/* It is safe to write "=r" for (info[1]) as in case that PIC is enabled for i386,
 			 * the compiler will not choose EBX as target register (but something else).
 			 */
-			: "a" (type)
+			: "a" (type), "c" (0)
 	);
 #else
 	__asm__ __volatile__ (
 			"cpuid           \n\t"
 			: "=a" (info[0]), "=b" (info[1]), "=c" (info[2]), "=d" (info[3])
-			: "a" (type)
+			: "a" (type), "c" (0)
 	);
 #endif /* i386 PIC */
 }
+
+/**
+ * Get the XCR0 register, which states which register sets are saved by the OS.
+ * @pre OSXSAVE is set.
+ * @return The value of XCR0.
+ */
+#define XGETBV_AVAILABLE
+static uint64 ottd_xgetbv0()
+{
+	uint32 eax, edx;
+	__asm__ __volatile__ (
+			"xgetbv          \n\t"
+			: "=a" (eax), "=d" (edx)
+			: "c" (0)
+	);
+	return eax | ((uint64)edx << 32);
+}
 #elif defined(__e2k__) /* MCST Elbrus 2000*/
 void ottd_cpuid(int info[4], int type)
 {
@@ -189,3 +219,14 @@ bool HasCPUIDFlag(uint type, uint index, uint bit)
 	ottd_cpuid(cpu_info, type);
 	return HasBit(cpu_info[index], bit);
 }
+
+bool HasCPUAVX2Support()
+{
+#ifdef XGETBV_AVAILABLE
+	/* The CPU must support AVX and AVX2, and the OS must save the SSE and AVX registers on context switches. */
+	if (!HasCPUIDFlag(1, 2, 27) || !HasCPUIDFlag(1, 2, 28) || !HasCPUIDFlag(7, 1, 5)) return false;
+	return (ottd_xgetbv0() & 0x6) == 0x6;
+#else
+	return false;
+#endif
+}
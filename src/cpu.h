@@ -32,4 +32,10 @@ void ottd_cpuid(int info[4], int type);
  */
 bool HasCPUIDFlag(uint type, uint index, uint bit);
 
+/**
+ * Check whether the current CPU and OS support AVX2 instructions.
+ * @return Whether AVX2 is supported, or false when there is no CPUID.
+ */
+bool HasCPUAVX2Support();
+
 #endif /* CPU_H */
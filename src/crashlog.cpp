@@ -9,6 +9,7 @@
 
 #include "stdafx.h"
 #include "crashlog.h"
+#include "core/checksum_func.hpp"
 #include "crashlog_bfd.h"
 #include "gamelog.h"
 #include "date_func.h"
@@ -33,6 +34,7 @@
 #include "debug_desync.h"
 #include "event_logs.h"
 #include "scope.h"
+#include "trace.h"
 
 #include "ai/ai_info.hpp"
 #include "game/game.hpp"
@@ -229,7 +231,8 @@ char *CrashLog::LogConfiguration(char *buffer, const char *last) const
 			FontCache::Get(FS_MONO)->GetFontName()
 	);
 
-	buffer += seprintf(buffer, last, "Map size: 0x%X (%u x %u)%s\n\n", MapSize(), MapSizeX(), MapSizeY(), (!_m || !_me) ? ", NO MAP ALLOCATED" : "");
+	buffer += seprintf(buffer, last, "Map size: 0x%X (%u x %u)%s\n", MapSize(), MapSizeX(), MapSizeY(), (!_m || !_me) ? ", NO MAP ALLOCATED" : "");
+	buffer += seprintf(buffer, last, "Map allocation: %s\n\n", GetMapAllocationMode());
 
 	if (_settings_game.debug.chicken_bits != 0) {
 		buffer += seprintf(buffer, last, "Chicken bits: 0x%08X\n\n", _settings_game.debug.chicken_bits);
@@ -516,11 +519,19 @@ char *CrashLog::FillDesyncCrashLog(char *buffer, const char *last, const DesyncE
 		auto flag_check = [&](DesyncExtraInfo::Flags flag, const char *str) {
 			return info.flags & flag ? str : "";
 		};
-		buffer += seprintf(buffer, last, "Flags: %s%s%s%s\n",
+		buffer += seprintf(buffer, last, "Flags: %s%s%s%s%s\n",
 				flag_check(DesyncExtraInfo::DEIF_RAND1, "R"),
 				flag_check(DesyncExtraInfo::DEIF_RAND2, "Z"),
 				flag_check(DesyncExtraInfo::DEIF_STATE, "S"),
-				flag_check(DesyncExtraInfo::DEIF_DBL_RAND, "D"));
+				flag_check(DesyncExtraInfo::DEIF_DBL_RAND, "D"),
+				flag_check(DesyncExtraInfo::DEIF_STATE_PARTS, "P"));
+		if (info.state_parts_mismatch != 0) {
+			buffer += seprintf(buffer, last, "Mismatched state checksum parts:");
+			for (uint i = 0; i < SCP_END; i++) {
+				if (HasBit(info.state_parts_mismatch, i)) buffer += seprintf(buffer, last, " %s", GetStateChecksumPartName((StateChecksumPart)i));
+			}
+			buffer += seprintf(buffer, last, "\n");
+		}
 	}
 
 	buffer += seprintf(buffer, last, "In game date: %i-%02i-%02i (%i, %i) (DL: %u)\n", _cur_date_ymd.year, _cur_date_ymd.month + 1, _cur_date_ymd.day, _date_fract, _tick_skip_counter, _settings_game.economy.day_length_factor);
@@ -623,6 +634,35 @@ char *CrashLog::FillInconsistencyLog(char *buffer, const char *last, const Incon
 	return buffer;
 }
 
+/**
+ * Fill the slow tick log buffer with the breakdown of a slow game tick.
+ * @param buffer The begin where to write at.
+ * @param last   The last position in the buffer to write to.
+ * @param info   The slow tick.
+ * @param trace_filename The file the trace was written to, or nullptr.
+ * @return the position of the \c '\0' character after the buffer.
+ */
+char *CrashLog::FillSlowTickLog(char *buffer, const char *last, const SlowTickExtraInfo &info, const char *trace_filename) const
+{
+	time_t cur_time = time(nullptr);
+	buffer += seprintf(buffer, last, "*** OpenTTD Slow Tick Report ***\n\n");
+
+	buffer += seprintf(buffer, last, "Slow tick at: %s", asctime(gmtime(&cur_time)));
+	buffer += seprintf(buffer, last, "In game date: %i-%02i-%02i (%i, %i) (DL: %u)\n", _cur_date_ymd.year, _cur_date_ymd.month + 1, _cur_date_ymd.day, _date_fract, _tick_skip_counter, _settings_game.economy.day_length_factor);
+	buffer += seprintf(buffer, last, "Duration: %.3f ms, threshold: %.3f ms\n", (info.end - info.start) / 1000000.0, info.threshold / 1000000.0);
+	if (trace_filename != nullptr) buffer += seprintf(buffer, last, "Trace: %s\n", trace_filename);
+	buffer += seprintf(buffer, last, "\n");
+
+	buffer = DumpTraceSummary(buffer, last, info.start, info.end);
+	buffer += seprintf(buffer, last, "\n");
+
+	buffer = this->LogOpenTTDVersion(buffer, last);
+	buffer = this->LogCommandLog(buffer, last);
+
+	buffer += seprintf(buffer, last, "*** End of OpenTTD Slow Tick Report ***\n");
+	return buffer;
+}
+
 /**
  * Fill the version info log buffer.
  * @param buffer The begin where to write at.
@@ -913,6 +953,42 @@ bool CrashLog::MakeDesyncCrashLog(const std::string *log_in, std::string *log_ou
 	return ret;
 }
 
+/**
+ * Makes a slow tick log and writes it, together with the trace leading up to the slow tick, to files.
+ * Unlike the other logs this does not save the game, as it is written while the game continues normally.
+ * @return true when the log was written successfully.
+ */
+bool CrashLog::MakeSlowTickLog(const SlowTickExtraInfo &info) const
+{
+	char filename[MAX_PATH];
+
+	const size_t length = 65536 * 4;
+	char * const buffer = MallocT<char>(length);
+	auto guard = scope_guard([=]() {
+		free(buffer);
+	});
+	const char * const last = buffer + length - 1;
+
+	char name_buffer[64];
+	char *name_buffer_date = name_buffer + seprintf(name_buffer, lastof(name_buffer), "slowtick-");
+	time_t cur_time = time(nullptr);
+	strftime(name_buffer_date, lastof(name_buffer) - name_buffer_date, "%Y%m%dT%H%M%SZ", gmtime(&cur_time));
+
+	char trace_filename[MAX_PATH];
+	seprintf(trace_filename, lastof(trace_filename), "%s%s.json", _personal_dir.c_str(), name_buffer);
+	bool have_trace = WriteTrace(trace_filename);
+
+	this->FillSlowTickLog(buffer, last, info, have_trace ? trace_filename : nullptr);
+
+	bool ret = this->WriteCrashLog(buffer, filename, lastof(filename), name_buffer);
+	if (ret) {
+		DEBUG(misc, 0, "Tick took %.3f ms, slow tick log written to %s", (info.end - info.start) / 1000000.0, filename);
+	} else {
+		DEBUG(misc, 0, "Tick took %.3f ms, writing slow tick log failed", (info.end - info.start) / 1000000.0);
+	}
+	return ret;
+}
+
 /**
  * Makes an inconsistency log, writes it to a file and then subsequently tries
  * to make a crash savegame. It uses DEBUG to write
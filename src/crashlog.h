@@ -21,9 +21,11 @@ struct DesyncExtraInfo {
 		DEIF_RAND2      = 1 << 1, ///< random 2 mismatch
 		DEIF_STATE      = 1 << 2, ///< state mismatch
 		DEIF_DBL_RAND   = 1 << 3, ///< double-seed sent
+		DEIF_STATE_PARTS = 1 << 4, ///< state checksum part mismatch
 	};
 
 	Flags flags = DEIF_NONE;
+	uint32 state_parts_mismatch = 0; ///< bit mask of the mismatched state checksum parts (see StateChecksumPart)
 	const char *client_name = nullptr;
 	int client_id = -1;
 	FILE **log_file = nullptr; ///< save unclosed log file handle here
@@ -34,6 +36,13 @@ struct InconsistencyExtraInfo {
 	std::vector<std::string> check_caches_result;
 };
 
+/** Details of a game tick which took longer than the slow tick threshold, times are in nanoseconds of the trace clock. */
+struct SlowTickExtraInfo {
+	uint64 start;     ///< Start of the tick.
+	uint64 end;       ///< End of the tick.
+	uint64 threshold; ///< Duration above which a tick is slow.
+};
+
 /**
  * Helper class for creating crash logs.
  */
@@ -141,6 +150,7 @@ public:
 	void FlushCrashLogBuffer();
 	char *FillDesyncCrashLog(char *buffer, const char *last, const DesyncExtraInfo &info) const;
 	char *FillInconsistencyLog(char *buffer, const char *last, const InconsistencyExtraInfo &info) const;
+	char *FillSlowTickLog(char *buffer, const char *last, const SlowTickExtraInfo &info, const char *trace_filename) const;
 	char *FillVersionInfoLog(char *buffer, const char *last) const;
 	bool WriteCrashLog(const char *buffer, char *filename, const char *filename_last, const char *name = "crash", FILE **crashlog_file = nullptr) const;
 
@@ -161,6 +171,7 @@ public:
 	bool MakeCrashLogWithStackBuffer();
 	bool MakeDesyncCrashLog(const std::string *log_in, std::string *log_out, const DesyncExtraInfo &info) const;
 	bool MakeInconsistencyLog(const InconsistencyExtraInfo &info) const;
+	bool MakeSlowTickLog(const SlowTickExtraInfo &info) const;
 	bool MakeVersionInfoLog() const;
 	bool MakeCrashSavegameAndScreenshot() const;
 
@@ -179,6 +190,7 @@ public:
 
 	static void DesyncCrashLog(const std::string *log_in, std::string *log_out, const DesyncExtraInfo &info);
 	static void InconsistencyLog(const InconsistencyExtraInfo &info);
+	static void SlowTickLog(const SlowTickExtraInfo &info);
 	static void VersionInfoLog();
 
 	static void SetErrorMessage(const char *message);
@@ -23,6 +23,7 @@
 #include "debug.h"
 #include "landscape.h"
 #include "widgets/statusbar_widget.h"
+#include "trace.h"
 
 #include "safeguards.h"
 
@@ -313,6 +314,8 @@ static void OnNewDay()
  */
 void IncreaseDate()
 {
+	TRACE_ZONE("IncreaseDate");
+
 	/* increase day, and check if a new day is there? */
 	_tick_counter++;
 
@@ -37,6 +37,9 @@ enum NewGRFOptimiserFlags {
 	NGOF_NO_OPT_VARACT2_INSERT_JUMPS    = 6,
 	NGOF_NO_OPT_VARACT2_CB_QUICK_EXIT   = 7,
 	NGOF_NO_OPT_VARACT2_PROC_INLINE     = 8,
+	NGOF_NO_OPT_VARACT2_EVAL_PROCS      = 9,
+	NGOF_NO_OPT_VEH_CALLBACK_CACHE      = 10,
+	NGOF_NO_OPT_SPRITE_GROUP_DEDUP      = 11,
 };
 
 inline bool HasGrfOptimiserFlag(NewGRFOptimiserFlags flag)
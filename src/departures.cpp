@@ -108,9 +108,7 @@ static inline bool VehicleSetNextDepartureTime(DateTicks *previous_departure, ui
 		if (order->IsScheduledDispatchOrder(true) && !(arrived_at_timing_point && is_current_implicit_order(order))) {
 			const DispatchSchedule &ds = v->orders->GetDispatchScheduleByIndex(order->GetDispatchScheduleIndex());
 
-			DateTicksScaled actual_departure    = -1;
 			const DateTicksScaled begin_time    = ds.GetScheduledDispatchStartTick();
-			const uint32 dispatch_duration      = ds.GetScheduledDispatchDuration();
 			const int32 max_delay               = ds.GetScheduledDispatchDelay();
 
 			/* Earliest possible departure according to schedue */
@@ -124,21 +122,12 @@ static inline bool VehicleSetNextDepartureTime(DateTicks *previous_departure, ui
 
 			btree::btree_set<DateTicksScaled> &slot_cache = dept_schedule_last[&ds];
 
-			/* Find next available slots */
-			for (auto current_offset : ds.GetScheduledDispatch()) {
-				if (current_offset >= dispatch_duration) continue;
-				DateTicksScaled current_departure = begin_time + current_offset;
-				while (current_departure <= earliest_departure) {
-					current_departure += dispatch_duration;
-				}
-
-				/* Make sure the slots has not already been used previously in this departure board calculation */
-				while (slot_cache.count(current_departure) > 0) {
-					current_departure += dispatch_duration;
-				}
-
-				if (actual_departure == -1 || actual_departure > current_departure) {
-					actual_departure = current_departure;
+			/* Find next available slot */
+			DateTicksScaled actual_departure = ds.GetFirstDispatchSlotFrom(earliest_departure + 1);
+			if (actual_departure != -1) {
+				/* Make sure the slot has not already been used previously in this departure board calculation */
+				while (slot_cache.count(actual_departure) > 0) {
+					actual_departure = ds.GetFirstDispatchSlotFrom(actual_departure + 1);
 				}
 			}
 
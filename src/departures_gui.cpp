@@ -18,6 +18,7 @@
 #include "window_gui.h"
 #include "timetable.h"
 #include "vehiclelist.h"
+#include "vehiclelist_func.h"
 #include "company_base.h"
 #include "date_func.h"
 #include "departures_gui.h"
@@ -147,30 +148,33 @@ protected:
 		CompanyMask companies = 0;
 		int unitnumber_max[4] = { -1, -1, -1, -1 };
 
-		for (const Vehicle *v : Vehicle::Iterate()) {
-			if (v->type < 4 && this->show_types[v->type] && v->IsPrimaryVehicle()) {
-				for(const Order *order : v->Orders()) {
-					if ((order->IsType(OT_GOTO_STATION) || order->IsType(OT_GOTO_WAYPOINT) || order->IsType(OT_IMPLICIT))
-							&& order->GetDestination() == this->station) {
-						this->vehicles.push_back(v);
-
-						if (v->name.empty() && !(v->group_id != DEFAULT_GROUP && _settings_client.gui.vehicle_names != 0)) {
-							if (v->unitnumber > unitnumber_max[v->type]) unitnumber_max[v->type] = v->unitnumber;
-						} else {
-							SetDParam(0, (uint64)(v->index));
-							int width = (GetStringBoundingBox(STR_DEPARTURES_VEH)).width + 4;
-							if (width > this->veh_width) this->veh_width = width;
-						}
+		FindVehiclesWithOrder(
+			[&](const Vehicle *v) -> bool {
+				return v->type < 4 && this->show_types[v->type] && v->IsPrimaryVehicle();
+			},
+			[&](const Order *order) -> bool {
+				return (order->IsType(OT_GOTO_STATION) || order->IsType(OT_GOTO_WAYPOINT) || order->IsType(OT_IMPLICIT))
+						&& order->GetDestination() == this->station;
+			},
+			[&](const Vehicle *v) {
+				this->vehicles.push_back(v);
+			}
+		);
 
-						if (v->group_id != INVALID_GROUP && v->group_id != DEFAULT_GROUP) {
-							groups.insert(v->group_id);
-						}
+		for (const Vehicle *v : this->vehicles) {
+			if (v->name.empty() && !(v->group_id != DEFAULT_GROUP && _settings_client.gui.vehicle_names != 0)) {
+				if (v->unitnumber > unitnumber_max[v->type]) unitnumber_max[v->type] = v->unitnumber;
+			} else {
+				SetDParam(0, (uint64)(v->index));
+				int width = (GetStringBoundingBox(STR_DEPARTURES_VEH)).width + 4;
+				if (width > this->veh_width) this->veh_width = width;
+			}
 
-						SetBit(companies, v->owner);
-						break;
-					}
-				}
+			if (v->group_id != INVALID_GROUP && v->group_id != DEFAULT_GROUP) {
+				groups.insert(v->group_id);
 			}
+
+			SetBit(companies, v->owner);
 		}
 
 		for (uint i = 0; i < 4; i++) {
@@ -9,6 +9,7 @@
 
 #include "stdafx.h"
 #include "depot_base.h"
+#include "depot_kdtree.h"
 #include "order_backup.h"
 #include "order_func.h"
 #include "window_func.h"
@@ -16,6 +17,7 @@
 #include "vehicle_gui.h"
 #include "vehiclelist.h"
 #include "tracerestrict.h"
+#include "water_map.h"
 
 #include "safeguards.h"
 
@@ -23,6 +25,17 @@
 DepotPool _depot_pool("Depot");
 INSTANTIATE_POOL_METHODS(Depot)
 
+DepotKdtree _ship_depot_kdtree(Kdtree_DepotXYFunc);
+
+void RebuildShipDepotKdtree()
+{
+	std::vector<DepotID> depots;
+	for (const Depot *depot : Depot::Iterate()) {
+		if (IsShipDepotTile(depot->xy)) depots.push_back(depot->index);
+	}
+	_ship_depot_kdtree.Build(depots.begin(), depots.end());
+}
+
 /**
  * Clean up a depot
  */
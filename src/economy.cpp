@@ -108,16 +108,65 @@ Prices _price;
 Money _additional_cash_required;
 static PriceMultipliers _price_base_multiplier;
 
+/** Totals of the stations and vehicles of a company, as used by its value and performance rating. */
+struct CompanyAssetTotals {
+	uint station_facilities = 0;          ///< Number of facilities of the stations.
+	uint serviced_station_facilities = 0; ///< Number of facilities of the stations which were recently loaded or unloaded at.
+	Money vehicle_value = 0;              ///< Value of the vehicles which count towards the company value.
+	uint profitable_vehicles = 0;         ///< Number of primary vehicles which made a profit last year.
+	Money min_profit = 0;                 ///< Lowest profit last year of the primary vehicles older than two years.
+	bool have_min_profit = false;         ///< Whether #min_profit is set.
+};
+
 /**
- * Calculate the value of the company. That is the value of all
- * assets (vehicles, stations, shares) and money minus the loan,
- * except when including_loan is \c false which is useful when
- * we want to calculate the value for bankruptcy.
+ * Gather the asset totals of all companies, in a single pass over the stations and vehicles.
+ * @param[out] totals The totals, indexed by company.
+ */
+static void GatherCompanyAssetTotals(CompanyAssetTotals (&totals)[MAX_COMPANIES])
+{
+	for (const Station *st : Station::Iterate()) {
+		if (st->owner >= MAX_COMPANIES) continue;
+		CompanyAssetTotals &t = totals[st->owner];
+		const uint facilities = CountBits((byte)st->facilities);
+		t.station_facilities += facilities;
+		if (st->time_since_load <= 20 || st->time_since_unload <= 20) t.serviced_station_facilities += facilities;
+	}
+
+	for (const Vehicle *v : Vehicle::Iterate()) {
+		if (v->owner >= MAX_COMPANIES) continue;
+		if (HasBit(v->subtype, GVSF_VIRTUAL)) continue;
+		CompanyAssetTotals &t = totals[v->owner];
+
+		if (v->type == VEH_TRAIN ||
+				v->type == VEH_ROAD ||
+				(v->type == VEH_AIRCRAFT && Aircraft::From(v)->IsNormalAircraft()) ||
+				v->type == VEH_SHIP) {
+			t.vehicle_value += v->value * 3 >> 1;
+		}
+
+		if (IsCompanyBuildableVehicleType(v->type) && v->IsPrimaryVehicle()) {
+			if (v->profit_last_year > 0) t.profitable_vehicles++; // For the vehicle score only count profitable vehicles
+			if (v->age > 730) {
+				/* Find the vehicle with the lowest amount of profit */
+				if (!t.have_min_profit || t.min_profit > v->profit_last_year) {
+					t.min_profit = v->profit_last_year;
+					t.have_min_profit = true;
+				}
+			}
+		}
+	}
+}
+
+static Money CalculateCompanyValueExcludingShares(const Company *c, bool including_loan, const CompanyAssetTotals &totals);
+
+/**
+ * Calculate the value of the company, see #CalculateCompanyValue.
  * @param c the company to get the value of.
  * @param including_loan include the loan in the company value.
+ * @param totals the asset totals of all companies.
  * @return the value of the company.
  */
-Money CalculateCompanyValue(const Company *c, bool including_loan)
+static Money CalculateCompanyValue(const Company *c, bool including_loan, const CompanyAssetTotals (&totals)[MAX_COMPANIES])
 {
 	Money owned_shares_value = 0;
 
@@ -130,35 +179,39 @@ Money CalculateCompanyValue(const Company *c, bool including_loan)
 			}
 		}
 
-		owned_shares_value += (CalculateCompanyValueExcludingShares(co) / 4) * shares_owned;
+		if (shares_owned > 0) owned_shares_value += (CalculateCompanyValueExcludingShares(co, true, totals[co->index]) / 4) * shares_owned;
 	}
 
-	return std::max<Money>(owned_shares_value + CalculateCompanyValueExcludingShares(c), 1);
+	return std::max<Money>(owned_shares_value + CalculateCompanyValueExcludingShares(c, true, totals[c->index]), 1);
 }
 
-Money CalculateCompanyValueExcludingShares(const Company *c, bool including_loan)
+/**
+ * Calculate the value of the company. That is the value of all
+ * assets (vehicles, stations, shares) and money minus the loan,
+ * except when including_loan is \c false which is useful when
+ * we want to calculate the value for bankruptcy.
+ * @param c the company to get the value of.
+ * @param including_loan include the loan in the company value.
+ * @return the value of the company.
+ */
+Money CalculateCompanyValue(const Company *c, bool including_loan)
 {
-	Owner owner = c->index;
-
-	uint num = 0;
-
-	for (const Station *st : Station::Iterate()) {
-		if (st->owner == owner) num += CountBits((byte)st->facilities);
-	}
-
-	Money value = num * _price[PR_STATION_VALUE] * 25;
+	CompanyAssetTotals totals[MAX_COMPANIES];
+	GatherCompanyAssetTotals(totals);
+	return CalculateCompanyValue(c, including_loan, totals);
+}
 
-	for (const Vehicle *v : Vehicle::Iterate()) {
-		if (v->owner != owner) continue;
-		if (HasBit(v->subtype, GVSF_VIRTUAL)) continue;
+Money CalculateCompanyValueExcludingShares(const Company *c, bool including_loan)
+{
+	CompanyAssetTotals totals[MAX_COMPANIES];
+	GatherCompanyAssetTotals(totals);
+	return CalculateCompanyValueExcludingShares(c, including_loan, totals[c->index]);
+}
 
-		if (v->type == VEH_TRAIN ||
-				v->type == VEH_ROAD ||
-				(v->type == VEH_AIRCRAFT && Aircraft::From(v)->IsNormalAircraft()) ||
-				v->type == VEH_SHIP) {
-			value += v->value * 3 >> 1;
-		}
-	}
+static Money CalculateCompanyValueExcludingShares(const Company *c, bool including_loan, const CompanyAssetTotals &totals)
+{
+	Money value = totals.station_facilities * _price[PR_STATION_VALUE] * 25;
+	value += totals.vehicle_value;
 
 	/* Add real money value */
 	if (including_loan) value -= c->current_loan;
@@ -175,7 +228,7 @@ Money CalculateCompanyValueExcludingShares(const Company *c, bool including_loan
  * @return actual score of this company
  *
  */
-int UpdateCompanyRatingAndValue(Company *c, bool update)
+static int UpdateCompanyRatingAndValue(Company *c, bool update, const CompanyAssetTotals (&totals)[MAX_COMPANIES])
 {
 	Owner owner = c->index;
 	int score = 0;
@@ -184,41 +237,20 @@ int UpdateCompanyRatingAndValue(Company *c, bool update)
 
 	/* Count vehicles */
 	{
-		Money min_profit = 0;
-		bool min_profit_first = true;
-		uint num = 0;
-
-		for (const Vehicle *v : Vehicle::Iterate()) {
-			if (v->owner != owner) continue;
-			if (IsCompanyBuildableVehicleType(v->type) && v->IsPrimaryVehicle() && !HasBit(v->subtype, GVSF_VIRTUAL)) {
-				if (v->profit_last_year > 0) num++; // For the vehicle score only count profitable vehicles
-				if (v->age > 730) {
-					/* Find the vehicle with the lowest amount of profit */
-					if (min_profit_first || min_profit > v->profit_last_year) {
-						min_profit = v->profit_last_year;
-						min_profit_first = false;
-					}
-				}
-			}
-		}
+		Money min_profit = totals[owner].min_profit;
 
 		min_profit >>= 8; // remove the fract part
 
-		_score_part[owner][SCORE_VEHICLES] = num;
+		_score_part[owner][SCORE_VEHICLES] = totals[owner].profitable_vehicles;
 		/* Don't allow negative min_profit to show */
 		if (min_profit > 0) {
 			_score_part[owner][SCORE_MIN_PROFIT] = min_profit;
 		}
 	}
 
-	/* Count stations */
+	/* Count stations, only those that are actually serviced */
 	{
-		uint num = 0;
-		for (const Station *st : Station::Iterate()) {
-			/* Only count stations that are actually serviced */
-			if (st->owner == owner && (st->time_since_load <= 20 || st->time_since_unload <= 20)) num += CountBits((byte)st->facilities);
-		}
-		_score_part[owner][SCORE_STATIONS] = num;
+		_score_part[owner][SCORE_STATIONS] = totals[owner].serviced_station_facilities;
 	}
 
 	/* Generate statistics depending on recent income statistics */
@@ -296,13 +328,30 @@ int UpdateCompanyRatingAndValue(Company *c, bool update)
 	if (update) {
 		c->old_economy[0].performance_history = score;
 		UpdateCompanyHQ(c->location_of_HQ, score);
-		c->old_economy[0].company_value = CalculateCompanyValue(c);
+		c->old_economy[0].company_value = CalculateCompanyValue(c, true, totals);
 	}
 
 	SetWindowDirty(WC_PERFORMANCE_DETAIL, 0);
 	return score;
 }
 
+int UpdateCompanyRatingAndValue(Company *c, bool update)
+{
+	CompanyAssetTotals totals[MAX_COMPANIES];
+	GatherCompanyAssetTotals(totals);
+	return UpdateCompanyRatingAndValue(c, update, totals);
+}
+
+/** Update the performance rating of all companies, without updating their history. */
+void UpdateAllCompanyRatings()
+{
+	CompanyAssetTotals totals[MAX_COMPANIES];
+	GatherCompanyAssetTotals(totals);
+	for (Company *c : Company::Iterate()) {
+		UpdateCompanyRatingAndValue(c, false, totals);
+	}
+}
+
 /**
  * Change the ownership of all the items of a company.
  * @param old_owner The company that gets removed.
@@ -755,6 +804,10 @@ static void CompaniesGenStatistics()
 	/* Only run the economic statics and update company stats every 3rd month (1st of quarter). */
 	if (!HasBit(1 << 0 | 1 << 3 | 1 << 6 | 1 << 9, _cur_date_ymd.month)) return;
 
+	/* The stations and vehicles do not change while the statistics of the companies are updated. */
+	CompanyAssetTotals totals[MAX_COMPANIES];
+	GatherCompanyAssetTotals(totals);
+
 	for (Company *c : Company::Iterate()) {
 		/* Drop the oldest history off the end */
 		std::copy_backward(c->old_economy, c->old_economy + MAX_HISTORY_QUARTERS - 1, c->old_economy + MAX_HISTORY_QUARTERS);
@@ -763,7 +816,7 @@ static void CompaniesGenStatistics()
 
 		if (c->num_valid_stat_ent != MAX_HISTORY_QUARTERS) c->num_valid_stat_ent++;
 
-		UpdateCompanyRatingAndValue(c, true);
+		UpdateCompanyRatingAndValue(c, true, totals);
 		if (c->block_preview != 0) c->block_preview--;
 	}
 
@@ -1094,16 +1147,12 @@ static SmallIndustryList _cargo_delivery_destinations;
 
 template <class F>
 void ForAcceptingIndustries(const Station *st, CargoID cargo_type, IndustryID source, CompanyID company, F&& f) {
-	for (const auto &i : st->industries_near) {
-		Industry *ind = i.industry;
+	auto range = st->GetIndustriesNearAccepting(cargo_type);
+	for (auto it = range.first; it != range.second; ++it) {
+		Industry *ind = it->industry;
 		if (ind->index == source) continue;
 
-		uint cargo_index;
-		for (cargo_index = 0; cargo_index < lengthof(ind->accepts_cargo); cargo_index++) {
-			if (cargo_type == ind->accepts_cargo[cargo_index]) break;
-		}
-		/* Check if matching cargo has been found */
-		if (cargo_index >= lengthof(ind->accepts_cargo)) continue;
+		uint cargo_index = it->cargo_index;
 
 		/* Check if industry temporarily refuses acceptance */
 		if (IndustryTemporarilyRefusesCargo(ind, cargo_type)) continue;
@@ -1785,9 +1834,10 @@ struct ReserveCargoAction {
 	const CargoStationIDStackSet &next_station;
 	Vehicle *cargo_type_loading;
 	bool through_load;
+	CargoTypes &exhausted; ///< Cargo types of which the station has no more cargo for the next hops, shared by the whole consist.
 
-	ReserveCargoAction(Station *st, const CargoStationIDStackSet &next_station, Vehicle *cargo_type_loading, bool through_load) :
-		st(st), next_station(next_station), cargo_type_loading(cargo_type_loading), through_load(through_load) {}
+	ReserveCargoAction(Station *st, const CargoStationIDStackSet &next_station, Vehicle *cargo_type_loading, bool through_load, CargoTypes &exhausted) :
+		st(st), next_station(next_station), cargo_type_loading(cargo_type_loading), through_load(through_load), exhausted(exhausted) {}
 
 	bool operator()(Vehicle *v)
 	{
@@ -1799,9 +1849,13 @@ struct ReserveCargoAction {
 			if (flags & OLFB_NO_LOAD) return true;
 			if (!(flags & OLFB_FULL_LOAD) && !through_load) return true;
 		}
+		/* The next hops only depend on the cargo type, so once a reservation came up short the rest of the consist would not get anything either. */
+		if (HasBit(this->exhausted, v->cargo_type)) return true;
 		if (v->cargo_cap > v->cargo.RemainingCount() && MayLoadUnderExclusiveRights(st, v)) {
-			st->goods[v->cargo_type].cargo.Reserve(v->cargo_cap - v->cargo.RemainingCount(),
-					&v->cargo, st->xy, next_station.Get(v->cargo_type));
+			const uint wanted = v->cargo_cap - v->cargo.RemainingCount();
+			if (st->goods[v->cargo_type].cargo.Reserve(wanted, &v->cargo, st->xy, next_station.Get(v->cargo_type)) < wanted) {
+				SetBit(this->exhausted, v->cargo_type);
+			}
 		}
 
 		return true;
@@ -1826,6 +1880,7 @@ static void ReserveConsist(Station *st, Vehicle *u, CargoArray *consist_capleft,
 	 * In that case, only reserve if it's a fixed refit and the equivalent of "articulated chain"
 	 * a vehicle belongs to already has the right cargo. */
 	bool must_reserve = !u->current_order.IsRefit() || u->cargo_payment == nullptr;
+	CargoTypes exhausted = 0;
 	for (Vehicle *v = u; v != nullptr; v = v->Next()) {
 		assert(v->cargo_cap >= v->cargo.RemainingCount());
 
@@ -1836,9 +1891,9 @@ static void ReserveConsist(Station *st, Vehicle *u, CargoArray *consist_capleft,
 				(v->type != VEH_TRAIN || !Train::From(v)->IsRearDualheaded()) &&
 				(v->type != VEH_AIRCRAFT || Aircraft::From(v)->IsNormalAircraft()) &&
 				(must_reserve || u->current_order.GetRefitCargo() == v->cargo_type)) {
-			IterateVehicleParts(v, ReserveCargoAction(st, next_station, cargo_type_loading ? u : nullptr, through_load), through_load);
+			IterateVehicleParts(v, ReserveCargoAction(st, next_station, cargo_type_loading ? u : nullptr, through_load, exhausted), through_load);
 		} else if (through_load && v->type == VEH_TRAIN && Train::From(v)->IsRearDualheaded()) {
-			ReserveCargoAction(st, next_station, cargo_type_loading ? u : nullptr, through_load)(v);
+			ReserveCargoAction(st, next_station, cargo_type_loading ? u : nullptr, through_load, exhausted)(v);
 		}
 		if (consist_capleft == nullptr || v->cargo_cap == 0) continue;
 		if (cargo_type_loading) {
@@ -1911,15 +1966,6 @@ static void LoadUnloadVehicle(Vehicle *front)
 			}
 		}
 	}
-	int platform_length_left = 0;
-	if (pull_through_mode) {
-		platform_length_left = st->GetPlatformLength(station_tile, ReverseDiagDir(DirToDiagDir(station_vehicle->direction))) * TILE_SIZE - GetTileMarginInFrontOfTrain(Train::From(station_vehicle));
-	} else if (front->type == VEH_TRAIN) {
-		platform_length_left = st->GetPlatformLength(station_tile) * TILE_SIZE - front->GetGroundVehicleCache()->cached_total_length;
-	}
-
-	CargoStationIDStackSet next_station = front->GetNextStoppingStation();
-
 	bool use_autorefit = front->current_order.IsRefit() && front->current_order.GetRefitCargo() == CT_AUTO_REFIT;
 	CargoArray consist_capleft;
 	bool should_reserve_consist = false;
@@ -1932,6 +1978,13 @@ static void LoadUnloadVehicle(Vehicle *front)
 			reserve_consist_cargo_type_loading = (front->current_order.GetLoadType() == OLFB_CARGO_TYPE_LOAD);
 		}
 	}
+
+	/* Most vehicles at a busy station are waiting for their next round of loading and have nothing to reserve,
+	 * skip looking up their next stopping station for them. */
+	if (front->load_unload_ticks != 0 && !should_reserve_consist) return;
+
+	CargoStationIDStackSet next_station = front->GetNextStoppingStation();
+
 	if (should_reserve_consist) {
 		ReserveConsist(st, front,
 				(use_autorefit && front->load_unload_ticks != 0) ? &consist_capleft : nullptr,
@@ -1951,6 +2004,13 @@ static void LoadUnloadVehicle(Vehicle *front)
 		return;
 	}
 
+	int platform_length_left = 0;
+	if (pull_through_mode) {
+		platform_length_left = st->GetPlatformLength(station_tile, ReverseDiagDir(DirToDiagDir(station_vehicle->direction))) * TILE_SIZE - GetTileMarginInFrontOfTrain(Train::From(station_vehicle));
+	} else if (front->type == VEH_TRAIN) {
+		platform_length_left = st->GetPlatformLength(station_tile) * TILE_SIZE - front->GetGroundVehicleCache()->cached_total_length;
+	}
+
 	int new_load_unload_ticks = 0;
 	bool dirty_vehicle = false;
 	bool dirty_station = false;
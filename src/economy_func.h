@@ -26,6 +26,7 @@ extern Economy _economy;
 extern Prices _price;
 
 int UpdateCompanyRatingAndValue(Company *c, bool update);
+void UpdateAllCompanyRatings();
 void StartupIndustryDailyChanges(bool init_counter);
 
 Money GetTransportedGoodsIncome(uint num_pieces, uint dist, byte transit_days, CargoID cargo_type);
@@ -326,6 +326,7 @@ void DrawVehicleEngine(int left, int right, int preferred_x, int y, EngineID eng
 void EngList_Sort(GUIEngineList *el, EngList_SortTypeFunction compare)
 {
 	if (el->size() < 2) return;
+	InvalidateEngineSortKeys();
 	std::sort(el->begin(), el->end(), compare);
 }
 
@@ -341,6 +342,7 @@ void EngList_SortPartial(GUIEngineList *el, EngList_SortTypeFunction compare, ui
 	if (num_items < 2) return;
 	assert(begin < el->size());
 	assert(begin + num_items <= el->size());
+	InvalidateEngineSortKeys();
 	std::sort(el->begin() + begin, el->begin() + begin + num_items, compare);
 }
 
@@ -1086,6 +1086,9 @@ void DeterminePaths(const char *exe, bool only_local_path)
 
 	extern std::string _log_file;
 	_log_file = _personal_dir + "openttd.log";
+
+	extern std::string _grf_md5_cache_file;
+	_grf_md5_cache_file = _personal_dir + "grf_md5.cache";
 }
 
 /**
@@ -1126,7 +1129,8 @@ std::unique_ptr<char[]> ReadFileToMem(const std::string &filename, size_t &lenp,
 	fseek(in, 0, SEEK_SET);
 	if (len > maxsize) return nullptr;
 
-	std::unique_ptr<char[]> mem = std::make_unique<char[]>(len + 1);
+	/* Not std::make_unique, that would needlessly zero the buffer which is read into next. */
+	std::unique_ptr<char[]> mem(new char[len + 1]);
 
 	mem.get()[len] = 0;
 	if (fread(mem.get(), len, 1, in) != 1) return nullptr;
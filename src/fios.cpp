@@ -22,6 +22,7 @@
 #include "tar_type.h"
 #include <sys/stat.h>
 #include <functional>
+#include <unordered_set>
 #include "3rdparty/optional/ottd_optional.h"
 
 #ifndef _WIN32
@@ -268,6 +269,7 @@ class FiosFileScanner : public FileScanner {
 	SaveLoadOperation fop;   ///< The kind of file we are looking for.
 	fios_getlist_callback_proc *callback_proc; ///< Callback to check whether the file may be added
 	FileList &file_list;     ///< Destination of the found files.
+	std::unordered_set<std::string> names; ///< Names of the items in #file_list.
 public:
 	/**
 	 * Create the scanner
@@ -277,7 +279,9 @@ public:
 	 */
 	FiosFileScanner(SaveLoadOperation fop, fios_getlist_callback_proc *callback_proc, FileList &file_list) :
 			fop(fop), callback_proc(callback_proc), file_list(file_list)
-	{}
+	{
+		for (const FiosItem &fios : file_list) this->names.insert(fios.name);
+	}
 
 	bool AddFile(const std::string &filename, size_t basepath_length, const std::string &tar_filename) override;
 };
@@ -294,15 +298,15 @@ bool FiosFileScanner::AddFile(const std::string &filename, size_t basepath_lengt
 	if (sep == std::string::npos) return false;
 	std::string ext = filename.substr(sep);
 
+	/* Check for duplicates before the callback, which may have to read the title of the file. */
+	if (this->names.count(filename) != 0) return false;
+
 	char fios_title[64];
 	fios_title[0] = '\0'; // reset the title;
 
 	FiosType type = this->callback_proc(this->fop, filename, ext.c_str(), fios_title, lastof(fios_title));
 	if (type == FIOS_TYPE_INVALID) return false;
-
-	for (const auto &fios : file_list) {
-		if (filename == fios.name) return false;
-	}
+	this->names.insert(filename);
 
 	FiosItem *fios = &file_list.emplace_back();
 #ifdef _WIN32
@@ -70,6 +70,29 @@ void LoadCheckData::Clear()
 	this->debug_config_data.clear();
 }
 
+/**
+ * Exchange the read data with another instance, without copying the owned data.
+ * The flags of what to read are not exchanged.
+ * @param other The other instance.
+ */
+void LoadCheckData::Swap(LoadCheckData &other)
+{
+	std::swap(this->checkable, other.checkable);
+	std::swap(this->error, other.error);
+	std::swap(this->error_data, other.error_data);
+	std::swap(this->map_size_x, other.map_size_x);
+	std::swap(this->map_size_y, other.map_size_y);
+	std::swap(this->current_date, other.current_date);
+	std::swap(this->settings, other.settings);
+	std::swap(this->companies, other.companies);
+	std::swap(this->grfconfig, other.grfconfig);
+	std::swap(this->grf_compatibility, other.grf_compatibility);
+	std::swap(this->gamelog_action, other.gamelog_action);
+	std::swap(this->gamelog_actions, other.gamelog_actions);
+	std::swap(this->debug_log_data, other.debug_log_data);
+	std::swap(this->debug_config_data, other.debug_config_data);
+}
+
 /** Load game/scenario with optional content download */
 static const NWidgetPart _nested_load_dialog_widgets[] = {
 	NWidget(NWID_HORIZONTAL),
@@ -292,6 +315,63 @@ private:
 	QueryString filter_editbox; ///< Filter editbox;
 	std::vector<bool> fios_items_shown; ///< Map of the filtered out fios items
 
+	/** Previously read data of a file, kept so selecting the file again does not read it again. */
+	struct LoadCheckCacheEntry {
+		std::string name;                    ///< Name of the file.
+		uint64 mtime;                        ///< Modification time of the file when it was read.
+		std::unique_ptr<LoadCheckData> data; ///< The read data.
+	};
+	static const uint LOAD_CHECK_CACHE_SIZE = 8; ///< Maximum number of entries in #load_check_cache.
+
+	std::vector<LoadCheckCacheEntry> load_check_cache; ///< Data of recently selected files, most recently selected first.
+	std::string load_check_name; ///< Name of the file #_load_check_data was read from, or empty.
+	uint64 load_check_mtime = 0; ///< Modification time of the file #_load_check_data was read from.
+
+	/** Move the data in #_load_check_data into the cache, leaving it cleared. */
+	void StashLoadCheckData()
+	{
+		if (!this->load_check_name.empty()) {
+			if (this->load_check_cache.size() >= LOAD_CHECK_CACHE_SIZE) this->load_check_cache.pop_back();
+			LoadCheckCacheEntry entry{ std::move(this->load_check_name), this->load_check_mtime, std::make_unique<LoadCheckData>() };
+			entry.data->Swap(_load_check_data);
+			this->load_check_cache.insert(this->load_check_cache.begin(), std::move(entry));
+			this->load_check_name.clear();
+		}
+		_load_check_data.Clear();
+	}
+
+	/** Clear #_load_check_data and the cache, as the files may have changed. */
+	void ClearLoadCheckData()
+	{
+		this->load_check_cache.clear();
+		this->load_check_name.clear();
+		_load_check_data.Clear();
+	}
+
+	/**
+	 * Fill #_load_check_data with the data of a savegame, from the cache if the file did not change since it was read.
+	 * @param name Name of the file.
+	 * @param mtime Modification time of the file.
+	 */
+	void CheckSavegame(const char *name, uint64 mtime)
+	{
+		this->StashLoadCheckData();
+
+		auto it = std::find_if(this->load_check_cache.begin(), this->load_check_cache.end(), [&](const LoadCheckCacheEntry &entry) {
+			return entry.mtime == mtime && entry.name == name;
+		});
+		if (it != this->load_check_cache.end()) {
+			_load_check_data.Swap(*it->data);
+			this->load_check_cache.erase(it);
+			/* The available NewGRFs may have changed since. */
+			if (_load_check_data.want_grf_compatibility && _load_check_data.HasNewGrfs()) _load_check_data.grf_compatibility = IsGoodGRFConfigList(_load_check_data.grfconfig);
+		} else {
+			SaveOrLoad(name, SLO_CHECK, DFT_GAME_FILE, NO_DIRECTORY, false);
+		}
+		this->load_check_name = name;
+		this->load_check_mtime = mtime;
+	}
+
 	static void SaveGameConfirmationCallback(Window *w, bool confirmed)
 	{
 		/* File name has already been written to _file_to_saveload */
@@ -687,11 +767,12 @@ public:
 				if (click_count == 1) {
 					if (this->selected != file) {
 						this->selected = file;
-						_load_check_data.Clear();
 
 						if (GetDetailedFileType(file->type) == DFT_GAME_FILE) {
 							/* Other detailed file types cannot be checked before. */
-							SaveOrLoad(name, SLO_CHECK, DFT_GAME_FILE, NO_DIRECTORY, false);
+							this->CheckSavegame(name, file->mtime);
+						} else {
+							this->StashLoadCheckData();
 						}
 
 						this->InvalidateData(SLIWD_SELECTION_CHANGES);
@@ -834,14 +915,14 @@ public:
 			case SLIWD_RESCAN_FILES:
 				/* Rescan files */
 				this->selected = nullptr;
-				_load_check_data.Clear();
+				this->ClearLoadCheckData();
 				if (!gui_scope) break;
 
 				_fios_path_changed = true;
 				this->fios_items.BuildFileList(this->abstract_filetype, this->fop);
 				this->vscroll->SetCount((uint)this->fios_items.size());
 				this->selected = nullptr;
-				_load_check_data.Clear();
+				this->ClearLoadCheckData();
 
 				/* We reset the files filtered */
 				this->OnInvalidateData(SLIWD_FILTER_CHANGES);
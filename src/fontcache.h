@@ -123,6 +123,18 @@ public:
 	 */
 	virtual const void *GetFontTable(uint32 tag, size_t &length) = 0;
 
+	/**
+	 * Get the memory used by the glyph lookup tables and cached font tables.
+	 * The sprites of the glyphs are not included, as their encoded size depends on the blitter.
+	 * @param[out] glyphs Number of glyphs with a cached sprite.
+	 * @return Number of bytes.
+	 */
+	virtual size_t GetMemoryUsage(uint &glyphs) const
+	{
+		glyphs = 0;
+		return 0;
+	}
+
 	/**
 	 * Get the native OS font handle, if there is one.
 	 * @return Opaque OS font handle.
@@ -63,6 +63,26 @@ void TrueTypeFontCache::ClearFontCache()
 	Layouter::ResetFontCache(this->fs);
 }
 
+size_t TrueTypeFontCache::GetMemoryUsage(uint &glyphs) const
+{
+	glyphs = 0;
+	size_t bytes = 0;
+	for (const auto &iter : this->font_tables) {
+		bytes += iter.second.first;
+	}
+	if (this->glyph_to_sprite == nullptr) return bytes;
+
+	bytes += 256 * sizeof(GlyphEntry *);
+	for (int i = 0; i < 256; i++) {
+		if (this->glyph_to_sprite[i] == nullptr) continue;
+
+		bytes += 256 * sizeof(GlyphEntry);
+		for (int j = 0; j < 256; j++) {
+			if (this->glyph_to_sprite[i][j].sprite != nullptr && !this->glyph_to_sprite[i][j].duplicate) glyphs++;
+		}
+	}
+	return bytes;
+}
 
 TrueTypeFontCache::GlyphEntry *TrueTypeFontCache::GetGlyphPtr(GlyphID key)
 {
@@ -75,6 +75,7 @@ public:
 	const Sprite *GetGlyph(GlyphID key) override;
 	const void *GetFontTable(uint32 tag, size_t &length) override;
 	void ClearFontCache() override;
+	size_t GetMemoryUsage(uint &glyphs) const override;
 	uint GetGlyphWidth(GlyphID key) override;
 	bool GetDrawGlyphShadow() override;
 	bool IsBuiltInFont() override { return false; }
@@ -8,6 +8,7 @@
 /** @file framerate_gui.cpp GUI for displaying framerate/game speed information. */
 
 #include "framerate_type.h"
+#include "trace.h"
 #include <chrono>
 #include "gfx_func.h"
 #include "window_gui.h"
@@ -23,6 +24,12 @@
 #include "ai/ai_instance.hpp"
 #include "game/game.hpp"
 #include "game/game_instance.hpp"
+#include "viewport_func.h"
+#include "settings_type.h"
+#include "date_type.h"
+#include "spritecache.h"
+#include "newgrf_profiling.h"
+#include "crashlog.h"
 
 #include "widgets/framerate_widget.h"
 #include "safeguards.h"
@@ -189,6 +196,7 @@ namespace {
 		PerformanceData(1),                     // PFE_ACC_GL_AIRCRAFT
 		PerformanceData(1),                     // PFE_GL_LANDSCAPE
 		PerformanceData(1),                     // PFE_GL_LINKGRAPH
+		PerformanceData(1),                     // PFE_LINKGRAPH_JOBS
 		PerformanceData(1000.0 / 30),           // PFE_DRAWING
 		PerformanceData(1),                     // PFE_ACC_DRAWWORLD
 		PerformanceData(60.0),                  // PFE_VIDEO
@@ -212,6 +220,19 @@ namespace {
 		PerformanceData(1),                     // PFE_AI14
 	};
 
+	/** Interval in seconds between printing the performance summary to the console, 0 when disabled. */
+	uint _framerate_stream_interval = 0;
+	/** Number of data points the performance summary printed to the console is based on. */
+	uint _framerate_stream_count = NUM_FRAMERATE_POINTS;
+	/** Timestamp at which the performance summary will next be printed to the console. */
+	TimingMeasurement _framerate_stream_next = 0;
+
+	/** Number of zones per thread kept by the trace started for the slow tick log. */
+	const uint SLOW_TICK_TRACE_EVENTS = 1 << 14;
+	/** Minimum interval in seconds between slow tick logs. */
+	const uint SLOW_TICK_LOG_INTERVAL = 60;
+
+	void PrintFramerateStream();
 }
 
 
@@ -220,7 +241,7 @@ namespace {
  * The basis of the timestamp is implementation defined, but the value should be steady,
  * so differences can be taken to reliably measure intervals.
  */
-static TimingMeasurement GetPerformanceTimer()
+TimingMeasurement GetPerformanceTimer()
 {
 	using namespace std::chrono;
 	return (TimingMeasurement)time_point_cast<microseconds>(high_resolution_clock::now()).time_since_epoch().count();
@@ -240,6 +261,36 @@ PerformanceMeasurer::PerformanceMeasurer(PerformanceElement elem)
 }
 
 /** Finish a cycle of a measured element and store the measurement taken. */
+/**
+ * Write a slow tick log when a game tick took longer than the threshold.
+ * This also keeps a small trace running, so that the log can include the zones of the slow tick.
+ * @param start_time Start of the tick.
+ * @param end_time End of the tick.
+ */
+static void CheckSlowTick(TimingMeasurement start_time, TimingMeasurement end_time)
+{
+	static bool trace_started = false;
+	static TimingMeasurement next_log = 0;
+
+	/* Only start the trace once, so that a trace stopped by the trace console command is not overwritten. */
+	if (!trace_started) {
+		trace_started = true;
+		if (!_trace_enabled) StartTrace(SLOW_TICK_TRACE_EVENTS);
+	}
+
+	const TimingMeasurement threshold = (TimingMeasurement)_settings_client.network.slow_tick_log_threshold * 1000;
+	if (end_time - start_time < threshold || end_time < next_log) return;
+
+	/* Rate limit the logs, a run of slow ticks is very likely to have a single cause. */
+	next_log = end_time + SLOW_TICK_LOG_INTERVAL * TIMESTAMP_PRECISION;
+
+	SlowTickExtraInfo info;
+	info.start = start_time * 1000;
+	info.end = end_time * 1000;
+	info.threshold = threshold * 1000;
+	CrashLog::SlowTickLog(info);
+}
+
 PerformanceMeasurer::~PerformanceMeasurer()
 {
 	if (this->elem == PFE_ALLSCRIPTS) {
@@ -251,7 +302,15 @@ PerformanceMeasurer::~PerformanceMeasurer()
 			return;
 		}
 	}
-	_pf_data[this->elem].Add(this->start_time, GetPerformanceTimer());
+	TimingMeasurement end_time = GetPerformanceTimer();
+	_pf_data[this->elem].Add(this->start_time, end_time);
+	if (_trace_enabled) RecordTraceZone(GetPerformanceElementKey(this->elem), this->start_time * 1000, end_time * 1000);
+
+	if (this->elem == PFE_GAMELOOP && _framerate_stream_interval != 0 && end_time >= _framerate_stream_next) {
+		_framerate_stream_next = end_time + _framerate_stream_interval * TIMESTAMP_PRECISION;
+		PrintFramerateStream();
+	}
+	if (this->elem == PFE_GAMELOOP && _settings_client.network.slow_tick_log_threshold != 0) CheckSlowTick(this->start_time, end_time);
 }
 
 /** Set the rate of expected cycles per second of a performance element. */
@@ -277,6 +336,20 @@ void PerformanceMeasurer::SetExpectedRate(double rate)
 	_pf_data[elem].AddPause(GetPerformanceTimer());
 }
 
+/**
+ * Record a measurement which was taken elsewhere, for example in another thread.
+ * This must only be called from the main thread.
+ * @param elem The element to record the measurement for
+ * @param start_time Start time of the measured block, from GetPerformanceTimer
+ * @param end_time End time of the measured block, from GetPerformanceTimer
+ */
+/* static */ void PerformanceMeasurer::AddMeasurement(PerformanceElement elem, TimingMeasurement start_time, TimingMeasurement end_time)
+{
+	assert(elem < PFE_MAX);
+
+	_pf_data[elem].Add(start_time, end_time);
+}
+
 
 /**
  * Begin measuring one block of the accumulating value.
@@ -293,7 +366,9 @@ PerformanceAccumulator::PerformanceAccumulator(PerformanceElement elem)
 /** Finish and add one block of the accumulating value. */
 PerformanceAccumulator::~PerformanceAccumulator()
 {
-	_pf_data[this->elem].AddAccumulate(GetPerformanceTimer() - this->start_time);
+	TimingMeasurement end_time = GetPerformanceTimer();
+	_pf_data[this->elem].AddAccumulate(end_time - this->start_time);
+	if (_trace_enabled) RecordTraceZone(GetPerformanceElementKey(this->elem), this->start_time * 1000, end_time * 1000);
 }
 
 /**
@@ -336,6 +411,7 @@ static const PerformanceElement DISPLAY_ORDER_PFE[PFE_MAX] = {
 	PFE_AI13,
 	PFE_AI14,
 	PFE_GL_LINKGRAPH,
+	PFE_LINKGRAPH_JOBS,
 	PFE_DRAWING,
 	PFE_DRAWWORLD,
 	PFE_VIDEO,
@@ -361,6 +437,10 @@ static const NWidgetPart _framerate_window_widgets[] = {
 			NWidget(WWT_TEXT, COLOUR_GREY, WID_FRW_RATE_GAMELOOP), SetDataTip(STR_FRAMERATE_RATE_GAMELOOP, STR_FRAMERATE_RATE_GAMELOOP_TOOLTIP), SetFill(1, 0), SetResize(1, 0),
 			NWidget(WWT_TEXT, COLOUR_GREY, WID_FRW_RATE_DRAWING),  SetDataTip(STR_FRAMERATE_RATE_BLITTER,  STR_FRAMERATE_RATE_BLITTER_TOOLTIP), SetFill(1, 0), SetResize(1, 0),
 			NWidget(WWT_TEXT, COLOUR_GREY, WID_FRW_RATE_FACTOR),   SetDataTip(STR_FRAMERATE_SPEED_FACTOR,  STR_FRAMERATE_SPEED_FACTOR_TOOLTIP), SetFill(1, 0), SetResize(1, 0),
+			NWidget(WWT_TEXT, COLOUR_GREY, WID_FRW_RATE_DIRTY_RECTS), SetDataTip(STR_FRAMERATE_DIRTY_RECTS, STR_FRAMERATE_DIRTY_RECTS_TOOLTIP), SetFill(1, 0), SetResize(1, 0),
+			NWidget(WWT_TEXT, COLOUR_GREY, WID_FRW_RATE_DIRTY_AREA), SetDataTip(STR_FRAMERATE_DIRTY_AREA, STR_FRAMERATE_DIRTY_AREA_TOOLTIP), SetFill(1, 0), SetResize(1, 0),
+			NWidget(WWT_TEXT, COLOUR_GREY, WID_FRW_RATE_SPRITE_CACHE), SetDataTip(STR_FRAMERATE_SPRITE_CACHE, STR_FRAMERATE_SPRITE_CACHE_TOOLTIP), SetFill(1, 0), SetResize(1, 0),
+			NWidget(WWT_TEXT, COLOUR_GREY, WID_FRW_RATE_NEWGRF_SAMPLES), SetDataTip(STR_FRAMERATE_NEWGRF_SAMPLES, STR_FRAMERATE_NEWGRF_SAMPLES_TOOLTIP), SetFill(1, 0), SetResize(1, 0),
 		EndContainer(),
 	EndContainer(),
 	NWidget(NWID_HORIZONTAL),
@@ -470,8 +550,10 @@ struct FramerateWindow : Window {
 
 		int new_active = 0;
 		for (PerformanceElement e = PFE_FIRST; e < PFE_MAX; e++) {
-			this->times_shortterm[e].SetTime(_pf_data[e].GetAverageDurationMilliseconds(8), MILLISECONDS_PER_TICK);
-			this->times_longterm[e].SetTime(_pf_data[e].GetAverageDurationMilliseconds(NUM_FRAMERATE_POINTS), MILLISECONDS_PER_TICK);
+			/* Link graph jobs run in the background, they only need to finish within the recalculation time. */
+			double target = (e == PFE_LINKGRAPH_JOBS) ? (double)_settings_game.linkgraph.recalc_time * DAY_TICKS * MILLISECONDS_PER_TICK : MILLISECONDS_PER_TICK;
+			this->times_shortterm[e].SetTime(_pf_data[e].GetAverageDurationMilliseconds(8), target);
+			this->times_longterm[e].SetTime(_pf_data[e].GetAverageDurationMilliseconds(NUM_FRAMERATE_POINTS), target);
 			if (_pf_data[e].num_valid > 0) {
 				new_active++;
 				if (e == PFE_GAMESCRIPT || e >= PFE_AI0) have_script = true;
@@ -515,6 +597,28 @@ struct FramerateWindow : Window {
 			case WID_FRW_RATE_FACTOR:
 				this->speed_gameloop.InsertDParams(0);
 				break;
+			case WID_FRW_RATE_DIRTY_RECTS:
+				SetDParam(0, _viewport_dirty_batch_stats.rects_in);
+				SetDParam(1, _viewport_dirty_batch_stats.rects_out);
+				break;
+			case WID_FRW_RATE_DIRTY_AREA: {
+				const uint64 screen_pixels = (uint64)_screen.width * _screen.height;
+				SetDParam(0, _viewport_dirty_area_stats.rects);
+				SetDParam(1, screen_pixels > 0 ? (_viewport_dirty_area_stats.pixels * 100) / screen_pixels : 0);
+				SetDParam(2, _viewport_dirty_area_stats.columns_scanned);
+				SetDParam(3, _viewport_dirty_area_stats.columns_total);
+				break;
+			}
+			case WID_FRW_RATE_SPRITE_CACHE:
+				SetDParam(0, GetSpriteCacheUsage());
+				SetDParam(1, _sprite_cache_stats.hits);
+				SetDParam(2, _sprite_cache_stats.misses);
+				break;
+			case WID_FRW_RATE_NEWGRF_SAMPLES:
+				SetDParam(0, (int64)(NewGRFSampleProfiler::GetEstimatedMillisecondsPerTick() * 100));
+				SetDParam(1, 2);
+				SetDParam(2, NewGRFSampleProfiler::total_samples);
+				break;
 			case WID_FRW_INFO_DATA_POINTS:
 				SetDParam(0, NUM_FRAMERATE_POINTS);
 				break;
@@ -541,6 +645,30 @@ struct FramerateWindow : Window {
 				SetDParam(1, 2);
 				*size = GetStringBoundingBox(STR_FRAMERATE_SPEED_FACTOR);
 				break;
+			case WID_FRW_RATE_DIRTY_RECTS:
+				SetDParam(0, 999999);
+				SetDParam(1, 999999);
+				*size = GetStringBoundingBox(STR_FRAMERATE_DIRTY_RECTS);
+				break;
+			case WID_FRW_RATE_DIRTY_AREA:
+				SetDParam(0, 999999);
+				SetDParam(1, 100);
+				SetDParam(2, 999999);
+				SetDParam(3, 999999);
+				*size = GetStringBoundingBox(STR_FRAMERATE_DIRTY_AREA);
+				break;
+			case WID_FRW_RATE_SPRITE_CACHE:
+				SetDParam(0, 999999999);
+				SetDParam(1, 999999999);
+				SetDParam(2, 999999999);
+				*size = GetStringBoundingBox(STR_FRAMERATE_SPRITE_CACHE);
+				break;
+			case WID_FRW_RATE_NEWGRF_SAMPLES:
+				SetDParam(0, 999999);
+				SetDParam(1, 2);
+				SetDParam(2, 999999999);
+				*size = GetStringBoundingBox(STR_FRAMERATE_NEWGRF_SAMPLES);
+				break;
 
 			case WID_FRW_TIMES_NAMES: {
 				size->width = 0;
@@ -1033,6 +1161,7 @@ void ConPrintFramerate()
 		"  GL aircraft ticks",
 		"  GL landscape ticks",
 		"  GL link graph delays",
+		"Link graph jobs",
 		"Drawing",
 		"  Viewport drawing",
 		"Video output",
@@ -1078,3 +1207,109 @@ void ConPrintFramerate()
 		IConsoleWarning("No performance measurements have been taken yet");
 	}
 }
+
+/**
+ * Get the number of data points which are kept for each performance element.
+ * @return The maximum number of data points the statistics can be based on.
+ */
+uint GetPerformanceDataPointCount()
+{
+	return NUM_FRAMERATE_POINTS;
+}
+
+/**
+ * Get a short identifier of a performance element, for machine readable output.
+ * @param elem The element.
+ * @return The identifier.
+ */
+const char *GetPerformanceElementKey(PerformanceElement elem)
+{
+	static const char * const keys[PFE_MAX] = {
+		"gameloop",
+		"gl_economy",
+		"gl_trains",
+		"gl_roadvehs",
+		"gl_ships",
+		"gl_aircraft",
+		"gl_landscape",
+		"gl_linkgraph",
+		"linkgraph_jobs",
+		"drawing",
+		"drawworld",
+		"video",
+		"sound",
+		"allscripts",
+		"gamescript",
+		"ai1", "ai2", "ai3", "ai4", "ai5", "ai6", "ai7", "ai8",
+		"ai9", "ai10", "ai11", "ai12", "ai13", "ai14", "ai15",
+	};
+	assert(elem < PFE_MAX);
+	return keys[elem];
+}
+
+/**
+ * Get the average and percentiles of the most recent durations of a performance element.
+ * @param elem The element.
+ * @param count The maximum number of most recent data points to base the statistics on.
+ * @param[out] summary The statistics.
+ * @return Whether there are any valid data points.
+ */
+bool GetPerformanceSummary(PerformanceElement elem, uint count, PerformanceSummary &summary)
+{
+	assert(elem < PFE_MAX);
+	auto &pf = _pf_data[elem];
+
+	int points = std::min<int>(count, pf.num_valid);
+	int first_point = pf.prev_index - points;
+	if (first_point < 0) first_point += NUM_FRAMERATE_POINTS;
+
+	TimingMeasurement durations[NUM_FRAMERATE_POINTS];
+	uint samples = 0;
+	TimingMeasurement total = 0;
+	for (int i = first_point; i < first_point + points; i++) {
+		TimingMeasurement d = pf.durations[i % NUM_FRAMERATE_POINTS];
+		if (d == PerformanceData::INVALID_DURATION) continue;
+		durations[samples++] = d;
+		total += d;
+	}
+	if (samples == 0) return false;
+
+	std::sort(durations, durations + samples);
+	auto to_ms = [](TimingMeasurement d) -> double { return (double)d * 1000 / TIMESTAMP_PRECISION; };
+	auto percentile = [&](uint pct) -> double { return to_ms(durations[std::min(samples - 1, (samples * pct) / 100)]); };
+
+	summary.samples = samples;
+	summary.rate = pf.GetRate();
+	summary.average = to_ms(total) / samples;
+	summary.p50 = percentile(50);
+	summary.p95 = percentile(95);
+	summary.p99 = percentile(99);
+	summary.max = to_ms(durations[samples - 1]);
+	return true;
+}
+
+namespace {
+	/** Print the performance summary of all measured elements to the console, in a machine readable format. */
+	void PrintFramerateStream()
+	{
+		for (PerformanceElement e = PFE_FIRST; e < PFE_MAX; e++) {
+			PerformanceSummary summary;
+			if (!GetPerformanceSummary(e, _framerate_stream_count, summary)) continue;
+			IConsolePrintF(CC_DEFAULT, "perf %s n=%u rate=%.2f avg=%.3f p50=%.3f p95=%.3f p99=%.3f max=%.3f",
+				GetPerformanceElementKey(e), summary.samples, summary.rate, summary.average, summary.p50, summary.p95, summary.p99, summary.max);
+		}
+	}
+}
+
+/**
+ * Set up printing the performance summary to the console periodically.
+ * @param interval Interval in seconds, 0 to stop printing periodically and to print once now instead.
+ * @param count The maximum number of most recent data points to base the statistics on.
+ */
+void SetFramerateStream(uint interval, uint count)
+{
+	_framerate_stream_interval = interval;
+	_framerate_stream_count = Clamp<uint>(count, 1, NUM_FRAMERATE_POINTS);
+	_framerate_stream_next = 0;
+	if (interval == 0) PrintFramerateStream();
+}
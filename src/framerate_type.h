@@ -54,6 +54,7 @@ enum PerformanceElement {
 	PFE_GL_AIRCRAFT,   ///< Time spent processing aircraft
 	PFE_GL_LANDSCAPE,  ///< Time spent processing other world features
 	PFE_GL_LINKGRAPH,  ///< Time spent waiting for link graph background jobs
+	PFE_LINKGRAPH_JOBS, ///< Run time of link graph background jobs
 	PFE_DRAWING,       ///< Speed of drawing world and GUI.
 	PFE_DRAWWORLD,     ///< Time spent drawing world viewports in GUI
 	PFE_VIDEO,         ///< Speed of painting drawn video buffer.
@@ -98,6 +99,7 @@ public:
 	void SetExpectedRate(double rate);
 	static void SetInactive(PerformanceElement elem);
 	static void Paused(PerformanceElement elem);
+	static void AddMeasurement(PerformanceElement elem, TimingMeasurement start_time, TimingMeasurement end_time);
 };
 
 /**
@@ -120,6 +122,22 @@ public:
 	static void Reset(PerformanceElement elem);
 };
 
+/** Statistics of the recent measurements of a performance element, durations are in milliseconds. */
+struct PerformanceSummary {
+	uint samples;   ///< Number of valid data points the statistics are based on.
+	double rate;    ///< Measured number of cycles per second.
+	double average; ///< Average duration.
+	double p50;     ///< Median duration.
+	double p95;     ///< 95th percentile of the durations.
+	double p99;     ///< 99th percentile of the durations.
+	double max;     ///< Longest duration.
+};
+
+TimingMeasurement GetPerformanceTimer();
 void ShowFramerateWindow();
+bool GetPerformanceSummary(PerformanceElement elem, uint count, PerformanceSummary &summary);
+const char *GetPerformanceElementKey(PerformanceElement elem);
+uint GetPerformanceDataPointCount();
+void SetFramerateStream(uint interval, uint count);
 
 #endif /* FRAMERATE_TYPE_H */
@@ -24,6 +24,7 @@
 #include "widget_type.h"
 #include "window_gui.h"
 #include "framerate_type.h"
+#include "trace.h"
 #include "transparency.h"
 #include "core/backup_type.hpp"
 #include "viewport_func.h"
@@ -508,6 +509,77 @@ static void SetColourRemap(TextColour colour)
  * @return In case of left or center alignment the right most pixel we have drawn to.
  *         In case of right alignment the left most pixel we have drawn to.
  */
+/** Glyph to draw with #GfxBlitGlyphRun. */
+struct GlyphRunBlitItem {
+	const Sprite *sprite; ///< Sprite of the glyph.
+	int x;                ///< X position of the glyph.
+	int y;                ///< Y position of the glyph.
+	bool shadow;          ///< Whether the glyph has a shadow.
+};
+
+/** Glyphs of the visual run being drawn, kept to avoid reallocating for each run. */
+static std::vector<GlyphRunBlitItem> _glyph_run_blit_items;
+
+/**
+ * Draw a run of glyph sprites at normal zoom to the current DrawPixelInfo, using the current colour remap.
+ * This performs the same clipping as #GfxMainBlitter, but sets up the blitter parameters common to all glyphs only once.
+ * @param items The glyphs to draw.
+ * @param shadow Whether to draw the shadows of the glyphs instead of the glyphs.
+ */
+static void GfxBlitGlyphRun(const std::vector<GlyphRunBlitItem> &items, bool shadow)
+{
+	const DrawPixelInfo *dpi = _cur_dpi;
+	Blitter *blitter = BlitterFactory::GetCurrentBlitter();
+
+	Blitter::BlitterParams bp;
+	bp.dst = dpi->dst_ptr;
+	bp.pitch = dpi->pitch;
+	bp.remap = _colour_remap_ptr;
+	bp.brightness_adjust = _sprite_brightness_adjust;
+
+	const int offset = shadow ? 1 : 0;
+	for (const GlyphRunBlitItem &item : items) {
+		if (shadow && !item.shadow) continue;
+
+		const Sprite *sprite = item.sprite;
+		if (sprite->width <= 0 || sprite->height <= 0) continue;
+
+		int x = item.x + offset + sprite->x_offs - dpi->left;
+		int y = item.y + offset + sprite->y_offs - dpi->top;
+
+		bp.skip_left = 0;
+		bp.skip_top = 0;
+		bp.width = sprite->width;
+		bp.height = sprite->height;
+		bp.left = x;
+		bp.top = y;
+
+		/* Check for top and bottom overflow */
+		if (y < 0) {
+			bp.height += y;
+			bp.skip_top = -y;
+			bp.top = 0;
+		}
+		if (bp.top + bp.height > dpi->height) bp.height = dpi->height - bp.top;
+		if (bp.height <= 0) continue;
+
+		/* Check for left and right overflow */
+		if (x < 0) {
+			bp.width += x;
+			bp.skip_left = -x;
+			bp.left = 0;
+		}
+		if (bp.left + bp.width > dpi->width) bp.width = dpi->width - bp.left;
+		if (bp.width <= 0) continue;
+
+		bp.sprite = sprite->data;
+		bp.sprite_width = sprite->width;
+		bp.sprite_height = sprite->height;
+
+		blitter->Draw(&bp, BM_COLOUR_REMAP, ZOOM_LVL_NORMAL);
+	}
+}
+
 static int DrawLayoutLine(const ParagraphLayouter::Line &line, int y, int left, int right, StringAlignment align, bool underline, bool truncation)
 {
 	if (line.CountRuns() == 0) return 0;
@@ -603,6 +675,8 @@ static int DrawLayoutLine(const ParagraphLayouter::Line &line, int y, int left,
 
 		draw_shadow = fc->GetDrawGlyphShadow() && (colour & TC_NO_SHADE) == 0 && colour != TC_BLACK;
 
+		_glyph_run_blit_items.clear();
+		bool any_shadow = false;
 		for (int i = 0; i < run.GetGlyphCount(); i++) {
 			GlyphID glyph = run.GetGlyphs()[i];
 
@@ -620,13 +694,18 @@ static int DrawLayoutLine(const ParagraphLayouter::Line &line, int y, int left,
 			/* Check clipping (the "+ 1" is for the shadow). */
 			if (begin_x + sprite->x_offs > dpi_right || begin_x + sprite->x_offs + sprite->width /* - 1 + 1 */ < dpi_left) continue;
 
-			if (draw_shadow && (glyph & SPRITE_GLYPH) == 0) {
-				SetColourRemap(TC_BLACK);
-				GfxMainBlitter(sprite, begin_x + 1, top + 1, BM_COLOUR_REMAP);
-				SetColourRemap(colour);
-			}
-			GfxMainBlitter(sprite, begin_x, top, BM_COLOUR_REMAP);
+			bool shadow = draw_shadow && (glyph & SPRITE_GLYPH) == 0;
+			any_shadow |= shadow;
+			_glyph_run_blit_items.push_back({ sprite, begin_x, top, shadow });
+		}
+
+		/* Draw the shadows of the whole run first, so that only two colour remaps are needed */
+		if (any_shadow) {
+			SetColourRemap(TC_BLACK);
+			GfxBlitGlyphRun(_glyph_run_blit_items, true);
+			SetColourRemap(colour);
 		}
+		GfxBlitGlyphRun(_glyph_run_blit_items, false);
 	}
 
 	if (truncation) {
@@ -1691,6 +1770,8 @@ static void DrawOverlappedWindowWithClipping(Window *w, int left, int top, int r
  */
 void DrawDirtyBlocks()
 {
+	TRACE_ZONE("DrawDirtyBlocks");
+
 	static std::vector<NWidgetBase *> dirty_widgets;
 
 	extern void ViewportPrepareVehicleRoute();
@@ -1717,6 +1798,8 @@ void DrawDirtyBlocks()
 		DrawPixelInfo bk;
 		_cur_dpi = &bk;
 
+		ViewportDirtyAreaStats area_stats;
+
 		for (Window *w : Window::IterateFromBack()) {
 			w->flags &= ~WF_DRAG_DIRTIED;
 			if (!MayBeShown(w)) continue;
@@ -1796,66 +1879,79 @@ void DrawDirtyBlocks()
 						}
 					}
 
+					BeginViewportSignGather(vp);
+
 					const uint grid_w = vp->dirty_blocks_per_row;
 					const uint grid_h = vp->dirty_blocks_per_column;
-
-					uint pos = 0;
-					uint x = 0;
-					do {
-						uint y = 0;
-						do {
-							if (vp->dirty_blocks[pos]) {
-								uint left = x;
-								uint top = y;
-								uint right = x + 1;
-								uint bottom = y;
-								uint p = pos;
-
-								/* First try coalescing downwards */
-								do {
-									vp->dirty_blocks[p] = false;
-									p++;
-									bottom++;
-								} while (bottom != grid_h && vp->dirty_blocks[p]);
-
-								/* Try coalescing to the right too. */
-								uint block_h = (bottom - y);
-								p = pos;
-
-								while (right != grid_w) {
-									uint p2 = (p += grid_h);
-									uint check_h = block_h;
-									/* Check if a full line of dirty flags is set. */
+					area_stats.columns_total += grid_w;
+
+					/* Only scan the columns which are flagged in the column summary, a word at a time. */
+					for (uint word = 0; word < (uint)vp->dirty_block_columns.size(); word++) {
+						uint64 columns = vp->dirty_block_columns[word];
+						while (columns != 0) {
+							const uint x = (word * 64) + FindFirstBit(columns);
+							columns &= columns - 1;
+							area_stats.columns_scanned++;
+
+							uint pos = x * grid_h;
+							uint y = 0;
+							do {
+								if (vp->dirty_blocks[pos]) {
+									uint left = x;
+									uint top = y;
+									uint right = x + 1;
+									uint bottom = y;
+									uint p = pos;
+
+									/* First try coalescing downwards */
 									do {
-										if (!vp->dirty_blocks[p2]) goto no_more_coalesc;
-										p2++;
-									} while (--check_h != 0);
-
-									/* Wohoo, can combine it one step to the right!
-									 * Do that, and clear the bits. */
-									right++;
-
-									check_h = block_h;
-									p2 = p;
-									do {
-										vp->dirty_blocks[p2] = false;
-										p2++;
-									} while (--check_h != 0);
-								}
-								no_more_coalesc:
-
-								assert(_cur_dpi == &bk);
-								int draw_left = std::max<int>(0, ((left == 0) ? 0 : vp->dirty_block_left_margin + (left << vp->GetDirtyBlockWidthShift())) + vp->left);
-								int draw_top = std::max<int>(0, (top << vp->GetDirtyBlockHeightShift()) + vp->top);
-								int draw_right = std::min<int>(_screen.width, std::min<int>((right << vp->GetDirtyBlockWidthShift()) + vp->dirty_block_left_margin, vp->width) + vp->left);
-								int draw_bottom = std::min<int>(_screen.height, std::min<int>(bottom << vp->GetDirtyBlockHeightShift(), vp->height) + vp->top);
-								if (draw_left < draw_right && draw_top < draw_bottom) {
-									DrawDirtyViewport(0, draw_left, draw_top, draw_right, draw_bottom);
+										vp->dirty_blocks[p] = false;
+										p++;
+										bottom++;
+									} while (bottom != grid_h && vp->dirty_blocks[p]);
+
+									/* Try coalescing to the right too. */
+									uint block_h = (bottom - y);
+									p = pos;
+
+									while (right != grid_w) {
+										uint p2 = (p += grid_h);
+										uint check_h = block_h;
+										/* Check if a full line of dirty flags is set. */
+										do {
+											if (!vp->dirty_blocks[p2]) goto no_more_coalesc;
+											p2++;
+										} while (--check_h != 0);
+
+										/* Wohoo, can combine it one step to the right!
+										 * Do that, and clear the bits. */
+										right++;
+
+										check_h = block_h;
+										p2 = p;
+										do {
+											vp->dirty_blocks[p2] = false;
+											p2++;
+										} while (--check_h != 0);
+									}
+									no_more_coalesc:
+
+									assert(_cur_dpi == &bk);
+									int draw_left = std::max<int>(0, ((left == 0) ? 0 : vp->dirty_block_left_margin + (left << vp->GetDirtyBlockWidthShift())) + vp->left);
+									int draw_top = std::max<int>(0, (top << vp->GetDirtyBlockHeightShift()) + vp->top);
+									int draw_right = std::min<int>(_screen.width, std::min<int>((right << vp->GetDirtyBlockWidthShift()) + vp->dirty_block_left_margin, vp->width) + vp->left);
+									int draw_bottom = std::min<int>(_screen.height, std::min<int>(bottom << vp->GetDirtyBlockHeightShift(), vp->height) + vp->top);
+									if (draw_left < draw_right && draw_top < draw_bottom) {
+										DrawDirtyViewport(0, draw_left, draw_top, draw_right, draw_bottom);
+										area_stats.rects++;
+										area_stats.pixels += (uint64)(draw_right - draw_left) * (draw_bottom - draw_top);
+									}
 								}
-							}
-						} while (pos++, ++y != grid_h);
-					} while (++x != grid_w);
+							} while (pos++, ++y != grid_h);
+						}
+					}
 
+					EndViewportSignGather();
 					_transparency_opt = to_backup;
 					w->viewport->ClearDirty();
 				}
@@ -1863,6 +1959,7 @@ void DrawDirtyBlocks()
 		}
 
 		_cur_dpi = old_dpi;
+		_viewport_dirty_area_stats = area_stats;
 
 		for (const Rect &r : _dirty_blocks) {
 			RedrawScreenRect(r.left, r.top, r.right, r.bottom);
@@ -2039,6 +2136,7 @@ void SetPendingDirtyBlocks(int left, int top, int right, int bottom)
 void MarkWholeScreenDirty()
 {
 	_whole_screen_dirty = true;
+	ClearViewportTileDrawCache();
 }
 
 /**
@@ -36,6 +36,9 @@ Layouter::LineCache *Layouter::linecache;
 /** Cache of Font instances. */
 Layouter::FontColourMap Layouter::fonts[FS_END];
 
+/** Cache of whether the digits of each font size have the same width. */
+int8 Layouter::digits_tabular[FS_END] = { -1, -1, -1, -1 };
+
 
 /**
  * Construct a new font.
@@ -256,7 +259,7 @@ public:
 		int glyph_count;  ///< The number of glyphs.
 
 	public:
-		FallbackVisualRun(Font *font, const WChar *chars, int glyph_count, int x);
+		FallbackVisualRun(Font *font, const WChar *chars, int glyph_count, int char_offset, int x);
 		FallbackVisualRun(FallbackVisualRun &&other) noexcept;
 		~FallbackVisualRun() override;
 		const Font *GetFont() const override;
@@ -328,9 +331,10 @@ public:
  * @param font       The font to use for this run.
  * @param chars      The characters to use for this run.
  * @param char_count The number of characters in this run.
+ * @param char_offset The offset of the first character of this run in the paragraph.
  * @param x          The initial x position for this run.
  */
-FallbackParagraphLayout::FallbackVisualRun::FallbackVisualRun(Font *font, const WChar *chars, int char_count, int x) :
+FallbackParagraphLayout::FallbackVisualRun::FallbackVisualRun(Font *font, const WChar *chars, int char_count, int char_offset, int x) :
 		font(font), glyph_count(char_count)
 {
 	this->glyphs = MallocT<GlyphID>(this->glyph_count);
@@ -345,7 +349,7 @@ FallbackParagraphLayout::FallbackVisualRun::FallbackVisualRun(Font *font, const
 		this->glyphs[i] = font->fc->MapCharToGlyph(chars[i]);
 		this->positions[2 * i + 2] = this->positions[2 * i] + font->fc->GetGlyphWidth(this->glyphs[i]);
 		this->positions[2 * i + 3] = 0;
-		this->glyph_to_char[i] = i;
+		this->glyph_to_char[i] = char_offset + i;
 	}
 }
 
@@ -509,7 +513,7 @@ std::unique_ptr<const ParagraphLayouter::Line> FallbackParagraphLayout::NextLine
 	if (*this->buffer == '\0') {
 		/* Only a newline. */
 		this->buffer = nullptr;
-		l->emplace_back(this->runs.front().second, this->buffer, 0, 0);
+		l->emplace_back(this->runs.front().second, this->buffer, 0, (int)(this->buffer - this->buffer_begin), 0);
 		return l;
 	}
 
@@ -538,7 +542,7 @@ std::unique_ptr<const ParagraphLayouter::Line> FallbackParagraphLayout::NextLine
 
 		if (this->buffer == next_run) {
 			int w = l->GetWidth();
-			l->emplace_back(iter->second, begin, this->buffer - begin, w);
+			l->emplace_back(iter->second, begin, this->buffer - begin, (int)(begin - this->buffer_begin), w);
 			iter++;
 			assert(iter != this->runs.End());
 
@@ -585,7 +589,7 @@ std::unique_ptr<const ParagraphLayouter::Line> FallbackParagraphLayout::NextLine
 
 	if (l->size() == 0 || last_char - begin != 0) {
 		int w = l->GetWidth();
-		l->emplace_back(iter->second, begin, last_char - begin, w);
+		l->emplace_back(iter->second, begin, last_char - begin, (int)(begin - this->buffer_begin), w);
 	}
 	return l;
 }
@@ -611,6 +615,7 @@ static inline void GetLayouter(Layouter::LineCacheItem &line, const char *&str,
 	Font *f = Layouter::GetFont(state.fontsize, state.cur_colour);
 
 	line.buffer = buff_begin;
+	line.digit_positions.clear();
 	fontMapping.clear();
 
 	/*
@@ -637,6 +642,7 @@ static inline void GetLayouter(Layouter::LineCacheItem &line, const char *&str,
 			 * will not be handled in the fallback non ICU case because they are
 			 * mostly needed for RTL languages which need more ICU support. */
 			if (!T::SUPPORTS_RTL && IsTextDirectionChar(c)) continue;
+			if (c >= '0' && c <= '9') line.digit_positions.push_back((int)(buff - buff_begin));
 			buff += T::AppendToBuffer(buff, buffer_last, c);
 			continue;
 		}
@@ -657,6 +663,112 @@ static inline void GetLayouter(Layouter::LineCacheItem &line, const char *&str,
 	line.state_after = state;
 }
 
+/**
+ * Line of a digit template layout, with the glyphs of the digits '0' of the template replaced by the actual digits.
+ * The digits of all fonts have the same width, so only the glyphs differ from the template line.
+ */
+class DigitSubstitutionLine : public ParagraphLayouter::Line {
+	/** Visual run of the template line with substituted glyphs. */
+	class DigitSubstitutionVisualRun : public ParagraphLayouter::VisualRun {
+		const ParagraphLayouter::VisualRun &run; ///< The template visual run.
+		std::vector<GlyphID> glyphs;             ///< The substituted glyphs.
+
+	public:
+		DigitSubstitutionVisualRun(const ParagraphLayouter::VisualRun &run, const std::vector<std::pair<int, WChar>> &substitutions) : run(run)
+		{
+			const GlyphID *template_glyphs = run.GetGlyphs();
+			const int *glyph_to_char = run.GetGlyphToCharMap();
+			this->glyphs.assign(template_glyphs, template_glyphs + run.GetGlyphCount());
+			for (size_t i = 0; i < this->glyphs.size(); i++) {
+				auto it = std::lower_bound(substitutions.begin(), substitutions.end(), glyph_to_char[i], [](const std::pair<int, WChar> &sub, int pos) { return sub.first < pos; });
+				if (it != substitutions.end() && it->first == glyph_to_char[i]) this->glyphs[i] = run.GetFont()->fc->MapCharToGlyph(it->second);
+			}
+		}
+
+		const Font *GetFont() const override { return this->run.GetFont(); }
+		int GetGlyphCount() const override { return this->run.GetGlyphCount(); }
+		const GlyphID *GetGlyphs() const override { return this->glyphs.data(); }
+		const float *GetPositions() const override { return this->run.GetPositions(); }
+		int GetLeading() const override { return this->run.GetLeading(); }
+		const int *GetGlyphToCharMap() const override { return this->run.GetGlyphToCharMap(); }
+	};
+
+	std::unique_ptr<const ParagraphLayouter::Line> line; ///< The template line.
+	std::vector<DigitSubstitutionVisualRun> runs;        ///< The runs with substituted glyphs.
+
+public:
+	/**
+	 * Create the substituted line.
+	 * @param line The template line.
+	 * @param substitutions Sorted buffer positions of the template digits to replace, and the replacement digits.
+	 */
+	DigitSubstitutionLine(std::unique_ptr<const ParagraphLayouter::Line> line, const std::vector<std::pair<int, WChar>> &substitutions) : line(std::move(line))
+	{
+		this->runs.reserve(this->line->CountRuns());
+		for (int i = 0; i < this->line->CountRuns(); i++) {
+			this->runs.emplace_back(this->line->GetVisualRun(i), substitutions);
+		}
+	}
+
+	int GetLeading() const override { return this->line->GetLeading(); }
+	int GetWidth() const override { return this->line->GetWidth(); }
+	int CountRuns() const override { return (int)this->runs.size(); }
+	const ParagraphLayouter::VisualRun &GetVisualRun(int run) const override { return this->runs[run]; }
+	int GetInternalCharLength(WChar c) const override { return this->line->GetInternalCharLength(c); }
+};
+
+/**
+ * Create the paragraph layout of a line, using the best available layouter.
+ * @param line The cache item to store the layout in.
+ * @param str The string to create the layout for, this is advanced past the laid out text.
+ * @param state The state of the font and color, this is updated to the state after the laid out text.
+ */
+static void GetParagraphLayout(Layouter::LineCacheItem &line, const char *&str, FontState &state)
+{
+	FontState old_state = state;
+#if defined(WITH_ICU_LX) || defined(WITH_UNISCRIBE) || defined(WITH_COCOA)
+	const char *old_str = str;
+#endif
+
+#ifdef WITH_ICU_LX
+	GetLayouter<ICUParagraphLayoutFactory>(line, str, state);
+	if (line.layout == nullptr) {
+		static bool warned = false;
+		if (!warned) {
+			DEBUG(misc, 0, "ICU layouter bailed on the font. Falling back to the fallback layouter");
+			warned = true;
+		}
+
+		state = old_state;
+		str = old_str;
+	}
+#endif
+
+#ifdef WITH_UNISCRIBE
+	if (line.layout == nullptr) {
+		GetLayouter<UniscribeParagraphLayoutFactory>(line, str, state);
+		if (line.layout == nullptr) {
+			state = old_state;
+			str = old_str;
+		}
+	}
+#endif
+
+#ifdef WITH_COCOA
+	if (line.layout == nullptr) {
+		GetLayouter<CoreTextParagraphLayoutFactory>(line, str, state);
+		if (line.layout == nullptr) {
+			state = old_state;
+			str = old_str;
+		}
+	}
+#endif
+
+	if (line.layout == nullptr) {
+		GetLayouter<FallbackParagraphLayoutFactory>(line, str, state);
+	}
+}
+
 /**
  * Create a new layouter.
  * @param str      The string to create the layout for.
@@ -678,55 +790,44 @@ Layouter::Layouter(const char *str, int maxw, TextColour colour, FontSize fontsi
 			lineend += len;
 		}
 
-		LineCacheItem& line = GetCachedParagraphLayout(str, lineend - str, state);
+		/* Lines containing digits share the layout of the line with all digits replaced by '0', the actual digit glyphs are substituted in afterwards */
+		static std::string digit_template;
+		static std::vector<std::pair<int, WChar>> digit_substitutions;
+		digit_substitutions.clear();
+		const char *line_start = str;
+		const char *line_str = str;
+		size_t line_len = lineend - str;
+		const bool use_digit_template = line_len < (size_t)DRAW_STRING_BUFFER && std::any_of(str, lineend, [](char ch) { return ch >= '0' && ch <= '9'; }) && AreDigitsTabular();
+		if (use_digit_template) {
+			digit_template.assign(str, line_len);
+			for (char &ch : digit_template) {
+				if (ch >= '1' && ch <= '9') ch = '0';
+			}
+			line_str = digit_template.c_str();
+		}
+
+		LineCacheItem& line = GetCachedParagraphLayout(line_str, line_len, state);
 		if (line.layout != nullptr) {
 			/* Line is in cache */
 			str = lineend + 1;
 			state = line.state_after;
 			line.layout->Reflow();
+		} else if (use_digit_template) {
+			/* Digit template line is new, layout it */
+			GetParagraphLayout(line, line_str, state);
+			str = lineend + 1;
 		} else {
 			/* Line is new, layout it */
-			FontState old_state = state;
-#if defined(WITH_ICU_LX) || defined(WITH_UNISCRIBE) || defined(WITH_COCOA)
-			const char *old_str = str;
-#endif
-
-#ifdef WITH_ICU_LX
-			GetLayouter<ICUParagraphLayoutFactory>(line, str, state);
-			if (line.layout == nullptr) {
-				static bool warned = false;
-				if (!warned) {
-					DEBUG(misc, 0, "ICU layouter bailed on the font. Falling back to the fallback layouter");
-					warned = true;
-				}
-
-				state = old_state;
-				str = old_str;
-			}
-#endif
-
-#ifdef WITH_UNISCRIBE
-			if (line.layout == nullptr) {
-				GetLayouter<UniscribeParagraphLayoutFactory>(line, str, state);
-				if (line.layout == nullptr) {
-					state = old_state;
-					str = old_str;
-				}
-			}
-#endif
-
-#ifdef WITH_COCOA
-			if (line.layout == nullptr) {
-				GetLayouter<CoreTextParagraphLayoutFactory>(line, str, state);
-				if (line.layout == nullptr) {
-					state = old_state;
-					str = old_str;
-				}
-			}
-#endif
+			GetParagraphLayout(line, str, state);
+		}
 
-			if (line.layout == nullptr) {
-				GetLayouter<FallbackParagraphLayoutFactory>(line, str, state);
+		if (use_digit_template) {
+			/* The digits of the source line are single byte characters, in the same order as the digit positions in the template buffer */
+			size_t digit = 0;
+			for (const char *p = line_start; p != lineend && digit < line.digit_positions.size(); p++) {
+				if (*p < '0' || *p > '9') continue;
+				if (*p != '0') digit_substitutions.emplace_back(line.digit_positions[digit], (WChar)*p);
+				digit++;
 			}
 		}
 
@@ -734,6 +835,7 @@ Layouter::Layouter(const char *str, int maxw, TextColour colour, FontSize fontsi
 		for (;;) {
 			auto l = line.layout->NextLine(maxw);
 			if (l == nullptr) break;
+			if (!digit_substitutions.empty()) l = std::make_unique<DigitSubstitutionLine>(std::move(l), digit_substitutions);
 			this->push_back(std::move(l));
 		}
 	} while (c != '\0');
@@ -851,6 +953,26 @@ Font *Layouter::GetFont(FontSize size, TextColour colour)
 	return f;
 }
 
+/**
+ * Check whether the digits of all font sizes have the same width, such that lines can share the layout of their digit template line.
+ * @return true if the digits of all font sizes have the same width.
+ */
+bool Layouter::AreDigitsTabular()
+{
+	for (FontSize fs = FS_BEGIN; fs < FS_END; fs++) {
+		if (digits_tabular[fs] < 0) {
+			FontCache *fc = FontCache::Get(fs);
+			uint width = fc->GetGlyphWidth(fc->MapCharToGlyph('0'));
+			digits_tabular[fs] = 1;
+			for (WChar c = '1'; c <= '9'; c++) {
+				if (fc->GetGlyphWidth(fc->MapCharToGlyph(c)) != width) digits_tabular[fs] = 0;
+			}
+		}
+		if (digits_tabular[fs] == 0) return false;
+	}
+	return true;
+}
+
 /**
  * Reset cached font information.
  * @param size Font size to reset.
@@ -861,6 +983,7 @@ void Layouter::ResetFontCache(FontSize size)
 		delete pair.second;
 	}
 	fonts[size].clear();
+	digits_tabular[size] = -1;
 
 	/* We must reset the linecache since it references the just freed fonts */
 	ResetLineCache();
@@ -187,6 +187,7 @@ public:
 
 		FontState state_after;     ///< Font state after the line.
 		ParagraphLayouter *layout; ///< Layout of the line.
+		std::vector<int> digit_positions; ///< Buffer positions of the digits of the line, used when this is a digit template line.
 
 		LineCacheItem() : buffer(nullptr), layout(nullptr) {}
 		~LineCacheItem() { delete layout; free(buffer); }
@@ -196,9 +197,11 @@ private:
 	static LineCache *linecache;
 
 	static LineCacheItem &GetCachedParagraphLayout(const char *str, size_t len, const FontState &state);
+	static bool AreDigitsTabular();
 
 	typedef SmallMap<TextColour, Font *> FontColourMap;
 	static FontColourMap fonts[FS_END];
+	static int8 digits_tabular[FS_END]; ///< Whether all digits of the font size have the same width: 1 yes, 0 no, -1 unknown.
 public:
 	static Font *GetFont(FontSize size, TextColour colour);
 
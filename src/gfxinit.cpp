@@ -342,6 +342,7 @@ static bool SwitchNewGRFBlitter()
 		{ "8bpp-optimized",  2,  8,  8,  8,  8 },
 		{ "40bpp-anim",      2,  8, 32,  8, 32 },
 #ifdef WITH_SSE
+		{ "32bpp-avx2",      0, 32, 32,  8, 32 },
 		{ "32bpp-sse4",      0, 32, 32,  8, 32 },
 		{ "32bpp-ssse3",     0, 32, 32,  8, 32 },
 		{ "32bpp-sse2",      0, 32, 32,  8, 32 },
@@ -526,6 +527,7 @@ void GfxLoadSprites()
 	GfxInitSpriteMem();
 	GfxInitPalettes();
 	LoadSpriteTables();
+	GfxDiscardRetainedSprites();
 	GfxDetermineMainColours();
 
 	UpdateRouteStepSpriteSize();
@@ -20,6 +20,8 @@
 
 #include "table/strings.h"
 
+#include <vector>
+
 #include "safeguards.h"
 
 /**
@@ -73,58 +75,93 @@ static inline byte RGBToGrayscale(byte red, byte green, byte blue)
 #include <png.h>
 
 /**
- * The PNG Heightmap loader.
+ * Get the grayscale values of the palette of a PNG image.
+ * @param png_ptr The PNG image.
+ * @param info_ptr The information of the PNG image.
+ * @param[out] gray_palette The grayscale value of each palette entry.
  */
-static void ReadHeightmapPNGImageData(byte *map, png_structp png_ptr, png_infop info_ptr)
+static void GetHeightmapPNGGrayPalette(png_structp png_ptr, png_infop info_ptr, byte *gray_palette)
 {
-	uint x, y;
-	byte gray_palette[256];
-	png_bytep *row_pointers = nullptr;
-	bool has_palette = png_get_color_type(png_ptr, info_ptr) == PNG_COLOR_TYPE_PALETTE;
-	uint channels = png_get_channels(png_ptr, info_ptr);
-
-	/* Get palette and convert it to grayscale */
-	if (has_palette) {
-		int i;
-		int palette_size;
-		png_color *palette;
-		bool all_gray = true;
+	int i;
+	int palette_size;
+	png_color *palette;
+	bool all_gray = true;
+
+	png_get_PLTE(png_ptr, info_ptr, &palette, &palette_size);
+	for (i = 0; i < palette_size && (palette_size != 16 || all_gray); i++) {
+		all_gray &= palette[i].red == palette[i].green && palette[i].red == palette[i].blue;
+		gray_palette[i] = RGBToGrayscale(palette[i].red, palette[i].green, palette[i].blue);
+	}
 
-		png_get_PLTE(png_ptr, info_ptr, &palette, &palette_size);
-		for (i = 0; i < palette_size && (palette_size != 16 || all_gray); i++) {
-			all_gray &= palette[i].red == palette[i].green && palette[i].red == palette[i].blue;
-			gray_palette[i] = RGBToGrayscale(palette[i].red, palette[i].green, palette[i].blue);
+	/**
+	 * For a non-gray palette of size 16 we assume that
+	 * the order of the palette determines the height;
+	 * the first entry is the sea (level 0), the second one
+	 * level 1, etc.
+	 */
+	if (palette_size == 16 && !all_gray) {
+		for (i = 0; i < palette_size; i++) {
+			gray_palette[i] = 256 * i / palette_size;
 		}
+	}
+}
 
-		/**
-		 * For a non-gray palette of size 16 we assume that
-		 * the order of the palette determines the height;
-		 * the first entry is the sea (level 0), the second one
-		 * level 1, etc.
-		 */
-		if (palette_size == 16 && !all_gray) {
-			for (i = 0; i < palette_size; i++) {
-				gray_palette[i] = 256 * i / palette_size;
-			}
+/**
+ * Convert a decoded row of a PNG image to 8-bit grayscale.
+ * @param pixel The destination of the grayscale row.
+ * @param row The decoded row.
+ * @param width The width of the image.
+ * @param channels Number of channels of the decoded row.
+ * @param gray_palette The grayscale palette, or \c nullptr if the image has no palette.
+ */
+static void ConvertHeightmapPNGRow(byte *pixel, const png_byte *row, uint width, uint channels, const byte *gray_palette)
+{
+	if (gray_palette != nullptr) {
+		for (uint x = 0; x < width; x++) *pixel++ = gray_palette[row[x * channels]];
+	} else if (channels == 3) {
+		for (uint x = 0; x < width; x++) {
+			*pixel++ = RGBToGrayscale(row[0], row[1], row[2]);
+			row += 3;
 		}
+	} else {
+		for (uint x = 0; x < width; x++) *pixel++ = row[x * channels];
 	}
+}
 
-	row_pointers = png_get_rows(png_ptr, info_ptr);
-
-	/* Read the raw image data and convert in 8-bit grayscale */
-	for (x = 0; x < png_get_image_width(png_ptr, info_ptr); x++) {
-		for (y = 0; y < png_get_image_height(png_ptr, info_ptr); y++) {
-			byte *pixel = &map[y * png_get_image_width(png_ptr, info_ptr) + x];
-			uint x_offset = x * channels;
-
-			if (has_palette) {
-				*pixel = gray_palette[row_pointers[y][x_offset]];
-			} else if (channels == 3) {
-				*pixel = RGBToGrayscale(row_pointers[y][x_offset + 0],
-						row_pointers[y][x_offset + 1], row_pointers[y][x_offset + 2]);
-			} else {
-				*pixel = row_pointers[y][x_offset];
-			}
+/**
+ * The PNG Heightmap loader.
+ * Non-interlaced images are decoded and converted one row at a time, so only the grayscale image is kept in memory.
+ * @param map The destination of the grayscale image.
+ * @param png_ptr The PNG image, of which the transformations have been set up.
+ * @param info_ptr The information of the PNG image.
+ * @param passes Number of interlacing passes.
+ * @param[out] image_data Buffer of the decoded rows, to be freed by the caller.
+ */
+static void ReadHeightmapPNGImageData(byte *map, png_structp png_ptr, png_infop info_ptr, int passes, byte * volatile &image_data)
+{
+	byte gray_palette[256];
+	bool has_palette = png_get_color_type(png_ptr, info_ptr) == PNG_COLOR_TYPE_PALETTE;
+	if (has_palette) GetHeightmapPNGGrayPalette(png_ptr, info_ptr, gray_palette);
+
+	const uint width = png_get_image_width(png_ptr, info_ptr);
+	const uint height = png_get_image_height(png_ptr, info_ptr);
+	const uint channels = png_get_channels(png_ptr, info_ptr);
+	const size_t rowbytes = png_get_rowbytes(png_ptr, info_ptr);
+
+	if (passes == 1) {
+		image_data = MallocT<byte>(rowbytes);
+		for (uint y = 0; y < height; y++) {
+			png_read_row(png_ptr, image_data, nullptr);
+			ConvertHeightmapPNGRow(&map[(size_t)y * width], image_data, width, channels, has_palette ? gray_palette : nullptr);
+		}
+	} else {
+		/* Interlaced images only have their final rows after the last pass. */
+		image_data = MallocT<byte>(rowbytes * height);
+		for (int pass = 0; pass < passes; pass++) {
+			for (uint y = 0; y < height; y++) png_read_row(png_ptr, image_data + rowbytes * y, nullptr);
+		}
+		for (uint y = 0; y < height; y++) {
+			ConvertHeightmapPNGRow(&map[(size_t)y * width], image_data + rowbytes * y, width, channels, has_palette ? gray_palette : nullptr);
 		}
 	}
 }
@@ -139,6 +176,7 @@ static bool ReadHeightmapPNG(const char *filename, uint *x, uint *y, byte **map)
 	FILE *fp;
 	png_structp png_ptr = nullptr;
 	png_infop info_ptr  = nullptr;
+	byte * volatile image_data = nullptr;
 
 	fp = FioFOpenFile(filename, "rb", HEIGHTMAP_DIR);
 	if (fp == nullptr) {
@@ -157,25 +195,15 @@ static bool ReadHeightmapPNG(const char *filename, uint *x, uint *y, byte **map)
 	if (info_ptr == nullptr || setjmp(png_jmpbuf(png_ptr))) {
 		ShowErrorMessage(STR_ERROR_PNGMAP, STR_ERROR_PNGMAP_MISC, WL_ERROR);
 		fclose(fp);
+		free(image_data);
 		png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
 		return false;
 	}
 
 	png_init_io(png_ptr, fp);
 
-	/* Allocate memory and read image, without alpha or 16-bit samples
-	 * (result is either 8-bit indexed/grayscale or 24-bit RGB) */
-	png_set_packing(png_ptr);
-	png_read_png(png_ptr, info_ptr, PNG_TRANSFORM_PACKING | PNG_TRANSFORM_STRIP_ALPHA | PNG_TRANSFORM_STRIP_16, nullptr);
-
-	/* Maps of wrong colour-depth are not used.
-	 * (this should have been taken care of by stripping alpha and 16-bit samples on load) */
-	if ((png_get_channels(png_ptr, info_ptr) != 1) && (png_get_channels(png_ptr, info_ptr) != 3) && (png_get_bit_depth(png_ptr, info_ptr) != 8)) {
-		ShowErrorMessage(STR_ERROR_PNGMAP, STR_ERROR_PNGMAP_IMAGE_TYPE, WL_ERROR);
-		fclose(fp);
-		png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
-		return false;
-	}
+	/* Only the header is needed for the size, the image data is not decoded unless the map is wanted. */
+	png_read_info(png_ptr, info_ptr);
 
 	uint width = png_get_image_width(png_ptr, info_ptr);
 	uint height = png_get_image_height(png_ptr, info_ptr);
@@ -188,8 +216,26 @@ static bool ReadHeightmapPNG(const char *filename, uint *x, uint *y, byte **map)
 	}
 
 	if (map != nullptr) {
+		/* Read the image without alpha or 16-bit samples
+		 * (result is either 8-bit indexed/grayscale or 24-bit RGB) */
+		png_set_packing(png_ptr);
+		png_set_strip_alpha(png_ptr);
+		png_set_strip_16(png_ptr);
+		int passes = png_set_interlace_handling(png_ptr);
+		png_read_update_info(png_ptr, info_ptr);
+
+		/* Maps of wrong colour-depth are not used.
+		 * (this should have been taken care of by stripping alpha and 16-bit samples on load) */
+		if ((png_get_channels(png_ptr, info_ptr) != 1) && (png_get_channels(png_ptr, info_ptr) != 3) && (png_get_bit_depth(png_ptr, info_ptr) != 8)) {
+			ShowErrorMessage(STR_ERROR_PNGMAP, STR_ERROR_PNGMAP_IMAGE_TYPE, WL_ERROR);
+			fclose(fp);
+			png_destroy_read_struct(&png_ptr, &info_ptr, nullptr);
+			return false;
+		}
+
 		*map = MallocT<byte>(width * height);
-		ReadHeightmapPNGImageData(*map, png_ptr, info_ptr);
+		ReadHeightmapPNGImageData(*map, png_ptr, info_ptr, passes, image_data);
+		free(image_data);
 	}
 
 	*x = width;
@@ -365,8 +411,34 @@ static void GrayscaleToMapHeights(uint img_width, uint img_height, byte *map)
 		for (uint y = 0; y < MapSizeY(); y++) MakeVoid(TileXY(0, y));
 	}
 
+	/* The image column of each map column only depends on the column, so work them out once. */
+	std::vector<uint> img_cols(width);
+	for (col = col_pad; col < width - col_pad; col++) {
+		switch (_settings_game.game_creation.heightmap_rotation) {
+			default: NOT_REACHED();
+			case HM_COUNTER_CLOCKWISE:
+				img_cols[col] = (((width - 1 - col - col_pad) * num_div) / img_scale);
+				break;
+			case HM_CLOCKWISE:
+				img_cols[col] = (((col - col_pad) * num_div) / img_scale);
+				break;
+		}
+	}
+
+	/* 0 is sea level.
+	 * Other grey scales are scaled evenly to the available height levels > 0.
+	 * (The coastline is independent from the number of height levels) */
+	uint gray_to_height[256];
+	gray_to_height[0] = 0;
+	for (uint gray = 1; gray < 256; gray++) {
+		gray_to_height[gray] = 1 + (gray - 1) * _settings_game.game_creation.heightmap_height / 255;
+	}
+
 	/* Form the landscape */
 	for (row = 0; row < height; row++) {
+		/* Use nearest neighbour resizing to scale map data. */
+		img_row = (row >= row_pad) ? (((row - row_pad) * num_div) / img_scale) : 0;
+
 		for (col = 0; col < width; col++) {
 			switch (_settings_game.game_creation.heightmap_rotation) {
 				default: NOT_REACHED();
@@ -380,32 +452,13 @@ static void GrayscaleToMapHeights(uint img_width, uint img_height, byte *map)
 					(col < col_pad) || (col >= (width  - col_pad - (_settings_game.construction.freeform_edges ? 0 : 1)))) {
 				SetTileHeight(tile, 0);
 			} else {
-				/* Use nearest neighbour resizing to scale map data.
-				 *  We rotate the map 45 degrees (counter)clockwise */
-				img_row = (((row - row_pad) * num_div) / img_scale);
-				switch (_settings_game.game_creation.heightmap_rotation) {
-					default: NOT_REACHED();
-					case HM_COUNTER_CLOCKWISE:
-						img_col = (((width - 1 - col - col_pad) * num_div) / img_scale);
-						break;
-					case HM_CLOCKWISE:
-						img_col = (((col - col_pad) * num_div) / img_scale);
-						break;
-				}
+				/* We rotate the map 45 degrees (counter)clockwise */
+				img_col = img_cols[col];
 
 				assert(img_row < img_height);
 				assert(img_col < img_width);
 
-				uint heightmap_height = map[img_row * img_width + img_col];
-
-				if (heightmap_height > 0) {
-					/* 0 is sea level.
-					 * Other grey scales are scaled evenly to the available height levels > 0.
-					 * (The coastline is independent from the number of height levels) */
-					heightmap_height = 1 + (heightmap_height - 1) * _settings_game.game_creation.heightmap_height / 255;
-				}
-
-				SetTileHeight(tile, heightmap_height);
+				SetTileHeight(tile, gray_to_height[map[(size_t)img_row * img_width + img_col]]);
 			}
 			/* Only clear the tiles within the map area. */
 			if (IsInnerTile(tile)) {
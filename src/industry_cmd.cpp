@@ -38,12 +38,14 @@
 #include "core/pool_func.hpp"
 #include "subsidy_func.h"
 #include "core/backup_type.hpp"
+#include "core/checksum_func.hpp"
 #include "object_base.h"
 #include "game/game.hpp"
 #include "error.h"
 #include "cmd_helper.h"
 #include "string_func.h"
 #include "event_logs.h"
+#include "trace.h"
 
 #include "table/strings.h"
 #include "table/industry_land.h"
@@ -1185,12 +1187,16 @@ static void ProduceIndustryGoodsFromRate(Industry *i, bool scale)
 
 static uint _scaled_production_ticks;
 
+/**
+ * Produce the goods of an industry, and do its other periodic work.
+ * @param i The industry, whose counter has already been decremented for this tick.
+ */
 static void ProduceIndustryGoods(Industry *i)
 {
 	const IndustrySpec *indsp = GetIndustrySpec(i->type);
 
 	/* play a sound? */
-	if ((i->counter & 0x3F) == 0) {
+	if (((i->counter + 1) & 0x3F) == 0) {
 		uint32 r;
 		if (Chance16R(1, 14, r) && indsp->number_of_sounds != 0 && _settings_client.sound.ambient) {
 			for (size_t j = 0; j < lengthof(i->last_month_production); j++) {
@@ -1205,8 +1211,6 @@ static void ProduceIndustryGoods(Industry *i)
 		}
 	}
 
-	i->counter--;
-
 	const bool scale_ticks = (_settings_game.economy.industry_cargo_scale_factor != 0) && HasBit(indsp->callback_mask, CBM_IND_PRODUCTION_256_TICKS);
 	if (scale_ticks) {
 		if ((i->counter % _scaled_production_ticks) == 0) {
@@ -1256,11 +1260,15 @@ static void ProduceIndustryGoods(Industry *i)
 
 		TriggerIndustry(i, INDUSTRY_TRIGGER_INDUSTRY_TICK);
 		StartStopIndustryTileAnimation(i, IAT_INDUSTRY_TICK);
+
+		UpdateStateSubChecksum((((uint64)i->index) << 32) | (i->produced_cargo_waiting[0] << 16) | i->produced_cargo_waiting[1], SCP_INDUSTRIES);
 	}
 }
 
 void OnTick_Industry()
 {
+	TRACE_ZONE("OnTick_Industry");
+
 	if (_industry_sound_ctr != 0) {
 		_industry_sound_ctr++;
 
@@ -1275,9 +1283,24 @@ void OnTick_Industry()
 	if (_game_mode == GM_EDITOR) return;
 
 	_scaled_production_ticks = ScaleQuantity(INDUSTRY_PRODUCE_TICKS, -_settings_game.economy.industry_cargo_scale_factor);
+	const bool scaled = _settings_game.economy.industry_cargo_scale_factor != 0;
+
+	/* Count down all industries first, to find the few which have something to do in this tick. */
+	static std::vector<IndustryID> active;
 	for (Industry *i : Industry::Iterate()) {
-		ProduceIndustryGoods(i);
+		const bool sound_tick = (i->counter & 0x3F) == 0;
+		i->counter--;
+		if (sound_tick || (i->counter % INDUSTRY_PRODUCE_TICKS) == 0 || (scaled && (i->counter % _scaled_production_ticks) == 0)) {
+			active.push_back(i->index);
+		}
 	}
+
+	/* Then do their work, in the same order as before. */
+	for (IndustryID index : active) {
+		Industry *i = Industry::GetIfValid(index);
+		if (i != nullptr) ProduceIndustryGoods(i);
+	}
+	active.clear();
 }
 
 /**
@@ -1462,11 +1485,16 @@ static CommandCost FindTownForIndustry(TileIndex tile, int type, Town **t)
 
 	if (_settings_game.economy.multiple_industry_per_town) return CommandCost();
 
+	/* Stop as soon as all industries of this type have been seen, which is immediately for types not yet on the map. */
+	uint remaining = Industry::GetIndustryTypeCount(type);
 	for (const Industry *i : Industry::Iterate()) {
-		if (i->type == (byte)type && i->town == *t) {
+		if (remaining == 0) break;
+		if (i->type != (byte)type) continue;
+		if (i->town == *t) {
 			*t = nullptr;
 			return_cmd_error(STR_ERROR_ONLY_ONE_ALLOWED_PER_TOWN);
 		}
+		remaining--;
 	}
 
 	return CommandCost();
@@ -1794,6 +1822,7 @@ static void PopulateStationsNearby(Industry *ind)
 		ind->stations_near.insert(ind->neutral_station);
 		ind->neutral_station->industries_near.clear();
 		ind->neutral_station->industries_near.insert(IndustryListEntry{0, ind});
+		ind->neutral_station->IndustriesNearChanged();
 		return;
 	}
 
@@ -3045,12 +3074,13 @@ void IndustryMonthlyLoop()
 			delete i;
 		} else {
 			ChangeIndustryProduction(i, true);
-			SetWindowDirty(WC_INDUSTRY_VIEW, i->index);
 		}
 	}
 
 	cur_company.Restore();
 
+	SetWindowClassesDirty(WC_INDUSTRY_VIEW);
+
 	/* production-change */
 	InvalidateWindowData(WC_INDUSTRY_DIRECTORY, 0, IDIWD_PRODUCTION_CHANGE);
 }
@@ -149,6 +149,7 @@ static inline IndustryGfx GetIndustryGfx(TileIndex t)
 static inline void SetIndustryGfx(TileIndex t, IndustryGfx gfx)
 {
 	assert_tile(IsTileType(t, MP_INDUSTRY), t);
+	if (GetCleanIndustryGfx(t) != gfx) MarkTileAcceptanceChanged(t);
 	_m[t].m5 = GB(gfx, 0, 8);
 	SB(_me[t].m6, 2, 1, GB(gfx, 8, 1));
 }
@@ -29,8 +29,16 @@
 
 #include "table/strings.h"
 
+/** Sharing fees not yet transferred, as money fraction (shifted 8 bits to the left), by paying company and infrastructure owner. */
+static Money _pending_sharing_fees[MAX_COMPANIES][MAX_COMPANIES];
+/** Net change of the money of each company by the pending sharing fees, as money fraction. */
+static Money _pending_sharing_fee_balance[MAX_COMPANIES];
+/** Companies which have pending sharing fees to pay. */
+static CompanyMask _pending_sharing_fee_payers;
+
 /**
- * Helper function for transferring sharing fees
+ * Helper function for transferring sharing fees.
+ * The transfer is deferred until #SettleSharingFees, so that each pair of companies only makes one transfer per tick.
  * @param v The vehicle involved
  * @param infra_owner The owner of the infrastructure
  * @param cost Amount to transfer as money fraction (shifted 8 bits to the left)
@@ -40,12 +48,32 @@ static void PaySharingFee(Vehicle *v, Owner infra_owner, Money cost)
 	Company *c = Company::Get(v->owner);
 	if (!_settings_game.economy.sharing_payment_in_debt) {
 		/* Do not allow fee payment to drop (money - loan) below 0. */
-		cost = std::min(cost, (c->money - c->current_loan) << 8);
+		cost = std::min(cost, ((c->money - c->current_loan) << 8) + _pending_sharing_fee_balance[v->owner]);
 		if (cost <= 0) return;
 	}
 	v->profit_this_year -= cost;
-	SubtractMoneyFromCompanyFract(v->owner, CommandCost(EXPENSES_SHARING_COST, cost));
-	SubtractMoneyFromCompanyFract(infra_owner, CommandCost(EXPENSES_SHARING_INC, -cost));
+	_pending_sharing_fees[v->owner][infra_owner] += cost;
+	_pending_sharing_fee_balance[v->owner] -= cost;
+	_pending_sharing_fee_balance[infra_owner] += cost;
+	SetBit(_pending_sharing_fee_payers, v->owner);
+}
+
+/**
+ * Transfer the sharing fees accumulated since the last call.
+ */
+void SettleSharingFees()
+{
+	for (CompanyID payer : SetBitIterator<CompanyID>(_pending_sharing_fee_payers)) {
+		for (CompanyID infra_owner = COMPANY_FIRST; infra_owner < MAX_COMPANIES; infra_owner++) {
+			Money &cost = _pending_sharing_fees[payer][infra_owner];
+			if (cost == 0) continue;
+			SubtractMoneyFromCompanyFract(payer, CommandCost(EXPENSES_SHARING_COST, cost));
+			SubtractMoneyFromCompanyFract(infra_owner, CommandCost(EXPENSES_SHARING_INC, -cost));
+			cost = 0;
+		}
+	}
+	_pending_sharing_fee_payers = 0;
+	for (Money &balance : _pending_sharing_fee_balance) balance = 0;
 }
 
 /**
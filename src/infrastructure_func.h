@@ -18,6 +18,7 @@
 
 void PayStationSharingFee(Vehicle *v, const Station *st);
 void PayDailyTrackSharingFee(Train *v);
+void SettleSharingFees();
 
 bool CheckSharingChangePossible(VehicleType type, bool new_value);
 void HandleSharingCompanyDeletion(Owner owner);
@@ -32,9 +32,13 @@
 #include "pathfinder/npf/aystar.h"
 #include "saveload/saveload.h"
 #include "framerate_type.h"
+#include "trace.h"
 #include "town.h"
 #include "3rdparty/cpp-btree/btree_set.h"
 #include "scope_info.h"
+#include "newgrf.h"
+#include "worker_thread.h"
+#include INCLUDE_FOR_PREFETCH_NTA
 #include <array>
 #include <list>
 #include <set>
@@ -827,8 +831,28 @@ TileIndex _cur_tileloop_tile;
 /**
  * Gradually iterate over all tiles on the map, calling their TileLoopProcs once every 256 ticks.
  */
+/**
+ * Check whether the tile loop of a clear tile would leave it unchanged.
+ * This must match TileLoop_Clear, for game modes in which #RunTileLoop uses it.
+ * @param tile Clear tile to check.
+ * @return True if the tile loop of the tile can be skipped.
+ */
+static inline bool IsClearTileLoopIdle(TileIndex tile)
+{
+	/* Flat edge tiles get flooded. */
+	if (_settings_game.construction.freeform_edges && DistanceFromEdge(tile) == 1) return false;
+
+	switch (GetClearGround(tile)) {
+		case CLEAR_GRASS:  return GetClearDensity(tile) == 3;
+		case CLEAR_FIELDS: return false;
+		default:           return true;
+	}
+}
+
 void RunTileLoop()
 {
+	TRACE_ZONE("RunTileLoop");
+
 	PerformanceAccumulator framerate(PFE_GL_LANDSCAPE);
 
 	/* The pseudorandom sequence of tiles is generated using a Galois linear feedback
@@ -859,11 +883,36 @@ void RunTileLoop()
 		count--;
 	}
 
+	/* The sequence jumps around the whole map, so the loop is mostly waiting for the map
+	 * arrays to be read from memory. Fetch the tiles a few steps ahead in the sequence
+	 * while the current one is processed. */
+	static const uint TILE_LOOP_PREFETCH_DISTANCE = 8;
+	auto next_tile = [feedback](TileIndex t) -> TileIndex {
+		/* Get the next tile in sequence using a Galois LFSR. */
+		return (t >> 1) ^ (-(int32)(t & 1) & feedback);
+	};
+	/* Clear tiles only change on their own or by their neighbours outside of temperate climate,
+	 * and in the scenario editor. The ambient sound callback draws random numbers for them. */
+	const bool skip_idle_clear = _game_mode != GM_EDITOR && _settings_game.game_creation.landscape == LT_TEMPERATE &&
+			!HasGrfMiscBit(GMB_AMBIENT_SOUND_CALLBACK);
+
+	TileIndex prefetch_tile = tile;
+	for (uint i = 0; i < TILE_LOOP_PREFETCH_DISTANCE; i++) {
+		PREFETCH_NTA(&_m[prefetch_tile]);
+		PREFETCH_NTA(&_me[prefetch_tile]);
+		prefetch_tile = next_tile(prefetch_tile);
+	}
+
 	while (count--) {
-		_tile_type_procs[GetTileType(tile)]->tile_loop_proc(tile);
+		PREFETCH_NTA(&_m[prefetch_tile]);
+		PREFETCH_NTA(&_me[prefetch_tile]);
+		prefetch_tile = next_tile(prefetch_tile);
 
-		/* Get the next tile in sequence using a Galois LFSR. */
-		tile = (tile >> 1) ^ (-(int32)(tile & 1) & feedback);
+		const TileType type = GetTileType(tile);
+		if (type != MP_VOID && !(type == MP_CLEAR && skip_idle_clear && IsClearTileLoopIdle(tile))) {
+			_tile_type_procs[type]->tile_loop_proc(tile);
+		}
+		tile = next_tile(tile);
 	}
 
 	_cur_tileloop_tile = tile;
@@ -1397,6 +1446,68 @@ static bool FlowRiver(TileIndex spring, TileIndex begin, uint min_river_length)
 	return found;
 }
 
+/**
+ * Finder of the springs of the next tries to create a river.
+ * When there are worker threads, the springs around the random tiles of several next tries are searched for at once.
+ * The random tiles of these tries are predicted with a copy of the game randomizer, and the spring search only reads
+ * the map. So the lookahead has to be discarded whenever a river was tried, as that uses random numbers and may change
+ * the map, but otherwise the results are exactly those of searching the springs one try at a time.
+ */
+class RiverSpringFinder {
+	static const uint LOOKAHEAD = 16; ///< Number of tries to search the springs of at once.
+
+	std::vector<TileIndex> tiles;   ///< Random tile of each try of the lookahead.
+	std::vector<TileIndex> springs; ///< Spring found around the random tile of each try, or INVALID_TILE.
+	size_t next = 0;                ///< Next try of the lookahead.
+	const bool lookahead;           ///< Whether to search springs ahead.
+
+	/** Search the springs of the next tries. */
+	void Fill()
+	{
+		Randomizer random = _random;
+		this->tiles.resize(LOOKAHEAD);
+		this->springs.resize(LOOKAHEAD);
+		for (TileIndex &tile : this->tiles) {
+			tile = RandomTileSeed(random.Next());
+		}
+		_general_worker_pool.ParallelFor(LOOKAHEAD, 1, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				TileIndex t = this->tiles[i];
+				this->springs[i] = CircularTileSearch(&t, 8, FindSpring, nullptr) ? t : INVALID_TILE;
+			}
+		});
+		this->next = 0;
+	}
+
+public:
+	RiverSpringFinder() : lookahead(_general_worker_pool.GetParallelism() > 1) {}
+
+	/**
+	 * Pick a random tile for the next try, and search a spring around it.
+	 * @return The spring, or INVALID_TILE when there is none.
+	 */
+	TileIndex FindNext()
+	{
+		if (!this->lookahead) {
+			TileIndex t = RandomTile();
+			return CircularTileSearch(&t, 8, FindSpring, nullptr) ? t : INVALID_TILE;
+		}
+
+		if (this->next == this->springs.size()) this->Fill();
+		[[maybe_unused]] TileIndex t = RandomTile();
+		assert(t == this->tiles[this->next]);
+		return this->springs[this->next++];
+	}
+
+	/** Discard the lookahead, after random numbers were used or the map was changed. */
+	void Invalidate()
+	{
+		this->tiles.clear();
+		this->springs.clear();
+		this->next = 0;
+	}
+};
+
 /**
  * Actually (try to) create some rivers.
  */
@@ -1409,25 +1520,31 @@ static void CreateRivers()
 	const uint num_short_rivers = wells - std::max(1u, wells / 10);
 	SetGeneratingWorldProgress(GWP_RIVER, wells + 256 / 64); // Include the tile loop calls below.
 
+	RiverSpringFinder spring_finder;
+
 	for (; wells > num_short_rivers; wells--) {
 		IncreaseGeneratingWorldProgress(GWP_RIVER);
 		for (int tries = 0; tries < 128; tries++) {
-			TileIndex t = RandomTile();
-			if (!CircularTileSearch(&t, 8, FindSpring, nullptr)) continue;
+			TileIndex t = spring_finder.FindNext();
+			if (t == INVALID_TILE) continue;
 			_current_spring = t;
 			_is_main_river = false;
-			if (FlowRiver(t, t, _settings_game.game_creation.min_river_length * 4)) break;
+			const bool built = FlowRiver(t, t, _settings_game.game_creation.min_river_length * 4);
+			spring_finder.Invalidate();
+			if (built) break;
 		}
 	}
 
 	for (; wells != 0; wells--) {
 		IncreaseGeneratingWorldProgress(GWP_RIVER);
 		for (int tries = 0; tries < 128; tries++) {
-			TileIndex t = RandomTile();
-			if (!CircularTileSearch(&t, 8, FindSpring, nullptr)) continue;
+			TileIndex t = spring_finder.FindNext();
+			if (t == INVALID_TILE) continue;
 			_current_spring = t;
 			_is_main_river = false;
-			if (FlowRiver(t, t, _settings_game.game_creation.min_river_length)) break;
+			const bool built = FlowRiver(t, t, _settings_game.game_creation.min_river_length);
+			spring_finder.Invalidate();
+			if (built) break;
 		}
 	}
 
@@ -1664,6 +1781,8 @@ void OnTick_LinkGraph();
 
 void CallLandscapeTick()
 {
+	TRACE_ZONE("CallLandscapeTick");
+
 	{
 		PerformanceAccumulator framerate(PFE_GL_LANDSCAPE);
 
@@ -2,6 +2,7 @@
 
 #include "../stdafx.h"
 #include "demands.h"
+#include "../core/bitmath_func.hpp"
 #include <queue>
 #include <algorithm>
 #include <tuple>
@@ -399,6 +400,77 @@ void DemandCalculator::CalcMinimisedDistanceDemand(LinkGraphJob &job, const std:
 	}
 }
 
+/**
+ * Get the key identifying the settings which affect the demands of a link graph.
+ * Cached demands are only reused if they were calculated with the same key.
+ * @param settings Link graph settings.
+ * @param cargo Cargo of the link graph.
+ * @return Cache key.
+ */
+/* static */ uint32 DemandCalculator::GetCacheKey(const LinkGraphSettings &settings, CargoID cargo)
+{
+	uint32 key = 0;
+	SB(key, 0, 8, settings.GetDistributionType(cargo));
+	SB(key, 8, 8, settings.accuracy);
+	SB(key, 16, 8, settings.demand_distance);
+	SB(key, 24, 8, settings.demand_size);
+	return key;
+}
+
+/**
+ * Reuse the demands calculated for a component by a previous job, if the component
+ * is still the same and no node's share of the total supply changed by more than
+ * the demand reuse threshold. The cached demands are scaled by the change of the
+ * total supply. As the cache is part of the game state, this is deterministic.
+ * @param job Job to calculate the demands for.
+ * @param component Nodes of the component.
+ * @param reachable_nodes Bitmap of the nodes of the component.
+ * @param station_to_node Lookup table for getting NodeIDs from StationIDs.
+ * @return If the cached demands have been used.
+ */
+bool DemandCalculator::ReuseDemands(LinkGraphJob &job, const std::vector<NodeID> &component, const std::vector<bool> &reachable_nodes, const std::vector<NodeID> &station_to_node)
+{
+	const LinkGraphSettings &settings = job.Settings();
+	const uint32 key = DemandCalculator::GetCacheKey(settings, job.Cargo());
+
+	uint64 supply_sum = 0;
+	uint64 cached_supply_sum = 0;
+	for (NodeID node : component) {
+		const LinkGraph::DemandCache &cache = job[node].GetDemandCache();
+		if (cache.component_size != component.size() || cache.key != key || cache.acceptance != job[node].Demand()) return false;
+		for (const auto &demand : cache.demands) {
+			if (demand.first >= station_to_node.size()) return false;
+			NodeID to = station_to_node[demand.first];
+			if (to == INVALID_NODE || !reachable_nodes[to]) return false;
+		}
+		supply_sum += job[node].Supply();
+		cached_supply_sum += job[node].GetDemandCache().supply;
+	}
+
+	/* Compare the shares of the total supply in units of 1/65536, with a tolerance of one unit. */
+	if (supply_sum > 0 && cached_supply_sum > 0) {
+		for (NodeID node : component) {
+			uint64 share = ((uint64)job[node].Supply() << 16) / supply_sum;
+			uint64 cached_share = ((uint64)job[node].GetDemandCache().supply << 16) / cached_supply_sum;
+			uint64 difference = share > cached_share ? share - cached_share : cached_share - share;
+			if (difference * 100 > cached_share * settings.demand_reuse_threshold + 100) return false;
+		}
+	} else if (supply_sum != cached_supply_sum) {
+		return false;
+	}
+
+	for (NodeID node : component) {
+		Node from = job[node];
+		for (const auto &demand : from.GetDemandCache().demands) {
+			uint64 amount = demand.second;
+			if (cached_supply_sum > 0) amount = std::max<uint64>(1, amount * supply_sum / cached_supply_sum);
+			amount = std::min<uint64>(amount, from.UndeliveredSupply());
+			from.DeliverSupply(station_to_node[demand.first], (uint)amount);
+		}
+	}
+	return true;
+}
+
 /**
  * Create the DemandCalculator and immediately do the calculation.
  * @param job Job to calculate the demands for.
@@ -419,62 +491,81 @@ DemandCalculator::DemandCalculator(LinkGraphJob &job) :
 
 	const uint size = job.Size();
 
-	/* Symmetric edge matrix
-	 * Storage order: e01  e02 e12  e03 e13 e23  e04 e14 e24 e34  ... */
-	auto se_index = [](uint i, uint j) -> uint {
-		if (j < i) std::swap(i, j);
-		return i + (j * (j - 1) / 2);
-	};
-	std::vector<bool> symmetric_edges(se_index(0, size));
+	/* Undirected adjacency lists, nodes are connected if there is an edge in either direction. */
+	std::vector<std::vector<NodeID>> neighbours(size);
 
 	for (NodeID node_id = 0; node_id < size; ++node_id) {
 		Node from = job[node_id];
 		for (EdgeIterator it(from.Begin()); it != from.End(); ++it) {
-			symmetric_edges[se_index(node_id, it->first)] = true;
+			neighbours[node_id].push_back(it->first);
+			neighbours[it->first].push_back(node_id);
+		}
+	}
+	/* Lookup table for getting NodeIDs from StationIDs, only needed to reuse cached demands. */
+	std::vector<NodeID> station_to_node;
+	if (settings.demand_reuse_threshold > 0) {
+		for (NodeID node = 0; node < size; ++node) {
+			StationID st = job[node].Station();
+			if (st >= station_to_node.size()) station_to_node.resize(st + 1, INVALID_NODE);
+			station_to_node[st] = node;
 		}
 	}
+
 	uint first_unseen = 0;
 	std::vector<bool> reachable_nodes(size);
+	std::vector<bool> seen_nodes(size);
+	std::vector<NodeID> component;
 	do {
 		reachable_nodes.assign(size, false);
+		component.clear();
 		std::vector<NodeID> queue;
 		queue.push_back(first_unseen);
 		reachable_nodes[first_unseen] = true;
 		while (!queue.empty()) {
 			NodeID from = queue.back();
 			queue.pop_back();
-			for (NodeID to = 0; to < size; ++to) {
-				if (from == to) continue;
-				if (symmetric_edges[se_index(from, to)]) {
-					std::vector<bool>::reference bit = reachable_nodes[to];
-					if (!bit) {
-						bit = true;
-						queue.push_back(to);
-					}
+			component.push_back(from);
+			seen_nodes[from] = true;
+			for (NodeID to : neighbours[from]) {
+				std::vector<bool>::reference bit = reachable_nodes[to];
+				if (!bit) {
+					bit = true;
+					queue.push_back(to);
 				}
 			}
 		}
+		std::sort(component.begin(), component.end());
+
+		if (settings.demand_reuse_threshold == 0 || !this->ReuseDemands(job, component, reachable_nodes, station_to_node)) {
+			for (NodeID node : component) {
+				job[node].SetDemandsCalculated((uint16)component.size());
+			}
 
-		switch (settings.GetDistributionType(cargo)) {
-			case DT_SYMMETRIC:
-				this->CalcDemand<SymmetricScaler>(job, reachable_nodes, SymmetricScaler(settings.demand_size));
-				break;
-			case DT_ASYMMETRIC:
-				this->CalcDemand<AsymmetricScaler>(job, reachable_nodes, AsymmetricScaler());
-				break;
-			case DT_ASYMMETRIC_EQ:
-				this->CalcMinimisedDistanceDemand<AsymmetricScalerEq>(job, reachable_nodes, AsymmetricScalerEq());
-				break;
-			case DT_ASYMMETRIC_NEAR:
-				this->CalcMinimisedDistanceDemand<AsymmetricScaler>(job, reachable_nodes, AsymmetricScaler());
-				break;
-			default:
-				/* Nothing to do. */
-				break;
+			switch (settings.GetDistributionType(cargo)) {
+				case DT_SYMMETRIC:
+					this->CalcDemand<SymmetricScaler>(job, reachable_nodes, SymmetricScaler(settings.demand_size));
+					break;
+				case DT_ASYMMETRIC:
+					this->CalcDemand<AsymmetricScaler>(job, reachable_nodes, AsymmetricScaler());
+					break;
+				case DT_ASYMMETRIC_EQ:
+					this->CalcMinimisedDistanceDemand<AsymmetricScalerEq>(job, reachable_nodes, AsymmetricScalerEq());
+					break;
+				case DT_ASYMMETRIC_NEAR:
+					this->CalcMinimisedDistanceDemand<AsymmetricScaler>(job, reachable_nodes, AsymmetricScaler());
+					break;
+				default:
+					/* Nothing to do. */
+					break;
+			}
 		}
 
-		while (first_unseen < size && reachable_nodes[first_unseen]) {
+		while (first_unseen < size && seen_nodes[first_unseen]) {
 			first_unseen++;
 		}
 	} while (first_unseen < size);
+
+	for (NodeID node = 0; node < size; ++node) {
+		job[node].SortDemands();
+	}
 }
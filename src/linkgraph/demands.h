@@ -13,6 +13,8 @@ class DemandCalculator {
 public:
 	DemandCalculator(LinkGraphJob &job);
 
+	static uint32 GetCacheKey(const LinkGraphSettings &settings, CargoID cargo);
+
 private:
 	int32 max_distance; ///< Maximum distance possible on the map.
 	int32 mod_dist;     ///< Distance modifier, determines how much demands decrease with distance.
@@ -23,6 +25,8 @@ private:
 
 	template<class Tscaler>
 	void CalcMinimisedDistanceDemand(LinkGraphJob &job, const std::vector<bool> &reachable_nodes, Tscaler scaler);
+
+	bool ReuseDemands(LinkGraphJob &job, const std::vector<NodeID> &component, const std::vector<bool> &reachable_nodes, const std::vector<NodeID> &station_to_node);
 };
 
 /**
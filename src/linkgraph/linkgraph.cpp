@@ -30,21 +30,34 @@ inline void LinkGraph::BaseNode::Init(TileIndex xy, StationID st, uint demand)
 	this->demand = demand;
 	this->station = st;
 	this->last_update = INVALID_DATE;
+	this->edges.clear();
+	this->demand_cache.Clear();
 }
 
 /**
  * Create an edge.
+ * @param dest_node Destination of the edge.
  */
-inline void LinkGraph::BaseEdge::Init()
+inline void LinkGraph::BaseEdge::Init(NodeID dest_node)
 {
 	this->capacity = 0;
 	this->usage = 0;
 	this->last_unrestricted_update = INVALID_DATE;
 	this->last_restricted_update = INVALID_DATE;
 	this->last_aircraft_update = INVALID_DATE;
-	this->next_edge = INVALID_NODE;
+	this->dest_node = dest_node;
 }
 
+/** Initialise an edge without capacity, used for nodes which are not linked. */
+static LinkGraph::BaseEdge MakeEmptyEdge()
+{
+	LinkGraph::BaseEdge edge;
+	edge.Init();
+	return edge;
+}
+
+/* static */ const LinkGraph::BaseEdge LinkGraph::empty_edge = MakeEmptyEdge();
+
 /**
  * Shift all dates by given interval.
  * This is useful if the date has been modified with the cheat menu.
@@ -53,11 +66,10 @@ inline void LinkGraph::BaseEdge::Init()
 void LinkGraph::ShiftDates(int interval)
 {
 	this->last_compression += interval;
-	for (NodeID node1 = 0; node1 < this->Size(); ++node1) {
-		BaseNode &source = this->nodes[node1];
+	for (NodeID id = 0; id < this->Size(); ++id) {
+		BaseNode &source = this->MutableNode(id);
 		if (source.last_update != INVALID_DATE) source.last_update += interval;
-		for (NodeID node2 = 0; node2 < this->Size(); ++node2) {
-			BaseEdge &edge = this->edges[node1][node2];
+		for (BaseEdge &edge : source.edges) {
 			if (edge.last_unrestricted_update != INVALID_DATE) edge.last_unrestricted_update += interval;
 			if (edge.last_restricted_update != INVALID_DATE) edge.last_restricted_update += interval;
 			if (edge.last_aircraft_update != INVALID_DATE) edge.last_aircraft_update += interval;
@@ -68,10 +80,10 @@ void LinkGraph::ShiftDates(int interval)
 void LinkGraph::Compress()
 {
 	this->last_compression = (_date + this->last_compression) / 2;
-	for (NodeID node1 = 0; node1 < this->Size(); ++node1) {
-		this->nodes[node1].supply /= 2;
-		for (NodeID node2 = 0; node2 < this->Size(); ++node2) {
-			BaseEdge &edge = this->edges[node1][node2];
+	for (NodeID id = 0; id < this->Size(); ++id) {
+		BaseNode &node = this->MutableNode(id);
+		node.supply /= 2;
+		for (BaseEdge &edge : node.edges) {
 			if (edge.capacity > 0) {
 				edge.capacity = std::max(1U, edge.capacity / 2);
 				edge.usage /= 2;
@@ -90,26 +102,24 @@ void LinkGraph::Merge(LinkGraph *other)
 	Date other_age = _date - other->last_compression + 1;
 	NodeID first = this->Size();
 	for (NodeID node1 = 0; node1 < other->Size(); ++node1) {
-		Station *st = Station::Get(other->nodes[node1].station);
+		const BaseNode &other_node = *other->nodes[node1];
+		Station *st = Station::Get(other_node.station);
 		NodeID new_node = this->AddNode(st);
-		this->nodes[new_node].supply = LinkGraph::Scale(other->nodes[node1].supply, age, other_age);
+		BaseNode &node = *this->nodes[new_node];
+		node.supply = LinkGraph::Scale(other_node.supply, age, other_age);
 		st->goods[this->cargo].link_graph = this->index;
 		st->goods[this->cargo].node = new_node;
-		for (NodeID node2 = 0; node2 < node1; ++node2) {
-			BaseEdge &forward = this->edges[new_node][first + node2];
-			BaseEdge &backward = this->edges[first + node2][new_node];
-			forward = other->edges[node1][node2];
-			backward = other->edges[node2][node1];
-			forward.capacity = LinkGraph::Scale(forward.capacity, age, other_age);
-			forward.usage = LinkGraph::Scale(forward.usage, age, other_age);
-			if (forward.next_edge != INVALID_NODE) forward.next_edge += first;
-			backward.capacity = LinkGraph::Scale(backward.capacity, age, other_age);
-			backward.usage = LinkGraph::Scale(backward.usage, age, other_age);
-			if (backward.next_edge != INVALID_NODE) backward.next_edge += first;
+
+		/* All edges of the other graph point to nodes appended after the existing
+		 * ones, so shifting them keeps the edge list sorted. The other graph may
+		 * still be shared with a running job, so its edges are copied. */
+		std::vector<BaseEdge> &new_edges = node.edges;
+		new_edges = other_node.edges;
+		for (BaseEdge &edge : new_edges) {
+			edge.capacity = LinkGraph::Scale(edge.capacity, age, other_age);
+			edge.usage = LinkGraph::Scale(edge.usage, age, other_age);
+			edge.dest_node += first;
 		}
-		BaseEdge &new_start = this->edges[new_node][new_node];
-		new_start = other->edges[node1][node1];
-		if (new_start.next_edge != INVALID_NODE) new_start.next_edge += first;
 	}
 	delete other;
 }
@@ -125,35 +135,28 @@ void LinkGraph::RemoveNode(NodeID id)
 	NodeID last_node = this->Size() - 1;
 	for (NodeID i = 0; i <= last_node; ++i) {
 		(*this)[i].RemoveEdge(id);
-		BaseEdge *node_edges = this->edges[i];
-		NodeID prev = i;
-		NodeID next = node_edges[i].next_edge;
-		while (next != INVALID_NODE) {
-			if (next == last_node) {
-				node_edges[prev].next_edge = id;
-				break;
-			}
-			prev = next;
-			next = node_edges[prev].next_edge;
+		if (id == last_node) continue;
+
+		/* Edges to the last node now point to the removed node's slot. */
+		const std::vector<BaseEdge> &old_edges = this->nodes[i]->edges;
+		if (!old_edges.empty() && old_edges.back().dest_node == last_node) {
+			BaseNode &node = this->MutableNode(i);
+			BaseEdge edge = node.edges.back();
+			node.edges.pop_back();
+			edge.dest_node = id;
+			node.edges.insert(node.FindEdgePosition(id), edge);
 		}
-		node_edges[id] = node_edges[last_node];
 	}
-	Station::Get(this->nodes[last_node].station)->goods[this->cargo].node = id;
+	Station::Get(this->nodes[last_node]->station)->goods[this->cargo].node = id;
 	/* Erase node by swapping with the last element. Node index is referenced
 	 * directly from station goods entries so the order and position must remain. */
-	this->nodes[id] = this->nodes.back();
+	this->nodes[id] = std::move(this->nodes.back());
 	this->nodes.pop_back();
-	this->edges.EraseColumn(id);
-	/* Not doing EraseRow here, as having the extra invalid row doesn't hurt
-	 * and removing it would trigger a lot of memmove. The data has already
-	 * been copied around in the loop above. */
 }
 
 /**
- * Add a node to the component and create empty edges associated with it. Set
- * the station's last_component to this component. Calculate the distances to all
- * other nodes. The distances to _all_ nodes are important as the demand
- * calculator relies on their availability.
+ * Add a node to the component. Set the station's last_component to this
+ * component. The new node has no edges yet.
  * @param st New node's station.
  * @return New node's ID.
  */
@@ -162,23 +165,10 @@ NodeID LinkGraph::AddNode(const Station *st)
 	const GoodsEntry &good = st->goods[this->cargo];
 
 	NodeID new_node = this->Size();
-	this->nodes.emplace_back();
-	/* Avoid reducing the height of the matrix as that is expensive and we
-	 * most likely will increase it again later which is again expensive. */
-	this->edges.Resize(new_node + 1U, std::max(new_node + 1U, this->edges.Height()));
+	this->nodes.push_back(std::make_shared<BaseNode>());
 
-	this->nodes[new_node].Init(st->xy, st->index,
+	this->nodes[new_node]->Init(st->xy, st->index,
 			HasBit(good.status, GoodsEntry::GES_ACCEPTANCE));
-
-	BaseEdge *new_edges = this->edges[new_node];
-
-	/* Reset the first edge starting at the new node */
-	new_edges[new_node].next_edge = INVALID_NODE;
-
-	for (NodeID i = 0; i <= new_node; ++i) {
-		new_edges[i].Init();
-		this->edges[i][new_node].Init();
-	}
 	return new_node;
 }
 
@@ -193,12 +183,13 @@ NodeID LinkGraph::AddNode(const Station *st)
 void LinkGraph::Node::AddEdge(NodeID to, uint capacity, uint usage, EdgeUpdateMode mode)
 {
 	assert(this->index != to);
-	BaseEdge &edge = this->edges[to];
-	BaseEdge &first = this->edges[this->index];
+	BaseNode &node = this->Modify();
+	auto iter = node.FindEdgePosition(to);
+	assert(iter == node.edges.end() || iter->dest_node != to);
+	BaseEdge &edge = *node.edges.emplace(iter);
+	edge.Init(to);
 	edge.capacity = capacity;
 	edge.usage = usage;
-	edge.next_edge = first.next_edge;
-	first.next_edge = to;
 	if (mode & EUM_UNRESTRICTED)  edge.last_unrestricted_update = _date;
 	if (mode & EUM_RESTRICTED) edge.last_restricted_update = _date;
 	if (mode & EUM_AIRCRAFT) edge.last_aircraft_update = _date;
@@ -215,7 +206,7 @@ void LinkGraph::Node::UpdateEdge(NodeID to, uint capacity, uint usage, EdgeUpdat
 {
 	assert(capacity > 0);
 	assert(usage <= capacity);
-	if (this->edges[to].capacity == 0) {
+	if (!this->HasEdgeTo(to)) {
 		this->AddEdge(to, capacity, usage, mode);
 	} else {
 		(*this)[to].Update(capacity, usage, mode);
@@ -228,27 +219,9 @@ void LinkGraph::Node::UpdateEdge(NodeID to, uint capacity, uint usage, EdgeUpdat
  */
 void LinkGraph::Node::RemoveEdge(NodeID to)
 {
-	if (this->index == to) return;
-	BaseEdge &edge = this->edges[to];
-	edge.capacity = 0;
-	edge.last_unrestricted_update = INVALID_DATE;
-	edge.last_restricted_update = INVALID_DATE;
-	edge.last_aircraft_update = INVALID_DATE;
-	edge.usage = 0;
-
-	NodeID prev = this->index;
-	NodeID next = this->edges[this->index].next_edge;
-	while (next != INVALID_NODE) {
-		if (next == to) {
-			/* Will be removed, skip it. */
-			this->edges[prev].next_edge = edge.next_edge;
-			edge.next_edge = INVALID_NODE;
-			break;
-		} else {
-			prev = next;
-			next = this->edges[next].next_edge;
-		}
-	}
+	if (!this->HasEdgeTo(to)) return;
+	BaseNode &node = this->Modify();
+	node.edges.erase(node.FindEdgePosition(to));
 }
 
 /**
@@ -278,19 +251,17 @@ void LinkGraph::Edge::Update(uint capacity, uint usage, EdgeUpdateMode mode)
 }
 
 /**
- * Resize the component and fill it with empty nodes and edges. Used when
- * loading from save games. The component is expected to be empty before.
+ * Resize the component and fill it with empty nodes. Used when loading from
+ * save games. The component is expected to be empty before.
  * @param size New size of the component.
  */
 void LinkGraph::Init(uint size)
 {
 	assert(this->Size() == 0);
-	this->edges.Resize(size, size);
 	this->nodes.resize(size);
 
 	for (uint i = 0; i < size; ++i) {
-		this->nodes[i].Init();
-		BaseEdge *column = this->edges[i];
-		for (uint j = 0; j < size; ++j) column[j].Init();
+		this->nodes[i] = std::make_shared<BaseNode>();
+		this->nodes[i]->Init();
 	}
 }
@@ -12,14 +12,16 @@
 
 #include "../core/pool_type.hpp"
 #include "../core/smallmap_type.hpp"
-#include "../core/smallmatrix_type.hpp"
 #include "../core/bitmath_func.hpp"
 #include "../station_base.h"
 #include "../cargotype.h"
 #include "../date_func.h"
 #include "../saveload/saveload_common.h"
 #include "linkgraph_type.h"
+#include <algorithm>
+#include <memory>
 #include <utility>
+#include <vector>
 
 class LinkGraph;
 
@@ -47,10 +49,49 @@ namespace upstream_sl {
 class LinkGraph : public LinkGraphPool::PoolItem<&_link_graph_pool> {
 public:
 
+	/**
+	 * An edge in the link graph. Corresponds to a link between two stations.
+	 */
+	struct BaseEdge {
+		uint capacity;                 ///< Capacity of the link.
+		uint usage;                    ///< Usage of the link.
+		Date last_unrestricted_update; ///< When the unrestricted part of the link was last updated.
+		Date last_restricted_update;   ///< When the restricted part of the link was last updated.
+		Date last_aircraft_update;     ///< When aircraft capacity of the link was last updated.
+		NodeID dest_node;              ///< Destination of the link.
+		void Init(NodeID dest_node = INVALID_NODE);
+	};
+
+	/**
+	 * Demands of a node as calculated by a previous link graph job. These are
+	 * reused by the DemandCalculator if the node's component hasn't changed
+	 * much since. This is part of the game state and saved with the link graph.
+	 */
+	struct DemandCache {
+		uint32 key;             ///< Settings the demands were calculated with.
+		uint supply;            ///< Supply of the node when the demands were calculated.
+		uint acceptance;        ///< Acceptance of the node when the demands were calculated.
+		uint16 component_size;  ///< Number of nodes of the component when the demands were calculated, 0 if there are no cached demands.
+		std::vector<std::pair<StationID, uint>> demands; ///< Demands towards other stations.
+
+		/** Invalidate the cache. */
+		void Clear()
+		{
+			this->key = 0;
+			this->supply = 0;
+			this->acceptance = 0;
+			this->component_size = 0;
+			this->demands.clear();
+		}
+	};
+
 	/**
 	 * Node of the link graph. contains all relevant information from the associated
 	 * station. It's copied so that the link graph job can work on its own data set
 	 * in a separate thread.
+	 * Only the real links (those with capacity) are stored as edges, so memory
+	 * and copying scale with the number of links rather than the square of the
+	 * number of nodes.
 	 */
 	struct BaseNode {
 		uint supply;             ///< Supply at the station.
@@ -58,25 +99,45 @@ public:
 		StationID station;       ///< Station ID.
 		TileIndex xy;            ///< Location of the station referred to by the node.
 		Date last_update;        ///< When the supply was last updated.
+		std::vector<BaseEdge> edges; ///< Outgoing edges, sorted by destination node.
+		DemandCache demand_cache; ///< Demands calculated for this node by the last job which didn't reuse them.
 		void Init(TileIndex xy = INVALID_TILE, StationID st = INVALID_STATION, uint demand = 0);
-	};
 
-	/**
-	 * An edge in the link graph. Corresponds to a link between two stations or at
-	 * least the distance between them. Edges from one node to itself contain the
-	 * ID of the opposite Node of the first active edge (i.e. not just distance) in
-	 * the column as next_edge.
-	 */
-	struct BaseEdge {
-		uint capacity;                 ///< Capacity of the link.
-		uint usage;                    ///< Usage of the link.
-		Date last_unrestricted_update; ///< When the unrestricted part of the link was last updated.
-		Date last_restricted_update;   ///< When the restricted part of the link was last updated.
-		Date last_aircraft_update;     ///< When aircraft capacity of the link was last updated.
-		NodeID next_edge;              ///< Destination of next valid edge starting at the same source node.
-		void Init();
+		/**
+		 * Get the position of the edge to a node, or of where it would have to be inserted.
+		 * @param to Destination node.
+		 * @return Iterator to the first edge with a destination not lower than to.
+		 */
+		inline std::vector<BaseEdge>::const_iterator FindEdgePosition(NodeID to) const
+		{
+			return std::lower_bound(this->edges.begin(), this->edges.end(), to, [](const BaseEdge &edge, NodeID to) { return edge.dest_node < to; });
+		}
+
+		/**
+		 * Get the edge to a node.
+		 * @param to Destination node.
+		 * @return The edge, or nullptr if there is no link to the node.
+		 */
+		inline const BaseEdge *GetEdge(NodeID to) const
+		{
+			auto iter = this->FindEdgePosition(to);
+			return (iter != this->edges.end() && iter->dest_node == to) ? &*iter : nullptr;
+		}
+
+		/**
+		 * Get the edge to a node.
+		 * @param to Destination node.
+		 * @return The edge, or nullptr if there is no link to the node.
+		 */
+		inline BaseEdge *GetEdge(NodeID to)
+		{
+			return const_cast<BaseEdge *>(const_cast<const BaseNode *>(this)->GetEdge(to));
+		}
 	};
 
+	/** Edge with no capacity, used by ConstNode for pairs of nodes which are not linked. */
+	static const BaseEdge empty_edge;
+
 	/**
 	 * Wrapper for an edge (const or not) allowing retrieval, but no modification.
 	 * @tparam Tedge Actual edge class, may be "const BaseEdge" or just "BaseEdge".
@@ -133,14 +194,12 @@ public:
 
 	/**
 	 * Wrapper for a node (const or not) allowing retrieval, but no modification.
-	 * @tparam Tedge Actual node class, may be "const BaseNode" or just "BaseNode".
-	 * @tparam Tedge Actual edge class, may be "const BaseEdge" or just "BaseEdge".
+	 * @tparam Tnode Actual node class, may be "const BaseNode" or just "BaseNode".
 	 */
-	template<typename Tnode, typename Tedge>
+	template<typename Tnode>
 	class NodeWrapper {
 	protected:
-		Tnode &node;  ///< Node being wrapped.
-		Tedge *edges; ///< Outgoing edges for wrapped node.
+		Tnode *node;  ///< Node being wrapped.
 		NodeID index; ///< ID of wrapped node.
 
 	public:
@@ -148,47 +207,63 @@ public:
 		/**
 		 * Wrap a node.
 		 * @param node Node to be wrapped.
-		 * @param edges Outgoing edges for node to be wrapped.
 		 * @param index ID of node to be wrapped.
 		 */
-		NodeWrapper(Tnode &node, Tedge *edges, NodeID index) : node(node),
-			edges(edges), index(index) {}
+		NodeWrapper(Tnode &node, NodeID index) : node(&node), index(index) {}
 
 		/**
 		 * Get supply of wrapped node.
 		 * @return Supply.
 		 */
-		uint Supply() const { return this->node.supply; }
+		uint Supply() const { return this->node->supply; }
 
 		/**
 		 * Get demand of wrapped node.
 		 * @return Demand.
 		 */
-		uint Demand() const { return this->node.demand; }
+		uint Demand() const { return this->node->demand; }
 
 		/**
 		 * Get ID of station belonging to wrapped node.
 		 * @return ID of node's station.
 		 */
-		StationID Station() const { return this->node.station; }
+		StationID Station() const { return this->node->station; }
 
 		/**
 		 * Get node's last update.
 		 * @return Last update.
 		 */
-		Date LastUpdate() const { return this->node.last_update; }
+		Date LastUpdate() const { return this->node->last_update; }
 
 		/**
 		 * Get the location of the station associated with the node.
 		 * @return Location of the station.
 		 */
-		TileIndex XY() const { return this->node.xy; }
+		TileIndex XY() const { return this->node->xy; }
+
+		/**
+		 * Check whether there is a link from this node to another one.
+		 * @param to Destination node.
+		 * @return If there is an edge with capacity to the node.
+		 */
+		bool HasEdgeTo(NodeID to) const { return this->node->GetEdge(to) != nullptr; }
+
+		/**
+		 * Get the number of outgoing links of this node.
+		 * @return Number of edges.
+		 */
+		uint EdgeCount() const { return (uint)this->node->edges.size(); }
+
+		/**
+		 * Get the demands calculated for this node by a previous job.
+		 * @return Demand cache.
+		 */
+		const DemandCache &GetDemandCache() const { return this->node->demand_cache; }
 	};
 
 	/**
-	 * Base class for iterating across outgoing edges of a node. Only the real
-	 * edges (those with capacity) are iterated. The ones with only distance
-	 * information are skipped.
+	 * Base class for iterating across outgoing edges of a node, in order of
+	 * their destination.
 	 * @tparam Tedge Actual edge class. May be "BaseEdge" or "const BaseEdge".
 	 * @tparam Titer Actual iterator class.
 	 */
@@ -196,7 +271,7 @@ public:
 	class BaseEdgeIterator {
 	protected:
 		Tedge *base;    ///< Array of edges being iterated.
-		NodeID current; ///< Current offset in edges array.
+		size_t current; ///< Current offset in edges array.
 
 		/**
 		 * A "fake" pointer to enable operator-> on temporaries. As the objects
@@ -224,11 +299,11 @@ public:
 		/**
 		 * Constructor.
 		 * @param base Array of edges to be iterated.
-		 * @param current ID of current node (to locate the first edge).
+		 * @param current Offset of the current edge in the array.
 		 */
-		BaseEdgeIterator (Tedge *base, NodeID current) :
+		BaseEdgeIterator (Tedge *base, size_t current) :
 			base(base),
-			current(current == INVALID_NODE ? current : base[current].next_edge)
+			current(current)
 		{}
 
 		/**
@@ -237,7 +312,7 @@ public:
 		 */
 		Titer &operator++()
 		{
-			this->current = this->base[this->current].next_edge;
+			this->current++;
 			return static_cast<Titer &>(*this);
 		}
 
@@ -248,7 +323,7 @@ public:
 		Titer operator++(int)
 		{
 			Titer ret(static_cast<Titer &>(*this));
-			this->current = this->base[this->current].next_edge;
+			this->current++;
 			return ret;
 		}
 
@@ -257,7 +332,7 @@ public:
 		 * child class.
 		 * @tparam Tother Class of other iterator.
 		 * @param other Instance of other iterator.
-		 * @return If the iterators have the same edge array and current node.
+		 * @return If the iterators have the same edge array and current offset.
 		 */
 		template<class Tother>
 		bool operator==(const Tother &other)
@@ -270,7 +345,7 @@ public:
 		 * may be of a child class.
 		 * @tparam Tother Class of other iterator.
 		 * @param other Instance of other iterator.
-		 * @return If either the edge arrays or the current nodes differ.
+		 * @return If either the edge arrays or the current offsets differ.
 		 */
 		template<class Tother>
 		bool operator!=(const Tother &other)
@@ -284,7 +359,7 @@ public:
 		 */
 		std::pair<NodeID, Tedge_wrapper> operator*() const
 		{
-			return std::pair<NodeID, Tedge_wrapper>(this->current, Tedge_wrapper(this->base[this->current]));
+			return std::pair<NodeID, Tedge_wrapper>(this->base[this->current].dest_node, Tedge_wrapper(this->base[this->current]));
 		}
 
 		/**
@@ -326,9 +401,9 @@ public:
 		/**
 		 * Constructor.
 		 * @param edges Array of edges to be iterated over.
-		 * @param current ID of current edge's end node.
+		 * @param current Offset of the current edge.
 		 */
-		ConstEdgeIterator(const BaseEdge *edges, NodeID current) :
+		ConstEdgeIterator(const BaseEdge *edges, size_t current) :
 			BaseEdgeIterator<const BaseEdge, ConstEdge, ConstEdgeIterator>(edges, current) {}
 	};
 
@@ -341,9 +416,9 @@ public:
 		/**
 		 * Constructor.
 		 * @param edges Array of edges to be iterated over.
-		 * @param current ID of current edge's end node.
+		 * @param current Offset of the current edge.
 		 */
-		EdgeIterator(BaseEdge *edges, NodeID current) :
+		EdgeIterator(BaseEdge *edges, size_t current) :
 			BaseEdgeIterator<BaseEdge, Edge, EdgeIterator>(edges, current) {}
 	};
 
@@ -351,7 +426,7 @@ public:
 	 * Constant node class. Only retrieval operations are allowed on both the
 	 * node itself and its edges.
 	 */
-	class ConstNode : public NodeWrapper<const BaseNode, const BaseEdge> {
+	class ConstNode : public NodeWrapper<const BaseNode> {
 	public:
 		/**
 		 * Constructor.
@@ -359,34 +434,53 @@ public:
 		 * @param node ID of the node.
 		 */
 		ConstNode(const LinkGraph *lg, NodeID node) :
-			NodeWrapper<const BaseNode, const BaseEdge>(lg->nodes[node], lg->edges[node], node)
+			NodeWrapper<const BaseNode>(*lg->nodes[node], node)
 		{}
 
 		/**
 		 * Get a ConstEdge. This is not a reference as the wrapper objects are
-		 * not actually persistent.
+		 * not actually persistent. If there is no link to the node, an edge
+		 * without capacity and with invalid update dates is returned.
 		 * @param to ID of end node of edge.
 		 * @return Constant edge wrapper.
 		 */
-		ConstEdge operator[](NodeID to) const { return ConstEdge(this->edges[to]); }
+		ConstEdge operator[](NodeID to) const
+		{
+			const BaseEdge *edge = this->node->GetEdge(to);
+			return ConstEdge(edge != nullptr ? *edge : LinkGraph::empty_edge);
+		}
 
 		/**
 		 * Get an iterator pointing to the start of the edges array.
 		 * @return Constant edge iterator.
 		 */
-		ConstEdgeIterator Begin() const { return ConstEdgeIterator(this->edges, this->index); }
+		ConstEdgeIterator Begin() const { return ConstEdgeIterator(this->node->edges.data(), 0); }
 
 		/**
 		 * Get an iterator pointing beyond the end of the edges array.
 		 * @return Constant edge iterator.
 		 */
-		ConstEdgeIterator End() const { return ConstEdgeIterator(this->edges, INVALID_NODE); }
+		ConstEdgeIterator End() const { return ConstEdgeIterator(this->node->edges.data(), this->node->edges.size()); }
 	};
 
 	/**
 	 * Updatable node class. The node itself as well as its edges can be modified.
+	 * Reading through this wrapper never copies the node. Modifying it copies the
+	 * node first if it is still shared with the snapshot of a running job.
 	 */
-	class Node : public NodeWrapper<BaseNode, BaseEdge> {
+	class Node : public NodeWrapper<BaseNode> {
+		LinkGraph *lg; ///< Link graph the node belongs to.
+
+		/**
+		 * Get the wrapped node for modification, unsharing it first if necessary.
+		 * @return Node which is only referenced by this link graph.
+		 */
+		BaseNode &Modify()
+		{
+			this->node = &this->lg->MutableNode(this->index);
+			return *this->node;
+		}
+
 	public:
 		/**
 		 * Constructor.
@@ -394,28 +488,36 @@ public:
 		 * @param node ID of the node.
 		 */
 		Node(LinkGraph *lg, NodeID node) :
-			NodeWrapper<BaseNode, BaseEdge>(lg->nodes[node], lg->edges[node], node)
+			NodeWrapper<BaseNode>(*lg->nodes[node], node), lg(lg)
 		{}
 
 		/**
 		 * Get an Edge. This is not a reference as the wrapper objects are not
-		 * actually persistent.
+		 * actually persistent. The edge must exist, check with HasEdgeTo() or
+		 * use a ConstNode if unsure.
 		 * @param to ID of end node of edge.
 		 * @return Edge wrapper.
 		 */
-		Edge operator[](NodeID to) { return Edge(this->edges[to]); }
+		Edge operator[](NodeID to)
+		{
+			BaseEdge *edge = this->Modify().GetEdge(to);
+			assert(edge != nullptr);
+			return Edge(*edge);
+		}
 
 		/**
 		 * Get an iterator pointing to the start of the edges array.
+		 * Adding or removing edges of this node invalidates the iterator.
+		 * Use a ConstNode to only read the edges.
 		 * @return Edge iterator.
 		 */
-		EdgeIterator Begin() { return EdgeIterator(this->edges, this->index); }
+		EdgeIterator Begin() { return EdgeIterator(this->Modify().edges.data(), 0); }
 
 		/**
 		 * Get an iterator pointing beyond the end of the edges array.
 		 * @return Constant edge iterator.
 		 */
-		EdgeIterator End() { return EdgeIterator(this->edges, INVALID_NODE); }
+		EdgeIterator End() { return EdgeIterator(this->Modify().edges.data(), this->node->edges.size()); }
 
 		/**
 		 * Update the node's supply and set last_update to the current date.
@@ -423,8 +525,9 @@ public:
 		 */
 		void UpdateSupply(uint supply)
 		{
-			this->node.supply += supply;
-			this->node.last_update = _date;
+			BaseNode &node = this->Modify();
+			node.supply += supply;
+			node.last_update = _date;
 		}
 
 		/**
@@ -433,7 +536,7 @@ public:
 		 */
 		void UpdateLocation(TileIndex xy)
 		{
-			this->node.xy = xy;
+			this->Modify().xy = xy;
 		}
 
 		/**
@@ -442,7 +545,24 @@ public:
 		 */
 		void SetDemand(uint demand)
 		{
-			this->node.demand = demand;
+			if (this->node->demand != demand) this->Modify().demand = demand;
+		}
+
+		/**
+		 * Replace the demands cached for this node.
+		 * @param cache New demand cache.
+		 */
+		void SetDemandCache(DemandCache &&cache)
+		{
+			this->Modify().demand_cache = std::move(cache);
+		}
+
+		/**
+		 * Invalidate the demands cached for this node.
+		 */
+		void ClearDemandCache()
+		{
+			if (this->node->demand_cache.component_size != 0) this->Modify().demand_cache.Clear();
 		}
 
 		void AddEdge(NodeID to, uint capacity, uint usage, EdgeUpdateMode mode);
@@ -450,8 +570,12 @@ public:
 		void RemoveEdge(NodeID to);
 	};
 
-	typedef std::vector<BaseNode> NodeVector;
-	typedef SmallMatrix<BaseEdge> EdgeMatrix;
+	/**
+	 * Nodes are shared between a link graph and the snapshots of it taken by
+	 * link graph jobs. A node is only copied when it is modified while shared,
+	 * see MutableNode.
+	 */
+	typedef std::vector<std::shared_ptr<BaseNode>> NodeVector;
 
 	/** Minimum effective distance for timeout calculation. */
 	static const uint MIN_TIMEOUT_DISTANCE = 32;
@@ -561,8 +685,22 @@ protected:
 
 	CargoID cargo;         ///< Cargo of this component's link graph.
 	Date last_compression; ///< Last time the capacities and supplies were compressed.
-	NodeVector nodes;      ///< Nodes in the component.
-	EdgeMatrix edges;      ///< Edges in the component.
+	NodeVector nodes;      ///< Nodes in the component, including their edges.
+
+	/**
+	 * Get a node for modification. If the node is shared with the snapshot of a
+	 * running job it is copied first, so that the job keeps seeing the old state.
+	 * The reference counts are only changed in the main thread, when jobs are
+	 * spawned and joined, so they can be checked here without further locking.
+	 * @param id ID of the node.
+	 * @return Node which is only referenced by this link graph.
+	 */
+	BaseNode &MutableNode(NodeID id)
+	{
+		std::shared_ptr<BaseNode> &node = this->nodes[id];
+		if (node.use_count() > 1) node = std::make_shared<BaseNode>(*node);
+		return *node;
+	}
 };
 
 #endif /* LINKGRAPH_H */
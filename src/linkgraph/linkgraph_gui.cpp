@@ -177,13 +177,14 @@ void LinkGraphOverlay::RebuildCache(bool incremental)
 		}
 	};
 
+	this->ResetStationMiddleCache();
 	const size_t previous_cached_stations_count = this->cached_stations.size();
 	for (const Station *sta : Station::Iterate()) {
 		if (sta->rect.IsEmpty()) continue;
 
 		if (incremental && std::binary_search(incremental_station_exclude.begin(), incremental_station_exclude.end(), sta->index)) continue;
 
-		Point pta = this->GetStationMiddle(sta);
+		Point pta = this->GetCachedStationMiddle(sta);
 
 		StationID from = sta->index;
 
@@ -216,7 +217,7 @@ void LinkGraphOverlay::RebuildCache(bool incremental)
 					continue;
 				}
 
-				Point ptb = this->GetStationMiddle(stb);
+				Point ptb = this->GetCachedStationMiddle(stb);
 
 				if (!cache_all && !this->IsLinkVisible(pta, ptb, &dpi)) continue;
 
@@ -359,11 +360,12 @@ inline bool LinkGraphOverlay::IsLinkVisible(Point pta, Point ptb, const DrawPixe
 
 void LinkGraphOverlay::RefreshDrawCache()
 {
+	this->ResetStationMiddleCache();
 	for (StationSupplyList::iterator i(this->cached_stations.begin()); i != this->cached_stations.end(); ++i) {
 		const Station *st = Station::GetIfValid(i->id);
 		if (st == nullptr) continue;
 
-		i->pt = this->GetStationMiddle(st);
+		i->pt = this->GetCachedStationMiddle(st);
 	}
 	for (LinkList::iterator i(this->cached_links.begin()); i != this->cached_links.end(); ++i) {
 		const Station *sta = Station::GetIfValid(i->from_id);
@@ -371,11 +373,32 @@ void LinkGraphOverlay::RefreshDrawCache()
 		const Station *stb = Station::GetIfValid(i->to_id);
 		if (stb == nullptr) continue;
 
-		i->from_pt = this->GetStationMiddle(sta);
-		i->to_pt = this->GetStationMiddle(stb);
+		i->from_pt = this->GetCachedStationMiddle(sta);
+		i->to_pt = this->GetCachedStationMiddle(stb);
 	}
 }
 
+/**
+ * Forget the cached station middles, e.g. because the viewport moved or stations changed.
+ */
+void LinkGraphOverlay::ResetStationMiddleCache()
+{
+	this->station_middle_cache.assign(Station::GetPoolSize(), { INT_MIN, INT_MIN });
+}
+
+/**
+ * Get the middle of a station, looking it up only once per cache reset.
+ * Stations are usually the end of several links, and looking up the height of a station tile is not free.
+ * @param st Station to get the middle of.
+ * @return The middle of the station in screen coordinates.
+ */
+Point LinkGraphOverlay::GetCachedStationMiddle(const Station *st)
+{
+	Point &pt = this->station_middle_cache[st->index];
+	if (pt.x == INT_MIN) pt = this->GetStationMiddle(st);
+	return pt;
+}
+
 /**
  * Draw the linkgraph overlay or some part of it, in the area given.
  * @param dpi Area to be drawn to.
@@ -94,8 +94,11 @@ protected:
 	uint scale;                        ///< Width of link lines.
 	bool dirty;                        ///< Set if overlay should be rebuilt.
 	uint64 last_update_number = 0;     ///< Last window update number
+	std::vector<Point> station_middle_cache; ///< Station middles by station ID, only valid during RebuildCache and RefreshDrawCache.
 
 	Point GetStationMiddle(const Station *st) const;
+	void ResetStationMiddleCache();
+	Point GetCachedStationMiddle(const Station *st);
 
 	void RefreshDrawCache();
 	void DrawLinks(const DrawPixelInfo *dpi) const;
@@ -12,6 +12,7 @@
 #include "../window_func.h"
 #include "linkgraphjob.h"
 #include "linkgraphschedule.h"
+#include "demands.h"
 
 #include "../safeguards.h"
 
@@ -43,7 +44,8 @@ static DateTicks GetLinkGraphJobJoinDateTicks(uint duration_multiplier)
  */
 LinkGraphJob::LinkGraphJob(const LinkGraph &orig, uint duration_multiplier) :
 		/* Copying the link graph here also copies its index member.
-		 * This is on purpose. */
+		 * This is on purpose. Only the node pointers are copied, the
+		 * game-side graph copies any node it modifies while the job runs. */
 		link_graph(orig),
 		settings(_settings_game.linkgraph),
 		join_date_ticks(GetLinkGraphJobJoinDateTicks(duration_multiplier)),
@@ -51,6 +53,7 @@ LinkGraphJob::LinkGraphJob(const LinkGraph &orig, uint duration_multiplier) :
 		job_completed(false),
 		job_aborted(false)
 {
+	this->telemetry.spawn_time = GetPerformanceTimer();
 }
 
 /**
@@ -93,7 +96,9 @@ LinkGraphJob::~LinkGraphJob()
  */
 void LinkGraphJob::FinaliseJob()
 {
+	this->telemetry.join_start_time = GetPerformanceTimer();
 	this->JoinThread();
+	this->telemetry.join_end_time = GetPerformanceTimer();
 
 	/* If the job has been aborted, the job state is invalid.
 	 * This should never be reached, as once the job has been marked as aborted
@@ -122,11 +127,13 @@ void LinkGraphJob::FinaliseJob()
 			continue;
 		}
 
-		LinkGraph *lg = LinkGraph::Get(ge.link_graph);
+		this->UpdateDemandCache(node_id, *LinkGraph::Get(ge.link_graph));
+
+		const LinkGraph *lg = LinkGraph::Get(ge.link_graph);
 		FlowStatMap &flows = from.Flows();
 
 		for (EdgeIterator it(from.Begin()); it != from.End(); ++it) {
-			if (from[it->first].Flow() == 0) continue;
+			if (it->second.Flow() == 0) continue;
 			StationID to = (*this)[it->first].Station();
 			Station *st2 = Station::GetIfValid(to);
 			if (st2 == nullptr || st2->goods[this->Cargo()].link_graph != this->link_graph.index ||
@@ -187,6 +194,34 @@ void LinkGraphJob::FinaliseJob()
 	}
 }
 
+/**
+ * Store the demands calculated for a node in the demand cache of the game-side
+ * link graph, so that the next job can reuse them.
+ * @param node_id Node to update the cache for.
+ * @param lg Link graph the node belongs to, which must still be the same node.
+ */
+void LinkGraphJob::UpdateDemandCache(NodeID node_id, LinkGraph &lg)
+{
+	if (this->settings.demand_reuse_threshold == 0) {
+		lg[node_id].ClearDemandCache();
+		return;
+	}
+
+	Node node = (*this)[node_id];
+	if (node.DemandComponentSize() == 0) return; // Demands were reused, keep the original cache.
+
+	LinkGraph::DemandCache cache;
+	cache.key = DemandCalculator::GetCacheKey(this->settings, this->Cargo());
+	cache.supply = node.Supply();
+	cache.acceptance = node.Demand();
+	cache.component_size = node.DemandComponentSize();
+	cache.demands.reserve(node.Demands().size());
+	for (const DemandAnnotation &demand : node.Demands()) {
+		cache.demands.emplace_back(this->link_graph[demand.dest].Station(), demand.demand);
+	}
+	lg[node_id].SetDemandCache(std::move(cache));
+}
+
 /**
  * Initialize the link graph job: Resize nodes and edges and populate them.
  * This is done after the constructor so that we can do it in the calculation
@@ -196,35 +231,46 @@ void LinkGraphJob::Init()
 {
 	uint size = this->Size();
 	this->nodes.resize(size);
-	this->edges.Resize(size, size);
 	for (uint i = 0; i < size; ++i) {
-		this->nodes[i].Init(this->link_graph[i].Supply());
-		EdgeAnnotation *node_edges = this->edges[i];
-		for (uint j = 0; j < size; ++j) {
-			node_edges[j].Init();
-		}
+		LinkGraph::ConstNode node = this->link_graph[i];
+		this->nodes[i].Init(node.Supply(), node.EdgeCount());
 	}
 }
 
 /**
- * Initialize a linkgraph job edge.
+ * Initialize a Linkgraph job node and the annotations of its edges.
+ * @param supply Initial undelivered supply.
+ * @param num_edges Number of outgoing edges of the node.
  */
-void LinkGraphJob::EdgeAnnotation::Init()
+void LinkGraphJob::NodeAnnotation::Init(uint supply, size_t num_edges)
 {
-	this->demand = 0;
-	this->flow = 0;
-	this->unsatisfied_demand = 0;
+	this->undelivered_supply = supply;
+	this->received_demand = 0;
+	this->edges.assign(num_edges, EdgeAnnotation{ 0 });
+	this->demands.clear();
+	this->demand_component_size = 0;
 }
 
 /**
- * Initialize a Linkgraph job node. The underlying memory is expected to be
- * freshly allocated, without any constructors having been called.
- * @param supply Initial undelivered supply.
+ * Sort the demands of this node by destination and merge those with the same
+ * destination. Has to be called after all supply has been delivered.
  */
-void LinkGraphJob::NodeAnnotation::Init(uint supply)
+void LinkGraphJob::Node::SortDemands()
 {
-	this->undelivered_supply = supply;
-	this->received_demand = 0;
+	DemandAnnotationVector &demands = this->node_anno.demands;
+	std::stable_sort(demands.begin(), demands.end(), [](const DemandAnnotation &a, const DemandAnnotation &b) {
+		return a.dest < b.dest;
+	});
+	auto out = demands.begin();
+	for (auto it = demands.begin(); it != demands.end(); ++it) {
+		if (out != demands.begin() && (out - 1)->dest == it->dest) {
+			(out - 1)->demand += it->demand;
+			(out - 1)->unsatisfied_demand += it->unsatisfied_demand;
+		} else {
+			*out++ = *it;
+		}
+	}
+	demands.erase(out, demands.end());
 }
 
 /**
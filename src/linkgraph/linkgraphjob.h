@@ -12,6 +12,7 @@
 
 #include "../thread.h"
 #include "../core/dyn_arena_alloc.hpp"
+#include "../framerate_type.h"
 #include "linkgraph.h"
 #include <vector>
 #include <memory>
@@ -27,19 +28,81 @@ typedef Pool<LinkGraphJob, LinkGraphJobID, 32, 0xFFFF> LinkGraphJobPool;
 /** The actual pool with link graph jobs. */
 extern LinkGraphJobPool _link_graph_job_pool;
 
+/** Stages of a link graph job, in order of execution. Each stage is run by one handler of the link graph schedule. */
+enum LinkGraphJobStage : uint8 {
+	LGJS_INIT,          ///< InitHandler
+	LGJS_DEMANDS,       ///< DemandCalculator
+	LGJS_MCF1,          ///< MCF1stPass
+	LGJS_FLOWMAPPER1,   ///< FlowMapper after the first MCF pass
+	LGJS_MCF2,          ///< MCF2ndPass
+	LGJS_FLOWMAPPER2,   ///< FlowMapper after the second MCF pass
+	LGJS_END,
+};
+
+/**
+ * Sizes and wall clock timings of a link graph job, for diagnostics.
+ * This is not part of the game state. All times are from GetPerformanceTimer, 0 means not (yet) measured.
+ */
+struct LinkGraphJobTelemetry {
+	LinkGraphID link_graph = INVALID_LINK_GRAPH; ///< ID of the link graph the job ran on.
+	CargoID cargo = CT_INVALID;                  ///< Cargo of the link graph.
+	uint nodes = 0;                              ///< Number of nodes of the link graph.
+	uint edges = 0;                              ///< Number of edges of the link graph.
+	TimingMeasurement spawn_time = 0;            ///< When the job was spawned (or loaded).
+	TimingMeasurement run_start_time = 0;        ///< When a thread started running the job.
+	TimingMeasurement run_end_time = 0;          ///< When the job finished running.
+	TimingMeasurement pause_time = 0;            ///< When the game was paused because the job was due but not finished.
+	TimingMeasurement join_start_time = 0;       ///< When the main thread started joining the job.
+	TimingMeasurement join_end_time = 0;         ///< When the main thread had joined the job, before applying its results.
+	TimingMeasurement finalise_end_time = 0;     ///< When the results of the job had been applied.
+	TimingMeasurement stage_durations[LGJS_END] = {}; ///< Time spent in each stage.
+
+	/** Get the time the job waited for a thread to run it. */
+	inline TimingMeasurement QueueWait() const { return this->run_start_time - this->spawn_time; }
+
+	/** Get the time the job took to run. */
+	inline TimingMeasurement RunTime() const { return this->run_end_time - this->run_start_time; }
+
+	/** Get how late the job was, measured from the first pause waiting for it, or else from the start of the join, until it had been joined. */
+	inline TimingMeasurement JoinLateness() const { return this->join_end_time - (this->pause_time != 0 ? this->pause_time : this->join_start_time); }
+
+	/** Get the time spent applying the results of the job. */
+	inline TimingMeasurement FinaliseTime() const { return this->finalise_end_time - this->join_end_time; }
+};
+
 /**
  * Class for calculation jobs to be run on link graphs.
  */
 class LinkGraphJob : public LinkGraphJobPool::PoolItem<&_link_graph_job_pool>{
+private:
+public:
+	/**
+	 * Transport demand from a node to another one.
+	 */
+	struct DemandAnnotation {
+		NodeID dest;             ///< Destination of the demand.
+		uint demand;             ///< Transport demand between the nodes.
+		uint unsatisfied_demand; ///< Demand that hasn't been satisfied by flows yet.
+
+		/**
+		 * Satisfy some demand.
+		 * @param demand Demand to be satisfied.
+		 */
+		void SatisfyDemand(uint demand)
+		{
+			assert(demand <= this->unsatisfied_demand);
+			this->unsatisfied_demand -= demand;
+		}
+	};
+
+	typedef std::vector<DemandAnnotation> DemandAnnotationVector;
+
 private:
 	/**
 	 * Annotation for a link graph edge.
 	 */
 	struct EdgeAnnotation {
-		uint demand;             ///< Transport demand between the nodes.
-		uint unsatisfied_demand; ///< Demand over this edge that hasn't been satisfied yet.
 		uint flow;               ///< Planned flow over this edge.
-		void Init();
 	};
 
 	/**
@@ -50,11 +113,13 @@ private:
 		uint received_demand;    ///< Received demand towards this node.
 		PathList paths;          ///< Paths through this node, sorted so that those with flow == 0 are in the back.
 		FlowStatMap flows;       ///< Planned flows to other nodes.
-		void Init(uint supply);
+		std::vector<EdgeAnnotation> edges; ///< Annotations of the outgoing edges, in the same order as the edges of the link graph node.
+		DemandAnnotationVector demands;    ///< Demands towards other nodes, sorted by destination once the demands have been calculated.
+		uint16 demand_component_size;      ///< Size of the component if the demands have been calculated rather than reused from the cache, 0 otherwise.
+		void Init(uint supply, size_t num_edges);
 	};
 
 	typedef std::vector<NodeAnnotation> NodeAnnotationVector;
-	typedef SmallMatrix<EdgeAnnotation> EdgeAnnotationMatrix;
 
 	friend SaveLoadTable GetLinkGraphJobDesc();
 	friend upstream_sl::SaveLoadTable upstream_sl::GetLinkGraphJobDesc();
@@ -63,17 +128,18 @@ private:
 	friend class LinkGraphJobGroup;
 
 protected:
-	const LinkGraph link_graph;       ///< Link graph to by analyzed. Is copied when job is started and mustn't be modified later.
+	const LinkGraph link_graph;       ///< Link graph to by analyzed. Is a snapshot sharing the nodes with the original graph, taken when the job is started and mustn't be modified later.
 	std::shared_ptr<LinkGraphJobGroup> group; ///< Job group thread the job is running in or nullptr if it's running in the main thread.
 	const LinkGraphSettings settings; ///< Copy of _settings_game.linkgraph at spawn time.
 	DateTicks join_date_ticks;        ///< Date when the job is to be joined.
 	DateTicks start_date_ticks;       ///< Date when the job was started.
-	NodeAnnotationVector nodes;       ///< Extra node data necessary for link graph calculation.
-	EdgeAnnotationMatrix edges;       ///< Extra edge data necessary for link graph calculation.
+	NodeAnnotationVector nodes;       ///< Extra node and edge data necessary for link graph calculation.
 	std::atomic<bool> job_completed;  ///< Is the job still running. This is accessed by multiple threads and reads may be stale.
 	std::atomic<bool> job_aborted;    ///< Has the job been aborted. This is accessed by multiple threads and reads may be stale.
+	LinkGraphJobTelemetry telemetry;  ///< Sizes and timings of the job. The run fields are written by the thread running the job, and must only be read after joining it.
 
 	void EraseFlows(NodeID from);
+	void UpdateDemandCache(NodeID node_id, LinkGraph &lg);
 	void JoinThread();
 	void SetJobGroup(std::shared_ptr<LinkGraphJobGroup> group);
 
@@ -97,18 +163,6 @@ public:
 		Edge(const LinkGraph::BaseEdge &edge, EdgeAnnotation &anno) :
 				LinkGraph::ConstEdge(edge), anno(anno) {}
 
-		/**
-		 * Get the transport demand between end the points of the edge.
-		 * @return Demand.
-		 */
-		uint Demand() const { return this->anno.demand; }
-
-		/**
-		 * Get the transport demand that hasn't been satisfied by flows, yet.
-		 * @return Unsatisfied demand.
-		 */
-		uint UnsatisfiedDemand() const { return this->anno.unsatisfied_demand; }
-
 		/**
 		 * Get the total flow on the edge.
 		 * @return Flow.
@@ -130,26 +184,6 @@ public:
 			assert(flow <= this->anno.flow);
 			this->anno.flow -= flow;
 		}
-
-		/**
-		 * Add some (not yet satisfied) demand.
-		 * @param demand Demand to be added.
-		 */
-		void AddDemand(uint demand)
-		{
-			this->anno.demand += demand;
-			this->anno.unsatisfied_demand += demand;
-		}
-
-		/**
-		 * Satisfy some demand.
-		 * @param demand Demand to be satisfied.
-		 */
-		void SatisfyDemand(uint demand)
-		{
-			assert(demand <= this->anno.unsatisfied_demand);
-			this->anno.unsatisfied_demand -= demand;
-		}
 	};
 
 	/**
@@ -164,7 +198,7 @@ public:
 		 * @param base_anno Array of annotations to be iterated.
 		 * @param current Start offset of iteration.
 		 */
-		EdgeIterator(const LinkGraph::BaseEdge *base, EdgeAnnotation *base_anno, NodeID current) :
+		EdgeIterator(const LinkGraph::BaseEdge *base, EdgeAnnotation *base_anno, size_t current) :
 				LinkGraph::BaseEdgeIterator<const LinkGraph::BaseEdge, Edge, EdgeIterator>(base, current),
 				base_anno(base_anno) {}
 
@@ -175,7 +209,7 @@ public:
 		 */
 		std::pair<NodeID, Edge> operator*() const
 		{
-			return std::pair<NodeID, Edge>(this->current, Edge(this->base[this->current], this->base_anno[this->current]));
+			return std::pair<NodeID, Edge>(this->base[this->current].dest_node, Edge(this->base[this->current], this->base_anno[this->current]));
 		}
 
 		/**
@@ -195,7 +229,6 @@ public:
 	class Node : public LinkGraph::ConstNode {
 	private:
 		NodeAnnotation &node_anno;  ///< Annotation being wrapped.
-		EdgeAnnotation *edge_annos; ///< Edge annotations belonging to this node.
 	public:
 
 		/**
@@ -205,30 +238,33 @@ public:
 		 */
 		Node (LinkGraphJob *lgj, NodeID node) :
 			LinkGraph::ConstNode(&lgj->link_graph, node),
-			node_anno(lgj->nodes[node]), edge_annos(lgj->edges[node])
+			node_anno(lgj->nodes[node])
 		{}
 
 		/**
 		 * Retrieve an edge starting at this node. Mind that this returns an
-		 * object, not a reference.
+		 * object, not a reference. The edge must exist.
 		 * @param to Remote end of the edge.
 		 * @return Edge between this node and "to".
 		 */
-		Edge operator[](NodeID to) const { return Edge(this->edges[to], this->edge_annos[to]); }
+		Edge operator[](NodeID to) const
+		{
+			auto iter = this->node->FindEdgePosition(to);
+			assert(iter != this->node->edges.end() && iter->dest_node == to);
+			return Edge(*iter, this->node_anno.edges[iter - this->node->edges.begin()]);
+		}
 
 		/**
-		 * Iterator for the "begin" of the edge array. Only edges with capacity
-		 * are iterated. The others are skipped.
+		 * Iterator for the "begin" of the edge array.
 		 * @return Iterator pointing to the first edge.
 		 */
-		EdgeIterator Begin() const { return EdgeIterator(this->edges, this->edge_annos, index); }
+		EdgeIterator Begin() const { return EdgeIterator(this->node->edges.data(), this->node_anno.edges.data(), 0); }
 
 		/**
-		 * Iterator for the "end" of the edge array. Only edges with capacity
-		 * are iterated. The others are skipped.
+		 * Iterator for the "end" of the edge array.
 		 * @return Iterator pointing beyond the last edge.
 		 */
-		EdgeIterator End() const { return EdgeIterator(this->edges, this->edge_annos, INVALID_NODE); }
+		EdgeIterator End() const { return EdgeIterator(this->node->edges.data(), this->node_anno.edges.data(), this->node->edges.size()); }
 
 		/**
 		 * Get amount of supply that hasn't been delivered, yet.
@@ -268,16 +304,52 @@ public:
 		const PathList &Paths() const { return this->node_anno.paths; }
 
 		/**
-		 * Deliver some supply, adding demand to the respective edge.
+		 * Get the demands from this node to others.
+		 * @return Demands.
+		 */
+		DemandAnnotationVector &Demands() { return this->node_anno.demands; }
+
+		/**
+		 * Get a constant version of the demands from this node to others.
+		 * @return Demands.
+		 */
+		const DemandAnnotationVector &Demands() const { return this->node_anno.demands; }
+
+		/**
+		 * Deliver some supply, adding demand towards the destination.
+		 * Demands are only appended here, SortDemands has to be called once all
+		 * supply has been delivered.
 		 * @param to Destination for supply.
 		 * @param amount Amount of supply to be delivered.
 		 */
 		void DeliverSupply(NodeID to, uint amount)
 		{
 			this->node_anno.undelivered_supply -= amount;
-			(*this)[to].AddDemand(amount);
+			if (amount == 0) return;
+			DemandAnnotationVector &demands = this->node_anno.demands;
+			if (!demands.empty() && demands.back().dest == to) {
+				demands.back().demand += amount;
+				demands.back().unsatisfied_demand += amount;
+			} else {
+				demands.push_back({ to, amount, amount });
+			}
 		}
 
+		void SortDemands();
+
+		/**
+		 * Mark the demands of this node as calculated, so that they are cached
+		 * when the job is finalised.
+		 * @param component_size Number of nodes in the node's component.
+		 */
+		void SetDemandsCalculated(uint16 component_size) { this->node_anno.demand_component_size = component_size; }
+
+		/**
+		 * Get the size of the component the demands were calculated for.
+		 * @return Component size, or 0 if the demands were reused from the cache.
+		 */
+		uint16 DemandComponentSize() const { return this->node_anno.demand_component_size; }
+
 		/**
 		 * Receive some demand, adding demand to the respective edge.
 		 * @param amount Amount of demand to be received.
@@ -293,7 +365,10 @@ public:
 	 * settings have to be brutally const-casted in order to populate them.
 	 */
 	LinkGraphJob() : settings(_settings_game.linkgraph),
-			join_date_ticks(INVALID_DATE), start_date_ticks(INVALID_DATE), job_completed(false), job_aborted(false) {}
+			join_date_ticks(INVALID_DATE), start_date_ticks(INVALID_DATE), job_completed(false), job_aborted(false)
+	{
+		this->telemetry.spawn_time = GetPerformanceTimer();
+	}
 
 	LinkGraphJob(const LinkGraph &orig, uint duration_multiplier);
 	~LinkGraphJob();
@@ -390,6 +465,12 @@ public:
 	 * @return Link graph.
 	 */
 	inline const LinkGraph &Graph() const { return this->link_graph; }
+
+	/**
+	 * Get the sizes and timings of the job.
+	 * @return Telemetry of the job.
+	 */
+	inline const LinkGraphJobTelemetry &Telemetry() const { return this->telemetry; }
 };
 
 /**
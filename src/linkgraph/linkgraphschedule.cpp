@@ -14,12 +14,153 @@
 #include "mcf.h"
 #include "flowmapper.h"
 #include "../framerate_type.h"
+#include "../trace.h"
 #include "../command_func.h"
 #include "../network/network.h"
+#include "../network/network_admin.h"
+#include "../core/math_func.hpp"
 #include <algorithm>
+#include <condition_variable>
+#include <mutex>
 
 #include "../safeguards.h"
 
+uint8 _config_linkgraph_threads = 0; ///< Configured number of link graph worker threads, 0 = automatic.
+
+/** Maximum number of link graph worker threads which will be started in automatic mode. */
+static const uint MAX_AUTO_LINKGRAPH_THREADS = 8;
+
+/**
+ * Pool of threads which run link graph job groups.
+ * Pending groups are started in order of join date, and within the same join date the most expensive group first,
+ * so that the groups which are due soonest, and which take longest, get the most time to complete.
+ * The completion order does not matter, jobs are still joined in the order of LinkGraphSchedule::running.
+ */
+class LinkGraphWorkerPool {
+	std::vector<std::thread> threads;
+	std::vector<std::shared_ptr<LinkGraphJobGroup>> pending; ///< Groups waiting to be run, highest priority last.
+	std::mutex lock;
+	std::condition_variable work_cv;
+	std::condition_variable done_cv;
+	bool exit = false;
+
+	static void Run(LinkGraphWorkerPool *pool);
+
+	static uint GetWantedThreads()
+	{
+		if (_config_linkgraph_threads != 0) return _config_linkgraph_threads;
+		uint hw = std::thread::hardware_concurrency();
+		return Clamp<uint>(hw > 1 ? hw - 1 : 1, 1, MAX_AUTO_LINKGRAPH_THREADS);
+	}
+
+	static bool IsLowerPriority(const std::shared_ptr<LinkGraphJobGroup> &a, const std::shared_ptr<LinkGraphJobGroup> &b)
+	{
+		if (a->join_date_ticks != b->join_date_ticks) return a->join_date_ticks > b->join_date_ticks;
+		return a->cost_estimate < b->cost_estimate;
+	}
+
+	void EnsureThreads();
+
+public:
+	~LinkGraphWorkerPool();
+
+	bool Submit(std::shared_ptr<LinkGraphJobGroup> group);
+	void Wait(LinkGraphJobGroup *group);
+};
+
+/**
+ * Start worker threads up to the configured number.
+ * Threads are only ever started here, surplus threads are left idle until the pool is destroyed.
+ * This must be called with the lock held.
+ */
+void LinkGraphWorkerPool::EnsureThreads()
+{
+	uint wanted = GetWantedThreads();
+	this->exit = false;
+	while (this->threads.size() < wanted) {
+		std::thread t;
+		if (!StartNewThread(&t, "ottd:linkgraph", &LinkGraphWorkerPool::Run, this)) break;
+		this->threads.push_back(std::move(t));
+	}
+}
+
+LinkGraphWorkerPool::~LinkGraphWorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(this->lock);
+		this->exit = true;
+	}
+	this->work_cv.notify_all();
+	for (std::thread &t : this->threads) {
+		if (t.joinable()) t.join();
+	}
+}
+
+/* static */ void LinkGraphWorkerPool::Run(LinkGraphWorkerPool *pool)
+{
+	std::unique_lock<std::mutex> lk(pool->lock);
+	while (true) {
+		pool->work_cv.wait(lk, [&]() { return pool->exit || !pool->pending.empty(); });
+		if (pool->pending.empty()) return;
+
+		std::shared_ptr<LinkGraphJobGroup> group = std::move(pool->pending.back());
+		pool->pending.pop_back();
+		group->state = LinkGraphJobGroup::State::Running;
+		lk.unlock();
+		LinkGraphJobGroup::Run(group.get());
+		lk.lock();
+		group->state = LinkGraphJobGroup::State::Done;
+		pool->done_cv.notify_all();
+	}
+}
+
+/**
+ * Queue a job group to be run by a worker thread.
+ * @param group Job group to run.
+ * @return false if no worker thread could be started, the group has not been queued in that case.
+ */
+bool LinkGraphWorkerPool::Submit(std::shared_ptr<LinkGraphJobGroup> group)
+{
+	{
+		std::lock_guard<std::mutex> guard(this->lock);
+		this->EnsureThreads();
+		if (this->threads.empty()) return false;
+		auto iter = std::upper_bound(this->pending.begin(), this->pending.end(), group, IsLowerPriority);
+		this->pending.insert(iter, std::move(group));
+	}
+	this->work_cv.notify_one();
+	return true;
+}
+
+/**
+ * Wait until a job group has been run.
+ * If no worker thread has picked up the group yet, it is run in the calling thread instead.
+ * @param group Job group to wait for.
+ */
+void LinkGraphWorkerPool::Wait(LinkGraphJobGroup *group)
+{
+	std::unique_lock<std::mutex> lk(this->lock);
+	if (group->state == LinkGraphJobGroup::State::Pending) {
+		auto iter = std::find_if(this->pending.begin(), this->pending.end(), [&](const std::shared_ptr<LinkGraphJobGroup> &it) { return it.get() == group; });
+		assert(iter != this->pending.end());
+		std::shared_ptr<LinkGraphJobGroup> keep_alive = std::move(*iter);
+		this->pending.erase(iter);
+		group->state = LinkGraphJobGroup::State::Running;
+		lk.unlock();
+		LinkGraphJobGroup::Run(group);
+		lk.lock();
+		group->state = LinkGraphJobGroup::State::Done;
+		return;
+	}
+	this->done_cv.wait(lk, [&]() { return group->state == LinkGraphJobGroup::State::Done; });
+}
+
+/**
+ * Worker pool for link graph jobs.
+ * This is defined before LinkGraphSchedule::instance, so that it is destroyed after any jobs of the schedule.
+ */
+static LinkGraphWorkerPool _linkgraph_worker_pool;
+
 /**
  * Static instance of LinkGraphSchedule.
  * Note: This instance is created on task start.
@@ -127,11 +268,40 @@ bool LinkGraphSchedule::IsJoinWithUnfinishedJobDue() const
 	return false;
 }
 
+/**
+ * Note that the game is being paused to wait for the jobs which are due to be joined, but not yet completed.
+ */
+void LinkGraphSchedule::MarkJoinDelayed()
+{
+	TimingMeasurement now = GetPerformanceTimer();
+	for (auto &it : this->running) {
+		if (!it->IsScheduledToBeJoined(2)) return;
+		if (!it->IsJobCompleted() && it->telemetry.pause_time == 0) it->telemetry.pause_time = now;
+	}
+}
+
+/**
+ * Record the telemetry of a joined job, and pass it on to the framerate window and the admin port.
+ * @param telemetry Telemetry of the job.
+ */
+void LinkGraphSchedule::RecordTelemetry(const LinkGraphJobTelemetry &telemetry)
+{
+	if (telemetry.run_end_time == 0) return;
+
+	PerformanceMeasurer::AddMeasurement(PFE_LINKGRAPH_JOBS, telemetry.run_start_time, telemetry.run_end_time);
+	if (_network_server) NetworkAdminLinkGraphJob(telemetry);
+
+	if (this->telemetry_history.size() >= TELEMETRY_HISTORY_SIZE) this->telemetry_history.pop_front();
+	this->telemetry_history.push_back(telemetry);
+}
+
 /**
  * Join the next finished job, if available.
  */
 void LinkGraphSchedule::JoinNext()
 {
+	TRACE_ZONE("LinkGraphSchedule::JoinNext");
+
 	while (!(this->running.empty())) {
 		if (!this->running.front()->IsScheduledToBeJoined()) return;
 		std::unique_ptr<LinkGraphJob> next = std::move(this->running.front());
@@ -139,6 +309,8 @@ void LinkGraphSchedule::JoinNext()
 		LinkGraphID id = next->LinkGraphIndex();
 		next->FinaliseJob(); // joins the thread and finalises the job
 		assert(!next->IsJobAborted());
+		next->telemetry.finalise_end_time = GetPerformanceTimer();
+		this->RecordTelemetry(next->telemetry);
 		next.reset();
 		if (LinkGraph::IsValidID(id)) {
 			LinkGraph *lg = LinkGraph::Get(id);
@@ -154,10 +326,29 @@ void LinkGraphSchedule::JoinNext()
  */
 /* static */ void LinkGraphSchedule::Run(LinkGraphJob *job)
 {
+	TRACE_ZONE("LinkGraphSchedule::Run");
+
+	static_assert(lengthof(instance.handlers) == LGJS_END);
+
+	LinkGraphJobTelemetry &telemetry = job->telemetry;
+	telemetry.link_graph = job->LinkGraphIndex();
+	telemetry.cargo = job->Cargo();
+	telemetry.nodes = job->Size();
+	telemetry.edges = 0;
+	for (NodeID node = 0; node < job->Size(); ++node) {
+		telemetry.edges += job->Graph()[node].EdgeCount();
+	}
+
+	TimingMeasurement stage_start = GetPerformanceTimer();
+	telemetry.run_start_time = stage_start;
 	for (uint i = 0; i < lengthof(instance.handlers); ++i) {
 		if (job->IsJobAborted()) return;
 		instance.handlers[i]->Run(*job);
+		TimingMeasurement stage_end = GetPerformanceTimer();
+		telemetry.stage_durations[i] = stage_end - stage_start;
+		stage_start = stage_end;
 	}
+	telemetry.run_end_time = stage_start;
 
 	/*
 	 * Readers of this variable in another thread may see an out of date value.
@@ -195,6 +386,7 @@ void LinkGraphSchedule::SpawnAll()
 	}
 	instance.running.clear();
 	instance.schedule.clear();
+	instance.telemetry_history.clear();
 }
 
 /**
@@ -229,20 +421,22 @@ LinkGraphSchedule::~LinkGraphSchedule()
 	this->Clear();
 }
 
-LinkGraphJobGroup::LinkGraphJobGroup(constructor_token token, std::vector<LinkGraphJob *> jobs) :
-	jobs(std::move(jobs)) { }
+LinkGraphJobGroup::LinkGraphJobGroup(constructor_token token, std::vector<LinkGraphJob *> jobs, uint cost_estimate, DateTicks join_date_ticks) :
+	jobs(std::move(jobs)), cost_estimate(cost_estimate), join_date_ticks(join_date_ticks) { }
 
 void LinkGraphJobGroup::SpawnThread()
 {
 	/**
-	 * Spawn a thread if possible and run the link graph job in the thread. If
+	 * Queue the job group on the link graph worker pool if possible. If
 	 * that's not possible run the job right now in the current thread.
 	 */
-	if (StartNewThread(&this->thread, "ottd:linkgraph", &(LinkGraphJobGroup::Run), this)) {
+	for (auto &it : this->jobs) {
+		it->SetJobGroup(this->shared_from_this());
+	}
+	if (!_linkgraph_worker_pool.Submit(this->shared_from_this())) {
 		for (auto &it : this->jobs) {
-			it->SetJobGroup(this->shared_from_this());
+			it->SetJobGroup(nullptr);
 		}
-	} else {
 		/* Of course this will hang a bit.
 		 * On the other hand, if you want to play games which make this hang noticably
 		 * on a platform without threads then you'll probably get other problems first.
@@ -251,19 +445,17 @@ void LinkGraphJobGroup::SpawnThread()
 		 * smaller grained "Step" method for all handlers and add some more ticks where
 		 * "Step" is called. No problem in principle. */
 		LinkGraphJobGroup::Run(this);
+		this->state = State::Done;
 	}
 }
 
 void LinkGraphJobGroup::JoinThread()
 {
-	if (this->thread.joinable()) {
-		this->thread.join();
-	}
+	_linkgraph_worker_pool.Wait(this);
 }
 
 /**
- * Run all jobs for the given LinkGraphJobGroup. This method is tailored to
- * ThreadObject::New.
+ * Run all jobs for the given LinkGraphJobGroup.
  * @param j Pointer to a LinkGraphJobGroup.
  */
 /* static */ void LinkGraphJobGroup::Run(void *group)
@@ -288,7 +480,7 @@ void LinkGraphJobGroup::JoinThread()
 		if (!bucket_cost) return;
 		DEBUG(linkgraph, 2, "LinkGraphJobGroup::ExecuteJobSet: Creating Job Group: jobs: " PRINTF_SIZE ", cost: %u, join after: %d",
 				bucket.size(), bucket_cost, bucket_join_date - ((_date * DAY_TICKS) + _date_fract));
-		auto group = std::make_shared<LinkGraphJobGroup>(constructor_token(), std::move(bucket));
+		auto group = std::make_shared<LinkGraphJobGroup>(constructor_token(), std::move(bucket), bucket_cost, bucket_join_date);
 		group->SpawnThread();
 		bucket_cost = 0;
 		bucket.clear();
@@ -332,6 +524,7 @@ void StateGameLoop_LinkGraphPauseControl()
 
 		/* perform check one _date_fract tick before we would join */
 		if (LinkGraphSchedule::instance.IsJoinWithUnfinishedJobDue()) {
+			LinkGraphSchedule::instance.MarkJoinDelayed();
 			DoCommandP(0, PM_PAUSED_LINK_GRAPH, 1, CMD_PAUSE);
 		}
 	}
@@ -355,6 +548,8 @@ void AfterLoad_LinkGraphPauseControl()
  */
 void OnTick_LinkGraph()
 {
+	TRACE_ZONE("OnTick_LinkGraph");
+
 	int offset;
 	int interval;
 	if (!_settings_game.linkgraph.recalc_not_scaled_by_daylength || _settings_game.economy.day_length_factor == 1) {
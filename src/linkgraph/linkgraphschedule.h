@@ -12,6 +12,8 @@
 
 #include "../thread.h"
 #include "linkgraph.h"
+#include "linkgraphjob.h"
+#include <deque>
 #include <memory>
 
 class LinkGraphJob;
@@ -52,10 +54,14 @@ protected:
 	std::unique_ptr<ComponentHandler> handlers[6]; ///< Handlers to be run for each job.
 	GraphList schedule;            ///< Queue for new jobs.
 	JobList running;               ///< Currently running jobs.
+	std::deque<LinkGraphJobTelemetry> telemetry_history; ///< Telemetry of the most recently joined jobs, oldest first.
+
+	void RecordTelemetry(const LinkGraphJobTelemetry &telemetry);
 
 public:
 	/* This is a tick where not much else is happening, so a small lag might go unnoticed. */
 	static const uint SPAWN_JOIN_TICK = 21; ///< Tick when jobs are spawned or joined every day.
+	static const uint TELEMETRY_HISTORY_SIZE = 64; ///< Number of joined jobs to keep the telemetry of.
 	static LinkGraphSchedule instance;
 
 	static void Run(LinkGraphJob *job);
@@ -63,6 +69,7 @@ public:
 
 	void SpawnNext();
 	bool IsJoinWithUnfinishedJobDue() const;
+	void MarkJoinDelayed();
 	void JoinNext();
 	void SpawnAll();
 	void ShiftDates(int interval);
@@ -82,14 +89,30 @@ public:
 	 * @param lg Link graph to be removed.
 	 */
 	void Unqueue(LinkGraph *lg) { this->schedule.remove(lg); }
+
+	/**
+	 * Get the telemetry of the most recently joined jobs.
+	 * @return Telemetry history, oldest first.
+	 */
+	const std::deque<LinkGraphJobTelemetry> &GetTelemetryHistory() const { return this->telemetry_history; }
 };
 
 class LinkGraphJobGroup : public std::enable_shared_from_this<LinkGraphJobGroup> {
 	friend LinkGraphJob;
+	friend class LinkGraphWorkerPool;
 
 private:
-	std::thread thread;                      ///< Thread the job group is running in or nullptr if it's running in the main thread.
+	/** Execution state of a job group, guarded by the worker pool lock. */
+	enum class State : uint8 {
+		Pending,   ///< Waiting to be picked up by a worker thread.
+		Running,   ///< Being run by a worker thread.
+		Done,      ///< All jobs of the group have been run.
+	};
+
 	const std::vector<LinkGraphJob *> jobs;  ///< The set of jobs in this job set
+	const uint cost_estimate;                ///< Sum of the cost estimates of the jobs.
+	const DateTicks join_date_ticks;         ///< Join date of the jobs.
+	State state = State::Pending;            ///< Execution state.
 
 private:
 	struct constructor_token { };
@@ -98,7 +121,7 @@ private:
 	void JoinThread();
 
 public:
-	LinkGraphJobGroup(constructor_token token, std::vector<LinkGraphJob *> jobs);
+	LinkGraphJobGroup(constructor_token token, std::vector<LinkGraphJob *> jobs, uint cost_estimate, DateTicks join_date_ticks);
 
 	struct JobInfo {
 		LinkGraphJob * job;
@@ -112,6 +135,8 @@ public:
 	static void ExecuteJobSet(std::vector<JobInfo> jobs);
 };
 
+extern uint8 _config_linkgraph_threads;
+
 void StateGameLoop_LinkGraphPauseControl();
 void AfterLoad_LinkGraphPauseControl();
 
@@ -4,27 +4,13 @@
 #include "../core/math_func.hpp"
 #include "mcf.h"
 #include "../3rdparty/cpp-btree/btree_map.h"
-#include <set>
+#include "../worker_thread.h"
+#include <algorithm>
 
 #include "../safeguards.h"
 
 typedef btree::btree_map<NodeID, Path *> PathViaMap;
 
-/**
- * This is a wrapper around Tannotation* which also stores a cache of GetAnnotation() and GetNode()
- * to remove the need dereference the Tannotation* pointer when sorting/inseting/erasing in MultiCommodityFlow::Dijkstra::AnnoSet
- */
-template<typename Tannotation>
-class AnnoSetItem {
-public:
-	Tannotation *anno_ptr;
-	typename Tannotation::AnnotationValueType cached_annotation;
-	NodeID node_id;
-
-	AnnoSetItem(Tannotation *anno) : anno_ptr(anno), cached_annotation(anno->GetAnnotation()), node_id(anno->GetNode()) {}
-	AnnoSetItem() : anno_ptr(nullptr), cached_annotation(0), node_id(INVALID_NODE) {}
-};
-
 /**
  * Distance-based annotation for use in the Dijkstra algorithm. This is close
  * to the original meaning of "annotation" in this context. Paths are rated
@@ -55,11 +41,16 @@ public:
 	inline void UpdateAnnotation() { }
 
 	/**
-	 * Comparator for std containers.
+	 * Get the key of this annotation in an AnnoRadixHeap, shorter distances are better.
+	 * @return Queue key.
 	 */
-	struct Comparator {
-		bool operator()(const AnnoSetItem<DistanceAnnotation> &x, const AnnoSetItem<DistanceAnnotation> &y) const;
-	};
+	inline uint32 GetQueueKey() const { return this->distance; }
+
+	/**
+	 * Get the tie breaker of this annotation in an AnnoRadixHeap, lower node IDs are preferred.
+	 * @return Tie breaker.
+	 */
+	inline uint16 GetQueueTie() const { return this->node; }
 };
 
 /**
@@ -98,16 +89,101 @@ public:
 	}
 
 	/**
-	 * Comparator for std containers.
+	 * Get the key of this annotation in an AnnoRadixHeap, higher capacity ratios are better.
+	 * @return Queue key.
+	 */
+	inline uint32 GetQueueKey() const { return (uint32)((int64)INT_MAX - this->cached_annotation); }
+
+	/**
+	 * Get the tie breaker of this annotation in an AnnoRadixHeap, higher node IDs are preferred.
+	 * @return Tie breaker.
 	 */
-	struct Comparator {
-		bool operator()(const AnnoSetItem<CapacityAnnotation> &x, const AnnoSetItem<CapacityAnnotation> &y) const;
+	inline uint16 GetQueueTie() const { return (uint16)~this->node; }
+};
+
+/**
+ * Radix heap of annotations, used as the priority queue of the Dijkstra search.
+ * Annotations are popped in order of their queue key, and for equal keys in order of their tie breaker.
+ * The keys of the annotations being pushed must never be lower than the key of the last popped one,
+ * which holds for both annotations as the annotation of a path never improves on that of the path it is forked from.
+ * An annotation which is improved is pushed again, instead of being moved, and the stale entries are skipped when popped.
+ * An annotation's AnnosSetFlag is set while it has a valid entry in the queue.
+ * @tparam Tannotation Annotation type.
+ */
+template <class Tannotation>
+class AnnoRadixHeap {
+	struct Entry {
+		uint32 key;
+		uint16 tie;
+		Tannotation *anno;
 	};
+
+	/**
+	 * Bucket 0 contains the entries with the same key as the last popped one, ordered as a heap by tie breaker.
+	 * Bucket i > 0 contains the entries whose key differs from the last popped one first in bit i - 1.
+	 */
+	std::vector<Entry> buckets[33];
+	uint32 last = 0; ///< Key of the last popped entry.
+	size_t count = 0; ///< Number of entries.
+
+	static bool TieGreater(const Entry &a, const Entry &b) { return a.tie > b.tie; }
+
+	void Place(const Entry &entry)
+	{
+		uint bucket = entry.key == this->last ? 0 : FindLastBit(entry.key ^ this->last) + 1;
+		this->buckets[bucket].push_back(entry);
+		if (bucket == 0) std::push_heap(this->buckets[0].begin(), this->buckets[0].end(), TieGreater);
+	}
+
+public:
+	/**
+	 * Push an annotation, with its current key.
+	 * @param anno Annotation.
+	 */
+	void Push(Tannotation *anno)
+	{
+		Entry entry{ anno->GetQueueKey(), anno->GetQueueTie(), anno };
+		assert(entry.key >= this->last);
+		this->Place(entry);
+		this->count++;
+		anno->SetAnnosSetFlag(true);
+	}
+
+	/**
+	 * Pop the best annotation.
+	 * @return The annotation, or nullptr if the queue is empty.
+	 */
+	Tannotation *Pop()
+	{
+		while (this->count > 0) {
+			if (this->buckets[0].empty()) {
+				uint i = 1;
+				while (this->buckets[i].empty()) i++;
+				std::vector<Entry> moved;
+				moved.swap(this->buckets[i]);
+				this->last = std::min_element(moved.begin(), moved.end(), [](const Entry &a, const Entry &b) { return a.key < b.key; })->key;
+				/* All moved entries end up in lower buckets */
+				for (const Entry &entry : moved) this->Place(entry);
+				moved.clear();
+				this->buckets[i].swap(moved);
+			}
+			std::pop_heap(this->buckets[0].begin(), this->buckets[0].end(), TieGreater);
+			Entry entry = this->buckets[0].back();
+			this->buckets[0].pop_back();
+			this->count--;
+
+			if (entry.anno->GetAnnosSetFlag() && entry.anno->GetQueueKey() == entry.key) {
+				entry.anno->SetAnnosSetFlag(false);
+				return entry.anno;
+			}
+		}
+		return nullptr;
+	}
 };
 
 /**
- * Iterator class for getting the edges in the order of their next_edge
- * members.
+ * Iterator class for getting the edges in the order of their destination
+ * nodes.
  */
 class GraphEdgeIterator {
 private:
@@ -122,7 +198,7 @@ public:
 	 * @param job Job to iterate on.
 	 */
 	GraphEdgeIterator(LinkGraphJob &job) : job(job),
-		i(nullptr, nullptr, INVALID_NODE), end(nullptr, nullptr, INVALID_NODE)
+		i(nullptr, nullptr, 0), end(nullptr, nullptr, 0)
 	{}
 
 	/**
@@ -265,40 +341,49 @@ bool CapacityAnnotation::IsBetter(const CapacityAnnotation *base, uint cap,
 }
 
 /**
- * A slightly modified Dijkstra algorithm. Grades the paths not necessarily by
- * distance, but by the value Tannotation computes. It uses the max_saturation
- * setting to artificially decrease capacities.
+ * Allocate and initialise the annotations for a path search.
+ * This uses the job's path allocator, so it must not be called concurrently for the same job.
  * @tparam Tannotation Annotation to be used.
- * @tparam Tedge_iterator Iterator to be used for getting outgoing edges.
- * @param source_node Node where the algorithm starts.
+ * @param source_node Node where the search starts.
  * @param paths Container for the paths to be calculated.
  */
-template<class Tannotation, class Tedge_iterator>
-void MultiCommodityFlow::Dijkstra(NodeID source_node, PathVector &paths)
+template<class Tannotation>
+void MultiCommodityFlow::InitPaths(NodeID source_node, PathVector &paths)
 {
-	typedef btree::btree_set<AnnoSetItem<Tannotation>, typename Tannotation::Comparator> AnnoSet;
-	AnnoSet annos = AnnoSet(typename Tannotation::Comparator());
-	Tedge_iterator iter(this->job);
 	uint size = this->job.Size();
 	paths.resize(size, nullptr);
 
 	this->job.path_allocator.SetParameters(sizeof(Tannotation), (8192 - 32) / sizeof(Tannotation));
 
-	const uint16 aircraft_link_scale = this->job.Settings().aircraft_link_scale;
-
 	for (NodeID node = 0; node < size; ++node) {
 		Tannotation *anno = new (this->job.path_allocator.Allocate()) Tannotation(node, node == source_node);
 		anno->UpdateAnnotation();
-		if (node == source_node) {
-			annos.insert(AnnoSetItem<Tannotation>(anno));
-			anno->SetAnnosSetFlag(true);
-		}
 		paths[node] = anno;
 	}
-	while (!annos.empty()) {
-		typename AnnoSet::iterator i = annos.begin();
-		Tannotation *source = i->anno_ptr;
-		annos.erase(i);
+}
+
+/**
+ * A slightly modified Dijkstra algorithm. Grades the paths not necessarily by
+ * distance, but by the value Tannotation computes. It uses the max_saturation
+ * setting to artificially decrease capacities.
+ * This only modifies the given paths, which must have been set up by InitPaths, and only reads the job.
+ * So it can be run concurrently for different sources of the same job, while no flow is being pushed.
+ * @tparam Tannotation Annotation to be used.
+ * @tparam Tedge_iterator Iterator to be used for getting outgoing edges.
+ * @param source_node Node where the algorithm starts.
+ * @param paths Container for the paths to be calculated.
+ */
+template<class Tannotation, class Tedge_iterator>
+void MultiCommodityFlow::SearchPaths(NodeID source_node, PathVector &paths)
+{
+	AnnoRadixHeap<Tannotation> annos;
+	Tedge_iterator iter(this->job);
+
+	const uint16 aircraft_link_scale = this->job.Settings().aircraft_link_scale;
+
+	annos.Push(static_cast<Tannotation *>(paths[source_node]));
+
+	for (Tannotation *source = annos.Pop(); source != nullptr; source = annos.Pop()) {
 		NodeID from = source->GetNode();
 		iter.SetNode(source_node, from);
 		for (NodeID to = iter.Next(); to != INVALID_NODE; to = iter.Next()) {
@@ -318,16 +403,28 @@ void MultiCommodityFlow::Dijkstra(NodeID source_node, PathVector &paths)
 			}
 			Tannotation *dest = static_cast<Tannotation *>(paths[to]);
 			if (dest->IsBetter(source, capacity, capacity - edge.Flow(), distance)) {
-				if (dest->GetAnnosSetFlag()) annos.erase(AnnoSetItem<Tannotation>(dest));
 				dest->Fork(source, capacity, capacity - edge.Flow(), distance);
 				dest->UpdateAnnotation();
-				annos.insert(AnnoSetItem<Tannotation>(dest));
-				dest->SetAnnosSetFlag(true);
+				annos.Push(dest);
 			}
 		}
 	}
 }
 
+/**
+ * Set up and run a path search from a source node.
+ * @tparam Tannotation Annotation to be used.
+ * @tparam Tedge_iterator Iterator to be used for getting outgoing edges.
+ * @param source_node Node where the algorithm starts.
+ * @param paths Container for the paths to be calculated.
+ */
+template<class Tannotation, class Tedge_iterator>
+void MultiCommodityFlow::Dijkstra(NodeID source_node, PathVector &paths)
+{
+	this->InitPaths<Tannotation>(source_node, paths);
+	this->SearchPaths<Tannotation, Tedge_iterator>(source_node, paths);
+}
+
 /**
  * Clean up paths that lead nowhere and the root path.
  * @param source_id ID of the root node.
@@ -357,20 +454,20 @@ void MultiCommodityFlow::CleanupPaths(NodeID source_id, PathVector &paths)
 
 /**
  * Push flow along a path and update the unsatisfied_demand of the associated
- * edge.
- * @param edge Edge whose ends the path connects.
+ * demand.
+ * @param demand Demand between the ends of the path.
  * @param path End of the path the flow should be pushed on.
  * @param accuracy Accuracy of the calculation.
  * @param max_saturation If < UINT_MAX only push flow up to the given
  *                       saturation, otherwise the path can be "overloaded".
  */
-uint MultiCommodityFlow::PushFlow(Edge &edge, Path *path, uint accuracy,
+uint MultiCommodityFlow::PushFlow(DemandAnnotation &demand, Path *path, uint accuracy,
 		uint max_saturation)
 {
-	assert(edge.UnsatisfiedDemand() > 0);
-	uint flow = Clamp(edge.Demand() / accuracy, 1, edge.UnsatisfiedDemand());
+	assert(demand.unsatisfied_demand > 0);
+	uint flow = Clamp(demand.demand / accuracy, 1, demand.unsatisfied_demand);
 	flow = path->AddFlow(flow, this->job, max_saturation);
-	edge.SatisfyDemand(flow);
+	demand.SatisfyDemand(flow);
 	return flow;
 }
 
@@ -519,18 +616,91 @@ bool MCF1stPass::EliminateCycles()
 	return cycles_found;
 }
 
+/**
+ * Push flow from a source along the paths found for it.
+ * @param source Source node.
+ * @param paths Paths found from the source, these are cleaned up afterwards.
+ * @param accuracy Accuracy of the calculation.
+ * @param more_loops Set to true if another loop could find more paths.
+ * @return If the source has any unsatisfied demand left.
+ */
+bool MCF1stPass::SaturatePaths(NodeID source, PathVector &paths, uint accuracy, bool &more_loops)
+{
+	bool source_demand_left = false;
+	for (DemandAnnotation &demand : this->job[source].Demands()) {
+		if (demand.unsatisfied_demand > 0) {
+			Path *path = paths[demand.dest];
+			assert(path != nullptr);
+			/* Generally only allow paths that don't exceed the
+			 * available capacity. But if no demand has been assigned
+			 * yet, make an exception and allow any valid path *once*. */
+			if (path->GetFreeCapacity() > 0 && this->PushFlow(demand, path,
+					accuracy, this->max_saturation) > 0) {
+				/* If a path has been found there is a chance we can
+				 * find more. */
+				more_loops = more_loops || (demand.unsatisfied_demand > 0);
+			} else if (demand.unsatisfied_demand == demand.demand &&
+					path->GetFreeCapacity() > INT_MIN) {
+				this->PushFlow(demand, path, accuracy, UINT_MAX);
+			}
+			if (demand.unsatisfied_demand > 0) source_demand_left = true;
+		}
+	}
+	this->CleanupPaths(source, paths);
+	return source_demand_left;
+}
+
+/**
+ * Minimum number of nodes for which the first pass searches the paths of several sources at once.
+ * This is a fixed property of the job, never of the machine, so that all clients calculate the same flows.
+ */
+static const uint MCF_BATCH_MIN_NODES = 384;
+
+/** Number of sources whose paths are searched at once in big jobs. */
+static const uint MCF_BATCH_SIZE = 16;
+
 /**
  * Run the first pass of the MCF calculation.
+ * In jobs with at least MCF_BATCH_MIN_NODES nodes the sources are processed in batches: the paths for all sources
+ * of a batch are searched concurrently on the general worker pool, using the flows as at the start of the batch,
+ * and then flow is pushed along them in source order.
  * @param job Link graph job to calculate.
  */
 MCF1stPass::MCF1stPass(LinkGraphJob &job) : MultiCommodityFlow(job)
 {
-	PathVector paths;
 	uint16 size = job.Size();
 	uint accuracy = job.Settings().accuracy;
 	bool more_loops;
 	std::vector<bool> finished_sources(size);
 
+	if (size >= MCF_BATCH_MIN_NODES) {
+		std::vector<NodeID> batch;
+		std::vector<PathVector> batch_paths(MCF_BATCH_SIZE);
+		do {
+			more_loops = false;
+			for (NodeID next = 0; next < size && !job.IsJobAborted();) {
+				batch.clear();
+				for (; next < size && batch.size() < MCF_BATCH_SIZE; ++next) {
+					if (!finished_sources[next]) batch.push_back(next);
+				}
+
+				for (size_t i = 0; i < batch.size(); i++) {
+					this->InitPaths<DistanceAnnotation>(batch[i], batch_paths[i]);
+				}
+				_general_worker_pool.ParallelFor(batch.size(), 1, [&](size_t start, size_t end) {
+					for (size_t i = start; i < end; i++) {
+						this->SearchPaths<DistanceAnnotation, GraphEdgeIterator>(batch[i], batch_paths[i]);
+					}
+				});
+				for (size_t i = 0; i < batch.size(); i++) {
+					if (!this->SaturatePaths(batch[i], batch_paths[i], accuracy, more_loops)) finished_sources[batch[i]] = true;
+				}
+			}
+		} while ((more_loops || this->EliminateCycles()) && !job.IsJobAborted());
+		return;
+	}
+
+	PathVector paths;
 	do {
 		more_loops = false;
 		for (NodeID source = 0; source < size; ++source) {
@@ -539,29 +709,7 @@ MCF1stPass::MCF1stPass(LinkGraphJob &job) : MultiCommodityFlow(job)
 			/* First saturate the shortest paths. */
 			this->Dijkstra<DistanceAnnotation, GraphEdgeIterator>(source, paths);
 
-			bool source_demand_left = false;
-			for (NodeID dest = 0; dest < size; ++dest) {
-				Edge edge = job[source][dest];
-				if (edge.UnsatisfiedDemand() > 0) {
-					Path *path = paths[dest];
-					assert(path != nullptr);
-					/* Generally only allow paths that don't exceed the
-					 * available capacity. But if no demand has been assigned
-					 * yet, make an exception and allow any valid path *once*. */
-					if (path->GetFreeCapacity() > 0 && this->PushFlow(edge, path,
-							accuracy, this->max_saturation) > 0) {
-						/* If a path has been found there is a chance we can
-						 * find more. */
-						more_loops = more_loops || (edge.UnsatisfiedDemand() > 0);
-					} else if (edge.UnsatisfiedDemand() == edge.Demand() &&
-							path->GetFreeCapacity() > INT_MIN) {
-						this->PushFlow(edge, path, accuracy, UINT_MAX);
-					}
-					if (edge.UnsatisfiedDemand() > 0) source_demand_left = true;
-				}
-			}
-			if (!source_demand_left) finished_sources[source] = true;
-			this->CleanupPaths(source, paths);
+			if (!this->SaturatePaths(source, paths, accuracy, more_loops)) finished_sources[source] = true;
 		}
 	} while ((more_loops || this->EliminateCycles()) && !job.IsJobAborted());
 }
@@ -587,12 +735,11 @@ MCF2ndPass::MCF2ndPass(LinkGraphJob &job) : MultiCommodityFlow(job)
 			this->Dijkstra<CapacityAnnotation, FlowEdgeIterator>(source, paths);
 
 			bool source_demand_left = false;
-			for (NodeID dest = 0; dest < size; ++dest) {
-				Edge edge = this->job[source][dest];
-				Path *path = paths[dest];
-				if (edge.UnsatisfiedDemand() > 0 && path->GetFreeCapacity() > INT_MIN) {
-					this->PushFlow(edge, path, accuracy, UINT_MAX);
-					if (edge.UnsatisfiedDemand() > 0) {
+			for (DemandAnnotation &demand : this->job[source].Demands()) {
+				Path *path = paths[demand.dest];
+				if (demand.unsatisfied_demand > 0 && path->GetFreeCapacity() > INT_MIN) {
+					this->PushFlow(demand, path, accuracy, UINT_MAX);
+					if (demand.unsatisfied_demand > 0) {
 						demand_left = true;
 						source_demand_left = true;
 					}
@@ -603,48 +750,3 @@ MCF2ndPass::MCF2ndPass(LinkGraphJob &job) : MultiCommodityFlow(job)
 		}
 	}
 }
-
-/**
- * Relation that creates a weak order without duplicates.
- * Avoid accidentally deleting different paths of the same capacity/distance in
- * a set. When the annotation is the same node IDs are compared, so there are
- * no equal ranges.
- * @tparam T Type to be compared on.
- * @param x_anno First value.
- * @param y_anno Second value.
- * @param x Node id associated with the first value.
- * @param y Node id associated with the second value.
- */
-template <typename T>
-bool Greater(T x_anno, T y_anno, NodeID x, NodeID y)
-{
-	if (x_anno > y_anno) return true;
-	if (x_anno < y_anno) return false;
-	return x > y;
-}
-
-/**
- * Compare two capacity annotations.
- * @param x First capacity annotation.
- * @param y Second capacity annotation.
- * @return If x is better than y.
- */
-bool CapacityAnnotation::Comparator::operator()(const AnnoSetItem<CapacityAnnotation> &x,
-		const AnnoSetItem<CapacityAnnotation> &y) const
-{
-	return x.anno_ptr != y.anno_ptr && Greater<int>(x.cached_annotation, y.cached_annotation,
-			x.node_id, y.node_id);
-}
-
-/**
- * Compare two distance annotations.
- * @param x First distance annotation.
- * @param y Second distance annotation.
- * @return If x is better than y.
- */
-bool DistanceAnnotation::Comparator::operator()(const AnnoSetItem<DistanceAnnotation> &x,
-		const AnnoSetItem<DistanceAnnotation> &y) const
-{
-	return x.anno_ptr != y.anno_ptr && !Greater<uint>(x.cached_annotation, y.cached_annotation,
-			x.node_id, y.node_id);
-}
@@ -21,10 +21,16 @@ protected:
 			max_saturation(job.Settings().short_path_saturation)
 	{}
 
+	template<class Tannotation>
+	void InitPaths(NodeID source_node, PathVector &paths);
+
+	template<class Tannotation, class Tedge_iterator>
+	void SearchPaths(NodeID source_node, PathVector &paths);
+
 	template<class Tannotation, class Tedge_iterator>
 	void Dijkstra(NodeID from, PathVector &paths);
 
-	uint PushFlow(Edge &edge, Path *path, uint accuracy, uint max_saturation);
+	uint PushFlow(DemandAnnotation &demand, Path *path, uint accuracy, uint max_saturation);
 
 	void CleanupPaths(NodeID source, PathVector &paths);
 
@@ -53,6 +59,7 @@ private:
 	bool EliminateCycles(PathVector &path, NodeID origin_id, NodeID next_id);
 	void EliminateCycle(PathVector &path, Path *cycle_begin, uint flow);
 	uint FindCycleFlow(const PathVector &path, const Path *cycle_begin);
+	bool SaturatePaths(NodeID source, PathVector &paths, uint accuracy, bool &more_loops);
 public:
 	MCF1stPass(LinkGraphJob &job);
 };
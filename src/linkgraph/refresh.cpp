@@ -34,7 +34,9 @@
 	/* Scan orders for cargo-specific load/unload, and run LinkRefresher separately for each set of cargoes where they differ. */
 	while (cargo_mask != 0) {
 		CargoTypes iter_cargo_mask = cargo_mask;
+		bool may_refit = false;
 		for (const Order *o = v->orders->GetFirstOrder(); o != nullptr; o = o->next) {
+			if ((o->IsType(OT_GOTO_STATION) || o->IsType(OT_GOTO_DEPOT)) && o->IsRefit()) may_refit = true;
 			if (o->IsType(OT_GOTO_STATION) || o->IsType(OT_IMPLICIT)) {
 				if (o->GetUnloadType() == OUFB_CARGO_TYPE_UNLOAD) {
 					CargoMaskValueFilter<uint>(iter_cargo_mask, [&](CargoID cargo) -> uint {
@@ -53,7 +55,7 @@
 		const Order *first = v->orders->GetNextDecisionNode(v->GetOrder(v->cur_implicit_order_index), 0, iter_cargo_mask);
 		if (first != nullptr) {
 			HopSet seen_hops;
-			LinkRefresher refresher(v, &seen_hops, allow_merge, is_full_loading, iter_cargo_mask);
+			LinkRefresher refresher(v, &seen_hops, allow_merge, is_full_loading, may_refit, iter_cargo_mask);
 
 			uint8 flags = 0;
 			if (iter_cargo_mask & have_cargo_mask) flags |= 1 << HAS_CARGO;
@@ -72,10 +74,12 @@
  *                  refresher and all its children.
  * @param allow_merge If the refresher is allowed to merge or extend link graphs.
  * @param is_full_loading If the vehicle is full loading.
+ * @param may_refit If the order list has any refit orders.
+ * @param cargo_mask Mask of cargoes to refresh.
  */
-LinkRefresher::LinkRefresher(Vehicle *vehicle, HopSet *seen_hops, bool allow_merge, bool is_full_loading, CargoTypes cargo_mask) :
+LinkRefresher::LinkRefresher(Vehicle *vehicle, HopSet *seen_hops, bool allow_merge, bool is_full_loading, bool may_refit, CargoTypes cargo_mask) :
 	vehicle(vehicle), seen_hops(seen_hops), cargo(CT_INVALID), allow_merge(allow_merge),
-	is_full_loading(is_full_loading), cargo_mask(cargo_mask)
+	is_full_loading(is_full_loading), may_refit(may_refit), cargo_mask(cargo_mask)
 {
 	memset(this->capacities, 0, sizeof(this->capacities));
 
@@ -196,18 +200,20 @@ const Order *LinkRefresher::PredictNextOrder(const Order *cur, const Order *next
 					this->vehicle->orders->GetOrderAt(next->GetConditionSkipToOrder()), num_hops, this_cargo_mask);
 			assert(this_cargo_mask == this->cargo_mask);
 			if (skip_to != nullptr && num_hops < std::min<uint>(64, this->vehicle->orders->GetNumOrders()) && skip_to != next) {
-				/* Make copies of capacity tracking lists. There is potential
-				 * for optimization here: If the vehicle never refits we don't
-				 * need to copy anything. */
-
 				/* Record the branch before executing it,
 				 * to avoid recursively executing it again. */
 				Hop hop(cur->index, skip_to->index, this->cargo, flags);
 				auto iter = this->seen_hops->lower_bound(hop);
 				if (iter == this->seen_hops->end() || *iter != hop) {
 					this->seen_hops->insert(iter, hop);
-					LinkRefresher branch(*this);
-					branch.RefreshLinks(cur, skip_to, flags, num_hops + 1);
+					if (this->may_refit) {
+						/* Make copies of capacity tracking lists, as the branch may refit. */
+						LinkRefresher branch(*this);
+						branch.RefreshLinks(cur, skip_to, flags, num_hops + 1);
+					} else {
+						/* Without refit orders the capacities never change, so the branch can share them. */
+						this->RefreshLinks(cur, skip_to, flags, num_hops + 1);
+					}
 				}
 			}
 		}
@@ -232,11 +238,9 @@ void LinkRefresher::RefreshStats(const Order *cur, const Order *next, uint8 flag
 	StationID next_station = next->GetDestination();
 	Station *st = Station::GetIfValid(cur->GetDestination());
 	if (st != nullptr && next_station != INVALID_STATION && next_station != st->index) {
-		for (CargoID c = 0; c < NUM_CARGO; c++) {
+		for (CargoID c : SetBitIterator<CargoID, CargoTypes>(this->cargo_mask)) {
 			/* Refresh the link and give it a minimum capacity. */
 
-			if (!HasBit(this->cargo_mask, c)) continue;
-
 			uint cargo_quantity = this->capacities[c];
 			if (cargo_quantity == 0) continue;
 
@@ -18,6 +18,16 @@
 #include <array>
 #include <deque>
 
+#if defined(__linux__)
+#	include <sys/mman.h>
+#	include <sys/syscall.h>
+#	include <unistd.h>
+#endif
+
+#ifdef _WIN32
+#	include <windows.h>
+#endif
+
 #include "safeguards.h"
 
 #if defined(_MSC_VER)
@@ -32,8 +42,183 @@ uint _map_size_y;    ///< Size of the map along the Y
 uint _map_size;      ///< The number of tiles on the map
 uint _map_tile_mask; ///< _map_size - 1 (to mask the mapsize)
 
+TileTypeHeight *_mth = nullptr; ///< Types and heights of the tiles of the map
 Tile *_m = nullptr;          ///< Tiles of the map
 TileExtended *_me = nullptr; ///< Extended Tiles of the map
+uint32 _rail_state_generation = 0; ///< Generation of track reservations and signal states, see map_func.h
+
+bool _config_map_huge_pages = true;        ///< Whether to try to back the map arrays with huge/large pages.
+bool _config_map_numa_interleave = false;  ///< Whether to interleave the map arrays over all NUMA nodes (Linux only).
+
+/** How a map array has been allocated. */
+enum MapAllocationMethod : uint8 {
+	MAM_HEAP,             ///< Plain CallocT.
+	MAM_MMAP,             ///< Anonymous mmap, the kernel declined transparent huge pages.
+	MAM_MMAP_HUGE,        ///< Anonymous mmap advised to use transparent huge pages.
+	MAM_WIN_LARGE_PAGES,  ///< VirtualAlloc with MEM_LARGE_PAGES.
+};
+
+/** Bookkeeping of a single map array allocation, so that it can be released the same way. */
+struct MapArrayAllocation {
+	void *ptr = nullptr;
+	size_t bytes = 0;
+	MapAllocationMethod method = MAM_HEAP;
+	bool numa_interleaved = false;
+};
+
+static MapArrayAllocation _map_allocations[3]; ///< Allocations of _mth, _m and _me.
+
+#if defined(__linux__)
+static const size_t MAP_HUGE_PAGE_SIZE = 2 * 1024 * 1024; ///< Size of a transparent huge page on the common platforms.
+
+/**
+ * Interleave the pages of a not yet touched mapping over all NUMA nodes with memory.
+ * This uses the raw system call, so that no dependency on libnuma is needed.
+ * @return true iff the memory policy is set, false when there is only one node or the call failed.
+ */
+static bool InterleaveMapArray(void *ptr, size_t bytes)
+{
+#if defined(SYS_mbind)
+	unsigned long node_mask = 0;
+	uint nodes = 0;
+	for (uint i = 0; i < sizeof(node_mask) * 8; i++) {
+		char path[64];
+		seprintf(path, lastof(path), "/sys/devices/system/node/node%u", i);
+		if (access(path, F_OK) == 0) {
+			node_mask |= 1UL << i;
+			nodes++;
+		}
+	}
+	if (nodes < 2) return false;
+
+	const int MPOL_INTERLEAVE_MODE = 3; // MPOL_INTERLEAVE from linux/mempolicy.h
+	return syscall(SYS_mbind, ptr, bytes, MPOL_INTERLEAVE_MODE, &node_mask, sizeof(node_mask) * 8 + 1, 0) == 0;
+#else
+	return false;
+#endif
+}
+#endif /* __linux__ */
+
+#ifdef _WIN32
+/**
+ * Try to enable the privilege to lock pages in memory, which is needed to allocate large pages.
+ * @return The large page size, or 0 when large pages can not be used.
+ */
+static size_t GetUsableLargePageSize()
+{
+	static size_t large_page_size = SIZE_MAX;
+	if (large_page_size != SIZE_MAX) return large_page_size;
+
+	large_page_size = 0;
+	HANDLE token;
+	if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token)) return 0;
+	TOKEN_PRIVILEGES tp;
+	tp.PrivilegeCount = 1;
+	tp.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+	if (LookupPrivilegeValue(nullptr, SE_LOCK_MEMORY_NAME, &tp.Privileges[0].Luid) && AdjustTokenPrivileges(token, FALSE, &tp, 0, nullptr, nullptr) && GetLastError() == ERROR_SUCCESS) {
+		large_page_size = GetLargePageMinimum();
+	}
+	CloseHandle(token);
+	return large_page_size;
+}
+#endif /* _WIN32 */
+
+/**
+ * Allocate a zeroed map array, backed by huge/large pages when possible.
+ * @param alloc Bookkeeping to fill.
+ * @param bytes Size of the array in bytes.
+ * @return The allocated array.
+ */
+static void *AllocateMapArray(MapArrayAllocation &alloc, size_t bytes)
+{
+	alloc.bytes = bytes;
+	alloc.numa_interleaved = false;
+
+#if defined(__linux__)
+	if ((_config_map_huge_pages && bytes >= MAP_HUGE_PAGE_SIZE) || _config_map_numa_interleave) {
+		/* Over-allocate, so that the start of the array can be aligned to a huge page boundary. */
+		size_t mapped = Align(bytes, MAP_HUGE_PAGE_SIZE) + MAP_HUGE_PAGE_SIZE;
+		void *raw = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (raw != MAP_FAILED) {
+			char *start = reinterpret_cast<char *>(Align(reinterpret_cast<uintptr_t>(raw), MAP_HUGE_PAGE_SIZE));
+			char *end = start + Align(bytes, MAP_HUGE_PAGE_SIZE);
+			if (start != raw) munmap(raw, start - static_cast<char *>(raw));
+			if (end != static_cast<char *>(raw) + mapped) munmap(end, static_cast<char *>(raw) + mapped - end);
+			alloc.bytes = end - start;
+			alloc.method = MAM_MMAP;
+#if defined(MADV_HUGEPAGE)
+			if (_config_map_huge_pages && madvise(start, alloc.bytes, MADV_HUGEPAGE) == 0) alloc.method = MAM_MMAP_HUGE;
+#endif
+			if (_config_map_numa_interleave) alloc.numa_interleaved = InterleaveMapArray(start, alloc.bytes);
+			alloc.ptr = start;
+			return start;
+		}
+	}
+#elif defined(_WIN32)
+	size_t page_size = _config_map_huge_pages ? GetUsableLargePageSize() : 0;
+	if (page_size != 0 && bytes >= page_size) {
+		size_t rounded = Align(bytes, page_size);
+		void *ptr = VirtualAlloc(nullptr, rounded, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+		if (ptr != nullptr) {
+			alloc.bytes = rounded;
+			alloc.method = MAM_WIN_LARGE_PAGES;
+			alloc.ptr = ptr;
+			return ptr;
+		}
+	}
+#endif
+
+	alloc.method = MAM_HEAP;
+	alloc.ptr = CallocT<byte>(bytes);
+	return alloc.ptr;
+}
+
+/**
+ * Release a map array allocated by AllocateMapArray.
+ * @param alloc Bookkeeping of the allocation.
+ */
+static void FreeMapArray(MapArrayAllocation &alloc)
+{
+	if (alloc.ptr == nullptr) return;
+	switch (alloc.method) {
+#if defined(__linux__)
+		case MAM_MMAP:
+		case MAM_MMAP_HUGE:
+			munmap(alloc.ptr, alloc.bytes);
+			break;
+#endif
+#ifdef _WIN32
+		case MAM_WIN_LARGE_PAGES:
+			VirtualFree(alloc.ptr, 0, MEM_RELEASE);
+			break;
+#endif
+		default:
+			free(alloc.ptr);
+			break;
+	}
+	alloc = {};
+}
+
+/**
+ * Describe how the map arrays are currently backed, for the crash log and debug output.
+ * @return Static description of the allocation mode.
+ */
+const char *GetMapAllocationMode()
+{
+	if (_m == nullptr) return "none";
+
+	MapAllocationMethod method = _map_allocations[0].method;
+	bool numa = _map_allocations[0].numa_interleaved;
+	for (const MapArrayAllocation &alloc : _map_allocations) {
+		if (alloc.method != method || alloc.numa_interleaved != numa) return "mixed";
+	}
+	switch (method) {
+		case MAM_MMAP:            return numa ? "mmap, NUMA interleaved" : "mmap";
+		case MAM_MMAP_HUGE:       return numa ? "transparent huge pages, NUMA interleaved" : "transparent huge pages";
+		case MAM_WIN_LARGE_PAGES: return "large pages";
+		default:                  return "heap";
+	}
+}
 
 /**
  * Validates whether a map with the given dimension is valid
@@ -76,11 +261,16 @@ void AllocateMap(uint size_x, uint size_y)
 	_map_size = size_x * size_y;
 	_map_tile_mask = _map_size - 1;
 
-	free(_m);
-	free(_me);
+	for (MapArrayAllocation &alloc : _map_allocations) FreeMapArray(alloc);
+
+	_mth = static_cast<TileTypeHeight *>(AllocateMapArray(_map_allocations[0], _map_size * sizeof(TileTypeHeight)));
+	_m = static_cast<Tile *>(AllocateMapArray(_map_allocations[1], _map_size * sizeof(Tile)));
+	_me = static_cast<TileExtended *>(AllocateMapArray(_map_allocations[2], _map_size * sizeof(TileExtended)));
+	DEBUG(map, 1, "Map arrays allocated using: %s", GetMapAllocationMode());
 
-	_m = CallocT<Tile>(_map_size);
-	_me = CallocT<TileExtended>(_map_size);
+	/* The vehicle tile hash is sized according to the map */
+	extern void ResetVehicleHash();
+	ResetVehicleHash();
 }
 
 
@@ -511,7 +701,7 @@ char *DumpTileInfo(char *b, const char *last, TileIndex tile)
 			b += seprintf(b, last, ", TILE OUTSIDE MAP");
 		} else {
 			b += seprintf(b, last, ", type: %02X (%s), height: %02X, data: %02X %04X %02X %02X %02X %02X %02X %04X",
-					_m[tile].type, tile_type_names[GB(_m[tile].type, 4, 4)], _m[tile].height,
+					_mth[tile].type, tile_type_names[GB(_mth[tile].type, 4, 4)], _mth[tile].height,
 					_m[tile].m1, _m[tile].m2, _m[tile].m3, _m[tile].m4, _m[tile].m5, _me[tile].m6, _me[tile].m7, _me[tile].m8);
 		}
 	}
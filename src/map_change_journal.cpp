@@ -0,0 +1,102 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file map_change_journal.cpp Journal of changed map regions, for caches of derived map data.
+ *
+ * The map is split up in regions of 2^MAP_CHANGE_REGION_SHIFT by 2^MAP_CHANGE_REGION_SHIFT tiles.
+ * Per channel, every change increases a generation counter, and the changed region remembers
+ * the generation of its last change. A cache stores the generation at which it was calculated,
+ * and is still valid as long as none of the regions it covers has a later generation.
+ */
+
+#include "stdafx.h"
+#include "map_change_journal.h"
+#include "map_func.h"
+#include "tilearea_type.h"
+#include <array>
+#include <vector>
+
+#include "safeguards.h"
+
+/** Change generations of one channel. */
+struct MapChangeChannelState {
+	std::vector<uint64> regions; ///< Per map region the generation of the last change of a tile within it.
+	uint64 generation = 0;       ///< Generation of the last change, increased for every change.
+};
+
+static std::array<MapChangeChannelState, MCC_END> _map_change_channels;
+
+/**
+ * Get the state of a channel, making sure there is a generation for every map region.
+ * Regions are considered changed when the map size changed.
+ * @param channel Channel to get.
+ * @return The channel state.
+ */
+static MapChangeChannelState &GetMapChangeChannel(MapChangeChannel channel)
+{
+	MapChangeChannelState &state = _map_change_channels[channel];
+	const size_t regions = (size_t)(MapSizeX() >> MAP_CHANGE_REGION_SHIFT) * (MapSizeY() >> MAP_CHANGE_REGION_SHIFT);
+	if (state.regions.size() != regions) state.regions.assign(regions, ++state.generation);
+	return state;
+}
+
+static inline size_t GetMapChangeRegionIndex(uint x, uint y)
+{
+	return (size_t)(y >> MAP_CHANGE_REGION_SHIFT) * (MapSizeX() >> MAP_CHANGE_REGION_SHIFT) + (x >> MAP_CHANGE_REGION_SHIFT);
+}
+
+/**
+ * Note that a tile changed, so that caches covering its region and channel are not used anymore.
+ * @param channel Kind of change.
+ * @param tile Changed tile.
+ */
+void MarkMapRegionChanged(MapChangeChannel channel, TileIndex tile)
+{
+	MapChangeChannelState &state = GetMapChangeChannel(channel);
+	state.regions[GetMapChangeRegionIndex(TileX(tile), TileY(tile))] = ++state.generation;
+}
+
+/**
+ * Note that any tile may have changed, e.g. because the NewGRFs were reloaded.
+ * @param channel Kind of change.
+ */
+void MarkAllMapRegionsChanged(MapChangeChannel channel)
+{
+	_map_change_channels[channel].regions.clear();
+}
+
+/**
+ * Get the current generation of a channel, to be stored with a cache calculated now.
+ * @param channel Kind of change.
+ * @return The generation of the last change.
+ */
+uint64 GetMapChangeGeneration(MapChangeChannel channel)
+{
+	return GetMapChangeChannel(channel).generation;
+}
+
+/**
+ * Check whether any tile of an area changed since a cache was calculated.
+ * @param channel Kind of change.
+ * @param area Area covered by the cache.
+ * @param generation Generation at which the cache was calculated, see GetMapChangeGeneration.
+ * @return True if a region overlapping the area changed after \a generation.
+ */
+bool HasMapAreaChangedSince(MapChangeChannel channel, const OrthogonalTileArea &area, uint64 generation)
+{
+	const MapChangeChannelState &state = GetMapChangeChannel(channel);
+	if (state.generation <= generation) return false;
+
+	const uint x0 = TileX(area.tile) & ~((1 << MAP_CHANGE_REGION_SHIFT) - 1);
+	const uint y0 = TileY(area.tile) & ~((1 << MAP_CHANGE_REGION_SHIFT) - 1);
+	for (uint y = y0; y < TileY(area.tile) + area.h; y += 1 << MAP_CHANGE_REGION_SHIFT) {
+		for (uint x = x0; x < TileX(area.tile) + area.w; x += 1 << MAP_CHANGE_REGION_SHIFT) {
+			if (state.regions[GetMapChangeRegionIndex(x, y)] > generation) return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,34 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file map_change_journal.h Journal of changed map regions, for caches of derived map data. */
+
+#ifndef MAP_CHANGE_JOURNAL_H
+#define MAP_CHANGE_JOURNAL_H
+
+#include "tile_type.h"
+
+struct OrthogonalTileArea;
+
+/**
+ * Kinds of map changes tracked by the journal.
+ * Each channel has its own generation counters, so that caches only see the changes they care about.
+ */
+enum MapChangeChannel : uint8 {
+	MCC_ACCEPTANCE,  ///< Tiles which may accept cargo: houses, industries and objects.
+	MCC_END,
+};
+
+/** Log2 of the side length of the map regions in which changes are tracked. */
+static const uint MAP_CHANGE_REGION_SHIFT = 4;
+
+void MarkMapRegionChanged(MapChangeChannel channel, TileIndex tile);
+void MarkAllMapRegionsChanged(MapChangeChannel channel);
+uint64 GetMapChangeGeneration(MapChangeChannel channel);
+bool HasMapAreaChangedSince(MapChangeChannel channel, const OrthogonalTileArea &area, uint64 generation);
+
+#endif /* MAP_CHANGE_JOURNAL_H */
@@ -25,6 +25,14 @@ extern uint _map_tile_mask;
 
 #define TILE_MASK(x) ((x) & _map_tile_mask)
 
+/**
+ * Pointer to the tile type and height array.
+ *
+ * This variable points to the array which contains the type and
+ * height of the tiles of the map.
+ */
+extern TileTypeHeight *_mth;
+
 /**
  * Pointer to the tile-array.
  *
@@ -41,8 +49,15 @@ extern Tile *_m;
  */
 extern TileExtended *_me;
 
+/**
+ * Incremented whenever a track reservation or a signal state on the map changes, or a game setting is changed.
+ * Used to check whether cached pathfinder results still apply.
+ */
+extern uint32 _rail_state_generation;
+
 bool ValidateMapSize(uint size_x, uint size_y);
 void AllocateMap(uint size_x, uint size_y);
+const char *GetMapAllocationMode();
 
 /**
  * Logarithm of the map size along the X side.
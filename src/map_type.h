@@ -11,12 +11,22 @@
 #define MAP_TYPE_H
 
 /**
- * Data that is stored per tile. Also used TileExtended for this.
+ * Type and height of a tile. These are stored in their own array, apart from the
+ * other data of the tile, as many map scans only look at the type or height of tiles.
  * Look at docs/landscape.html for the exact meaning of the members.
  */
-struct Tile {
+struct TileTypeHeight {
 	byte   type;        ///< The type (bits 4..7), bridges (2..3), rainforest/desert (0..1)
 	byte   height;      ///< The height of the northern corner.
+};
+
+static_assert(sizeof(TileTypeHeight) == 2);
+
+/**
+ * Data that is stored per tile. Also used TileTypeHeight and TileExtended for this.
+ * Look at docs/landscape.html for the exact meaning of the members.
+ */
+struct Tile {
 	uint16 m2;          ///< Primarily used for indices to towns, industries and stations
 	byte   m1;          ///< Primarily used for ownership information
 	byte   m3;          ///< General purpose
@@ -24,10 +34,10 @@ struct Tile {
 	byte   m5;          ///< General purpose
 };
 
-static_assert(sizeof(Tile) == 8);
+static_assert(sizeof(Tile) == 6);
 
 /**
- * Data that is stored per tile. Also used Tile for this.
+ * Data that is stored per tile. Also used TileTypeHeight and Tile for this.
  * Look at docs/landscape.html for the exact meaning of the members.
  */
 struct TileExtended {
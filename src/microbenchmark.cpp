@@ -0,0 +1,268 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file microbenchmark.cpp Timing of hot kernels in isolation, on synthetic inputs or on the loaded game. */
+
+#include "stdafx.h"
+#include "microbenchmark.h"
+#include "viewport_func.h"
+#include "viewport_sprite_sorter.h"
+#include "window_gui.h"
+#include "window_func.h"
+#include "gfx_func.h"
+#include "blitter/factory.hpp"
+#include "strings_func.h"
+#include "town.h"
+#include "station_base.h"
+#include "train.h"
+#include "vehicle_base.h"
+#include "rail_map.h"
+#include "settings_type.h"
+#include "core/random_func.hpp"
+#include "pathfinder/yapf/yapf.h"
+#include "saveload/saveload.h"
+#include "saveload/saveload_filter.h"
+
+#include "table/strings.h"
+
+#include <chrono>
+#include <memory>
+
+#include "safeguards.h"
+
+/** Measures the time spent on the kernel of a microbenchmark. */
+struct MicrobenchmarkTimer {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	/** Add the time since the start to the result. */
+	void Stop(MicrobenchmarkResult &result)
+	{
+		result.nanoseconds += (uint64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - this->start).count();
+	}
+};
+
+/**
+ * Sort a synthetic set of parent sprites, resembling those of a busy town at normal zoom.
+ * @param iterations Number of times to sort the sprites.
+ * @param legacy Whether to use the legacy sprite sorter instead of the bucketed one.
+ * @param[out] result The result.
+ */
+static void BenchmarkSpriteSort(uint iterations, bool legacy, MicrobenchmarkResult &result)
+{
+	static const uint SPRITE_COUNT = 2000;
+
+	/* Use a fixed seed, so every run sorts the same sprites. */
+	Randomizer random;
+	random.SetSeed(0x5EED);
+
+	std::vector<ParentSpriteToDraw> sprites(SPRITE_COUNT);
+	for (ParentSpriteToDraw &ps : sprites) {
+		ps = {};
+		ps.xmin = random.Next(64) * 16 + random.Next(8);
+		ps.ymin = random.Next(64) * 16 + random.Next(8);
+		ps.zmin = random.Next(4) * 8;
+		ps.xmax = ps.xmin + random.Next(16);
+		ps.ymax = ps.ymin + random.Next(16);
+		ps.zmax = ps.zmin + random.Next(32);
+	}
+
+	ParentSpriteToSortVector to_sort;
+	for (uint i = 0; i < iterations; i++) {
+		to_sort.clear();
+		for (ParentSpriteToDraw &ps : sprites) {
+			ps.SetComparisonDone(false);
+			to_sort.push_back(&ps);
+		}
+
+		MicrobenchmarkTimer timer;
+		ViewportSortParentSpritesForBenchmark(&to_sort, legacy);
+		timer.Stop(result);
+	}
+	result.items = (uint64)SPRITE_COUNT * iterations;
+}
+
+static bool MicrobenchmarkSpriteSort(uint iterations, MicrobenchmarkResult &result)
+{
+	BenchmarkSpriteSort(iterations, false, result);
+	return true;
+}
+
+static bool MicrobenchmarkSpriteSortLegacy(uint iterations, MicrobenchmarkResult &result)
+{
+	BenchmarkSpriteSort(iterations, true, result);
+	return true;
+}
+
+static bool MicrobenchmarkViewportDraw(uint iterations, MicrobenchmarkResult &result)
+{
+	Window *w = FindWindowById(WC_MAIN_WINDOW, 0);
+	if (w == nullptr || w->viewport == nullptr) return false;
+	Viewport *vp = w->viewport;
+
+	Blitter *blitter = BlitterFactory::GetCurrentBlitter();
+	std::unique_ptr<byte[]> buf(new byte[blitter->BufferSize(vp->width, vp->height)]);
+
+	/* Draw into the buffer instead of the screen, like the screenshots do. */
+	DrawPixelInfo old_screen = _screen;
+	bool old_disable_anim = _screen_disable_anim;
+	_screen.dst_ptr = buf.get();
+	_screen.width = vp->width;
+	_screen.height = vp->height;
+	_screen.pitch = vp->width;
+	_screen_disable_anim = true;
+
+	DrawPixelInfo dpi;
+	dpi.dst_ptr = buf.get();
+	dpi.left = vp->left;
+	dpi.top = vp->top;
+	dpi.width = vp->width;
+	dpi.height = vp->height;
+	dpi.pitch = vp->width;
+	dpi.zoom = ZOOM_LVL_NORMAL;
+	DrawPixelInfo *old_dpi = _cur_dpi;
+	_cur_dpi = &dpi;
+
+	MicrobenchmarkTimer timer;
+	for (uint i = 0; i < iterations; i++) {
+		ViewportDoDraw(vp, vp->virtual_left, vp->virtual_top, vp->virtual_left + vp->virtual_width, vp->virtual_top + vp->virtual_height);
+	}
+	timer.Stop(result);
+
+	_cur_dpi = old_dpi;
+	_screen = old_screen;
+	_screen_disable_anim = old_disable_anim;
+
+	result.items = (uint64)vp->width * vp->height * iterations;
+	return true;
+}
+
+static bool MicrobenchmarkStringFormat(uint iterations, MicrobenchmarkResult &result)
+{
+	size_t total_length = 0;
+	MicrobenchmarkTimer timer;
+	for (uint i = 0; i < iterations; i++) {
+		for (const Town *t : Town::Iterate()) {
+			SetDParam(0, t->index);
+			total_length += strlen(GetStringTemp(STR_TOWN_NAME));
+			result.items++;
+		}
+		for (const Station *st : Station::Iterate()) {
+			SetDParam(0, st->index);
+			total_length += strlen(GetStringTemp(STR_STATION_NAME));
+			result.items++;
+		}
+		for (const Vehicle *v : Vehicle::Iterate()) {
+			if (!v->IsPrimaryVehicle()) continue;
+			SetDParam(0, v->index);
+			total_length += strlen(GetStringTemp(STR_VEHICLE_NAME));
+			result.items++;
+		}
+	}
+	timer.Stop(result);
+	return total_length > 0;
+}
+
+/** Save filter which only counts the bytes of the savegame. */
+struct DiscardSaveFilter : SaveFilter {
+	uint64 *size; ///< Number of bytes written.
+
+	DiscardSaveFilter(uint64 *size) : SaveFilter(nullptr), size(size) {}
+
+	void Write(byte *buf, size_t len) override
+	{
+		*this->size += len;
+	}
+};
+
+static bool MicrobenchmarkSave(uint iterations, MicrobenchmarkResult &result)
+{
+	for (uint i = 0; i < iterations; i++) {
+		uint64 size = 0;
+		MicrobenchmarkTimer timer;
+		SaveOrLoadResult res = SaveWithFilter(new DiscardSaveFilter(&size), false, SMF_NONE);
+		timer.Stop(result);
+		if (res != SL_OK) return false;
+		result.items += size;
+	}
+	return true;
+}
+
+static bool MicrobenchmarkTrainDepotPathfind(uint iterations, MicrobenchmarkResult &result)
+{
+	if (_settings_game.pf.pathfinder_for_trains != VPF_YAPF) return false;
+
+	std::vector<const Train *> trains;
+	for (const Train *t : Train::Iterate()) {
+		if (t->IsFrontEngine() && !(t->vehstatus & VS_CRASHED) && !IsRailDepotTile(t->tile)) trains.push_back(t);
+	}
+	if (trains.empty()) return false;
+
+	MicrobenchmarkTimer timer;
+	for (uint i = 0; i < iterations; i++) {
+		for (const Train *t : trains) {
+			YapfTrainFindNearestDepot(t, 0);
+		}
+	}
+	timer.Stop(result);
+	result.items = (uint64)trains.size() * iterations;
+	return true;
+}
+
+static bool MicrobenchmarkVehicleSprites(uint iterations, MicrobenchmarkResult &result)
+{
+	std::vector<const Vehicle *> vehicles;
+	for (const Vehicle *v : Vehicle::Iterate()) {
+		if (v->type < VEH_COMPANY_END) vehicles.push_back(v);
+	}
+	if (vehicles.empty()) return false;
+
+	VehicleSpriteSeq seq;
+	MicrobenchmarkTimer timer;
+	for (uint i = 0; i < iterations; i++) {
+		for (const Vehicle *v : vehicles) {
+			v->GetImage(v->direction, EIT_ON_MAP, &seq);
+		}
+	}
+	timer.Stop(result);
+	result.items = (uint64)vehicles.size() * iterations;
+	return true;
+}
+
+/** All microbenchmarks. */
+static const Microbenchmark _microbenchmarks[] = {
+	{ "sprite_sort",          "Bucketed viewport sprite sorter, synthetic sprites",                   MicrobenchmarkSpriteSort },
+	{ "sprite_sort_legacy",   "Legacy (SSE4.1 if available) viewport sprite sorter, synthetic sprites", MicrobenchmarkSpriteSortLegacy },
+	{ "viewport_draw",        "Drawing of the main viewport into a buffer, including sorting and blitting", MicrobenchmarkViewportDraw },
+	{ "string_format",        "Formatting of the names of all towns, stations and primary vehicles",  MicrobenchmarkStringFormat },
+	{ "save",                 "Saving the game into memory, items are bytes",                         MicrobenchmarkSave },
+	{ "train_depot_pathfind", "YAPF nearest depot search of all trains, with the segment cost cache", MicrobenchmarkTrainDepotPathfind },
+	{ "vehicle_sprites",      "Sprite resolution of all vehicles, including NewGRF sprite groups",    MicrobenchmarkVehicleSprites },
+};
+
+/**
+ * Call a handler for each of the microbenchmarks.
+ * @param handler The handler.
+ */
+void IterateMicrobenchmarks(std::function<void(const Microbenchmark &)> handler)
+{
+	for (const Microbenchmark &mb : _microbenchmarks) {
+		handler(mb);
+	}
+}
+
+/**
+ * Find a microbenchmark by name.
+ * @param name The name.
+ * @return The microbenchmark, or nullptr if there is none with that name.
+ */
+const Microbenchmark *GetMicrobenchmark(const char *name)
+{
+	for (const Microbenchmark &mb : _microbenchmarks) {
+		if (strcmp(mb.name, name) == 0) return &mb;
+	}
+	return nullptr;
+}
@@ -0,0 +1,40 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file microbenchmark.h Timing of hot kernels in isolation, on synthetic inputs or on the loaded game. */
+
+#ifndef MICROBENCHMARK_H
+#define MICROBENCHMARK_H
+
+#include <functional>
+
+/** Result of running a microbenchmark. */
+struct MicrobenchmarkResult {
+	uint iterations = 0;     ///< Number of times the kernel was run.
+	uint64 items = 0;        ///< Number of items processed over all iterations.
+	uint64 nanoseconds = 0;  ///< Time spent running the kernel over all iterations.
+};
+
+/**
+ * Run the kernel of a microbenchmark.
+ * @param iterations Number of times to run the kernel.
+ * @param[out] result The result, only valid if the kernel could be run.
+ * @return Whether the kernel could be run, i.e. whether the required input exists.
+ */
+typedef bool MicrobenchmarkProc(uint iterations, MicrobenchmarkResult &result);
+
+/** Description of a microbenchmark. */
+struct Microbenchmark {
+	const char *name;          ///< Name of the microbenchmark.
+	const char *description;   ///< What the kernel does, and which input it uses.
+	MicrobenchmarkProc *proc;  ///< Function which runs the kernel.
+};
+
+void IterateMicrobenchmarks(std::function<void(const Microbenchmark &)> handler);
+const Microbenchmark *GetMicrobenchmark(const char *name);
+
+#endif /* MICROBENCHMARK_H */
@@ -26,6 +26,7 @@
 #include "core/pool_type.hpp"
 #include "game/game.hpp"
 #include "linkgraph/linkgraphschedule.h"
+#include "depot_kdtree.h"
 #include "station_kdtree.h"
 #include "town_kdtree.h"
 #include "viewport_kdtree.h"
@@ -39,6 +40,7 @@
 #include "cargopacket.h"
 #include "tbtr_template_vehicle_func.h"
 #include "event_logs.h"
+#include "pathfinder/yapf/yapf_cache.h"
 
 #include "safeguards.h"
 
@@ -77,6 +79,9 @@ void InitializeGame(uint size_x, uint size_y, bool reset_date, bool reset_settin
 
 	AllocateMap(size_x, size_y);
 
+	/* Cached rail segments refer to the old map, drop them all */
+	YapfNotifyTrackLayoutChange(INVALID_TILE, INVALID_TRACK);
+
 	ViewportMapClearTunnelCache();
 	ClearCommandLog();
 	ClearCommandQueue();
@@ -126,6 +131,8 @@ void InitializeGame(uint size_x, uint size_y, bool reset_date, bool reset_settin
 	ClearNewSignalStyleMapping();
 
 	RebuildStationKdtree();
+	RebuildAirportKdtree();
+	RebuildShipDepotKdtree();
 	RebuildTownKdtree();
 	RebuildViewportKdtree();
 
@@ -136,8 +136,8 @@ public:
 				BridgePieceDebugInfo info = GetBridgePieceDebugInfo(tile);
 				DEBUG(misc, LANDINFOD_LEVEL, "bridge above: piece: %u, pillars: %X, pillar index: %u", info.piece, info.pillar_flags, info.pillar_index);
 			}
-			DEBUG(misc, LANDINFOD_LEVEL, "type   = %#x", _m[tile].type);
-			DEBUG(misc, LANDINFOD_LEVEL, "height = %#x", _m[tile].height);
+			DEBUG(misc, LANDINFOD_LEVEL, "type   = %#x", _mth[tile].type);
+			DEBUG(misc, LANDINFOD_LEVEL, "height = %#x", _mth[tile].height);
 			DEBUG(misc, LANDINFOD_LEVEL, "m1     = %#x", _m[tile].m1);
 			DEBUG(misc, LANDINFOD_LEVEL, "m2     = %#x", _m[tile].m2);
 			DEBUG(misc, LANDINFOD_LEVEL, "m3     = %#x", _m[tile].m3);
@@ -68,49 +68,28 @@ static int RateConversion(T *b, int frac_pos)
 	return ((b[0] * ((1 << 16) - frac_pos)) + (b[1] * frac_pos)) >> 16;
 }
 
-static void mix_int16(MixerChannel *sc, int16 *buffer, uint samples, uint8 effect_vol)
-{
-	if (samples > sc->samples_left) samples = sc->samples_left;
-	sc->samples_left -= samples;
-	assert(samples > 0);
-
-	const int16 *b = (const int16 *)sc->memory + sc->pos;
-	uint32 frac_pos = sc->frac_pos;
-	uint32 frac_speed = sc->frac_speed;
-	int volume_left = sc->volume_left * effect_vol / 255;
-	int volume_right = sc->volume_right * effect_vol / 255;
+/** Number of samples which are mixed at once in the intermediate buffer of #MxMixSamples. */
+static const uint MIX_BLOCK_SAMPLES = 512;
 
-	if (frac_speed == 0x10000) {
-		/* Special case when frac_speed is 0x10000 */
-		do {
-			buffer[0] = Clamp(buffer[0] + (*b * volume_left  >> 16), -MAX_VOLUME, MAX_VOLUME);
-			buffer[1] = Clamp(buffer[1] + (*b * volume_right >> 16), -MAX_VOLUME, MAX_VOLUME);
-			b++;
-			buffer += 2;
-		} while (--samples > 0);
-	} else {
-		do {
-			int data = RateConversion(b, frac_pos);
-			buffer[0] = Clamp(buffer[0] + (data * volume_left  >> 16), -MAX_VOLUME, MAX_VOLUME);
-			buffer[1] = Clamp(buffer[1] + (data * volume_right >> 16), -MAX_VOLUME, MAX_VOLUME);
-			buffer += 2;
-			frac_pos += frac_speed;
-			b += frac_pos >> 16;
-			frac_pos &= 0xffff;
-		} while (--samples > 0);
-	}
-
-	sc->frac_pos = frac_pos;
-	sc->pos = b - (const int16 *)sc->memory;
-}
-
-static void mix_int8_to_int16(MixerChannel *sc, int16 *buffer, uint samples, uint8 effect_vol)
+/**
+ * Mix the samples of a channel into the intermediate buffer, without clamping.
+ * The volume is only clamped once all channels are mixed, which leaves the loops
+ * free of dependencies between samples so the compiler can vectorise them.
+ * @param sc the channel to mix
+ * @param buffer the intermediate buffer, interleaved left and right
+ * @param samples the number of samples to mix
+ * @param effect_vol the master effect volume
+ * @tparam T the type of the samples of the channel
+ * @tparam Tshift the shift to scale a sample multiplied by the volume back to 16 bits
+ */
+template <typename T, int Tshift>
+static void MixChannel(MixerChannel *sc, int32 *buffer, uint samples, uint8 effect_vol)
 {
 	if (samples > sc->samples_left) samples = sc->samples_left;
 	sc->samples_left -= samples;
 	assert(samples > 0);
 
-	const int8 *b = sc->memory + sc->pos;
+	const T *b = (const T *)sc->memory + sc->pos;
 	uint32 frac_pos = sc->frac_pos;
 	uint32 frac_speed = sc->frac_speed;
 	int volume_left = sc->volume_left * effect_vol / 255;
@@ -118,17 +97,16 @@ static void mix_int8_to_int16(MixerChannel *sc, int16 *buffer, uint samples, uin
 
 	if (frac_speed == 0x10000) {
 		/* Special case when frac_speed is 0x10000 */
-		do {
-			buffer[0] = Clamp(buffer[0] + (*b * volume_left  >> 8), -MAX_VOLUME, MAX_VOLUME);
-			buffer[1] = Clamp(buffer[1] + (*b * volume_right >> 8), -MAX_VOLUME, MAX_VOLUME);
-			b++;
-			buffer += 2;
-		} while (--samples > 0);
+		for (uint i = 0; i < samples; i++) {
+			buffer[i * 2]     += b[i] * volume_left  >> Tshift;
+			buffer[i * 2 + 1] += b[i] * volume_right >> Tshift;
+		}
+		b += samples;
 	} else {
 		do {
 			int data = RateConversion(b, frac_pos);
-			buffer[0] = Clamp(buffer[0] + (data * volume_left  >> 8), -MAX_VOLUME, MAX_VOLUME);
-			buffer[1] = Clamp(buffer[1] + (data * volume_right >> 8), -MAX_VOLUME, MAX_VOLUME);
+			buffer[0] += data * volume_left  >> Tshift;
+			buffer[1] += data * volume_right >> Tshift;
 			buffer += 2;
 			frac_pos += frac_speed;
 			b += frac_pos >> 16;
@@ -137,7 +115,7 @@ static void mix_int8_to_int16(MixerChannel *sc, int16 *buffer, uint samples, uin
 	}
 
 	sc->frac_pos = frac_pos;
-	sc->pos = b - sc->memory;
+	sc->pos = b - (const T *)sc->memory;
 }
 
 static void MxCloseChannel(MixerChannel *mc)
@@ -173,16 +151,26 @@ void MxMixSamples(void *buffer, uint samples)
 	                    _settings_client.music.effect_vol *
 	                    _settings_client.music.effect_vol) / (127 * 127);
 
-	/* Mix each channel */
-	for (mc = _channels; mc != endof(_channels); mc++) {
-		if (mc->active) {
-			if (mc->is16bit) {
-				mix_int16(mc, (int16*)buffer, samples, effect_vol);
-			} else {
-				mix_int8_to_int16(mc, (int16*)buffer, samples, effect_vol);
+	/* Mix all channels a block at a time into an intermediate buffer, and only clamp the sum. */
+	int16 *out = (int16 *)buffer;
+	int32 mix_buffer[MIX_BLOCK_SAMPLES * 2];
+	for (uint done = 0; done < samples; done += MIX_BLOCK_SAMPLES) {
+		uint count = std::min(samples - done, MIX_BLOCK_SAMPLES);
+		int16 *block = out + done * 2;
+		for (uint i = 0; i < count * 2; i++) mix_buffer[i] = block[i];
+
+		for (mc = _channels; mc != endof(_channels); mc++) {
+			if (mc->active) {
+				if (mc->is16bit) {
+					MixChannel<int16, 16>(mc, mix_buffer, count, effect_vol);
+				} else {
+					MixChannel<int8, 8>(mc, mix_buffer, count, effect_vol);
+				}
+				if (mc->samples_left == 0) MxCloseChannel(mc);
 			}
-			if (mc->samples_left == 0) MxCloseChannel(mc);
 		}
+
+		for (uint i = 0; i < count * 2; i++) block[i] = Clamp(mix_buffer[i], -MAX_VOLUME, MAX_VOLUME);
 	}
 }
 
@@ -51,6 +51,27 @@ Packet::Packet(PacketType type, size_t limit) : pos(0), limit(limit), cs(nullptr
 	this->ResetState(type);
 }
 
+/**
+ * Creates a packet which sends the contents of a broadcast packet, see Packet::MakeBroadcast.
+ * Each socket needs its own copy, as the packet keeps track of how much has been sent.
+ * @param shared The broadcast packet to send.
+ */
+Packet::Packet(std::shared_ptr<const Packet> shared) : pos(0), limit(shared->limit), cs(nullptr), shared(std::move(shared))
+{
+}
+
+/**
+ * Turn a packet into an immutable broadcast packet, of which the contents
+ * can be sent to many sockets without building or copying it for each of them.
+ * @param packet The packet to send, it must not be changed any more.
+ * @return The broadcast packet, ready to be sent.
+ */
+/* static */ std::shared_ptr<const Packet> Packet::MakeBroadcast(std::unique_ptr<Packet> packet)
+{
+	packet->PrepareToSend();
+	return std::shared_ptr<const Packet>(std::move(packet));
+}
+
 void Packet::ResetState(PacketType type)
 {
 	this->cs = nullptr;
@@ -68,10 +89,14 @@ void Packet::PrepareToSend()
 {
 	assert(this->cs == nullptr);
 
+	this->pos = 0; // We start reading from here
+
+	/* The contents of broadcast packets have been prepared by MakeBroadcast. */
+	if (this->shared != nullptr) return;
+
 	this->buffer[0] = GB(this->Size(), 0, 8);
 	this->buffer[1] = GB(this->Size(), 8, 8);
 
-	this->pos  = 0; // We start reading from here
 	this->buffer.shrink_to_fit();
 }
 
@@ -250,7 +275,7 @@ bool Packet::HasPacketSizeData() const
  */
 size_t Packet::Size() const
 {
-	return this->buffer.size();
+	return this->shared != nullptr ? this->shared->Size() : this->buffer.size();
 }
 
 size_t Packet::ReadRawPacketSize() const
@@ -294,7 +319,7 @@ void Packet::PrepareToRead()
 PacketType Packet::GetPacketType() const
 {
 	assert(this->Size() >= sizeof(PacketSize) + sizeof(PacketType));
-	return static_cast<PacketType>(buffer[sizeof(PacketSize)]);
+	return static_cast<PacketType>(this->GetBufferData()[sizeof(PacketSize)]);
 }
 
 /**
@@ -19,6 +19,7 @@
 #include <string>
 #include <functional>
 #include <limits>
+#include <memory>
 
 typedef uint16 PacketSize; ///< Size of the whole packet.
 typedef uint8  PacketType; ///< Identifier for the packet
@@ -54,9 +55,15 @@ private:
 	/** Socket we're associated with. */
 	NetworkSocketHandler *cs;
 
+	/** Immutable packet which is sent instead of the buffer, when this packet is one of the copies of a broadcast packet. */
+	std::shared_ptr<const Packet> shared;
+
 public:
 	Packet(NetworkSocketHandler *cs, size_t limit, size_t initial_read_size = sizeof(PacketSize));
 	Packet(PacketType type, size_t limit = COMPAT_MTU);
+	Packet(std::shared_ptr<const Packet> shared);
+
+	static std::shared_ptr<const Packet> MakeBroadcast(std::unique_ptr<Packet> packet);
 
 	void ResetState(PacketType type);
 
@@ -94,7 +101,23 @@ public:
 
 	size_t RemainingBytesToTransfer() const;
 
-	const byte *GetBufferData() const { return this->buffer.data(); }
+	const byte *GetBufferData() const { return this->shared != nullptr ? this->shared->buffer.data() : this->buffer.data(); }
+
+	/**
+	 * Get the data which has not been transferred out yet, for transferring it out without TransferOut.
+	 * @return Pointer to the first byte to transfer, RemainingBytesToTransfer() bytes are available.
+	 */
+	const byte *GetDataToTransferOut() const { return this->GetBufferData() + this->pos; }
+
+	/**
+	 * Mark data returned by GetDataToTransferOut as transferred out.
+	 * @param bytes The number of bytes which have been transferred.
+	 */
+	void MarkTransferredOut(size_t bytes)
+	{
+		assert(bytes <= this->RemainingBytesToTransfer());
+		this->pos += (PacketSize)bytes;
+	}
 	PacketSize GetRawPos() const { return this->pos; }
 	void ReserveBuffer(size_t size) { this->buffer.reserve(size); }
 
@@ -120,10 +143,10 @@ public:
 		size_t amount = std::min(this->RemainingBytesToTransfer(), limit);
 		if (amount == 0) return 0;
 
-		assert(this->pos < this->buffer.size());
-		assert(this->pos + amount <= this->buffer.size());
+		assert(this->pos < this->Size());
+		assert(this->pos + amount <= this->Size());
 		/* Making buffer a char means casting a lot in the Recv/Send functions. */
-		const char *output_buffer = reinterpret_cast<const char*>(this->buffer.data() + this->pos);
+		const char *output_buffer = reinterpret_cast<const char*>(this->GetDataToTransferOut());
 		ssize_t bytes = transfer_function(destination, output_buffer, static_cast<A>(amount), std::forward<Args>(args)...);
 		if (bytes > 0) this->pos += bytes;
 		return bytes;
@@ -14,8 +14,54 @@
 
 #include "tcp.h"
 
+#if defined(UNIX) && !defined(__OS2__) && !defined(__EMSCRIPTEN__)
+#	include <sys/uio.h>
+#	define WITH_GATHERED_SEND
+#elif defined(_WIN32)
+#	define WITH_GATHERED_SEND
+#endif
+
 #include "../../safeguards.h"
 
+#ifdef WITH_GATHERED_SEND
+/** Maximum number of packets which are handed to the OS in a single send call. */
+static const uint MAX_GATHERED_SEND_PACKETS = 64;
+
+/**
+ * Send the data of the first packets of a queue with a single gather-write.
+ * @param sock The socket to send to.
+ * @param queue The packets to send, these are not modified.
+ * @param[out] requested The number of bytes which were offered to the OS.
+ * @return The number of bytes sent, or -1 on errors.
+ */
+static ssize_t SendGathered(SOCKET sock, const std::deque<std::unique_ptr<Packet>> &queue, size_t &requested)
+{
+	const uint count = (uint)std::min<size_t>(queue.size(), MAX_GATHERED_SEND_PACKETS);
+	requested = 0;
+	for (uint i = 0; i < count; i++) requested += queue[i]->RemainingBytesToTransfer();
+#if defined(_WIN32)
+	WSABUF buffers[MAX_GATHERED_SEND_PACKETS];
+	for (uint i = 0; i < count; i++) {
+		buffers[i].buf = const_cast<char *>(reinterpret_cast<const char *>(queue[i]->GetDataToTransferOut()));
+		buffers[i].len = (ULONG)queue[i]->RemainingBytesToTransfer();
+	}
+	DWORD sent = 0;
+	if (WSASend(sock, buffers, count, &sent, 0, nullptr, nullptr) != 0) return -1;
+	return sent;
+#else
+	struct iovec buffers[MAX_GATHERED_SEND_PACKETS];
+	for (uint i = 0; i < count; i++) {
+		buffers[i].iov_base = const_cast<byte *>(queue[i]->GetDataToTransferOut());
+		buffers[i].iov_len = queue[i]->RemainingBytesToTransfer();
+	}
+	struct msghdr msg = {};
+	msg.msg_iov = buffers;
+	msg.msg_iovlen = count;
+	return sendmsg(sock, &msg, 0);
+#endif
+}
+#endif /* WITH_GATHERED_SEND */
+
 /**
  * Construct a socket handler for a TCP connection.
  * @param s The just opened TCP connection.
@@ -114,6 +160,20 @@ void NetworkTCPSocketHandler::SendPrependPacket(std::unique_ptr<Packet> packet,
 	this->packet_queue.push_front(std::move(packet));
 }
 
+/**
+ * Get the number of packets and bytes which are still waiting in the send queue.
+ * @param[out] packets The number of (partially) unsent packets.
+ * @param[out] bytes The number of unsent bytes.
+ */
+void NetworkTCPSocketHandler::GetSendQueueStatistics(size_t &packets, size_t &bytes) const
+{
+	packets = this->packet_queue.size();
+	bytes = 0;
+	for (const auto &p : this->packet_queue) {
+		bytes += p->RemainingBytesToTransfer();
+	}
+}
+
 /**
  * Sends all the buffered packets out for this client. It stops when:
  *   1) all packets are send (queue is empty)
@@ -133,8 +193,12 @@ SendPacketsState NetworkTCPSocketHandler::SendPackets(bool closing_down)
 	if (!this->IsConnected()) return SPS_CLOSED;
 
 	while (!this->packet_queue.empty()) {
-		Packet *p = this->packet_queue.front().get();
-		res = p->TransferOut<int>(send, this->sock, 0);
+#ifdef WITH_GATHERED_SEND
+		size_t requested;
+		res = SendGathered(this->sock, this->packet_queue, requested);
+#else
+		res = this->packet_queue.front()->TransferOut<int>(send, this->sock, 0);
+#endif
 		if (res == -1) {
 			NetworkError err = NetworkError::GetLast();
 			if (!err.WouldBlock()) {
@@ -153,7 +217,24 @@ SendPacketsState NetworkTCPSocketHandler::SendPackets(bool closing_down)
 			return SPS_CLOSED;
 		}
 
+#ifdef WITH_GATHERED_SEND
+		/* Account the sent bytes to the packets, in order. */
+		size_t sent = res;
+		while (sent > 0) {
+			Packet *p = this->packet_queue.front().get();
+			size_t amount = std::min(sent, p->RemainingBytesToTransfer());
+			p->MarkTransferredOut(amount);
+			sent -= amount;
+			if (p->RemainingBytesToTransfer() != 0) break;
+
+			if (_debug_net_level >= 5) this->LogSentPacket(*p);
+			this->packet_queue.pop_front();
+		}
+		/* The OS did not take everything, so its buffer is full. */
+		if ((size_t)res != requested) return SPS_PARTLY_SENT;
+#else
 		/* Is this packet sent? */
+		Packet *p = this->packet_queue.front().get();
 		if (p->RemainingBytesToTransfer() == 0) {
 			/* Go to the next packet */
 			if (_debug_net_level >= 5) this->LogSentPacket(*p);
@@ -161,6 +242,7 @@ SendPacketsState NetworkTCPSocketHandler::SendPackets(bool closing_down)
 		} else {
 			return SPS_PARTLY_SENT;
 		}
+#endif
 	}
 
 	return SPS_ALL_SENT;
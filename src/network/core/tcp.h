@@ -61,6 +61,15 @@ public:
 		this->SendPacket(std::unique_ptr<Packet>(packet));
 	}
 
+	/**
+	 * This function puts a copy of a broadcast packet in the send-queue, see Packet::MakeBroadcast.
+	 * @param packet the packet to send
+	 */
+	void SendPacket(std::shared_ptr<const Packet> packet)
+	{
+		this->SendPacket(std::make_unique<Packet>(std::move(packet)));
+	}
+
 	SendPacketsState SendPackets(bool closing_down = false);
 
 	virtual std::unique_ptr<Packet> ReceivePacket();
@@ -73,6 +82,7 @@ public:
 	 * @return true when something is pending in the send queue.
 	 */
 	bool HasSendQueue() { return !this->packet_queue.empty(); }
+	void GetSendQueueStatistics(size_t &packets, size_t &bytes) const;
 
 	NetworkTCPSocketHandler(SOCKET s = INVALID_SOCKET);
 	~NetworkTCPSocketHandler();
@@ -60,6 +60,9 @@ enum PacketAdminType {
 	ADMIN_PACKET_SERVER_GAMESCRIPT,      ///< The server gives the admin information from the GameScript in JSON.
 	ADMIN_PACKET_SERVER_RCON_END,        ///< The server indicates that the remote console command has completed.
 	ADMIN_PACKET_SERVER_PONG,            ///< The server replies to a ping request from the admin.
+	ADMIN_PACKET_SERVER_LINKGRAPH_JOB,   ///< The server gives the admin the sizes and timings of a finished link graph job.
+	ADMIN_PACKET_SERVER_CLIENT_METRICS,  ///< The server gives the admin network and lag metrics of a client.
+	ADMIN_PACKET_SERVER_PERFORMANCE,     ///< The server gives the admin statistics of its performance measurements.
 
 	INVALID_ADMIN_PACKET = 0xFF,         ///< An invalid marker for admin packets.
 };
@@ -83,6 +86,9 @@ enum AdminUpdateType {
 	ADMIN_UPDATE_CMD_NAMES,       ///< The admin would like a list of all DoCommand names.
 	ADMIN_UPDATE_CMD_LOGGING,     ///< The admin would like to have DoCommand information.
 	ADMIN_UPDATE_GAMESCRIPT,      ///< The admin would like to have gamescript messages.
+	ADMIN_UPDATE_LINKGRAPH_JOBS,  ///< The admin would like to have link graph job telemetry.
+	ADMIN_UPDATE_CLIENT_METRICS,  ///< The admin would like to have network and lag metrics of clients.
+	ADMIN_UPDATE_PERFORMANCE,     ///< The admin would like to have statistics of the performance measurements.
 	ADMIN_UPDATE_END,             ///< Must ALWAYS be on the end of this list!! (period)
 };
 
@@ -147,6 +153,7 @@ protected:
 	 * uint8   #AdminUpdateType the server should answer for, only if #AdminUpdateFrequency #ADMIN_FREQUENCY_POLL is advertised in the PROTOCOL packet. Note integer type - see "Certain Packet Information" in docs/admin_network.md.
 	 * uint32  ID relevant to the packet type, e.g.
 	 *          - the client ID for #ADMIN_UPDATE_CLIENT_INFO. Use UINT32_MAX to show all clients.
+	 *          - the client ID for #ADMIN_UPDATE_CLIENT_METRICS. Use UINT32_MAX to show all clients.
 	 *          - the company ID for #ADMIN_UPDATE_COMPANY_INFO. Use UINT32_MAX to show all companies.
 	 * @param p The packet that was just received.
 	 * @return The state the network should have.
@@ -481,6 +488,59 @@ protected:
 	 */
 	virtual NetworkRecvStatus Receive_SERVER_PONG(Packet *p);
 
+	/**
+	 * Send the sizes and timings of a link graph job, after it has been joined.
+	 * This is for diagnostic purposes only, the timings are wall clock times in microseconds.
+	 * uint16  ID of the link graph.
+	 * uint8   ID of the cargo.
+	 * uint32  Number of nodes.
+	 * uint32  Number of edges.
+	 * uint64  Time the job waited for a thread to run it.
+	 * uint64  Time spent in each of the stages: init, demands, MCF first pass, flow mapping, MCF second pass, flow mapping.
+	 * uint64  Join lateness: time from the first pause waiting for the job, or else from the start of the join, until it had been joined.
+	 * uint64  Time spent applying the results of the job.
+	 * @param p The packet that was just received.
+	 * @return The state the network should have.
+	 */
+	virtual NetworkRecvStatus Receive_SERVER_LINKGRAPH_JOB(Packet *p);
+
+	/**
+	 * Network and lag metrics of a specific client.
+	 * This is for diagnostic purposes only, the counters are totals since the client connected.
+	 * uint32  ID of the client.
+	 * uint8   Status of the connection of the client.
+	 * uint32  Frame lag of the client.
+	 * uint32  Milliseconds since the client connected.
+	 * uint32  Number of packets waiting in the send queue of the client.
+	 * uint64  Number of bytes waiting in the send queue of the client.
+	 * uint64  Number of packets received from the client.
+	 * uint64  Number of bytes received from the client.
+	 * uint64  Number of commands received from the client.
+	 * uint64  Number of bytes of the map queued for sending to the client.
+	 * uint32  Milliseconds the map transfer took until the client reported it had the map, or has taken so far; 0 when it never started.
+	 * @param p The packet that was just received.
+	 * @return The state the network should have.
+	 */
+	virtual NetworkRecvStatus Receive_SERVER_CLIENT_METRICS(Packet *p);
+
+	/**
+	 * Statistics of the performance measurements of the server, as shown in the framerate window.
+	 * This is for diagnostic purposes only, the statistics are of the most recent measurements.
+	 * uint16  Maximum number of data points the statistics are based on.
+	 * For each measured performance element until the end of the packet:
+	 * uint8   ID of the performance element (see PerformanceElement in framerate_type.h).
+	 * uint16  Number of data points the statistics are based on.
+	 * uint32  Measured rate, in thousandths of cycles per second.
+	 * uint32  Average duration in microseconds.
+	 * uint32  Median duration in microseconds.
+	 * uint32  95th percentile duration in microseconds.
+	 * uint32  99th percentile duration in microseconds.
+	 * uint32  Longest duration in microseconds.
+	 * @param p The packet that was just received.
+	 * @return The state the network should have.
+	 */
+	virtual NetworkRecvStatus Receive_SERVER_PERFORMANCE(Packet *p);
+
 	/**
 	 * Notify the admin connection that the rcon command has finished.
 	 * string The command as requested by the admin connection.
@@ -74,6 +74,7 @@ static const char* _packet_game_type_names[] {
 	"CLIENT_DESYNC_LOG",
 	"SERVER_DESYNC_LOG",
 	"CLIENT_DESYNC_MSG",
+	"SERVER_COMMAND_BATCH",
 };
 static_assert(lengthof(_packet_game_type_names) == PACKET_END);
 
@@ -165,6 +166,7 @@ NetworkRecvStatus NetworkGameSocketHandler::HandlePacket(Packet *p)
 		case PACKET_CLIENT_ACK:                   return this->Receive_CLIENT_ACK(p);
 		case PACKET_CLIENT_COMMAND:               return this->Receive_CLIENT_COMMAND(p);
 		case PACKET_SERVER_COMMAND:               return this->Receive_SERVER_COMMAND(p);
+		case PACKET_SERVER_COMMAND_BATCH:         return this->Receive_SERVER_COMMAND_BATCH(p);
 		case PACKET_CLIENT_CHAT:                  return this->Receive_CLIENT_CHAT(p);
 		case PACKET_SERVER_CHAT:                  return this->Receive_SERVER_CHAT(p);
 		case PACKET_SERVER_EXTERNAL_CHAT:         return this->Receive_SERVER_EXTERNAL_CHAT(p);
@@ -257,6 +259,7 @@ NetworkRecvStatus NetworkGameSocketHandler::Receive_SERVER_SYNC(Packet *p) { ret
 NetworkRecvStatus NetworkGameSocketHandler::Receive_CLIENT_ACK(Packet *p) { return this->ReceiveInvalidPacket(PACKET_CLIENT_ACK); }
 NetworkRecvStatus NetworkGameSocketHandler::Receive_CLIENT_COMMAND(Packet *p) { return this->ReceiveInvalidPacket(PACKET_CLIENT_COMMAND); }
 NetworkRecvStatus NetworkGameSocketHandler::Receive_SERVER_COMMAND(Packet *p) { return this->ReceiveInvalidPacket(PACKET_SERVER_COMMAND); }
+NetworkRecvStatus NetworkGameSocketHandler::Receive_SERVER_COMMAND_BATCH(Packet *p) { return this->ReceiveInvalidPacket(PACKET_SERVER_COMMAND_BATCH); }
 NetworkRecvStatus NetworkGameSocketHandler::Receive_CLIENT_CHAT(Packet *p) { return this->ReceiveInvalidPacket(PACKET_CLIENT_CHAT); }
 NetworkRecvStatus NetworkGameSocketHandler::Receive_SERVER_CHAT(Packet *p) { return this->ReceiveInvalidPacket(PACKET_SERVER_CHAT); }
 NetworkRecvStatus NetworkGameSocketHandler::Receive_SERVER_EXTERNAL_CHAT(Packet *p) { return this->ReceiveInvalidPacket(PACKET_SERVER_EXTERNAL_CHAT); }
@@ -133,6 +133,8 @@ enum PacketGameType {
 	PACKET_SERVER_DESYNC_LOG,            ///< A server reports a desync log
 	PACKET_CLIENT_DESYNC_MSG,            ///< A client reports a desync message
 
+	PACKET_SERVER_COMMAND_BATCH,         ///< Server distributes several commands of the same frame to (all) the clients.
+
 	PACKET_END,                          ///< Must ALWAYS be on the end of this list!! (period)
 };
 
@@ -394,6 +396,23 @@ protected:
 	 */
 	virtual NetworkRecvStatus Receive_SERVER_COMMAND(Packet *p);
 
+	/**
+	 * Sends several commands of the same frame to the client, none of which originate from it:
+	 * uint32  Frame of execution.
+	 * For each command until the end of the packet:
+	 * uint8   Flags telling which of the following fields differ from the previous command (see CommandBatchFlags).
+	 * uint8   ID of the company, when it differs.
+	 * uint32  ID of the command, when the company or command differs.
+	 * uint32  P1, when it differs.
+	 * uint32  P2, when it differs.
+	 * uint64  P3, when it differs.
+	 * uint16  Signed offset of the tile to the tile of the previous command, or
+	 * uint32  Tile where this is taking place, when it differs.
+	 * uint32  Length of binary data and the text or binary data, when present.
+	 * @param p The packet that was just received.
+	 */
+	virtual NetworkRecvStatus Receive_SERVER_COMMAND_BATCH(Packet *p);
+
 	/**
 	 * Sends a chat-packet to the server:
 	 * uint8   ID of the action (see NetworkAction).
@@ -587,6 +606,8 @@ public:
 
 	const char *ReceiveCommand(Packet *p, CommandPacket *cp);
 	void SendCommand(Packet *p, const CommandPacket *cp);
+	const char *ReceiveCommandBatchEntry(Packet *p, CommandPacket *cp, const CommandPacket *prev);
+	static void SendCommandBatchEntry(Packet *p, const CommandPacket *cp, const CommandPacket *prev);
 
 	virtual std::string GetDebugInfo() const;
 	virtual void LogSentPacket(const Packet &pkt) override;
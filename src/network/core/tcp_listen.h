@@ -18,6 +18,12 @@
 #include "../../debug.h"
 #include "table/strings.h"
 
+#if defined(UNIX) && !defined(__OS2__) && !defined(__EMSCRIPTEN__)
+#	include <poll.h>
+#	include <vector>
+#	define WITH_POLL_LISTEN
+#endif
+
 /**
  * Template for TCP listeners.
  * @param Tsocket      The class we create sockets for.
@@ -100,6 +106,44 @@ public:
 	 */
 	static bool Receive()
 	{
+#ifdef WITH_POLL_LISTEN
+		/* Poll the sockets instead of selecting them, so the cost does not depend on the
+		 * highest descriptor number and descriptors beyond FD_SETSIZE are handled. */
+		static std::vector<pollfd> fds;
+		static std::vector<size_t> indices;
+		fds.clear();
+		indices.clear();
+
+		for (auto &s : sockets) {
+			fds.push_back({ s.second, POLLIN, 0 });
+		}
+		const size_t first_client = fds.size();
+
+		for (Tsocket *cs : Tsocket::Iterate()) {
+			fds.push_back({ cs->sock, POLLIN | POLLOUT, 0 });
+			indices.push_back(cs->index);
+		}
+
+		if (poll(fds.data(), fds.size(), 0) < 0) return false;
+
+		/* accept clients.. */
+		for (size_t i = 0; i < first_client; i++) {
+			if (fds[i].revents & POLLIN) AcceptClient(fds[i].fd);
+		}
+
+		/* read stuff from clients, clients accepted above are handled next time */
+		for (size_t i = 0; i < indices.size(); i++) {
+			Tsocket *cs = Tsocket::GetIfValid(indices[i]);
+			const pollfd &fd = fds[first_client + i];
+			if (cs == nullptr || cs->sock != fd.fd) continue;
+
+			cs->writable = (fd.revents & POLLOUT) != 0;
+			/* Errors and hang-ups are reported by the receive itself. */
+			if (fd.revents & (POLLIN | POLLERR | POLLHUP)) {
+				cs->ReceivePackets();
+			}
+		}
+#else
 		fd_set read_fd, write_fd;
 		struct timeval tv;
 
@@ -132,6 +176,7 @@ public:
 				cs->ReceivePackets();
 			}
 		}
+#endif /* WITH_POLL_LISTEN */
 		return _networking;
 	}
 
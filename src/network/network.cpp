@@ -39,6 +39,7 @@
 #include "../string_func_extra.h"
 #include "../3rdparty/randombytes/randombytes.h"
 #include "../settings_internal.h"
+#include "../trace.h"
 #include <sstream>
 #include <iomanip>
 
@@ -83,6 +84,8 @@ uint32 _sync_seed_1;                  ///< Seed to compare during sync checks.
 uint32 _sync_seed_2;                  ///< Second part of the seed.
 #endif
 uint64 _sync_state_checksum;          ///< State checksum to compare during sync checks.
+uint64 _sync_state_checksum_parts[SCP_END]; ///< Checksums of the parts of the state to compare during sync checks.
+bool _sync_state_checksum_parts_valid;      ///< Whether #_sync_state_checksum_parts has been received from the server for the sync check.
 uint32 _sync_frame;                   ///< The frame to perform the sync check.
 Date   _last_sync_date;               ///< The game date of the last successfully received sync frame
 DateFract _last_sync_date_fract;      ///< "
@@ -1076,6 +1079,8 @@ void NetworkGameLoop()
 {
 	if (!_networking) return;
 
+	TRACE_ZONE("NetworkGameLoop");
+
 	if (!NetworkReceive()) return;
 
 	if (_network_server) {
@@ -1224,6 +1229,9 @@ void NetworkGameLoop()
 		_sync_seed_2 = _random.state[1];
 #endif
 		_sync_state_checksum = _state_checksum.state;
+		for (uint i = 0; i < SCP_END; i++) {
+			_sync_state_checksum_parts[i] = _state_checksum_parts[i].state;
+		}
 
 		NetworkServer_Tick(send_frame);
 	} else {
@@ -21,6 +21,8 @@
 #include "../map_func.h"
 #include "../rev.h"
 #include "../game/game.hpp"
+#include "../linkgraph/linkgraphjob.h"
+#include "../framerate_type.h"
 
 #include "../safeguards.h"
 
@@ -53,6 +55,9 @@ static const AdminUpdateFrequency _admin_update_type_frequencies[] = {
 	ADMIN_FREQUENCY_POLL,                                                                                                                                  ///< ADMIN_UPDATE_CMD_NAMES
 	                       ADMIN_FREQUENCY_AUTOMATIC,                                                                                                      ///< ADMIN_UPDATE_CMD_LOGGING
 	                       ADMIN_FREQUENCY_AUTOMATIC,                                                                                                      ///< ADMIN_UPDATE_GAMESCRIPT
+	                       ADMIN_FREQUENCY_AUTOMATIC,                                                                                                      ///< ADMIN_UPDATE_LINKGRAPH_JOBS
+	ADMIN_FREQUENCY_POLL | ADMIN_FREQUENCY_DAILY | ADMIN_FREQUENCY_WEEKLY | ADMIN_FREQUENCY_MONTHLY | ADMIN_FREQUENCY_QUARTERLY | ADMIN_FREQUENCY_ANUALLY, ///< ADMIN_UPDATE_CLIENT_METRICS
+	ADMIN_FREQUENCY_POLL | ADMIN_FREQUENCY_DAILY | ADMIN_FREQUENCY_WEEKLY | ADMIN_FREQUENCY_MONTHLY | ADMIN_FREQUENCY_QUARTERLY | ADMIN_FREQUENCY_ANUALLY, ///< ADMIN_UPDATE_PERFORMANCE
 };
 /** Sanity check. */
 static_assert(lengthof(_admin_update_type_frequencies) == ADMIN_UPDATE_END);
@@ -588,6 +593,112 @@ NetworkRecvStatus ServerNetworkAdminSocketHandler::SendPong(uint32 d1)
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
+/**
+ * Send the sizes and timings of a joined link graph job.
+ * @param telemetry Telemetry of the job.
+ */
+NetworkRecvStatus ServerNetworkAdminSocketHandler::SendLinkGraphJob(const LinkGraphJobTelemetry &telemetry)
+{
+	Packet *p = new Packet(ADMIN_PACKET_SERVER_LINKGRAPH_JOB);
+
+	p->Send_uint16(telemetry.link_graph);
+	p->Send_uint8(telemetry.cargo);
+	p->Send_uint32(telemetry.nodes);
+	p->Send_uint32(telemetry.edges);
+	p->Send_uint64(telemetry.QueueWait());
+	for (TimingMeasurement duration : telemetry.stage_durations) {
+		p->Send_uint64(duration);
+	}
+	p->Send_uint64(telemetry.JoinLateness());
+	p->Send_uint64(telemetry.FinaliseTime());
+	this->SendPacket(p);
+
+	return NETWORK_RECV_STATUS_OKAY;
+}
+
+/**
+ * Send the network and lag metrics of a client.
+ * @param cs The socket of the client.
+ */
+NetworkRecvStatus ServerNetworkAdminSocketHandler::SendClientMetrics(const NetworkClientSocket *cs)
+{
+	/* Only send data when we're a proper client, not just someone trying to query the server. */
+	if (cs->GetInfo() == nullptr) return NETWORK_RECV_STATUS_OKAY;
+
+	auto to_ms = [](std::chrono::steady_clock::duration duration) -> uint32 {
+		return (uint32)std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+	};
+	const auto now = std::chrono::steady_clock::now();
+
+	size_t queued_packets;
+	size_t queued_bytes;
+	cs->GetSendQueueStatistics(queued_packets, queued_bytes);
+
+	uint32 map_transfer_time = 0;
+	if (cs->map_transfer_start != std::chrono::steady_clock::time_point()) {
+		bool done = cs->map_transfer_end >= cs->map_transfer_start;
+		map_transfer_time = std::max<uint32>(1, to_ms((done ? cs->map_transfer_end : now) - cs->map_transfer_start));
+	}
+
+	Packet *p = new Packet(ADMIN_PACKET_SERVER_CLIENT_METRICS);
+
+	p->Send_uint32(cs->client_id);
+	p->Send_uint8 (cs->status);
+	p->Send_uint32(cs->status >= NetworkClientSocket::STATUS_MAP ? NetworkCalculateLag(cs) : 0);
+	p->Send_uint32(to_ms(now - cs->connect_time));
+	p->Send_uint32((uint32)queued_packets);
+	p->Send_uint64(queued_bytes);
+	p->Send_uint64(cs->packets_received);
+	p->Send_uint64(cs->bytes_received);
+	p->Send_uint64(cs->commands_received);
+	p->Send_uint64(cs->map_bytes_sent);
+	p->Send_uint32(map_transfer_time);
+
+	this->SendPacket(p);
+
+	return NETWORK_RECV_STATUS_OKAY;
+}
+
+/**
+ * Send the network and lag metrics of all clients.
+ */
+NetworkRecvStatus ServerNetworkAdminSocketHandler::SendClientMetrics()
+{
+	for (const NetworkClientSocket *cs : NetworkClientSocket::Iterate()) {
+		this->SendClientMetrics(cs);
+	}
+
+	return NETWORK_RECV_STATUS_OKAY;
+}
+
+/** Send the statistics of the performance measurements. */
+NetworkRecvStatus ServerNetworkAdminSocketHandler::SendPerformance()
+{
+	auto to_us = [](double ms) -> uint32 { return (uint32)std::min<double>(ms * 1000, UINT32_MAX); };
+
+	Packet *p = new Packet(ADMIN_PACKET_SERVER_PERFORMANCE);
+
+	const uint count = GetPerformanceDataPointCount();
+	p->Send_uint16(count);
+	for (PerformanceElement e = PFE_FIRST; e < PFE_MAX; e++) {
+		PerformanceSummary summary;
+		if (!GetPerformanceSummary(e, count, summary)) continue;
+
+		p->Send_uint8 (e);
+		p->Send_uint16(summary.samples);
+		p->Send_uint32((uint32)std::min<double>(summary.rate * 1000, UINT32_MAX));
+		p->Send_uint32(to_us(summary.average));
+		p->Send_uint32(to_us(summary.p50));
+		p->Send_uint32(to_us(summary.p95));
+		p->Send_uint32(to_us(summary.p99));
+		p->Send_uint32(to_us(summary.max));
+	}
+
+	this->SendPacket(p);
+
+	return NETWORK_RECV_STATUS_OKAY;
+}
+
 /** Send the names of the commands. */
 NetworkRecvStatus ServerNetworkAdminSocketHandler::SendCmdNames()
 {
@@ -750,6 +861,21 @@ NetworkRecvStatus ServerNetworkAdminSocketHandler::Receive_ADMIN_POLL(Packet *p)
 			this->SendCompanyStats();
 			break;
 
+		case ADMIN_UPDATE_PERFORMANCE:
+			/* The admin is requesting performance statistics. */
+			this->SendPerformance();
+			break;
+
+		case ADMIN_UPDATE_CLIENT_METRICS:
+			/* The admin is requesting client metrics. */
+			if (d1 == UINT32_MAX) {
+				this->SendClientMetrics();
+			} else {
+				const NetworkClientSocket *cs = NetworkClientSocket::GetByClientID((ClientID)d1);
+				if (cs != nullptr) this->SendClientMetrics(cs);
+			}
+			break;
+
 		case ADMIN_UPDATE_CMD_NAMES:
 			/* The admin is requesting the names of DoCommands. */
 			this->SendCmdNames();
@@ -973,6 +1099,19 @@ void NetworkAdminGameScript(const std::string_view json)
 	}
 }
 
+/**
+ * Send the telemetry of a joined link graph job to the admin network (if they did opt in for the respective update).
+ * @param telemetry Telemetry of the job.
+ */
+void NetworkAdminLinkGraphJob(const LinkGraphJobTelemetry &telemetry)
+{
+	for (ServerNetworkAdminSocketHandler *as : ServerNetworkAdminSocketHandler::IterateActive()) {
+		if (as->update_frequency[ADMIN_UPDATE_LINKGRAPH_JOBS] & ADMIN_FREQUENCY_AUTOMATIC) {
+			as->SendLinkGraphJob(telemetry);
+		}
+	}
+}
+
 /**
  * Distribute CommandPacket details over the admin network for logging purposes.
  * @param owner The owner of the CommandPacket (who sent us the CommandPacket).
@@ -1022,6 +1161,14 @@ void NetworkAdminUpdate(AdminUpdateFrequency freq)
 						as->SendCompanyStats();
 						break;
 
+					case ADMIN_UPDATE_CLIENT_METRICS:
+						as->SendClientMetrics();
+						break;
+
+					case ADMIN_UPDATE_PERFORMANCE:
+						as->SendPerformance();
+						break;
+
 					default: NOT_REACHED();
 				}
 			}
@@ -14,6 +14,8 @@
 #include "core/tcp_listen.h"
 #include "core/tcp_admin.h"
 
+struct LinkGraphJobTelemetry;
+
 extern AdminIndex _redirect_console_to_admin;
 
 class ServerNetworkAdminSocketHandler;
@@ -69,6 +71,10 @@ public:
 	NetworkRecvStatus SendCmdNames();
 	NetworkRecvStatus SendCmdLogging(ClientID client_id, const CommandPacket *cp);
 	NetworkRecvStatus SendRconEnd(const std::string_view command);
+	NetworkRecvStatus SendLinkGraphJob(const LinkGraphJobTelemetry &telemetry);
+	NetworkRecvStatus SendClientMetrics(const NetworkClientSocket *cs);
+	NetworkRecvStatus SendClientMetrics();
+	NetworkRecvStatus SendPerformance();
 
 	static void Send();
 	static void AcceptConnection(SOCKET s, const NetworkAddress &address);
@@ -113,5 +119,6 @@ void NetworkServerSendAdminRcon(AdminIndex admin_index, TextColour colour_code,
 void NetworkAdminConsole(const std::string_view origin, const std::string_view string);
 void NetworkAdminGameScript(const std::string_view json);
 void NetworkAdminCmdLogging(const NetworkClientSocket *owner, const CommandPacket *cp);
+void NetworkAdminLinkGraphJob(const LinkGraphJobTelemetry &telemetry);
 
 #endif /* NETWORK_ADMIN_H */
@@ -38,6 +38,9 @@
 
 #include "../safeguards.h"
 
+extern uint64 _sync_state_checksum_parts[SCP_END];
+extern bool _sync_state_checksum_parts_valid;
+
 /* This file handles all the client-commands */
 
 /** Read some packets, and when do use that data as initial load filter. */
@@ -90,8 +93,8 @@ struct PacketReader : LoadFilter {
 		/* Did everything fit in the current chunk, then we're done. */
 		if (p->RemainingBytesToTransfer() == 0) return;
 
-		/* Allocate a new chunk and add the remaining data. */
-		this->blocks.push_back(this->buf = CallocT<byte>(CHUNK));
+		/* Allocate a new chunk and add the remaining data. It is not zeroed, the data is only read up to #written_bytes. */
+		this->blocks.push_back(this->buf = MallocT<byte>(CHUNK));
 		this->bufe = this->buf + CHUNK;
 
 		p->TransferOutWithLimit(TransferOutMemCopy, this->bufe - this->buf, this);
@@ -305,10 +308,16 @@ void ClientNetworkGameSocketHandler::ClientError(NetworkRecvStatus res)
 	/* Check if we are in sync! */
 	if (_sync_frame != 0) {
 		if (_sync_frame == _frame_counter) {
+			uint32 mismatched_parts = 0;
+			if (_sync_state_checksum_parts_valid && !HasChickenBit(DCBF_MP_NO_STATE_CSUM_CHECK)) {
+				for (uint i = 0; i < SCP_END; i++) {
+					if (_sync_state_checksum_parts[i] != _state_checksum_parts[i].state) SetBit(mismatched_parts, i);
+				}
+			}
 #ifdef NETWORK_SEND_DOUBLE_SEED
-			if (_sync_seed_1 != _random.state[0] || _sync_seed_2 != _random.state[1] || (_sync_state_checksum != _state_checksum.state && !HasChickenBit(DCBF_MP_NO_STATE_CSUM_CHECK))) {
+			if (_sync_seed_1 != _random.state[0] || _sync_seed_2 != _random.state[1] || (_sync_state_checksum != _state_checksum.state && !HasChickenBit(DCBF_MP_NO_STATE_CSUM_CHECK)) || mismatched_parts != 0) {
 #else
-			if (_sync_seed_1 != _random.state[0] || (_sync_state_checksum != _state_checksum.state && !HasChickenBit(DCBF_MP_NO_STATE_CSUM_CHECK))) {
+			if (_sync_seed_1 != _random.state[0] || (_sync_state_checksum != _state_checksum.state && !HasChickenBit(DCBF_MP_NO_STATE_CSUM_CHECK)) || mismatched_parts != 0) {
 #endif
 				DesyncExtraInfo info;
 				if (_sync_seed_1 != _random.state[0]) info.flags |= DesyncExtraInfo::DEIF_RAND1;
@@ -317,10 +326,18 @@ void ClientNetworkGameSocketHandler::ClientError(NetworkRecvStatus res)
 				info.flags |= DesyncExtraInfo::DEIF_DBL_RAND;
 #endif
 				if (_sync_state_checksum != _state_checksum.state) info.flags |= DesyncExtraInfo::DEIF_STATE;
+				if (mismatched_parts != 0) info.flags |= DesyncExtraInfo::DEIF_STATE_PARTS;
+				info.state_parts_mismatch = mismatched_parts;
 
 				ShowNetworkError(STR_NETWORK_ERROR_DESYNC);
 				DEBUG(desync, 1, "sync_err: date{%08x; %02x; %02x} {%x, " OTTD_PRINTFHEX64 "} != {%x, " OTTD_PRINTFHEX64 "}"
 						, _date, _date_fract, _tick_skip_counter, _sync_seed_1, _sync_state_checksum, _random.state[0], _state_checksum.state);
+				for (uint i = 0; i < SCP_END; i++) {
+					if (HasBit(mismatched_parts, i)) {
+						DEBUG(desync, 1, "sync_err: state checksum of %s differs: " OTTD_PRINTFHEX64 " != " OTTD_PRINTFHEX64,
+								GetStateChecksumPartName((StateChecksumPart)i), _sync_state_checksum_parts[i], _state_checksum_parts[i].state);
+					}
+				}
 				DEBUG(net, 0, "Sync error detected!");
 
 				std::string desync_log;
@@ -904,6 +921,9 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_MAP_SIZE(Packet
 	_network_join_bytes_total = p->Recv_uint32();
 	SetWindowDirty(WC_NETWORK_STATUS_WINDOW, WN_NETWORK_STATUS_WINDOW_JOIN);
 
+	/* Avoid repeatedly moving the list of blocks while large maps are downloaded. */
+	this->savegame->blocks.reserve(_network_join_bytes_total / PacketReader::CHUNK + 1);
+
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
@@ -1037,6 +1057,17 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_SYNC(Packet *p)
 #endif
 	_sync_state_checksum = p->Recv_uint64();
 
+	/* The checksums of the parts of the state are only sent when enabled by the server. */
+	_sync_state_checksum_parts_valid = false;
+	if (p->CanReadFromPacket(sizeof(uint8))) {
+		uint count = p->Recv_uint8();
+		for (uint i = 0; i < count; i++) {
+			uint64 checksum = p->Recv_uint64();
+			if (i < SCP_END) _sync_state_checksum_parts[i] = checksum;
+		}
+		_sync_state_checksum_parts_valid = (count == SCP_END);
+	}
+
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
@@ -1060,6 +1091,32 @@ NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_COMMAND(Packet
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
+NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_COMMAND_BATCH(Packet *p)
+{
+	if (this->status == STATUS_CLOSING) return NETWORK_RECV_STATUS_OKAY;
+	if (this->status != STATUS_ACTIVE) return NETWORK_RECV_STATUS_MALFORMED_PACKET;
+
+	uint32 frame = p->Recv_uint32();
+
+	CommandPacket cp;
+	const CommandPacket *prev = nullptr;
+	while (p->CanReadFromPacket(1)) {
+		const char *err = this->ReceiveCommandBatchEntry(p, &cp, prev);
+		if (err == nullptr && this->HasClientQuit()) err = "truncated command batch";
+		if (err != nullptr) {
+			IConsolePrintF(CC_ERROR, "WARNING: %s from server, dropping...", err);
+			return NETWORK_RECV_STATUS_MALFORMED_PACKET;
+		}
+		cp.frame  = frame;
+		cp.my_cmd = false;
+
+		this->incoming_queue.Append(cp);
+		prev = &cp;
+	}
+
+	return NETWORK_RECV_STATUS_OKAY;
+}
+
 NetworkRecvStatus ClientNetworkGameSocketHandler::Receive_SERVER_CHAT(Packet *p)
 {
 	if (this->status == STATUS_CLOSING) return NETWORK_RECV_STATUS_OKAY;
@@ -14,6 +14,7 @@
 #include "../command_func.h"
 #include "../company_func.h"
 #include "../settings_type.h"
+#include "../core/checksum_func.hpp"
 
 #include "../safeguards.h"
 
@@ -233,7 +234,12 @@ void NetworkExecuteLocalCommandQueue()
 		_current_company = cp->company;
 		_cmd_client_id = cp->client_id;
 		cp->cmd |= CMD_NETWORK_COMMAND;
-		DoCommandP(cp, cp->my_cmd);
+		bool success = DoCommandP(cp, cp->my_cmd);
+
+		UpdateStateSubChecksum((((uint64)cp->cmd) << 32) | cp->tile, SCP_COMMANDS);
+		UpdateStateSubChecksum((((uint64)cp->p1) << 32) | cp->p2, SCP_COMMANDS);
+		UpdateStateSubChecksum(cp->p3, SCP_COMMANDS);
+		UpdateStateSubChecksum((((uint64)cp->company) << 8) | (success ? 1 : 0), SCP_COMMANDS);
 
 		queue.Pop();
 	}
@@ -254,26 +260,43 @@ void NetworkFreeLocalCommandQueue()
 
 /**
  * "Send" a particular CommandPacket to all clients.
- * @param cp    The command that has to be distributed.
- * @param owner The client that owns the command,
+ * @param cp           The command that has to be distributed.
+ * @param owner        The client that owns the command,
+ * @param batch_packet The command batch packet starting with this command, if any.
+ * @param batched      Whether the command is in the command batch packet of an earlier command.
  */
-static void DistributeCommandPacket(CommandPacket &cp, const NetworkClientSocket *owner)
+static void DistributeCommandPacket(CommandPacket &cp, const NetworkClientSocket *owner, std::shared_ptr<const Packet> batch_packet = nullptr, bool batched = false)
 {
 	CommandCallback *callback = cp.callback;
 	cp.frame = _frame_counter_max + 1;
 
+	/* The packet for the clients which did not send the command is the same for all of them, so build it just once. */
+	std::shared_ptr<const Packet> broadcast_packet = std::move(batch_packet);
+
 	for (NetworkClientSocket *cs : NetworkClientSocket::Iterate()) {
 		if (cs->status >= NetworkClientSocket::STATUS_MAP) {
 			/* Callbacks are only send back to the client who sent them in the
 			 *  first place. This filters that out. */
 			cp.callback = (cs != owner) ? nullptr : callback;
 			cp.my_cmd = (cs == owner);
+			cp.broadcast_packet = nullptr;
+			cp.batched = false;
+			if (cs != owner) {
+				if (batched) {
+					cp.batched = true;
+				} else {
+					if (broadcast_packet == nullptr) broadcast_packet = Packet::MakeBroadcast(cs->CreateCommandPacket(&cp));
+					cp.broadcast_packet = broadcast_packet;
+				}
+			}
 			cs->outgoing_queue.Append(cp);
 		}
 	}
 
 	cp.callback = (nullptr != owner) ? nullptr : callback;
 	cp.my_cmd = (nullptr == owner);
+	cp.broadcast_packet = nullptr;
+	cp.batched = false;
 	_local_execution_queue.Append(cp);
 }
 
@@ -291,10 +314,31 @@ static void DistributeQueue(CommandQueue *queue, const NetworkClientSocket *owne
 	int to_go = _settings_client.network.commands_per_frame;
 #endif
 
+	std::vector<std::unique_ptr<CommandPacket>> batch;
 	std::unique_ptr<CommandPacket> cp;
 	while (--to_go >= 0 && (cp = queue->Pop(true)) != nullptr) {
-		DistributeCommandPacket(*cp, owner);
-		NetworkAdminCmdLogging(owner, cp.get());
+		cp->frame = _frame_counter_max + 1;
+		batch.push_back(std::move(cp));
+	}
+
+	/* Several commands for the same frame are sent to the clients which did not originate them in as few packets as possible. */
+	std::vector<std::shared_ptr<const Packet>> batch_packets;
+	if (batch.size() > 1) {
+		for (const NetworkClientSocket *cs : NetworkClientSocket::Iterate()) {
+			if (cs != owner && cs->status >= NetworkClientSocket::STATUS_MAP) {
+				batch_packets = ServerNetworkGameSocketHandler::CreateCommandBatchPackets(batch);
+				break;
+			}
+		}
+	}
+
+	for (size_t i = 0; i < batch.size(); i++) {
+		if (batch_packets.empty()) {
+			DistributeCommandPacket(*batch[i], owner);
+		} else {
+			DistributeCommandPacket(*batch[i], owner, batch_packets[i], batch_packets[i] == nullptr);
+		}
+		NetworkAdminCmdLogging(owner, batch[i].get());
 	}
 }
 
@@ -376,3 +420,110 @@ void NetworkGameSocketHandler::SendCommand(Packet *p, const CommandPacket *cp)
 	}
 	p->Send_uint8 (callback);
 }
+
+/** Flags of a command in a command batch packet, telling which fields are sent rather than taken from the previous command. */
+enum CommandBatchFlags : uint8 {
+	CBF_COMMAND    = 1 << 0, ///< The company and command are sent.
+	CBF_P1         = 1 << 1, ///< P1 is sent.
+	CBF_P2         = 1 << 2, ///< P2 is sent.
+	CBF_P3         = 1 << 3, ///< P3 is sent.
+	CBF_TILE_DELTA = 1 << 4, ///< The tile is sent as signed 16 bit offset to the previous tile.
+	CBF_TILE       = 1 << 5, ///< The tile is sent.
+	CBF_TEXT       = 1 << 6, ///< The binary length and the text or binary data are sent, otherwise there is no text.
+};
+
+/**
+ * Receives a command of a command batch from the network.
+ * @param p the packet to read from.
+ * @param cp the struct to write the data to.
+ * @param prev the previously received command of the batch, may be the same as \a cp, or nullptr for the first command.
+ * @return an error message. When nullptr there has been no error.
+ */
+const char *NetworkGameSocketHandler::ReceiveCommandBatchEntry(Packet *p, CommandPacket *cp, const CommandPacket *prev)
+{
+	byte flags = p->Recv_uint8();
+	if (prev == nullptr && (flags & CBF_COMMAND) == 0) return "command batch without initial command";
+
+	if (prev != nullptr && prev != cp) {
+		cp->company = prev->company;
+		cp->cmd     = prev->cmd;
+		cp->p1      = prev->p1;
+		cp->p2      = prev->p2;
+		cp->p3      = prev->p3;
+		cp->tile    = prev->tile;
+	}
+	if (prev == nullptr) {
+		cp->p1 = cp->p2 = cp->p3 = 0;
+		cp->tile = 0;
+	}
+
+	if (flags & CBF_COMMAND) {
+		cp->company = (CompanyID)p->Recv_uint8();
+		cp->cmd     = p->Recv_uint32();
+		if (!IsValidCommand(cp->cmd))               return "invalid command";
+		if (GetCommandFlags(cp->cmd) & CMD_OFFLINE) return "single-player only command";
+		if ((cp->cmd & CMD_FLAGS_MASK) != 0)        return "invalid command flag";
+	}
+	if (flags & CBF_P1) cp->p1 = p->Recv_uint32();
+	if (flags & CBF_P2) cp->p2 = p->Recv_uint32();
+	if (flags & CBF_P3) cp->p3 = p->Recv_uint64();
+	if (flags & CBF_TILE_DELTA) cp->tile += (int16)p->Recv_uint16();
+	if (flags & CBF_TILE) cp->tile = p->Recv_uint32();
+
+	cp->text.clear();
+	cp->binary_length = 0;
+	if (flags & CBF_TEXT) {
+		cp->binary_length = p->Recv_uint32();
+		if (cp->binary_length == 0) {
+			p->Recv_string(cp->text, (!_network_server && GetCommandFlags(cp->cmd) & CMD_STR_CTRL) != 0 ? SVS_ALLOW_CONTROL_CODE | SVS_REPLACE_WITH_QUESTION_MARK : SVS_REPLACE_WITH_QUESTION_MARK);
+		} else {
+			if (!p->CanReadFromPacket(cp->binary_length)) return "invalid binary data length";
+			if (cp->binary_length > MAX_CMD_TEXT_LENGTH) return "over-size binary data length";
+			p->Recv_binary(cp->text, cp->binary_length);
+		}
+	}
+
+	cp->callback = nullptr;
+	return nullptr;
+}
+
+/**
+ * Sends a command of a command batch over the network, only the fields differing from the previous command are sent.
+ * The callback is not sent, as batches are only sent to clients which did not originate the commands.
+ * @param p the packet to send it in.
+ * @param cp the packet to actually send.
+ * @param prev the previously sent command of the batch, or nullptr for the first command.
+ */
+/* static */ void NetworkGameSocketHandler::SendCommandBatchEntry(Packet *p, const CommandPacket *cp, const CommandPacket *prev)
+{
+	byte flags = 0;
+	if (prev == nullptr || cp->company != prev->company || cp->cmd != prev->cmd) flags |= CBF_COMMAND;
+	if (prev == nullptr ? cp->p1 != 0 : cp->p1 != prev->p1) flags |= CBF_P1;
+	if (prev == nullptr ? cp->p2 != 0 : cp->p2 != prev->p2) flags |= CBF_P2;
+	if (prev == nullptr ? cp->p3 != 0 : cp->p3 != prev->p3) flags |= CBF_P3;
+
+	int32 tile_delta = (int32)(cp->tile - (prev == nullptr ? 0 : prev->tile));
+	if (tile_delta != 0) flags |= (tile_delta >= INT16_MIN && tile_delta <= INT16_MAX) ? CBF_TILE_DELTA : CBF_TILE;
+
+	if (cp->binary_length != 0 || !cp->text.empty()) flags |= CBF_TEXT;
+
+	p->Send_uint8(flags);
+	if (flags & CBF_COMMAND) {
+		p->Send_uint8 (cp->company);
+		p->Send_uint32(cp->cmd);
+	}
+	if (flags & CBF_P1) p->Send_uint32(cp->p1);
+	if (flags & CBF_P2) p->Send_uint32(cp->p2);
+	if (flags & CBF_P3) p->Send_uint64(cp->p3);
+	if (flags & CBF_TILE_DELTA) p->Send_uint16((uint16)(int16)tile_delta);
+	if (flags & CBF_TILE) p->Send_uint32(cp->tile);
+	if (flags & CBF_TEXT) {
+		p->Send_uint32(cp->binary_length);
+		if (cp->binary_length == 0) {
+			p->Send_string(cp->text.c_str());
+		} else {
+			assert(cp->text.size() >= cp->binary_length);
+			p->Send_binary(cp->text.c_str(), cp->binary_length);
+		}
+	}
+}
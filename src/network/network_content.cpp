@@ -402,104 +402,22 @@ void ClientNetworkContentSocketHandler::DownloadSelectedContentFallback(const Co
 }
 
 /**
- * Determine the full filename of a piece of content information
- * @param ci         the information to get the filename from
- * @param compressed should the filename end with .gz?
- * @return a statically allocated buffer with the filename or
- *         nullptr when no filename could be made.
+ * Determine the full filename of the tar of a piece of content information
+ * @param ci the information to get the filename from
+ * @return the filename, or an empty string when no filename could be made.
  */
-static std::string GetFullFilename(const ContentInfo *ci, bool compressed)
+static std::string GetFullFilename(const ContentInfo *ci)
 {
 	Subdirectory dir = GetContentInfoSubDir(ci->type);
 	if (dir == NO_DIRECTORY) return {};
 
 	std::string buf = FioGetDirectory(SP_AUTODOWNLOAD_DIR, dir);
 	buf += ci->filename;
-	buf += compressed ? ".tar.gz" : ".tar";
+	buf += ".tar";
 
 	return buf;
 }
 
-/**
- * Gunzip a given file and remove the .gz if successful.
- * @param ci container with filename
- * @return true if the gunzip completed
- */
-static bool GunzipFile(const ContentInfo *ci)
-{
-#if defined(WITH_ZLIB)
-	bool ret = true;
-
-	/* Need to open the file with fopen() to support non-ASCII on Windows. */
-	FILE *ftmp = fopen(GetFullFilename(ci, true).c_str(), "rb");
-	if (ftmp == nullptr) return false;
-	/* Duplicate the handle, and close the FILE*, to avoid double-closing the handle later. */
-	int fdup = dup(fileno(ftmp));
-	gzFile fin = gzdopen(fdup, "rb");
-	fclose(ftmp);
-
-	FILE *fout = fopen(GetFullFilename(ci, false).c_str(), "wb");
-
-	if (fin == nullptr || fout == nullptr) {
-		ret = false;
-	} else {
-		byte buff[8192];
-		for (;;) {
-			int read = gzread(fin, buff, sizeof(buff));
-			if (read == 0) {
-				/* If gzread() returns 0, either the end-of-file has been
-				 * reached or an underlying read error has occurred.
-				 *
-				 * gzeof() can't be used, because:
-				 * 1.2.5 - it is safe, 1 means 'everything was OK'
-				 * 1.2.3.5, 1.2.4 - 0 or 1 is returned 'randomly'
-				 * 1.2.3.3 - 1 is returned for truncated archive
-				 *
-				 * So we use gzerror(). When proper end of archive
-				 * has been reached, then:
-				 * errnum == Z_STREAM_END in 1.2.3.3,
-				 * errnum == 0 in 1.2.4 and 1.2.5 */
-				int errnum;
-				gzerror(fin, &errnum);
-				if (errnum != 0 && errnum != Z_STREAM_END) ret = false;
-				break;
-			}
-			if (read < 0 || (size_t)read != fwrite(buff, 1, read, fout)) {
-				/* If gzread() returns -1, there was an error in archive */
-				ret = false;
-				break;
-			}
-			/* DO NOT DO THIS! It will fail to detect broken archive with 1.2.3.3!
-			 * if (read < sizeof(buff)) break; */
-		}
-	}
-
-	if (fin != nullptr) {
-		gzclose(fin);
-	} else if (fdup != -1) {
-		/* Failing gzdopen does not close the passed file descriptor. */
-		close(fdup);
-	}
-	if (fout != nullptr) fclose(fout);
-
-	return ret;
-#else
-	NOT_REACHED();
-#endif /* defined(WITH_ZLIB) */
-}
-
-/**
- * Simple wrapper around fwrite to be able to pass it to Packet's TransferOut.
- * @param file   The file to write data to.
- * @param buffer The buffer to write to the file.
- * @param amount The number of bytes to write.
- * @return The number of bytes that were written.
- */
-static inline ssize_t TransferOutFWrite(FILE *file, const char *buffer, size_t amount)
-{
-	return fwrite(buffer, 1, amount, file);
-}
-
 bool ClientNetworkContentSocketHandler::Receive_SERVER_CONTENT(Packet *p)
 {
 	if (this->curFile == nullptr) {
@@ -518,15 +436,15 @@ bool ClientNetworkContentSocketHandler::Receive_SERVER_CONTENT(Packet *p)
 	} else {
 		/* We have a file opened, thus are downloading internal content */
 		size_t toRead = p->RemainingBytesToTransfer();
-		if (toRead != 0 && (size_t)p->TransferOut(TransferOutFWrite, this->curFile) != toRead) {
+		if (toRead != 0 && !this->WriteDownloadedData(reinterpret_cast<const char *>(p->GetDataToTransferOut()), toRead)) {
 			DeleteWindowById(WC_NETWORK_STATUS_WINDOW, WN_NETWORK_STATUS_WINDOW_CONTENT_DOWNLOAD);
 			ShowErrorMessage(STR_CONTENT_ERROR_COULD_NOT_DOWNLOAD, STR_CONTENT_ERROR_COULD_NOT_DOWNLOAD_FILE_NOT_WRITABLE, WL_ERROR);
 			this->CloseConnection();
-			fclose(this->curFile);
-			this->curFile = nullptr;
+			this->CloseDownloadedFile(false);
 
 			return false;
 		}
+		p->MarkTransferredOut(toRead);
 
 		this->OnDownloadProgress(this->curInfo, (int)toRead);
 
@@ -549,37 +467,116 @@ bool ClientNetworkContentSocketHandler::BeforeDownload()
 	}
 
 	if (this->curInfo->filesize != 0) {
-		/* The filesize is > 0, so we are going to download it */
-		std::string filename = GetFullFilename(this->curInfo, true);
+		/* The filesize is > 0, so we are going to download it.
+		 * The data is decompressed while it is received, straight into the tar file. */
+		std::string filename = GetFullFilename(this->curInfo);
 		if (filename.empty() || (this->curFile = fopen(filename.c_str(), "wb")) == nullptr) {
 			/* Unless that fails of course... */
 			DeleteWindowById(WC_NETWORK_STATUS_WINDOW, WN_NETWORK_STATUS_WINDOW_CONTENT_DOWNLOAD);
 			ShowErrorMessage(STR_CONTENT_ERROR_COULD_NOT_DOWNLOAD, STR_CONTENT_ERROR_COULD_NOT_DOWNLOAD_FILE_NOT_WRITABLE, WL_ERROR);
 			return false;
 		}
+
+#if defined(WITH_ZLIB)
+		this->curStream = new z_stream();
+		/* Only accept the gzip format. */
+		if (inflateInit2(this->curStream, MAX_WBITS + 16) != Z_OK) {
+			delete this->curStream;
+			this->curStream = nullptr;
+			fclose(this->curFile);
+			this->curFile = nullptr;
+			return false;
+		}
+		this->curStreamEnded = false;
+		this->curReceived = 0;
+#else
+		NOT_REACHED();
+#endif /* defined(WITH_ZLIB) */
 	}
 	return true;
 }
 
 /**
- * Handle the closing and extracting of a file after
- * downloading it has been done.
+ * Decompress received data of the currently downloaded file, and write it to the file.
+ * @param data The received data.
+ * @param length The number of bytes of received data.
+ * @return false if the data could not be decompressed or written.
  */
-void ClientNetworkContentSocketHandler::AfterDownload()
+bool ClientNetworkContentSocketHandler::WriteDownloadedData(const char *data, size_t length)
 {
-	/* We read nothing; that's our marker for end-of-stream.
-	 * Now gunzip the tar and make it known. */
-	fclose(this->curFile);
+#if defined(WITH_ZLIB)
+	z_stream *z = this->curStream;
+	z->next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+	z->avail_in = (uInt)length;
+
+	byte buff[8192];
+	for (;;) {
+		if (this->curStreamEnded) {
+			if (z->avail_in == 0) break;
+			/* Decompress concatenated gzip members one after the other, like gzread does. */
+			if (inflateReset(z) != Z_OK) return false;
+			this->curStreamEnded = false;
+		}
+
+		z->next_out = buff;
+		z->avail_out = sizeof(buff);
+		int res = inflate(z, Z_NO_FLUSH);
+		if (res == Z_STREAM_END) {
+			this->curStreamEnded = true;
+		} else if (res != Z_OK && res != Z_BUF_ERROR) {
+			return false;
+		}
+
+		size_t written = sizeof(buff) - z->avail_out;
+		if (written != 0 && fwrite(buff, 1, written, this->curFile) != written) return false;
+
+		/* All input is consumed, and there is no pending output left. */
+		if (z->avail_in == 0 && z->avail_out != 0) break;
+	}
+	this->curReceived += length;
+	return true;
+#else
+	NOT_REACHED();
+#endif /* defined(WITH_ZLIB) */
+}
+
+/**
+ * Close the currently downloaded file, and remove it unless it was completely received and decompressed.
+ * @param complete Whether the whole file has been received.
+ * @return true if the file is complete.
+ */
+bool ClientNetworkContentSocketHandler::CloseDownloadedFile(bool complete)
+{
+	bool ok = complete && this->curStreamEnded;
+
+#if defined(WITH_ZLIB)
+	if (this->curStream != nullptr) {
+		inflateEnd(this->curStream);
+		delete this->curStream;
+		this->curStream = nullptr;
+	}
+#endif /* defined(WITH_ZLIB) */
+
+	if (fclose(this->curFile) != 0) ok = false;
 	this->curFile = nullptr;
 
-	if (GunzipFile(this->curInfo)) {
-		unlink(GetFullFilename(this->curInfo, true).c_str());
+	if (!ok) unlink(GetFullFilename(this->curInfo).c_str());
+	return ok;
+}
 
+/**
+ * Handle the closing of a file after downloading it has been done, and make it known.
+ */
+void ClientNetworkContentSocketHandler::AfterDownload()
+{
+	/* We read nothing; that's our marker for end-of-stream.
+	 * The tar has been decompressed while downloading, make it known. */
+	if (this->CloseDownloadedFile(true)) {
 		Subdirectory sd = GetContentInfoSubDir(this->curInfo->type);
 		if (sd == NO_DIRECTORY) NOT_REACHED();
 
 		TarScanner ts;
-		std::string fname = GetFullFilename(this->curInfo, false);
+		std::string fname = GetFullFilename(this->curInfo);
 		ts.AddFile(sd, fname);
 
 		if (this->curInfo->type == CONTENT_TYPE_BASE_MUSIC) {
@@ -611,11 +608,9 @@ void ClientNetworkContentSocketHandler::OnFailure()
 
 	if (this->curFile != nullptr) {
 		/* Revert the download progress when we are going for the old system. */
-		long size = ftell(this->curFile);
-		if (size > 0) this->OnDownloadProgress(this->curInfo, (int)-size);
+		if (this->curReceived > 0) this->OnDownloadProgress(this->curInfo, -(int)this->curReceived);
 
-		fclose(this->curFile);
-		this->curFile = nullptr;
+		this->CloseDownloadedFile(false);
 	}
 }
 
@@ -641,8 +636,8 @@ void ClientNetworkContentSocketHandler::OnReceiveData(const char *data, size_t l
 	}
 
 	if (data != nullptr) {
-		/* We have data, so write it to the file. */
-		if (fwrite(data, 1, length, this->curFile) != length) {
+		/* We have data, so decompress it to the file. */
+		if (!this->WriteDownloadedData(data, length)) {
 			/* Writing failed somehow, let try via the old method. */
 			this->OnFailure();
 		} else {
@@ -751,6 +746,9 @@ ClientNetworkContentSocketHandler::ClientNetworkContentSocketHandler() :
 	NetworkContentSocketHandler(),
 	http_response_index(-2),
 	curFile(nullptr),
+	curStream(nullptr),
+	curStreamEnded(false),
+	curReceived(0),
 	curInfo(nullptr),
 	isConnecting(false)
 {
@@ -760,8 +758,8 @@ ClientNetworkContentSocketHandler::ClientNetworkContentSocketHandler() :
 /** Clear up the mess ;) */
 ClientNetworkContentSocketHandler::~ClientNetworkContentSocketHandler()
 {
+	if (this->curFile != nullptr) this->CloseDownloadedFile(false);
 	delete this->curInfo;
-	if (this->curFile != nullptr) fclose(this->curFile);
 
 	for (ContentInfo *ci : this->infos) delete ci;
 }
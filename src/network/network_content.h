@@ -73,7 +73,10 @@ protected:
 	std::vector<char> http_response;              ///< The HTTP response to the requests we've been doing
 	int http_response_index;                      ///< Where we are, in the response, with handling it
 
-	FILE *curFile;        ///< Currently downloaded file
+	FILE *curFile;        ///< Currently downloaded file, written decompressed
+	struct z_stream_s *curStream; ///< Decompression state of the currently downloaded file
+	bool curStreamEnded;  ///< Whether the end of the compressed stream of the currently downloaded file has been reached
+	size_t curReceived;   ///< Number of compressed bytes received of the currently downloaded file
 	ContentInfo *curInfo; ///< Information about the currently downloaded file
 	bool isConnecting;    ///< Whether we're connecting
 	std::chrono::steady_clock::time_point lastActivity;  ///< The last time there was network activity
@@ -98,6 +101,8 @@ protected:
 
 	bool BeforeDownload();
 	void AfterDownload();
+	bool WriteDownloadedData(const char *data, size_t length);
+	bool CloseDownloadedFile(bool complete);
 
 	void DownloadSelectedContentHTTP(const ContentIDList &content);
 	void DownloadSelectedContentFallback(const ContentIDList &content);
@@ -113,12 +113,14 @@ void UpdateNetworkGameWindow();
  */
 struct CommandPacket : CommandContainer {
 	/** Make sure the pointer is nullptr. */
-	CommandPacket() : next(nullptr), frame(0), client_id(INVALID_CLIENT_ID), company(INVALID_COMPANY), my_cmd(false) {}
+	CommandPacket() : next(nullptr), frame(0), client_id(INVALID_CLIENT_ID), company(INVALID_COMPANY), my_cmd(false), batched(false) {}
 	CommandPacket *next; ///< the next command packet (if in queue)
 	uint32 frame;        ///< the frame in which this packet is executed
 	ClientID client_id;  ///< originating client ID (or INVALID_CLIENT_ID if not specified)
 	CompanyID company;   ///< company that is executing the command
 	bool my_cmd;         ///< did the command originate from "me"
+	bool batched;        ///< the command is sent to the client by the broadcast packet of an earlier command of the same batch
+	std::shared_ptr<const Packet> broadcast_packet; ///< the packet sending this command to every client which did not originate it, when distributed by the server
 };
 
 void NetworkDistributeCommands();
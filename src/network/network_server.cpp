@@ -30,6 +30,7 @@
 #include "../core/random_func.hpp"
 #include "../rev.h"
 #include "../crashlog.h"
+#include "../core/checksum_func.hpp"
 #include <mutex>
 #include <condition_variable>
 #if defined(__MINGW32__)
@@ -39,6 +40,8 @@
 
 #include "../safeguards.h"
 
+extern uint64 _sync_state_checksum_parts[SCP_END];
+
 
 /* This file handles all the server-commands */
 
@@ -58,21 +61,24 @@ INSTANTIATE_POOL_METHODS(NetworkClientSocket)
 /** Instantiate the listen sockets. */
 template SocketList TCPListenHandler<ServerNetworkGameSocketHandler, PACKET_SERVER_FULL, PACKET_SERVER_BANNED>::sockets;
 
-/** Writing a savegame directly to a number of packets. */
+/**
+ * Writing a savegame directly to a number of packets.
+ * A single writer can be shared by all clients which started downloading the
+ * map at the same frame, so the game only has to be saved and compressed once.
+ */
 struct PacketWriter : SaveFilter {
-	ServerNetworkGameSocketHandler *cs; ///< Socket we are associated with.
+	uint clients;                       ///< Number of sockets we are associated with.
 	std::unique_ptr<Packet> current;    ///< The packet we're currently writing to.
 	size_t total_size;                  ///< Total size of the compressed savegame.
-	std::vector<std::unique_ptr<Packet>> packets; ///< Packet queue of the savegame; send these "slowly" to the client.
-	std::unique_ptr<Packet> map_size_packet; ///< Map size packet, fast tracked to the client
+	std::vector<std::unique_ptr<Packet>> packets; ///< Packet queue of the savegame; send these "slowly" to the clients.
+	std::unique_ptr<Packet> map_size_packet; ///< Map size packet, fast tracked to the clients
 	std::mutex mutex;                   ///< Mutex for making threaded saving safe.
 	std::condition_variable exit_sig;   ///< Signal for threaded destruction of this packet writer.
 
 	/**
 	 * Create the packet writer.
-	 * @param cs The socket handler we're making the packets for.
 	 */
-	PacketWriter(ServerNetworkGameSocketHandler *cs) : SaveFilter(nullptr), cs(cs), total_size(0)
+	PacketWriter() : SaveFilter(nullptr), clients(0), total_size(0)
 	{
 	}
 
@@ -81,9 +87,9 @@ struct PacketWriter : SaveFilter {
 	{
 		std::unique_lock<std::mutex> lock(this->mutex);
 
-		if (this->cs != nullptr) this->exit_sig.wait(lock);
+		if (this->clients != 0) this->exit_sig.wait(lock);
 
-		/* This must all wait until the Destroy function is called. */
+		/* This must all wait until the last Destroy function is called. */
 
 		this->packets.clear();
 		this->map_size_packet.reset();
@@ -91,20 +97,39 @@ struct PacketWriter : SaveFilter {
 	}
 
 	/**
-	 * Begin the destruction of this packet writer. It can happen in two ways:
-	 * in the first case the client disconnected while saving the map. In this
+	 * Associate another socket with this packet writer.
+	 * This must be done before the saving starts.
+	 * @param socket The network socket which will receive the packets.
+	 */
+	void Attach(ServerNetworkGameSocketHandler *socket)
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+
+		this->clients++;
+		socket->savegame = this;
+		socket->savegame_next_packet = 0;
+		socket->savegame_size_sent = false;
+	}
+
+	/**
+	 * Dissociate a socket from this packet writer, and begin the destruction
+	 * of the packet writer when it was the last one. It can happen in two ways:
+	 * in the first case all clients disconnected while saving the map. In this
 	 * case the saving has not finished and killed this PacketWriter. In that
-	 * case we simply set cs to nullptr, triggering the appending to fail due to
+	 * case we simply set clients to 0, triggering the appending to fail due to
 	 * the connection problem and eventually triggering the destructor. In the
 	 * second case the destructor is already called, and it is waiting for our
 	 * signal which we will send. Only then the packets will be removed by the
 	 * destructor.
+	 * @param socket The network socket to dissociate.
 	 */
-	void Destroy()
+	void Destroy(ServerNetworkGameSocketHandler *socket)
 	{
 		std::unique_lock<std::mutex> lock(this->mutex);
 
-		this->cs = nullptr;
+		assert(socket->savegame == this && this->clients > 0);
+		socket->savegame = nullptr;
+		if (--this->clients != 0) return;
 
 		this->exit_sig.notify_all();
 		lock.unlock();
@@ -116,8 +141,9 @@ struct PacketWriter : SaveFilter {
 	}
 
 	/**
-	 * Transfer all packets from here to the network's queue while holding
-	 * the lock on our mutex.
+	 * Transfer all packets the socket has not received yet from here to the
+	 * network's queue while holding the lock on our mutex. The packets are
+	 * only copied when other sockets still need them.
 	 * @param socket The network socket to write to.
 	 * @return True iff the last packet of the map has been sent.
 	 */
@@ -125,17 +151,24 @@ struct PacketWriter : SaveFilter {
 	{
 		std::lock_guard<std::mutex> lock(this->mutex);
 
-		if (this->map_size_packet) {
+		const bool shared = this->clients > 1;
+		if (this->map_size_packet && !socket->savegame_size_sent) {
 			/* Don't queue the PACKET_SERVER_MAP_SIZE before the corresponding PACKET_SERVER_MAP_BEGIN */
-			socket->SendPrependPacket(std::move(this->map_size_packet), PACKET_SERVER_MAP_BEGIN);
+			socket->SendPrependPacket(shared ? std::make_unique<Packet>(*this->map_size_packet) : std::move(this->map_size_packet), PACKET_SERVER_MAP_BEGIN);
+			socket->savegame_size_sent = true;
 		}
 		bool last_packet = false;
-		for (auto &p : this->packets) {
+		for (size_t &i = socket->savegame_next_packet; i < this->packets.size(); i++) {
+			std::unique_ptr<Packet> &p = this->packets[i];
 			if (p->GetPacketType() == PACKET_SERVER_MAP_DONE) last_packet = true;
-			socket->SendPacket(std::move(p));
-
+			socket->map_bytes_sent += p->Size();
+			socket->SendPacket(shared ? std::make_unique<Packet>(*p) : std::move(p));
+		}
+		if (!shared) {
+			/* Nobody else needs these packets, so drop the moved-from entries. */
+			this->packets.clear();
+			socket->savegame_next_packet = 0;
 		}
-		this->packets.clear();
 
 		return last_packet;
 	}
@@ -150,8 +183,8 @@ struct PacketWriter : SaveFilter {
 
 	void Write(byte *buf, size_t size) override
 	{
-		/* We want to abort the saving when the socket is closed. */
-		if (this->cs == nullptr) SlError(STR_NETWORK_ERROR_LOSTCONNECTION);
+		/* We want to abort the saving when all sockets are closed. */
+		if (this->clients == 0) SlError(STR_NETWORK_ERROR_LOSTCONNECTION);
 
 		if (this->current == nullptr) this->current.reset(new Packet(PACKET_SERVER_MAP_DATA, SHRT_MAX));
 
@@ -173,8 +206,8 @@ struct PacketWriter : SaveFilter {
 
 	void Finish() override
 	{
-		/* We want to abort the saving when the socket is closed. */
-		if (this->cs == nullptr) SlError(STR_NETWORK_ERROR_LOSTCONNECTION);
+		/* We want to abort the saving when all sockets are closed. */
+		if (this->clients == 0) SlError(STR_NETWORK_ERROR_LOSTCONNECTION);
 
 		std::lock_guard<std::mutex> lock(this->mutex);
 
@@ -185,7 +218,7 @@ struct PacketWriter : SaveFilter {
 		this->current.reset(new Packet(PACKET_SERVER_MAP_DONE, SHRT_MAX));
 		this->AppendQueue();
 
-		/* Fast-track the size to the client. */
+		/* Fast-track the size to the clients. */
 		this->map_size_packet.reset(new Packet(PACKET_SERVER_MAP_SIZE, SHRT_MAX));
 		this->map_size_packet->Send_uint32((uint32)this->total_size);
 	}
@@ -204,6 +237,7 @@ ServerNetworkGameSocketHandler::ServerNetworkGameSocketHandler(SOCKET s) : Netwo
 	this->server_hash_bits = InteractiveRandom();
 	this->rcon_hash_bits = InteractiveRandom();
 	this->settings_hash_bits = InteractiveRandom();
+	this->connect_time = std::chrono::steady_clock::now();
 
 	/* The Socket and Info pools need to be the same in size. After all,
 	 * each Socket will be associated with at most one Info object. As
@@ -222,10 +256,7 @@ ServerNetworkGameSocketHandler::~ServerNetworkGameSocketHandler()
 	extern void RemoveVirtualTrainsOfUser(uint32 user);
 	RemoveVirtualTrainsOfUser(this->client_id);
 
-	if (this->savegame != nullptr) {
-		this->savegame->Destroy();
-		this->savegame = nullptr;
-	}
+	if (this->savegame != nullptr) this->savegame->Destroy(this);
 }
 
 std::unique_ptr<Packet> ServerNetworkGameSocketHandler::ReceivePacket()
@@ -237,7 +268,11 @@ std::unique_ptr<Packet> ServerNetworkGameSocketHandler::ReceivePacket()
 	/* We can receive a packet, so try that and if needed account for
 	 * the amount of received data. */
 	std::unique_ptr<Packet> p = this->NetworkTCPSocketHandler::ReceivePacket();
-	if (p != nullptr) this->receive_limit -= p->Size();
+	if (p != nullptr) {
+		this->receive_limit -= p->Size();
+		this->packets_received++;
+		this->bytes_received += p->Size();
+	}
 	return p;
 }
 
@@ -272,9 +307,8 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::CloseConnection(NetworkRecvSta
 	/* If we were transfering a map to this client, stop the savegame creation
 	 * process and queue the next client to receive the map. */
 	if (this->status == STATUS_MAP) {
-		/* Ensure the saving of the game is stopped too. */
-		this->savegame->Destroy();
-		this->savegame = nullptr;
+		/* Ensure the saving of the game is stopped too, unless other clients still need it. */
+		this->savegame->Destroy(this);
 
 		this->CheckNextClientToSendMap(this);
 	}
@@ -399,7 +433,7 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendError(NetworkErrorCode err
 
 		this->GetClientName(client_name, lastof(client_name));
 
-		DEBUG(net, 1, "'%s' made an error and has been disconnected: %s", client_name, GetString(strid).c_str());
+		DEBUG(net, 1, "'%s' made an error and has been disconnected: %s", client_name, GetStringTemp(strid));
 
 		if (error == NETWORK_ERROR_KICKED && !reason.empty()) {
 			NetworkTextMessage(NETWORK_ACTION_KICKED, CC_DEFAULT, false, client_name, reason, strid);
@@ -420,7 +454,7 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendError(NetworkErrorCode err
 
 		NetworkAdminClientError(this->client_id, error);
 	} else {
-		DEBUG(net, 1, "Client %d made an error and has been disconnected: %s", this->client_id, GetString(strid).c_str());
+		DEBUG(net, 1, "Client %d made an error and has been disconnected: %s", this->client_id, GetStringTemp(strid));
 	}
 
 	/* The client made a mistake, so drop the connection now! */
@@ -554,6 +588,9 @@ void ServerNetworkGameSocketHandler::CheckNextClientToSendMap(NetworkClientSocke
 	for (NetworkClientSocket *new_cs : NetworkClientSocket::Iterate()) {
 		if (ignore_cs == new_cs) continue;
 
+		/* Only keep one map dump in memory; wait until everyone sharing the current one is done. */
+		if (new_cs->status == STATUS_MAP) return;
+
 		if (new_cs->status == STATUS_MAP_WAIT) {
 			if (best == nullptr || best->GetInfo()->join_date > new_cs->GetInfo()->join_date || (best->GetInfo()->join_date == new_cs->GetInfo()->join_date && best->client_id > new_cs->client_id)) {
 				best = new_cs;
@@ -584,31 +621,52 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendMap()
 
 	if (this->status == STATUS_AUTHORIZED) {
 		WaitTillSaved();
-		this->savegame = new PacketWriter(this);
-
-		/* Now send the _frame_counter and how many packets are coming */
-		Packet *p = new Packet(PACKET_SERVER_MAP_BEGIN, SHRT_MAX);
-		p->Send_uint32(_frame_counter);
-		this->SendPacket(p);
+		PacketWriter *writer = new PacketWriter();
 
-		NetworkSyncCommandQueue(this);
-		this->status = STATUS_MAP;
-		/* Mark the start of download */
-		this->last_frame = _frame_counter;
-		this->last_frame_server = _frame_counter;
+		/* Let the clients waiting for a map with the same capabilities share this dump, in joining order. */
+		std::vector<NetworkClientSocket *> sockets = { this };
+		for (NetworkClientSocket *new_cs : NetworkClientSocket::Iterate()) {
+			if (new_cs->status == STATUS_MAP_WAIT && new_cs->supports_zstd == this->supports_zstd) sockets.push_back(new_cs);
+		}
+		std::sort(sockets.begin() + 1, sockets.end(), [](const NetworkClientSocket *a, const NetworkClientSocket *b) {
+			if (a->GetInfo()->join_date != b->GetInfo()->join_date) return a->GetInfo()->join_date < b->GetInfo()->join_date;
+			return a->client_id < b->client_id;
+		});
+		if (sockets.size() > _settings_client.network.max_map_transfer_clients) sockets.resize(_settings_client.network.max_map_transfer_clients);
+
+		for (NetworkClientSocket *cs : sockets) {
+			writer->Attach(cs);
+
+			/* Now send the _frame_counter and how many packets are coming */
+			Packet *p = new Packet(PACKET_SERVER_MAP_BEGIN, SHRT_MAX);
+			p->Send_uint32(_frame_counter);
+			cs->SendPacket(p);
+
+			NetworkSyncCommandQueue(cs);
+			cs->status = STATUS_MAP;
+			/* Mark the start of download */
+			cs->last_frame = _frame_counter;
+			cs->last_frame_server = _frame_counter;
+			cs->map_transfer_start = std::chrono::steady_clock::now();
+		}
+		if (sockets.size() > 1) {
+			DEBUG(net, 3, "[%s] Sending the same map to %u clients", ServerNetworkGameSocketHandler::GetName(), (uint)sockets.size());
+			for (NetworkClientSocket *new_cs : NetworkClientSocket::Iterate()) {
+				if (new_cs->status == STATUS_MAP_WAIT) new_cs->SendWait();
+			}
+		}
 
 		/* Make a dump of the current game */
 		SaveModeFlags flags = SMF_NET_SERVER;
 		if (this->supports_zstd) flags |= SMF_ZSTD_OK;
-		if (SaveWithFilter(this->savegame, true, flags) != SL_OK) usererror("network savedump failed");
+		if (SaveWithFilter(writer, true, flags) != SL_OK) usererror("network savedump failed");
 	}
 
 	if (this->status == STATUS_MAP) {
 		bool last_packet = this->savegame->TransferToNetworkQueue(this);
 		if (last_packet) {
 			/* Done reading, make sure saving is done as well */
-			this->savegame->Destroy();
-			this->savegame = nullptr;
+			this->savegame->Destroy(this);
 
 			/* Set the status to DONE_MAP, no we will wait for the client
 			 *  to send it is ready (maybe that happens like never ;)) */
@@ -634,10 +692,19 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendJoin(ClientID client_id)
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
-/** Tell the client that they may run to a particular frame. */
-NetworkRecvStatus ServerNetworkGameSocketHandler::SendFrame()
+/**
+ * Tell the client that they may run to a particular frame.
+ * @param broadcast If not nullptr, the frame packet which is shared between the clients this frame, it is created when needed.
+ */
+NetworkRecvStatus ServerNetworkGameSocketHandler::SendFrame(std::shared_ptr<const Packet> *broadcast)
 {
-	Packet *p = new Packet(PACKET_SERVER_FRAME, SHRT_MAX);
+	/* The packet can only be shared with the other clients when no token needs to be sent. */
+	if (broadcast != nullptr && this->last_token != 0 && *broadcast != nullptr) {
+		this->SendPacket(*broadcast);
+		return NETWORK_RECV_STATUS_OKAY;
+	}
+
+	std::unique_ptr<Packet> p(new Packet(PACKET_SERVER_FRAME, SHRT_MAX));
 	p->Send_uint32(_frame_counter);
 	p->Send_uint32(_frame_counter_max);
 #ifdef ENABLE_NETWORK_SYNC_EVERY_FRAME
@@ -652,16 +719,28 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendFrame()
 	if (this->last_token == 0) {
 		this->last_token = InteractiveRandomRange(UINT8_MAX - 1) + 1;
 		p->Send_uint8(this->last_token);
+	} else if (broadcast != nullptr) {
+		*broadcast = Packet::MakeBroadcast(std::move(p));
+		this->SendPacket(*broadcast);
+		return NETWORK_RECV_STATUS_OKAY;
 	}
 
-	this->SendPacket(p);
+	this->SendPacket(std::move(p));
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
-/** Request the client to sync. */
-NetworkRecvStatus ServerNetworkGameSocketHandler::SendSync()
+/**
+ * Request the client to sync.
+ * @param broadcast If not nullptr, the sync packet which is shared between the clients this frame, it is created when needed.
+ */
+NetworkRecvStatus ServerNetworkGameSocketHandler::SendSync(std::shared_ptr<const Packet> *broadcast)
 {
-	Packet *p = new Packet(PACKET_SERVER_SYNC, SHRT_MAX);
+	if (broadcast != nullptr && *broadcast != nullptr) {
+		this->SendPacket(*broadcast);
+		return NETWORK_RECV_STATUS_OKAY;
+	}
+
+	std::unique_ptr<Packet> p(new Packet(PACKET_SERVER_SYNC, SHRT_MAX));
 	p->Send_uint32(_frame_counter);
 	p->Send_uint32(_sync_seed_1);
 
@@ -669,23 +748,87 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::SendSync()
 	p->Send_uint32(_sync_seed_2);
 #endif
 	p->Send_uint64(_sync_state_checksum);
-	this->SendPacket(p);
+
+	if (_settings_client.network.sync_state_checksum_parts) {
+		p->Send_uint8(SCP_END);
+		for (uint64 checksum : _sync_state_checksum_parts) {
+			p->Send_uint64(checksum);
+		}
+	}
+
+	if (broadcast != nullptr) {
+		*broadcast = Packet::MakeBroadcast(std::move(p));
+		this->SendPacket(*broadcast);
+	} else {
+		this->SendPacket(std::move(p));
+	}
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
 /**
- * Send a command to the client to execute.
+ * Create the packet to send a command to the client with.
  * @param cp The command to send.
+ * @return The packet.
  */
-NetworkRecvStatus ServerNetworkGameSocketHandler::SendCommand(const CommandPacket *cp)
+std::unique_ptr<Packet> ServerNetworkGameSocketHandler::CreateCommandPacket(const CommandPacket *cp)
 {
-	Packet *p = new Packet(PACKET_SERVER_COMMAND, SHRT_MAX);
+	std::unique_ptr<Packet> p(new Packet(PACKET_SERVER_COMMAND, SHRT_MAX));
 
-	this->NetworkGameSocketHandler::SendCommand(p, cp);
+	this->NetworkGameSocketHandler::SendCommand(p.get(), cp);
 	p->Send_uint32(cp->frame);
 	p->Send_bool  (cp->my_cmd);
 
-	this->SendPacket(p);
+	return p;
+}
+
+/**
+ * Create the packets to send a batch of commands of the same frame to the clients which did not originate them.
+ * @param batch The commands to send.
+ * @return For each command the broadcast packet starting with it, or nullptr when it is in the packet of an earlier command.
+ */
+std::vector<std::shared_ptr<const Packet>> ServerNetworkGameSocketHandler::CreateCommandBatchPackets(const std::vector<std::unique_ptr<CommandPacket>> &batch)
+{
+	std::vector<std::shared_ptr<const Packet>> packets(batch.size());
+
+	std::unique_ptr<Packet> p;
+	size_t first = 0;
+	const CommandPacket *prev = nullptr;
+	for (size_t i = 0; i < batch.size(); i++) {
+		const CommandPacket *cp = batch[i].get();
+
+		/* Flags, company, command, p1, p2, p3, tile and binary length; followed by the text or binary data. */
+		size_t max_entry_size = 1 + 1 + 4 + 4 + 4 + 8 + 4 + 4 + (cp->binary_length == 0 ? cp->text.size() + 1 : cp->binary_length);
+		if (p != nullptr && !p->CanWriteToPacket(max_entry_size)) {
+			packets[first] = Packet::MakeBroadcast(std::move(p));
+		}
+		if (p == nullptr) {
+			p.reset(new Packet(PACKET_SERVER_COMMAND_BATCH, SHRT_MAX));
+			p->Send_uint32(cp->frame);
+			first = i;
+			prev = nullptr;
+		}
+
+		NetworkGameSocketHandler::SendCommandBatchEntry(p.get(), cp, prev);
+		prev = cp;
+	}
+	if (p != nullptr) packets[first] = Packet::MakeBroadcast(std::move(p));
+
+	return packets;
+}
+
+/**
+ * Send a command to the client to execute.
+ * @param cp The command to send.
+ */
+NetworkRecvStatus ServerNetworkGameSocketHandler::SendCommand(const CommandPacket *cp)
+{
+	if (cp->batched) return NETWORK_RECV_STATUS_OKAY;
+
+	if (cp->broadcast_packet != nullptr) {
+		this->SendPacket(cp->broadcast_packet);
+	} else {
+		this->SendPacket(this->CreateCommandPacket(cp));
+	}
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
@@ -1056,6 +1199,8 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::Receive_CLIENT_MAP_OK(Packet *
 	if (this->status == STATUS_DONE_MAP && !this->HasClientQuit()) {
 		char client_name[NETWORK_CLIENT_NAME_LENGTH];
 
+		this->map_transfer_end = std::chrono::steady_clock::now();
+
 		this->GetClientName(client_name, lastof(client_name));
 
 		NetworkTextMessage(NETWORK_ACTION_JOIN, CC_DEFAULT, false, client_name, "", this->client_id);
@@ -1162,6 +1307,7 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::Receive_CLIENT_COMMAND(Packet
 	cp.client_id = this->client_id;
 
 	this->incoming_queue.Append(std::move(cp));
+	this->commands_received++;
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
@@ -1177,7 +1323,7 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::Receive_CLIENT_ERROR(Packet *p
 
 	/* The client was never joined.. thank the client for the packet, but ignore it */
 	if (this->status < STATUS_DONE_MAP || this->HasClientQuit()) {
-		DEBUG(net, 2, "non-joined client %d reported an error and is closing its connection (%s) (%d, %d, %d)", this->client_id, GetString(GetNetworkErrorMsg(errorno)).c_str(), rx_status, status, last_pkt_type);
+		DEBUG(net, 2, "non-joined client %d reported an error and is closing its connection (%s) (%d, %d, %d)", this->client_id, GetStringTemp(GetNetworkErrorMsg(errorno)), rx_status, status, last_pkt_type);
 		return this->CloseConnection(NETWORK_RECV_STATUS_CLIENT_QUIT);
 	}
 
@@ -1185,7 +1331,7 @@ NetworkRecvStatus ServerNetworkGameSocketHandler::Receive_CLIENT_ERROR(Packet *p
 
 	StringID strid = GetNetworkErrorMsg(errorno);
 
-	DEBUG(net, 1, "'%s' reported an error and is closing its connection (%s) (%d, %d, %d)", client_name, GetString(strid).c_str(), rx_status, status, last_pkt_type);
+	DEBUG(net, 1, "'%s' reported an error and is closing its connection (%s) (%d, %d, %d)", client_name, GetStringTemp(strid), rx_status, status, last_pkt_type);
 
 	NetworkTextMessage(NETWORK_ACTION_LEAVE, CC_DEFAULT, false, client_name, "", strid);
 
@@ -1867,6 +2013,10 @@ void NetworkServer_Tick(bool send_frame)
 	}
 #endif
 
+	/* The frame and sync packets are the same for all clients, so they are only built once. */
+	std::shared_ptr<const Packet> frame_packet;
+	std::shared_ptr<const Packet> sync_packet;
+
 	/* Now we are done with the frame, inform the clients that they can
 	 *  do their frame! */
 	for (NetworkClientSocket *cs : NetworkClientSocket::Iterate()) {
@@ -1980,11 +2130,11 @@ void NetworkServer_Tick(bool send_frame)
 			NetworkHandleCommandQueue(cs);
 
 			/* Send an updated _frame_counter_max to the client */
-			if (send_frame) cs->SendFrame();
+			if (send_frame) cs->SendFrame(&frame_packet);
 
 #ifndef ENABLE_NETWORK_SYNC_EVERY_FRAME
 			/* Send a sync-check packet */
-			if (send_sync) cs->SendSync();
+			if (send_sync) cs->SendSync(&sync_packet);
 #endif
 		}
 	}
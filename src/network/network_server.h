@@ -81,9 +81,19 @@ public:
 	bool settings_authed = false;///< Authorised to control all game settings
 	bool supports_zstd = false;  ///< Client supports zstd compression
 
-	struct PacketWriter *savegame; ///< Writer used to write the savegame.
+	struct PacketWriter *savegame; ///< Writer used to write the savegame, possibly shared with other clients.
+	size_t savegame_next_packet = 0; ///< Index of the next packet of the savegame writer to send to this client.
+	bool savegame_size_sent = false; ///< Whether the map size packet of the savegame writer has been sent to this client.
 	NetworkAddress client_address; ///< IP-address of the client (so they can be banned)
 
+	std::chrono::steady_clock::time_point connect_time;       ///< Time the connection was accepted.
+	uint64 packets_received = 0;                              ///< Number of packets received from the client.
+	uint64 bytes_received = 0;                                ///< Number of bytes received from the client.
+	uint64 commands_received = 0;                             ///< Number of commands accepted from the client.
+	uint64 map_bytes_sent = 0;                                ///< Number of bytes of the map queued for sending to the client.
+	std::chrono::steady_clock::time_point map_transfer_start; ///< Time the map transfer to the client started.
+	std::chrono::steady_clock::time_point map_transfer_end;   ///< Time the client reported it had received the map.
+
 	std::string desync_log;
 
 	ServerNetworkGameSocketHandler(SOCKET s);
@@ -110,9 +120,11 @@ public:
 	NetworkRecvStatus SendChat(NetworkAction action, ClientID client_id, bool self_send, const std::string &msg, NetworkTextMessageData data);
 	NetworkRecvStatus SendExternalChat(const std::string &source, TextColour colour, const std::string &user, const std::string &msg);
 	NetworkRecvStatus SendJoin(ClientID client_id);
-	NetworkRecvStatus SendFrame();
-	NetworkRecvStatus SendSync();
+	NetworkRecvStatus SendFrame(std::shared_ptr<const Packet> *broadcast = nullptr);
+	NetworkRecvStatus SendSync(std::shared_ptr<const Packet> *broadcast = nullptr);
 	NetworkRecvStatus SendCommand(const CommandPacket *cp);
+	std::unique_ptr<Packet> CreateCommandPacket(const CommandPacket *cp);
+	static std::vector<std::shared_ptr<const Packet>> CreateCommandBatchPackets(const std::vector<std::unique_ptr<CommandPacket>> &batch);
 	NetworkRecvStatus SendCompanyUpdate();
 	NetworkRecvStatus SendConfigUpdate();
 	NetworkRecvStatus SendSettingsAccessUpdate(bool ok);
@@ -53,6 +53,7 @@
 #include "road.h"
 #include "newgrf_roadstop.h"
 #include "debug_settings.h"
+#include "newgrf_profiling.h"
 
 #include "table/strings.h"
 #include "table/build_industry.h"
@@ -7150,6 +7151,8 @@ static void SkipAct5(ByteReader *buf)
  */
 bool GetGlobalVariable(byte param, uint32 *value, const GRFFile *grffile)
 {
+	_sprite_group_resolve_check_veh_callback = nullptr;
+
 	if (_sprite_group_resolve_check_veh_check) {
 		switch (param) {
 			case 0x00:
@@ -10094,6 +10097,7 @@ static void ResetNewGRF()
 
 	_grf_files.clear();
 	_cur.grffile   = nullptr;
+	NewGRFSampleProfiler::Reset();
 	_new_signals_grfs.clear();
 	MemSetT<NewSignalStyle>(_new_signal_styles.data(), 0, MAX_NEW_SIGNAL_STYLES);
 	_num_new_signal_styles = 0;
@@ -11414,6 +11418,9 @@ void LoadNewGRF(uint load_index, uint num_baseset)
 			}
 		}
 
+		/* All files are opened in the label scan stage, parse their sprite sections ahead of the init and activation stages. */
+		if (stage == GLS_INIT) PrescanGRFSpriteOffsets();
+
 		uint num_grfs = 0;
 		uint num_non_static = 0;
 
@@ -11460,6 +11467,12 @@ void LoadNewGRF(uint load_index, uint num_baseset)
 		}
 	}
 
+	/* Sprite groups are not modified by further GRF loading, merge identical groups */
+	DeduplicateSpriteGroups();
+
+	/* The VarAction2 adjusts are final now */
+	BindDeterministicSpriteGroupAdjustEvalProcs();
+
 	/* Pseudo sprite processing is finished; free temporary stuff */
 	_cur.ClearDataForNextFile();
 	_callback_result_cache.clear();
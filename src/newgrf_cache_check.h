@@ -10,7 +10,10 @@
 #ifndef NEWGRF_CACHE_CHECK_H
 #define NEWGRF_CACHE_CHECK_H
 
+struct Vehicle;
+
 extern bool _sprite_group_resolve_check_veh_check;
 extern bool _sprite_group_resolve_check_veh_curvature_check;
+extern const Vehicle *_sprite_group_resolve_check_veh_callback;
 
 #endif /* NEWGRF_CACHE_CHECK_H */
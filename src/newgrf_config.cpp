@@ -26,6 +26,9 @@
 
 #include "fileio_func.h"
 #include "fios.h"
+#include "3rdparty/cpp-btree/btree_set.h"
+#include <map>
+#include <sys/stat.h>
 
 #include "thread.h"
 #include <mutex>
@@ -453,9 +456,10 @@ static bool CalcGRFMD5Sum(GRFConfig *config, Subdirectory subdir)
  * @param config    grf to fill.
  * @param is_static grf is static.
  * @param subdir    the subdirectory to search in.
+ * @param known_md5sum The md5sum of the grf if it is already known, to skip calculating it; or nullptr.
  * @return Operation was successfully completed.
  */
-bool FillGRFDetails(GRFConfig *config, bool is_static, Subdirectory subdir)
+bool FillGRFDetails(GRFConfig *config, bool is_static, Subdirectory subdir, const uint8 *known_md5sum)
 {
 	if (!FioCheckFileExists(config->filename, subdir)) {
 		config->status = GCS_NOT_FOUND;
@@ -478,6 +482,11 @@ bool FillGRFDetails(GRFConfig *config, bool is_static, Subdirectory subdir)
 		if (HasBit(config->flags, GCF_UNSAFE)) return false;
 	}
 
+	if (known_md5sum != nullptr) {
+		memcpy(config->ident.md5sum, known_md5sum, sizeof(config->ident.md5sum));
+		return true;
+	}
+
 	return CalcGRFMD5Sum(config, subdir);
 }
 
@@ -670,10 +679,194 @@ compatible_grf:
 int _skip_all_newgrf_scanning = 0;
 
 /** Helper for scanning for files with GRF as extension */
+std::string _grf_md5_cache_file; ///< File storing the md5sums of the scanned NewGRFs.
+
+/**
+ * Persistent cache of the md5sums of the scanned NewGRFs, so unchanged NewGRFs do not need to be read entirely at each scan.
+ * The entries are identified by the path of the NewGRF, or of the tar and the NewGRF within it, and the size and modification time of that file.
+ */
+class GRFMD5Cache {
+	/** Cached md5sum of a file. */
+	struct Entry {
+		uint64 size;     ///< Size of the file.
+		int64 mtime;     ///< Modification time of the file.
+		uint8 md5sum[16]; ///< MD5 sum of the NewGRF.
+	};
+
+	std::map<std::string, Entry> entries; ///< Cached md5sums, by path.
+	bool dirty = false;                   ///< Whether the entries differ from the file.
+
+	static const char *HEADER; ///< First line of the cache file.
+
+public:
+	/** Key identifying a scanned file. */
+	struct Key {
+		std::string path; ///< Path of the file, or the tar and the file within it.
+		uint64 size = 0;  ///< Size of the file, or the tar.
+		int64 mtime = 0;  ///< Modification time of the file, or the tar.
+		bool valid = false; ///< Whether the file could be examined.
+	};
+
+	static Key GetKey(const std::string &filename, const std::string &tar_filename);
+
+	void Load();
+	void Save();
+	const uint8 *Find(const Key &key) const;
+	void Set(const Key &key, const uint8 *md5sum);
+	void RemoveUnused(const btree::btree_set<std::string> &used);
+};
+
+/* static */ const char *GRFMD5Cache::HEADER = "OpenTTD NewGRF md5sum cache 1";
+
+/**
+ * Get the key of a file which is being scanned.
+ * @param filename The name of the file, within the tar if \a tar_filename is not empty.
+ * @param tar_filename The tar containing the file, or empty.
+ * @return The key, which is not valid if the file could not be examined.
+ */
+/* static */ GRFMD5Cache::Key GRFMD5Cache::GetKey(const std::string &filename, const std::string &tar_filename)
+{
+	Key key;
+	const std::string &disk_file = tar_filename.empty() ? filename : tar_filename;
+#if defined(_WIN32)
+	struct _stat64 sb;
+	if (_wstat64(OTTD2FS(disk_file).c_str(), &sb) != 0) return key;
+#else
+	struct stat sb;
+	if (stat(OTTD2FS(disk_file).c_str(), &sb) != 0) return key;
+#endif
+	key.path = tar_filename.empty() ? filename : tar_filename + PATHSEP + filename;
+	key.size = sb.st_size;
+	key.mtime = sb.st_mtime;
+	key.valid = true;
+	return key;
+}
+
+/** Load the cache file. */
+void GRFMD5Cache::Load()
+{
+	this->entries.clear();
+	this->dirty = false;
+	if (_grf_md5_cache_file.empty()) return;
+
+	FILE *f = FioFOpenFile(_grf_md5_cache_file, "rb", NO_DIRECTORY);
+	if (f == nullptr) return;
+
+	char line[4096];
+	if (fgets(line, sizeof(line), f) != nullptr && strncmp(line, HEADER, strlen(HEADER)) == 0) {
+		while (fgets(line, sizeof(line), f) != nullptr) {
+			/* Format: md5sum size mtime path */
+			char md5[33];
+			unsigned long long size;
+			long long mtime;
+			int path_offset;
+			if (sscanf(line, "%32s %llu %lld %n", md5, &size, &mtime, &path_offset) != 3 || strlen(md5) != 32) continue;
+
+			std::string path = line + path_offset;
+			while (!path.empty() && (path.back() == '\n' || path.back() == '\r')) path.pop_back();
+			if (path.empty()) continue;
+
+			Entry entry;
+			entry.size = size;
+			entry.mtime = mtime;
+			bool ok = true;
+			for (uint i = 0; i < 16; i++) {
+				uint v;
+				if (sscanf(md5 + i * 2, "%2x", &v) != 1) {
+					ok = false;
+					break;
+				}
+				entry.md5sum[i] = (uint8)v;
+			}
+			if (ok) this->entries[path] = entry;
+		}
+	}
+	FioFCloseFile(f);
+}
+
+/** Save the cache file, if it changed. */
+void GRFMD5Cache::Save()
+{
+	if (!this->dirty || _grf_md5_cache_file.empty()) return;
+
+	const std::string tmp_file = _grf_md5_cache_file + ".new";
+	FILE *f = FioFOpenFile(tmp_file, "wb", NO_DIRECTORY);
+	if (f == nullptr) return;
+
+	fprintf(f, "%s\n", HEADER);
+	for (const auto &it : this->entries) {
+		char md5[33];
+		md5sumToString(md5, lastof(md5), it.second.md5sum);
+		fprintf(f, "%s " OTTD_PRINTF64U " " OTTD_PRINTF64 " %s\n", md5, it.second.size, it.second.mtime, it.first.c_str());
+	}
+	bool ok = ferror(f) == 0;
+	FioFCloseFile(f);
+
+#if defined(_WIN32)
+	_wunlink(OTTD2FS(_grf_md5_cache_file).c_str());
+	if (ok && _wrename(OTTD2FS(tmp_file).c_str(), OTTD2FS(_grf_md5_cache_file).c_str()) != 0) ok = false;
+#else
+	if (ok && rename(OTTD2FS(tmp_file).c_str(), OTTD2FS(_grf_md5_cache_file).c_str()) != 0) ok = false;
+#endif
+	if (!ok) {
+		DEBUG(grf, 1, "Saving the NewGRF md5sum cache %s failed", _grf_md5_cache_file.c_str());
+		return;
+	}
+	this->dirty = false;
+}
+
+/**
+ * Find the cached md5sum of a file.
+ * @param key The key of the file.
+ * @return The md5sum, or nullptr if it is not known or the file changed.
+ */
+const uint8 *GRFMD5Cache::Find(const Key &key) const
+{
+	if (!key.valid) return nullptr;
+	auto it = this->entries.find(key.path);
+	if (it == this->entries.end() || it->second.size != key.size || it->second.mtime != key.mtime) return nullptr;
+	return it->second.md5sum;
+}
+
+/**
+ * Store the md5sum of a file.
+ * @param key The key of the file.
+ * @param md5sum The md5sum.
+ */
+void GRFMD5Cache::Set(const Key &key, const uint8 *md5sum)
+{
+	if (!key.valid) return;
+	Entry &entry = this->entries[key.path];
+	if (entry.size == key.size && entry.mtime == key.mtime && memcmp(entry.md5sum, md5sum, sizeof(entry.md5sum)) == 0) return;
+	entry.size = key.size;
+	entry.mtime = key.mtime;
+	memcpy(entry.md5sum, md5sum, sizeof(entry.md5sum));
+	this->dirty = true;
+}
+
+/**
+ * Remove the entries of the files which no longer exist.
+ * @param used The paths of all scanned files.
+ */
+void GRFMD5Cache::RemoveUnused(const btree::btree_set<std::string> &used)
+{
+	for (auto it = this->entries.begin(); it != this->entries.end();) {
+		if (used.count(it->first) == 0) {
+			it = this->entries.erase(it);
+			this->dirty = true;
+		} else {
+			++it;
+		}
+	}
+}
+
 class GRFFileScanner : FileScanner {
 	std::chrono::steady_clock::time_point next_update; ///< The next moment we do update the screen.
 	uint num_scanned; ///< The number of GRFs we have scanned.
 	std::vector<GRFConfig *> grfs;
+	std::vector<GRFMD5Cache::Key> grf_keys; ///< Cache keys of #grfs.
+	btree::btree_set<std::string> scanned_paths; ///< Cache paths of all scanned files.
+	GRFMD5Cache md5_cache;
 
 public:
 	GRFFileScanner() : num_scanned(0)
@@ -694,9 +887,19 @@ public:
 		CalcGRFMD5ThreadingStart();
 		GRFFileScanner fs;
 		fs.grfs.clear();
+		fs.md5_cache.Load();
 		int ret = fs.Scan(".grf", NEWGRF_DIR);
 		CalcGRFMD5ThreadingEnd();
 
+		/* All md5sums are known now; remember them for the next scan. */
+		if (!_exit_game) {
+			for (size_t i = 0; i < fs.grfs.size(); i++) {
+				fs.md5_cache.Set(fs.grf_keys[i], fs.grfs[i]->ident.md5sum);
+			}
+			fs.md5_cache.RemoveUnused(fs.scanned_paths);
+			fs.md5_cache.Save();
+		}
+
 		for (GRFConfig *c : fs.grfs) {
 			bool added = true;
 			if (_all_grfs == nullptr) {
@@ -741,9 +944,13 @@ bool GRFFileScanner::AddFile(const std::string &filename, size_t basepath_length
 
 	GRFConfig *c = new GRFConfig(filename.c_str() + basepath_length);
 
-	bool added = FillGRFDetails(c, false);
+	GRFMD5Cache::Key key = GRFMD5Cache::GetKey(filename, tar_filename);
+	if (key.valid) this->scanned_paths.insert(key.path);
+
+	bool added = FillGRFDetails(c, false, NEWGRF_DIR, this->md5_cache.Find(key));
 	if (added) {
 		this->grfs.push_back(c);
+		this->grf_keys.push_back(std::move(key));
 	}
 
 	this->num_scanned++;
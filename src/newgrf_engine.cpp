@@ -27,11 +27,14 @@
 #include "scope_info.h"
 #include "newgrf_extension.h"
 #include "newgrf_analysis.h"
+#include "debug_settings.h"
+#include "newgrf_profiling.h"
 
 #include "safeguards.h"
 
 bool _sprite_group_resolve_check_veh_check = false;
 bool _sprite_group_resolve_check_veh_curvature_check = false;
+const Vehicle *_sprite_group_resolve_check_veh_callback = nullptr;
 
 void SetWagonOverrideSprites(EngineID engine, CargoID cargo, const SpriteGroup *group, EngineID *train_id, uint trains)
 {
@@ -312,11 +315,13 @@ static byte MapAircraftMovementAction(const Aircraft *v)
 
 /* virtual */ uint32 VehicleScopeResolver::GetRandomBits() const
 {
+	_sprite_group_resolve_check_veh_callback = nullptr;
 	return this->v == nullptr ? 0 : this->v->random_bits;
 }
 
 /* virtual */ uint32 VehicleScopeResolver::GetTriggers() const
 {
+	_sprite_group_resolve_check_veh_callback = nullptr;
 	if (this->v == nullptr) {
 		return 0;
 	} else {
@@ -428,6 +433,30 @@ static uint32 PositionHelper(const Vehicle *v, bool consecutive)
 
 static uint32 VehicleGetVariable(Vehicle *v, const VehicleScopeResolver *object, uint16 variable, uint32 parameter, GetVariableExtra *extra)
 {
+	if (_sprite_group_resolve_check_veh_callback != nullptr) {
+		/* Only variables of the vehicle itself, which do not change without the NewGRF cache being invalidated, are usable for callback result caching */
+		if (v != _sprite_group_resolve_check_veh_callback) {
+			_sprite_group_resolve_check_veh_callback = nullptr;
+		} else {
+			switch (variable) {
+				case 0x25:
+				case 0x40:
+				case 0x41:
+				case 0x42:
+				case 0x43:
+				case 0x47:
+				case 0x4D:
+				case 0x60:
+				case 0x80 + 0x72:
+					break;
+
+				default:
+					_sprite_group_resolve_check_veh_callback = nullptr;
+					break;
+			}
+		}
+	}
+
 	if (_sprite_group_resolve_check_veh_check) {
 		switch (variable) {
 			case 0xC:
@@ -1155,6 +1184,8 @@ static uint32 VehicleGetVariable(Vehicle *v, const VehicleScopeResolver *object,
 		return nullptr;
 	}
 
+	_sprite_group_resolve_check_veh_callback = nullptr;
+
 	bool in_motion = !v->First()->current_order.IsType(OT_LOADING);
 
 	uint totalsets = in_motion ? (uint)group->loaded.size() : (uint)group->loading.size();
@@ -1306,6 +1337,93 @@ bool UsesWagonOverride(const Vehicle *v)
 	return Train::From(v)->tcache.cached_override != nullptr;
 }
 
+/**
+ * Check whether the result of a vehicle callback may be stored in the callback cache of the vehicle.
+ * Callbacks where the caller reads the temporary registers after the callback are not usable.
+ * @param callback The callback
+ * @return true if the callback result may be cached
+ */
+static bool IsVehicleCallbackCacheable(CallbackID callback)
+{
+	switch (callback) {
+		case CBID_VEHICLE_MODIFY_PROPERTY:
+		case CBID_VEHICLE_VISUAL_EFFECT:
+		case CBID_VEHICLE_LOAD_AMOUNT:
+		case CBID_VEHICLE_LENGTH:
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+/**
+ * Look up a previously cached vehicle callback result.
+ * @param callback The callback
+ * @param param1   First parameter of the callback
+ * @param param2   Second parameter of the callback
+ * @param engine   Engine type of the vehicle to evaluate the callback for
+ * @param v        The vehicle to evaluate the callback for, not nullptr
+ * @param[out] result The cached callback result, if found
+ * @return true if a cached result was found
+ */
+static bool LookupVehicleCallbackCache(CallbackID callback, uint32 param1, uint32 param2, EngineID engine, const Vehicle *v, uint16 &result)
+{
+	if (_sprite_group_resolve_check_veh_callback != nullptr && _sprite_group_resolve_check_veh_callback != v) {
+		/* A callback of another vehicle is being resolved, which now depends on this vehicle */
+		_sprite_group_resolve_check_veh_callback = nullptr;
+	}
+
+	const VehicleCallbackCache &cache = v->callback_cache;
+	for (uint i = 0; i < cache.count; i++) {
+		const VehicleCallbackCacheEntry &entry = cache.entries[i];
+		if (entry.callback == callback && entry.param1 == param1 && entry.param2 == param2 && entry.engine == engine &&
+				entry.cargo_type == v->cargo_type && entry.cargo_subtype == v->cargo_subtype) {
+			if (NewGRFSampleProfiler::ShouldSample()) {
+				VehicleResolverObject object(engine, v, VehicleResolverObject::WO_UNCACHED, false, callback, param1, param2);
+				NewGRFSampleProfiler::SampleCacheHit(object);
+			}
+			result = entry.result;
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Resolve a vehicle callback, and store the result in the callback cache of the vehicle if the resolution only used cacheable variables.
+ * @param object The resolver object for the callback
+ * @param engine Engine type of the vehicle to evaluate the callback for
+ * @param v      The vehicle to evaluate the callback for, not nullptr
+ * @return The value the callback returned, or CALLBACK_FAILED if it failed
+ */
+static uint16 ResolveVehicleCallbackWithCache(VehicleResolverObject &object, EngineID engine, const Vehicle *v)
+{
+	if (_sprite_group_resolve_check_veh_callback != nullptr || HasGrfOptimiserFlag(NGOF_NO_OPT_VEH_CALLBACK_CACHE)) return object.ResolveCallback();
+
+	_sprite_group_resolve_check_veh_callback = v;
+	uint16 result = object.ResolveCallback();
+	if (_sprite_group_resolve_check_veh_callback == v) {
+		VehicleCallbackCache &cache = const_cast<Vehicle *>(v)->callback_cache;
+		VehicleCallbackCacheEntry *entry;
+		if (cache.count < VEHICLE_CALLBACK_CACHE_SIZE) {
+			entry = &cache.entries[cache.count++];
+		} else {
+			entry = &cache.entries[cache.next];
+			cache.next = (cache.next + 1) % VEHICLE_CALLBACK_CACHE_SIZE;
+		}
+		entry->param1 = object.callback_param1;
+		entry->param2 = object.callback_param2;
+		entry->engine = engine;
+		entry->callback = object.callback;
+		entry->result = result;
+		entry->cargo_type = v->cargo_type;
+		entry->cargo_subtype = v->cargo_subtype;
+	}
+	_sprite_group_resolve_check_veh_callback = nullptr;
+	return result;
+}
+
 /**
  * Evaluate a newgrf callback for vehicles
  * @param callback The callback to evaluate
@@ -1317,7 +1435,14 @@ bool UsesWagonOverride(const Vehicle *v)
  */
 uint16 GetVehicleCallback(CallbackID callback, uint32 param1, uint32 param2, EngineID engine, const Vehicle *v)
 {
+	const bool cacheable = v != nullptr && IsVehicleCallbackCacheable(callback);
+	if (cacheable) {
+		uint16 result;
+		if (LookupVehicleCallbackCache(callback, param1, param2, engine, v, result)) return result;
+	}
+
 	VehicleResolverObject object(engine, v, VehicleResolverObject::WO_UNCACHED, false, callback, param1, param2);
+	if (cacheable) return ResolveVehicleCallbackWithCache(object, engine, v);
 	return object.ResolveCallback();
 }
 
@@ -1351,14 +1476,17 @@ int GetEngineProperty(EngineID engine, PropertyID property, int orig_value, cons
 	const Engine *e = Engine::Get(engine);
 	if (static_cast<uint>(property) < 64 && !HasBit(e->cb36_properties_used, property)) return orig_value;
 
-	VehicleResolverObject object(engine, v, VehicleResolverObject::WO_UNCACHED, false, CBID_VEHICLE_MODIFY_PROPERTY, property, 0);
-	if (static_cast<uint>(property) < 64 && !e->sprite_group_cb36_properties_used.empty()) {
-		auto iter = e->sprite_group_cb36_properties_used.find(object.root_spritegroup);
-		if (iter != e->sprite_group_cb36_properties_used.end()) {
-			if (!HasBit(iter->second, property)) return orig_value;
+	uint16 callback;
+	if (v == nullptr || !LookupVehicleCallbackCache(CBID_VEHICLE_MODIFY_PROPERTY, property, 0, engine, v, callback)) {
+		VehicleResolverObject object(engine, v, VehicleResolverObject::WO_UNCACHED, false, CBID_VEHICLE_MODIFY_PROPERTY, property, 0);
+		if (static_cast<uint>(property) < 64 && !e->sprite_group_cb36_properties_used.empty()) {
+			auto iter = e->sprite_group_cb36_properties_used.find(object.root_spritegroup);
+			if (iter != e->sprite_group_cb36_properties_used.end()) {
+				if (!HasBit(iter->second, property)) return orig_value;
+			}
 		}
+		callback = (v != nullptr) ? ResolveVehicleCallbackWithCache(object, engine, v) : object.ResolveCallback();
 	}
-	uint16 callback = object.ResolveCallback();
 	if (callback != CALLBACK_FAILED) {
 		if (is_signed) {
 			/* Sign extend 15 bit integer */
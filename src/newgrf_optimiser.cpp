@@ -16,6 +16,7 @@
 #include "scope.h"
 
 #include <tuple>
+#include <unordered_map>
 
 #include "safeguards.h"
 
@@ -3024,3 +3025,231 @@ const SpriteGroup *PruneTargetSpriteGroup(const SpriteGroup *result)
 	}
 	return result;
 }
+
+/** State of the sprite group deduplication pass */
+struct SpriteGroupDeduplicationState {
+	btree::btree_map<const SpriteGroup *, const SpriteGroup *> canonical;             ///< Canonical group of each visited group
+	std::unordered_map<uint64, std::vector<const SpriteGroup *>> buckets;             ///< Canonical groups by hash
+	uint merged = 0;                                                                   ///< Number of groups merged into an identical canonical group
+	uint redirected = 0;                                                               ///< Number of references redirected to a canonical group
+	size_t merged_bytes = 0;                                                           ///< Approximate size of the merged groups
+
+	const SpriteGroup *Canonicalise(const SpriteGroup *group);
+	void RedirectChild(const SpriteGroup *&child);
+};
+
+static inline void MixSpriteGroupHash(uint64 &hash, uint64 value)
+{
+	hash ^= value + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+}
+
+static uint64 HashSpriteGroup(const SpriteGroup *group)
+{
+	uint64 hash = 0;
+	MixSpriteGroupHash(hash, group->type);
+	MixSpriteGroupHash(hash, group->feature);
+	MixSpriteGroupHash(hash, group->sg_flags);
+	switch (group->type) {
+		case SGT_DETERMINISTIC: {
+			const DeterministicSpriteGroup *dsg = static_cast<const DeterministicSpriteGroup *>(group);
+			MixSpriteGroupHash(hash, dsg->var_scope | (dsg->size << 8) | (dsg->calculated_result << 16) | (dsg->dsg_flags << 24));
+			for (const DeterministicSpriteGroupAdjust &adjust : dsg->adjusts) {
+				MixSpriteGroupHash(hash, adjust.operation | (adjust.type << 8) | (adjust.variable << 16) | ((uint64)adjust.shift_num << 32) | ((uint64)adjust.adjust_flags << 40));
+				MixSpriteGroupHash(hash, adjust.parameter | ((uint64)adjust.and_mask << 32));
+				MixSpriteGroupHash(hash, adjust.add_val | ((uint64)adjust.divmod_val << 32));
+				MixSpriteGroupHash(hash, adjust.variable == 0x7E ? (uint64)(size_t)adjust.subroutine : adjust.jump);
+			}
+			for (const DeterministicSpriteGroupRange &range : dsg->ranges) {
+				MixSpriteGroupHash(hash, (uint64)(size_t)range.group);
+				MixSpriteGroupHash(hash, range.low | ((uint64)range.high << 32));
+			}
+			MixSpriteGroupHash(hash, (uint64)(size_t)dsg->default_group);
+			MixSpriteGroupHash(hash, (uint64)(size_t)dsg->error_group);
+			break;
+		}
+
+		case SGT_RANDOMIZED: {
+			const RandomizedSpriteGroup *rsg = static_cast<const RandomizedSpriteGroup *>(group);
+			MixSpriteGroupHash(hash, rsg->var_scope | (rsg->cmp_mode << 8) | (rsg->triggers << 16) | (rsg->count << 24) | ((uint64)rsg->lowest_randbit << 32));
+			for (const SpriteGroup *sg : rsg->groups) {
+				MixSpriteGroupHash(hash, (uint64)(size_t)sg);
+			}
+			break;
+		}
+
+		case SGT_RESULT: {
+			const ResultSpriteGroup *rsg = static_cast<const ResultSpriteGroup *>(group);
+			MixSpriteGroupHash(hash, rsg->sprite | ((uint64)rsg->num_sprites << 32));
+			break;
+		}
+
+		default:
+			NOT_REACHED();
+	}
+	return hash;
+}
+
+/**
+ * Check whether two sprite groups resolve identically.
+ * Child groups are compared by identity, so these must already have been canonicalised.
+ * The NFO line is not compared as it is only used for debugging.
+ */
+static bool AreSpriteGroupsEqual(const SpriteGroup *a, const SpriteGroup *b)
+{
+	if (a->type != b->type || a->feature != b->feature || a->sg_flags != b->sg_flags) return false;
+	switch (a->type) {
+		case SGT_DETERMINISTIC: {
+			const DeterministicSpriteGroup *da = static_cast<const DeterministicSpriteGroup *>(a);
+			const DeterministicSpriteGroup *db = static_cast<const DeterministicSpriteGroup *>(b);
+			if (da->var_scope != db->var_scope || da->size != db->size || da->calculated_result != db->calculated_result || da->dsg_flags != db->dsg_flags) return false;
+			if (da->default_group != db->default_group || da->error_group != db->error_group) return false;
+			if (da->adjusts.size() != db->adjusts.size() || da->ranges.size() != db->ranges.size()) return false;
+			for (size_t i = 0; i < da->adjusts.size(); i++) {
+				const DeterministicSpriteGroupAdjust &aa = da->adjusts[i];
+				const DeterministicSpriteGroupAdjust &ab = db->adjusts[i];
+				if (aa.operation != ab.operation || aa.type != ab.type || aa.variable != ab.variable || aa.shift_num != ab.shift_num ||
+						aa.adjust_flags != ab.adjust_flags || aa.parameter != ab.parameter || aa.and_mask != ab.and_mask ||
+						aa.add_val != ab.add_val || aa.divmod_val != ab.divmod_val) {
+					return false;
+				}
+				if (aa.variable == 0x7E ? (aa.subroutine != ab.subroutine) : (aa.jump != ab.jump)) return false;
+			}
+			for (size_t i = 0; i < da->ranges.size(); i++) {
+				const DeterministicSpriteGroupRange &ra = da->ranges[i];
+				const DeterministicSpriteGroupRange &rb = db->ranges[i];
+				if (ra.group != rb.group || ra.low != rb.low || ra.high != rb.high) return false;
+			}
+			return true;
+		}
+
+		case SGT_RANDOMIZED: {
+			const RandomizedSpriteGroup *ra = static_cast<const RandomizedSpriteGroup *>(a);
+			const RandomizedSpriteGroup *rb = static_cast<const RandomizedSpriteGroup *>(b);
+			return ra->var_scope == rb->var_scope && ra->cmp_mode == rb->cmp_mode && ra->triggers == rb->triggers &&
+					ra->count == rb->count && ra->lowest_randbit == rb->lowest_randbit && ra->groups == rb->groups;
+		}
+
+		case SGT_RESULT: {
+			const ResultSpriteGroup *ra = static_cast<const ResultSpriteGroup *>(a);
+			const ResultSpriteGroup *rb = static_cast<const ResultSpriteGroup *>(b);
+			return ra->sprite == rb->sprite && ra->num_sprites == rb->num_sprites;
+		}
+
+		default:
+			NOT_REACHED();
+	}
+}
+
+void SpriteGroupDeduplicationState::RedirectChild(const SpriteGroup *&child)
+{
+	const SpriteGroup *target = this->Canonicalise(child);
+	if (target != child) {
+		child = target;
+		this->redirected++;
+	}
+}
+
+/**
+ * Canonicalise the child references of a sprite group, and then find or register its canonical identical group.
+ * @param group The group to canonicalise
+ * @return The canonical group identical to \p group
+ */
+const SpriteGroup *SpriteGroupDeduplicationState::Canonicalise(const SpriteGroup *group)
+{
+	if (group == nullptr) return nullptr;
+
+	auto iter = this->canonical.find(group);
+	if (iter != this->canonical.end()) return iter->second;
+
+	/* Sprite groups can only refer to previously defined groups, so there are no cycles */
+	switch (group->type) {
+		case SGT_REAL: {
+			RealSpriteGroup *real = const_cast<RealSpriteGroup *>(static_cast<const RealSpriteGroup *>(group));
+			for (const SpriteGroup *&sg : real->loaded) this->RedirectChild(sg);
+			for (const SpriteGroup *&sg : real->loading) this->RedirectChild(sg);
+			this->canonical[group] = group;
+			return group;
+		}
+
+		case SGT_DETERMINISTIC: {
+			DeterministicSpriteGroup *dsg = const_cast<DeterministicSpriteGroup *>(static_cast<const DeterministicSpriteGroup *>(group));
+			for (DeterministicSpriteGroupAdjust &adjust : dsg->adjusts) {
+				if (adjust.variable == 0x7E) this->RedirectChild(adjust.subroutine);
+			}
+			for (DeterministicSpriteGroupRange &range : dsg->ranges) this->RedirectChild(range.group);
+			this->RedirectChild(dsg->default_group);
+			this->RedirectChild(dsg->error_group);
+			break;
+		}
+
+		case SGT_RANDOMIZED: {
+			RandomizedSpriteGroup *rsg = const_cast<RandomizedSpriteGroup *>(static_cast<const RandomizedSpriteGroup *>(group));
+			for (const SpriteGroup *&sg : rsg->groups) this->RedirectChild(sg);
+			break;
+		}
+
+		case SGT_RESULT:
+			break;
+
+		default:
+			/* Callback results are already shared when loading, other group types are not merged */
+			this->canonical[group] = group;
+			return group;
+	}
+
+	std::vector<const SpriteGroup *> &bucket = this->buckets[HashSpriteGroup(group)];
+	for (const SpriteGroup *candidate : bucket) {
+		if (AreSpriteGroupsEqual(group, candidate)) {
+			this->canonical[group] = candidate;
+			this->merged++;
+			switch (group->type) {
+				case SGT_DETERMINISTIC: {
+					const DeterministicSpriteGroup *dsg = static_cast<const DeterministicSpriteGroup *>(group);
+					this->merged_bytes += sizeof(DeterministicSpriteGroup) + dsg->adjusts.capacity() * sizeof(DeterministicSpriteGroupAdjust) + dsg->ranges.capacity() * sizeof(DeterministicSpriteGroupRange);
+					break;
+				}
+				case SGT_RANDOMIZED:
+					this->merged_bytes += sizeof(RandomizedSpriteGroup) + static_cast<const RandomizedSpriteGroup *>(group)->groups.capacity() * sizeof(const SpriteGroup *);
+					break;
+				default:
+					this->merged_bytes += sizeof(ResultSpriteGroup);
+					break;
+			}
+			return candidate;
+		}
+	}
+	bucket.push_back(group);
+	this->canonical[group] = group;
+	return group;
+}
+
+/**
+ * Merge structurally identical deterministic, randomised and result sprite groups, by redirecting all references
+ * between sprite groups to one canonical group.
+ * This is done after all VarAction2 optimisation passes as these may make more groups identical.
+ * Root groups referenced by features are not changed.
+ */
+void DeduplicateSpriteGroups()
+{
+	if (HasGrfOptimiserFlag(NGOF_NO_OPT_VARACT2) || HasGrfOptimiserFlag(NGOF_NO_OPT_SPRITE_GROUP_DEDUP)) return;
+
+	SpriteGroupDeduplicationState state;
+	for (const SpriteGroup *group : SpriteGroup::Iterate()) {
+		state.Canonicalise(group);
+	}
+
+	/* The shadow copies refer to the groups as they were loaded, and so also share the canonical groups */
+	for (auto &it : _deterministic_sg_shadows) {
+		for (DeterministicSpriteGroupAdjust &adjust : it.second.adjusts) {
+			if (adjust.variable == 0x7E) state.RedirectChild(adjust.subroutine);
+		}
+		for (DeterministicSpriteGroupRange &range : it.second.ranges) state.RedirectChild(range.group);
+		state.RedirectChild(it.second.default_group);
+	}
+	for (auto &it : _randomized_sg_shadows) {
+		for (const SpriteGroup *&sg : it.second.groups) state.RedirectChild(sg);
+	}
+
+	DEBUG(grf, 1, "DeduplicateSpriteGroups: merged %u of " PRINTF_SIZE " sprite groups, redirected %u references, " PRINTF_SIZE " bytes of merged groups",
+			state.merged, SpriteGroup::GetNumItems(), state.redirected, state.merged_bytes);
+}
@@ -158,3 +158,106 @@ uint32 NewGRFProfiler::FinishAll()
 
 	return total_microseconds;
 }
+
+uint NewGRFSampleProfiler::sample_interval = 0;
+uint NewGRFSampleProfiler::countdown = 0;
+uint64 NewGRFSampleProfiler::start_tick = 0;
+uint64 NewGRFSampleProfiler::end_tick = 0;
+uint64 NewGRFSampleProfiler::total_samples = 0;
+uint64 NewGRFSampleProfiler::total_ns = 0;
+std::map<NewGRFSampleProfiler::Key, NewGRFSampleProfiler::Stats> NewGRFSampleProfiler::stats;
+
+/**
+ * Discard all collected samples and start sampling.
+ * @param interval Sample every interval-th event, must be non-zero
+ */
+void NewGRFSampleProfiler::Start(uint interval)
+{
+	assert(interval > 0);
+	Reset();
+	sample_interval = interval;
+	countdown = interval;
+}
+
+/**
+ * Stop sampling, the collected samples are kept.
+ */
+void NewGRFSampleProfiler::Stop()
+{
+	if (!IsActive()) return;
+	countdown = 0;
+	end_tick = _tick_counter;
+}
+
+/**
+ * Discard all collected samples, this must be called when the GRF files are freed.
+ */
+void NewGRFSampleProfiler::Reset()
+{
+	stats.clear();
+	start_tick = _tick_counter;
+	end_tick = _tick_counter;
+	total_samples = 0;
+	total_ns = 0;
+}
+
+/**
+ * Begin a sampled top-level sprite group resolution.
+ * @return Start time of the resolution (nanoseconds)
+ */
+uint64 NewGRFSampleProfiler::BeginSample()
+{
+	using namespace std::chrono;
+	countdown = sample_interval;
+	return (uint64)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Complete a sampled top-level sprite group resolution and record the time taken.
+ * @param object Information used to resolve the group
+ * @param start  Start time returned by BeginSample
+ */
+void NewGRFSampleProfiler::EndSample(const ResolverObject &object, uint64 start)
+{
+	using namespace std::chrono;
+	uint64 ns = (uint64)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count() - start;
+
+	Stats &s = stats[{ object.grffile, object.GetFeature(), object.callback, object.root_spritegroup }];
+	s.samples++;
+	s.total_ns += ns;
+	s.max_ns = std::max(s.max_ns, ns);
+	total_samples++;
+	total_ns += ns;
+}
+
+/**
+ * Record a sampled vehicle callback cache hit.
+ * @param object Resolver object which would have been used to resolve the callback
+ */
+void NewGRFSampleProfiler::SampleCacheHit(const ResolverObject &object)
+{
+	countdown = sample_interval;
+
+	stats[{ object.grffile, object.GetFeature(), object.callback, object.root_spritegroup }].cache_hits++;
+	total_samples++;
+}
+
+/**
+ * Get the number of ticks covered by the collected samples.
+ * @return Number of ticks
+ */
+uint64 NewGRFSampleProfiler::GetSampledTicks()
+{
+	return (IsActive() ? _tick_counter : end_tick) - start_tick;
+}
+
+/**
+ * Get the estimated total time per game tick spent resolving sprite groups, extrapolated from the samples.
+ * @return Estimated time in milliseconds per game tick
+ */
+double NewGRFSampleProfiler::GetEstimatedMillisecondsPerTick()
+{
+	uint64 ticks = GetSampledTicks();
+	if (ticks == 0) return 0;
+	return ((double)total_ns * sample_interval) / ((double)ticks * 1000000.0);
+}
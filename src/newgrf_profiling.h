@@ -19,6 +19,8 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <map>
+#include <tuple>
 
 /**
  * Callback profiler for NewGRF development
@@ -60,4 +62,67 @@ struct NewGRFProfiler {
 extern std::vector<NewGRFProfiler> _newgrf_profilers;
 extern Date _newgrf_profile_end_date;
 
+/**
+ * Statistical sampling profiler of sprite group resolution for all GRFs.
+ * Every sample_interval-th top-level resolution or vehicle callback cache hit is measured and aggregated.
+ */
+struct NewGRFSampleProfiler {
+	/** Aggregation key of samples */
+	struct Key {
+		const GRFFile *grffile;        ///< GRF being resolved
+		GrfSpecFeature feat;           ///< GRF feature being resolved for
+		CallbackID cb;                 ///< Callback ID
+		const SpriteGroup *root_group; ///< Root sprite group
+
+		bool operator<(const Key &other) const
+		{
+			return std::tie(this->grffile, this->feat, this->cb, this->root_group) < std::tie(other.grffile, other.feat, other.cb, other.root_group);
+		}
+	};
+
+	/** Aggregated samples */
+	struct Stats {
+		uint64 samples = 0;    ///< Number of sampled resolutions
+		uint64 cache_hits = 0; ///< Number of sampled vehicle callback cache hits
+		uint64 total_ns = 0;   ///< Total time taken by the sampled resolutions (nanoseconds)
+		uint64 max_ns = 0;     ///< Time taken by the slowest sampled resolution (nanoseconds)
+	};
+
+	static uint sample_interval; ///< Sampling interval of the collected samples
+	static uint countdown;       ///< Number of events until the next sample, 0 when sampling is disabled
+	static uint64 start_tick;    ///< Tick number sampling was started on
+	static uint64 end_tick;      ///< Tick number sampling was stopped on
+	static uint64 total_samples; ///< Total number of samples taken
+	static uint64 total_ns;      ///< Total time taken by all sampled resolutions (nanoseconds)
+	static std::map<Key, Stats> stats;
+
+	static void Start(uint interval);
+	static void Stop();
+	static void Reset();
+	static uint64 BeginSample();
+	static void EndSample(const ResolverObject &object, uint64 start);
+	static void SampleCacheHit(const ResolverObject &object);
+	static uint64 GetSampledTicks();
+	static double GetEstimatedMillisecondsPerTick();
+
+	/**
+	 * Check whether sampling is currently active.
+	 * @return true if sampling is active
+	 */
+	static inline bool IsActive()
+	{
+		return countdown != 0;
+	}
+
+	/**
+	 * Check whether the next event should be sampled.
+	 * This is the only cost when sampling is disabled.
+	 * @return true if the next event should be sampled
+	 */
+	static inline bool ShouldSample()
+	{
+		return countdown != 0 && --countdown == 0;
+	}
+};
+
 #endif /* NEWGRF_PROFILING_H */
@@ -49,7 +49,15 @@ bool _grfs_loaded_with_sg_shadow_enable = false;
 	auto profiler = std::find_if(_newgrf_profilers.begin(), _newgrf_profilers.end(), [&](const NewGRFProfiler &pr) { return pr.grffile == grf; });
 
 	if (profiler == _newgrf_profilers.end() || !profiler->active) {
-		if (top_level) _temp_store.ClearChanges();
+		if (top_level) {
+			_temp_store.ClearChanges();
+			if (NewGRFSampleProfiler::ShouldSample()) {
+				uint64 start = NewGRFSampleProfiler::BeginSample();
+				const SpriteGroup *result = group->Resolve(object);
+				NewGRFSampleProfiler::EndSample(object, start);
+				return result;
+			}
+		}
 		return group->Resolve(object);
 	} else if (top_level) {
 		profiler->BeginResolve(object);
@@ -153,8 +161,9 @@ static inline uint32 GetVariable(const ResolverObject &object, ScopeResolver *sc
 }
 
 /* Evaluate an adjustment for a variable of the given size.
- * U is the unsigned type and S is the signed type to use. */
-template <typename U, typename S>
+ * U is the unsigned type and S is the signed type to use.
+ * OP is the operation of the adjust if it is fixed at compile time, or -1 to use the operation of the adjust. */
+template <typename U, typename S, int OP = -1>
 static U EvalAdjustT(const DeterministicSpriteGroupAdjust &adjust, ScopeResolver *scope, U last_value, uint32 value, const DeterministicSpriteGroupAdjust **adjust_iter = nullptr)
 {
 	value >>= adjust.shift_num;
@@ -179,7 +188,8 @@ static U EvalAdjustT(const DeterministicSpriteGroupAdjust &adjust, ScopeResolver
 		}
 	};
 
-	switch (adjust.operation) {
+	const DeterministicSpriteGroupAdjustOperation operation = (OP >= 0) ? (DeterministicSpriteGroupAdjustOperation)OP : adjust.operation;
+	switch (operation) {
 		case DSGA_OP_ADD:  return last_value + value;
 		case DSGA_OP_SUB:  return last_value - value;
 		case DSGA_OP_SMIN: return std::min<S>(last_value, value);
@@ -231,6 +241,83 @@ uint32 EvaluateDeterministicSpriteGroupAdjust(DeterministicSpriteGroupSize size,
 	}
 }
 
+template <typename U, typename S, DeterministicSpriteGroupAdjustOperation OP>
+static uint32 EvalAdjustOpT(const DeterministicSpriteGroupAdjust &adjust, ScopeResolver *scope, uint32 last_value, uint32 value, const DeterministicSpriteGroupAdjust **adjust_iter)
+{
+	return EvalAdjustT<U, S, OP>(adjust, scope, last_value, value, adjust_iter);
+}
+
+template <typename U, typename S>
+static DeterministicSpriteGroupAdjustEvalProc *GetEvalAdjustProcT(DeterministicSpriteGroupAdjustOperation operation)
+{
+	switch (operation) {
+#define DSGA_EVAL_PROC(op) case op: return &EvalAdjustOpT<U, S, op>;
+		DSGA_EVAL_PROC(DSGA_OP_ADD)
+		DSGA_EVAL_PROC(DSGA_OP_SUB)
+		DSGA_EVAL_PROC(DSGA_OP_SMIN)
+		DSGA_EVAL_PROC(DSGA_OP_SMAX)
+		DSGA_EVAL_PROC(DSGA_OP_UMIN)
+		DSGA_EVAL_PROC(DSGA_OP_UMAX)
+		DSGA_EVAL_PROC(DSGA_OP_SDIV)
+		DSGA_EVAL_PROC(DSGA_OP_SMOD)
+		DSGA_EVAL_PROC(DSGA_OP_UDIV)
+		DSGA_EVAL_PROC(DSGA_OP_UMOD)
+		DSGA_EVAL_PROC(DSGA_OP_MUL)
+		DSGA_EVAL_PROC(DSGA_OP_AND)
+		DSGA_EVAL_PROC(DSGA_OP_OR)
+		DSGA_EVAL_PROC(DSGA_OP_XOR)
+		DSGA_EVAL_PROC(DSGA_OP_STO)
+		DSGA_EVAL_PROC(DSGA_OP_RST)
+		DSGA_EVAL_PROC(DSGA_OP_STOP)
+		DSGA_EVAL_PROC(DSGA_OP_ROR)
+		DSGA_EVAL_PROC(DSGA_OP_SCMP)
+		DSGA_EVAL_PROC(DSGA_OP_UCMP)
+		DSGA_EVAL_PROC(DSGA_OP_SHL)
+		DSGA_EVAL_PROC(DSGA_OP_SHR)
+		DSGA_EVAL_PROC(DSGA_OP_SAR)
+		DSGA_EVAL_PROC(DSGA_OP_TERNARY)
+		DSGA_EVAL_PROC(DSGA_OP_EQ)
+		DSGA_EVAL_PROC(DSGA_OP_SLT)
+		DSGA_EVAL_PROC(DSGA_OP_SGE)
+		DSGA_EVAL_PROC(DSGA_OP_SLE)
+		DSGA_EVAL_PROC(DSGA_OP_SGT)
+		DSGA_EVAL_PROC(DSGA_OP_RSUB)
+		DSGA_EVAL_PROC(DSGA_OP_STO_NC)
+		DSGA_EVAL_PROC(DSGA_OP_ABS)
+		DSGA_EVAL_PROC(DSGA_OP_JZ)
+		DSGA_EVAL_PROC(DSGA_OP_JNZ)
+		DSGA_EVAL_PROC(DSGA_OP_JZ_LV)
+		DSGA_EVAL_PROC(DSGA_OP_JNZ_LV)
+		DSGA_EVAL_PROC(DSGA_OP_NOOP)
+#undef DSGA_EVAL_PROC
+		default: return nullptr;
+	}
+}
+
+/**
+ * Bind the evaluation functions specialised for the size of the group and the operation of the adjust, to the adjusts of all deterministic sprite groups.
+ * This replaces the size and operation dispatch of each adjust in DeterministicSpriteGroup::Resolve by a single indirect call.
+ * This must be called once the adjusts are final, after all NewGRF loading stages and VarAction2 optimisation passes.
+ */
+void BindDeterministicSpriteGroupAdjustEvalProcs()
+{
+	if (HasGrfOptimiserFlag(NGOF_NO_OPT_VARACT2) || HasGrfOptimiserFlag(NGOF_NO_OPT_VARACT2_EVAL_PROCS)) return;
+
+	for (SpriteGroup *sg : SpriteGroup::Iterate()) {
+		if (sg->type != SGT_DETERMINISTIC) continue;
+
+		DeterministicSpriteGroup *group = static_cast<DeterministicSpriteGroup *>(sg);
+		for (DeterministicSpriteGroupAdjust &adjust : group->adjusts) {
+			switch (group->size) {
+				case DSG_SIZE_BYTE:  adjust.eval_proc = GetEvalAdjustProcT<uint8,  int8> (adjust.operation); break;
+				case DSG_SIZE_WORD:  adjust.eval_proc = GetEvalAdjustProcT<uint16, int16>(adjust.operation); break;
+				case DSG_SIZE_DWORD: adjust.eval_proc = GetEvalAdjustProcT<uint32, int32>(adjust.operation); break;
+				default: NOT_REACHED();
+			}
+		}
+	}
+}
+
 static bool RangeHighComparator(const DeterministicSpriteGroupRange& range, uint32 value)
 {
 	return range.high < value;
@@ -274,11 +361,15 @@ const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject &object) con
 			return SpriteGroup::Resolve(this->error_group, object, false);
 		}
 
-		switch (this->size) {
-			case DSG_SIZE_BYTE:  value = EvalAdjustT<uint8,  int8> (adjust, scope, last_value, value, &iter); break;
-			case DSG_SIZE_WORD:  value = EvalAdjustT<uint16, int16>(adjust, scope, last_value, value, &iter); break;
-			case DSG_SIZE_DWORD: value = EvalAdjustT<uint32, int32>(adjust, scope, last_value, value, &iter); break;
-			default: NOT_REACHED();
+		if (adjust.eval_proc != nullptr) {
+			value = adjust.eval_proc(adjust, scope, last_value, value, &iter);
+		} else {
+			switch (this->size) {
+				case DSG_SIZE_BYTE:  value = EvalAdjustT<uint8,  int8> (adjust, scope, last_value, value, &iter); break;
+				case DSG_SIZE_WORD:  value = EvalAdjustT<uint16, int16>(adjust, scope, last_value, value, &iter); break;
+				case DSG_SIZE_DWORD: value = EvalAdjustT<uint32, int32>(adjust, scope, last_value, value, &iter); break;
+				default: NOT_REACHED();
+			}
 		}
 		last_value = value;
 	}
@@ -417,6 +417,15 @@ inline DeterministicSpriteGroupAdjustType InvertConstantComparisonAdjustType(Det
 	return (adjust_type == DSGA_TYPE_EQ) ? DSGA_TYPE_NEQ : DSGA_TYPE_EQ;
 }
 
+struct DeterministicSpriteGroupAdjust;
+struct ScopeResolver;
+
+/**
+ * Evaluation function of an adjust, specialised for the group's size and the adjust's operation.
+ * See BindDeterministicSpriteGroupAdjustEvalProcs.
+ */
+typedef uint32 DeterministicSpriteGroupAdjustEvalProc(const DeterministicSpriteGroupAdjust &adjust, ScopeResolver *scope, uint32 last_value, uint32 value, const DeterministicSpriteGroupAdjust **adjust_iter);
+
 struct DeterministicSpriteGroupAdjust {
 	DeterministicSpriteGroupAdjustOperation operation;
 	DeterministicSpriteGroupAdjustType type;
@@ -431,6 +440,7 @@ struct DeterministicSpriteGroupAdjust {
 		const SpriteGroup *subroutine;
 		uint32 jump;
 	};
+	DeterministicSpriteGroupAdjustEvalProc *eval_proc = nullptr; ///< Specialised evaluation function, or nullptr to use the generic one.
 };
 
 struct DeterministicSpriteGroupRange {
@@ -765,5 +775,6 @@ public:
 
 void DumpSpriteGroup(const SpriteGroup *sg, DumpSpriteGroupPrinter print);
 uint32 EvaluateDeterministicSpriteGroupAdjust(DeterministicSpriteGroupSize size, const DeterministicSpriteGroupAdjust &adjust, ScopeResolver *scope, uint32 last_value, uint32 value);
+void BindDeterministicSpriteGroupAdjustEvalProcs();
 
 #endif /* NEWGRF_SPRITEGROUP_H */
@@ -37,6 +37,7 @@
 #include "zoom_func.h"
 
 #include "widgets/news_widget.h"
+#include "trace.h"
 
 #include "table/strings.h"
 
@@ -1014,6 +1015,8 @@ void ChangeVehicleNews(VehicleID from_index, VehicleID to_index)
 
 void NewsLoop()
 {
+	TRACE_ZONE("NewsLoop");
+
 	/* no news item yet */
 	if (_total_news == 0) return;
 
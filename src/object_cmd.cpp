@@ -225,6 +225,10 @@ void UpdateCompanyHQ(TileIndex tile, uint score)
 	if (score >= 520) val++;
 	if (score >= 720) val++;
 
+	if (GetCompanyHQSize(tile) >= val) return;
+
+	/* The acceptance of the HQ depends on its size. */
+	for (TileIndex t : TileArea(tile, 2, 2)) MarkTileAcceptanceChanged(t);
 	while (GetCompanyHQSize(tile) < val) {
 		IncreaseCompanyHQSize(tile);
 	}
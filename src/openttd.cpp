@@ -65,6 +65,7 @@
 #include "viewport_func.h"
 #include "viewport_sprite_sorter.h"
 #include "framerate_type.h"
+#include "trace.h"
 #include "programmable_signals.h"
 #include "smallmap_gui.h"
 #include "viewport_func.h"
@@ -83,6 +84,7 @@
 #include "debug_desync.h"
 #include "event_logs.h"
 #include "tunnelbridge.h"
+#include "worker_thread.h"
 
 #include "linkgraph/linkgraphschedule.h"
 #include "tracerestrict.h"
@@ -94,6 +96,7 @@
 
 #include <stdarg.h>
 #include <system_error>
+#include <chrono>
 
 #include "safeguards.h"
 
@@ -119,6 +122,26 @@ bool _request_newgrf_scan = false;
 NewGRFScanCallback *_request_newgrf_scan_callback = nullptr;
 
 SimpleChecksum64 _state_checksum;
+SimpleChecksum64 _state_checksum_parts[SCP_END];
+
+/**
+ * Get the name of a part of the state checksum.
+ * @param part The part.
+ * @return The name.
+ */
+const char *GetStateChecksumPartName(StateChecksumPart part)
+{
+	static const char * const names[SCP_END] = {
+		"vehicles",
+		"companies",
+		"commands",
+		"towns",
+		"stations",
+		"industries",
+	};
+	assert(part < SCP_END);
+	return names[part];
+}
 
 /**
  * Error handling for fatal user errors.
@@ -388,6 +411,10 @@ static void WriteSavegameDebugData(const char *name)
 	} else {
 		p += seprintf(p, buflast, "No debug config data in savegame\n");
 	}
+	PrintSaveLoadProfile(GetLastSaveLoadProfile(), [&](const char *line) {
+		if (buflast - p <= 1024) bump_size();
+		p += seprintf(p, buflast, "%s\n", line);
+	});
 
 	/* ShowInfo put output to stderr, but version information should go
 	 * to stdout; this is the only exception */
@@ -441,6 +468,8 @@ static void ShutdownGame()
 	GamelogReset();
 
 	LinkGraphSchedule::Clear();
+	MapExportStop();
+	_general_worker_pool.Stop();
 	ClearTraceRestrictMapping();
 	ClearBridgeSimulatedSignalMapping();
 	ClearBridgeSignalStyleMapping();
@@ -1374,6 +1403,38 @@ void WriteVehicleInfo(char *&p, const char *last, const Vehicle *u, const Vehicl
 	}
 }
 
+/**
+ * Add the number of signals on a tile to the per-company signal totals.
+ * @param tile Tile to count.
+ * @param totals Per-company signal totals to add to.
+ */
+static void AddTileSignalCount(TileIndex tile, std::array<int, MAX_COMPANIES> &totals)
+{
+	switch (GetTileType(tile)) {
+		case MP_RAILWAY:
+			if (HasSignals(tile)) {
+				const Company *c = Company::GetIfValid(GetTileOwner(tile));
+				if (c != nullptr) totals[c->index] += CountBits(GetPresentSignals(tile));
+			}
+			break;
+
+		case MP_TUNNELBRIDGE: {
+			/* Only count the tunnel/bridge if we're on the northern end tile. */
+			DiagDirection dir = GetTunnelBridgeDirection(tile);
+			if (dir == DIAGDIR_NE || dir == DIAGDIR_NW) break;
+
+			if (IsTunnelBridgeWithSignalSimulation(tile)) {
+				const Company *c = Company::GetIfValid(GetTileOwner(tile));
+				if (c != nullptr) totals[c->index] += GetTunnelBridgeSignalSimulationSignalCount(tile, GetOtherTunnelBridgeEnd(tile));
+			}
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
 static bool SignalInfraTotalMatches()
 {
 	std::array<int, MAX_COMPANIES> old_signal_totals = {};
@@ -1383,32 +1444,246 @@ static bool SignalInfraTotalMatches()
 
 	std::array<int, MAX_COMPANIES> new_signal_totals = {};
 	for (TileIndex tile = 0; tile < MapSize(); tile++) {
-		switch (GetTileType(tile)) {
-			case MP_RAILWAY:
-				if (HasSignals(tile)) {
-					const Company *c = Company::GetIfValid(GetTileOwner(tile));
-					if (c != nullptr) new_signal_totals[c->index] += CountBits(GetPresentSignals(tile));
-				}
+		AddTileSignalCount(tile, new_signal_totals);
+	}
+
+	return old_signal_totals == new_signal_totals;
+}
+
+#define CCLOG(...) { \
+	seprintf(cclog_buffer, lastof(cclog_buffer), __VA_ARGS__); \
+	emit(cclog_buffer); \
+}
+
+#define CCLOGV(...) { \
+	char *p = cclog_buffer + seprintf(cclog_buffer, lastof(cclog_buffer), __VA_ARGS__); \
+	WriteVehicleInfo(p, lastof(cclog_buffer), u, v, length); \
+	emit(cclog_buffer); \
+}
+
+/**
+ * Check the vehicle tile hash of a vehicle and, for primary vehicles,
+ * the validity of the caches of the whole chain.
+ * The chain's caches are recalculated as part of the check.
+ * @param v Vehicle to check.
+ * @param emit Function to output the log messages to.
+ */
+static void CheckVehicleCaches(Vehicle *v, const std::function<void(const char *)> &emit)
+{
+	char cclog_buffer[1024];
+
+	extern bool ValidateVehicleTileHash(const Vehicle *v);
+	if (!ValidateVehicleTileHash(v)) {
+		CCLOG("vehicle tile hash mismatch: type %i, vehicle %i, company %i, unit number %i", (int)v->type, v->index, (int)v->owner, v->unitnumber);
+	}
+
+	extern void FillNewGRFVehicleCache(const Vehicle *v);
+	if (v != v->First() || v->vehstatus & VS_CRASHED || !v->IsPrimaryVehicle()) return;
+
+	uint length = 0;
+	for (const Vehicle *u = v; u != nullptr; u = u->Next()) {
+		if (u->IsGroundVehicle() && (HasBit(u->GetGroundVehicleFlags(), GVF_GOINGUP_BIT) || HasBit(u->GetGroundVehicleFlags(), GVF_GOINGDOWN_BIT)) && u->GetGroundVehicleCache()->cached_slope_resistance && HasBit(v->vcache.cached_veh_flags, VCF_GV_ZERO_SLOPE_RESIST)) {
+			CCLOGV("VCF_GV_ZERO_SLOPE_RESIST set incorrectly (1)");
+		}
+		if (u->type == VEH_TRAIN && u->breakdown_ctr != 0 && !HasBit(Train::From(v)->flags, VRF_CONSIST_BREAKDOWN) && (Train::From(u)->IsEngine() || Train::From(u)->IsMultiheaded())) {
+			CCLOGV("VRF_CONSIST_BREAKDOWN incorrectly not set");
+		}
+		if (u->type == VEH_TRAIN && ((Train::From(u)->track & TRACK_BIT_WORMHOLE && !(Train::From(u)->vehstatus & VS_HIDDEN)) || Train::From(u)->track == TRACK_BIT_DEPOT) && !HasBit(Train::From(v)->flags, VRF_CONSIST_SPEED_REDUCTION)) {
+			CCLOGV("VRF_CONSIST_SPEED_REDUCTION incorrectly not set");
+		}
+		length++;
+	}
+
+	NewGRFCache        *grf_cache = CallocT<NewGRFCache>(length);
+	VehicleCache       *veh_cache = CallocT<VehicleCache>(length);
+	GroundVehicleCache *gro_cache = CallocT<GroundVehicleCache>(length);
+	AircraftCache      *air_cache = CallocT<AircraftCache>(length);
+	TrainCache         *tra_cache = CallocT<TrainCache>(length);
+	Vehicle           **veh_old   = CallocT<Vehicle *>(length);
+
+	length = 0;
+	for (const Vehicle *u = v; u != nullptr; u = u->Next()) {
+		FillNewGRFVehicleCache(u);
+		grf_cache[length] = u->grf_cache;
+		veh_cache[length] = u->vcache;
+		switch (u->type) {
+			case VEH_TRAIN:
+				gro_cache[length] = Train::From(u)->gcache;
+				tra_cache[length] = Train::From(u)->tcache;
+				veh_old[length] = CallocT<Train>(1);
+				memcpy((void *) veh_old[length], (const void *) Train::From(u), sizeof(Train));
+				break;
+			case VEH_ROAD:
+				gro_cache[length] = RoadVehicle::From(u)->gcache;
+				veh_old[length] = CallocT<RoadVehicle>(1);
+				memcpy((void *) veh_old[length], (const void *) RoadVehicle::From(u), sizeof(RoadVehicle));
 				break;
+			case VEH_AIRCRAFT:
+				air_cache[length] = Aircraft::From(u)->acache;
+				veh_old[length] = CallocT<Aircraft>(1);
+				memcpy((void *) veh_old[length], (const void *) Aircraft::From(u), sizeof(Aircraft));
+				break;
+			default:
+				veh_old[length] = CallocT<Vehicle>(1);
+				memcpy((void *) veh_old[length], (const void *) u, sizeof(Vehicle));
+				break;
+		}
+		length++;
+	}
 
-			case MP_TUNNELBRIDGE: {
-				/* Only count the tunnel/bridge if we're on the northern end tile. */
-				DiagDirection dir = GetTunnelBridgeDirection(tile);
-				if (dir == DIAGDIR_NE || dir == DIAGDIR_NW) break;
+	switch (v->type) {
+		case VEH_TRAIN:    Train::From(v)->ConsistChanged(CCF_TRACK); break;
+		case VEH_ROAD:     RoadVehUpdateCache(RoadVehicle::From(v)); break;
+		case VEH_AIRCRAFT: UpdateAircraftCache(Aircraft::From(v));   break;
+		case VEH_SHIP:     Ship::From(v)->UpdateCache();             break;
+		default: break;
+	}
 
-				if (IsTunnelBridgeWithSignalSimulation(tile)) {
-					const Company *c = Company::GetIfValid(GetTileOwner(tile));
-					if (c != nullptr) new_signal_totals[c->index] += GetTunnelBridgeSignalSimulationSignalCount(tile, GetOtherTunnelBridgeEnd(tile));
+	length = 0;
+	for (const Vehicle *u = v; u != nullptr; u = u->Next()) {
+		FillNewGRFVehicleCache(u);
+		if (memcmp(&grf_cache[length], &u->grf_cache, sizeof(NewGRFCache)) != 0) {
+			CCLOGV("newgrf cache mismatch");
+		}
+		if (veh_cache[length].cached_max_speed != u->vcache.cached_max_speed || veh_cache[length].cached_cargo_age_period != u->vcache.cached_cargo_age_period ||
+				veh_cache[length].cached_vis_effect != u->vcache.cached_vis_effect || HasBit(veh_cache[length].cached_veh_flags ^ u->vcache.cached_veh_flags, VCF_LAST_VISUAL_EFFECT)) {
+			CCLOGV("vehicle cache mismatch: %c%c%c%c",
+					veh_cache[length].cached_max_speed != u->vcache.cached_max_speed ? 'm' : '-',
+					veh_cache[length].cached_cargo_age_period != u->vcache.cached_cargo_age_period ? 'c' : '-',
+					veh_cache[length].cached_vis_effect != u->vcache.cached_vis_effect ? 'v' : '-',
+					HasBit(veh_cache[length].cached_veh_flags ^ u->vcache.cached_veh_flags, VCF_LAST_VISUAL_EFFECT) ? 'l' : '-');
+		}
+		if (u->IsGroundVehicle() && (HasBit(u->GetGroundVehicleFlags(), GVF_GOINGUP_BIT) || HasBit(u->GetGroundVehicleFlags(), GVF_GOINGDOWN_BIT)) && u->GetGroundVehicleCache()->cached_slope_resistance && HasBit(v->vcache.cached_veh_flags, VCF_GV_ZERO_SLOPE_RESIST)) {
+			CCLOGV("VCF_GV_ZERO_SLOPE_RESIST set incorrectly (2)");
+		}
+		if (veh_old[length]->acceleration != u->acceleration) {
+			CCLOGV("acceleration mismatch");
+		}
+		if (veh_old[length]->breakdown_chance != u->breakdown_chance) {
+			CCLOGV("breakdown_chance mismatch");
+		}
+		if (veh_old[length]->breakdown_ctr != u->breakdown_ctr) {
+			CCLOGV("breakdown_ctr mismatch");
+		}
+		if (veh_old[length]->breakdown_delay != u->breakdown_delay) {
+			CCLOGV("breakdown_delay mismatch");
+		}
+		if (veh_old[length]->breakdowns_since_last_service != u->breakdowns_since_last_service) {
+			CCLOGV("breakdowns_since_last_service mismatch");
+		}
+		if (veh_old[length]->breakdown_severity != u->breakdown_severity) {
+			CCLOGV("breakdown_severity mismatch");
+		}
+		if (veh_old[length]->breakdown_type != u->breakdown_type) {
+			CCLOGV("breakdown_type mismatch");
+		}
+		if (veh_old[length]->vehicle_flags != u->vehicle_flags) {
+			CCLOGV("vehicle_flags mismatch");
+		}
+		auto print_gv_cache_diff = [&](const char *vtype, const GroundVehicleCache &a, const GroundVehicleCache &b) {
+			CCLOGV("%s ground vehicle cache mismatch: %c%c%c%c%c%c%c%c%c%c",
+					vtype,
+					a.cached_weight != b.cached_weight ? 'w' : '-',
+					a.cached_slope_resistance != b.cached_slope_resistance ? 'r' : '-',
+					a.cached_max_te != b.cached_max_te ? 't' : '-',
+					a.cached_axle_resistance != b.cached_axle_resistance ? 'a' : '-',
+					a.cached_max_track_speed != b.cached_max_track_speed ? 's' : '-',
+					a.cached_power != b.cached_power ? 'p' : '-',
+					a.cached_air_drag != b.cached_air_drag ? 'd' : '-',
+					a.cached_total_length != b.cached_total_length ? 'l' : '-',
+					a.first_engine != b.first_engine ? 'e' : '-',
+					a.cached_veh_length != b.cached_veh_length ? 'L' : '-');
+		};
+		switch (u->type) {
+			case VEH_TRAIN:
+				if (memcmp(&gro_cache[length], &Train::From(u)->gcache, sizeof(GroundVehicleCache)) != 0) {
+					print_gv_cache_diff("train", gro_cache[length], Train::From(u)->gcache);
+				}
+				if (memcmp(&tra_cache[length], &Train::From(u)->tcache, sizeof(TrainCache)) != 0) {
+					CCLOGV("train cache mismatch: %c%c%c%c%c%c%c%c%c%c%c",
+							tra_cache[length].cached_override != Train::From(u)->tcache.cached_override ? 'o' : '-',
+							tra_cache[length].cached_curve_speed_mod != Train::From(u)->tcache.cached_curve_speed_mod ? 'C' : '-',
+							tra_cache[length].cached_tflags != Train::From(u)->tcache.cached_tflags ? 'f' : '-',
+							tra_cache[length].cached_num_engines != Train::From(u)->tcache.cached_num_engines ? 'e' : '-',
+							tra_cache[length].cached_centre_mass != Train::From(u)->tcache.cached_centre_mass ? 'm' : '-',
+							tra_cache[length].cached_braking_length != Train::From(u)->tcache.cached_braking_length ? 'b' : '-',
+							tra_cache[length].cached_veh_weight != Train::From(u)->tcache.cached_veh_weight ? 'w' : '-',
+							tra_cache[length].cached_uncapped_decel != Train::From(u)->tcache.cached_uncapped_decel ? 'D' : '-',
+							tra_cache[length].cached_deceleration != Train::From(u)->tcache.cached_deceleration ? 'd' : '-',
+							tra_cache[length].user_def_data != Train::From(u)->tcache.user_def_data ? 'u' : '-',
+							tra_cache[length].cached_max_curve_speed != Train::From(u)->tcache.cached_max_curve_speed ? 'c' : '-');
+				}
+				if (Train::From(veh_old[length])->railtype != Train::From(u)->railtype) {
+					CCLOGV("railtype mismatch");
+				}
+				if (Train::From(veh_old[length])->compatible_railtypes != Train::From(u)->compatible_railtypes) {
+					CCLOGV("compatible_railtypes mismatch");
+				}
+				if (Train::From(veh_old[length])->flags != Train::From(u)->flags) {
+					CCLOGV("train flags mismatch");
+				}
+				break;
+			case VEH_ROAD:
+				if (memcmp(&gro_cache[length], &RoadVehicle::From(u)->gcache, sizeof(GroundVehicleCache)) != 0) {
+					print_gv_cache_diff("road vehicle", gro_cache[length], Train::From(u)->gcache);
+				}
+				break;
+			case VEH_AIRCRAFT:
+				if (memcmp(&air_cache[length], &Aircraft::From(u)->acache, sizeof(AircraftCache)) != 0) {
+					CCLOGV("Aircraft vehicle cache mismatch: %c%c",
+							air_cache[length].cached_max_range != Aircraft::From(u)->acache.cached_max_range ? 'r' : '-',
+							air_cache[length].cached_max_range_sqr != Aircraft::From(u)->acache.cached_max_range_sqr ? 's' : '-');
 				}
 				break;
-			}
-
 			default:
 				break;
 		}
+		free(veh_old[length]);
+		length++;
 	}
 
-	return old_signal_totals == new_signal_totals;
+	free(grf_cache);
+	free(veh_cache);
+	free(gro_cache);
+	free(air_cache);
+	free(tra_cache);
+	free(veh_old);
+}
+
+/**
+ * Check the validity of the cargo list and docking tile caches of a station.
+ * The caches are recalculated as part of the check.
+ * @param st Station to check.
+ * @param emit Function to output the log messages to.
+ */
+static void CheckStationCaches(Station *st, const std::function<void(const char *)> &emit)
+{
+	char cclog_buffer[1024];
+
+	for (CargoID c = 0; c < NUM_CARGO; c++) {
+		byte buff[sizeof(StationCargoList)];
+		memcpy(buff, &st->goods[c].cargo, sizeof(StationCargoList));
+		st->goods[c].cargo.InvalidateCache();
+		assert(memcmp(&st->goods[c].cargo, buff, sizeof(StationCargoList)) == 0);
+	}
+
+	/* Check docking tiles */
+	TileArea ta;
+	std::map<TileIndex, bool> docking_tiles;
+	for (TileIndex tile : st->docking_station) {
+		ta.Add(tile);
+		docking_tiles[tile] = IsDockingTile(tile);
+	}
+	UpdateStationDockingTiles(st);
+	if (ta.tile != st->docking_station.tile || ta.w != st->docking_station.w || ta.h != st->docking_station.h) {
+		CCLOG("station docking mismatch: station %i, company %i, prev: (%X, %u, %u), recalc: (%X, %u, %u)",
+				st->index, (int)st->owner, ta.tile, ta.w, ta.h, st->docking_station.tile, st->docking_station.w, st->docking_station.h);
+	}
+	for (TileIndex tile : ta) {
+		if (docking_tiles[tile] != IsDockingTile(tile)) {
+			CCLOG("docking tile mismatch: tile %i", (int)tile);
+		}
+	}
 }
 
 /**
@@ -1444,31 +1719,16 @@ void CheckCaches(bool force_check, std::function<void(const char *)> log, CheckC
 		};
 	}
 
-	char cclog_buffer[1024];
-#define CCLOG(...) { \
-	seprintf(cclog_buffer, lastof(cclog_buffer), __VA_ARGS__); \
-	DEBUG(desync, 0, "%s", cclog_buffer); \
-	if (log) { \
-		log(cclog_buffer); \
-	} else { \
-		LogDesyncMsg(cclog_buffer); \
-	} \
-}
-
-	auto output_veh_info = [&](char *&p, const Vehicle *u, const Vehicle *v, uint length) {
-		WriteVehicleInfo(p, lastof(cclog_buffer), u, v, length);
+	auto emit = [&](const char *str) {
+		DEBUG(desync, 0, "%s", str);
+		if (log) {
+			log(str);
+		} else {
+			LogDesyncMsg(str);
+		}
 	};
 
-#define CCLOGV(...) { \
-	char *p = cclog_buffer + seprintf(cclog_buffer, lastof(cclog_buffer), __VA_ARGS__); \
-	output_veh_info(p, u, v, length); \
-	DEBUG(desync, 0, "%s", cclog_buffer); \
-	if (log) { \
-		log(cclog_buffer); \
-	} else { \
-		LogDesyncMsg(cclog_buffer); \
-	} \
-}
+	char cclog_buffer[1024];
 
 	if (flags & CHECK_CACHE_GENERAL) {
 		/* Check the town caches. */
@@ -1601,217 +1861,20 @@ void CheckCaches(bool force_check, std::function<void(const char *)> log, CheckC
 		}
 
 		for (Vehicle *v : Vehicle::Iterate()) {
-			extern bool ValidateVehicleTileHash(const Vehicle *v);
-			if (!ValidateVehicleTileHash(v)) {
-				CCLOG("vehicle tile hash mismatch: type %i, vehicle %i, company %i, unit number %i", (int)v->type, v->index, (int)v->owner, v->unitnumber);
-			}
-
-			extern void FillNewGRFVehicleCache(const Vehicle *v);
-			if (v != v->First() || v->vehstatus & VS_CRASHED || !v->IsPrimaryVehicle()) continue;
-
-			uint length = 0;
-			for (const Vehicle *u = v; u != nullptr; u = u->Next()) {
-				if (u->IsGroundVehicle() && (HasBit(u->GetGroundVehicleFlags(), GVF_GOINGUP_BIT) || HasBit(u->GetGroundVehicleFlags(), GVF_GOINGDOWN_BIT)) && u->GetGroundVehicleCache()->cached_slope_resistance && HasBit(v->vcache.cached_veh_flags, VCF_GV_ZERO_SLOPE_RESIST)) {
-					CCLOGV("VCF_GV_ZERO_SLOPE_RESIST set incorrectly (1)");
-				}
-				if (u->type == VEH_TRAIN && u->breakdown_ctr != 0 && !HasBit(Train::From(v)->flags, VRF_CONSIST_BREAKDOWN) && (Train::From(u)->IsEngine() || Train::From(u)->IsMultiheaded())) {
-					CCLOGV("VRF_CONSIST_BREAKDOWN incorrectly not set");
-				}
-				if (u->type == VEH_TRAIN && ((Train::From(u)->track & TRACK_BIT_WORMHOLE && !(Train::From(u)->vehstatus & VS_HIDDEN)) || Train::From(u)->track == TRACK_BIT_DEPOT) && !HasBit(Train::From(v)->flags, VRF_CONSIST_SPEED_REDUCTION)) {
-					CCLOGV("VRF_CONSIST_SPEED_REDUCTION incorrectly not set");
-				}
-				length++;
-			}
-
-			NewGRFCache        *grf_cache = CallocT<NewGRFCache>(length);
-			VehicleCache       *veh_cache = CallocT<VehicleCache>(length);
-			GroundVehicleCache *gro_cache = CallocT<GroundVehicleCache>(length);
-			AircraftCache      *air_cache = CallocT<AircraftCache>(length);
-			TrainCache         *tra_cache = CallocT<TrainCache>(length);
-			Vehicle           **veh_old   = CallocT<Vehicle *>(length);
-
-			length = 0;
-			for (const Vehicle *u = v; u != nullptr; u = u->Next()) {
-				FillNewGRFVehicleCache(u);
-				grf_cache[length] = u->grf_cache;
-				veh_cache[length] = u->vcache;
-				switch (u->type) {
-					case VEH_TRAIN:
-						gro_cache[length] = Train::From(u)->gcache;
-						tra_cache[length] = Train::From(u)->tcache;
-						veh_old[length] = CallocT<Train>(1);
-						memcpy((void *) veh_old[length], (const void *) Train::From(u), sizeof(Train));
-						break;
-					case VEH_ROAD:
-						gro_cache[length] = RoadVehicle::From(u)->gcache;
-						veh_old[length] = CallocT<RoadVehicle>(1);
-						memcpy((void *) veh_old[length], (const void *) RoadVehicle::From(u), sizeof(RoadVehicle));
-						break;
-					case VEH_AIRCRAFT:
-						air_cache[length] = Aircraft::From(u)->acache;
-						veh_old[length] = CallocT<Aircraft>(1);
-						memcpy((void *) veh_old[length], (const void *) Aircraft::From(u), sizeof(Aircraft));
-						break;
-					default:
-						veh_old[length] = CallocT<Vehicle>(1);
-						memcpy((void *) veh_old[length], (const void *) u, sizeof(Vehicle));
-						break;
-				}
-				length++;
-			}
-
-			switch (v->type) {
-				case VEH_TRAIN:    Train::From(v)->ConsistChanged(CCF_TRACK); break;
-				case VEH_ROAD:     RoadVehUpdateCache(RoadVehicle::From(v)); break;
-				case VEH_AIRCRAFT: UpdateAircraftCache(Aircraft::From(v));   break;
-				case VEH_SHIP:     Ship::From(v)->UpdateCache();             break;
-				default: break;
-			}
-
-			length = 0;
-			for (const Vehicle *u = v; u != nullptr; u = u->Next()) {
-				FillNewGRFVehicleCache(u);
-				if (memcmp(&grf_cache[length], &u->grf_cache, sizeof(NewGRFCache)) != 0) {
-					CCLOGV("newgrf cache mismatch");
-				}
-				if (veh_cache[length].cached_max_speed != u->vcache.cached_max_speed || veh_cache[length].cached_cargo_age_period != u->vcache.cached_cargo_age_period ||
-						veh_cache[length].cached_vis_effect != u->vcache.cached_vis_effect || HasBit(veh_cache[length].cached_veh_flags ^ u->vcache.cached_veh_flags, VCF_LAST_VISUAL_EFFECT)) {
-					CCLOGV("vehicle cache mismatch: %c%c%c%c",
-							veh_cache[length].cached_max_speed != u->vcache.cached_max_speed ? 'm' : '-',
-							veh_cache[length].cached_cargo_age_period != u->vcache.cached_cargo_age_period ? 'c' : '-',
-							veh_cache[length].cached_vis_effect != u->vcache.cached_vis_effect ? 'v' : '-',
-							HasBit(veh_cache[length].cached_veh_flags ^ u->vcache.cached_veh_flags, VCF_LAST_VISUAL_EFFECT) ? 'l' : '-');
-				}
-				if (u->IsGroundVehicle() && (HasBit(u->GetGroundVehicleFlags(), GVF_GOINGUP_BIT) || HasBit(u->GetGroundVehicleFlags(), GVF_GOINGDOWN_BIT)) && u->GetGroundVehicleCache()->cached_slope_resistance && HasBit(v->vcache.cached_veh_flags, VCF_GV_ZERO_SLOPE_RESIST)) {
-					CCLOGV("VCF_GV_ZERO_SLOPE_RESIST set incorrectly (2)");
-				}
-				if (veh_old[length]->acceleration != u->acceleration) {
-					CCLOGV("acceleration mismatch");
-				}
-				if (veh_old[length]->breakdown_chance != u->breakdown_chance) {
-					CCLOGV("breakdown_chance mismatch");
-				}
-				if (veh_old[length]->breakdown_ctr != u->breakdown_ctr) {
-					CCLOGV("breakdown_ctr mismatch");
-				}
-				if (veh_old[length]->breakdown_delay != u->breakdown_delay) {
-					CCLOGV("breakdown_delay mismatch");
-				}
-				if (veh_old[length]->breakdowns_since_last_service != u->breakdowns_since_last_service) {
-					CCLOGV("breakdowns_since_last_service mismatch");
-				}
-				if (veh_old[length]->breakdown_severity != u->breakdown_severity) {
-					CCLOGV("breakdown_severity mismatch");
-				}
-				if (veh_old[length]->breakdown_type != u->breakdown_type) {
-					CCLOGV("breakdown_type mismatch");
-				}
-				if (veh_old[length]->vehicle_flags != u->vehicle_flags) {
-					CCLOGV("vehicle_flags mismatch");
-				}
-				auto print_gv_cache_diff = [&](const char *vtype, const GroundVehicleCache &a, const GroundVehicleCache &b) {
-					CCLOGV("%s ground vehicle cache mismatch: %c%c%c%c%c%c%c%c%c%c",
-							vtype,
-							a.cached_weight != b.cached_weight ? 'w' : '-',
-							a.cached_slope_resistance != b.cached_slope_resistance ? 'r' : '-',
-							a.cached_max_te != b.cached_max_te ? 't' : '-',
-							a.cached_axle_resistance != b.cached_axle_resistance ? 'a' : '-',
-							a.cached_max_track_speed != b.cached_max_track_speed ? 's' : '-',
-							a.cached_power != b.cached_power ? 'p' : '-',
-							a.cached_air_drag != b.cached_air_drag ? 'd' : '-',
-							a.cached_total_length != b.cached_total_length ? 'l' : '-',
-							a.first_engine != b.first_engine ? 'e' : '-',
-							a.cached_veh_length != b.cached_veh_length ? 'L' : '-');
-				};
-				switch (u->type) {
-					case VEH_TRAIN:
-						if (memcmp(&gro_cache[length], &Train::From(u)->gcache, sizeof(GroundVehicleCache)) != 0) {
-							print_gv_cache_diff("train", gro_cache[length], Train::From(u)->gcache);
-						}
-						if (memcmp(&tra_cache[length], &Train::From(u)->tcache, sizeof(TrainCache)) != 0) {
-							CCLOGV("train cache mismatch: %c%c%c%c%c%c%c%c%c%c%c",
-									tra_cache[length].cached_override != Train::From(u)->tcache.cached_override ? 'o' : '-',
-									tra_cache[length].cached_curve_speed_mod != Train::From(u)->tcache.cached_curve_speed_mod ? 'C' : '-',
-									tra_cache[length].cached_tflags != Train::From(u)->tcache.cached_tflags ? 'f' : '-',
-									tra_cache[length].cached_num_engines != Train::From(u)->tcache.cached_num_engines ? 'e' : '-',
-									tra_cache[length].cached_centre_mass != Train::From(u)->tcache.cached_centre_mass ? 'm' : '-',
-									tra_cache[length].cached_braking_length != Train::From(u)->tcache.cached_braking_length ? 'b' : '-',
-									tra_cache[length].cached_veh_weight != Train::From(u)->tcache.cached_veh_weight ? 'w' : '-',
-									tra_cache[length].cached_uncapped_decel != Train::From(u)->tcache.cached_uncapped_decel ? 'D' : '-',
-									tra_cache[length].cached_deceleration != Train::From(u)->tcache.cached_deceleration ? 'd' : '-',
-									tra_cache[length].user_def_data != Train::From(u)->tcache.user_def_data ? 'u' : '-',
-									tra_cache[length].cached_max_curve_speed != Train::From(u)->tcache.cached_max_curve_speed ? 'c' : '-');
-						}
-						if (Train::From(veh_old[length])->railtype != Train::From(u)->railtype) {
-							CCLOGV("railtype mismatch");
-						}
-						if (Train::From(veh_old[length])->compatible_railtypes != Train::From(u)->compatible_railtypes) {
-							CCLOGV("compatible_railtypes mismatch");
-						}
-						if (Train::From(veh_old[length])->flags != Train::From(u)->flags) {
-							CCLOGV("train flags mismatch");
-						}
-						break;
-					case VEH_ROAD:
-						if (memcmp(&gro_cache[length], &RoadVehicle::From(u)->gcache, sizeof(GroundVehicleCache)) != 0) {
-							print_gv_cache_diff("road vehicle", gro_cache[length], Train::From(u)->gcache);
-						}
-						break;
-					case VEH_AIRCRAFT:
-						if (memcmp(&air_cache[length], &Aircraft::From(u)->acache, sizeof(AircraftCache)) != 0) {
-							CCLOGV("Aircraft vehicle cache mismatch: %c%c",
-									air_cache[length].cached_max_range != Aircraft::From(u)->acache.cached_max_range ? 'r' : '-',
-									air_cache[length].cached_max_range_sqr != Aircraft::From(u)->acache.cached_max_range_sqr ? 's' : '-');
-						}
-						break;
-					default:
-						break;
-				}
-				free(veh_old[length]);
-				length++;
-			}
-
-			free(grf_cache);
-			free(veh_cache);
-			free(gro_cache);
-			free(air_cache);
-			free(tra_cache);
-			free(veh_old);
+			CheckVehicleCaches(v, emit);
 		}
 
 		/* Check whether the caches are still valid */
 		for (Vehicle *v : Vehicle::Iterate()) {
 			byte buff[sizeof(VehicleCargoList)];
+			v->cargo.ApplyPendingAge();
 			memcpy(buff, &v->cargo, sizeof(VehicleCargoList));
 			v->cargo.InvalidateCache();
 			assert(memcmp(&v->cargo, buff, sizeof(VehicleCargoList)) == 0);
 		}
 
 		for (Station *st : Station::Iterate()) {
-			for (CargoID c = 0; c < NUM_CARGO; c++) {
-				byte buff[sizeof(StationCargoList)];
-				memcpy(buff, &st->goods[c].cargo, sizeof(StationCargoList));
-				st->goods[c].cargo.InvalidateCache();
-				assert(memcmp(&st->goods[c].cargo, buff, sizeof(StationCargoList)) == 0);
-			}
-
-			/* Check docking tiles */
-			TileArea ta;
-			std::map<TileIndex, bool> docking_tiles;
-			for (TileIndex tile : st->docking_station) {
-				ta.Add(tile);
-				docking_tiles[tile] = IsDockingTile(tile);
-			}
-			UpdateStationDockingTiles(st);
-			if (ta.tile != st->docking_station.tile || ta.w != st->docking_station.w || ta.h != st->docking_station.h) {
-				CCLOG("station docking mismatch: station %i, company %i, prev: (%X, %u, %u), recalc: (%X, %u, %u)",
-						st->index, (int)st->owner, ta.tile, ta.w, ta.h, st->docking_station.tile, st->docking_station.w, st->docking_station.h);
-			}
-			for (TileIndex tile : ta) {
-				if (docking_tiles[tile] != IsDockingTile(tile)) {
-					CCLOG("docking tile mismatch: tile %i", (int)tile);
-				}
-			}
+			CheckStationCaches(st, emit);
 		}
 
 		for (OrderList *order_list : OrderList::Iterate()) {
@@ -1860,9 +1923,236 @@ void CheckCaches(bool force_check, std::function<void(const char *)> log, CheckC
 		}
 	}
 
+}
+
+/** State of the budgeted sampling cache check, which is carried over between ticks. */
+struct SampledCacheCheckState {
+	enum Phase : uint8 {
+		PHASE_VEHICLES,  ///< Check the vehicle caches, one vehicle at a time.
+		PHASE_STATIONS,  ///< Check the station caches, one station at a time.
+		PHASE_TOWNS,     ///< Check the town zone radius caches, one town at a time.
+		PHASE_TILES,     ///< Sweep the map to count signals and houses.
+		PHASE_END,
+	};
+
+	/** Per-town house totals. */
+	struct TownHouseCount {
+		TileIndex xy;       ///< Town location, to detect the town being replaced during the sweep.
+		uint32 population;  ///< Population of completed houses.
+		uint32 num_houses;  ///< Number of houses.
+	};
+
+	Phase phase = PHASE_VEHICLES;
+	size_t next_index = 0;                                  ///< Next pool index or tile to check in the current phase.
+	std::array<int, MAX_COMPANIES> signal_snapshot;         ///< Company signal totals at the start of the map sweep, -1 for invalid companies.
+	std::array<int, MAX_COMPANIES> signal_counts;           ///< Signals counted so far in the map sweep.
+	std::vector<TownHouseCount> town_snapshot;              ///< Town house totals at the start of the map sweep.
+	std::vector<TownHouseCount> town_counts;                ///< Houses counted so far in the map sweep.
+};
+
+static SampledCacheCheckState _sampled_cache_check_state;
+
+/**
+ * Count the houses of town over the whole map.
+ * @param t Town to count.
+ * @return The population and the number of houses of the town.
+ */
+static SampledCacheCheckState::TownHouseCount CountTownHouses(const Town *t)
+{
+	SampledCacheCheckState::TownHouseCount count = { t->xy, 0, 0 };
+	for (TileIndex tile = 0; tile < MapSize(); tile++) {
+		if (!IsTileType(tile, MP_HOUSE) || GetTownIndex(tile) != t->index) continue;
+
+		HouseID house_id = GetHouseType(tile);
+		if (IsHouseCompleted(tile)) count.population += HouseSpec::Get(house_id)->population;
+		if (GetHouseNorthPart(house_id) == 0) count.num_houses++;
+	}
+	return count;
+}
+
+/**
+ * Start a new sampled sweep of the map, taking a snapshot of the totals to compare against at the end of the sweep.
+ * @param state Sampling state.
+ */
+static void StartSampledTileSweep(SampledCacheCheckState &state)
+{
+	state.signal_snapshot.fill(-1);
+	state.signal_counts.fill(0);
+	for (const Company *c : Company::Iterate()) {
+		state.signal_snapshot[c->index] = c->infrastructure.signal;
+	}
+
+	state.town_snapshot.assign(Town::GetPoolSize(), { INVALID_TILE, 0, 0 });
+	state.town_counts.assign(Town::GetPoolSize(), { INVALID_TILE, 0, 0 });
+	for (const Town *t : Town::Iterate()) {
+		state.town_snapshot[t->index] = { t->xy, t->cache.population, t->cache.num_houses };
+	}
+}
+
+/**
+ * Finish a sampled sweep of the map, and check the counted totals.
+ * Totals which changed while the sweep was in progress are not checked.
+ * As a tile may have changed after it was counted without changing the total, each apparent mismatch is
+ * confirmed with a full count before it is reported.
+ * @param state Sampling state.
+ * @param emit Function to output the log messages to.
+ */
+static void FinishSampledTileSweep(SampledCacheCheckState &state, const std::function<void(const char *)> &emit)
+{
+	char cclog_buffer[1024];
+
+	bool signal_mismatch = false;
+	for (const Company *c : Company::Iterate()) {
+		if (state.signal_snapshot[c->index] == (int)c->infrastructure.signal && state.signal_counts[c->index] != (int)c->infrastructure.signal) signal_mismatch = true;
+	}
+	if (signal_mismatch && !SignalInfraTotalMatches()) {
+		CCLOG("sampled cache check: signal infrastructure total mismatch");
+		CheckCaches(true, emit, CHECK_CACHE_INFRA_TOTALS);
+	}
+
+	for (Town *t : Town::Iterate()) {
+		if (t->index >= state.town_snapshot.size()) continue;
+		const SampledCacheCheckState::TownHouseCount &snapshot = state.town_snapshot[t->index];
+		const SampledCacheCheckState::TownHouseCount &counted = state.town_counts[t->index];
+		if (snapshot.xy != t->xy || snapshot.population != t->cache.population || snapshot.num_houses != t->cache.num_houses) continue;
+		if (counted.population == t->cache.population && counted.num_houses == t->cache.num_houses) continue;
+
+		SampledCacheCheckState::TownHouseCount recount = CountTownHouses(t);
+		if (recount.population != t->cache.population) {
+			CCLOG("town cache population mismatch: town %i, (old size: %u, new size: %u)", (int)t->index, t->cache.population, recount.population);
+		}
+		if (recount.num_houses != t->cache.num_houses) {
+			CCLOG("town cache num_houses mismatch: town %i, (old size: %u, new size: %u)", (int)t->index, t->cache.num_houses, recount.num_houses);
+		}
+		if (recount.population != t->cache.population || recount.num_houses != t->cache.num_houses) {
+			t->cache.population = recount.population;
+			t->cache.num_houses = recount.num_houses;
+			UpdateTownRadius(t);
+		}
+	}
+}
+
+/**
+ * Check the validity of a rotating sample of the caches, within a fixed time budget.
+ * Each call continues where the previous call stopped, cycling through the vehicles, stations,
+ * towns and a sweep of the map for the signal infrastructure and town house totals.
+ * This is intended to be cheap enough to be run every tick on a live server.
+ * Mismatches are written to the desync log.
+ * @param budget_us Time budget in microseconds, 0 to disable.
+ */
+void CheckCachesSampled(uint budget_us)
+{
+	if (budget_us == 0) return;
+
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(budget_us);
+	auto out_of_time = [&]() -> bool {
+		return std::chrono::steady_clock::now() >= deadline;
+	};
+
+	std::vector<std::string> saved_messages;
+	auto emit = [&saved_messages](const char *str) {
+		DEBUG(desync, 0, "%s", str);
+		saved_messages.emplace_back(str);
+	};
+
+	char cclog_buffer[1024];
+
+	SampledCacheCheckState &state = _sampled_cache_check_state;
+
+	/* Stop once each phase has been visited in this call, so that an empty game does not spin until the deadline. */
+	for (uint phases = 0; phases < SampledCacheCheckState::PHASE_END && !out_of_time(); phases++) {
+		switch (state.phase) {
+			case SampledCacheCheckState::PHASE_VEHICLES:
+				while (state.next_index < Vehicle::GetPoolSize()) {
+					Vehicle *v = Vehicle::GetIfValid(state.next_index++);
+					if (v == nullptr) continue;
+					CheckVehicleCaches(v, emit);
+					if (out_of_time()) break;
+				}
+				if (state.next_index < Vehicle::GetPoolSize()) break;
+				state.phase = SampledCacheCheckState::PHASE_STATIONS;
+				state.next_index = 0;
+				break;
+
+			case SampledCacheCheckState::PHASE_STATIONS:
+				while (state.next_index < Station::GetPoolSize()) {
+					Station *st = Station::GetIfValid(state.next_index++);
+					if (st == nullptr) continue;
+
+					IndustryList old_industries_near = st->industries_near;
+					BitmapTileArea old_catchment_tiles = st->catchment_tiles;
+					st->RecomputeCatchment();
+					if (old_industries_near != st->industries_near) {
+						CCLOG("station industries_near mismatch: st %i, (old size: %u, new size: %u)", (int)st->index, (uint)old_industries_near.size(), (uint)st->industries_near.size());
+					}
+					if (!(old_catchment_tiles == st->catchment_tiles)) {
+						CCLOG("station catchment_tiles mismatch: st %i", (int)st->index);
+					}
+					CheckStationCaches(st, emit);
+					if (out_of_time()) break;
+				}
+				if (state.next_index < Station::GetPoolSize()) break;
+				state.phase = SampledCacheCheckState::PHASE_TOWNS;
+				state.next_index = 0;
+				break;
+
+			case SampledCacheCheckState::PHASE_TOWNS:
+				while (state.next_index < Town::GetPoolSize()) {
+					Town *t = Town::GetIfValid(state.next_index++);
+					if (t == nullptr) continue;
+
+					uint32 old_radius[lengthof(t->cache.squared_town_zone_radius)];
+					MemCpyT(old_radius, t->cache.squared_town_zone_radius, lengthof(old_radius));
+					UpdateTownRadius(t);
+					if (MemCmpT(old_radius, t->cache.squared_town_zone_radius, lengthof(old_radius)) != 0) {
+						CCLOG("town cache squared_town_zone_radius mismatch: town %i", (int)t->index);
+					}
+					if (out_of_time()) break;
+				}
+				if (state.next_index < Town::GetPoolSize()) break;
+				state.phase = SampledCacheCheckState::PHASE_TILES;
+				state.next_index = 0;
+				break;
+
+			case SampledCacheCheckState::PHASE_TILES:
+				if (state.next_index == 0) StartSampledTileSweep(state);
+				while (state.next_index < MapSize()) {
+					TileIndex tile = (TileIndex)state.next_index++;
+					AddTileSignalCount(tile, state.signal_counts);
+					if (IsTileType(tile, MP_HOUSE)) {
+						TownID town = GetTownIndex(tile);
+						if (town < state.town_counts.size()) {
+							HouseID house_id = GetHouseType(tile);
+							if (IsHouseCompleted(tile)) state.town_counts[town].population += HouseSpec::Get(house_id)->population;
+							if (GetHouseNorthPart(house_id) == 0) state.town_counts[town].num_houses++;
+						}
+					}
+					/* Only check the time every so often, counting a tile is cheap. */
+					if ((state.next_index & 0x3FF) == 0 && out_of_time()) break;
+				}
+				if (state.next_index < MapSize()) break;
+				FinishSampledTileSweep(state, emit);
+				state.phase = SampledCacheCheckState::PHASE_VEHICLES;
+				state.next_index = 0;
+				break;
+
+			default:
+				NOT_REACHED();
+		}
+	}
+
+	if (!saved_messages.empty()) {
+		InconsistencyExtraInfo info;
+		info.check_caches_result = std::move(saved_messages);
+		CrashLog::InconsistencyLog(info);
+		for (std::string &str : info.check_caches_result) {
+			LogDesyncMsg(std::move(str));
+		}
+	}
+}
+
 #undef CCLOGV
 #undef CCLOG
-}
 
 /**
  * Network-safe forced desync check.
@@ -1889,6 +2179,8 @@ CommandCost CmdDesyncCheck(TileIndex tile, DoCommandFlag flags, uint32 p1, uint3
  */
 void StateGameLoop()
 {
+	TRACE_ZONE("StateGameLoop");
+
 	if (!_networking || _network_server) {
 		StateGameLoop_LinkGraphPauseControl();
 	}
@@ -1934,6 +2226,7 @@ void StateGameLoop()
 		}
 
 		CheckCaches(false, nullptr, CHECK_CACHE_ALL | CHECK_CACHE_EMIT_LOG);
+		CheckCachesSampled(_settings_client.network.sampled_cache_check_budget);
 
 		/* All these actions has to be done from OWNER_NONE
 		 *  for multiplayer compatibility */
@@ -1980,7 +2273,7 @@ void StateGameLoop()
 
 		for (Company *c : Company::Iterate()) {
 			DEBUG_UPDATESTATECHECKSUM("Company: %u, Money: " OTTD_PRINTF64, c->index, (int64)c->money);
-			UpdateStateChecksum(c->money);
+			UpdateStateChecksum(c->money, SCP_COMPANIES);
 		}
 		cur_company.Restore();
 	}
@@ -2050,6 +2343,8 @@ void GameLoopSpecial()
 
 void GameLoop()
 {
+	TRACE_ZONE("GameLoop");
+
 	if (_game_mode == GM_BOOTSTRAP) {
 		/* Check for UDP stuff */
 		if (_network_available) NetworkBackgroundLoop();
@@ -2074,6 +2369,7 @@ void GameLoop()
 		_switch_mode = SM_NONE;
 	}
 
+	PrefetchQueuedSprites();
 	IncreaseSpriteLRU();
 
 	/* Check for UDP stuff */
@@ -2095,6 +2391,8 @@ void GameLoop()
 	}
 	ExecuteCommandQueue();
 
+	MapExportLoop();
+
 	if (!_pause_mode && HasBit(_display_opt, DO_FULL_ANIMATION)) {
 		extern std::mutex _cur_palette_mutex;
 		std::lock_guard<std::mutex> lock_state(_cur_palette_mutex);
@@ -654,6 +654,7 @@ public:
 	void ClearScheduledDispatch() { this->scheduled_dispatch.clear(); }
 	bool UpdateScheduledDispatchToDate(DateTicksScaled now);
 	void UpdateScheduledDispatch(const Vehicle *v);
+	DateTicksScaled GetFirstDispatchSlotFrom(DateTicksScaled tick) const;
 
 	/**
 	 * Set the scheduled dispatch duration, in scaled tick
@@ -525,6 +525,12 @@ void CDECL HandleCrash(int signum, siginfo_t *si, void *context)
 	log.MakeInconsistencyLog(info);
 }
 
+/* static */ void CrashLog::SlowTickLog(const SlowTickExtraInfo &info)
+{
+	CrashLogOSX log(CrashLogOSX::DesyncTag{});
+	log.MakeSlowTickLog(info);
+}
+
 
 /* static */ void CrashLog::VersionInfoLog()
 {
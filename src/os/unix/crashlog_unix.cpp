@@ -804,6 +804,12 @@ static void CDECL HandleCrash(int signum)
 	log.MakeInconsistencyLog(info);
 }
 
+/* static */ void CrashLog::SlowTickLog(const SlowTickExtraInfo &info)
+{
+	CrashLogUnix log(CrashLogUnix::DesyncTag{});
+	log.MakeSlowTickLog(info);
+}
+
 /* static */ void CrashLog::VersionInfoLog()
 {
 	CrashLogUnix log(CrashLogUnix::DesyncTag{});
@@ -785,6 +785,12 @@ static void CDECL CustomAbort(int signal)
 	log.MakeInconsistencyLog(info);
 }
 
+/* static */ void CrashLog::SlowTickLog(const SlowTickExtraInfo &info)
+{
+	CrashLogWindows log(nullptr);
+	log.MakeSlowTickLog(info);
+}
+
 /* static */ void CrashLog::VersionInfoLog()
 {
 	CrashLogWindows log(nullptr);
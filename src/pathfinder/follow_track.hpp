@@ -17,6 +17,7 @@
 #include "../tunnelbridge.h"
 #include "../tunnelbridge_map.h"
 #include "../depot_map.h"
+#include "../water_map.h"
 #include "../infrastructure_func.h"
 #include "pathfinder_func.h"
 
@@ -240,6 +241,8 @@ protected:
 			m_new_td_bits = (TrackdirBits)(GetTrackBits(m_new_tile) * 0x101);
 		} else if (IsRoadTT()) {
 			m_new_td_bits = GetTrackdirBitsForRoad(m_new_tile, this->IsTram() ? RTT_TRAM : RTT_ROAD);
+		} else if (IsWaterTT() && IsTileType(m_new_tile, MP_WATER)) {
+			m_new_td_bits = TrackBitsToTrackdirBits(GetWaterTileShipTrackBits(m_new_tile));
 		} else {
 			m_new_td_bits = TrackStatusToTrackdirBits(GetTileTrackStatus(m_new_tile, TT(), 0));
 		}
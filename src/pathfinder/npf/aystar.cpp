@@ -35,9 +35,7 @@
  */
 PathNode *AyStar::ClosedListIsInList(const AyStarNode *node)
 {
-	const auto result = this->closedlist_hash.find(std::make_pair(node->tile, node->direction));
-
-	return (result == this->closedlist_hash.end()) ? nullptr : result->second;
+	return this->closedlist_hash.Find(node->tile, node->direction);
 }
 
 /**
@@ -51,7 +49,7 @@ void AyStar::ClosedListAdd(const PathNode *node)
 	const auto new_node = MallocT<PathNode>(1);
 	*new_node = *node;
 
-	this->closedlist_hash[std::make_pair(node->node.tile, node->node.direction)] = new_node;
+	this->closedlist_hash.Set(node->node.tile, node->node.direction, new_node);
 }
 
 /**
@@ -61,9 +59,7 @@ void AyStar::ClosedListAdd(const PathNode *node)
  */
 OpenListNode *AyStar::OpenListIsInList(const AyStarNode *node)
 {
-	const auto result = this->openlist_hash.find(std::make_pair(node->tile, node->direction));
-
-	return (result == this->openlist_hash.end()) ? nullptr : result->second;
+	return this->openlist_hash.Find(node->tile, node->direction);
 }
 
 /**
@@ -74,9 +70,9 @@ OpenListNode *AyStar::OpenListIsInList(const AyStarNode *node)
 OpenListNode *AyStar::OpenListPop()
 {
 	/* Return the item the Queue returns.. the best next OpenList item. */
-	OpenListNode *res = (OpenListNode*)this->openlist_queue.Pop();
+	OpenListNode *res = this->openlist_queue.Pop();
 	if (res != nullptr) {
-		this->openlist_hash.erase(std::make_pair(res->path.node.tile, res->path.node.direction));
+		this->openlist_hash.Erase(res->path.node.tile, res->path.node.direction);
 	}
 
 	return res;
@@ -93,7 +89,7 @@ void AyStar::OpenListAdd(PathNode *parent, const AyStarNode *node, int f, int g)
 	new_node->g = g;
 	new_node->path.parent = parent;
 	new_node->path.node = *node;
-	this->openlist_hash[std::make_pair(node->tile, node->direction)] =  new_node;
+	this->openlist_hash.Set(node->tile, node->direction, new_node);
 
 	/* Add it to the queue */
 	this->openlist_queue.Push(new_node, f);
@@ -139,7 +135,6 @@ void AyStar::CheckTile(AyStarNode *current, OpenListNode *parent)
 		uint i;
 		/* Yes, check if this g value is lower.. */
 		if (new_g >= check->g) return;
-		this->openlist_queue.Delete(check, 0);
 
 		/* It is lower, so change it to this item */
 		check->g = new_g;
@@ -148,8 +143,8 @@ void AyStar::CheckTile(AyStarNode *current, OpenListNode *parent)
 		for (i = 0; i < lengthof(current->user_data); i++) {
 			check->path.node.user_data[i] = current->user_data[i];
 		}
-		/* Re-add it in the openlist_queue. */
-		this->openlist_queue.Push(check, new_f);
+		/* Move it to its new place in the openlist_queue. */
+		this->openlist_queue.Update(check, new_f);
 	} else {
 		/* A new node, add it to the OpenList */
 		this->OpenListAdd(closedlist_parent, current, new_f, new_g);
@@ -198,7 +193,7 @@ int AyStar::Loop()
 	/* Free the node */
 	free(current);
 
-	if (this->max_search_nodes != 0 && this->closedlist_hash.size() >= this->max_search_nodes) {
+	if (this->max_search_nodes != 0 && this->closedlist_hash.Size() >= this->max_search_nodes) {
 		/* We've expanded enough nodes */
 		return AYSTAR_LIMIT_REACHED;
 	} else {
@@ -212,17 +207,12 @@ int AyStar::Loop()
  */
 void AyStar::Free()
 {
-	this->openlist_queue.Free(false);
-	/* 2nd argument above is false, below is true, to free the values only
-	 * once */
-	for (const auto& pair : this->openlist_hash) {
-		free(pair.second);
-	}
-	this->openlist_hash.clear();
-	for (const auto& pair : this->closedlist_hash) {
-		free(pair.second);
-	}
-	this->closedlist_hash.clear();
+	/* The queue only references the values of the open list hash, free them only once */
+	this->openlist_queue.Free();
+	this->openlist_hash.ForEach([](OpenListNode *node) { free(node); });
+	this->openlist_hash.Free();
+	this->closedlist_hash.ForEach([](PathNode *node) { free(node); });
+	this->closedlist_hash.Free();
 #ifdef AYSTAR_DEBUG
 	printf("[AyStar] Memory free'd\n");
 #endif
@@ -236,17 +226,12 @@ void AyStar::Clear()
 {
 	/* Clean the Queue, but not the elements within. That will be done by
 	 * the hash. */
-	this->openlist_queue.Clear(false);
+	this->openlist_queue.Clear();
 	/* Clean the hashes */
-	for (const auto& pair : this->openlist_hash) {
-		free(pair.second);
-	}
-	this->openlist_hash.clear();
-
-	for (const auto& pair : this->closedlist_hash) {
-		free(pair.second);
-	}
-	this->closedlist_hash.clear();
+	this->openlist_hash.ForEach([](OpenListNode *node) { free(node); });
+	this->openlist_hash.Clear();
+	this->closedlist_hash.ForEach([](PathNode *node) { free(node); });
+	this->closedlist_hash.Clear();
 
 #ifdef AYSTAR_DEBUG
 	printf("[AyStar] Cleared AyStar\n");
@@ -313,15 +298,11 @@ void AyStar::AddStartNode(AyStarNode *start_node, uint g)
 void AyStar::Init(uint num_buckets)
 {
 	MemSetT(&neighbours, 0);
-	MemSetT(&openlist_queue, 0);
 
-	/* Allocated the Hash for the OpenList and ClosedList */
-	this->openlist_hash.reserve(num_buckets);
-	this->closedlist_hash.reserve(num_buckets);
+	/* Allocate the Hash for the OpenList and ClosedList, they grow when needed */
+	this->openlist_hash.Init(num_buckets);
+	this->closedlist_hash.Init(num_buckets);
 
-	/* Set up our sorting queue
-	 *  BinaryHeap allocates a block of 1024 nodes
-	 *  When that one gets full it reserves another one, till this number
-	 *  That is why it can stay this high */
-	this->openlist_queue.Init(102400);
+	/* Set up our sorting queue, this also grows when needed */
+	this->openlist_queue.Reserve(num_buckets);
 }
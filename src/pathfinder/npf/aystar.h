@@ -17,8 +17,6 @@
 #define AYSTAR_H
 
 #include "queue.h"
-#include <unordered_map>
-#include <memory>
 
 #include "../../tile_type.h"
 #include "../../track_type.h"
@@ -57,6 +55,7 @@ struct PathNode {
  */
 struct OpenListNode {
 	int g;
+	uint heap_index; ///< Position of this node in #AyStar::openlist_queue.
 	PathNode path;
 };
 
@@ -168,9 +167,9 @@ struct AyStar {
 	void CheckTile(AyStarNode *current, OpenListNode *parent);
 
 protected:
-	std::unordered_map<std::pair<TileIndex, Trackdir>, PathNode*, PairHash> closedlist_hash;
-	BinaryHeap openlist_queue;  ///< The open queue.
-	std::unordered_map<std::pair<TileIndex, Trackdir>, OpenListNode*, PairHash> openlist_hash;
+	NodeHash<PathNode> closedlist_hash;         ///< The closed list.
+	IndexedHeap<OpenListNode> openlist_queue;  ///< The open queue.
+	NodeHash<OpenListNode> openlist_hash;      ///< The open list, for looking up nodes in #openlist_queue.
 
 	void OpenListAdd(PathNode *parent, const AyStarNode *node, int f, int g);
 	OpenListNode *OpenListIsInList(const AyStarNode *node);
@@ -5,105 +5,295 @@
  * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
  */
 
-/** @file queue.h Binary heap implementation, hash implementation. */
+/** @file queue.h Indexed d-ary heap and open addressing node hash, used by %AyStar. */
 
 #ifndef QUEUE_H
 #define QUEUE_H
 
-//#define HASH_STATS
+#include "../../tile_type.h"
+#include "../../track_type.h"
+#include <algorithm>
+#include <vector>
 
+/**
+ * Flat d-ary min-heap of item pointers, with decrease-key support.
+ * Each item stores its own position in the heap in its \c heap_index field,
+ * so updating the priority of a queued item does not need to search the heap.
+ * Of items with equal priority the most recently pushed or updated one is popped first.
+ * @tparam T Item type, must have a \c uint \c heap_index member.
+ * @tparam D Number of children of each heap node.
+ */
+template <typename T, uint D = 4>
+class IndexedHeap {
+	struct Node {
+		int priority;
+		T *item;
+	};
 
-struct BinaryHeapNode {
-	void *item;
-	int priority;
-};
+	std::vector<Node> elements;
 
+	inline void Place(uint index, const Node &node)
+	{
+		this->elements[index] = node;
+		node.item->heap_index = index;
+	}
 
-/**
- * Binary Heap.
- * For information, see: http://www.policyalmanac.org/games/binaryHeaps.htm
- */
-struct BinaryHeap {
-	static const int BINARY_HEAP_BLOCKSIZE;
-	static const int BINARY_HEAP_BLOCKSIZE_BITS;
-	static const int BINARY_HEAP_BLOCKSIZE_MASK;
+	void SiftUp(uint index)
+	{
+		Node node = this->elements[index];
+		while (index > 0) {
+			uint parent = (index - 1) / D;
+			if (this->elements[parent].priority < node.priority) break;
+			this->Place(index, this->elements[parent]);
+			index = parent;
+		}
+		this->Place(index, node);
+	}
 
-	void Init(uint max_size);
+	void SiftDown(uint index)
+	{
+		Node node = this->elements[index];
+		const uint size = (uint)this->elements.size();
+		for (;;) {
+			uint first = index * D + 1;
+			if (first >= size) break;
+			uint last = std::min(first + D, size);
+			uint best = first;
+			for (uint child = first + 1; child < last; child++) {
+				if (this->elements[child].priority < this->elements[best].priority) best = child;
+			}
+			if (this->elements[best].priority > node.priority) break;
+			this->Place(index, this->elements[best]);
+			index = best;
+		}
+		this->Place(index, node);
+	}
+
+public:
+	/**
+	 * Reserve space for a number of items.
+	 * @param size Number of items.
+	 */
+	inline void Reserve(uint size) { this->elements.reserve(size); }
 
-	bool Push(void *item, int priority);
-	void *Pop();
-	bool Delete(void *item, int priority);
-	void Clear(bool free_values);
-	void Free(bool free_values);
+	/** Get the number of queued items. */
+	inline uint Size() const { return (uint)this->elements.size(); }
 
 	/**
-	 * Get an element from the #elements.
-	 * @param i Element to access (starts at offset \c 1).
-	 * @return Value of the element.
+	 * Add an item to the heap.
+	 * @param item Item to add, must not already be in the heap.
+	 * @param priority Priority of the item, lower priorities are popped first.
 	 */
-	inline BinaryHeapNode &GetElement(uint i)
+	void Push(T *item, int priority)
 	{
-		assert(i > 0);
-		return this->elements[(i - 1) >> BINARY_HEAP_BLOCKSIZE_BITS][(i - 1) & BINARY_HEAP_BLOCKSIZE_MASK];
+		this->elements.push_back({ priority, item });
+		this->SiftUp((uint)this->elements.size() - 1);
 	}
 
-	uint max_size;
-	uint size;
-	uint blocks; ///< The amount of blocks for which space is reserved in elements
-	BinaryHeapNode **elements;
-};
+	/**
+	 * Change the priority of an item which is queued in the heap.
+	 * @param item Item to update.
+	 * @param priority New priority of the item.
+	 */
+	void Update(T *item, int priority)
+	{
+		uint index = item->heap_index;
+		assert(index < this->elements.size() && this->elements[index].item == item);
+		int old_priority = this->elements[index].priority;
+		this->elements[index].priority = priority;
+		if (priority <= old_priority) {
+			this->SiftUp(index);
+		} else {
+			this->SiftDown(index);
+		}
+	}
 
+	/**
+	 * Remove the item with the lowest priority from the heap.
+	 * @return The removed item, or \c nullptr if the heap is empty.
+	 */
+	T *Pop()
+	{
+		if (this->elements.empty()) return nullptr;
+		T *result = this->elements.front().item;
+		Node last = this->elements.back();
+		this->elements.pop_back();
+		if (!this->elements.empty()) {
+			this->elements.front() = last;
+			this->SiftDown(0);
+		}
+		return result;
+	}
 
-/*
- * Hash
- */
-struct HashNode {
-	uint key1;
-	uint key2;
-	void *value;
-	HashNode *next;
+	/** Remove all items from the heap, the items themselves are not freed. */
+	inline void Clear() { this->elements.clear(); }
+
+	/** Remove all items from the heap and release its memory. */
+	inline void Free()
+	{
+		this->elements.clear();
+		this->elements.shrink_to_fit();
+	}
 };
+
 /**
- * Generates a hash code from the given key pair. You should make sure that
- * the resulting range is clearly defined.
+ * Open addressing (linear probing) hash table mapping a (tile, trackdir) pair to a node pointer.
+ * Slots with a \c nullptr value are empty, so \c nullptr can not be stored.
+ * @tparam T Type of the nodes.
  */
-typedef uint Hash_HashProc(uint key1, uint key2);
-struct Hash {
-	/* The hash function used */
-	Hash_HashProc *hash;
-	/* The amount of items in the hash */
-	uint size;
-	/* The number of buckets allocated */
-	uint num_buckets;
-	/* A pointer to an array of num_buckets buckets. */
-	HashNode *buckets;
-	/* A pointer to an array of numbuckets booleans, which will be true if
-	 * there are any Nodes in the bucket */
-	bool *buckets_in_use;
-
-	void Init(Hash_HashProc *hash, uint num_buckets);
-
-	void *Get(uint key1, uint key2) const;
-	void *Set(uint key1, uint key2, void *value);
-
-	void *DeleteValue(uint key1, uint key2);
-
-	void Clear(bool free_values);
-	void Delete(bool free_values);
+template <typename T>
+class NodeHash {
+	struct Slot {
+		TileIndex tile;
+		Trackdir direction;
+		T *value;
+	};
+
+	std::vector<Slot> slots;
+	uint count = 0;
+	uint mask = 0;
+
+	inline uint Bucket(TileIndex tile, Trackdir direction) const
+	{
+		uint32 key = (tile << 4) ^ (uint32)direction ^ (tile >> 28);
+		return (uint)((key * 0x9E3779B1U) >> 8) & this->mask;
+	}
+
+	void Grow()
+	{
+		std::vector<Slot> old_slots;
+		old_slots.swap(this->slots);
+		this->Resize((uint)old_slots.size() * 2);
+		for (const Slot &slot : old_slots) {
+			if (slot.value != nullptr) this->Insert(slot.tile, slot.direction, slot.value);
+		}
+	}
+
+	void Resize(uint size)
+	{
+		this->slots.assign(size, Slot{ 0, INVALID_TRACKDIR, nullptr });
+		this->mask = size - 1;
+		this->count = 0;
+	}
+
+	void Insert(TileIndex tile, Trackdir direction, T *value)
+	{
+		uint i = this->Bucket(tile, direction);
+		while (this->slots[i].value != nullptr) i = (i + 1) & this->mask;
+		this->slots[i] = { tile, direction, value };
+		this->count++;
+	}
+
+public:
+	/**
+	 * Set up the table for a number of items.
+	 * @param num_buckets Expected number of items, rounded up to a power of two.
+	 */
+	void Init(uint num_buckets)
+	{
+		uint size = 16;
+		while (size < num_buckets * 2) size <<= 1;
+		this->Resize(size);
+	}
+
+	/** Get the number of stored items. */
+	inline uint Size() const { return this->count; }
+
+	/**
+	 * Look up a node.
+	 * @param tile Tile of the node.
+	 * @param direction Trackdir of the node.
+	 * @return The stored node, or \c nullptr if there is none.
+	 */
+	T *Find(TileIndex tile, Trackdir direction) const
+	{
+		if (this->slots.empty()) return nullptr;
+		for (uint i = this->Bucket(tile, direction);; i = (i + 1) & this->mask) {
+			const Slot &slot = this->slots[i];
+			if (slot.value == nullptr) return nullptr;
+			if (slot.tile == tile && slot.direction == direction) return slot.value;
+		}
+	}
 
 	/**
-	 * Gets the current size of the hash.
+	 * Store a node, replacing any existing value for its key.
+	 * @param tile Tile of the node.
+	 * @param direction Trackdir of the node.
+	 * @param value Node to store, not \c nullptr.
 	 */
-	inline uint GetSize() const
+	void Set(TileIndex tile, Trackdir direction, T *value)
 	{
-		return this->size;
+		assert(value != nullptr);
+		if (this->slots.empty()) this->Init(0);
+		for (uint i = this->Bucket(tile, direction);; i = (i + 1) & this->mask) {
+			Slot &slot = this->slots[i];
+			if (slot.value == nullptr) break;
+			if (slot.tile == tile && slot.direction == direction) {
+				slot.value = value;
+				return;
+			}
+		}
+		if ((this->count + 1) * 2 > this->slots.size()) this->Grow();
+		this->Insert(tile, direction, value);
 	}
 
-protected:
-#ifdef HASH_STATS
-	void PrintStatistics() const;
-#endif
-	HashNode *FindNode(uint key1, uint key2, HashNode** prev_out) const;
+	/**
+	 * Remove a node, if present.
+	 * Following entries of the probe sequence are shifted back, so no tombstones are left behind.
+	 * @param tile Tile of the node.
+	 * @param direction Trackdir of the node.
+	 */
+	void Erase(TileIndex tile, Trackdir direction)
+	{
+		if (this->slots.empty()) return;
+		uint i = this->Bucket(tile, direction);
+		for (;; i = (i + 1) & this->mask) {
+			const Slot &slot = this->slots[i];
+			if (slot.value == nullptr) return;
+			if (slot.tile == tile && slot.direction == direction) break;
+		}
+		this->count--;
+		uint hole = i;
+		for (uint j = (i + 1) & this->mask; this->slots[j].value != nullptr; j = (j + 1) & this->mask) {
+			uint home = this->Bucket(this->slots[j].tile, this->slots[j].direction);
+			/* Move the entry into the hole, unless its home bucket lies cyclically within (hole, j] */
+			if (((j - home) & this->mask) >= ((j - hole) & this->mask)) {
+				this->slots[hole] = this->slots[j];
+				hole = j;
+			}
+		}
+		this->slots[hole].value = nullptr;
+	}
+
+	/**
+	 * Call a function for every stored node.
+	 * @param func Function to call with each node.
+	 */
+	template <typename F>
+	void ForEach(F func) const
+	{
+		if (this->count == 0) return;
+		for (const Slot &slot : this->slots) {
+			if (slot.value != nullptr) func(slot.value);
+		}
+	}
+
+	/** Remove all nodes, keeping the allocated table. The nodes themselves are not freed. */
+	void Clear()
+	{
+		if (this->count == 0) return;
+		for (Slot &slot : this->slots) slot.value = nullptr;
+		this->count = 0;
+	}
+
+	/** Remove all nodes and release the table. The nodes themselves are not freed. */
+	void Free()
+	{
+		this->slots.clear();
+		this->slots.shrink_to_fit();
+		this->count = 0;
+		this->mask = 0;
+	}
 };
 
 #endif /* QUEUE_H */
@@ -0,0 +1,401 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @file water_regions.cpp Handling of water regions, for hierarchical ship pathfinding.
+ *
+ * The map is divided into square regions of WATER_REGION_EDGE_LENGTH tiles. The water tiles of each region
+ * are grouped into patches: sets of tiles which are connected to each other by water tracks within the region.
+ * Patches of neighbouring regions are connected where a water track crosses the region edge, and by aqueducts.
+ *
+ * A search over this graph of patches finds the sequence of regions a ship should pass through, and the
+ * tile based ship pathfinder is then restricted to those regions and their neighbours.
+ *
+ * Region data is computed on demand and kept between searches. It is a pure function of the map contents
+ * of the region (plus the row and column beyond it, which affect tile slopes). A hash of these map contents
+ * is stored with the data and checked once per search, so any change to the map is picked up without needing
+ * to be notified of it, and the result never depends on which regions happened to be cached already.
+ */
+
+#include "../stdafx.h"
+#include "water_regions.h"
+#include "../map_func.h"
+#include "../tile_cmd.h"
+#include "../track_func.h"
+#include "../tunnelbridge_map.h"
+
+#include <memory>
+#include <queue>
+#include <unordered_map>
+
+#include "../safeguards.h"
+
+/** Patch in a water region: region index in the upper bits, 1-based patch label in the lower 8 bits. */
+typedef uint32 WaterRegionPatchKey;
+
+/** Maximum number of patch nodes the region search may expand, before giving up. */
+static const uint MAX_WATER_REGION_SEARCH_NODES = 1 << 16;
+
+/** Data of one water region. */
+struct WaterRegionData {
+	uint64 hash = 0;                ///< Hash of the map contents which the data was calculated from.
+	uint32 validated_search = 0;    ///< Search counter value when the hash was last checked.
+	bool initialised = false;       ///< Whether the data has been calculated at all.
+	bool too_complex = false;       ///< The region has more patches than fit in a label, it can't be used.
+	uint8 labels[WATER_REGION_NUMBER_OF_TILES];                  ///< Patch label of each tile, 0 for tiles without water tracks.
+	uint8 edge_labels[DIAGDIR_END][WATER_REGION_EDGE_LENGTH];    ///< Patch label of each tile on each edge which has a track crossing that edge, otherwise 0.
+	std::vector<uint8> aqueduct_heads; ///< Tile offsets of aqueduct heads whose other end is in another region.
+};
+
+static std::vector<std::unique_ptr<WaterRegionData>> _water_regions;
+static uint32 _water_region_search_counter = 0;
+
+static inline uint GetWaterRegionMapSizeX()
+{
+	return MapSizeX() / WATER_REGION_EDGE_LENGTH;
+}
+
+static inline uint GetWaterRegionMapSizeY()
+{
+	return MapSizeY() / WATER_REGION_EDGE_LENGTH;
+}
+
+static inline uint GetWaterRegionIndex(uint rx, uint ry)
+{
+	return ry * GetWaterRegionMapSizeX() + rx;
+}
+
+static inline uint GetWaterRegionIndex(TileIndex tile)
+{
+	return GetWaterRegionIndex(TileX(tile) / WATER_REGION_EDGE_LENGTH, TileY(tile) / WATER_REGION_EDGE_LENGTH);
+}
+
+static inline uint GetWaterRegionTileOffset(TileIndex tile)
+{
+	return (TileY(tile) % WATER_REGION_EDGE_LENGTH) * WATER_REGION_EDGE_LENGTH + (TileX(tile) % WATER_REGION_EDGE_LENGTH);
+}
+
+static inline TileIndex GetWaterRegionTile(uint rx, uint ry, uint offset)
+{
+	return TileXY(rx * WATER_REGION_EDGE_LENGTH + (offset % WATER_REGION_EDGE_LENGTH), ry * WATER_REGION_EDGE_LENGTH + (offset / WATER_REGION_EDGE_LENGTH));
+}
+
+/** Get the tile offset within a region of edge position @p pos on the edge in direction @p dir. */
+static inline uint GetWaterRegionEdgeTileOffset(DiagDirection dir, uint pos)
+{
+	const uint last = WATER_REGION_EDGE_LENGTH - 1;
+	switch (dir) {
+		case DIAGDIR_NE: return pos * WATER_REGION_EDGE_LENGTH;
+		case DIAGDIR_SE: return last * WATER_REGION_EDGE_LENGTH + pos;
+		case DIAGDIR_SW: return pos * WATER_REGION_EDGE_LENGTH + last;
+		case DIAGDIR_NW: return pos;
+		default: NOT_REACHED();
+	}
+}
+
+/**
+ * Hash the map contents which the data of a region depends on.
+ * This includes the row and column beyond the region as the slope of a tile depends on the heights of its neighbours.
+ */
+static uint64 CalculateWaterRegionHash(uint rx, uint ry)
+{
+	const uint x0 = rx * WATER_REGION_EDGE_LENGTH;
+	const uint y0 = ry * WATER_REGION_EDGE_LENGTH;
+	const uint x1 = std::min(x0 + WATER_REGION_EDGE_LENGTH, MapMaxX());
+	const uint y1 = std::min(y0 + WATER_REGION_EDGE_LENGTH, MapMaxY());
+
+	uint64 hash = 0;
+	for (uint y = y0; y <= y1; y++) {
+		for (uint x = x0; x <= x1; x++) {
+			const TileIndex t = TileXY(x, y);
+			const TileTypeHeight &mth = _mth[t];
+			const Tile &m = _m[t];
+			const TileExtended &me = _me[t];
+			uint64 v = (uint64)mth.type | ((uint64)mth.height << 8) | ((uint64)m.m2 << 16) | ((uint64)m.m1 << 32) |
+					((uint64)m.m3 << 40) | ((uint64)m.m4 << 48) | ((uint64)m.m5 << 56);
+			uint64 e = (uint64)me.m6 | ((uint64)me.m7 << 8) | ((uint64)me.m8 << 16);
+			hash = (hash ^ v) * 0x9E3779B97F4A7C15ULL;
+			hash = (hash ^ e ^ (hash >> 31)) * 0xBF58476D1CE4E5B9ULL;
+		}
+	}
+	return hash;
+}
+
+/** Get the tile sides which water tracks of a tile cross, as a bitmask of DiagDirection. */
+static uint8 GetWaterTileSides(TileIndex tile)
+{
+	TrackBits tracks = TrackStatusToTrackBits(GetTileTrackStatus(tile, TRANSPORT_WATER, 0));
+	if (tracks == TRACK_BIT_NONE) return 0;
+
+	uint8 sides = 0;
+	if (tracks & TRACK_BIT_3WAY_NE) SetBit(sides, DIAGDIR_NE);
+	if (tracks & TRACK_BIT_3WAY_SE) SetBit(sides, DIAGDIR_SE);
+	if (tracks & TRACK_BIT_3WAY_SW) SetBit(sides, DIAGDIR_SW);
+	if (tracks & TRACK_BIT_3WAY_NW) SetBit(sides, DIAGDIR_NW);
+
+	/* Aqueduct heads can't be left towards the tiles under the aqueduct */
+	if (IsTileType(tile, MP_TUNNELBRIDGE)) ClrBit(sides, GetTunnelBridgeDirection(tile));
+	return sides;
+}
+
+/** (Re)calculate the patches of a region. */
+static void UpdateWaterRegion(WaterRegionData &region, uint rx, uint ry)
+{
+	uint8 sides[WATER_REGION_NUMBER_OF_TILES];
+	for (uint offset = 0; offset < WATER_REGION_NUMBER_OF_TILES; offset++) {
+		sides[offset] = GetWaterTileSides(GetWaterRegionTile(rx, ry, offset));
+	}
+
+	std::fill(std::begin(region.labels), std::end(region.labels), 0);
+	region.aqueduct_heads.clear();
+	region.too_complex = false;
+
+	uint16 stack[WATER_REGION_NUMBER_OF_TILES];
+	uint label = 0;
+	for (uint start = 0; start < WATER_REGION_NUMBER_OF_TILES; start++) {
+		if (sides[start] == 0 || region.labels[start] != 0) continue;
+		if (label == UINT8_MAX) {
+			region.too_complex = true;
+			return;
+		}
+
+		label++;
+		uint stack_size = 0;
+		region.labels[start] = label;
+		stack[stack_size++] = start;
+		while (stack_size > 0) {
+			const uint cur = stack[--stack_size];
+			const uint cx = cur % WATER_REGION_EDGE_LENGTH;
+			const uint cy = cur / WATER_REGION_EDGE_LENGTH;
+			for (DiagDirection dir = DIAGDIR_BEGIN; dir < DIAGDIR_END; dir++) {
+				if (!HasBit(sides[cur], dir)) continue;
+				const TileIndexDiffC diff = TileIndexDiffCByDiagDir(dir);
+				const uint nx = cx + diff.x;
+				const uint ny = cy + diff.y;
+				if (nx >= WATER_REGION_EDGE_LENGTH || ny >= WATER_REGION_EDGE_LENGTH) continue; // other region, or wrapped around below zero
+				const uint next = ny * WATER_REGION_EDGE_LENGTH + nx;
+				if (region.labels[next] == 0 && HasBit(sides[next], ReverseDiagDir(dir))) {
+					region.labels[next] = label;
+					stack[stack_size++] = next;
+				}
+			}
+
+			const TileIndex tile = GetWaterRegionTile(rx, ry, cur);
+			if (IsTileType(tile, MP_TUNNELBRIDGE)) {
+				const TileIndex other = GetOtherTunnelBridgeEnd(tile);
+				if (GetWaterRegionIndex(other) == GetWaterRegionIndex(rx, ry)) {
+					const uint other_offset = GetWaterRegionTileOffset(other);
+					if (region.labels[other_offset] == 0 && sides[other_offset] != 0) {
+						region.labels[other_offset] = label;
+						stack[stack_size++] = other_offset;
+					}
+				} else {
+					region.aqueduct_heads.push_back(cur);
+				}
+			}
+		}
+	}
+
+	for (DiagDirection dir = DIAGDIR_BEGIN; dir < DIAGDIR_END; dir++) {
+		for (uint pos = 0; pos < WATER_REGION_EDGE_LENGTH; pos++) {
+			const uint offset = GetWaterRegionEdgeTileOffset(dir, pos);
+			region.edge_labels[dir][pos] = HasBit(sides[offset], dir) ? region.labels[offset] : 0;
+		}
+	}
+}
+
+/** Get the data of a region, recalculating it if the map contents of the region have changed. */
+static const WaterRegionData &GetWaterRegion(uint rx, uint ry)
+{
+	std::unique_ptr<WaterRegionData> &ptr = _water_regions[GetWaterRegionIndex(rx, ry)];
+	if (!ptr) ptr.reset(new WaterRegionData());
+	WaterRegionData &region = *ptr;
+	if (region.validated_search != _water_region_search_counter) {
+		region.validated_search = _water_region_search_counter;
+		const uint64 hash = CalculateWaterRegionHash(rx, ry);
+		if (!region.initialised || hash != region.hash) {
+			UpdateWaterRegion(region, rx, ry);
+			region.hash = hash;
+			region.initialised = true;
+		}
+	}
+	return region;
+}
+
+/** Start a new region search, such that the hash of each region is checked again once. */
+static void BeginWaterRegionSearch()
+{
+	const size_t count = (size_t)GetWaterRegionMapSizeX() * GetWaterRegionMapSizeY();
+	if (_water_regions.size() != count) {
+		_water_regions.clear();
+		_water_regions.resize(count);
+	}
+
+	_water_region_search_counter++;
+	if (_water_region_search_counter == 0) {
+		for (std::unique_ptr<WaterRegionData> &region : _water_regions) {
+			if (region) region->validated_search = 0;
+		}
+		_water_region_search_counter = 1;
+	}
+}
+
+void WaterRegionCorridor::Reset(uint region_count)
+{
+	this->regions.assign(region_count, false);
+}
+
+void WaterRegionCorridor::Include(uint region_index)
+{
+	this->regions[region_index] = true;
+}
+
+/**
+ * Check whether a tile is within the corridor.
+ * @param tile Tile to check.
+ * @return true if the tile is in one of the regions of the corridor.
+ */
+bool WaterRegionCorridor::Contains(TileIndex tile) const
+{
+	return this->regions[GetWaterRegionIndex(tile)];
+}
+
+/**
+ * Find the regions a ship should pass through to get from @p origin to any of @p destinations.
+ * @param origin Origin tile.
+ * @param destinations Destination tiles.
+ * @param[out] corridor Set to the regions along the found route and their neighbours.
+ * @return true if a route was found and the corridor was set.
+ *         false if there is no route, or the route could not be determined, in which case the search should not be restricted.
+ */
+bool FindWaterRegionCorridor(TileIndex origin, const std::vector<TileIndex> &destinations, WaterRegionCorridor &corridor)
+{
+	if (destinations.empty()) return false;
+
+	BeginWaterRegionSearch();
+
+	const uint size_x = GetWaterRegionMapSizeX();
+	const uint size_y = GetWaterRegionMapSizeY();
+	bool too_complex = false;
+
+	auto get_patch = [&](TileIndex tile) -> WaterRegionPatchKey {
+		const uint rx = TileX(tile) / WATER_REGION_EDGE_LENGTH;
+		const uint ry = TileY(tile) / WATER_REGION_EDGE_LENGTH;
+		const WaterRegionData &region = GetWaterRegion(rx, ry);
+		if (region.too_complex) {
+			too_complex = true;
+			return 0;
+		}
+		const uint label = region.labels[GetWaterRegionTileOffset(tile)];
+		if (label == 0) return 0;
+		return (GetWaterRegionIndex(rx, ry) << 8) | label;
+	};
+
+	const WaterRegionPatchKey origin_patch = get_patch(origin);
+	if (origin_patch == 0) return false;
+
+	std::vector<WaterRegionPatchKey> dest_patches;
+	std::vector<std::pair<uint, uint>> dest_regions;
+	for (TileIndex tile : destinations) {
+		const WaterRegionPatchKey patch = get_patch(tile);
+		if (too_complex) return false;
+		if (patch == 0) continue;
+		if (patch == origin_patch) return false; // nothing to restrict
+		dest_patches.push_back(patch);
+		dest_regions.emplace_back(TileX(tile) / WATER_REGION_EDGE_LENGTH, TileY(tile) / WATER_REGION_EDGE_LENGTH);
+	}
+	if (dest_patches.empty()) return false;
+	std::sort(dest_patches.begin(), dest_patches.end());
+
+	auto estimate = [&](uint rx, uint ry) -> uint {
+		uint best = UINT_MAX;
+		for (const auto &it : dest_regions) {
+			best = std::min<uint>(best, Delta(rx, it.first) + Delta(ry, it.second));
+		}
+		return best;
+	};
+
+	struct NodeInfo {
+		uint32 cost;
+		WaterRegionPatchKey parent;
+	};
+	std::unordered_map<WaterRegionPatchKey, NodeInfo> nodes;
+
+	/* Open list items are (estimated total cost << 32 | patch), so that ties are broken by patch key */
+	std::priority_queue<uint64, std::vector<uint64>, std::greater<uint64>> open;
+
+	auto add_node = [&](WaterRegionPatchKey patch, WaterRegionPatchKey parent, uint32 cost) {
+		auto it = nodes.find(patch);
+		if (it != nodes.end() && it->second.cost <= cost) return;
+		nodes[patch] = { cost, parent };
+		const uint region_index = patch >> 8;
+		const uint64 total = (uint64)cost + estimate(region_index % size_x, region_index / size_x);
+		open.push((total << 32) | patch);
+	};
+
+	add_node(origin_patch, 0, 0);
+
+	uint expanded = 0;
+	while (!open.empty()) {
+		const uint64 item = open.top();
+		open.pop();
+		const WaterRegionPatchKey patch = (WaterRegionPatchKey)(item & 0xFFFFFFFF);
+		const uint region_index = patch >> 8;
+		const uint rx = region_index % size_x;
+		const uint ry = region_index / size_x;
+		const uint32 cost = nodes[patch].cost;
+		if ((item >> 32) != (uint64)cost + estimate(rx, ry)) continue; // superseded by a cheaper entry
+
+		if (std::binary_search(dest_patches.begin(), dest_patches.end(), patch)) {
+			corridor.Reset(size_x * size_y);
+			for (WaterRegionPatchKey p = patch; p != 0; p = nodes[p].parent) {
+				const uint index = p >> 8;
+				const uint px = index % size_x;
+				const uint py = index / size_x;
+				for (uint y = (py > 0 ? py - 1 : 0); y <= std::min(py + 1, size_y - 1); y++) {
+					for (uint x = (px > 0 ? px - 1 : 0); x <= std::min(px + 1, size_x - 1); x++) {
+						corridor.Include(GetWaterRegionIndex(x, y));
+					}
+				}
+			}
+			return true;
+		}
+
+		if (++expanded > MAX_WATER_REGION_SEARCH_NODES) return false;
+
+		const uint label = patch & 0xFF;
+		const WaterRegionData &region = GetWaterRegion(rx, ry);
+
+		for (DiagDirection dir = DIAGDIR_BEGIN; dir < DIAGDIR_END; dir++) {
+			const TileIndexDiffC diff = TileIndexDiffCByDiagDir(dir);
+			const uint nx = rx + diff.x;
+			const uint ny = ry + diff.y;
+			if (nx >= size_x || ny >= size_y) continue;
+
+			const WaterRegionData &neighbour = GetWaterRegion(nx, ny);
+			if (neighbour.too_complex) return false;
+			const DiagDirection reverse = ReverseDiagDir(dir);
+			for (uint pos = 0; pos < WATER_REGION_EDGE_LENGTH; pos++) {
+				if (region.edge_labels[dir][pos] != label) continue;
+				const uint neighbour_label = neighbour.edge_labels[reverse][pos];
+				if (neighbour_label != 0) add_node((GetWaterRegionIndex(nx, ny) << 8) | neighbour_label, patch, cost + 1);
+			}
+		}
+
+		for (uint8 offset : region.aqueduct_heads) {
+			if (region.labels[offset] != label) continue;
+			const TileIndex other = GetOtherTunnelBridgeEnd(GetWaterRegionTile(rx, ry, offset));
+			const WaterRegionPatchKey other_patch = get_patch(other);
+			if (too_complex) return false;
+			if (other_patch == 0) continue;
+			const uint other_index = other_patch >> 8;
+			add_node(other_patch, patch, cost + Delta(rx, other_index % size_x) + Delta(ry, other_index / size_x));
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,40 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file water_regions.h Handling of water regions, for hierarchical ship pathfinding. */
+
+#ifndef WATER_REGIONS_H
+#define WATER_REGIONS_H
+
+#include "../tile_type.h"
+#include <vector>
+
+/** Length of the side of a (square) water region, in tiles. */
+static const uint WATER_REGION_EDGE_LENGTH = 16;
+
+/** Number of tiles in a water region. */
+static const uint WATER_REGION_NUMBER_OF_TILES = WATER_REGION_EDGE_LENGTH * WATER_REGION_EDGE_LENGTH;
+
+/**
+ * Set of water regions which a ship path search is restricted to.
+ * An invalid (default constructed) corridor does not restrict anything.
+ */
+class WaterRegionCorridor {
+	std::vector<bool> regions;
+
+public:
+	/** Whether this corridor restricts a search. */
+	bool IsValid() const { return !this->regions.empty(); }
+
+	void Reset(uint region_count);
+	void Include(uint region_index);
+	bool Contains(TileIndex tile) const;
+};
+
+bool FindWaterRegionCorridor(TileIndex origin, const std::vector<TileIndex> &destinations, WaterRegionCorridor &corridor);
+
+#endif /* WATER_REGIONS_H */
@@ -13,6 +13,113 @@
 #include "../../misc/array.hpp"
 #include "../../misc/hashtable.hpp"
 #include "../../misc/binaryheap.hpp"
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Node storage for CNodeList_HashTableT.
+ *  Items are stored in fixed size blocks, so item addresses are stable.
+ *  Clearing keeps all blocks allocated, and cleared arenas are kept in a per-thread
+ *  free list, so that consecutive searches reuse the same memory, up to the
+ *  largest number of nodes used by any search so far.
+ */
+template <class T>
+class CNodeArenaT {
+	static const uint BLOCK_BITS = 12;
+	static const uint BLOCK_SIZE = 1 << BLOCK_BITS;
+
+	struct Block {
+		alignas(T) byte data[BLOCK_SIZE * sizeof(T)];
+	};
+
+	std::vector<std::unique_ptr<Block>> m_blocks;
+	uint m_length = 0;
+
+	inline T *ItemPtr(uint index) const
+	{
+		return reinterpret_cast<T *>(m_blocks[index >> BLOCK_BITS]->data) + (index & (BLOCK_SIZE - 1));
+	}
+
+	static std::vector<std::unique_ptr<CNodeArenaT>> &FreeList()
+	{
+		static thread_local std::vector<std::unique_ptr<CNodeArenaT>> free_list;
+		return free_list;
+	}
+
+public:
+	/** Take a cleared arena from the free list of this thread, or create a new one. */
+	static std::unique_ptr<CNodeArenaT> Acquire()
+	{
+		std::vector<std::unique_ptr<CNodeArenaT>> &free_list = FreeList();
+		if (free_list.empty()) return std::unique_ptr<CNodeArenaT>(new CNodeArenaT());
+		std::unique_ptr<CNodeArenaT> arena = std::move(free_list.back());
+		free_list.pop_back();
+		return arena;
+	}
+
+	/** Clear an arena and return it to the free list of this thread. */
+	static void Release(std::unique_ptr<CNodeArenaT> arena)
+	{
+		arena->Clear();
+		FreeList().push_back(std::move(arena));
+	}
+
+	~CNodeArenaT()
+	{
+		Clear();
+	}
+
+	/** Destroy all items, keeping the storage. This is O(1) for trivially destructible items. */
+	inline void Clear()
+	{
+		if (!std::is_trivially_destructible<T>::value) {
+			for (uint i = 0; i < m_length; i++) ItemPtr(i)->~T();
+		}
+		m_length = 0;
+	}
+
+	/** Return actual number of items */
+	inline uint Length() const
+	{
+		return m_length;
+	}
+
+	/** allocate and construct new item using default constructor */
+	inline T *AppendC()
+	{
+		if ((m_length >> BLOCK_BITS) == m_blocks.size()) m_blocks.emplace_back(new Block());
+		T *item = ItemPtr(m_length++);
+		new (item) T;
+		return item;
+	}
+
+	inline T &operator[](uint index)
+	{
+		assert(index < m_length);
+		return *ItemPtr(index);
+	}
+
+	inline const T &operator[](uint index) const
+	{
+		assert(index < m_length);
+		return *ItemPtr(index);
+	}
+
+	/**
+	 * Helper for creating a human readable output of this data.
+	 * @param dmp The location to dump to.
+	 */
+	template <typename D> void Dump(D &dmp) const
+	{
+		dmp.WriteValue("num_items", m_length);
+		for (uint i = 0; i < m_length; i++) {
+			char name[32];
+			seprintf(name, lastof(name), "item[%d]", i);
+			dmp.WriteStructT(name, &(*this)[i]);
+		}
+	}
+};
 
 /**
  * Hash table based node list multi-container class.
@@ -24,13 +131,13 @@ class CNodeList_HashTableT {
 public:
 	typedef Titem_ Titem;                                        ///< Make #Titem_ visible from outside of class.
 	typedef typename Titem_::Key Key;                            ///< Make Titem_::Key a property of this class.
-	typedef SmallArray<Titem_, 65536, 256> CItemArray;           ///< Type that we will use as item container.
+	typedef CNodeArenaT<Titem_> CItemArray;                      ///< Type that we will use as item container.
 	typedef CHashTableT<Titem_, Thash_bits_open_  > COpenList;   ///< How pointers to open nodes will be stored.
 	typedef CHashTableT<Titem_, Thash_bits_closed_> CClosedList; ///< How pointers to closed nodes will be stored.
 	typedef CBinaryHeapT<Titem_> CPriorityQueue;                 ///< How the priority queue will be managed.
 
 protected:
-	CItemArray      m_arr;        ///< Here we store full item data (Titem_).
+	std::unique_ptr<CItemArray> m_arr; ///< Here we store full item data (Titem_), this is reused between searches.
 	COpenList       m_open;       ///< Hash table of pointers to open item data.
 	CClosedList     m_closed;     ///< Hash table of pointers to closed item data.
 	CPriorityQueue  m_open_queue; ///< Priority queue of pointers to open item data.
@@ -38,7 +145,7 @@ protected:
 
 public:
 	/** default constructor */
-	CNodeList_HashTableT() : m_open_queue(2048)
+	CNodeList_HashTableT() : m_arr(CItemArray::Acquire()), m_open_queue(2048)
 	{
 		m_new_node = nullptr;
 	}
@@ -46,6 +153,7 @@ public:
 	/** destructor */
 	~CNodeList_HashTableT()
 	{
+		CItemArray::Release(std::move(m_arr));
 	}
 
 	/** return number of open nodes */
@@ -63,7 +171,7 @@ public:
 	/** allocate new data item from m_arr */
 	inline Titem_ *CreateNewNode()
 	{
-		if (m_new_node == nullptr) m_new_node = m_arr.AppendC();
+		if (m_new_node == nullptr) m_new_node = m_arr->AppendC();
 		return m_new_node;
 	}
 
@@ -157,19 +265,19 @@ public:
 	/** The number of items. */
 	inline int TotalCount()
 	{
-		return m_arr.Length();
+		return m_arr->Length();
 	}
 
 	/** Get a particular item. */
 	inline Titem_& ItemAt(int idx)
 	{
-		return m_arr[idx];
+		return (*m_arr)[idx];
 	}
 
 	/** Helper for creating output of this array. */
 	template <class D> void Dump(D &dmp) const
 	{
-		dmp.WriteStructT("m_arr", &m_arr);
+		dmp.WriteStructT("m_arr", m_arr.get());
 	}
 };
 
@@ -99,10 +99,15 @@ public:
  */
 struct CSegmentCostCacheBase
 {
-	static int   s_rail_change_counter;
+	/** number of recent track layout changes which are remembered for partial cache invalidation */
+	static const uint CHANGE_LOG_SIZE = 64;
+
+	static uint32    s_rail_change_counter;
+	static TileIndex s_rail_change_log[CHANGE_LOG_SIZE]; ///< tiles of the most recent changes, indexed by counter value, INVALID_TILE for a change which affects all tiles
 
 	static void NotifyTrackLayoutChange(TileIndex tile, Track track)
 	{
+		s_rail_change_log[s_rail_change_counter % CHANGE_LOG_SIZE] = tile;
 		s_rail_change_counter++;
 	}
 };
@@ -138,6 +143,56 @@ struct CSegmentCostCacheT : public CSegmentCostCacheBase {
 		m_heap.Clear();
 	}
 
+	/**
+	 * Remove only those segments which may be affected by the track layout changes since the given counter value.
+	 * If the changes are not all known, or not all associated with a tile, the whole cache is flushed.
+	 * @param since value of s_rail_change_counter when the cache was last brought up to date
+	 */
+	inline void FlushChangesSince(uint32 since)
+	{
+		const uint32 count = s_rail_change_counter - since;
+		if (count > CHANGE_LOG_SIZE) {
+			Flush();
+			return;
+		}
+		if (m_heap.Length() == 0) return;
+
+		uint change_x[CHANGE_LOG_SIZE];
+		uint change_y[CHANGE_LOG_SIZE];
+		for (uint32 i = 0; i < count; i++) {
+			TileIndex tile = s_rail_change_log[(since + i) % CHANGE_LOG_SIZE];
+			if (tile == INVALID_TILE) {
+				Flush();
+				return;
+			}
+			change_x[i] = TileX(tile);
+			change_y[i] = TileY(tile);
+		}
+
+		std::vector<Tsegment> keep;
+		keep.reserve(m_heap.Length());
+		for (uint i = 0; i < m_heap.Length(); i++) {
+			Tsegment &item = m_heap[i];
+			if (item.m_cost < 0) continue;
+			bool affected = false;
+			for (uint32 j = 0; j < count; j++) {
+				if (item.MayBeAffectedByTile(change_x[j], change_y[j])) {
+					affected = true;
+					break;
+				}
+			}
+			if (!affected) keep.push_back(item);
+		}
+		if (keep.size() == m_heap.Length()) return;
+
+		Flush();
+		for (const Tsegment &item : keep) {
+			Tsegment *new_item = new (m_heap.Append()) Tsegment(item);
+			new_item->SetHashNext(nullptr);
+			m_map.Push(*new_item);
+		}
+	}
+
 	inline Tsegment& Get(Key &key, bool *found)
 	{
 		Tsegment *item = m_map.Find(key);
@@ -181,13 +236,13 @@ protected:
 
 	inline static Cache& stGetGlobalCache()
 	{
-		static int last_rail_change_counter = 0;
+		static uint32 last_rail_change_counter = 0;
 		static Cache C;
 
-		/* delete the cache sometimes... */
+		/* delete the parts of the cache affected by track layout changes */
 		if (last_rail_change_counter != Cache::s_rail_change_counter) {
+			C.FlushChangesSince(last_rail_change_counter);
 			last_rail_change_counter = Cache::s_rail_change_counter;
-			C.Flush();
 		}
 		return C;
 	}
@@ -57,6 +57,7 @@ protected:
 	 */
 	int m_max_cost;
 	bool m_disable_cache;
+	bool m_trace_restrict_seen; ///< whether a routing restriction program may have affected the search
 	std::vector<int> m_sig_look_ahead_costs;
 
 public:
@@ -65,7 +66,7 @@ protected:
 
 	static const int s_max_segment_cost = 10000;
 
-	CYapfCostRailT() : m_max_cost(0), m_disable_cache(false), m_stopped_on_first_two_way_signal(false)
+	CYapfCostRailT() : m_max_cost(0), m_disable_cache(false), m_trace_restrict_seen(false), m_stopped_on_first_two_way_signal(false)
 	{
 		/* pre-compute look-ahead penalties into array */
 		int p0 = Yapf().PfGetSettings().rail_look_ahead_signal_p0;
@@ -172,15 +173,21 @@ private:
 	// returns true if ExecuteTraceRestrict should be called
 	inline bool ShouldCheckTraceRestrict(Node& n, TileIndex tile)
 	{
-		return n.m_num_signals_passed < m_sig_look_ahead_costs.size() &&
-				IsRestrictedSignal(tile);
+		if (n.m_num_signals_passed < m_sig_look_ahead_costs.size() && IsRestrictedSignal(tile)) {
+			m_trace_restrict_seen = true;
+			return true;
+		}
+		return false;
 	}
 
 	// returns true if ExecuteTunnelBridgeTraceRestrict should be called
 	inline bool ShouldCheckTunnelBridgeTraceRestrict(Node& n, TileIndex tile)
 	{
-		return n.m_num_signals_passed < m_sig_look_ahead_costs.size() &&
-				IsTunnelBridgeRestrictedSignal(tile);
+		if (n.m_num_signals_passed < m_sig_look_ahead_costs.size() && IsTunnelBridgeRestrictedSignal(tile)) {
+			m_trace_restrict_seen = true;
+			return true;
+		}
+		return false;
 	}
 
 	/**
@@ -614,6 +621,8 @@ public:
 
 no_entry_cost: // jump here at the beginning if the node has no parent (it is the first node)
 
+			segment.IncludeTile(cur.tile);
+
 			/* All other tile costs will be calculated here. */
 			segment_cost += Yapf().OneTileCost(cur.tile, cur.td);
 
@@ -755,6 +764,7 @@ no_entry_cost: // jump here at the beginning if the node has no parent (it is th
 
 			/* Gather the next tile/trackdir/tile_type/rail_type. */
 			TILE next(tf_local.m_new_tile, (Trackdir)FindFirstBit2x64(tf_local.m_new_td_bits));
+			segment.IncludeTile(next.tile);
 
 			if (TrackFollower::DoTrackMasking() && IsTileType(next.tile, MP_RAILWAY)) {
 				if (HasSignalOnTrackdir(next.tile, next.td) && IsPbsSignal(GetSignalType(next.tile, TrackdirToTrack(next.td)))) {
@@ -888,9 +898,21 @@ no_entry_cost: // jump here at the beginning if the node has no parent (it is th
 		if (n.m_segment->m_cost < 0) {
 			n.m_segment->m_last_tile = n.m_key.m_tile;
 			n.m_segment->m_last_td = n.m_key.m_td;
+			n.m_segment->ResetTileBounds();
 		}
 	}
 
+	inline bool IsCacheDisabled() const
+	{
+		return m_disable_cache;
+	}
+
+	/** Whether a routing restriction program was evaluated during the search, making the result specific to the vehicle. */
+	inline bool HasSeenTraceRestrict() const
+	{
+		return m_trace_restrict_seen;
+	}
+
 	void DisableCache(bool disable)
 	{
 		m_disable_cache = disable;
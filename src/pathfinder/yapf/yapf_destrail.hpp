@@ -10,6 +10,12 @@
 #ifndef YAPF_DESTRAIL_HPP
 #define YAPF_DESTRAIL_HPP
 
+#include "../../base_station_base.h"
+#include "../../tracerestrict.h"
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
 class CYapfDestinationRailBase {
 protected:
 	RailTypes m_compatible_railtypes;
@@ -117,17 +123,116 @@ public:
 	}
 };
 
+/**
+ * Lower bounds of the remaining path cost around a rail destination, found by a limited backwards search from the destination.
+ * Only the base tile costs are counted, which no real path can undercut, so the bounds can be used as an admissible
+ * and consistent estimate. Track positions beyond the searched perimeter are bounded by the perimeter radius.
+ */
+template <class TrackFollower>
+class CYapfRailDestinationPerimeter {
+	std::unordered_map<uint64, int> m_costs; ///< lower bound per settled (tile, trackdir)
+	int m_radius = 0;                        ///< lower bound for all positions which were not settled
+
+	static inline uint64 Key(TileIndex tile, Trackdir td)
+	{
+		return (((uint64)tile) << 4) | td;
+	}
+
+	/** Whether a reverse behind signal action may make the forward search leave the relaxed track graph at this tile. */
+	static inline bool HasReversingRestriction(TileIndex tile)
+	{
+		if (!IsTileType(tile, MP_RAILWAY) || !HasSignals(tile) || !IsRestrictedSignal(tile)) return false;
+		TrackBits tracks = GetTrackBits(tile);
+		while (tracks != TRACK_BIT_NONE) {
+			const TraceRestrictProgram *prog = GetExistingTraceRestrictProgram(tile, RemoveFirstTrack(&tracks));
+			if (prog != nullptr && prog->actions_used_flags & TRPAUF_REVERSE) return true;
+		}
+		return false;
+	}
+
+public:
+	bool IsValid() const
+	{
+		return !m_costs.empty();
+	}
+
+	/**
+	 * Search backwards from the destination positions.
+	 * The search is abandoned (leaving the perimeter invalid) if it finds a signal which may reverse the train,
+	 * as the resulting path would not be covered by the backwards search.
+	 * @param v Vehicle to search for.
+	 * @param railtypes Compatible rail types.
+	 * @param destinations Destination positions, where the remaining cost is zero.
+	 * @param max_positions Maximum number of positions to settle.
+	 */
+	void Build(const Train *v, RailTypes railtypes, const std::vector<std::pair<TileIndex, Trackdir>> &destinations, uint max_positions)
+	{
+		typedef std::pair<int, uint64> QueueItem;
+		std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+		std::unordered_map<uint64, int> best;
+
+		m_costs.clear();
+		m_radius = 0;
+		for (const auto &dest : destinations) {
+			uint64 key = Key(dest.first, dest.second);
+			if (best.emplace(key, 0).second) queue.push(QueueItem(0, key));
+		}
+
+		TrackFollower F(v, railtypes);
+		while (!queue.empty() && m_costs.size() < max_positions) {
+			QueueItem item = queue.top();
+			queue.pop();
+			if (m_costs.find(item.second) != m_costs.end()) continue;
+			m_costs[item.second] = item.first;
+			m_radius = item.first;
+
+			TileIndex tile = (TileIndex)(item.second >> 4);
+			Trackdir td = (Trackdir)(item.second & 0xF);
+			if (HasReversingRestriction(tile)) {
+				m_costs.clear();
+				return;
+			}
+
+			/* Positions from which the forward search would enter this one are found by following the reversed trackdir */
+			if (!F.Follow(tile, ReverseTrackdir(td))) continue;
+			if (HasReversingRestriction(F.m_new_tile)) {
+				m_costs.clear();
+				return;
+			}
+			int cost = item.first + (IsDiagonalTrackdir(td) ? YAPF_TILE_LENGTH : YAPF_TILE_CORNER_LENGTH) + YAPF_TILE_LENGTH * F.m_tiles_skipped;
+			for (TrackdirBits bits = F.m_new_td_bits; bits != TRACKDIR_BIT_NONE;) {
+				uint64 key = Key(F.m_new_tile, ReverseTrackdir(RemoveFirstTrackdir(&bits)));
+				auto res = best.emplace(key, cost);
+				if (!res.second) {
+					if (res.first->second <= cost) continue;
+					res.first->second = cost;
+				}
+				queue.push(QueueItem(cost, key));
+			}
+		}
+	}
+
+	/** Get the lower bound of the remaining cost after leaving the given position. */
+	inline int GetLowerBound(TileIndex tile, Trackdir td) const
+	{
+		auto iter = m_costs.find(Key(tile, td));
+		return iter != m_costs.end() ? iter->second : m_radius;
+	}
+};
+
 template <class Types>
 class CYapfDestinationTileOrStationRailT : public CYapfDestinationRailBase {
 public:
 	typedef typename Types::Tpf Tpf;              ///< the pathfinder class (derived from THIS class)
 	typedef typename Types::NodeList::Titem Node; ///< this will be our node type
 	typedef typename Node::Key Key;               ///< key to hash tables
+	typedef typename Types::TrackFollower TrackFollower; ///< TrackFollower. Need to typedef for gcc 2.95
 
 protected:
 	TileIndex    m_destTile;
 	TrackdirBits m_destTrackdirs;
 	StationID    m_dest_station_id;
+	CYapfRailDestinationPerimeter<TrackFollower> m_perimeter;
 
 	/** to access inherited path finder */
 	Tpf& Yapf()
@@ -163,6 +268,29 @@ public:
 				break;
 		}
 		CYapfDestinationRailBase::SetDestination(v);
+
+		uint perimeter_positions = Yapf().PfGetSettings().rail_destination_perimeter_nodes;
+		if (perimeter_positions > 0) SetupPerimeter(v, perimeter_positions);
+	}
+
+	/** Search backwards from all destination positions, to improve the cost estimate around detours near the destination. */
+	void SetupPerimeter(const Train *v, uint max_positions)
+	{
+		std::vector<std::pair<TileIndex, Trackdir>> destinations;
+		if (m_dest_station_id != INVALID_STATION) {
+			for (TileIndex tile : BaseStation::Get(m_dest_station_id)->train_station) {
+				if (!HasStationTileRail(tile) || GetStationIndex(tile) != m_dest_station_id) continue;
+				Trackdir td = TrackToTrackdir(GetRailStationTrack(tile));
+				destinations.emplace_back(tile, td);
+				destinations.emplace_back(tile, ReverseTrackdir(td));
+			}
+		} else if (m_destTrackdirs != INVALID_TRACKDIR_BIT) {
+			for (TrackdirBits bits = m_destTrackdirs; bits != TRACKDIR_BIT_NONE;) {
+				destinations.emplace_back(m_destTile, RemoveFirstTrackdir(&bits));
+			}
+		}
+		if (destinations.empty()) return;
+		m_perimeter.Build(v, GetCompatibleRailTypes(), destinations, max_positions);
 	}
 
 	/** Called by YAPF to detect if node ends in the desired destination */
@@ -207,6 +335,7 @@ public:
 		int dmin = std::min(dx, dy);
 		int dxy = abs(dx - dy);
 		int d = dmin * YAPF_TILE_CORNER_LENGTH + (dxy - 1) * (YAPF_TILE_LENGTH / 2);
+		if (m_perimeter.IsValid()) d = std::max(d, m_perimeter.GetLowerBound(tile, n.GetLastTrackdir()));
 		n.m_estimate = n.m_cost + d;
 		assert(n.m_estimate >= n.m_parent->m_estimate);
 		return true;
@@ -69,6 +69,10 @@ struct CYapfRailSegment
 	TileIndex              m_last_signal_tile;
 	Trackdir               m_last_signal_td;
 	EndSegmentReasonBits   m_end_segment_reason;
+	uint16                 m_min_x;      ///< bounding box of the tiles examined when calculating this segment
+	uint16                 m_min_y;
+	uint16                 m_max_x;
+	uint16                 m_max_y;
 	CYapfRailSegment      *m_hash_next;
 
 	inline CYapfRailSegment(const CYapfRailSegmentKey &key)
@@ -80,7 +84,37 @@ struct CYapfRailSegment
 		, m_last_signal_td(INVALID_TRACKDIR)
 		, m_end_segment_reason(ESRB_NONE)
 		, m_hash_next(nullptr)
-	{}
+	{
+		ResetTileBounds();
+	}
+
+	/** reset the bounding box of examined tiles to just the segment origin tile */
+	inline void ResetTileBounds()
+	{
+		TileIndex tile = m_key.GetTile();
+		m_min_x = m_max_x = TileX(tile);
+		m_min_y = m_max_y = TileY(tile);
+	}
+
+	/** extend the bounding box of examined tiles to include the given tile */
+	inline void IncludeTile(TileIndex tile)
+	{
+		uint x = TileX(tile);
+		uint y = TileY(tile);
+		if (x < m_min_x) m_min_x = x;
+		if (x > m_max_x) m_max_x = x;
+		if (y < m_min_y) m_min_y = y;
+		if (y > m_max_y) m_max_y = y;
+	}
+
+	/**
+	 * may a change to the given tile affect this segment?
+	 * This includes tiles adjacent to the examined tiles, as these are looked at when following the track
+	 */
+	inline bool MayBeAffectedByTile(uint x, uint y) const
+	{
+		return x + 1 >= m_min_x && x <= (uint)m_max_x + 1 && y + 1 >= m_min_y && y <= (uint)m_max_y + 1;
+	}
 
 	inline const Key& GetKey() const
 	{
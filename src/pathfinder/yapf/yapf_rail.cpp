@@ -463,6 +463,102 @@ public:
 	}
 };
 
+/**
+ * Short-lived cache of non-reserving ChooseRailTrack results.
+ * Trains sharing orders tend to repeat the same search from the same place, with the same vehicle parameters.
+ * An entry is only valid while the track layout, track reservations, signal states and game settings are unchanged,
+ * and searches which evaluated routing restrictions are never stored, so a hit returns exactly what a new search would.
+ */
+struct RailChooseTrackCache {
+	struct Key {
+		TileIndex origin_tile;
+		Trackdir origin_td;
+		TileIndex veh_tile;
+		TileIndex dest_tile;
+		uint16 order_dest;
+		OrderType order_type;
+		Owner owner;
+		bool allow_90deg;
+		RailTypes railtypes;
+		uint32 total_length;
+		uint16 max_speed;
+
+		bool operator==(const Key &other) const
+		{
+			return this->origin_tile == other.origin_tile && this->origin_td == other.origin_td && this->veh_tile == other.veh_tile &&
+					this->dest_tile == other.dest_tile && this->order_dest == other.order_dest && this->order_type == other.order_type &&
+					this->owner == other.owner && this->allow_90deg == other.allow_90deg && this->railtypes == other.railtypes &&
+					this->total_length == other.total_length && this->max_speed == other.max_speed;
+		}
+	};
+
+	struct Entry {
+		Key key;
+		uint32 rail_change_counter;
+		uint32 state_generation;
+		Trackdir result;
+		bool path_found;
+		bool valid = false;
+	};
+
+	static const uint SIZE = 256;
+	static Entry s_entries[SIZE];
+
+	/**
+	 * Make the cache key for a train, if its search may be cached.
+	 * @return true if the key is valid.
+	 */
+	static bool MakeKey(Key &key, const Train *v, const PBSTileInfo &origin, bool allow_90deg)
+	{
+		/* Waypoint orders may look at vehicle positions when reversing, and complex waypoints disable the segment cache */
+		if (v->current_order.IsType(OT_GOTO_WAYPOINT)) return false;
+
+		key.origin_tile = origin.tile;
+		key.origin_td = origin.trackdir;
+		key.veh_tile = v->tile;
+		key.dest_tile = v->dest_tile;
+		key.order_dest = v->current_order.GetDestination();
+		key.order_type = v->current_order.GetType();
+		key.owner = v->owner;
+		key.allow_90deg = allow_90deg;
+		key.railtypes = v->compatible_railtypes;
+		key.total_length = v->gcache.cached_total_length;
+		key.max_speed = std::min<int>(v->GetDisplayMaxSpeed(), v->current_order.GetMaxSpeed());
+		return true;
+	}
+
+	static Entry &GetEntry(const Key &key)
+	{
+		uint hash = (key.origin_tile * 0x9E3779B1) ^ (key.origin_td << 24) ^ (key.dest_tile * 0x85EBCA6B) ^ key.order_dest;
+		return s_entries[(hash >> 16) % SIZE];
+	}
+
+	static bool Lookup(const Key &key, Trackdir &result, bool &path_found)
+	{
+		const Entry &entry = GetEntry(key);
+		if (!entry.valid || entry.rail_change_counter != CSegmentCostCacheBase::s_rail_change_counter ||
+				entry.state_generation != _rail_state_generation || !(entry.key == key)) {
+			return false;
+		}
+		result = entry.result;
+		path_found = entry.path_found;
+		return true;
+	}
+
+	static void Store(const Key &key, Trackdir result, bool path_found)
+	{
+		Entry &entry = GetEntry(key);
+		entry.key = key;
+		entry.rail_change_counter = CSegmentCostCacheBase::s_rail_change_counter;
+		entry.state_generation = _rail_state_generation;
+		entry.result = result;
+		entry.path_found = path_found;
+		entry.valid = true;
+	}
+};
+
+RailChooseTrackCache::Entry RailChooseTrackCache::s_entries[RailChooseTrackCache::SIZE];
+
 template <class Types>
 class CYapfFollowRailT : public CYapfReserveTrack<Types>
 {
@@ -549,6 +645,14 @@ public:
 
 		/* set origin and destination nodes */
 		PBSTileInfo origin = FollowTrainReservation(v, nullptr, FTRF_OKAY_UNUSED);
+
+		RailChooseTrackCache::Key cache_key;
+		bool use_result_cache = !reserve_track && !Yapf().IsCacheDisabled() && RailChooseTrackCache::MakeKey(cache_key, v, origin, TrackFollower::Allow90degTurns());
+		if (use_result_cache) {
+			Trackdir cached_trackdir;
+			if (RailChooseTrackCache::Lookup(cache_key, cached_trackdir, path_found)) return cached_trackdir;
+		}
+
 		Yapf().SetOrigin(origin.tile, origin.trackdir, INVALID_TILE, INVALID_TRACKDIR, 1, true);
 		Yapf().SetDestination(v);
 
@@ -580,6 +684,8 @@ public:
 
 		/* Treat the path as found if stopped on the first two way signal(s). */
 		path_found |= Yapf().m_stopped_on_first_two_way_signal;
+
+		if (use_result_cache && !Yapf().HasSeenTraceRestrict()) RailChooseTrackCache::Store(cache_key, next_trackdir, path_found);
 		return next_trackdir;
 	}
 
@@ -781,7 +887,8 @@ bool YapfTrainFindNearestSafeTile(const Train *v, TileIndex tile, Trackdir td, b
 }
 
 /** if any track changes, this counter is incremented - that will invalidate segment cost cache */
-int CSegmentCostCacheBase::s_rail_change_counter = 0;
+uint32 CSegmentCostCacheBase::s_rail_change_counter = 0;
+TileIndex CSegmentCostCacheBase::s_rail_change_log[CSegmentCostCacheBase::CHANGE_LOG_SIZE];
 
 void YapfNotifyTrackLayoutChange(TileIndex tile, Track track)
 {
@@ -13,6 +13,9 @@
 #include "../../roadstop_base.h"
 #include "../../vehicle_func.h"
 
+#include <unordered_map>
+#include <vector>
+
 #include "../../safeguards.h"
 
 /**
@@ -26,6 +29,78 @@ const uint MAX_RV_PF_TILES = 1 << 11;
 
 const int MAX_RV_LEADER_TARGETS = 4;
 
+/**
+ * Walk of a road segment, from a junction to the next junction, dead end or depot.
+ * This holds the parts of the segment cost calculation which only depend on the map and the road type of the vehicle,
+ * all costs which depend on the vehicle, the occupancy of road stops or the search itself are evaluated for each search.
+ * A segment is checked against a copy of the map data of all the tiles it was built from whenever it is used,
+ * so no notification of road layout changes is required.
+ */
+struct CachedRoadSegment {
+	/** Why the walk stopped at a step. */
+	enum EndReason : uint8 {
+		RSER_NONE,      ///< Walk continues to the next step.
+		RSER_DEPOT,     ///< Entered a depot.
+		RSER_DEAD_END,  ///< No reachable trackdirs.
+		RSER_JUNCTION,  ///< More than one reachable trackdir on the next tile.
+		RSER_LOOP,      ///< Back at the start of the segment.
+		RSER_TOO_LONG,  ///< Segment length limit reached, this step is the segment end but is itself not walked.
+	};
+
+	struct Step {
+		TileIndex tile;
+		Trackdir td;
+		EndReason end;
+		bool slope_up;           ///< Moving to the next step is up-hill.
+		uint tiles_skipped;      ///< Tunnel/bridge tiles skipped when moving to the next step.
+		int max_speed;           ///< Speed limit when moving to the next step.
+		int min_speed;           ///< Minimum speed when moving to the next step.
+		TileTypeHeight mth;      ///< Copy of the type and height of the tile.
+		Tile m;                  ///< Copy of the map data of the tile.
+		TileExtended me;         ///< Copy of the extended map data of the tile.
+		byte corner_heights[3];  ///< Heights of the other three corners of the tile.
+	};
+
+	std::vector<Step> steps;
+	TileIndex probe_tile = INVALID_TILE; ///< Tile which was looked at to find the end of the segment, if not a step.
+	TileTypeHeight probe_mth;
+	Tile probe_m;
+	TileExtended probe_me;
+	RoadTypes compatible_roadtypes;
+	bool infra_sharing;
+
+	static void GetCornerHeights(TileIndex tile, byte *heights)
+	{
+		heights[0] = TileHeight(tile + TileDiffXY(1, 0));
+		heights[1] = TileHeight(tile + TileDiffXY(0, 1));
+		heights[2] = TileHeight(tile + TileDiffXY(1, 1));
+	}
+
+	/** Check whether the map is still the same as when the segment was walked. */
+	bool IsValid(const RoadVehicle *v) const
+	{
+		if (this->compatible_roadtypes != v->compatible_roadtypes || this->infra_sharing != _settings_game.economy.infrastructure_sharing[VEH_ROAD]) return false;
+		for (const Step &step : this->steps) {
+			if (memcmp(&_mth[step.tile], &step.mth, sizeof(TileTypeHeight)) != 0 || memcmp(&_m[step.tile], &step.m, sizeof(Tile)) != 0 ||
+					memcmp(&_me[step.tile], &step.me, sizeof(TileExtended)) != 0) return false;
+			byte heights[3];
+			GetCornerHeights(step.tile, heights);
+			if (memcmp(heights, step.corner_heights, sizeof(heights)) != 0) return false;
+		}
+		if (this->probe_tile != INVALID_TILE) {
+			if (memcmp(&_mth[this->probe_tile], &this->probe_mth, sizeof(TileTypeHeight)) != 0 || memcmp(&_m[this->probe_tile], &this->probe_m, sizeof(Tile)) != 0 ||
+					memcmp(&_me[this->probe_tile], &this->probe_me, sizeof(TileExtended)) != 0) return false;
+		}
+		return true;
+	}
+};
+
+/** Maximum number of cached road segments, the cache is cleared when it grows above this. */
+static const size_t MAX_CACHED_ROAD_SEGMENTS = 1 << 16;
+
+/** Cached road segments, keyed by start tile, trackdir, owner and road type. */
+static std::unordered_map<uint64, CachedRoadSegment> _cached_road_segments;
+
 template <class Types>
 class CYapfCostRoadT
 {
@@ -48,7 +123,8 @@ protected:
 		return *p;
 	}
 
-	int SlopeCost(TileIndex tile, TileIndex next_tile, Trackdir trackdir)
+	/** Whether moving from the centre of tile to the centre of next_tile is up-hill. */
+	static bool IsUphill(TileIndex tile, TileIndex next_tile)
 	{
 		/* height of the center of the current tile */
 		int x1 = TileX(tile) * TILE_SIZE;
@@ -60,11 +136,7 @@ protected:
 		int y2 = TileY(next_tile) * TILE_SIZE;
 		int z2 = GetSlopePixelZ(x2 + TILE_SIZE / 2, y2 + TILE_SIZE / 2);
 
-		if (z2 - z1 > 1) {
-			/* Slope up */
-			return Yapf().PfGetSettings().road_slope_penalty;
-		}
-		return 0;
+		return z2 - z1 > 1;
 	}
 
 	/** return one tile cost */
@@ -140,6 +212,109 @@ public:
 		m_max_cost = max_cost;
 	}
 
+	/**
+	 * Walk the road segment starting at the given tile and trackdir, recording everything that does not depend on the search.
+	 * This must stop for exactly the same reasons as the walk in PfCalcCost.
+	 */
+	void WalkSegment(TileIndex start_tile, Trackdir start_td, CachedRoadSegment &segment)
+	{
+		const RoadVehicle *v = Yapf().GetVehicle();
+		segment.steps.clear();
+		segment.probe_tile = INVALID_TILE;
+		segment.compatible_roadtypes = v->compatible_roadtypes;
+		segment.infra_sharing = _settings_game.economy.infrastructure_sharing[VEH_ROAD];
+
+		uint tiles = 0;
+		TileIndex tile = start_tile;
+		Trackdir trackdir = start_td;
+		for (;;) {
+			segment.steps.emplace_back();
+			CachedRoadSegment::Step &step = segment.steps.back();
+			step.tile = tile;
+			step.td = trackdir;
+			step.end = CachedRoadSegment::RSER_NONE;
+			step.slope_up = false;
+			step.tiles_skipped = 0;
+			step.max_speed = INT_MAX;
+			step.min_speed = 0;
+			step.mth = _mth[tile];
+			step.m = _m[tile];
+			step.me = _me[tile];
+			CachedRoadSegment::GetCornerHeights(tile, step.corner_heights);
+
+			/* stop if we have just entered the depot */
+			if (IsRoadDepotTile(tile) && trackdir == DiagDirToDiagTrackdir(ReverseDiagDir(GetRoadDepotDirection(tile)))) {
+				step.end = CachedRoadSegment::RSER_DEPOT;
+				break;
+			}
+
+			TrackFollower F(v);
+			bool followed = F.Follow(tile, trackdir);
+			if (F.m_new_tile != INVALID_TILE && F.m_new_tile != tile) {
+				segment.probe_tile = F.m_new_tile;
+				segment.probe_mth = _mth[F.m_new_tile];
+				segment.probe_m = _m[F.m_new_tile];
+				segment.probe_me = _me[F.m_new_tile];
+			}
+			if (!followed) {
+				step.end = CachedRoadSegment::RSER_DEAD_END;
+				break;
+			}
+
+			step.tiles_skipped = F.m_tiles_skipped;
+			tiles += F.m_tiles_skipped + 1;
+
+			if (KillFirstBit(F.m_new_td_bits) != TRACKDIR_BIT_NONE) {
+				step.end = CachedRoadSegment::RSER_JUNCTION;
+				break;
+			}
+
+			Trackdir new_td = (Trackdir)FindFirstBit2x64(F.m_new_td_bits);
+			if (F.m_new_tile == start_tile && new_td == start_td) {
+				step.end = CachedRoadSegment::RSER_LOOP;
+				break;
+			}
+
+			step.slope_up = IsUphill(tile, F.m_new_tile);
+			step.max_speed = F.GetSpeedLimit(&step.min_speed);
+
+			tile = F.m_new_tile;
+			trackdir = new_td;
+			if (tiles > MAX_RV_PF_TILES) {
+				CachedRoadSegment::Step last = step;
+				last.tile = tile;
+				last.td = trackdir;
+				last.end = CachedRoadSegment::RSER_TOO_LONG;
+				last.mth = _mth[tile];
+				last.m = _m[tile];
+				last.me = _me[tile];
+				CachedRoadSegment::GetCornerHeights(tile, last.corner_heights);
+				segment.steps.push_back(last);
+				break;
+			}
+		}
+		/* The probe tile is only of interest for the final step, it is one of the steps otherwise */
+		if (segment.steps.back().end != CachedRoadSegment::RSER_JUNCTION && segment.steps.back().end != CachedRoadSegment::RSER_DEAD_END) {
+			segment.probe_tile = INVALID_TILE;
+		}
+	}
+
+	/** Get the walk of the road segment starting at the given tile and trackdir, from the cache if it is still valid. */
+	const CachedRoadSegment &GetSegment(TileIndex tile, Trackdir trackdir)
+	{
+		const RoadVehicle *v = Yapf().GetVehicle();
+		uint64 key = ((uint64)tile << 32) | ((uint64)trackdir << 24) | ((uint64)v->owner << 16) | v->roadtype;
+		auto iter = _cached_road_segments.find(key);
+		if (iter != _cached_road_segments.end()) {
+			if (iter->second.IsValid(v)) return iter->second;
+		} else {
+			if (_cached_road_segments.size() >= MAX_CACHED_ROAD_SEGMENTS) _cached_road_segments.clear();
+			iter = _cached_road_segments.emplace(key, CachedRoadSegment()).first;
+		}
+		WalkSegment(tile, trackdir, iter->second);
+		return iter->second;
+	}
+
 	/**
 	 * Called by YAPF to calculate the cost from the origin to the given node.
 	 *  Calculates only the cost of given node, adds it to the parent node cost
@@ -151,19 +326,21 @@ public:
 		 * and we have advanced across the bridge in the initial step */
 		int segment_cost = tf->m_tiles_skipped * YAPF_TILE_LENGTH;
 
-		uint tiles = 0;
-		/* start at n.m_key.m_tile / n.m_key.m_td and walk to the end of segment */
-		TileIndex tile = n.m_key.m_tile;
-		Trackdir trackdir = n.m_key.m_td;
 		int parent_cost = (n.m_parent != nullptr) ? n.m_parent->m_cost : 0;
+		const RoadVehicle *v = Yapf().GetVehicle();
+		const int max_veh_speed = std::min<int>(v->GetDisplayMaxSpeed(), v->current_order.GetMaxSpeed() * 2);
+
+		/* walk the (cached) steps of the segment, adding the costs which are specific to this search */
+		const CachedRoadSegment &segment = GetSegment(n.m_key.m_tile, n.m_key.m_td);
+		const CachedRoadSegment::Step *step = segment.steps.data();
+		for (;; step++) {
+			if (step->end == CachedRoadSegment::RSER_TOO_LONG) break;
 
-		for (;;) {
 			/* base tile cost depending on distance between edges */
-			segment_cost += Yapf().OneTileCost(tile, trackdir, tf);
+			segment_cost += Yapf().OneTileCost(step->tile, step->td, tf);
 
-			const RoadVehicle *v = Yapf().GetVehicle();
 			/* we have reached the vehicle's destination - segment should end here to avoid target skipping */
-			if (Yapf().PfDetectDestinationTile(tile, trackdir)) break;
+			if (Yapf().PfDetectDestinationTile(step->tile, step->td)) break;
 
 			/* Finish if we already exceeded the maximum path cost (i.e. when
 			 * searching for the nearest depot). */
@@ -171,48 +348,31 @@ public:
 				return false;
 			}
 
-			/* stop if we have just entered the depot */
-			if (IsRoadDepotTile(tile) && trackdir == DiagDirToDiagTrackdir(ReverseDiagDir(GetRoadDepotDirection(tile)))) {
-				/* next time we will reverse and leave the depot */
-				break;
-			}
-
-			/* if there are no reachable trackdirs on new tile, we have end of road */
-			TrackFollower F(Yapf().GetVehicle());
-			if (!F.Follow(tile, trackdir)) break;
+			/* stop if we have just entered the depot (next time we will reverse and leave the depot),
+			 * or if there are no reachable trackdirs on new tile */
+			if (step->end == CachedRoadSegment::RSER_DEPOT || step->end == CachedRoadSegment::RSER_DEAD_END) break;
 
 			/* if we skipped some tunnel tiles, add their cost */
 			/* with custom bridge heads, this cost must be added before checking if the segment has ended */
-			segment_cost += F.m_tiles_skipped * YAPF_TILE_LENGTH;
-			tiles += F.m_tiles_skipped + 1;
+			segment_cost += step->tiles_skipped * YAPF_TILE_LENGTH;
 
 			/* if there are more trackdirs available & reachable, we are at the end of segment */
-			if (KillFirstBit(F.m_new_td_bits) != TRACKDIR_BIT_NONE) break;
-
-			Trackdir new_td = (Trackdir)FindFirstBit2x64(F.m_new_td_bits);
+			if (step->end == CachedRoadSegment::RSER_JUNCTION) break;
 
 			/* stop if RV is on simple loop with no junctions */
-			if (F.m_new_tile == n.m_key.m_tile && new_td == n.m_key.m_td) return false;
+			if (step->end == CachedRoadSegment::RSER_LOOP) return false;
 
 			/* add hilly terrain penalty */
-			segment_cost += Yapf().SlopeCost(tile, F.m_new_tile, trackdir);
+			if (step->slope_up) segment_cost += Yapf().PfGetSettings().road_slope_penalty;
 
 			/* add min/max speed penalties */
-			int min_speed = 0;
-			int max_veh_speed = std::min<int>(v->GetDisplayMaxSpeed(), v->current_order.GetMaxSpeed() * 2);
-			int max_speed = F.GetSpeedLimit(&min_speed);
-			if (max_speed < max_veh_speed) segment_cost += YAPF_TILE_LENGTH * (max_veh_speed - max_speed) * (4 + F.m_tiles_skipped) / max_veh_speed;
-			if (min_speed > max_veh_speed) segment_cost += YAPF_TILE_LENGTH * (min_speed - max_veh_speed);
-
-			/* move to the next tile */
-			tile = F.m_new_tile;
-			trackdir = new_td;
-			if (tiles > MAX_RV_PF_TILES) break;
+			if (step->max_speed < max_veh_speed) segment_cost += YAPF_TILE_LENGTH * (max_veh_speed - step->max_speed) * (4 + step->tiles_skipped) / max_veh_speed;
+			if (step->min_speed > max_veh_speed) segment_cost += YAPF_TILE_LENGTH * (step->min_speed - max_veh_speed);
 		}
 
 		/* save end of segment back to the node */
-		n.m_segment_last_tile = tile;
-		n.m_segment_last_td = trackdir;
+		n.m_segment_last_tile = step->tile;
+		n.m_segment_last_td = step->td;
 
 		/* save also tile cost */
 		n.m_cost = parent_cost + segment_cost;
@@ -11,6 +11,8 @@
 #include "../../ship.h"
 #include "../../industry.h"
 #include "../../vehicle_func.h"
+#include "../../station_base.h"
+#include "../water_regions.h"
 
 #include "yapf.hpp"
 #include "yapf_node_ship.hpp"
@@ -68,6 +70,26 @@ public:
 		return tile == m_destTile && ((m_destTrackdirs & TrackdirToTrackdirBits(trackdir)) != TRACKDIR_BIT_NONE);
 	}
 
+	/** Get the tiles which may be the end of a path to the destination, for the water region search */
+	void GetDestinationTiles(std::vector<TileIndex> &tiles) const
+	{
+		if (m_destStation != INVALID_STATION) {
+			const Station *st = Station::GetIfValid(m_destStation);
+			if (st == nullptr) return;
+			for (TileIndex tile : st->docking_station) {
+				if (IsDockingTile(tile) && IsShipDestinationTile(tile, m_destStation)) tiles.push_back(tile);
+			}
+		} else if (m_destTile != INVALID_TILE) {
+			tiles.push_back(m_destTile);
+		}
+	}
+
+	/** Get the destination tile used for the distance estimate */
+	inline TileIndex GetDestinationTile() const
+	{
+		return m_destTile;
+	}
+
 	/**
 	 * Called by YAPF to calculate cost estimate. Calculates distance to the destination
 	 *  adds it to the actual cost from origin and stores the sum to the Node::m_estimate
@@ -109,7 +131,12 @@ public:
 	typedef typename Types::NodeList::Titem Node;        ///< this will be our node type
 	typedef typename Node::Key Key;                      ///< key to hash tables
 
+	/** Minimum distance between origin and destination for which the search is restricted to a water region corridor. */
+	static const uint MIN_CORRIDOR_DISTANCE = 4 * WATER_REGION_EDGE_LENGTH;
+
 protected:
+	const WaterRegionCorridor *m_corridor = nullptr; ///< regions the search is restricted to, or nullptr
+
 	/** to access inherited path finder */
 	inline Tpf& Yapf()
 	{
@@ -126,10 +153,45 @@ public:
 	{
 		TrackFollower F(Yapf().GetVehicle());
 		if (F.Follow(old_node.m_key.m_tile, old_node.m_key.m_td)) {
+			if (m_corridor != nullptr && !m_corridor->Contains(F.m_new_tile)) return;
 			Yapf().AddMultipleNodes(&old_node, F);
 		}
 	}
 
+	/**
+	 * Find the path for the set up origin and destination.
+	 * For long distances, the search is first restricted to the regions found by a search over water regions.
+	 * If no path can be found within those regions, the search is repeated without restriction.
+	 * @param pf pathfinder instance, replaced by a new instance if the search needs to be repeated
+	 * @param v ship
+	 * @param origin origin tile
+	 * @param setup function to set the origin and destination of a new pathfinder instance
+	 * @return true if a path was found
+	 */
+	template <typename F>
+	static bool FindPathUsingCorridor(std::unique_ptr<Tpf> &pf, const Ship *v, TileIndex origin, F setup)
+	{
+		setup(*pf);
+		if (DistanceManhattan(origin, pf->GetDestinationTile()) < MIN_CORRIDOR_DISTANCE) return pf->FindPath(v);
+
+		std::vector<TileIndex> destinations;
+		pf->GetDestinationTiles(destinations);
+		WaterRegionCorridor corridor;
+		if (!FindWaterRegionCorridor(origin, destinations, corridor)) return pf->FindPath(v);
+
+		pf->m_corridor = &corridor;
+		bool path_found = pf->FindPath(v);
+		pf->m_corridor = nullptr;
+
+		/* The search ran out of nodes within the corridor, the route isn't as expected from the regions */
+		if (!path_found && pf->m_nodes.GetBestOpenNode() == nullptr) {
+			pf.reset(new Tpf());
+			setup(*pf);
+			path_found = pf->FindPath(v);
+		}
+		return path_found;
+	}
+
 	/** return debug report character to identify the transportation type */
 	inline char TransportTypeChar() const
 	{
@@ -159,16 +221,16 @@ public:
 		TrackdirBits trackdirs = TrackdirToTrackdirBits(trackdir);
 
 		/* create pathfinder instance */
-		Tpf pf;
-		/* set origin and destination nodes */
-		pf.SetOrigin(src_tile, trackdirs);
-		pf.SetDestination(v);
-		/* find best path */
-		path_found = pf.FindPath(v);
+		std::unique_ptr<Tpf> pf(new Tpf());
+		/* find best path, after setting origin and destination nodes */
+		path_found = FindPathUsingCorridor(pf, v, src_tile, [&](Tpf &pf) {
+			pf.SetOrigin(src_tile, trackdirs);
+			pf.SetDestination(v);
+		});
 
 		Trackdir next_trackdir = INVALID_TRACKDIR; // this would mean "path not found"
 
-		Node *pNode = pf.GetBestNode();
+		Node *pNode = pf->GetBestNode();
 		if (pNode != nullptr) {
 			uint steps = 0;
 			for (Node *n = pNode; n->m_parent != nullptr; n = n->m_parent) steps++;
@@ -210,20 +272,21 @@ public:
 	static bool CheckShipReverse(const Ship *v, TileIndex tile, Trackdir td1, Trackdir td2, Trackdir *trackdir)
 	{
 		/* create pathfinder instance */
-		Tpf pf;
-		/* set origin and destination nodes */
-		if (trackdir == nullptr) {
-			pf.SetOrigin(tile, TrackdirToTrackdirBits(td1) | TrackdirToTrackdirBits(td2));
-		} else {
-			DiagDirection entry = ReverseDiagDir(VehicleExitDir(v->direction, v->state));
-			TrackdirBits rtds = DiagdirReachesTrackdirs(entry) & TrackStatusToTrackdirBits(GetTileTrackStatus(tile, TRANSPORT_WATER, 0, entry));
-			pf.SetOrigin(tile, rtds);
-		}
-		pf.SetDestination(v);
-		/* find best path */
-		if (!pf.FindPath(v)) return false;
+		std::unique_ptr<Tpf> pf(new Tpf());
+		/* find best path, after setting origin and destination nodes */
+		bool path_found = FindPathUsingCorridor(pf, v, tile, [&](Tpf &pf) {
+			if (trackdir == nullptr) {
+				pf.SetOrigin(tile, TrackdirToTrackdirBits(td1) | TrackdirToTrackdirBits(td2));
+			} else {
+				DiagDirection entry = ReverseDiagDir(VehicleExitDir(v->direction, v->state));
+				TrackdirBits rtds = DiagdirReachesTrackdirs(entry) & TrackStatusToTrackdirBits(GetTileTrackStatus(tile, TRANSPORT_WATER, 0, entry));
+				pf.SetOrigin(tile, rtds);
+			}
+			pf.SetDestination(v);
+		});
+		if (!path_found) return false;
 
-		Node *pNode = pf.GetBestNode();
+		Node *pNode = pf->GetBestNode();
 		if (pNode == nullptr) return false;
 
 		/* path was found
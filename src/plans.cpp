@@ -47,3 +47,19 @@ void PlanLine::UpdateVisualExtents()
 	this->viewport_extents = { (int)(min_x * TILE_SIZE * 2 * ZOOM_LVL_BASE), (int)(min_y * TILE_SIZE * ZOOM_LVL_BASE),
 			(int)((max_x + 1) * TILE_SIZE * 2 * ZOOM_LVL_BASE), (int)((max_y + 1) * TILE_SIZE * ZOOM_LVL_BASE) };
 }
+
+/** Update the viewport extents of the plan from those of its lines, call after adding or removing lines. */
+void Plan::UpdateVisualExtents()
+{
+	if (_network_dedicated) return;
+
+	this->viewport_extents = { INT_MAX, INT_MAX, INT_MIN, INT_MIN };
+	for (const PlanLine *pl : this->lines) {
+		if (pl->tiles.size() < 2) continue;
+		this->viewport_extents.left = std::min(this->viewport_extents.left, pl->viewport_extents.left);
+		this->viewport_extents.top = std::min(this->viewport_extents.top, pl->viewport_extents.top);
+		this->viewport_extents.right = std::max(this->viewport_extents.right, pl->viewport_extents.right);
+		this->viewport_extents.bottom = std::max(this->viewport_extents.bottom, pl->viewport_extents.bottom);
+	}
+	if (this->viewport_extents.left > this->viewport_extents.right) this->viewport_extents = { INT_MAX, INT_MAX, INT_MAX, INT_MAX };
+}
@@ -169,6 +169,7 @@ struct Plan : PlanPool::PoolItem<&_plan_pool> {
 	Date creation_date;
 	std::string name;
 	Colours colour;
+	Rect viewport_extents; ///< Union of the viewport extents of the lines.
 
 	Plan(Owner owner = INVALID_OWNER)
 	{
@@ -178,6 +179,7 @@ struct Plan : PlanPool::PoolItem<&_plan_pool> {
 		this->visible_by_all = false;
 		this->show_lines = false;
 		this->colour = COLOUR_WHITE;
+		this->viewport_extents = { INT_MAX, INT_MAX, INT_MAX, INT_MAX };
 		this->temp_line = new PlanLine();
 		this->last_tile = INVALID_TILE;
 	}
@@ -214,6 +216,8 @@ struct Plan : PlanPool::PoolItem<&_plan_pool> {
 		return this->visible;
 	}
 
+	void UpdateVisualExtents();
+
 	PlanLine *NewLine()
 	{
 		PlanLine *pl = new PlanLine();
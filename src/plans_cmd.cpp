@@ -70,6 +70,7 @@ CommandCost CmdAddPlanLine(TileIndex tile, DoCommandFlag flags, uint32 p1, uint3
 			return CMD_ERROR;
 		}
 		pl->UpdateVisualExtents();
+		p->UpdateVisualExtents();
 		if (p->IsListable()) {
 			pl->SetVisibility(p->visible);
 			if (p->visible) pl->MarkDirty();
@@ -180,6 +181,7 @@ CommandCost CmdRemovePlanLine(TileIndex tile, DoCommandFlag flags, uint32 p1, ui
 		(*it)->SetVisibility(false);
 		delete *it;
 		p->lines.erase(it);
+		p->UpdateVisualExtents();
 		if (p->IsListable()) {
 			Window *w = FindWindowById(WC_PLANS, 0);
 			if (w) w->InvalidateData(p->index, false);
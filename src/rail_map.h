@@ -244,6 +244,7 @@ static inline void SetTrackReservation(TileIndex t, TrackBits b)
 	Track track = RemoveFirstTrack(&b);
 	SB(_m[t].m2, 8, 3, track == INVALID_TRACK ? 0 : track + 1);
 	SB(_m[t].m2, 11, 1, (byte)(b != TRACK_BIT_NONE));
+	_rail_state_generation++;
 }
 
 /**
@@ -301,6 +302,7 @@ static inline void SetDepotReservation(TileIndex t, bool b)
 {
 	assert_tile(IsRailDepot(t), t);
 	SB(_m[t].m5, 4, 1, (byte)b);
+	_rail_state_generation++;
 }
 
 /**
@@ -450,6 +452,7 @@ static inline void SetSignalAlwaysReserveThrough(TileIndex t, Track track, bool
 static inline void SetSignalStates(TileIndex tile, uint state)
 {
 	SB(_m[tile].m4, 4, 4, state);
+	_rail_state_generation++;
 }
 
 /**
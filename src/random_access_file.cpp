@@ -14,6 +14,14 @@
 #include "fileio_func.h"
 #include "string_func.h"
 
+#include <algorithm>
+
+#if defined(UNIX) && !defined(__OS2__) && defined(POINTER_IS_64BIT)
+#	define WITH_RANDOM_ACCESS_FILE_MMAP
+#	include <sys/mman.h>
+#	include <unistd.h>
+#endif
+
 #include "safeguards.h"
 
 /**
@@ -23,7 +31,7 @@
  */
 RandomAccessFile::RandomAccessFile(const std::string &filename, Subdirectory subdir) : filename(filename)
 {
-	this->file_handle = FioFOpenFile(filename, "rb", subdir);
+	this->file_handle = FioFOpenFile(filename, "rb", subdir, &this->file_size);
 	if (this->file_handle == nullptr) usererror("Cannot open file '%s'", filename.c_str());
 
 	/* When files are in a tar-file, the begin of the file might not be at 0. */
@@ -36,6 +44,29 @@ RandomAccessFile::RandomAccessFile(const std::string &filename, Subdirectory sub
 	this->simplified_filename = name_without_path.substr(0, name_without_path.rfind('.'));
 	strtolower(this->simplified_filename);
 
+	this->start_pos = (size_t)pos;
+	this->map_base = nullptr;
+	this->map_size = 0;
+	this->map_data = nullptr;
+
+#ifdef WITH_RANDOM_ACCESS_FILE_MMAP
+	/* Map the whole file, so that reads are served straight from the page cache instead of through fread and the local buffer.
+	 * The offset of the mapping must be aligned to a page, files in a tar-file generally do not start at a page boundary. */
+	if (this->file_size > 0) {
+		const size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+		const size_t map_offset = this->start_pos - (this->start_pos % page_size);
+		const size_t map_size = this->start_pos - map_offset + this->file_size;
+		void *ptr = mmap(nullptr, map_size, PROT_READ, MAP_PRIVATE, fileno(this->file_handle), (off_t)map_offset);
+		if (ptr != MAP_FAILED) {
+			this->map_base = static_cast<byte *>(ptr);
+			this->map_size = map_size;
+			this->map_data = this->map_base + (this->start_pos - map_offset);
+		} else {
+			DEBUG(misc, 3, "Memory mapping %s failed, reading it through a buffer instead", this->filename.c_str());
+		}
+	}
+#endif
+
 	this->SeekTo((size_t)pos, SEEK_SET);
 }
 
@@ -44,6 +75,9 @@ RandomAccessFile::RandomAccessFile(const std::string &filename, Subdirectory sub
  */
 RandomAccessFile::~RandomAccessFile()
 {
+#ifdef WITH_RANDOM_ACCESS_FILE_MMAP
+	if (this->map_base != nullptr) munmap(this->map_base, this->map_size);
+#endif
 	fclose(this->file_handle);
 }
 
@@ -66,6 +100,15 @@ const std::string &RandomAccessFile::GetSimplifiedFilename() const
 	return this->simplified_filename;
 }
 
+/**
+ * Get the size of the opened file. For files in a tar-file, this is the size of the file within the tar-file.
+ * @return Size of the file.
+ */
+size_t RandomAccessFile::GetFileSize() const
+{
+	return this->file_size;
+}
+
 /**
  * Get position in the file.
  * @return Position in the file.
@@ -84,6 +127,15 @@ void RandomAccessFile::SeekTo(size_t pos, int mode)
 {
 	if (mode == SEEK_CUR) pos += this->GetPos();
 
+	if (this->map_base != nullptr) {
+		/* Point the buffer into the memory mapping, seeking outside the file results in being at the end of the file. */
+		const size_t offset = (pos >= this->start_pos) ? std::min(pos - this->start_pos, this->file_size) : this->file_size;
+		this->buffer = this->map_data + offset;
+		this->buffer_end = this->map_data + this->file_size;
+		this->pos = this->start_pos + this->file_size;
+		return;
+	}
+
 	this->pos = pos;
 	if (fseek(this->file_handle, this->pos, SEEK_SET) < 0) {
 		DEBUG(misc, 0, "Seeking in %s failed", this->filename.c_str());
@@ -100,6 +152,9 @@ void RandomAccessFile::SeekTo(size_t pos, int mode)
 byte RandomAccessFile::ReadByteIntl()
 {
 	if (this->buffer == this->buffer_end) {
+		/* The whole file is in the buffer when it is memory mapped, so this is the end of the file. */
+		if (this->map_base != nullptr) return 0;
+
 		this->buffer = this->buffer_start;
 		size_t size = fread(this->buffer, 1, RandomAccessFile::BUFFER_SIZE, this->file_handle);
 		this->pos += size;
@@ -137,6 +192,13 @@ uint32 RandomAccessFile::ReadDwordIntl()
  */
 void RandomAccessFile::ReadBlock(void *ptr, size_t size)
 {
+	if (this->map_base != nullptr) {
+		size = std::min<size_t>(size, this->buffer_end - this->buffer);
+		memcpy(ptr, this->buffer, size);
+		this->buffer += size;
+		return;
+	}
+
 	this->SeekTo(this->GetPos(), SEEK_SET);
 	this->pos += fread(ptr, 1, size, this->file_handle);
 }
@@ -29,8 +29,14 @@ class RandomAccessFile {
 	std::string simplified_filename; ///< Simplified lowecase name of the file; only the name, no path or extension.
 
 	FILE *file_handle;               ///< File handle of the open file.
+	size_t file_size;                ///< Size of the open file.
+	size_t start_pos;                ///< Position of the begin of the file, this is not 0 for files in a tar-file.
 	size_t pos;                      ///< Position in the file of the end of the read buffer.
 
+	byte *map_base;                  ///< Start of the memory mapping of the file, or nullptr when the file is read through the local buffer.
+	size_t map_size;                 ///< Size of the memory mapping.
+	byte *map_data;                  ///< Byte at #start_pos within the memory mapping.
+
 	byte *buffer;                    ///< Current position within the local buffer.
 	byte *buffer_end;                ///< Last valid byte of buffer.
 	byte buffer_start[BUFFER_SIZE];  ///< Local buffer when read from file.
@@ -48,6 +54,7 @@ public:
 
 	const std::string &GetFilename() const;
 	const std::string &GetSimplifiedFilename() const;
+	size_t GetFileSize() const;
 
 	size_t GetPos() const;
 	void SeekTo(size_t pos, int mode);
@@ -446,6 +446,7 @@ static inline void SetCrossingReservation(TileIndex t, bool b)
 {
 	assert_tile(IsLevelCrossingTile(t), t);
 	SB(_m[t].m5, 4, 1, b ? 1 : 0);
+	_rail_state_generation++;
 }
 
 /**
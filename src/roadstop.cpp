@@ -175,12 +175,7 @@ void RoadStop::ClearDriveThrough()
 				rs_north = RoadStop::GetByTile(north_tile, rst);
 			}
 
-			/* We have to rebuild the entries because we cannot easily determine
-			 * how full each part is. So instead of keeping and maintaining a list
-			 * of vehicles and using that to 'rebuild' the occupied state we just
-			 * rebuild it from scratch as that removes lots of maintenance code
-			 * for the vehicle list and it's faster in real games as long as you
-			 * do not keep split and merge road stop every tick by the millions. */
+			/* Rebuild the entries of both parts from the occupancy of their tiles. */
 			rs_south_base->east->Rebuild(rs_south_base);
 			rs_south_base->west->Rebuild(rs_south_base);
 
@@ -256,12 +251,7 @@ void RoadStop::ChangeDriveThroughDisallowedRoadDirections(DisallowedRoadDirectio
 				rs_south->west = rs_south_base->west;
 			}
 
-			/* We have to rebuild the entries because we cannot easily determine
-			 * how full each part is. So instead of keeping and maintaining a list
-			 * of vehicles and using that to 'rebuild' the occupied state we just
-			 * rebuild it from scratch as that removes lots of maintenance code
-			 * for the vehicle list and it's faster in real games as long as you
-			 * do not keep split and merge road stop every tick by the millions. */
+			/* Rebuild the entries of both parts from the occupancy of their tiles. */
 			rs_south_base->east->Rebuild(rs_south_base);
 			rs_south_base->west->Rebuild(rs_south_base);
 		}
@@ -318,7 +308,10 @@ void RoadStop::Leave(RoadVehicle *rv)
 		this->SetEntranceBusy(false);
 	} else {
 		/* Otherwise just leave the drive through's entry cache. */
-		this->GetEntry(rv)->Leave(rv);
+		Entry *entry = this->GetEntry(rv);
+		entry->Leave(rv);
+		this->GetTileOccupied(entry) -= rv->gcache.cached_total_length;
+		assert(this->GetTileOccupied(entry) >= 0);
 	}
 }
 
@@ -346,13 +339,30 @@ bool RoadStop::Enter(RoadVehicle *rv)
 	}
 
 	/* Vehicles entering a drive-through stop from the 'normal' side use first bay (bay 0). */
-	this->GetEntry(rv)->Enter(rv);
+	Entry *entry = this->GetEntry(rv);
+	entry->Enter(rv);
+	this->GetTileOccupied(entry) += rv->gcache.cached_total_length;
 
 	/* Indicate a drive-through stop */
 	SetBit(rv->state, RVS_IN_DT_ROAD_STOP);
 	return true;
 }
 
+/**
+ * Move the occupancy of a vehicle to the next tile of the same drive through road stop, when the vehicle moves there.
+ * @param rv   the vehicle that moves
+ * @param next the road stop of the tile the vehicle moves to
+ */
+void RoadStop::MoveOccupancy(const RoadVehicle *rv, RoadStop *next)
+{
+	const Entry *entry = this->GetEntry(rv);
+	assert(next->GetEntry(rv) == entry);
+
+	this->GetTileOccupied(entry) -= rv->gcache.cached_total_length;
+	assert(this->GetTileOccupied(entry) >= 0);
+	next->GetTileOccupied(entry) += rv->gcache.cached_total_length;
+}
+
 /**
  * Find a roadstop at given tile
  * @param tile tile with roadstop
@@ -409,43 +419,65 @@ void RoadStop::Entry::Enter(const RoadVehicle *rv)
 			GetDriveThroughStopDisallowedRoadDirections(next) == GetDriveThroughStopDisallowedRoadDirections(rs);
 }
 
-typedef std::list<const RoadVehicle *> RVList; ///< A list of road vehicles
-
-/** Helper for finding RVs in a road stop. */
-struct RoadStopEntryRebuilderHelper {
-	RVList vehicles;   ///< The list of vehicles to possibly add to.
-	DiagDirection dir; ///< The direction the vehicle has to face to be added.
+/** Helper for counting the space occupied by RVs on a road stop tile. */
+struct RoadStopTileOccupancyHelper {
+	DiagDirection dir; ///< The direction the vehicle has to face to be counted.
+	int occupied;      ///< The occupied space of the counted vehicles.
 };
 
 /**
- * Add road vehicles to the station's list if needed.
+ * Count the space occupied by a road vehicle if needed.
  * @param v the found vehicle
  * @param data the extra data used to make our decision
  * @return always nullptr
  */
-Vehicle *FindVehiclesInRoadStop(Vehicle *v, void *data)
+Vehicle *CountVehiclesInRoadStop(Vehicle *v, void *data)
 {
-	RoadStopEntryRebuilderHelper *rserh = (RoadStopEntryRebuilderHelper*)data;
+	RoadStopTileOccupancyHelper *helper = (RoadStopTileOccupancyHelper*)data;
 	/* Not a RV or not in the right direction or crashed :( */
 	DiagDirection diag_dir = DirToDiagDir(v->direction);
 	if (RoadVehicle::From(v)->overtaking != 0) diag_dir = ReverseDiagDir(diag_dir);
-	if (diag_dir != rserh->dir || !v->IsPrimaryVehicle() || (v->vehstatus & VS_CRASHED) != 0) return nullptr;
+	if (diag_dir != helper->dir || !v->IsPrimaryVehicle() || (v->vehstatus & VS_CRASHED) != 0) return nullptr;
 
 	RoadVehicle *rv = RoadVehicle::From(v);
-	/* Don't add ones not in a road stop */
+	/* Don't count ones not in a road stop */
 	if (rv->state < RVSB_IN_ROAD_STOP) return nullptr;
 
-	/* Do not add duplicates! */
-	for (RVList::iterator it = rserh->vehicles.begin(); it != rserh->vehicles.end(); it++) {
-		if (rv == *it) return nullptr;
-	}
-
-	rserh->vehicles.push_back(rv);
+	helper->occupied += rv->gcache.cached_total_length;
 	return nullptr;
 }
 
 /**
- * Rebuild, from scratch, the vehicles and other metadata on this stop.
+ * Count, from scratch, the space occupied by the vehicles with their front on this tile.
+ * @param dir the direction the vehicles have to face to be counted
+ * @return the occupied space in tile units
+ */
+int RoadStop::CountTileOccupied(DiagDirection dir) const
+{
+	RoadStopTileOccupancyHelper helper;
+	helper.dir = dir;
+	helper.occupied = 0;
+	FindVehicleOnPos(this->xy, VEH_ROAD, &helper, CountVehiclesInRoadStop);
+	return helper.occupied;
+}
+
+/**
+ * Rebuild, from scratch, the occupancy of the tiles of all drive through road stops.
+ * This is only needed after loading a game; afterwards the occupancy is kept up to date when vehicles move.
+ */
+/* static */ void RoadStop::RebuildTileOccupancy()
+{
+	for (RoadStop *rs : RoadStop::Iterate()) {
+		if (rs->east == nullptr) continue;
+
+		DiagDirection dir = GetRoadStopDir(rs->xy);
+		rs->occupied_east = rs->CountTileOccupied(dir);
+		rs->occupied_west = rs->CountTileOccupied(ReverseDiagDir(dir));
+	}
+}
+
+/**
+ * Rebuild the length and the occupied space of this entry from the occupancy of the tiles of the stop.
  * @param rs   the roadstop this entry is part of
  * @param side the side of the road stop to look at
  */
@@ -453,28 +485,23 @@ void RoadStop::Entry::Rebuild(const RoadStop *rs, int side)
 {
 	assert(HasBit(rs->status, RSSFB_BASE_ENTRY));
 
+	RoadStopType rst = GetRoadStopType(rs->xy);
 	DiagDirection dir = GetRoadStopDir(rs->xy);
 	if (side == -1) side = (rs->east == this);
 
-	RoadStopEntryRebuilderHelper rserh;
-	rserh.dir = side ? dir : ReverseDiagDir(dir);
-
 	this->length = 0;
+	this->occupied = 0;
 	TileIndexDiff offset = abs(TileOffsByDiagDir(dir));
 	for (TileIndex tile = rs->xy; IsDriveThroughRoadStopContinuation(rs->xy, tile); tile += offset) {
+		const RoadStop *tile_rs = RoadStop::GetByTile(tile, rst);
 		this->length += TILE_SIZE;
-		FindVehicleOnPos(tile, VEH_ROAD, &rserh, FindVehiclesInRoadStop);
-	}
-
-	this->occupied = 0;
-	for (RVList::iterator it = rserh.vehicles.begin(); it != rserh.vehicles.end(); it++) {
-		this->occupied += (*it)->gcache.cached_total_length;
+		this->occupied += side ? tile_rs->occupied_east : tile_rs->occupied_west;
 	}
 }
 
 
 /**
- * Check the integrity of the data in this struct.
+ * Check the integrity of the data in this struct and of the occupancy of the tiles of the stop.
  * @param rs the roadstop this entry is part of
  */
 void RoadStop::Entry::CheckIntegrity(const RoadStop *rs) const
@@ -484,7 +511,19 @@ void RoadStop::Entry::CheckIntegrity(const RoadStop *rs) const
 	/* The tile 'before' the road stop must not be part of this 'line' */
 	assert(!IsDriveThroughRoadStopContinuation(rs->xy, rs->xy - abs(TileOffsByDiagDir(GetRoadStopDir(rs->xy)))));
 
-	Entry temp;
-	temp.Rebuild(rs, rs->east == this);
-	if (temp.length != this->length || temp.occupied != this->occupied) NOT_REACHED();
+	RoadStopType rst = GetRoadStopType(rs->xy);
+	DiagDirection dir = GetRoadStopDir(rs->xy);
+	bool side = (rs->east == this);
+
+	int length = 0;
+	int occupied = 0;
+	TileIndexDiff offset = abs(TileOffsByDiagDir(dir));
+	for (TileIndex tile = rs->xy; IsDriveThroughRoadStopContinuation(rs->xy, tile); tile += offset) {
+		const RoadStop *tile_rs = RoadStop::GetByTile(tile, rst);
+		int tile_occupied = tile_rs->CountTileOccupied(side ? dir : ReverseDiagDir(dir));
+		if (tile_occupied != (side ? tile_rs->occupied_east : tile_rs->occupied_west)) NOT_REACHED();
+		length += TILE_SIZE;
+		occupied += tile_occupied;
+	}
+	if (length != this->length || occupied != this->occupied) NOT_REACHED();
 }
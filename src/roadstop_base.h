@@ -152,17 +152,34 @@ struct RoadStop : RoadStopPool::PoolItem<&_roadstop_pool> {
 
 	void Leave(RoadVehicle *rv);
 	bool Enter(RoadVehicle *rv);
+	void MoveOccupancy(const RoadVehicle *rv, RoadStop *next);
 
 	RoadStop *GetNextRoadStop(const struct RoadVehicle *v) const;
 
 	static RoadStop *GetByTile(TileIndex tile, RoadStopType type);
 
 	static bool IsDriveThroughRoadStopContinuation(TileIndex rs, TileIndex next);
+	static void RebuildTileOccupancy();
 
 private:
 	Entry *east; ///< The vehicles that entered from the east
 	Entry *west; ///< The vehicles that entered from the west
 
+	int occupied_east = 0; ///< The amount of the east entry occupied by vehicles with their front on this tile, in tile 'units'
+	int occupied_west = 0; ///< The amount of the west entry occupied by vehicles with their front on this tile, in tile 'units'
+
+	/**
+	 * Get the amount of the given entry occupied by vehicles with their front on this tile.
+	 * @param entry The entry, either #east or #west.
+	 * @return the occupied space of this tile in tile units.
+	 */
+	inline int &GetTileOccupied(const Entry *entry)
+	{
+		return entry == this->east ? this->occupied_east : this->occupied_west;
+	}
+
+	int CountTileOccupied(DiagDirection dir) const;
+
 	/**
 	 * Allocates a bay
 	 * @return the allocated bay number
@@ -344,8 +344,6 @@ CommandCost CmdBuildRoadVehicle(TileIndex tile, DoCommandFlag flags, const Engin
 		v->UpdatePosition();
 
 		CheckConsistencyOfArticulatedVehicle(v);
-
-		InvalidateVehicleTickCaches();
 	}
 
 	return CommandCost();
@@ -686,10 +684,14 @@ struct RoadVehFindData {
 	Direction dir;
 };
 
+/** Distances per direction, not inclusive, in front of a position within which a road vehicle is close to it. */
+static const int8 _road_veh_close_dist_x[] = { -4, -8, -4, -1, 4, 8, 4, 1 };
+static const int8 _road_veh_close_dist_y[] = { -4, -1, 4, 8, 4, 1, -4, -8 };
+
 static Vehicle *EnumCheckRoadVehClose(Vehicle *v, void *data)
 {
-	static const int8 dist_x[] = { -4, -8, -4, -1, 4, 8, 4, 1 };
-	static const int8 dist_y[] = { -4, -1, 4, 8, 4, 1, -4, -8 };
+	const int8 *dist_x = _road_veh_close_dist_x;
+	const int8 *dist_y = _road_veh_close_dist_y;
 
 	RoadVehFindData *rvf = (RoadVehFindData*)data;
 
@@ -732,7 +734,15 @@ static RoadVehicle *RoadVehFindCloseTo(RoadVehicle *v, int x, int y, Direction d
 		FindVehicleOnPos(v->tile, VEH_ROAD, &rvf, EnumCheckRoadVehClose);
 		FindVehicleOnPos(GetOtherTunnelBridgeEnd(v->tile), VEH_ROAD, &rvf, EnumCheckRoadVehClose);
 	} else {
-		FindVehicleOnPosXY(x, y, VEH_ROAD, &rvf, EnumCheckRoadVehClose);
+		/* Only scan the part of the area scanned by FindVehicleOnPosXY in which vehicles can be close, in front of x, y. */
+		const int COLL_DIST = 6;
+		int dist_x = _road_veh_close_dist_x[dir];
+		int dist_y = _road_veh_close_dist_y[dir];
+		int xl = dist_x < 0 ? std::max(x + dist_x + 1, x - COLL_DIST) : x;
+		int xu = dist_x > 0 ? std::min(x + dist_x - 1, x + COLL_DIST) : x;
+		int yl = dist_y < 0 ? std::max(y + dist_y + 1, y - COLL_DIST) : y;
+		int yu = dist_y > 0 ? std::min(y + dist_y - 1, y + COLL_DIST) : y;
+		FindVehicleOnPosXYArea(xl, yl, xu, yu, VEH_ROAD, &rvf, EnumCheckRoadVehClose);
 	}
 
 	/* This code protects a roadvehicle from being blocked for ever
@@ -1271,7 +1281,7 @@ static Trackdir RoadFindPathToDest(RoadVehicle *v, TileIndex tile, DiagDirection
 		default: NOT_REACHED();
 	}
 	DEBUG_UPDATESTATECHECKSUM("RoadFindPathToDest: v: %u, path_found: %d, best_track: %d", v->index, path_found, best_track);
-	UpdateStateChecksum((((uint64) v->index) << 32) | (path_found << 16) | best_track);
+	UpdateStateChecksum((((uint64) v->index) << 32) | (path_found << 16) | best_track, SCP_VEHICLES);
 	v->HandlePathfindingResult(path_found);
 
 found_best_track:;
@@ -1839,6 +1849,10 @@ again:
 					v->tile != tile) {
 				/* So, keep 'our' state */
 				dir = (Trackdir)v->state;
+				if (v->IsFrontEngine() && IsInsideMM(v->state, RVSB_IN_DT_ROAD_STOP, RVSB_IN_DT_ROAD_STOP_END)) {
+					RoadStopType rst = GetRoadStopType(v->tile);
+					RoadStop::GetByTile(v->tile, rst)->MoveOccupancy(v, RoadStop::GetByTile(tile, rst));
+				}
 			} else if (IsStationRoadStop(v->tile)) {
 				/* We're not continuing our drive through road stop, so leave. */
 				RoadStop::GetByTile(v->tile, GetRoadStopType(v->tile))->Leave(v);
@@ -2200,9 +2214,9 @@ Money RoadVehicle::GetRunningCost() const
 bool RoadVehicle::Tick()
 {
 	DEBUG_UPDATESTATECHECKSUM("RoadVehicle::Tick 1: v: %u, x: %d, y: %d", this->index, this->x_pos, this->y_pos);
-	UpdateStateChecksum((((uint64) this->x_pos) << 32) | this->y_pos);
+	UpdateStateChecksum((((uint64) this->x_pos) << 32) | this->y_pos, SCP_VEHICLES);
 	DEBUG_UPDATESTATECHECKSUM("RoadVehicle::Tick 2: v: %u, state: %d, frame: %d", this->index, this->state, this->frame);
-	UpdateStateChecksum((((uint64) this->state) << 32) | this->frame);
+	UpdateStateChecksum((((uint64) this->state) << 32) | this->frame, SCP_VEHICLES);
 	if (this->IsFrontEngine()) {
 		if (!(this->IsRoadVehicleStopped() || this->IsWaitingInDepot())) this->running_ticks++;
 		return RoadVehController(this);
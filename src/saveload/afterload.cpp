@@ -11,6 +11,7 @@
 #include "../void_map.h"
 #include "../signs_base.h"
 #include "../depot_base.h"
+#include "../depot_kdtree.h"
 #include "../tunnel_base.h"
 #include "../fios.h"
 #include "../gamelog_internal.h"
@@ -72,6 +73,8 @@
 #include "../newgrf_industrytiles.h"
 
 
+#include "../worker_thread.h"
+
 #include "saveload_internal.h"
 
 #include <signal.h>
@@ -243,6 +246,41 @@ void ClearAllCachedNames()
 	ClearAllIndustryCachedNames();
 }
 
+/** A pass of AfterLoadGame which may run concurrently with the other passes of its graph, see RunAfterLoadTasks. */
+struct AfterLoadTask {
+	void (*proc)();      ///< Function performing the pass.
+	uint32 dependencies; ///< Bit mask of the indices of the tasks in the graph which must have completed before this one starts.
+};
+
+/**
+ * Run a dependency graph of AfterLoadGame passes.
+ * The passes are run in waves of all tasks of which the dependencies have completed, the tasks of a wave run concurrently.
+ * Tasks without a dependency between them must not write any state which the other reads or writes,
+ * the result is then the same as when running the tasks one by one in the order given.
+ * @param tasks The tasks, each task may only depend on tasks before it.
+ */
+static void RunAfterLoadTasks(std::initializer_list<AfterLoadTask> tasks)
+{
+	assert(tasks.size() <= 32);
+	const AfterLoadTask *task_list = tasks.begin();
+	const uint32 all_tasks = (uint32)((1ULL << tasks.size()) - 1);
+
+	uint32 done = 0;
+	std::vector<uint> wave;
+	while (done != all_tasks) {
+		wave.clear();
+		for (uint i = 0; i < tasks.size(); i++) {
+			if (!HasBit(done, i) && (task_list[i].dependencies & ~done) == 0) wave.push_back(i);
+		}
+		assert(!wave.empty());
+
+		_general_worker_pool.ParallelFor(wave.size(), 1, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) task_list[wave[i]].proc();
+		});
+		for (uint i : wave) SetBit(done, i);
+	}
+}
+
 /**
  * Initialization of the windows and several kinds of caches.
  * This is not done directly in AfterLoadGame because these
@@ -633,8 +671,10 @@ bool AfterLoadGame()
 	GamelogTestRevision();
 	GamelogTestMode();
 
-	RebuildTownKdtree();
-	RebuildStationKdtree();
+	RunAfterLoadTasks({
+		{ &RebuildTownKdtree,    0 },
+		{ &RebuildStationKdtree, 0 },
+	});
 	UpdateCachedSnowLine();
 	UpdateCachedSnowLineBounds();
 
@@ -689,25 +729,25 @@ bool AfterLoadGame()
 
 		/* In old savegame versions, the heightlevel was coded in bits 0..3 of the type field */
 		for (TileIndex t = 0; t < map_size; t++) {
-			_m[t].height = GB(_m[t].type, 0, 4);
-			SB(_m[t].type, 0, 2, GB(_me[t].m6, 0, 2));
+			_mth[t].height = GB(_mth[t].type, 0, 4);
+			SB(_mth[t].type, 0, 2, GB(_me[t].m6, 0, 2));
 			SB(_me[t].m6, 0, 2, 0);
 			if (MayHaveBridgeAbove(t)) {
-				SB(_m[t].type, 2, 2, GB(_me[t].m6, 6, 2));
+				SB(_mth[t].type, 2, 2, GB(_me[t].m6, 6, 2));
 				SB(_me[t].m6, 6, 2, 0);
 			} else {
-				SB(_m[t].type, 2, 2, 0);
+				SB(_mth[t].type, 2, 2, 0);
 			}
 		}
 	} else if (IsSavegameVersionBefore(SLV_194) && SlXvIsFeaturePresent(XSLFI_HEIGHT_8_BIT)) {
 		for (TileIndex t = 0; t < map_size; t++) {
-			SB(_m[t].type, 0, 2, GB(_me[t].m6, 0, 2));
+			SB(_mth[t].type, 0, 2, GB(_me[t].m6, 0, 2));
 			SB(_me[t].m6, 0, 2, 0);
 			if (MayHaveBridgeAbove(t)) {
-				SB(_m[t].type, 2, 2, GB(_me[t].m6, 6, 2));
+				SB(_mth[t].type, 2, 2, GB(_me[t].m6, 6, 2));
 				SB(_me[t].m6, 6, 2, 0);
 			} else {
-				SB(_m[t].type, 2, 2, 0);
+				SB(_mth[t].type, 2, 2, 0);
 			}
 		}
 	}
@@ -860,6 +900,7 @@ bool AfterLoadGame()
 	/* Load the sprites */
 	GfxLoadSprites();
 	LoadStringWidthTable();
+	SlProfileStage("afterload: sprites");
 
 	/* Copy temporary data to Engine pool */
 	CopyTempEngineData();
@@ -960,6 +1001,7 @@ bool AfterLoadGame()
 
 	/* Update template vehicles */
 	AfterLoadTemplateVehicles();
+	SlProfileStage("afterload: engines and vehicles");
 
 	/* Make sure there is an AI attached to an AI company */
 	{
@@ -1732,6 +1774,7 @@ bool AfterLoadGame()
 	}
 
 	AfterLoadStations();
+	SlProfileStage("afterload: early conversions and stations");
 
 	/* Time starts at 0 instead of 1920.
 	 * Account for this in older games by adding an offset */
@@ -3812,6 +3855,8 @@ bool AfterLoadGame()
 		}
 	}
 
+	SlProfileStage("afterload: map conversions");
+
 	/* Compute station catchment areas. This is needed here in case UpdateStationAcceptance is called below. */
 	Station::RecomputeCatchmentForAll();
 
@@ -3819,6 +3864,7 @@ bool AfterLoadGame()
 	if (IsSavegameVersionBefore(SLV_127)) {
 		for (Station *st : Station::Iterate()) UpdateStationAcceptance(st, false);
 	}
+	SlProfileStage("afterload: station catchment");
 
 	// setting moved from game settings to company settings
 	if (SlXvIsFeaturePresent(XSLFI_ORDER_OCCUPANCY, 1, 1)) {
@@ -3942,6 +3988,8 @@ bool AfterLoadGame()
 
 	if (SlXvIsFeatureMissing(XSLFI_ANIMATED_TILE_EXTRA)) {
 		UpdateAllAnimatedTileSpeeds();
+	} else {
+		RebuildAnimatedTileBuckets();
 	}
 
 	if (!SlXvIsFeaturePresent(XSLFI_REALISTIC_TRAIN_BRAKING, 2)) {
@@ -4108,21 +4156,26 @@ bool AfterLoadGame()
 
 	InitializeRoadGUI();
 
-	/* This needs to be done after conversion. */
-	RebuildViewportKdtree();
-	ViewportMapBuildTunnelCache();
-
-	/* Road stops is 'only' updating some caches */
-	AfterLoadRoadStops();
-	AfterLoadLabelMaps();
-	AfterLoadCompanyStats();
-	AfterLoadStoryBook();
+	/* These need to be done after conversion.
+	 * Road stops is 'only' updating some caches, this and the company statistics read the rail types rewritten by the label maps. */
+	RunAfterLoadTasks({
+		{ &AfterLoadLabelMaps,          0 },
+		{ &RebuildViewportKdtree,       0 },
+		{ &RebuildAirportKdtree,        0 },
+		{ &RebuildShipDepotKdtree,      1 << 0 },
+		{ &ViewportMapBuildTunnelCache, 0 },
+		{ &AfterLoadStoryBook,          0 },
+		{ &AfterLoadRoadStops,          1 << 0 },
+		{ &AfterLoadCompanyStats,       1 << 0 },
+	});
 
 	AfterLoadVehiclesRemoveAnyFoundInvalid();
+	SlProfileStage("afterload: late conversions");
 
 	GamelogPrintDebug(1);
 
 	InitializeWindowsAndCaches();
+	SlProfileStage("afterload: windows and caches");
 	/* Restore the signals */
 	ResetSignalHandlers();
 
@@ -4169,6 +4222,7 @@ bool AfterLoadGame()
 	_game_load_tick_skip_counter = _tick_skip_counter;
 	_game_load_time = time(nullptr);
 
+	SlProfileStage("afterload: link graphs and vehicle caches");
 	return true;
 }
 
@@ -4192,12 +4246,14 @@ void ReloadNewGRFData()
 
 	/* reload grf data */
 	GfxLoadSprites();
+	MarkAllTileAcceptanceChanged();
 	RecomputePrices();
 	LoadStringWidthTable();
 	/* reload vehicles */
 	ResetVehicleHash();
 	AfterLoadEngines();
 	AnalyseIndustryTileSpriteGroups();
+	for (Vehicle *v : Vehicle::Iterate()) v->InvalidateNewGRFCache();
 	AfterLoadVehicles(false);
 	StartupEngines();
 	GroupStatistics::UpdateAfterLoad();
@@ -131,6 +131,9 @@ SaveLoadTable GetCargoPacketDesc()
  */
 static void Save_CAPA()
 {
+	/* Vehicles age their packets lazily, save the real days in transit. */
+	for (Vehicle *v : Vehicle::Iterate()) v->cargo.ApplyPendingAge();
+
 	std::vector<SaveLoad> filtered_packet_desc = SlFilterObject(GetCargoPacketDesc());
 	for (CargoPacket *cp : CargoPacket::Iterate()) {
 		SlSetArrayIndex(cp->index);
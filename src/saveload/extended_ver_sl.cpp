@@ -175,6 +175,9 @@ const SlxiSubChunkInfo _sl_xv_sub_chunk_infos[] = {
 	{ XSLFI_INDUSTRY_ANIM_MASK,     XSCF_IGNORABLE_ALL,       1,   1, "industry_anim_mask",        nullptr, nullptr, nullptr        },
 	{ XSLFI_NEW_SIGNAL_STYLES,      XSCF_NULL,                2,   2, "new_signal_styles",         nullptr, nullptr, "XBST,NSID"    },
 	{ XSLFI_NO_TREE_COUNTER,        XSCF_IGNORABLE_ALL,       1,   1, "no_tree_counter",           nullptr, nullptr, nullptr        },
+	{ XSLFI_LINKGRAPH_DEMAND_CACHE, XSCF_NULL,                1,   1, "linkgraph_demand_cache",    nullptr, nullptr, nullptr        },
+	{ XSLFI_STATE_CHECKSUM_PARTS,   XSCF_NULL,                1,   1, "state_checksum_parts",      nullptr, nullptr, nullptr        },
+	{ XSLFI_TOWN_GROWTH_FRONTIER,   XSCF_NULL,                1,   1, "town_growth_frontier",      nullptr, nullptr, nullptr        },
 	{ XSLFI_SCRIPT_INT64,           XSCF_NULL,                1,   1, "script_int64",              nullptr, nullptr, nullptr        },
 	{ XSLFI_U64_TICK_COUNTER,       XSCF_NULL,                1,   1, "u64_tick_counter",          nullptr, nullptr, nullptr        },
 	{ XSLFI_NULL, XSCF_NULL, 0, 0, nullptr, nullptr, nullptr, nullptr },// This is the end marker
@@ -128,6 +128,9 @@ enum SlXvFeatureIndex {
 	XSLFI_INDUSTRY_ANIM_MASK,                     ///< Industry tile animation masking
 	XSLFI_NEW_SIGNAL_STYLES,                      ///< New signal styles
 	XSLFI_NO_TREE_COUNTER,                        ///< No tree counter
+	XSLFI_LINKGRAPH_DEMAND_CACHE,                 ///< Link graph node demand cache and demand reuse threshold setting
+	XSLFI_STATE_CHECKSUM_PARTS,                   ///< State checksums of parts of the game state
+	XSLFI_TOWN_GROWTH_FRONTIER,                   ///< Town growth frontier and town growth frontier setting
 
 	XSLFI_SCRIPT_INT64,                           ///< See: SLV_SCRIPT_INT64
 	XSLFI_U64_TICK_COUNTER,                       ///< See: SLV_U64_TICK_COUNTER
@@ -18,7 +18,21 @@
 #include "../safeguards.h"
 
 typedef LinkGraph::BaseNode Node;
-typedef LinkGraph::BaseEdge Edge;
+
+/**
+ * Edge as stored in savegames: the edges of a node form a chain, starting at
+ * the node's link to itself, which has no other meaning.
+ */
+struct Edge : LinkGraph::BaseEdge {
+	NodeID next_edge; ///< Destination of next valid edge starting at the same source node.
+
+	/** Reset the edge, so that fields missing from old savegames have their default values. */
+	void Reset()
+	{
+		static_cast<LinkGraph::BaseEdge &>(*this) = LinkGraph::empty_edge;
+		this->next_edge = INVALID_NODE;
+	}
+};
 
 const SettingDesc *GetSettingDescription(uint index);
 
@@ -117,6 +131,10 @@ static const SaveLoad _node_desc[] = {
 	    SLE_VAR(Node, demand,      SLE_UINT32),
 	    SLE_VAR(Node, station,     SLE_UINT16),
 	    SLE_VAR(Node, last_update, SLE_INT32),
+	SLE_CONDVAR_X(Node, demand_cache.key,            SLE_UINT32, SL_MIN_VERSION, SL_MAX_VERSION, SlXvFeatureTest(XSLFTO_AND, XSLFI_LINKGRAPH_DEMAND_CACHE)),
+	SLE_CONDVAR_X(Node, demand_cache.supply,         SLE_UINT32, SL_MIN_VERSION, SL_MAX_VERSION, SlXvFeatureTest(XSLFTO_AND, XSLFI_LINKGRAPH_DEMAND_CACHE)),
+	SLE_CONDVAR_X(Node, demand_cache.acceptance,     SLE_UINT32, SL_MIN_VERSION, SL_MAX_VERSION, SlXvFeatureTest(XSLFTO_AND, XSLFI_LINKGRAPH_DEMAND_CACHE)),
+	SLE_CONDVAR_X(Node, demand_cache.component_size, SLE_UINT16, SL_MIN_VERSION, SL_MAX_VERSION, SlXvFeatureTest(XSLFTO_AND, XSLFI_LINKGRAPH_DEMAND_CACHE)),
 };
 
 /**
@@ -151,15 +169,38 @@ void Save_LinkGraph(LinkGraph &lg)
 {
 	uint16 size = lg.Size();
 	for (NodeID from = 0; from < size; ++from) {
-		Node *node = &lg.nodes[from];
+		Node *node = lg.nodes[from].get();
 		SlObjectSaveFiltered(node, _filtered_node_desc);
+		SlWriteUint32((uint32)node->demand_cache.demands.size());
+		for (const auto &demand : node->demand_cache.demands) {
+			SlWriteUint16(demand.first);
+			SlWriteUint32(demand.second);
+		}
 		/* ... but as that wasted a lot of space we save a sparse matrix now. */
-		for (NodeID to = from; to != INVALID_NODE; to = lg.edges[from][to].next_edge) {
-			SlObjectSaveFiltered(&lg.edges[from][to], _filtered_edge_desc);
+		Edge edge;
+		edge.Reset();
+		edge.next_edge = node->edges.empty() ? INVALID_NODE : node->edges.front().dest_node;
+		SlObjectSaveFiltered(&edge, _filtered_edge_desc);
+		for (size_t i = 0; i < node->edges.size(); ++i) {
+			static_cast<LinkGraph::BaseEdge &>(edge) = node->edges[i];
+			edge.next_edge = (i + 1 < node->edges.size()) ? node->edges[i + 1].dest_node : INVALID_NODE;
+			SlObjectSaveFiltered(&edge, _filtered_edge_desc);
 		}
 	}
 }
 
+/**
+ * Add an edge loaded from a savegame to a node.
+ * @param node Node to add the edge to.
+ * @param edge Loaded edge.
+ * @param to Destination of the edge.
+ */
+static void AddLoadedEdge(Node *node, const Edge &edge, NodeID to)
+{
+	node->edges.push_back(edge);
+	node->edges.back().dest_node = to;
+}
+
 /**
  * Load a link graph.
  * @param lg Link graph to be saved or loaded.
@@ -167,21 +208,45 @@ void Save_LinkGraph(LinkGraph &lg)
 void Load_LinkGraph(LinkGraph &lg)
 {
 	uint size = lg.Size();
+	std::vector<Edge> row;
 	for (NodeID from = 0; from < size; ++from) {
-		Node *node = &lg.nodes[from];
+		Node *node = lg.nodes[from].get();
 		SlObjectLoadFiltered(node, _filtered_node_desc);
+		if (SlXvIsFeaturePresent(XSLFI_LINKGRAPH_DEMAND_CACHE)) {
+			uint32 count = SlReadUint32();
+			if (count > size) SlErrorCorrupt("Link graph demand cache overflow");
+			node->demand_cache.demands.resize(count);
+			for (auto &demand : node->demand_cache.demands) {
+				demand.first = SlReadUint16();
+				demand.second = SlReadUint32();
+			}
+		}
 		if (IsSavegameVersionBefore(SLV_191)) {
 			/* We used to save the full matrix ... */
+			row.resize(size);
 			for (NodeID to = 0; to < size; ++to) {
-				SlObjectLoadFiltered(&lg.edges[from][to], _filtered_edge_desc);
+				row[to].Reset();
+				SlObjectLoadFiltered(&row[to], _filtered_edge_desc);
+			}
+			for (NodeID to = row[from].next_edge; to != INVALID_NODE; to = row[to].next_edge) {
+				if (to >= size || to == from || node->edges.size() >= size) SlErrorCorrupt("Link graph structure overflow");
+				AddLoadedEdge(node, row[to], to);
 			}
 		} else {
 			/* ... but as that wasted a lot of space we save a sparse matrix now. */
-			for (NodeID to = from; to != INVALID_NODE; to = lg.edges[from][to].next_edge) {
-				if (to >= size) SlErrorCorrupt("Link graph structure overflow");
-				SlObjectLoadFiltered(&lg.edges[from][to], _filtered_edge_desc);
+			Edge edge;
+			edge.Reset();
+			SlObjectLoadFiltered(&edge, _filtered_edge_desc);
+			for (NodeID to = edge.next_edge; to != INVALID_NODE; to = edge.next_edge) {
+				if (to >= size || to == from || node->edges.size() >= size) SlErrorCorrupt("Link graph structure overflow");
+				edge.Reset();
+				SlObjectLoadFiltered(&edge, _filtered_edge_desc);
+				AddLoadedEdge(node, edge, to);
 			}
 		}
+		std::sort(node->edges.begin(), node->edges.end(), [](const LinkGraph::BaseEdge &a, const LinkGraph::BaseEdge &b) {
+			return a.dest_node < b.dest_node;
+		});
 	}
 }
 
@@ -55,15 +55,37 @@ static void Check_MAPS()
 
 static const uint MAP_SL_BUF_SIZE = 4096;
 
-static void Load_MAPT()
+/**
+ * Load a plane of byte sized fields of all tiles, straight from the savegame buffer.
+ * @param array The map array the field is part of.
+ * @param field The field to load.
+ */
+template <typename T>
+static void LoadMapPlane8(T *array, byte T::*field)
 {
-	std::array<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
+	T *tile = array;
+	ReadBuffer::GetCurrent()->ReadRecords(MapSize(), 1, [&](const byte *src, size_t count) {
+		for (size_t j = 0; j != count; j++) (tile++)->*field = src[j];
+	});
+}
 
-	for (TileIndex i = 0; i != size;) {
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].type = buf[j];
-	}
+/**
+ * Load a plane of 16 bit fields of all tiles, straight from the savegame buffer.
+ * @param array The map array the field is part of.
+ * @param field The field to load.
+ */
+template <typename T>
+static void LoadMapPlane16(T *array, uint16 T::*field)
+{
+	T *tile = array;
+	ReadBuffer::GetCurrent()->ReadRecords(MapSize(), 2, [&](const byte *src, size_t count) {
+		for (size_t j = 0; j != count; j++, src += 2) (tile++)->*field = (src[0] << 8) | src[1];
+	});
+}
+
+static void Load_MAPT()
+{
+	LoadMapPlane8(_mth, &TileTypeHeight::type);
 }
 
 static void Check_MAPH_common()
@@ -92,77 +114,50 @@ static void Load_MAPH()
 
 			for (TileIndex i = 0; i != size;) {
 				SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT16);
-				for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].height = buf[j];
+				for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _mth[i++].height = buf[j];
 			}
 		}
 		return;
 	}
 
-	std::array<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	for (TileIndex i = 0; i != size;) {
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].height = buf[j];
-	}
+	LoadMapPlane8(_mth, &TileTypeHeight::height);
 }
 
 static void Load_MAP1()
 {
-	std::array<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	for (TileIndex i = 0; i != size;) {
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].m1 = buf[j];
-	}
+	LoadMapPlane8(_m, &Tile::m1);
 }
 
 static void Load_MAP2()
 {
+	if (!IsSavegameVersionBefore(SLV_5)) {
+		LoadMapPlane16(_m, &Tile::m2);
+		return;
+	}
+
+	/* In those versions the m2 was 8 bits */
 	std::array<uint16, MAP_SL_BUF_SIZE> buf;
 	TileIndex size = MapSize();
 
 	for (TileIndex i = 0; i != size;) {
-		SlArray(buf.data(), MAP_SL_BUF_SIZE,
-			/* In those versions the m2 was 8 bits */
-			IsSavegameVersionBefore(SLV_5) ? SLE_FILE_U8 | SLE_VAR_U16 : SLE_UINT16
-		);
+		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_FILE_U8 | SLE_VAR_U16);
 		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].m2 = buf[j];
 	}
 }
 
 static void Load_MAP3()
 {
-	std::array<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	for (TileIndex i = 0; i != size;) {
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].m3 = buf[j];
-	}
+	LoadMapPlane8(_m, &Tile::m3);
 }
 
 static void Load_MAP4()
 {
-	std::array<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	for (TileIndex i = 0; i != size;) {
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].m4 = buf[j];
-	}
+	LoadMapPlane8(_m, &Tile::m4);
 }
 
 static void Load_MAP5()
 {
-	std::array<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	for (TileIndex i = 0; i != size;) {
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].m5 = buf[j];
-	}
+	LoadMapPlane8(_m, &Tile::m5);
 }
 
 static void Load_MAP6()
@@ -182,60 +177,48 @@ static void Load_MAP6()
 			}
 		}
 	} else {
-		for (TileIndex i = 0; i != size;) {
-			SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _me[i++].m6 = buf[j];
-		}
+		LoadMapPlane8(_me, &TileExtended::m6);
 	}
 }
 
 static void Load_MAP7()
 {
-	std::array<byte, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	for (TileIndex i = 0; i != size;) {
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _me[i++].m7 = buf[j];
-	}
+	LoadMapPlane8(_me, &TileExtended::m7);
 }
 
 static void Load_MAP8()
 {
-	std::array<uint16, MAP_SL_BUF_SIZE> buf;
-	TileIndex size = MapSize();
-
-	for (TileIndex i = 0; i != size;) {
-		SlArray(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT16);
-		for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _me[i++].m8 = buf[j];
-	}
+	LoadMapPlane16(_me, &TileExtended::m8);
 }
 
 static void Load_WMAP()
 {
-	static_assert(sizeof(Tile) == 8);
+	static_assert(sizeof(TileTypeHeight) + sizeof(Tile) == 8);
 	static_assert(sizeof(TileExtended) == 4);
+	static_assert(offsetof(TileTypeHeight, height) == 1 && offsetof(Tile, m2) == 0 && offsetof(Tile, m1) == 2 && offsetof(Tile, m3) == 3 && offsetof(Tile, m4) == 4 && offsetof(Tile, m5) == 5); // Savegame order
 	assert(_sl_xv_feature_versions[XSLFI_WHOLE_MAP_CHUNK] == 1 || _sl_xv_feature_versions[XSLFI_WHOLE_MAP_CHUNK] == 2);
 
 	ReadBuffer *reader = ReadBuffer::GetCurrent();
 	const TileIndex size = MapSize();
 
+	/* The type and height are stored apart from the rest of the tile in memory, so the tiles can't be copied as a whole. */
+	TileIndex i = 0;
+	reader->ReadRecords(size, 8, [&](const byte *src, size_t count) {
+		for (size_t j = 0; j != count; j++, i++, src += 8) {
 #if TTD_ENDIAN == TTD_LITTLE_ENDIAN
-	reader->CopyBytes((byte *) _m, size * 8);
+			memcpy(&_mth[i], src, 2);
+			memcpy(&_m[i], src + 2, 6);
 #else
-	for (TileIndex i = 0; i != size; i++) {
-		reader->CheckBytes(8);
-		_m[i].type = reader->RawReadByte();
-		_m[i].height = reader->RawReadByte();
-		uint16 m2 = reader->RawReadByte();
-		m2 |= ((uint16) reader->RawReadByte()) << 8;
-		_m[i].m2 = m2;
-		_m[i].m1 = reader->RawReadByte();
-		_m[i].m3 = reader->RawReadByte();
-		_m[i].m4 = reader->RawReadByte();
-		_m[i].m5 = reader->RawReadByte();
-	}
+			_mth[i].type = src[0];
+			_mth[i].height = src[1];
+			_m[i].m2 = src[2] | (src[3] << 8);
+			_m[i].m1 = src[4];
+			_m[i].m3 = src[5];
+			_m[i].m4 = src[6];
+			_m[i].m5 = src[7];
 #endif
+		}
+	});
 
 	if (_sl_xv_feature_versions[XSLFI_WHOLE_MAP_CHUNK] == 1) {
 		for (TileIndex i = 0; i != size; i++) {
@@ -263,29 +246,36 @@ static void Load_WMAP()
 
 static void Save_WMAP()
 {
-	static_assert(sizeof(Tile) == 8);
+	static_assert(sizeof(TileTypeHeight) + sizeof(Tile) == 8);
 	static_assert(sizeof(TileExtended) == 4);
+	static_assert(offsetof(TileTypeHeight, height) == 1 && offsetof(Tile, m2) == 0 && offsetof(Tile, m1) == 2 && offsetof(Tile, m3) == 3 && offsetof(Tile, m4) == 4 && offsetof(Tile, m5) == 5); // Savegame order
 	assert(_sl_xv_feature_versions[XSLFI_WHOLE_MAP_CHUNK] == 2);
 
 	MemoryDumper *dumper = MemoryDumper::GetCurrent();
 	const TileIndex size = MapSize();
 	SlSetLength(size * 12);
 
+	TileIndex i = 0;
+	dumper->WriteRecords(size, 8, [&](byte *dst, size_t count) {
+		for (size_t j = 0; j != count; j++, i++, dst += 8) {
+#if TTD_ENDIAN == TTD_LITTLE_ENDIAN
+			memcpy(dst, &_mth[i], 2);
+			memcpy(dst + 2, &_m[i], 6);
+#else
+			dst[0] = _mth[i].type;
+			dst[1] = _mth[i].height;
+			dst[2] = GB(_m[i].m2, 0, 8);
+			dst[3] = GB(_m[i].m2, 8, 8);
+			dst[4] = _m[i].m1;
+			dst[5] = _m[i].m3;
+			dst[6] = _m[i].m4;
+			dst[7] = _m[i].m5;
+#endif
+		}
+	});
 #if TTD_ENDIAN == TTD_LITTLE_ENDIAN
-	dumper->CopyBytes((byte *) _m, size * 8);
 	dumper->CopyBytes((byte *) _me, size * 4);
 #else
-	for (TileIndex i = 0; i != size; i++) {
-		dumper->CheckBytes(8);
-		dumper->RawWriteByte(_m[i].type);
-		dumper->RawWriteByte(_m[i].height);
-		dumper->RawWriteByte(GB(_m[i].m2, 0, 8));
-		dumper->RawWriteByte(GB(_m[i].m2, 8, 8));
-		dumper->RawWriteByte(_m[i].m1);
-		dumper->RawWriteByte(_m[i].m3);
-		dumper->RawWriteByte(_m[i].m4);
-		dumper->RawWriteByte(_m[i].m5);
-	}
 	for (TileIndex i = 0; i != size; i++) {
 		dumper->CheckBytes(4);
 		dumper->RawWriteByte(_me[i].m6);
@@ -308,7 +298,7 @@ static const ChunkHandler map_chunk_handlers[] = {
 	{ 'MAPE', nullptr,   Load_MAP6, nullptr, nullptr,    CH_RIFF },
 	{ 'MAP7', nullptr,   Load_MAP7, nullptr, nullptr,    CH_RIFF },
 	{ 'MAP8', nullptr,   Load_MAP8, nullptr, nullptr,    CH_RIFF },
-	{ 'WMAP', Save_WMAP, Load_WMAP, nullptr, nullptr,    CH_RIFF },
+	{ 'WMAP', Save_WMAP, Load_WMAP, nullptr, nullptr,    CH_RIFF, true },
 };
 
 extern const ChunkHandlerTable _map_chunk_handlers(map_chunk_handlers);
@@ -72,6 +72,9 @@ void ResetViewportAfterLoadGame()
 
 byte _age_cargo_skip_counter; ///< Skip aging of cargo? Used before savegame version 162.
 
+/* _state_checksum_parts is saved as an array of its states. */
+static_assert(sizeof(SimpleChecksum64) == sizeof(uint64));
+
 static const SaveLoad _date_desc[] = {
 	SLEG_CONDVAR(_date,                   SLE_FILE_U16 | SLE_VAR_I32,  SL_MIN_VERSION,  SLV_31),
 	SLEG_CONDVAR(_date,                   SLE_INT32,                  SLV_31, SL_MAX_VERSION),
@@ -101,6 +104,7 @@ static const SaveLoad _date_desc[] = {
 	SLE_CONDNULL_X(1, SL_MIN_VERSION, SL_MAX_VERSION, SlXvFeatureTest(XSLFTO_AND, XSLFI_REALISTIC_TRAIN_BRAKING, 4, 6)), // _extra_aspects
 	SLEG_CONDVAR_X(_aspect_cfg_hash,      SLE_UINT64,         SL_MIN_VERSION, SL_MAX_VERSION, SlXvFeatureTest(XSLFTO_AND, XSLFI_REALISTIC_TRAIN_BRAKING, 7)),
 	SLE_CONDNULL(4, SLV_11, SLV_120),
+	SLEG_CONDARR_X(_state_checksum_parts, SLE_UINT64, SCP_END, SL_MIN_VERSION, SL_MAX_VERSION, SlXvFeatureTest(XSLFTO_AND, XSLFI_STATE_CHECKSUM_PARTS)),
 };
 
 static const SaveLoad _date_check_desc[] = {
@@ -132,6 +136,7 @@ static const SaveLoad _date_check_desc[] = {
 	SLE_CONDNULL_X(1, SL_MIN_VERSION, SL_MAX_VERSION, SlXvFeatureTest(XSLFTO_AND, XSLFI_REALISTIC_TRAIN_BRAKING, 4, 6)), // _extra_aspects
 	SLE_CONDNULL_X(8, SL_MIN_VERSION, SL_MAX_VERSION, SlXvFeatureTest(XSLFTO_AND, XSLFI_REALISTIC_TRAIN_BRAKING, 7)), // _aspect_cfg_hash
 	SLE_CONDNULL(4, SLV_11, SLV_120),
+	SLE_CONDNULL_X(8 * SCP_END, SL_MIN_VERSION, SL_MAX_VERSION, SlXvFeatureTest(XSLFTO_AND, XSLFI_STATE_CHECKSUM_PARTS)), // _state_checksum_parts
 };
 
 /* Save load date related variables as well as persistent tick counters
@@ -62,6 +62,7 @@ static void Load_PLAN()
 				SlArray(pl->tiles.data(), tile_count, SLE_UINT32);
 				pl->UpdateVisualExtents();
 			}
+			p->UpdateVisualExtents();
 			p->SetVisibility(false);
 		}
 	}
@@ -84,6 +85,7 @@ static void Load_PLANLINE()
 	}
 
 	for (Plan *p : Plan::Iterate()) {
+		p->UpdateVisualExtents();
 		p->SetVisibility(false);
 	}
 }
@@ -44,8 +44,12 @@
 #include "../fios.h"
 #include "../error.h"
 #include "../scope.h"
+#include "../worker_thread.h"
 #include <atomic>
+#include <chrono>
 #include <deque>
+#include <exception>
+#include <memory>
 #include <string>
 #ifdef __EMSCRIPTEN__
 #	include <emscripten.h>
@@ -64,6 +68,7 @@
 #include <vector>
 
 #include "../thread.h"
+#include "../trace.h"
 #include <mutex>
 #include <condition_variable>
 #if defined(__MINGW32__)
@@ -71,6 +76,14 @@
 #include "../3rdparty/mingw-std-threads/mingw.condition_variable.h"
 #endif
 
+#if defined(UNIX) && !defined(__APPLE__) && !defined(__EMSCRIPTEN__)
+#	define WITH_FORKED_SAVES
+#	include <sys/types.h>
+#	include <sys/wait.h>
+#	include <unistd.h>
+#	include <errno.h>
+#endif
+
 #include "../safeguards.h"
 
 extern const SaveLoadVersion SAVEGAME_VERSION = SLV_CUSTOM_SUBSIDY_DURATION; ///< Current savegame version of OpenTTD.
@@ -85,6 +98,7 @@ uint32 _ttdp_version;         ///< version of TTDP savegame (if applicable)
 SaveLoadVersion _sl_version;  ///< the major savegame version identifier
 byte   _sl_minor_version;     ///< the minor savegame version, DO NOT USE!
 std::string _savegame_format; ///< how to compress savegames
+std::string _autosave_format; ///< how to compress autosaves, the same as savegames if empty
 bool _do_autosave;            ///< are we doing an autosave at the moment?
 
 extern bool _sl_is_ext_version;
@@ -213,6 +227,22 @@ std::pair<byte *, size_t> MemoryDumper::StopAutoLength()
  * Get the size of the memory dump made so far.
  * @return The size.
  */
+/**
+ * Move all data written to another dumper to the end of this one.
+ * @param other The dumper to take the data of, it is empty afterwards.
+ */
+void MemoryDumper::Splice(MemoryDumper &other)
+{
+	this->FinaliseBlock();
+	other.FinaliseBlock();
+	for (BufferInfo &block : other.blocks) {
+		this->blocks.emplace_back(std::move(block));
+	}
+	this->completed_block_bytes += other.completed_block_bytes;
+	other.blocks.clear();
+	other.completed_block_bytes = 0;
+}
+
 size_t MemoryDumper::GetSize() const
 {
 	assert(this->saved_buf == nullptr);
@@ -222,14 +252,9 @@ size_t MemoryDumper::GetSize() const
 /** The saveload struct, containing reader-writer functions, buffer, version, etc. */
 struct SaveLoadParams {
 	SaveLoadAction action;               ///< are we doing a save or a load atm.
-	NeedLength need_length;              ///< working in NeedLength (Autolength) mode?
-	byte block_mode;                     ///< ???
 	bool error;                          ///< did an error occur or not
 
-	size_t obj_len;                      ///< the length of the current object we are busy with
-	int array_index, last_array_index;   ///< in the case of an array, the current and last positions
-
-	MemoryDumper *dumper;                ///< Memory dumper to write the savegame to.
+	MemoryDumper *dumper;                ///< Memory dumper the whole savegame is written to.
 	SaveFilter *sf;                      ///< Filter to write the savegame to.
 
 	ReadBuffer *reader;                  ///< Savegame reading buffer.
@@ -245,6 +270,147 @@ struct SaveLoadParams {
 
 static SaveLoadParams _sl; ///< Parameters used for/at saveload.
 
+/**
+ * Parameters of the chunk which is currently being saved or loaded.
+ * These are per thread, so that independent chunks can be saved concurrently, see SlSaveChunks.
+ */
+struct SaveLoadChunkParams {
+	NeedLength need_length;              ///< working in NeedLength (Autolength) mode?
+	byte block_mode;                     ///< ???
+
+	size_t obj_len;                      ///< the length of the current object we are busy with
+	int array_index, last_array_index;   ///< in the case of an array, the current and last positions
+	size_t objects;                      ///< number of array elements of the current chunk, for profiling
+
+	MemoryDumper *dumper;                ///< Memory dumper to write the current chunk to.
+};
+
+static thread_local SaveLoadChunkParams _slc; ///< Parameters of the current chunk.
+
+static std::mutex _sl_profile_mutex;  ///< Mutex for the profile, chunks may be saved by other threads.
+static SaveLoadProfile _sl_profile;   ///< Measurements of the last savegame which was saved or loaded.
+static std::chrono::steady_clock::time_point _sl_profile_stage_start; ///< Start of the current stage of the profile.
+
+/**
+ * Get the time elapsed since a point in time.
+ * @param start The point in time.
+ * @return The elapsed wall time in microseconds.
+ */
+static uint64 SlProfileElapsed(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Start profiling a new savegame operation, discarding the previous profile.
+ * @param operation Name of the operation.
+ */
+static void SlProfileBegin(const char *operation)
+{
+	std::lock_guard<std::mutex> lock(_sl_profile_mutex);
+	_sl_profile = {};
+	_sl_profile.operation = operation;
+	_sl_profile_stage_start = std::chrono::steady_clock::now();
+}
+
+/**
+ * Record the measurements of a chunk in the profile.
+ * @param chunk The measurements of the chunk.
+ */
+static void SlProfileChunk(const SaveLoadChunkProfile &chunk)
+{
+	std::lock_guard<std::mutex> lock(_sl_profile_mutex);
+	_sl_profile.chunks.push_back(chunk);
+}
+
+/**
+ * Record the end of a stage of the current savegame operation in the profile.
+ * The stage lasted from the end of the previous stage, or the start of the operation.
+ * @param name Name of the stage, this must be a string literal.
+ */
+void SlProfileStage(const char *name)
+{
+	std::lock_guard<std::mutex> lock(_sl_profile_mutex);
+	_sl_profile.stages.emplace_back(name, SlProfileElapsed(_sl_profile_stage_start));
+	_sl_profile_stage_start = std::chrono::steady_clock::now();
+}
+
+/**
+ * Get the measurements of the last savegame which was saved or loaded.
+ * @return A copy of the profile.
+ */
+SaveLoadProfile GetLastSaveLoadProfile()
+{
+	std::lock_guard<std::mutex> lock(_sl_profile_mutex);
+	return _sl_profile;
+}
+
+/**
+ * Print a savegame profile in human readable form.
+ * @param profile The profile to print.
+ * @param print Function printing a single line.
+ */
+void PrintSaveLoadProfile(const SaveLoadProfile &profile, std::function<void(const char *)> print)
+{
+	char buffer[256];
+	if (profile.operation == nullptr) {
+		print("No savegame has been saved or loaded yet");
+		return;
+	}
+
+	SaveLoadChunkProfile total = {};
+	for (const SaveLoadChunkProfile &chunk : profile.chunks) {
+		total.raw_bytes += chunk.raw_bytes;
+		total.compressed_bytes += chunk.compressed_bytes;
+		total.objects += chunk.objects;
+		total.time_us += chunk.time_us;
+	}
+
+	seprintf(buffer, lastof(buffer), "Savegame %s: %u chunks", profile.operation, (uint)profile.chunks.size());
+	print(buffer);
+	print("  Chunk     Raw bytes   Compressed      Objects    Time (us)");
+	auto print_chunk = [&](const char *name, const SaveLoadChunkProfile &chunk) {
+		char compressed[24] = "-";
+		if (total.compressed_bytes != 0) seprintf(compressed, lastof(compressed), PRINTF_SIZE, chunk.compressed_bytes);
+		seprintf(buffer, lastof(buffer), "  %-5s %13s %12s %12s %12s", name,
+				std::to_string(chunk.raw_bytes).c_str(), compressed, std::to_string(chunk.objects).c_str(), std::to_string(chunk.time_us).c_str());
+		print(buffer);
+	};
+	for (const SaveLoadChunkProfile &chunk : profile.chunks) {
+		char name[5] = { (char)(chunk.id >> 24), (char)(chunk.id >> 16), (char)(chunk.id >> 8), (char)chunk.id, 0 };
+		print_chunk(name, chunk);
+	}
+	print_chunk("Total", total);
+
+	for (const auto &stage : profile.stages) {
+		seprintf(buffer, lastof(buffer), "  Stage: %s: " OTTD_PRINTF64U " us", stage.first.c_str(), stage.second);
+		print(buffer);
+	}
+}
+
+/**
+ * Write a savegame profile to a CSV file.
+ * @param profile The profile to write.
+ * @param filename Name of the file to write.
+ * @return True if the file could be written.
+ */
+bool WriteSaveLoadProfileCSV(const SaveLoadProfile &profile, const char *filename)
+{
+	FILE *f = FioFOpenFile(filename, "wt", Subdirectory::NO_DIRECTORY);
+	if (f == nullptr) return false;
+	FileCloser fcloser(f);
+
+	fputs("Type,Name,RawBytes,CompressedBytes,Objects,Microseconds\n", f);
+	for (const SaveLoadChunkProfile &chunk : profile.chunks) {
+		fprintf(f, "chunk,%c%c%c%c," PRINTF_SIZE "," PRINTF_SIZE "," PRINTF_SIZE "," OTTD_PRINTF64U "\n", chunk.id >> 24, chunk.id >> 16, chunk.id >> 8, chunk.id,
+				chunk.raw_bytes, chunk.compressed_bytes, chunk.objects, chunk.time_us);
+	}
+	for (const auto &stage : profile.stages) {
+		fprintf(f, "stage,%s,,,," OTTD_PRINTF64U "\n", stage.first.c_str(), stage.second);
+	}
+	return true;
+}
+
 ReadBuffer *ReadBuffer::GetCurrent()
 {
 	return _sl.reader;
@@ -252,7 +418,7 @@ ReadBuffer *ReadBuffer::GetCurrent()
 
 MemoryDumper *MemoryDumper::GetCurrent()
 {
-	return _sl.dumper;
+	return _slc.dumper;
 }
 
 static const std::vector<ChunkHandler> &ChunkHandlers()
@@ -480,6 +646,10 @@ void NORETURN CDECL SlErrorCorruptFmt(const char *format, ...)
 typedef void (*AsyncSaveFinishProc)();                      ///< Callback for when the savegame loading is finished.
 static std::atomic<AsyncSaveFinishProc> _async_save_finish; ///< Callback to call when the savegame loading is finished.
 static std::thread _save_thread;                            ///< The thread we're using to compress and write a savegame
+#ifdef WITH_FORKED_SAVES
+static pid_t _save_process = -1;                            ///< The forked process serialising, compressing and writing a savegame, see DoForkedSave
+static void FinishForkedSave(pid_t result, int status);
+#endif
 
 /**
  * Called by save thread to tell we finished saving.
@@ -498,6 +668,14 @@ static void SetAsyncSaveFinish(AsyncSaveFinishProc proc)
  */
 void ProcessAsyncSaveFinish()
 {
+#ifdef WITH_FORKED_SAVES
+	if (_save_process > 0) {
+		int status;
+		pid_t result = waitpid(_save_process, &status, WNOHANG);
+		if (result != 0) FinishForkedSave(result, status);
+	}
+#endif
+
 	AsyncSaveFinishProc proc = _async_save_finish.exchange(nullptr, std::memory_order_acq_rel);
 	if (proc == nullptr) return;
 
@@ -551,25 +729,25 @@ uint64 SlReadUint64()
  */
 void SlWriteByte(byte b)
 {
-	_sl.dumper->WriteByte(b);
+	_slc.dumper->WriteByte(b);
 }
 
 void SlWriteUint16(uint16 v)
 {
-	_sl.dumper->CheckBytes(2);
-	_sl.dumper->RawWriteUint16(v);
+	_slc.dumper->CheckBytes(2);
+	_slc.dumper->RawWriteUint16(v);
 }
 
 void SlWriteUint32(uint32 v)
 {
-	_sl.dumper->CheckBytes(4);
-	_sl.dumper->RawWriteUint32(v);
+	_slc.dumper->CheckBytes(4);
+	_slc.dumper->RawWriteUint32(v);
 }
 
 void SlWriteUint64(uint64 v)
 {
-	_sl.dumper->CheckBytes(8);
-	_sl.dumper->RawWriteUint64(v);
+	_slc.dumper->CheckBytes(8);
+	_slc.dumper->RawWriteUint64(v);
 }
 
 /**
@@ -589,7 +767,7 @@ size_t SlGetBytesRead()
 size_t SlGetBytesWritten()
 {
 	assert(_sl.action == SLA_SAVE);
-	return _sl.dumper->GetSize();
+	return _slc.dumper->GetSize();
 }
 
 /**
@@ -744,8 +922,9 @@ static inline size_t SlCalcRefLen()
 
 void SlSetArrayIndex(uint index)
 {
-	_sl.need_length = NL_WANTLENGTH;
-	_sl.array_index = index;
+	_slc.need_length = NL_WANTLENGTH;
+	_slc.array_index = index;
+	_slc.objects++;
 }
 
 static size_t _next_offs;
@@ -772,18 +951,21 @@ int SlIterateArray()
 			return -1;
 		}
 
-		_sl.obj_len = --length;
+		_slc.obj_len = --length;
 		_next_offs = _sl.reader->GetSize() + length;
 
-		switch (_sl.block_mode) {
+		switch (_slc.block_mode) {
 			case CH_SPARSE_ARRAY: index = (int)SlReadSparseIndex(); break;
-			case CH_ARRAY:        index = _sl.array_index++; break;
+			case CH_ARRAY:        index = _slc.array_index++; break;
 			default:
 				DEBUG(sl, 0, "SlIterateArray error");
 				return -1; // error
 		}
 
-		if (length != 0) return index;
+		if (length != 0) {
+			_slc.objects++;
+			return index;
+		}
 	}
 }
 
@@ -806,10 +988,10 @@ void SlSetLength(size_t length)
 {
 	assert(_sl.action == SLA_SAVE);
 
-	switch (_sl.need_length) {
+	switch (_slc.need_length) {
 		case NL_WANTLENGTH:
-			_sl.need_length = NL_NONE;
-			switch (_sl.block_mode) {
+			_slc.need_length = NL_NONE;
+			switch (_slc.block_mode) {
 				case CH_RIFF:
 					/* Ugly encoding of >16M RIFF chunks
 					 * The lower 24 bits are normal
@@ -831,15 +1013,15 @@ void SlSetLength(size_t length)
 					}
 					break;
 				case CH_ARRAY:
-					assert(_sl.last_array_index <= _sl.array_index);
-					while (++_sl.last_array_index <= _sl.array_index) {
+					assert(_slc.last_array_index <= _slc.array_index);
+					while (++_slc.last_array_index <= _slc.array_index) {
 						SlWriteArrayLength(1);
 					}
 					SlWriteArrayLength(length + 1);
 					break;
 				case CH_SPARSE_ARRAY:
-					SlWriteArrayLength(length + 1 + SlGetArrayLength(_sl.array_index)); // Also include length of sparse index.
-					SlWriteSparseIndex(_sl.array_index);
+					SlWriteArrayLength(length + 1 + SlGetArrayLength(_slc.array_index)); // Also include length of sparse index.
+					SlWriteSparseIndex(_slc.array_index);
 					break;
 				default: NOT_REACHED();
 			}
@@ -865,7 +1047,7 @@ static void SlCopyBytes(void *ptr, size_t length)
 			_sl.reader->CopyBytes(p, length);
 			break;
 		case SLA_SAVE:
-			_sl.dumper->CopyBytes(p, length);
+			_slc.dumper->CopyBytes(p, length);
 			break;
 		default: NOT_REACHED();
 	}
@@ -874,7 +1056,7 @@ static void SlCopyBytes(void *ptr, size_t length)
 /** Get the length of the current object */
 size_t SlGetFieldLength()
 {
-	return _sl.obj_len;
+	return _slc.obj_len;
 }
 
 /**
@@ -1208,12 +1390,40 @@ static inline size_t SlCalcArrayLen(size_t length, VarType conv)
  * @param length The length of the array in elements
  * @param conv VarType type of the atomic array (int, byte, uint64, etc.)
  */
+/**
+ * Save/Load an array of which the elements have the same type in memory and in the savegame,
+ * straight from/to the savegame buffer.
+ * @param array The array being manipulated.
+ * @param length The length of the array in elements.
+ * @tparam T Unsigned type of the elements, the savegame stores them big endian.
+ */
+template <typename T>
+static void SlArrayUnconverted(T *array, size_t length)
+{
+	if (_sl.action == SLA_SAVE) {
+		_slc.dumper->WriteRecords(length, sizeof(T), [&](byte *dst, size_t count) {
+			for (size_t i = 0; i != count; i++) {
+				const T v = *array++;
+				for (uint b = 0; b != sizeof(T); b++) *dst++ = (byte)(v >> (8 * (sizeof(T) - 1 - b)));
+			}
+		});
+	} else {
+		_sl.reader->ReadRecords(length, sizeof(T), [&](const byte *src, size_t count) {
+			for (size_t i = 0; i != count; i++) {
+				T v = 0;
+				for (uint b = 0; b != sizeof(T); b++) v = (T)((v << 8) | *src++);
+				*array++ = v;
+			}
+		});
+	}
+}
+
 void SlArray(void *array, size_t length, VarType conv)
 {
 	if (_sl.action == SLA_PTRS || _sl.action == SLA_NULL) return;
 
 	/* Automatically calculate the length? */
-	if (_sl.need_length != NL_NONE) {
+	if (_slc.need_length != NL_NONE) {
 		SlSetLength(SlCalcArrayLen(length, conv));
 	}
 
@@ -1239,6 +1449,12 @@ void SlArray(void *array, size_t length, VarType conv)
 	 * conversion is needed, use specialized copy-copy function to speed up things */
 	if (conv == SLE_INT8 || conv == SLE_UINT8) {
 		SlCopyBytes(array, length);
+	} else if (conv == SLE_INT16 || conv == SLE_UINT16) {
+		SlArrayUnconverted(static_cast<uint16 *>(array), length);
+	} else if (conv == SLE_INT32 || conv == SLE_UINT32) {
+		SlArrayUnconverted(static_cast<uint32 *>(array), length);
+	} else if (conv == SLE_INT64 || conv == SLE_UINT64) {
+		SlArrayUnconverted(static_cast<uint64 *>(array), length);
 	} else {
 		byte *a = (byte*)array;
 		byte mem_size = SlCalcConvMemLen(conv);
@@ -1520,7 +1736,7 @@ template<typename PtrList>
 static void SlRefList(void *list, SLRefType conv)
 {
 	/* Automatically calculate the length? */
-	if (_sl.need_length != NL_NONE) {
+	if (_slc.need_length != NL_NONE) {
 		SlSetLength(SlCalcRefListLen<PtrList>(list));
 	}
 
@@ -1576,7 +1792,7 @@ static void SlVarList(void *list, VarType conv)
 {
 	const size_t size_len = SlCalcConvMemLen(conv);
 	/* Automatically calculate the length? */
-	if (_sl.need_length != NL_NONE) {
+	if (_slc.need_length != NL_NONE) {
 		SlSetLength(SlCalcVarListLen<PtrList>(list, size_len));
 	}
 
@@ -1848,10 +2064,71 @@ void SlFilterObject(const SaveLoadTable &slt, std::vector<SaveLoad> &save)
 	}
 }
 
+/**
+ * Get the size of a variable, if it is of a type which can be merged with adjacent variables into one array.
+ * @param sld The variable.
+ * @return The size of the variable in bytes, or 0 if it can not be merged.
+ */
+static size_t GetMergeableVariableSize(const SaveLoad &sld)
+{
+	if (sld.cmd != SL_VAR || sld.global) return 0;
+
+	switch (GB(sld.conv, 0, 8)) {
+		case SLE_INT8:
+		case SLE_UINT8:
+			return 1;
+
+		case SLE_INT16:
+		case SLE_UINT16:
+		case SLE_INT32:
+		case SLE_UINT32:
+		case SLE_INT64:
+		case SLE_UINT64:
+			/* SlArray loads these as bytes from the oldest savegames. */
+			if (_sl.action != SLA_SAVE && _sl_version == 0) return 0;
+			return SlCalcConvMemLen(sld.conv);
+
+		default:
+			return 0;
+	}
+}
+
+/**
+ * Merge runs of adjacent variables in an object, which have the same type in memory and in the savegame, into single arrays.
+ * Byte sized variables are then copied as a whole, and larger ones without any per variable conversion switches.
+ * @param save The filtered SaveLoad table.
+ */
+static void SlMergeFilteredVariables(std::vector<SaveLoad> &save)
+{
+	size_t out = 0;
+	for (size_t i = 0; i < save.size();) {
+		SaveLoad sld = save[i++];
+		const size_t size = GetMergeableVariableSize(sld);
+		if (size != 0) {
+			size_t count = 1;
+			while (i < save.size() && count < UINT16_MAX && GetMergeableVariableSize(save[i]) == size &&
+					(size == 1 || GB(save[i].conv, 0, 8) == GB(sld.conv, 0, 8)) &&
+					reinterpret_cast<size_t>(save[i].address) == reinterpret_cast<size_t>(sld.address) + count * size) {
+				count++;
+				i++;
+			}
+			if (count > 1) {
+				sld.cmd = SL_ARR;
+				if (size == 1) sld.conv = SLE_UINT8;
+				sld.length = (uint16)count;
+				sld.size = count * size;
+			}
+		}
+		save[out++] = sld;
+	}
+	save.resize(out);
+}
+
 std::vector<SaveLoad> SlFilterObject(const SaveLoadTable &slt)
 {
 	std::vector<SaveLoad> save;
 	SlFilterObject(slt, save);
+	SlMergeFilteredVariables(save);
 	return save;
 }
 
@@ -1973,7 +2250,7 @@ bool SlObjectMember(void *object, const SaveLoad &sld)
 void SlObject(void *object, const SaveLoadTable &slt)
 {
 	/* Automatically calculate the length? */
-	if (_sl.need_length != NL_NONE) {
+	if (_slc.need_length != NL_NONE) {
 		SlSetLength(SlCalcObjLength(object, slt));
 	}
 
@@ -1992,14 +2269,14 @@ void SlObjectIterateBase(void *object, const SaveLoadTable &slt)
 
 void SlObjectSaveFiltered(void *object, const SaveLoadTable &slt)
 {
-	if (_sl.need_length != NL_NONE) {
-		_sl.need_length = NL_NONE;
-		_sl.dumper->StartAutoLength();
+	if (_slc.need_length != NL_NONE) {
+		_slc.need_length = NL_NONE;
+		_slc.dumper->StartAutoLength();
 		SlObjectIterateBase<SLA_SAVE, false>(object, slt);
-		auto result = _sl.dumper->StopAutoLength();
-		_sl.need_length = NL_WANTLENGTH;
+		auto result = _slc.dumper->StopAutoLength();
+		_slc.need_length = NL_WANTLENGTH;
 		SlSetLength(result.second);
-		_sl.dumper->CopyBytes(result.first, result.second);
+		_slc.dumper->CopyBytes(result.first, result.second);
 	} else {
 		SlObjectIterateBase<SLA_SAVE, false>(object, slt);
 	}
@@ -2040,16 +2317,16 @@ void SlGlobList(const SaveLoadTable &slt)
 void SlAutolength(AutolengthProc *proc, void *arg)
 {
 	assert(_sl.action == SLA_SAVE);
-	assert(_sl.need_length == NL_WANTLENGTH);
+	assert(_slc.need_length == NL_WANTLENGTH);
 
-	_sl.need_length = NL_NONE;
-	_sl.dumper->StartAutoLength();
+	_slc.need_length = NL_NONE;
+	_slc.dumper->StartAutoLength();
 	proc(arg);
-	auto result = _sl.dumper->StopAutoLength();
+	auto result = _slc.dumper->StopAutoLength();
 	/* Setup length */
-	_sl.need_length = NL_WANTLENGTH;
+	_slc.need_length = NL_WANTLENGTH;
 	SlSetLength(result.second);
-	_sl.dumper->CopyBytes(result.first, result.second);
+	_slc.dumper->CopyBytes(result.first, result.second);
 }
 
 /**
@@ -2060,14 +2337,14 @@ void SlAutolength(AutolengthProc *proc, void *arg)
 std::vector<byte> SlSaveToVector(AutolengthProc *proc, void *arg)
 {
 	assert(_sl.action == SLA_SAVE);
-	NeedLength orig_need_length = _sl.need_length;
+	NeedLength orig_need_length = _slc.need_length;
 
-	_sl.need_length = NL_NONE;
-	_sl.dumper->StartAutoLength();
+	_slc.need_length = NL_NONE;
+	_slc.dumper->StartAutoLength();
 	proc(arg);
-	auto result = _sl.dumper->StopAutoLength();
+	auto result = _slc.dumper->StopAutoLength();
 	/* Setup length */
-	_sl.need_length = orig_need_length;
+	_slc.need_length = orig_need_length;
 	return std::vector<uint8>(result.first, result.first + result.second);
 }
 
@@ -2080,8 +2357,8 @@ void SlLoadFromBuffer(const byte *buffer, size_t length, AutolengthProc *proc, v
 {
 	assert(_sl.action == SLA_LOAD || _sl.action == SLA_LOAD_CHECK);
 
-	size_t old_obj_len = _sl.obj_len;
-	_sl.obj_len = length;
+	size_t old_obj_len = _slc.obj_len;
+	_slc.obj_len = length;
 
 	ReadBuffer *reader = ReadBuffer::GetCurrent();
 	byte *old_bufp = reader->bufp;
@@ -2095,7 +2372,7 @@ void SlLoadFromBuffer(const byte *buffer, size_t length, AutolengthProc *proc, v
 		SlErrorCorrupt("SlLoadFromBuffer: Wrong number of bytes read");
 	}
 
-	_sl.obj_len = old_obj_len;
+	_slc.obj_len = old_obj_len;
 	reader->bufp = old_bufp;
 	reader->bufe = old_bufe;
 }
@@ -2135,8 +2412,8 @@ static void SlLoadChunk(const ChunkHandler &ch)
 	size_t len;
 	size_t endoffs;
 
-	_sl.block_mode = m;
-	_sl.obj_len = 0;
+	_slc.block_mode = m;
+	_slc.obj_len = 0;
 
 	SaveLoadChunkExtHeaderFlags ext_flags = static_cast<SaveLoadChunkExtHeaderFlags>(0);
 	if ((m & 0xF) == CH_EXT_HDR) {
@@ -2144,12 +2421,12 @@ static void SlLoadChunk(const ChunkHandler &ch)
 
 		/* read in real header */
 		m = SlReadByte();
-		_sl.block_mode = m;
+		_slc.block_mode = m;
 	}
 
 	switch (m) {
 		case CH_ARRAY:
-			_sl.array_index = 0;
+			_slc.array_index = 0;
 			ch.load_proc();
 			if (_next_offs != 0) SlErrorCorrupt("Invalid array length");
 			break;
@@ -2173,7 +2450,7 @@ static void SlLoadChunk(const ChunkHandler &ch)
 					len |= SlReadUint32() << 28;
 				}
 
-				_sl.obj_len = len;
+				_slc.obj_len = len;
 				endoffs = _sl.reader->GetSize() + len;
 				ch.load_proc();
 				if (_sl.reader->GetSize() != endoffs) {
@@ -2198,8 +2475,8 @@ static void SlLoadCheckChunk(const ChunkHandler *ch)
 	size_t len;
 	size_t endoffs;
 
-	_sl.block_mode = m;
-	_sl.obj_len = 0;
+	_slc.block_mode = m;
+	_slc.obj_len = 0;
 
 	SaveLoadChunkExtHeaderFlags ext_flags = static_cast<SaveLoadChunkExtHeaderFlags>(0);
 	if ((m & 0xF) == CH_EXT_HDR) {
@@ -2207,12 +2484,12 @@ static void SlLoadCheckChunk(const ChunkHandler *ch)
 
 		/* read in real header */
 		m = SlReadByte();
-		_sl.block_mode = m;
+		_slc.block_mode = m;
 	}
 
 	switch (m) {
 		case CH_ARRAY:
-			_sl.array_index = 0;
+			_slc.array_index = 0;
 			if (ext_flags) {
 				SlErrorCorruptFmt("CH_ARRAY does not take chunk header extension flags: 0x%X", ext_flags);
 			}
@@ -2255,7 +2532,7 @@ static void SlLoadCheckChunk(const ChunkHandler *ch)
 					}
 					len = static_cast<size_t>(full_len);
 				}
-				_sl.obj_len = len;
+				_slc.obj_len = len;
 				endoffs = _sl.reader->GetSize() + len;
 				if (ch && ch->load_check_proc) {
 					ch->load_check_proc();
@@ -2288,17 +2565,18 @@ static void SlSaveChunk(const ChunkHandler &ch)
 	SlWriteUint32(ch.id);
 	DEBUG(sl, 2, "Saving chunk %c%c%c%c", ch.id >> 24, ch.id >> 16, ch.id >> 8, ch.id);
 
-	size_t written = 0;
-	if (_debug_sl_level >= 3) written = SlGetBytesWritten();
+	const auto start = std::chrono::steady_clock::now();
+	const size_t written = SlGetBytesWritten();
 
-	_sl.block_mode = ch.type;
+	_slc.objects = 0;
+	_slc.block_mode = ch.type;
 	switch (ch.type) {
 		case CH_RIFF:
-			_sl.need_length = NL_WANTLENGTH;
+			_slc.need_length = NL_WANTLENGTH;
 			proc();
 			break;
 		case CH_ARRAY:
-			_sl.last_array_index = 0;
+			_slc.last_array_index = 0;
 			SlWriteByte(CH_ARRAY);
 			proc();
 			SlWriteArrayLength(0); // Terminate arrays
@@ -2311,18 +2589,90 @@ static void SlSaveChunk(const ChunkHandler &ch)
 		default: NOT_REACHED();
 	}
 
-	DEBUG(sl, 3, "Saved chunk %c%c%c%c (" PRINTF_SIZE " bytes)", ch.id >> 24, ch.id >> 16, ch.id >> 8, ch.id, SlGetBytesWritten() - written);
+	SaveLoadChunkProfile profile = { ch.id, SlGetBytesWritten() - written, 0, _slc.objects, SlProfileElapsed(start) };
+	SlProfileChunk(profile);
+	DEBUG(sl, 3, "Saved chunk %c%c%c%c (" PRINTF_SIZE " bytes, " PRINTF_SIZE " objects, " OTTD_PRINTF64U " us)", ch.id >> 24, ch.id >> 16, ch.id >> 8, ch.id,
+			profile.raw_bytes, profile.objects, profile.time_us);
 }
 
-/** Save all chunks */
+/** Output of a part of the chunks, see SlSaveChunks. */
+struct SaveChunkSegment {
+	MemoryDumper dumper;          ///< Dumper the chunks of this segment are written to.
+	std::thread thread;           ///< Thread saving the chunk of this segment, if it is saved concurrently.
+	std::exception_ptr error;     ///< Error thrown by the thread, if any.
+};
+
+/**
+ * Save all chunks.
+ * Chunks of which the handler allows concurrent saving are each saved by their own thread into their own
+ * dumper, while the other chunks are saved in order by this thread. The dumpers are spliced together in
+ * the canonical chunk order, so the savegame is the same as when saving everything in order.
+ */
 static void SlSaveChunks()
 {
-	for (auto &ch : ChunkHandlers()) {
-		SlSaveChunk(ch);
+	MemoryDumper *main_dumper = _slc.dumper;
+	const bool concurrent = _general_worker_pool.GetParallelism() > 1;
+	std::vector<std::unique_ptr<SaveChunkSegment>> segments;
+
+	auto join_segments = [&]() {
+		for (auto &seg : segments) {
+			if (seg->thread.joinable()) seg->thread.join();
+		}
+	};
+
+	try {
+		for (auto &ch : ChunkHandlers()) {
+			if (!concurrent || !ch.concurrent_save || ch.save_proc == nullptr) {
+				SlSaveChunk(ch);
+				continue;
+			}
+
+			SaveChunkSegment *seg = segments.emplace_back(new SaveChunkSegment()).get();
+			auto save_chunk = [seg, &ch]() {
+				_slc = {};
+				_slc.dumper = &seg->dumper;
+				try {
+					SlSaveChunk(ch);
+				} catch (...) {
+					seg->error = std::current_exception();
+				}
+			};
+			if (!StartNewThread(&seg->thread, "ottd:savechunk", decltype(save_chunk)(save_chunk))) {
+				SaveLoadChunkParams saved = _slc;
+				save_chunk();
+				_slc = saved;
+			}
+
+			/* Continue with the following chunks in a new segment. */
+			_slc.dumper = &segments.emplace_back(new SaveChunkSegment())->dumper;
+		}
+
+		/* Terminator */
+		SlWriteUint32(0);
+	} catch (...) {
+		join_segments();
+		_slc.dumper = main_dumper;
+		throw;
+	}
+
+	join_segments();
+	_slc.dumper = main_dumper;
+	for (auto &seg : segments) {
+		if (seg->error) std::rethrow_exception(seg->error);
+		main_dumper->Splice(seg->dumper);
 	}
 
-	/* Terminator */
-	SlWriteUint32(0);
+	if (!segments.empty()) {
+		/* Concurrently saved chunks were profiled out of order, restore the savegame order. */
+		std::lock_guard<std::mutex> lock(_sl_profile_mutex);
+		auto chunk_order = [](uint32 id) {
+			const std::vector<ChunkHandler> &handlers = ChunkHandlers();
+			return std::find_if(handlers.begin(), handlers.end(), [&](const ChunkHandler &ch) { return ch.id == id; }) - handlers.begin();
+		};
+		std::stable_sort(_sl_profile.chunks.begin(), _sl_profile.chunks.end(), [&](const SaveLoadChunkProfile &a, const SaveLoadChunkProfile &b) {
+			return chunk_order(a.id) < chunk_order(b.id);
+		});
+	}
 }
 
 /**
@@ -2337,6 +2687,38 @@ static const ChunkHandler *SlFindChunkHandler(uint32 id)
 	return nullptr;
 }
 
+static size_t SlGetCompressedBytesRead();
+
+/** Measurement of the loading of a single chunk, see SlProfileChunk. */
+struct SlProfileLoadChunk {
+	std::chrono::steady_clock::time_point start; ///< Start of loading the chunk.
+	SaveLoadChunkProfile profile;                ///< Measurements of the chunk.
+
+	/**
+	 * Start measuring the loading of a chunk.
+	 * @param id ID of the chunk.
+	 */
+	SlProfileLoadChunk(uint32 id) : start(std::chrono::steady_clock::now())
+	{
+		this->profile = { id, SlGetBytesRead(), SlGetCompressedBytesRead(), 0, 0 };
+		_slc.objects = 0;
+	}
+
+	/** Finish measuring the loading of the chunk, and record it. */
+	void Finish()
+	{
+		this->profile.raw_bytes = SlGetBytesRead() - this->profile.raw_bytes;
+		this->profile.compressed_bytes = SlGetCompressedBytesRead() - this->profile.compressed_bytes;
+		this->profile.objects = _slc.objects;
+		this->profile.time_us = SlProfileElapsed(this->start);
+		SlProfileChunk(this->profile);
+
+		uint32 id = this->profile.id;
+		DEBUG(sl, 3, "Loaded chunk %c%c%c%c (" PRINTF_SIZE " bytes, " PRINTF_SIZE " objects, " OTTD_PRINTF64U " us)", id >> 24, id >> 16, id >> 8, id,
+				this->profile.raw_bytes, this->profile.objects, this->profile.time_us);
+	}
+};
+
 /** Load all chunks */
 static void SlLoadChunks()
 {
@@ -2347,8 +2729,7 @@ static void SlLoadChunks()
 
 	for (uint32 id = SlReadUint32(); id != 0; id = SlReadUint32()) {
 		DEBUG(sl, 2, "Loading chunk %c%c%c%c", id >> 24, id >> 16, id >> 8, id);
-		size_t read = 0;
-		if (_debug_sl_level >= 3) read = SlGetBytesRead();
+		SlProfileLoadChunk profiler(id);
 
 		if (SlXvIsChunkDiscardable(id)) {
 			DEBUG(sl, 1, "Discarding chunk %c%c%c%c", id >> 24, id >> 16, id >> 8, id);
@@ -2361,7 +2742,7 @@ static void SlLoadChunks()
 				SlLoadChunk(*ch);
 			}
 		}
-		DEBUG(sl, 3, "Loaded chunk %c%c%c%c (" PRINTF_SIZE " bytes)", id >> 24, id >> 16, id >> 8, id, SlGetBytesRead() - read);
+		profiler.Finish();
 	}
 }
 
@@ -2378,8 +2759,7 @@ static void SlLoadCheckChunks()
 
 	for (id = SlReadUint32(); id != 0; id = SlReadUint32()) {
 		DEBUG(sl, 2, "Loading chunk %c%c%c%c", id >> 24, id >> 16, id >> 8, id);
-		size_t read = 0;
-		if (_debug_sl_level >= 3) read = SlGetBytesRead();
+		SlProfileLoadChunk profiler(id);
 
 		if (SlXvIsChunkDiscardable(id)) {
 			ch = nullptr;
@@ -2388,7 +2768,7 @@ static void SlLoadCheckChunks()
 			if (ch == nullptr) SlErrorCorrupt("Unknown chunk type");
 		}
 		SlLoadCheckChunk(ch);
-		DEBUG(sl, 3, "Loaded chunk %c%c%c%c (" PRINTF_SIZE " bytes)", id >> 24, id >> 16, id >> 8, id, SlGetBytesRead() - read);
+		profiler.Finish();
 	}
 }
 
@@ -2453,6 +2833,22 @@ struct FileReader : LoadFilter {
 	}
 };
 
+/**
+ * Get the number of bytes read from the savegame file, before decompression.
+ * This includes data buffered by the decompressor, so it is only an approximation of the compressed size of what has been read.
+ * @return The number of bytes, or 0 when not loading from a file.
+ */
+static size_t SlGetCompressedBytesRead()
+{
+	LoadFilter *filter = _sl.lf;
+	if (filter == nullptr) return 0;
+	while (filter->chain != nullptr) filter = filter->chain;
+
+	FileReader *reader = dynamic_cast<FileReader *>(filter);
+	if (reader == nullptr || reader->file == nullptr) return 0;
+	return ftell(reader->file) - reader->begin;
+}
+
 /** Yes, simply writing to a file. */
 struct FileWriter : SaveFilter {
 	FILE *file; ///< The file to write to.
@@ -2763,10 +3159,20 @@ struct LZMALoadFilter : LoadFilter {
 
 	/**
 	 * Initialise this filter.
-	 * @param chain The next filter in this chain.
+	 * @param chain   The next filter in this chain.
+	 * @param threads The number of threads to decompress with, only blocks of multi-threaded compressed saves can be decompressed in parallel.
 	 */
-	LZMALoadFilter(LoadFilter *chain) : LoadFilter(chain), lzma(_lzma_init)
+	LZMALoadFilter(LoadFilter *chain, uint threads) : LoadFilter(chain), lzma(_lzma_init)
 	{
+#if LZMA_VERSION >= 50040002
+		if (threads > 1) {
+			lzma_mt mt = {};
+			mt.threads = threads;
+			mt.memlimit_threading = 1 << 28;
+			mt.memlimit_stop = 1 << 28;
+			if (lzma_stream_decoder_mt(&this->lzma, &mt) == LZMA_OK) return;
+		}
+#endif
 		/* Allow saves up to 256 MB uncompressed */
 		if (lzma_auto_decoder(&this->lzma, 1 << 28, 0) != LZMA_OK) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "cannot initialize decompressor");
 	}
@@ -2807,9 +3213,19 @@ struct LZMASaveFilter : SaveFilter {
 	 * Initialise this filter.
 	 * @param chain             The next filter in this chain.
 	 * @param compression_level The requested level of compression.
+	 * @param threads           The number of threads to compress with, more than one splits the stream up in independently compressed blocks.
 	 */
-	LZMASaveFilter(SaveFilter *chain, byte compression_level) : SaveFilter(chain), lzma(_lzma_init)
+	LZMASaveFilter(SaveFilter *chain, byte compression_level, uint threads) : SaveFilter(chain), lzma(_lzma_init)
 	{
+#if LZMA_VERSION >= 50020002
+		if (threads > 1) {
+			lzma_mt mt = {};
+			mt.threads = threads;
+			mt.preset = compression_level;
+			mt.check = LZMA_CHECK_CRC32;
+			if (lzma_stream_encoder_mt(&this->lzma, &mt) == LZMA_OK) return;
+		}
+#endif
 		if (lzma_easy_encoder(&this->lzma, compression_level, LZMA_CHECK_CRC32) != LZMA_OK) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "cannot initialize compressor");
 	}
 
@@ -2920,8 +3336,9 @@ struct ZSTDSaveFilter : SaveFilter {
 	 * Initialise this filter.
 	 * @param chain             The next filter in this chain.
 	 * @param compression_level The requested level of compression.
+	 * @param threads           The number of threads to compress with, this is ignored if libzstd was built without multi-threading support.
 	 */
-	ZSTDSaveFilter(SaveFilter *chain, byte compression_level) : SaveFilter(chain)
+	ZSTDSaveFilter(SaveFilter *chain, byte compression_level, uint threads) : SaveFilter(chain)
 	{
 		this->zstd = ZSTD_createCCtx();
 		if (!this->zstd) SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "cannot initialize compressor");
@@ -2929,6 +3346,10 @@ struct ZSTDSaveFilter : SaveFilter {
 			ZSTD_freeCCtx(this->zstd);
 			SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, "invalid compresison level");
 		}
+		if (threads > 1) {
+			/* Fails harmlessly if libzstd has no multi-threading support, compression then stays in this thread. */
+			ZSTD_CCtx_setParameter(this->zstd, ZSTD_c_nbWorkers, (int)threads);
+		}
 	}
 
 	/** Clean up what we allocated. */
@@ -2982,6 +3403,7 @@ enum SaveLoadFormatFlags : byte {
 	SLF_NONE             = 0,
 	SLF_NO_THREADED_LOAD = 1 << 0, ///< Unsuitable for threaded loading
 	SLF_REQUIRES_ZSTD    = 1 << 1, ///< Automatic selection requires the zstd flag
+	SLF_MULTI_THREADED   = 1 << 2, ///< Filters can use multiple threads, see GetSaveLoadFilterThreads
 };
 DECLARE_ENUM_AS_BIT_SET(SaveLoadFormatFlags);
 
@@ -2990,8 +3412,8 @@ struct SaveLoadFormat {
 	const char *name;                     ///< name of the compressor/decompressor (debug-only)
 	uint32 tag;                           ///< the 4-letter tag by which it is identified in the savegame
 
-	LoadFilter *(*init_load)(LoadFilter *chain);                    ///< Constructor for the load filter.
-	SaveFilter *(*init_write)(SaveFilter *chain, byte compression); ///< Constructor for the save filter.
+	LoadFilter *(*init_load)(LoadFilter *chain, uint threads);                    ///< Constructor for the load filter.
+	SaveFilter *(*init_write)(SaveFilter *chain, byte compression, uint threads); ///< Constructor for the save filter.
 
 	byte min_compression;                 ///< the minimum compression level of this format
 	byte default_compression;             ///< the default compression level of this format
@@ -3023,7 +3445,7 @@ static const SaveLoadFormat _saveload_formats[] = {
 	 * The next significant reduction in file size is at level 4, but that is already 4 times slower. Level 3 is primarily 50%
 	 * slower while not improving the filesize, while level 0 and 1 are faster, but don't reduce savegame size much.
 	 * It's OTTX and not e.g. OTTL because liblzma is part of xz-utils and .tar.xz is preferred over .tar.lzma. */
-	{"lzma",   TO_BE32X('OTTX'), CreateLoadFilter<LZMALoadFilter>,   CreateSaveFilter<LZMASaveFilter>,   0, 2, 9, SLF_NONE},
+	{"lzma",   TO_BE32X('OTTX'), CreateLoadFilter<LZMALoadFilter>,   CreateSaveFilter<LZMASaveFilter>,   0, 2, 9, SLF_MULTI_THREADED},
 #else
 	{"lzma",   TO_BE32X('OTTX'), nullptr,                            nullptr,                            0, 0, 0, SLF_NONE},
 #endif
@@ -3034,12 +3456,24 @@ static const SaveLoadFormat _saveload_formats[] = {
 	 * (compress + 10 MB/s download + decompress time), about 3x faster than lzma:2 and 1.5x than zlib:2 and lzo.
 	 * As zstd has negative compression levels the values were increased by 100 moving zstd level range -100..22 into
 	 * openttd 0..122. Also note that value 100 mathes zstd level 0 which is a special value for default level 3 (openttd 103) */
-	{"zstd",   TO_BE32X('OTTS'), CreateLoadFilter<ZSTDLoadFilter>,   CreateSaveFilter<ZSTDSaveFilter>,   0, 101, 122, SLF_REQUIRES_ZSTD},
+	{"zstd",   TO_BE32X('OTTS'), CreateLoadFilter<ZSTDLoadFilter>,   CreateSaveFilter<ZSTDSaveFilter>,   0, 101, 122, SLF_REQUIRES_ZSTD | SLF_MULTI_THREADED},
 #else
 	{"zstd",   TO_BE32X('OTTS'), nullptr,                            nullptr,                            0, 0, 0, SLF_REQUIRES_ZSTD},
 #endif
 };
 
+/**
+ * Get the number of threads the filters of a savegame format may use.
+ * One thread is left for the game, which keeps running while saving in the background.
+ * @param fmt The savegame format.
+ * @return The number of threads.
+ */
+static uint GetSaveLoadFilterThreads(const SaveLoadFormat *fmt)
+{
+	if (!(fmt->flags & SLF_MULTI_THREADED)) return 1;
+	return std::max<uint>(_general_worker_pool.GetParallelism(), 2) - 1;
+}
+
 /**
  * Return the savegameformat of the game. Whether it was created with ZLIB compression
  * uncompressed, or another type
@@ -3110,6 +3544,7 @@ static inline void ClearSaveLoadState()
 {
 	delete _sl.dumper;
 	_sl.dumper = nullptr;
+	_slc.dumper = nullptr;
 
 	delete _sl.sf;
 	_sl.sf = nullptr;
@@ -3185,9 +3620,12 @@ static void SaveFileError()
  */
 static SaveOrLoadResult SaveFileToDisk(bool threaded)
 {
+	TRACE_ZONE("SaveFileToDisk");
+
 	try {
 		byte compression;
-		const SaveLoadFormat *fmt = GetSavegameFormat(_savegame_format, &compression, _sl.save_flags);
+		const bool use_autosave_format = (_sl.save_flags & SMF_AUTOSAVE) && !_autosave_format.empty();
+		const SaveLoadFormat *fmt = GetSavegameFormat(use_autosave_format ? _autosave_format : _savegame_format, &compression, _sl.save_flags);
 
 		DEBUG(sl, 3, "Using compression format: %s, level: %u", fmt->name, compression);
 
@@ -3195,10 +3633,11 @@ static SaveOrLoadResult SaveFileToDisk(bool threaded)
 		uint32 hdr[2] = { fmt->tag, TO_BE32((uint32) (SAVEGAME_VERSION | SAVEGAME_VERSION_EXT) << 16) };
 		_sl.sf->Write((byte*)hdr, sizeof(hdr));
 
-		_sl.sf = fmt->init_write(_sl.sf, compression);
+		_sl.sf = fmt->init_write(_sl.sf, compression, GetSaveLoadFilterThreads(fmt));
 		_sl.dumper->Flush(_sl.sf);
 
 		ClearSaveLoadState();
+		SlProfileStage("compress and write");
 
 		if (threaded) SetAsyncSaveFinish(SaveFileDone);
 
@@ -3227,6 +3666,17 @@ static SaveOrLoadResult SaveFileToDisk(bool threaded)
 
 void WaitTillSaved()
 {
+#ifdef WITH_FORKED_SAVES
+	if (_save_process > 0) {
+		int status;
+		pid_t result;
+		do {
+			result = waitpid(_save_process, &status, 0);
+		} while (result == -1 && errno == EINTR);
+		FinishForkedSave(result, status);
+	}
+#endif
+
 	if (!_save_thread.joinable()) return;
 
 	_save_thread.join();
@@ -3235,26 +3685,98 @@ void WaitTillSaved()
 	ProcessAsyncSaveFinish();
 }
 
+#ifdef WITH_FORKED_SAVES
+/**
+ * Save the game from a forked process, which has a copy-on-write snapshot of the game state.
+ * The child serialises, compresses and writes the savegame, while the parent continues right away.
+ * The parent notices the child exiting in ProcessAsyncSaveFinish or WaitTillSaved.
+ * @return True if the process was forked, false if saving should happen in this process.
+ */
+static bool DoForkedSave()
+{
+	pid_t pid = fork();
+	if (pid < 0) return false;
+
+	if (pid == 0) {
+		/* Only this thread exists in the child, so do everything in it. Exit without
+		 * running any destructors or exit handlers, those are for the parent's state. */
+		_config_worker_threads = 1;
+		int status = 1;
+		try {
+			SlSaveChunks();
+			if (SaveFileToDisk(false) == SL_OK) status = 0;
+		} catch (...) {
+		}
+		_exit(status);
+	}
+
+	_save_process = pid;
+	return true;
+}
+
+/**
+ * Handle the exit of the forked savegame process.
+ * @param result Result of waitpid.
+ * @param status Status of the process as returned by waitpid.
+ */
+static void FinishForkedSave(pid_t result, int status)
+{
+	_save_process = -1;
+
+	if (result == -1 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+		_sl.action = SLA_SAVE;
+		_sl.error_str = STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR;
+		free(_sl.extra_msg);
+		_sl.extra_msg = stredup("savegame process failed");
+		/* Skip the "colour" character */
+		DEBUG(sl, 0, "%s", GetSaveLoadErrorString() + 3);
+		SaveFileError();
+	} else {
+		SaveFileDone();
+	}
+}
+#endif /* WITH_FORKED_SAVES */
+
 /**
  * Actually perform the saving of the savegame.
  * General tactics is to first save the game to memory, then write it to file
  * using the writer, either in threaded mode if possible, or single-threaded.
  * @param writer   The filter to write the savegame to.
  * @param threaded Whether to try to perform the saving asynchronously.
+ * @param forked   Whether to try to perform the saving in a forked process, see DoForkedSave.
  * @return Return the result of the action. #SL_OK or #SL_ERROR
  */
-static SaveOrLoadResult DoSave(SaveFilter *writer, bool threaded)
+static SaveOrLoadResult DoSave(SaveFilter *writer, bool threaded, bool forked = false)
 {
+	TRACE_ZONE("DoSave");
+
 	assert(!_sl.saveinprogress);
 
+	SlProfileBegin("save");
 	_sl.dumper = new MemoryDumper();
+	_slc.dumper = _sl.dumper;
 	_sl.sf = writer;
 
 	_sl_version = SAVEGAME_VERSION;
 	SlXvSetCurrentState();
 
 	SaveViewportBeforeSaveGame();
+
+#ifdef WITH_FORKED_SAVES
+	if (forked) {
+		if (DoForkedSave()) {
+			/* The child has its own copies of the dumper and writer. */
+			ClearSaveLoadState();
+			SaveFileStart();
+			return SL_OK;
+		}
+		DEBUG(sl, 1, "Cannot fork savegame process, reverting to threaded mode...");
+	}
+#endif
+
 	SlSaveChunks();
+	_slc.dumper = nullptr;
+	SlProfileStage("save chunks");
 
 	SaveFileStart();
 
@@ -3408,6 +3930,9 @@ struct ThreadedLoadFilter : LoadFilter {
  */
 static SaveOrLoadResult DoLoad(LoadFilter *reader, bool load_check)
 {
+	TRACE_ZONE("DoLoad");
+
+	SlProfileBegin(load_check ? "load check" : "load");
 	_sl.lf = reader;
 
 	if (load_check) {
@@ -3494,7 +4019,7 @@ static SaveOrLoadResult DoLoad(LoadFilter *reader, bool load_check)
 		SlError(STR_GAME_SAVELOAD_ERROR_BROKEN_INTERNAL_ERROR, err_str);
 	}
 
-	_sl.lf = fmt->init_load(_sl.lf);
+	_sl.lf = fmt->init_load(_sl.lf, GetSaveLoadFilterThreads(fmt));
 	if (!(fmt->flags & SLF_NO_THREADED_LOAD)) {
 		_sl.lf = new ThreadedLoadFilter(_sl.lf);
 	}
@@ -3541,10 +4066,13 @@ static SaveOrLoadResult DoLoad(LoadFilter *reader, bool load_check)
 		/* Load chunks into _load_check_data.
 		 * No pools are loaded. References are not possible, and thus do not need resolving. */
 		SlLoadCheckChunks();
+		SlProfileStage("load chunks");
 	} else {
 		/* Load chunks and resolve references */
 		SlLoadChunks();
+		SlProfileStage("load chunks");
 		SlFixPointers();
+		SlProfileStage("fix pointers");
 	}
 
 	ClearSaveLoadState();
@@ -3623,7 +4151,9 @@ SaveOrLoadResult SaveOrLoad(const std::string &filename, SaveLoadOperation fop,
 			 * for OTTD savegames which have their own NewGRF logic. */
 			ClearGRFConfigList(&_grfconfig);
 			GamelogReset();
+			SlProfileBegin("load");
 			if (!LoadOldSaveGame(filename)) return SL_REINIT;
+			SlProfileStage("load old savegame");
 			_sl_version = SL_MIN_VERSION;
 			_sl_minor_version = 0;
 			SlXvResetState();
@@ -3670,7 +4200,7 @@ SaveOrLoadResult SaveOrLoad(const std::string &filename, SaveLoadOperation fop,
 			DEBUG(desync, 1, "save: date{%08x; %02x; %02x}; %s", _date, _date_fract, _tick_skip_counter, filename.c_str());
 			if (!_settings_client.gui.threaded_saves) threaded = false;
 
-			return DoSave(new FileWriter(fh), threaded);
+			return DoSave(new FileWriter(fh), threaded, threaded && _settings_client.gui.forked_saves);
 		}
 
 		/* LOAD game */
@@ -3706,7 +4236,7 @@ void DoAutoOrNetsave(FiosNumberedSaveName &counter, bool threaded)
 	}
 
 	DEBUG(sl, 2, "Autosaving to '%s'", buf);
-	if (SaveOrLoad(buf, SLO_SAVE, DFT_GAME_FILE, AUTOSAVE_DIR, threaded, SMF_ZSTD_OK) != SL_OK) {
+	if (SaveOrLoad(buf, SLO_SAVE, DFT_GAME_FILE, AUTOSAVE_DIR, threaded, SMF_ZSTD_OK | SMF_AUTOSAVE) != SL_OK) {
 		ShowErrorMessage(STR_ERROR_AUTOSAVE_FAILED, INVALID_STRING_ID, WL_ERROR);
 	}
 }
@@ -16,6 +16,7 @@
 #include "../strings_type.h"
 
 #include <stdarg.h>
+#include <functional>
 #include <vector>
 #include <string>
 #include <vector>
@@ -55,6 +56,7 @@ enum SaveModeFlags : byte {
 	SMF_NONE             = 0,
 	SMF_NET_SERVER       = 1 << 0, ///< Network server save
 	SMF_ZSTD_OK          = 1 << 1, ///< Zstd OK
+	SMF_AUTOSAVE         = 1 << 2, ///< Autosave or netsave, uses #_autosave_format if set
 };
 DECLARE_ENUM_AS_BIT_SET(SaveModeFlags);
 
@@ -74,6 +76,27 @@ SaveOrLoadResult SaveWithFilter(struct SaveFilter *writer, bool threaded, SaveMo
 SaveOrLoadResult LoadWithFilter(struct LoadFilter *reader);
 bool IsNetworkServerSave();
 
+/** Measurements of a single chunk of the last savegame which was saved or loaded. */
+struct SaveLoadChunkProfile {
+	uint32 id;               ///< ID of the chunk.
+	size_t raw_bytes;        ///< Size of the chunk before compression.
+	size_t compressed_bytes; ///< Approximate size of the chunk in the compressed savegame, only known when loading from a file.
+	size_t objects;          ///< Number of array elements in the chunk, 0 for RIFF chunks.
+	uint64 time_us;          ///< Wall time spent saving or loading the chunk, in microseconds.
+};
+
+/** Measurements of the last savegame which was saved or loaded. */
+struct SaveLoadProfile {
+	const char *operation = nullptr;                    ///< "save", "load" or "load check", nullptr if nothing has been profiled yet.
+	std::vector<SaveLoadChunkProfile> chunks;           ///< Chunks, in savegame order.
+	std::vector<std::pair<std::string, uint64>> stages; ///< Names and wall times in microseconds of the stages of the operation.
+};
+
+SaveLoadProfile GetLastSaveLoadProfile();
+void SlProfileStage(const char *name);
+void PrintSaveLoadProfile(const SaveLoadProfile &profile, std::function<void(const char *)> print);
+bool WriteSaveLoadProfileCSV(const SaveLoadProfile &profile, const char *filename);
+
 typedef void ChunkSaveLoadProc();
 typedef void AutolengthProc(void *arg);
 
@@ -93,6 +116,7 @@ struct ChunkHandler {
 	ChunkSaveLoadProc *ptrs_proc;       ///< Manipulate pointers in the chunk.
 	ChunkSaveLoadProc *load_check_proc; ///< Load procedure for game preview.
 	ChunkType type;                     ///< Type of the chunk. @see ChunkType
+	bool concurrent_save = false;       ///< Whether the save procedure only reads game state, so that it may run concurrently with other chunks.
 };
 
 struct NullStruct {
@@ -653,6 +677,7 @@ void SlResetVENC();
 void SlProcessVENC();
 
 extern std::string _savegame_format;
+extern std::string _autosave_format;
 extern bool _do_autosave;
 
 #endif /* SAVELOAD_H */
@@ -125,6 +125,24 @@ struct ReadBuffer {
 		}
 	}
 
+	/**
+	 * Read records of a fixed size in bulk, straight from the buffer.
+	 * @param count       The number of records to read.
+	 * @param record_size The size of one record in bytes, at most #MEMORY_CHUNK_SIZE.
+	 * @param proc        Called with the first record and the number of records of each consecutive run of records in the buffer.
+	 */
+	template <typename F>
+	inline void ReadRecords(size_t count, size_t record_size, F proc)
+	{
+		while (count != 0) {
+			this->CheckBytes(record_size);
+			const size_t run = std::min<size_t>(count, (this->bufe - this->bufp) / record_size);
+			proc(const_cast<const byte *>(this->bufp), run);
+			this->bufp += run * record_size;
+			count -= run;
+		}
+	}
+
 	/**
 	 * Get the size of the memory dump made so far.
 	 * @return The size.
@@ -175,6 +193,7 @@ struct MemoryDumper {
 
 	void FinaliseBlock();
 	void AllocateBuffer();
+	void Splice(MemoryDumper &other);
 
 	inline void CheckBytes(size_t bytes)
 	{
@@ -209,6 +228,24 @@ struct MemoryDumper {
 		}
 	}
 
+	/**
+	 * Write records of a fixed size in bulk, straight into the buffer.
+	 * @param count       The number of records to write.
+	 * @param record_size The size of one record in bytes, at most #MEMORY_CHUNK_SIZE.
+	 * @param proc        Called with the space for the first record and the number of records of each consecutive run of records in the buffer.
+	 */
+	template <typename F>
+	inline void WriteRecords(size_t count, size_t record_size, F proc)
+	{
+		while (count != 0) {
+			this->CheckBytes(record_size);
+			const size_t run = std::min<size_t>(count, (this->bufe - this->buf) / record_size);
+			proc(this->buf, run);
+			this->buf += run * record_size;
+			count -= run;
+		}
+	}
+
 	inline void RawWriteByte(byte b)
 	{
 		*this->buf++ = b;
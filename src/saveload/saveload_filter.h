@@ -10,6 +10,8 @@
 #ifndef SAVELOAD_FILTER_H
 #define SAVELOAD_FILTER_H
 
+#include <type_traits>
+
 /** Interface for filtering a savegame till it is loaded. */
 struct LoadFilter {
 	/** Chained to the (savegame) filters. */
@@ -48,12 +50,17 @@ struct LoadFilter {
 
 /**
  * Instantiator for a load filter.
- * @param chain The next filter in this chain.
- * @tparam T    The type of load filter to create.
+ * @param chain   The next filter in this chain.
+ * @param threads The number of threads the filter may use, if it supports that.
+ * @tparam T      The type of load filter to create.
  */
-template <typename T> LoadFilter *CreateLoadFilter(LoadFilter *chain)
+template <typename T> LoadFilter *CreateLoadFilter(LoadFilter *chain, uint threads)
 {
-	return new T(chain);
+	if constexpr (std::is_constructible_v<T, LoadFilter *, uint>) {
+		return new T(chain, threads);
+	} else {
+		return new T(chain);
+	}
 }
 
 /** Interface for filtering a savegame till it is written. */
@@ -95,11 +102,16 @@ struct SaveFilter {
  * Instantiator for a save filter.
  * @param chain             The next filter in this chain.
  * @param compression_level The requested level of compression.
+ * @param threads           The number of threads the filter may use, if it supports that.
  * @tparam T                The type of save filter to create.
  */
-template <typename T> SaveFilter *CreateSaveFilter(SaveFilter *chain, byte compression_level)
+template <typename T> SaveFilter *CreateSaveFilter(SaveFilter *chain, byte compression_level, uint threads)
 {
-	return new T(chain, compression_level);
+	if constexpr (std::is_constructible_v<T, SaveFilter *, byte, uint>) {
+		return new T(chain, compression_level, threads);
+	} else {
+		return new T(chain, compression_level);
+	}
 }
 
 #endif /* SAVELOAD_FILTER_H */
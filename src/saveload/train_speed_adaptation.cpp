@@ -11,7 +11,7 @@
 #include "../train_speed_adaptation.h"
 #include "saveload.h"
 
-using SignalSpeedType = std::pair<const SignalSpeedKey, SignalSpeedValue>;
+using SignalSpeedType = SignalSpeedMap::Entry;
 
 static const SaveLoad _train_speed_adaptation_map_desc[] = {
 	SLE_CONDVAR_X(SignalSpeedType, first.signal_track,           SLE_FILE_U8  | SLE_VAR_U16,    SL_MIN_VERSION, SL_MAX_VERSION, SlXvFeatureTest(XSLFTO_AND, XSLFI_TRAIN_SPEED_ADAPTATION, 1, 1)),
@@ -29,9 +29,9 @@ static void Load_TSAS()
 	int index;
 	SignalSpeedType data;
 	while ((index = SlIterateArray()) != -1) {
-		const_cast<SignalSpeedKey &>(data.first).signal_tile = index;
+		data.first.signal_tile = index;
 		SlObjectLoadFiltered(&data, _filtered_train_speed_adaptation_map_desc);
-		_signal_speeds.insert(data);
+		_signal_speeds.Set(data.first, data.second);
 	}
 	_filtered_train_speed_adaptation_map_desc.clear();
 }
@@ -44,11 +44,11 @@ static void RealSave_TSAS(SignalSpeedType *data)
 static void Save_TSAS()
 {
 	_filtered_train_speed_adaptation_map_desc = SlFilterObject(_train_speed_adaptation_map_desc);
-	for (auto &it : _signal_speeds) {
+	_signal_speeds.ForEach([](SignalSpeedType &it) {
 		SlSetArrayIndex(it.first.signal_tile);
 		SignalSpeedType *data = &it;
 		SlAutolength((AutolengthProc*) RealSave_TSAS, data);
-	}
+	});
 	_filtered_train_speed_adaptation_map_desc.clear();
 }
 
@@ -22,7 +22,21 @@
 namespace upstream_sl {
 
 typedef LinkGraph::BaseNode Node;
-typedef LinkGraph::BaseEdge Edge;
+
+/**
+ * Edge as stored in savegames: the edges of a node form a chain, starting at
+ * the node's link to itself, which has no other meaning.
+ */
+struct Edge : LinkGraph::BaseEdge {
+	NodeID next_edge; ///< Destination of next valid edge starting at the same source node.
+
+	/** Reset the edge, so that fields missing from old savegames have their default values. */
+	void Reset()
+	{
+		static_cast<LinkGraph::BaseEdge &>(*this) = LinkGraph::empty_edge;
+		this->next_edge = INVALID_NODE;
+	}
+};
 
 static uint16 _num_nodes;
 static LinkGraph *_linkgraph; ///< Contains the current linkgraph being saved/loaded.
@@ -42,14 +56,16 @@ public:
 
 	void Save(Node *bn) const override
 	{
-		uint16 size = 0;
-		for (NodeID to = _linkgraph_from; to != INVALID_NODE; to = _linkgraph->edges[_linkgraph_from][to].next_edge) {
-			size++;
-		}
-
-		SlSetStructListLength(size);
-		for (NodeID to = _linkgraph_from; to != INVALID_NODE; to = _linkgraph->edges[_linkgraph_from][to].next_edge) {
-			SlObject(&_linkgraph->edges[_linkgraph_from][to], this->GetDescription());
+		SlSetStructListLength(bn->edges.size() + 1);
+
+		Edge edge;
+		edge.Reset();
+		edge.next_edge = bn->edges.empty() ? INVALID_NODE : bn->edges.front().dest_node;
+		SlObject(&edge, this->GetDescription());
+		for (size_t i = 0; i < bn->edges.size(); ++i) {
+			static_cast<LinkGraph::BaseEdge &>(edge) = bn->edges[i];
+			edge.next_edge = (i + 1 < bn->edges.size()) ? bn->edges[i + 1].dest_node : INVALID_NODE;
+			SlObject(&edge, this->GetDescription());
 		}
 	}
 
@@ -57,26 +73,44 @@ public:
 	{
 		uint16 max_size = _linkgraph->Size();
 
+		auto add_edge = [&](const Edge &edge, NodeID to) {
+			if (to >= max_size || to == _linkgraph_from || bn->edges.size() >= max_size) SlErrorCorrupt("Link graph structure overflow");
+			bn->edges.push_back(edge);
+			bn->edges.back().dest_node = to;
+		};
+
 		if (IsSavegameVersionBefore(SLV_191)) {
 			/* We used to save the full matrix ... */
+			std::vector<Edge> row(max_size);
 			for (NodeID to = 0; to < max_size; ++to) {
-				SlObject(&_linkgraph->edges[_linkgraph_from][to], this->GetLoadDescription());
+				row[to].Reset();
+				SlObject(&row[to], this->GetLoadDescription());
+			}
+			for (NodeID to = row[_linkgraph_from].next_edge; to != INVALID_NODE; to = row[to].next_edge) {
+				add_edge(row[to], to);
+			}
+		} else {
+			size_t used_size = IsSavegameVersionBefore(SLV_SAVELOAD_LIST_LENGTH) ? max_size : SlGetStructListLength(UINT16_MAX);
+
+			/* ... but as that wasted a lot of space we save a sparse matrix now. */
+			Edge edge;
+			edge.next_edge = _linkgraph_from;
+			for (NodeID to = _linkgraph_from; to != INVALID_NODE; to = edge.next_edge) {
+				if (used_size == 0) SlErrorCorrupt("Link graph structure overflow");
+				used_size--;
+
+				if (to >= max_size) SlErrorCorrupt("Link graph structure overflow");
+				edge.Reset();
+				SlObject(&edge, this->GetLoadDescription());
+				if (to != _linkgraph_from) add_edge(edge, to);
 			}
-			return;
-		}
-
-		size_t used_size = IsSavegameVersionBefore(SLV_SAVELOAD_LIST_LENGTH) ? max_size : SlGetStructListLength(UINT16_MAX);
-
-		/* ... but as that wasted a lot of space we save a sparse matrix now. */
-		for (NodeID to = _linkgraph_from; to != INVALID_NODE; to = _linkgraph->edges[_linkgraph_from][to].next_edge) {
-			if (used_size == 0) SlErrorCorrupt("Link graph structure overflow");
-			used_size--;
 
-			if (to >= max_size) SlErrorCorrupt("Link graph structure overflow");
-			SlObject(&_linkgraph->edges[_linkgraph_from][to], this->GetLoadDescription());
+			if (!IsSavegameVersionBefore(SLV_SAVELOAD_LIST_LENGTH) && used_size > 0) SlErrorCorrupt("Corrupted link graph");
 		}
 
-		if (!IsSavegameVersionBefore(SLV_SAVELOAD_LIST_LENGTH) && used_size > 0) SlErrorCorrupt("Corrupted link graph");
+		std::sort(bn->edges.begin(), bn->edges.end(), [](const LinkGraph::BaseEdge &a, const LinkGraph::BaseEdge &b) {
+			return a.dest_node < b.dest_node;
+		});
 	}
 };
 
@@ -99,7 +133,7 @@ public:
 		SlSetStructListLength(lg->Size());
 		for (NodeID from = 0; from < lg->Size(); ++from) {
 			_linkgraph_from = from;
-			SlObject(&lg->nodes[from], this->GetDescription());
+			SlObject(lg->nodes[from].get(), this->GetDescription());
 		}
 	}
 
@@ -111,7 +145,7 @@ public:
 		lg->Init(length);
 		for (NodeID from = 0; from < length; ++from) {
 			_linkgraph_from = from;
-			SlObject(&lg->nodes[from], this->GetLoadDescription());
+			SlObject(lg->nodes[from].get(), this->GetLoadDescription());
 		}
 	}
 };
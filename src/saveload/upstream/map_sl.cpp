@@ -79,7 +79,7 @@ struct MAPTChunkHandler : ChunkHandler {
 
 		for (TileIndex i = 0; i != size;) {
 			SlCopy(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].type = buf[j];
+			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _mth[i++].type = buf[j];
 		}
 	}
 
@@ -90,7 +90,7 @@ struct MAPTChunkHandler : ChunkHandler {
 
 		SlSetLength(size);
 		for (TileIndex i = 0; i != size;) {
-			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _m[i++].type;
+			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _mth[i++].type;
 			SlCopy(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
 		}
 	}
@@ -106,7 +106,7 @@ struct MAPHChunkHandler : ChunkHandler {
 
 		for (TileIndex i = 0; i != size;) {
 			SlCopy(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
-			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _m[i++].height = buf[j];
+			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) _mth[i++].height = buf[j];
 		}
 	}
 
@@ -117,7 +117,7 @@ struct MAPHChunkHandler : ChunkHandler {
 
 		SlSetLength(size);
 		for (TileIndex i = 0; i != size;) {
-			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _m[i++].height;
+			for (uint j = 0; j != MAP_SL_BUF_SIZE; j++) buf[j] = _mth[i++].height;
 			SlCopy(buf.data(), MAP_SL_BUF_SIZE, SLE_UINT8);
 		}
 	}
@@ -450,6 +450,34 @@ void DispatchSchedule::RemoveScheduledDispatch(uint32 offset)
 	this->scheduled_dispatch.erase(erase_position);
 }
 
+/**
+ * Get the first dispatch slot at or after a given time, the slots repeat every duration from the start tick onwards.
+ * The slot offsets are sorted, so this is a binary search instead of a scan over all slots.
+ * @param tick The earliest time of the slot.
+ * @return The time of the slot, or -1 if there are no slots within the duration.
+ */
+DateTicksScaled DispatchSchedule::GetFirstDispatchSlotFrom(DateTicksScaled tick) const
+{
+	const uint32 duration = this->GetScheduledDispatchDuration();
+
+	/* Only the offsets within the duration are used, these are at the front of the list. */
+	auto slots_end = std::lower_bound(this->scheduled_dispatch.begin(), this->scheduled_dispatch.end(), duration);
+	if (slots_end == this->scheduled_dispatch.begin()) return -1;
+
+	const DateTicksScaled begin_time = this->GetScheduledDispatchStartTick();
+	if (tick <= begin_time) return begin_time + this->scheduled_dispatch.front();
+
+	DateTicksScaled period = (tick - begin_time) / duration;
+	uint32 offset = (uint32)((tick - begin_time) % duration);
+	auto slot = std::lower_bound(this->scheduled_dispatch.begin(), slots_end, offset);
+	if (slot == slots_end) {
+		/* Past the last slot of this period, use the first slot of the next one. */
+		period++;
+		slot = this->scheduled_dispatch.begin();
+	}
+	return begin_time + (period * duration) + *slot;
+}
+
 bool DispatchSchedule::UpdateScheduledDispatchToDate(DateTicksScaled now)
 {
 	bool update_windows = false;
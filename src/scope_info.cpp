@@ -24,17 +24,17 @@
 
 #ifdef USE_SCOPE_INFO
 
-std::vector<std::function<int(char *, const char *)>> _scope_stack;
+scope_info_func_obj *_scope_stack_top = nullptr;
 
 int WriteScopeLog(char *buf, const char *last)
 {
 	char *b = buf;
-	if (!_scope_stack.empty()) {
+	if (_scope_stack_top != nullptr) {
 		b += seprintf(b, last, "Within context:");
 		int depth = 0;
-		for (auto it = _scope_stack.rbegin(); it != _scope_stack.rend(); ++it, depth++) {
+		for (const scope_info_func_obj *it = _scope_stack_top; it != nullptr; it = it->prev, depth++) {
 			b += seprintf(b, last, "\n    %2d: ", depth);
-			b += (*it)(b, last);
+			b += it->proc(it->func, b, last);
 		}
 		b += seprintf(b, last, "\n\n");
 	}
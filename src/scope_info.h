@@ -12,47 +12,61 @@
 
 #include "tile_type.h"
 
-#include <functional>
-#include <vector>
-
 struct Vehicle;
 struct BaseStation;
 struct Window;
 
 #ifdef USE_SCOPE_INFO
 
-extern std::vector<std::function<int(char *, const char *)>> _scope_stack;
-
+/**
+ * Entry of the scope stack, which is linked through the stack frames of the scopes themselves.
+ * Entering and leaving a scope only links and unlinks the entry; the scope info is only formatted when the scope log is written.
+ */
 struct scope_info_func_obj {
-	scope_info_func_obj(std::function<int(char *, const char *)> func)
-	{
-		_scope_stack.emplace_back(std::move(func));
-	}
+	typedef int ScopeInfoProc(const void *func, char *buf, const char *last);
+
+	scope_info_func_obj *prev;  ///< Entry of the enclosing scope, or nullptr.
+	const void *func;           ///< Function object which writes the scope info.
+	ScopeInfoProc *proc;        ///< Calls #func.
+
+	template <typename F>
+	scope_info_func_obj(const F &func);
 
 	scope_info_func_obj(const scope_info_func_obj &copysrc) = delete;
 
-	~scope_info_func_obj()
-	{
-		_scope_stack.pop_back();
-	}
+	~scope_info_func_obj();
 };
 
+extern scope_info_func_obj *_scope_stack_top;
+
+template <typename F>
+scope_info_func_obj::scope_info_func_obj(const F &func) : prev(_scope_stack_top), func(&func)
+{
+	this->proc = [](const void *func, char *buf, const char *last) -> int {
+		return (*static_cast<const F *>(func))(buf, last);
+	};
+	_scope_stack_top = this;
+}
+
+inline scope_info_func_obj::~scope_info_func_obj()
+{
+	_scope_stack_top = this->prev;
+}
+
 int WriteScopeLog(char *buf, const char *last);
 
 #define SCOPE_INFO_PASTE(a, b) a ## b
 
 /**
  * This creates a lambda in the current scope with the specified capture which outputs the given args as a format string.
- * This lambda is then captured by reference in a std::function which is pushed onto the scope stack
+ * A reference to this lambda is then pushed onto the scope stack, without any allocation or type erasure.
  * The scope stack is popped at the end of the scope
  */
 #define SCOPE_INFO_FMT(capture, ...) \
 	auto SCOPE_INFO_PASTE(_sc_lm_, __LINE__) = capture (char *buf, const char *last) { \
 		return seprintf(buf, last, __VA_ARGS__); \
 	}; \
-	scope_info_func_obj SCOPE_INFO_PASTE(_sc_obj_, __LINE__) ([&](char *buf, const char *last) -> int { \
-		return SCOPE_INFO_PASTE(_sc_lm_, __LINE__) (buf, last); \
-	});
+	scope_info_func_obj SCOPE_INFO_PASTE(_sc_obj_, __LINE__) (SCOPE_INFO_PASTE(_sc_lm_, __LINE__));
 
 #else /* USE_SCOPE_INFO */
 
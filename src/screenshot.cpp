@@ -31,6 +31,7 @@
 #include "smallmap_colours.h"
 #include "smallmap_gui.h"
 #include "screenshot_gui.h"
+#include "network/network.h"
 
 #include "table/strings.h"
 
@@ -249,6 +250,10 @@ static bool MakeBMPImage(const char *name, ScreenshotCallback *callb, void *user
 #include "base_media_base.h"
 #endif /* PNG_TEXT_SUPPORTED */
 
+#include "thread.h"
+#include <condition_variable>
+#include <mutex>
+
 static void PNGAPI png_my_error(png_structp png_ptr, png_const_charp message)
 {
 	DEBUG(misc, 0, "[libpng] error: %s - %s", message, (const char *)png_get_error_ptr(png_ptr));
@@ -260,6 +265,157 @@ static void PNGAPI png_my_warning(png_structp png_ptr, png_const_charp message)
 	DEBUG(misc, 1, "[libpng] warning: %s - %s", message, (const char *)png_get_error_ptr(png_ptr));
 }
 
+/**
+ * Write lines of pixels to a PNG image.
+ * This sets its own error handler, so it can be called from another thread than the one which set up the image.
+ * @param png_ptr The image.
+ * @param buf The lines of pixels.
+ * @param n The number of lines.
+ * @param row_bytes The number of bytes per line.
+ * @return True iff the lines were written successfully.
+ */
+static bool WritePNGRows(png_structp png_ptr, const uint8 *buf, uint n, uint row_bytes)
+{
+	if (setjmp(png_jmpbuf(png_ptr))) return false;
+
+	for (uint i = 0; i != n; i++) {
+		png_write_row(png_ptr, (png_const_bytep)buf + i * row_bytes);
+	}
+	return true;
+}
+
+/**
+ * Writer of the lines of a PNG image on a separate thread, so that compressing the lines overlaps with generating the next lines.
+ * The memory use is bounded by the fixed number of buffers of lines, generating the lines waits when all of them are full.
+ */
+struct PNGThreadedRowWriter {
+	static const uint BUFFER_COUNT = 2;
+
+	png_structp png_ptr;
+	const uint row_bytes;             ///< Number of bytes per line.
+	const uint maxlines;              ///< Number of lines per buffer.
+	std::vector<uint8> buffers;       ///< The buffers, each of maxlines lines.
+	uint buffer_lines[BUFFER_COUNT];  ///< Number of lines in each full buffer.
+
+	std::mutex mutex;
+	std::condition_variable full_cv;  ///< Notified when a buffer has been filled, or there is nothing left to fill.
+	std::condition_variable empty_cv; ///< Notified when a buffer has been written.
+	uint first_full = 0;              ///< First full buffer.
+	uint count_full = 0;              ///< Number of full buffers.
+	bool finished = false;            ///< Whether no more buffers will be filled.
+	bool failed = false;              ///< Whether writing the image failed.
+
+	std::thread write_thread;
+
+	PNGThreadedRowWriter(png_structp png_ptr, uint row_bytes, uint maxlines) :
+			png_ptr(png_ptr), row_bytes(row_bytes), maxlines(maxlines), buffers((size_t)row_bytes * maxlines * BUFFER_COUNT) {}
+
+	/**
+	 * Start the write thread.
+	 * @return True iff the thread is running.
+	 */
+	bool Start()
+	{
+		return StartNewThread(&this->write_thread, "ottd:screenshot", &PNGThreadedRowWriter::RunThread, this);
+	}
+
+	static void RunThread(PNGThreadedRowWriter *self)
+	{
+		std::unique_lock<std::mutex> lk(self->mutex);
+		while (true) {
+			if (self->count_full == 0) {
+				if (self->finished) return;
+				self->full_cv.wait(lk);
+				continue;
+			}
+
+			const uint buf = self->first_full;
+			const bool write = !self->failed;
+			lk.unlock();
+			const bool ok = !write || WritePNGRows(self->png_ptr, self->buffers.data() + (size_t)buf * self->row_bytes * self->maxlines, self->buffer_lines[buf], self->row_bytes);
+			lk.lock();
+			if (!ok) self->failed = true;
+			self->first_full = (self->first_full + 1) % BUFFER_COUNT;
+			self->count_full--;
+			self->empty_cv.notify_one();
+		}
+	}
+
+	/**
+	 * Get the next buffer to fill, waiting until one has been written if needed.
+	 * @return The buffer, or nullptr if writing the image failed.
+	 */
+	uint8 *GetEmptyBuffer()
+	{
+		std::unique_lock<std::mutex> lk(this->mutex);
+		while (this->count_full == BUFFER_COUNT && !this->failed) this->empty_cv.wait(lk);
+		if (this->failed) return nullptr;
+		return this->buffers.data() + (size_t)((this->first_full + this->count_full) % BUFFER_COUNT) * this->row_bytes * this->maxlines;
+	}
+
+	/**
+	 * Pass the buffer returned by #GetEmptyBuffer to the write thread.
+	 * @param n Number of lines in the buffer.
+	 */
+	void SubmitBuffer(uint n)
+	{
+		std::unique_lock<std::mutex> lk(this->mutex);
+		this->buffer_lines[(this->first_full + this->count_full) % BUFFER_COUNT] = n;
+		this->count_full++;
+		this->full_cv.notify_one();
+	}
+
+	/**
+	 * Wait until all submitted buffers have been written, and stop the write thread.
+	 * @return True iff all lines were written successfully.
+	 */
+	bool Finish()
+	{
+		std::unique_lock<std::mutex> lk(this->mutex);
+		this->finished = true;
+		this->full_cv.notify_one();
+		lk.unlock();
+		this->write_thread.join();
+		return !this->failed;
+	}
+};
+
+/**
+ * Generate and write all lines of a PNG image, compressing the lines on a separate thread.
+ * @param png_ptr The image.
+ * @param callb Callback function for generating lines of pixels.
+ * @param userdata User data, passed on to \a callb.
+ * @param w Width of the image in pixels.
+ * @param h Height of the image in pixels.
+ * @param bpp Bytes per pixel.
+ * @param maxlines Maximum number of lines to generate at a time.
+ * @param[out] success Whether all lines were written successfully.
+ * @return False if no thread could be started, and nothing was written.
+ */
+static bool WritePNGRowsThreaded(png_structp png_ptr, ScreenshotCallback *callb, void *userdata, uint w, uint h, uint bpp, uint maxlines, bool &success)
+{
+	PNGThreadedRowWriter writer(png_ptr, w * bpp, maxlines);
+	if (!writer.Start()) return false;
+
+	uint y = 0;
+	do {
+		uint8 *buff = writer.GetEmptyBuffer();
+		if (buff == nullptr) break;
+
+		/* determine # lines to write */
+		uint n = std::min(h - y, maxlines);
+
+		/* render the pixels into the buffer */
+		callb(userdata, buff, y, w, n);
+		y += n;
+
+		writer.SubmitBuffer(n);
+	} while (y != h);
+
+	success = writer.Finish();
+	return true;
+}
+
 /**
  * Generic .PNG file image writer.
  * @param name        Filename, including extension.
@@ -269,10 +425,10 @@ static void PNGAPI png_my_warning(png_structp png_ptr, png_const_charp message)
  * @param h           Height of the image in pixels.
  * @param pixelformat Bits per pixel (bpp), either 8 or 32.
  * @param palette     %Colour palette (for 8bpp images).
+ * @param game_info   Whether to add a description of the game to the image, this accesses the game state.
  * @return File was written successfully.
- * @see ScreenshotHandlerProc
  */
-static bool MakePNGImage(const char *name, ScreenshotCallback *callb, void *userdata, uint w, uint h, int pixelformat, const Colour *palette)
+static bool WritePNGImage(const char *name, ScreenshotCallback *callb, void *userdata, uint w, uint h, int pixelformat, const Colour *palette, bool game_info)
 {
 	png_color rq[256];
 	FILE *f;
@@ -326,33 +482,37 @@ static bool MakePNGImage(const char *name, ScreenshotCallback *callb, void *user
 	text[0].compression = PNG_TEXT_COMPRESSION_NONE;
 
 	char buf[8192];
-	char *p = buf;
-	p += seprintf(p, lastof(buf), "Graphics set: %s (%u)\n", BaseGraphics::GetUsedSet()->name.c_str(), BaseGraphics::GetUsedSet()->version);
-	p = strecpy(p, "NewGRFs:\n", lastof(buf));
-	for (const GRFConfig *c = _game_mode == GM_MENU ? nullptr : _grfconfig; c != nullptr; c = c->next) {
-		p += seprintf(p, lastof(buf), "%08X ", BSWAP32(c->ident.grfid));
-		p = md5sumToString(p, lastof(buf), c->ident.md5sum);
-		p += seprintf(p, lastof(buf), " %s\n", c->filename);
-	}
-	p = strecpy(p, "\nCompanies:\n", lastof(buf));
-	for (const Company *c : Company::Iterate()) {
-		if (c->ai_info == nullptr) {
-			p += seprintf(p, lastof(buf), "%2i: Human\n", (int)c->index);
-		} else {
-			p += seprintf(p, lastof(buf), "%2i: %s (v%d)\n", (int)c->index, c->ai_info->GetName(), c->ai_info->GetVersion());
+	int num_text = 1;
+	if (game_info) {
+		char *p = buf;
+		p += seprintf(p, lastof(buf), "Graphics set: %s (%u)\n", BaseGraphics::GetUsedSet()->name.c_str(), BaseGraphics::GetUsedSet()->version);
+		p = strecpy(p, "NewGRFs:\n", lastof(buf));
+		for (const GRFConfig *c = _game_mode == GM_MENU ? nullptr : _grfconfig; c != nullptr; c = c->next) {
+			p += seprintf(p, lastof(buf), "%08X ", BSWAP32(c->ident.grfid));
+			p = md5sumToString(p, lastof(buf), c->ident.md5sum);
+			p += seprintf(p, lastof(buf), " %s\n", c->filename);
 		}
+		p = strecpy(p, "\nCompanies:\n", lastof(buf));
+		for (const Company *c : Company::Iterate()) {
+			if (c->ai_info == nullptr) {
+				p += seprintf(p, lastof(buf), "%2i: Human\n", (int)c->index);
+			} else {
+				p += seprintf(p, lastof(buf), "%2i: %s (v%d)\n", (int)c->index, c->ai_info->GetName(), c->ai_info->GetVersion());
+			}
+		}
+		text[1].key = const_cast<char *>("Description");
+		text[1].text = buf;
+		text[1].text_length = p - buf;
+		text[1].compression = PNG_TEXT_COMPRESSION_zTXt;
+		if (_screenshot_aux_text_key && _screenshot_aux_text_value) {
+			text[2].key = const_cast<char *>(_screenshot_aux_text_key);
+			text[2].text = const_cast<char *>(_screenshot_aux_text_value);
+			text[2].text_length = strlen(_screenshot_aux_text_value);
+			text[2].compression = PNG_TEXT_COMPRESSION_zTXt;
+		}
+		num_text = _screenshot_aux_text_key && _screenshot_aux_text_value ? 3 : 2;
 	}
-	text[1].key = const_cast<char *>("Description");
-	text[1].text = buf;
-	text[1].text_length = p - buf;
-	text[1].compression = PNG_TEXT_COMPRESSION_zTXt;
-	if (_screenshot_aux_text_key && _screenshot_aux_text_value) {
-		text[2].key = const_cast<char *>(_screenshot_aux_text_key);
-		text[2].text = const_cast<char *>(_screenshot_aux_text_value);
-		text[2].text_length = strlen(_screenshot_aux_text_value);
-		text[2].compression = PNG_TEXT_COMPRESSION_zTXt;
-	}
-	png_set_text(png_ptr, info_ptr, text, _screenshot_aux_text_key && _screenshot_aux_text_value ? 3 : 2);
+	png_set_text(png_ptr, info_ptr, text, num_text);
 #endif /* PNG_TEXT_SUPPORTED */
 
 	if (pixelformat == 8) {
@@ -391,31 +551,59 @@ static bool MakePNGImage(const char *name, ScreenshotCallback *callb, void *user
 	/* use by default 64k temp memory */
 	maxlines = Clamp(65536 / w, 16, 128);
 
-	/* now generate the bitmap bits */
-	void *buff = CallocT<uint8>(w * maxlines * bpp); // by default generate 128 lines at a time.
+	/* now generate the bitmap bits, while compressing the previous lines on another thread if possible */
+	bool rows_written;
+	if (!WritePNGRowsThreaded(png_ptr, callb, userdata, w, h, bpp, maxlines, rows_written)) {
+		void *buff = CallocT<uint8>(w * maxlines * bpp); // by default generate 128 lines at a time.
 
-	y = 0;
-	do {
-		/* determine # lines to write */
-		n = std::min(h - y, maxlines);
+		y = 0;
+		do {
+			/* determine # lines to write */
+			n = std::min(h - y, maxlines);
 
-		/* render the pixels into the buffer */
-		callb(userdata, buff, y, w, n);
-		y += n;
+			/* render the pixels into the buffer */
+			callb(userdata, buff, y, w, n);
+			y += n;
 
-		/* write them to png */
-		for (i = 0; i != n; i++) {
-			png_write_row(png_ptr, (png_bytep)buff + i * w * bpp);
-		}
-	} while (y != h);
+			/* write them to png */
+			for (i = 0; i != n; i++) {
+				png_write_row(png_ptr, (png_bytep)buff + i * w * bpp);
+			}
+		} while (y != h);
+
+		free(buff);
+		rows_written = true;
+	}
+
+	/* The rows may have been written by another thread, which took over the error handling. */
+	if (!rows_written || setjmp(png_jmpbuf(png_ptr))) {
+		png_destroy_write_struct(&png_ptr, &info_ptr);
+		fclose(f);
+		return false;
+	}
 
 	png_write_end(png_ptr, info_ptr);
 	png_destroy_write_struct(&png_ptr, &info_ptr);
 
-	free(buff);
 	fclose(f);
 	return true;
 }
+/**
+ * Generic .PNG file image writer.
+ * @param name        Filename, including extension.
+ * @param callb       Callback function for generating lines of pixels.
+ * @param userdata    User data, passed on to \a callb.
+ * @param w           Width of the image in pixels.
+ * @param h           Height of the image in pixels.
+ * @param pixelformat Bits per pixel (bpp), either 8 or 32.
+ * @param palette     %Colour palette (for 8bpp images).
+ * @return File was written successfully.
+ * @see ScreenshotHandlerProc
+ */
+static bool MakePNGImage(const char *name, ScreenshotCallback *callb, void *userdata, uint w, uint h, int pixelformat, const Colour *palette)
+{
+	return WritePNGImage(name, callb, userdata, w, h, pixelformat, palette, true);
+}
 #endif /* WITH_PNG */
 
 
@@ -1354,3 +1542,190 @@ bool MakeIndustryScreenshot(const char *name)
 	const ScreenshotFormat *sf = _screenshot_formats + _cur_screenshot_format;
 	return sf->proc(MakeScreenshotName(SCREENSHOT_NAME, sf->extension), IndustryScreenCallback, nullptr, MapSizeX(), MapSizeY(), 32, _cur_palette.palette);
 }
+
+#if defined(WITH_PNG)
+
+/** Images exported by the map export of dedicated servers. */
+enum MapExportImage {
+	MEI_MINIMAP,    ///< Owners of the tiles, as in the minimap screenshot.
+	MEI_TOPOGRAPHY, ///< Topography, as in the topography screenshot.
+	MEI_INDUSTRY,   ///< Industries, as in the industry screenshot.
+	MEI_END,
+};
+
+/** File names of the exported map images. */
+static const char * const _map_export_names[MEI_END] = { "map_minimap.png", "map_topography.png", "map_industry.png" };
+
+/**
+ * Periodic export of images of the map on dedicated servers.
+ * The images are kept as a palette index per tile, in the layout of the minimap screenshots. Every game loop refreshes
+ * a few rows of them, so that the whole map is refreshed once per export interval without stalling the game.
+ * After each complete sweep over the map, a copy of the images is written to PNG files by a background thread.
+ */
+struct MapExporter {
+	uint size_x = 0;                     ///< Width of the images.
+	uint size_y = 0;                     ///< Height of the images.
+	uint next_row = 0;                   ///< First row which has not been refreshed in this sweep.
+	uint32 loops = 0;                    ///< Number of game loops done in this sweep.
+	std::vector<byte> images[MEI_END];   ///< Palette index of each pixel of the images.
+
+	/** Copy of the images which is being written by the write thread. */
+	struct WriteJob {
+		std::string dir;                   ///< Directory to write the images to.
+		std::vector<byte> images[MEI_END]; ///< The images.
+		Colour palette[256];               ///< Palette of the images.
+	};
+	std::unique_ptr<WriteJob> job;       ///< Images being written, only accessed by the write thread while #writing is set.
+	std::thread write_thread;            ///< Thread writing the images.
+	std::atomic<bool> writing { false }; ///< Whether the write thread is busy.
+
+	void RefreshRows(uint first, uint count);
+	void StartWrite();
+	static void WriteThread(MapExporter *self);
+	void Loop();
+	void Stop();
+};
+
+static MapExporter _map_exporter;
+
+/**
+ * Refresh rows of the images.
+ * @param first The first row.
+ * @param count The number of rows.
+ */
+void MapExporter::RefreshRows(uint first, uint count)
+{
+	byte owner_colours[OWNER_END + 1];
+	for (const Company *c : Company::Iterate()) {
+		owner_colours[c->index] = MKCOLOUR(_colour_gradient[c->colour][5]);
+	}
+	owner_colours[OWNER_TOWN]    = PC_DARK_RED;
+	owner_colours[OWNER_NONE]    = PC_GRASS_LAND;
+	owner_colours[OWNER_WATER]   = PC_WATER;
+	owner_colours[OWNER_DEITY]   = PC_DARK_GREY; // industry
+	owner_colours[OWNER_END]     = PC_BLACK;
+
+	for (uint row = first; row < first + count; row++) {
+		size_t i = (size_t)row * this->size_x;
+		for (uint col = 0; col < this->size_x; col++, i++) {
+			const TileIndex tile = TileXY(this->size_x - 1 - col, row);
+			this->images[MEI_MINIMAP][i] = owner_colours[GetMinimapOwner(tile)];
+			this->images[MEI_TOPOGRAPHY][i] = GetTopographyValue(tile);
+			this->images[MEI_INDUSTRY][i] = GetIndustryValue(tile);
+		}
+	}
+}
+
+/** Callback of the screenshot generator which copies the lines of an exported map image. */
+static void MapExportImageCallback(void *userdata, void *buf, uint y, uint pitch, uint n)
+{
+	const byte *image = (const byte *)userdata;
+	memcpy(buf, image + (size_t)y * pitch, (size_t)pitch * n);
+}
+
+/* static */ void MapExporter::WriteThread(MapExporter *self)
+{
+	const WriteJob *job = self->job.get();
+	for (uint i = 0; i < MEI_END; i++) {
+		/* Write to a temporary file first, so readers never see a partially written image. */
+		const std::string name = job->dir + _map_export_names[i];
+		const std::string tmp_name = name + ".tmp";
+		if (!WritePNGImage(tmp_name.c_str(), MapExportImageCallback, const_cast<byte *>(job->images[i].data()), self->size_x, self->size_y, 8, job->palette, false)) {
+			DEBUG(misc, 0, "Map export: writing %s failed", tmp_name.c_str());
+			continue;
+		}
+#if defined(_WIN32)
+		_wunlink(OTTD2FS(name).c_str());
+		if (_wrename(OTTD2FS(tmp_name).c_str(), OTTD2FS(name).c_str()) != 0) {
+#else
+		if (rename(OTTD2FS(tmp_name).c_str(), OTTD2FS(name).c_str()) != 0) {
+#endif
+			DEBUG(misc, 0, "Map export: renaming %s to %s failed", tmp_name.c_str(), name.c_str());
+		}
+	}
+	self->writing.store(false, std::memory_order_release);
+}
+
+/** Start writing the images in the background, unless the previous images are still being written. */
+void MapExporter::StartWrite()
+{
+	if (this->writing.load(std::memory_order_acquire)) {
+		DEBUG(misc, 1, "Map export: previous images are still being written, skipping this export");
+		return;
+	}
+	if (this->write_thread.joinable()) this->write_thread.join();
+
+	if (this->job == nullptr) this->job.reset(new WriteJob());
+	WriteJob *job = this->job.get();
+	job->dir = _settings_client.network.map_export_dir.empty() ? FiosGetScreenshotDir() : _settings_client.network.map_export_dir;
+	if (job->dir.back() != PATHSEPCHAR) job->dir += PATHSEPCHAR;
+	for (uint i = 0; i < MEI_END; i++) job->images[i] = this->images[i];
+	MemCpyT(job->palette, _cur_palette.palette, lengthof(job->palette));
+
+	this->writing.store(true, std::memory_order_relaxed);
+	if (!StartNewThread(&this->write_thread, "ottd:mapexport", &MapExporter::WriteThread, this)) {
+		WriteThread(this);
+	}
+}
+
+/** Refresh the part of the images which is due in this game loop, and write them when they are complete. */
+void MapExporter::Loop()
+{
+	if (this->size_x != MapSizeX() || this->size_y != MapSizeY()) {
+		/* New map; start a new sweep. */
+		this->size_x = MapSizeX();
+		this->size_y = MapSizeY();
+		for (std::vector<byte> &image : this->images) image.assign((size_t)this->size_x * this->size_y, 0);
+		this->next_row = 0;
+		this->loops = 0;
+	}
+
+	const uint32 sweep_loops = std::max<uint32>(1, _settings_client.network.map_export_interval * (60000 / MILLISECONDS_PER_TICK));
+	this->loops++;
+	const uint due = (uint)std::min<uint64>(this->size_y, ((uint64)this->size_y * this->loops) / sweep_loops);
+	if (due > this->next_row) {
+		this->RefreshRows(this->next_row, due - this->next_row);
+		this->next_row = due;
+	}
+
+	if (this->next_row == this->size_y) {
+		this->next_row = 0;
+		this->loops = 0;
+		this->StartWrite();
+	}
+}
+
+/** Wait for the write thread, and release the images. */
+void MapExporter::Stop()
+{
+	if (this->write_thread.joinable()) this->write_thread.join();
+	this->job.reset();
+	for (std::vector<byte> &image : this->images) image = std::vector<byte>();
+	this->size_x = this->size_y = 0;
+}
+
+/**
+ * Export images of the map periodically on dedicated servers, see #MapExporter.
+ * This is called every game loop.
+ */
+void MapExportLoop()
+{
+	if (_settings_client.network.map_export_interval == 0 || !_network_dedicated || _game_mode != GM_NORMAL) return;
+
+	_map_exporter.Loop();
+}
+
+/**
+ * Stop exporting images of the map, waiting for images being written.
+ */
+void MapExportStop()
+{
+	_map_exporter.Stop();
+}
+
+#else
+
+void MapExportLoop() {}
+void MapExportStop() {}
+
+#endif /* WITH_PNG */
@@ -41,6 +41,8 @@ bool MakeTopographyScreenshot(const char *name);
 bool MakeIndustryScreenshot(const char *name);
 void SetScreenshotAuxiliaryText(const char *key, const char *value);
 inline void ClearScreenshotAuxiliaryText() { SetScreenshotAuxiliaryText(nullptr, nullptr); }
+void MapExportLoop();
+void MapExportStop();
 
 extern std::string _screenshot_format_name;
 extern uint _num_screenshot_formats;
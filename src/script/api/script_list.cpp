@@ -10,9 +10,16 @@
 #include "../../stdafx.h"
 #include "script_list.hpp"
 #include "script_controller.hpp"
+#include "script_industry.hpp"
+#include "script_map.hpp"
+#include "script_station.hpp"
+#include "script_tile.hpp"
+#include "script_town.hpp"
 #include "../../debug.h"
 #include "../../script/squirrel.hpp"
 
+#include <utility>
+
 #include "../../safeguards.h"
 
 /**
@@ -842,6 +849,137 @@ SQInteger ScriptList::_nexti(HSQUIRRELVM vm)
 	return 1;
 }
 
+/**
+ * Valuate all items of a list by calling an API function directly.
+ * @param list The list to valuate.
+ * @param vm The VM the valuator was called from.
+ * @param func The API function, which gets the item as first parameter.
+ * @param extra The values of the remaining parameters of the function.
+ */
+template <typename Tret, typename Titem, typename... Targs, size_t... i>
+static void NativeValuateItems(ScriptList *list, HSQUIRRELVM vm, Tret (*func)(Titem, Targs...), const SQInteger *extra, std::index_sequence<i...>)
+{
+	for (ScriptList::ScriptListMap::iterator iter = list->items.begin(); iter != list->items.end(); iter++) {
+		list->SetValue(iter->first, (int64)func((Titem)iter->first, (Targs)extra[i]...));
+
+		/* Same cost as a valuator called from Squirrel. */
+		Squirrel::DecreaseOps(vm, 5);
+	}
+}
+
+/**
+ * Try to valuate a list natively with the given API function.
+ * This succeeds when the valuator at stack index 2 is the Squirrel method of \a func,
+ * and the number of remaining parameters matches and they are all integers.
+ * @param list The list to valuate.
+ * @param vm The VM the valuator was called from.
+ * @param nparam The number of parameters given to Valuate, including the valuator.
+ * @param data The data bound to the valuator, or nullptr if it is not a native function.
+ * @param func The API function to check for.
+ * @return True if the list was valuated.
+ */
+template <typename Tret, typename Titem, typename... Targs>
+static bool TryNativeValuate(ScriptList *list, HSQUIRRELVM vm, int nparam, const void *data, Tret (*func)(Titem, Targs...))
+{
+	if (data == nullptr || memcmp(data, &func, sizeof(func)) != 0) return false;
+	if (nparam - 1 != (int)sizeof...(Targs)) return false;
+
+	SQInteger extra[sizeof...(Targs) + 1];
+	for (int i = 0; i < nparam - 1; i++) {
+		if (sq_gettype(vm, i + 3) != OT_INTEGER) return false;
+		sq_getinteger(vm, i + 3, &extra[i]);
+	}
+
+	NativeValuateItems(list, vm, func, extra, std::index_sequence_for<Targs...>{});
+	return true;
+}
+
+/**
+ * Valuate a list natively when the valuator is one of the commonly used API functions.
+ * These functions only read the game state, so the result is the same as calling them through Squirrel.
+ * @param list The list to valuate.
+ * @param vm The VM the valuator was called from.
+ * @param nparam The number of parameters given to Valuate, including the valuator.
+ * @return True if the list was valuated.
+ */
+static bool NativeValuate(ScriptList *list, HSQUIRRELVM vm, int nparam)
+{
+	using ValuatorFunc = bool (*)(TileIndex);
+	const void *data = Squirrel::GetNativeClosureData(vm, 2, sizeof(ValuatorFunc));
+	if (data == nullptr) return false;
+
+	auto try_valuate = [&](auto func) -> bool {
+		static_assert(sizeof(func) == sizeof(ValuatorFunc));
+		return TryNativeValuate(list, vm, nparam, data, func);
+	};
+
+	return
+		/* Map and tile */
+		try_valuate(&ScriptMap::IsValidTile) ||
+		try_valuate(&ScriptMap::GetTileX) ||
+		try_valuate(&ScriptMap::GetTileY) ||
+		try_valuate(&ScriptMap::DistanceManhattan) ||
+		try_valuate(&ScriptMap::DistanceMax) ||
+		try_valuate(&ScriptMap::DistanceSquare) ||
+		try_valuate(&ScriptMap::DistanceFromEdge) ||
+		try_valuate(&ScriptTile::IsBuildable) ||
+		try_valuate(&ScriptTile::IsBuildableRectangle) ||
+		try_valuate(&ScriptTile::IsSeaTile) ||
+		try_valuate(&ScriptTile::IsRiverTile) ||
+		try_valuate(&ScriptTile::IsWaterTile) ||
+		try_valuate(&ScriptTile::IsCoastTile) ||
+		try_valuate(&ScriptTile::IsStationTile) ||
+		try_valuate(&ScriptTile::HasTreeOnTile) ||
+		try_valuate(&ScriptTile::IsFarmTile) ||
+		try_valuate(&ScriptTile::IsRockTile) ||
+		try_valuate(&ScriptTile::IsRoughTile) ||
+		try_valuate(&ScriptTile::IsSnowTile) ||
+		try_valuate(&ScriptTile::IsDesertTile) ||
+		try_valuate(&ScriptTile::GetTerrainType) ||
+		try_valuate(&ScriptTile::GetSlope) ||
+		try_valuate(&ScriptTile::GetMinHeight) ||
+		try_valuate(&ScriptTile::GetMaxHeight) ||
+		try_valuate(&ScriptTile::GetCornerHeight) ||
+		try_valuate(&ScriptTile::GetOwner) ||
+		try_valuate(&ScriptTile::HasTransportType) ||
+		try_valuate(&ScriptTile::GetCargoAcceptance) ||
+		try_valuate(&ScriptTile::GetCargoProduction) ||
+		try_valuate(&ScriptTile::GetDistanceManhattanToTile) ||
+		try_valuate(&ScriptTile::GetDistanceSquareToTile) ||
+		try_valuate(&ScriptTile::IsWithinTownInfluence) ||
+		try_valuate(&ScriptTile::GetTownAuthority) ||
+		try_valuate(&ScriptTile::GetClosestTown) ||
+		/* Stations */
+		try_valuate(&ScriptStation::GetLocation) ||
+		try_valuate(&ScriptStation::GetCargoWaiting) ||
+		try_valuate(&ScriptStation::GetCargoPlanned) ||
+		try_valuate(&ScriptStation::GetCargoRating) ||
+		try_valuate(&ScriptStation::GetDistanceManhattanToTile) ||
+		try_valuate(&ScriptStation::GetDistanceSquareToTile) ||
+		try_valuate(&ScriptStation::IsWithinTownInfluence) ||
+		/* Industries */
+		try_valuate(&ScriptIndustry::IsCargoAccepted) ||
+		try_valuate(&ScriptIndustry::GetLastMonthProduction) ||
+		try_valuate(&ScriptIndustry::GetLastMonthTransported) ||
+		try_valuate(&ScriptIndustry::GetLastMonthTransportedPercentage) ||
+		try_valuate(&ScriptIndustry::GetLocation) ||
+		try_valuate(&ScriptIndustry::GetAmountOfStationsAround) ||
+		try_valuate(&ScriptIndustry::GetDistanceManhattanToTile) ||
+		try_valuate(&ScriptIndustry::GetDistanceSquareToTile) ||
+		try_valuate(&ScriptIndustry::GetIndustryType) ||
+		/* Towns */
+		try_valuate(&ScriptTown::GetPopulation) ||
+		try_valuate(&ScriptTown::GetHouseCount) ||
+		try_valuate(&ScriptTown::GetLocation) ||
+		try_valuate(&ScriptTown::GetLastMonthProduction) ||
+		try_valuate(&ScriptTown::GetLastMonthSupplied) ||
+		try_valuate(&ScriptTown::GetLastMonthTransportedPercentage) ||
+		try_valuate(&ScriptTown::GetDistanceManhattanToTile) ||
+		try_valuate(&ScriptTown::GetDistanceSquareToTile) ||
+		try_valuate(&ScriptTown::IsWithinTownInfluence) ||
+		try_valuate(&ScriptTown::GetRating);
+}
+
 SQInteger ScriptList::Valuate(HSQUIRRELVM vm)
 {
 	this->modifications++;
@@ -866,6 +1004,13 @@ SQInteger ScriptList::Valuate(HSQUIRRELVM vm)
 	bool backup_allow = ScriptObject::GetAllowDoCommand();
 	ScriptObject::SetAllowDoCommand(false);
 
+	if (NativeValuate(this, vm, nparam)) {
+		ScriptObject::SetAllowDoCommand(backup_allow);
+		/* Pop the parameters given to this function and the ScriptList instance object. */
+		sq_pop(vm, nparam + 1);
+		return 0;
+	}
+
 	/* Push the function to call */
 	sq_push(vm, 2);
 
@@ -283,6 +283,10 @@ public:
 	 *    return myparam * bridge_id; // This is silly
 	 *  }
 	 *  list.Valuate(MyVal, 12);
+	 * @note Common API functions which only take integer parameters, such as
+	 *  ScriptTile.IsBuildable, ScriptMap.DistanceManhattan, ScriptStation.GetCargoRating
+	 *  or ScriptIndustry.GetLastMonthProduction, are evaluated for all items at once,
+	 *  instead of being called once per item. The result is the same.
 	 */
 	void Valuate(void *valuator_function, int params, ...);
 #endif /* DOXYGEN_API */
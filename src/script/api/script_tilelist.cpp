@@ -47,6 +47,13 @@ void ScriptTileList::RemoveTile(TileIndex tile)
 	this->RemoveItem(tile);
 }
 
+void ScriptTileList::AddTileSet(ScriptTileSet *set)
+{
+	if (set == nullptr) return;
+
+	set->AddToList(this);
+}
+
 /**
  * Helper to get list of tiles that will cover an industry's production or acceptance.
  * @param i Industry in question
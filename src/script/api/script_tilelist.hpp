@@ -12,6 +12,7 @@
 
 #include "script_station.hpp"
 #include "script_list.hpp"
+#include "script_tileset.hpp"
 
 /**
  * Creates an empty list, in which you can add tiles.
@@ -51,6 +52,14 @@ public:
 	 * @pre ScriptMap::IsValidTile(tile).
 	 */
 	void RemoveTile(TileIndex tile);
+
+	/**
+	 * Add all tiles of a tile set to the list.
+	 * @param set The set of tiles to add.
+	 * @pre set != null
+	 * @note Tiles which are already in the list keep their value, new tiles get value 0.
+	 */
+	void AddTileSet(ScriptTileSet *set);
 };
 
 /**
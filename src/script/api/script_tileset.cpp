@@ -0,0 +1,413 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file script_tileset.cpp Implementation of ScriptTileSet. */
+
+#include "../../stdafx.h"
+#include "script_tileset.hpp"
+#include "script_list.hpp"
+#include "script_rail.hpp"
+#include "script_road.hpp"
+#include "script_tile.hpp"
+#include "../../core/bitmath_func.hpp"
+#include "../../core/math_func.hpp"
+#include "../../map_func.h"
+#include "../../tile_map.h"
+
+#include "../../safeguards.h"
+
+/**
+ * Get 64 bits of a bitmap row, starting at the given bit position.
+ * Bits outside of the row are zero.
+ * @param row The row.
+ * @param words The number of words of the row.
+ * @param pos The position of the first bit, may be negative.
+ * @return The bits.
+ */
+static uint64 GetRowBits(const uint64 *row, uint words, int64 pos)
+{
+	if (pos <= -64 || pos >= (int64)words * 64) return 0;
+	if (pos < 0) return row[0] << (-pos);
+
+	const uint index = (uint)(pos / 64);
+	const uint shift = (uint)(pos % 64);
+	uint64 value = row[index] >> shift;
+	if (shift != 0 && index + 1 < words) value |= row[index + 1] << (64 - shift);
+	return value;
+}
+
+/**
+ * Set or clear a range of bits of a bitmap row.
+ * @param row The row.
+ * @param first The first bit.
+ * @param last The last bit (inclusive).
+ * @param value Whether to set or clear the bits.
+ */
+static void SetRowBits(uint64 *row, uint first, uint last, bool value)
+{
+	for (uint word = first / 64; word <= last / 64; word++) {
+		const uint lo = std::max(first, word * 64) - (word * 64);
+		const uint hi = std::min(last, (word * 64) + 63) - (word * 64);
+		const uint64 mask = (hi - lo == 63) ? UINT64_MAX : ((((uint64)1 << (hi - lo + 1)) - 1) << lo);
+		if (value) {
+			row[word] |= mask;
+		} else {
+			row[word] &= ~mask;
+		}
+	}
+}
+
+ScriptTileSet::ScriptTileSet() :
+	area_x(0),
+	area_y(0),
+	area_w(0),
+	area_h(0),
+	stride(0)
+{
+}
+
+/**
+ * Get a row of the bitmap at a different horizontal offset.
+ * @param y The map Y coordinate of the row.
+ * @param x The map X coordinate of the first bit of the output.
+ * @param words The number of words to output.
+ * @param out The output, tiles outside the area of the set are zero.
+ */
+void ScriptTileSet::GetRowAt(uint y, uint x, uint words, uint64 *out) const
+{
+	if (y < this->area_y || y >= this->area_y + this->area_h) {
+		std::fill_n(out, words, 0);
+		return;
+	}
+
+	const uint64 *row = this->Row(y - this->area_y);
+	const int64 offset = (int64)x - this->area_x;
+	for (uint word = 0; word < words; word++) {
+		out[word] = GetRowBits(row, this->stride, offset + (word * 64));
+	}
+}
+
+/**
+ * Change the area covered by the bitmap, keeping the tiles which are within the new area.
+ * @param x The X coordinate of the north corner of the new area.
+ * @param y The Y coordinate of the north corner of the new area.
+ * @param w The width of the new area.
+ * @param h The height of the new area.
+ */
+void ScriptTileSet::SetArea(uint x, uint y, uint w, uint h)
+{
+	const uint stride = CeilDiv(w, 64);
+	std::vector<uint64> bits(stride * h);
+	for (uint row = 0; row < h; row++) {
+		this->GetRowAt(y + row, x, stride, bits.data() + (row * stride));
+	}
+
+	this->area_x = x;
+	this->area_y = y;
+	this->area_w = w;
+	this->area_h = h;
+	this->stride = stride;
+	this->bits = std::move(bits);
+	this->ClearPadding();
+}
+
+/**
+ * Grow the area covered by the bitmap to include the given rectangle.
+ * @param x0 The X coordinate of the north corner of the rectangle.
+ * @param y0 The Y coordinate of the north corner of the rectangle.
+ * @param x1 The X coordinate of the south corner of the rectangle (inclusive).
+ * @param y1 The Y coordinate of the south corner of the rectangle (inclusive).
+ */
+void ScriptTileSet::IncludeArea(uint x0, uint y0, uint x1, uint y1)
+{
+	if (this->area_w == 0) {
+		this->area_x = x0;
+		this->area_y = y0;
+		this->area_w = x1 - x0 + 1;
+		this->area_h = y1 - y0 + 1;
+		this->stride = CeilDiv(this->area_w, 64);
+		this->bits.assign(this->stride * this->area_h, 0);
+		return;
+	}
+
+	const uint nx0 = std::min(x0, this->area_x);
+	const uint ny0 = std::min(y0, this->area_y);
+	const uint nx1 = std::max(x1, this->area_x + this->area_w - 1);
+	const uint ny1 = std::max(y1, this->area_y + this->area_h - 1);
+	if (nx0 == this->area_x && ny0 == this->area_y && nx1 - nx0 + 1 == this->area_w && ny1 - ny0 + 1 == this->area_h) return;
+
+	this->SetArea(nx0, ny0, nx1 - nx0 + 1, ny1 - ny0 + 1);
+}
+
+/**
+ * Clear the bits of each row beyond the width of the area.
+ */
+void ScriptTileSet::ClearPadding()
+{
+	const uint used = this->area_w % 64;
+	if (used == 0) return;
+
+	const uint64 mask = ((uint64)1 << used) - 1;
+	for (uint row = 0; row < this->area_h; row++) {
+		this->Row(row)[this->stride - 1] &= mask;
+	}
+}
+
+/**
+ * Add or remove the tiles of a rectangle.
+ * @param tile_from One corner of the rectangle.
+ * @param tile_to The other corner of the rectangle.
+ * @param value Whether to add or remove the tiles.
+ */
+void ScriptTileSet::SetRectangle(TileIndex tile_from, TileIndex tile_to, bool value)
+{
+	if (!::IsValidTile(tile_from) || !::IsValidTile(tile_to)) return;
+
+	uint x0 = std::min(TileX(tile_from), TileX(tile_to));
+	uint y0 = std::min(TileY(tile_from), TileY(tile_to));
+	uint x1 = std::max(TileX(tile_from), TileX(tile_to));
+	uint y1 = std::max(TileY(tile_from), TileY(tile_to));
+
+	if (value) {
+		this->IncludeArea(x0, y0, x1, y1);
+	} else {
+		if (this->area_w == 0) return;
+		x0 = std::max(x0, this->area_x);
+		y0 = std::max(y0, this->area_y);
+		x1 = std::min(x1, this->area_x + this->area_w - 1);
+		y1 = std::min(y1, this->area_y + this->area_h - 1);
+		if (x0 > x1 || y0 > y1) return;
+	}
+
+	for (uint y = y0; y <= y1; y++) {
+		SetRowBits(this->Row(y - this->area_y), x0 - this->area_x, x1 - this->area_x, value);
+	}
+}
+
+void ScriptTileSet::AddRectangle(TileIndex tile_from, TileIndex tile_to)
+{
+	this->SetRectangle(tile_from, tile_to, true);
+}
+
+void ScriptTileSet::AddTile(TileIndex tile)
+{
+	this->SetRectangle(tile, tile, true);
+}
+
+void ScriptTileSet::RemoveRectangle(TileIndex tile_from, TileIndex tile_to)
+{
+	this->SetRectangle(tile_from, tile_to, false);
+}
+
+void ScriptTileSet::RemoveTile(TileIndex tile)
+{
+	this->SetRectangle(tile, tile, false);
+}
+
+bool ScriptTileSet::HasTile(TileIndex tile)
+{
+	if (!::IsValidTile(tile)) return false;
+
+	const uint x = TileX(tile);
+	const uint y = TileY(tile);
+	if (x < this->area_x || x >= this->area_x + this->area_w || y < this->area_y || y >= this->area_y + this->area_h) return false;
+
+	const uint bit = x - this->area_x;
+	return HasBit(this->Row(y - this->area_y)[bit / 64], bit % 64);
+}
+
+int32 ScriptTileSet::Count()
+{
+	uint count = 0;
+	for (uint64 word : this->bits) {
+		count += CountBits(word);
+	}
+	return count;
+}
+
+bool ScriptTileSet::IsEmpty()
+{
+	for (uint64 word : this->bits) {
+		if (word != 0) return false;
+	}
+	return true;
+}
+
+void ScriptTileSet::Clear()
+{
+	this->area_x = 0;
+	this->area_y = 0;
+	this->area_w = 0;
+	this->area_h = 0;
+	this->stride = 0;
+	this->bits.clear();
+}
+
+void ScriptTileSet::AddSet(ScriptTileSet *set)
+{
+	if (set == nullptr || set == this || set->area_w == 0) return;
+
+	this->IncludeArea(set->area_x, set->area_y, set->area_x + set->area_w - 1, set->area_y + set->area_h - 1);
+
+	std::vector<uint64> other(this->stride);
+	for (uint y = set->area_y; y < set->area_y + set->area_h; y++) {
+		set->GetRowAt(y, this->area_x, this->stride, other.data());
+		uint64 *row = this->Row(y - this->area_y);
+		for (uint word = 0; word < this->stride; word++) {
+			row[word] |= other[word];
+		}
+	}
+}
+
+void ScriptTileSet::RemoveSet(ScriptTileSet *set)
+{
+	if (set == nullptr) return;
+	if (set == this) {
+		this->Clear();
+		return;
+	}
+
+	std::vector<uint64> other(this->stride);
+	for (uint row = 0; row < this->area_h; row++) {
+		set->GetRowAt(this->area_y + row, this->area_x, this->stride, other.data());
+		uint64 *bits = this->Row(row);
+		for (uint word = 0; word < this->stride; word++) {
+			bits[word] &= ~other[word];
+		}
+	}
+}
+
+void ScriptTileSet::KeepSet(ScriptTileSet *set)
+{
+	if (set == nullptr || set == this) return;
+
+	std::vector<uint64> other(this->stride);
+	for (uint row = 0; row < this->area_h; row++) {
+		set->GetRowAt(this->area_y + row, this->area_x, this->stride, other.data());
+		uint64 *bits = this->Row(row);
+		for (uint word = 0; word < this->stride; word++) {
+			bits[word] &= other[word];
+		}
+	}
+}
+
+void ScriptTileSet::Dilate(int32 radius)
+{
+	if (radius <= 0 || this->area_w == 0) return;
+
+	const uint r = (uint)std::min<int32>(radius, std::max(MapSizeX(), MapSizeY()));
+	const uint x0 = this->area_x - std::min(this->area_x, r);
+	const uint y0 = this->area_y - std::min(this->area_y, r);
+	const uint x1 = std::min(this->area_x + this->area_w - 1 + r, MapMaxX());
+	const uint y1 = std::min(this->area_y + this->area_h - 1 + r, MapMaxY());
+	this->SetArea(x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+
+	/* Each pass ORs the bitmap with itself shifted both ways by step.
+	 * With the steps 1, 2, 4, ... the passes together cover every distance up to the radius. */
+	std::vector<uint64> tmp(this->stride);
+	for (uint done = 0; done < r;) {
+		const uint step = std::min(done + 1, r - done);
+		for (uint row = 0; row < this->area_h; row++) {
+			uint64 *bits = this->Row(row);
+			std::copy_n(bits, this->stride, tmp.data());
+			for (uint word = 0; word < this->stride; word++) {
+				const int64 pos = (int64)word * 64;
+				bits[word] |= GetRowBits(tmp.data(), this->stride, pos - step) | GetRowBits(tmp.data(), this->stride, pos + step);
+			}
+		}
+		done += step;
+	}
+	this->ClearPadding();
+
+	std::vector<uint64> prev;
+	for (uint done = 0; done < r;) {
+		const uint step = std::min(done + 1, r - done);
+		prev = this->bits;
+		for (uint row = 0; row < this->area_h; row++) {
+			uint64 *bits = this->Row(row);
+			if (row >= step) {
+				const uint64 *above = prev.data() + ((row - step) * this->stride);
+				for (uint word = 0; word < this->stride; word++) bits[word] |= above[word];
+			}
+			if (row + step < this->area_h) {
+				const uint64 *below = prev.data() + ((row + step) * this->stride);
+				for (uint word = 0; word < this->stride; word++) bits[word] |= below[word];
+			}
+		}
+		done += step;
+	}
+}
+
+/**
+ * Keep or remove the tiles which match a filter.
+ * @param filter The filter.
+ * @param keep True to keep the matching tiles, false to remove them.
+ */
+void ScriptTileSet::Filter(TileFilter filter, bool keep)
+{
+	bool (*proc)(TileIndex);
+	switch (filter) {
+		case TF_BUILDABLE: proc = &ScriptTile::IsBuildable; break;
+		case TF_FLAT:      proc = [](TileIndex tile) { return ::GetTileSlope(tile) == SLOPE_FLAT; }; break;
+		case TF_WATER:     proc = &ScriptTile::IsWaterTile; break;
+		case TF_SEA:       proc = &ScriptTile::IsSeaTile; break;
+		case TF_RIVER:     proc = &ScriptTile::IsRiverTile; break;
+		case TF_COAST:     proc = &ScriptTile::IsCoastTile; break;
+		case TF_STATION:   proc = &ScriptTile::IsStationTile; break;
+		case TF_ROAD:      proc = &ScriptRoad::IsRoadTile; break;
+		case TF_RAIL:      proc = &ScriptRail::IsRailTile; break;
+		case TF_TREES:     proc = &ScriptTile::HasTreeOnTile; break;
+		case TF_FARM:      proc = &ScriptTile::IsFarmTile; break;
+		case TF_ROCK:      proc = &ScriptTile::IsRockTile; break;
+		case TF_ROUGH:     proc = &ScriptTile::IsRoughTile; break;
+		case TF_SNOW:      proc = &ScriptTile::IsSnowTile; break;
+		case TF_DESERT:    proc = &ScriptTile::IsDesertTile; break;
+		default: return;
+	}
+
+	for (uint row = 0; row < this->area_h; row++) {
+		uint64 *bits = this->Row(row);
+		for (uint word = 0; word < this->stride; word++) {
+			uint64 value = bits[word];
+			while (value != 0) {
+				const uint bit = FindFirstBit(value);
+				value &= value - 1;
+				const TileIndex tile = TileXY(this->area_x + (word * 64) + bit, this->area_y + row);
+				if (proc(tile) != keep) ClrBit(bits[word], bit);
+			}
+		}
+	}
+}
+
+void ScriptTileSet::KeepFilter(TileFilter filter)
+{
+	this->Filter(filter, true);
+}
+
+void ScriptTileSet::RemoveFilter(TileFilter filter)
+{
+	this->Filter(filter, false);
+}
+
+/**
+ * Add all tiles of the set to a list, with value 0.
+ * @param list The list to add the tiles to.
+ */
+void ScriptTileSet::AddToList(ScriptList *list) const
+{
+	for (uint row = 0; row < this->area_h; row++) {
+		const uint64 *bits = this->Row(row);
+		for (uint word = 0; word < this->stride; word++) {
+			uint64 value = bits[word];
+			while (value != 0) {
+				const uint bit = FindFirstBit(value);
+				value &= value - 1;
+				list->AddItem(TileXY(this->area_x + (word * 64) + bit, this->area_y + row));
+			}
+		}
+	}
+}
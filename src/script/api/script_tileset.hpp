@@ -0,0 +1,167 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file script_tileset.hpp A set of tiles, stored as a bitmap. */
+
+#ifndef SCRIPT_TILESET_HPP
+#define SCRIPT_TILESET_HPP
+
+#include "script_object.hpp"
+#include <vector>
+
+/**
+ * Creates an empty set of tiles, which is stored as a bitmap over the area containing the tiles.
+ * Large areas of tiles can be built, combined and filtered much faster and with much less memory than with a ScriptTileList.
+ * Use ScriptTileList::AddTileSet to get a list of the tiles for valuating and sorting.
+ * @api ai game
+ */
+class ScriptTileSet : public ScriptObject {
+public:
+	/**
+	 * Conditions to filter the tiles of a set by.
+	 */
+	enum TileFilter {
+		TF_BUILDABLE, ///< The tile is buildable, see ScriptTile::IsBuildable.
+		TF_FLAT,      ///< The tile has a flat slope.
+		TF_WATER,     ///< The tile is a water tile, see ScriptTile::IsWaterTile.
+		TF_SEA,       ///< The tile is a sea tile, see ScriptTile::IsSeaTile.
+		TF_RIVER,     ///< The tile is a river tile, see ScriptTile::IsRiverTile.
+		TF_COAST,     ///< The tile is a coast tile, see ScriptTile::IsCoastTile.
+		TF_STATION,   ///< The tile is a station tile, see ScriptTile::IsStationTile.
+		TF_ROAD,      ///< The tile is a road tile, see ScriptRoad::IsRoadTile.
+		TF_RAIL,      ///< The tile is a rail tile, see ScriptRail::IsRailTile.
+		TF_TREES,     ///< The tile has trees, see ScriptTile::HasTreeOnTile.
+		TF_FARM,      ///< The tile is a farm tile, see ScriptTile::IsFarmTile.
+		TF_ROCK,      ///< The tile is a rock tile, see ScriptTile::IsRockTile.
+		TF_ROUGH,     ///< The tile is a rough tile, see ScriptTile::IsRoughTile.
+		TF_SNOW,      ///< The tile is a snow tile, see ScriptTile::IsSnowTile.
+		TF_DESERT,    ///< The tile is a desert tile, see ScriptTile::IsDesertTile.
+	};
+
+	ScriptTileSet();
+
+	/**
+	 * Add the rectangle between tile_from and tile_to to the set.
+	 * @param tile_from One corner of the tiles to add.
+	 * @param tile_to The other corner of the tiles to add.
+	 * @pre ScriptMap::IsValidTile(tile_from).
+	 * @pre ScriptMap::IsValidTile(tile_to).
+	 */
+	void AddRectangle(TileIndex tile_from, TileIndex tile_to);
+
+	/**
+	 * Add a tile to the set.
+	 * @param tile The tile to add.
+	 * @pre ScriptMap::IsValidTile(tile).
+	 */
+	void AddTile(TileIndex tile);
+
+	/**
+	 * Remove the tiles inside the rectangle between tile_from and tile_to from the set.
+	 * @param tile_from One corner of the tiles to remove.
+	 * @param tile_to The other corner of the tiles to remove.
+	 * @pre ScriptMap::IsValidTile(tile_from).
+	 * @pre ScriptMap::IsValidTile(tile_to).
+	 */
+	void RemoveRectangle(TileIndex tile_from, TileIndex tile_to);
+
+	/**
+	 * Remove a tile from the set.
+	 * @param tile The tile to remove.
+	 * @pre ScriptMap::IsValidTile(tile).
+	 */
+	void RemoveTile(TileIndex tile);
+
+	/**
+	 * Check if a tile is in the set.
+	 * @param tile The tile to check.
+	 * @return True if the tile is in the set.
+	 */
+	bool HasTile(TileIndex tile);
+
+	/**
+	 * Get the number of tiles in the set.
+	 * @return The number of tiles.
+	 */
+	int32 Count();
+
+	/**
+	 * Check if the set is empty.
+	 * @return True if the set contains no tiles.
+	 */
+	bool IsEmpty();
+
+	/**
+	 * Remove all tiles from the set.
+	 */
+	void Clear();
+
+	/**
+	 * Add all tiles of another set to this set (union).
+	 * @param set The set of tiles to add.
+	 * @pre set != null
+	 * @post The set to be added ('set') stays unmodified.
+	 */
+	void AddSet(ScriptTileSet *set);
+
+	/**
+	 * Remove all tiles of another set from this set (difference).
+	 * @param set The set of tiles to remove.
+	 * @pre set != null
+	 */
+	void RemoveSet(ScriptTileSet *set);
+
+	/**
+	 * Keep only the tiles which are also in another set (intersection).
+	 * @param set The set of tiles to keep.
+	 * @pre set != null
+	 */
+	void KeepSet(ScriptTileSet *set);
+
+	/**
+	 * Add all tiles within the given distance of a tile of the set, using the distance of ScriptMap::DistanceMax.
+	 * Tiles outside of the map are not added.
+	 * @param radius The distance in tiles.
+	 * @pre radius >= 0.
+	 */
+	void Dilate(int32 radius);
+
+	/**
+	 * Keep only the tiles which match the given filter.
+	 * @param filter The condition the tiles must match.
+	 */
+	void KeepFilter(TileFilter filter);
+
+	/**
+	 * Remove the tiles which match the given filter.
+	 * @param filter The condition of the tiles to remove.
+	 */
+	void RemoveFilter(TileFilter filter);
+
+private:
+	friend class ScriptTileList;
+
+	uint area_x;              ///< X coordinate of the north corner of the area covered by the bitmap.
+	uint area_y;              ///< Y coordinate of the north corner of the area covered by the bitmap.
+	uint area_w;              ///< Width of the area covered by the bitmap, 0 if empty.
+	uint area_h;              ///< Height of the area covered by the bitmap, 0 if empty.
+	uint stride;              ///< Number of words per row of the bitmap.
+	std::vector<uint64> bits; ///< Bitmap of the tiles, row by row, bit x of a row is the tile at #area_x + x.
+
+	uint64 *Row(uint row) { return this->bits.data() + (row * this->stride); }
+	const uint64 *Row(uint row) const { return this->bits.data() + (row * this->stride); }
+
+	void GetRowAt(uint y, uint x, uint words, uint64 *out) const;
+	void SetArea(uint x, uint y, uint w, uint h);
+	void IncludeArea(uint x0, uint y0, uint x1, uint y1);
+	void SetRectangle(TileIndex tile_from, TileIndex tile_to, bool value);
+	void ClearPadding();
+	void Filter(TileFilter filter, bool keep);
+	void AddToList(class ScriptList *list) const;
+};
+
+#endif /* SCRIPT_TILESET_HPP */
@@ -15,6 +15,7 @@
 #include "../../depot_map.h"
 #include "../../vehicle_base.h"
 #include "../../train.h"
+#include "../../vehiclelist_func.h"
 
 #include "../../safeguards.h"
 
@@ -29,16 +30,17 @@ ScriptVehicleList_Station::ScriptVehicleList_Station(StationID station_id)
 {
 	if (!ScriptBaseStation::IsValidBaseStation(station_id)) return;
 
-	for (const Vehicle *v : Vehicle::Iterate()) {
-		if ((v->owner == ScriptObject::GetCompany() || ScriptObject::GetCompany() == OWNER_DEITY) && v->IsPrimaryVehicle()) {
-			for (const Order *order : v->Orders()) {
-				if ((order->IsType(OT_GOTO_STATION) || order->IsType(OT_GOTO_WAYPOINT)) && order->GetDestination() == station_id) {
-					this->AddItem(v->index);
-					break;
-				}
-			}
+	FindVehiclesWithOrder(
+		[](const Vehicle *v) -> bool {
+			return (v->owner == ScriptObject::GetCompany() || ScriptObject::GetCompany() == OWNER_DEITY) && v->IsPrimaryVehicle();
+		},
+		[&](const Order *order) -> bool {
+			return (order->IsType(OT_GOTO_STATION) || order->IsType(OT_GOTO_WAYPOINT)) && order->GetDestination() == station_id;
+		},
+		[this](const Vehicle *v) {
+			this->AddItem(v->index);
 		}
-	}
+	);
 }
 
 ScriptVehicleList_Depot::ScriptVehicleList_Depot(TileIndex tile)
@@ -77,16 +79,17 @@ ScriptVehicleList_Depot::ScriptVehicleList_Depot(TileIndex tile)
 			return;
 	}
 
-	for (const Vehicle *v : Vehicle::Iterate()) {
-		if ((v->owner == ScriptObject::GetCompany() || ScriptObject::GetCompany() == OWNER_DEITY) && v->IsPrimaryVehicle() && v->type == type) {
-			for (const Order *order : v->Orders()) {
-				if (order->IsType(OT_GOTO_DEPOT) && order->GetDestination() == dest) {
-					this->AddItem(v->index);
-					break;
-				}
-			}
+	FindVehiclesWithOrder(
+		[type](const Vehicle *v) -> bool {
+			return (v->owner == ScriptObject::GetCompany() || ScriptObject::GetCompany() == OWNER_DEITY) && v->IsPrimaryVehicle() && v->type == type;
+		},
+		[dest](const Order *order) -> bool {
+			return order->IsType(OT_GOTO_DEPOT) && order->GetDestination() == dest;
+		},
+		[this](const Vehicle *v) {
+			this->AddItem(v->index);
 		}
-	}
+	);
 }
 
 ScriptVehicleList_SharedOrders::ScriptVehicleList_SharedOrders(VehicleID vehicle_id)
@@ -62,7 +62,7 @@ bool ScriptInfo::CheckMethod(const char *name) const
 	sq_addref(vm, info->SQ_instance);
 
 	info->scanner = (ScriptScanner *)Squirrel::GetGlobalPointer(vm);
-	info->engine = info->scanner->GetEngine();
+	info->engine = Squirrel::Get(vm);
 
 	/* Ensure the mandatory functions exist */
 	static const char * const required_functions[] = {
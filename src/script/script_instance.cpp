@@ -762,6 +762,33 @@ void ScriptInstance::SetMemoryAllocationLimit(size_t limit) const
 	if (this->engine != nullptr) this->engine->SetMemoryAllocationLimit(limit);
 }
 
+bool ScriptInstance::StartProfiling()
+{
+	if (this->engine == nullptr || this->is_dead) return false;
+	this->engine->StartProfiling();
+	return true;
+}
+
+void ScriptInstance::StopProfiling()
+{
+	if (this->engine != nullptr) this->engine->StopProfiling();
+}
+
+bool ScriptInstance::IsProfiling() const
+{
+	return this->engine != nullptr && this->engine->IsProfiling();
+}
+
+void ScriptInstance::PrintProfile(uint count)
+{
+	this->engine->PrintProfile(count);
+}
+
+bool ScriptInstance::WriteProfile(const char *filename)
+{
+	return this->engine->WriteProfile(filename);
+}
+
 void ScriptInstance::ReleaseSQObject(HSQOBJECT *obj)
 {
 	if (!this->in_shutdown) this->engine->ReleaseObject(obj);
@@ -205,6 +205,37 @@ public:
 
 	void SetMemoryAllocationLimit(size_t limit) const;
 
+	/**
+	 * Start collecting per function statistics of the script, discarding any previously collected ones.
+	 * @return False if the script is not running.
+	 */
+	bool StartProfiling();
+
+	/**
+	 * Stop collecting per function statistics of the script and discard them.
+	 */
+	void StopProfiling();
+
+	/**
+	 * Are per function statistics of the script being collected?
+	 */
+	bool IsProfiling() const;
+
+	/**
+	 * Print the most expensive functions of the script to the console.
+	 * @param count The maximum number of functions to print.
+	 * @pre IsProfiling()
+	 */
+	void PrintProfile(uint count);
+
+	/**
+	 * Write the statistics of all functions of the script to a CSV file.
+	 * @param filename The name of the file.
+	 * @return True when the file was written.
+	 * @pre IsProfiling()
+	 */
+	bool WriteProfile(const char *filename);
+
 	/**
 	 * Indicate whether this instance is currently being destroyed.
 	 */
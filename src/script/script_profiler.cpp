@@ -0,0 +1,210 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file script_profiler.cpp Implementation of ScriptProfiler. */
+
+#include "../stdafx.h"
+#include "../string_func.h"
+#include "../console_func.h"
+#include "../fileio_func.h"
+#include "script_profiler.hpp"
+#include <../squirrel/sqstring.h>
+#include <../squirrel/sqfuncproto.h>
+#include <../squirrel/sqclosure.h>
+
+#include <algorithm>
+
+#include "../safeguards.h"
+
+/** Get the difference between two time points in nanoseconds. */
+static inline uint64 ElapsedNanoseconds(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+{
+	return (uint64)std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
+}
+
+/**
+ * Get the statistics entry of a script function, creating it when needed.
+ * @param func The function.
+ * @return The entry.
+ */
+ScriptProfiler::Entry &ScriptProfiler::GetFunctionEntry(SQFunctionProto *func)
+{
+	auto result = this->entries.try_emplace(func);
+	Entry &entry = result.first->second;
+	if (result.second) {
+		const char *name = type(func->_name) == OT_STRING ? _stringval(func->_name) : "unnamed";
+		const char *source = type(func->_sourcename) == OT_STRING ? _stringval(func->_sourcename) : "unknown";
+		int line = func->_nlineinfos > 0 ? (int)func->_lineinfos[0]._line : 0;
+		entry.name = stdstr_fmt("%s (%s:%d)", name, source, line);
+	}
+	return entry;
+}
+
+/**
+ * Attribute the time since the last switch to the currently timed entry, and start timing another entry.
+ * @param entry The entry to time from now on, or nullptr.
+ * @param now The current time.
+ */
+void ScriptProfiler::SetTimed(Entry *entry, TimePoint now)
+{
+	if (this->depth > 0 && this->timed != nullptr) this->timed->self_time += ElapsedNanoseconds(this->last_time, now);
+	this->timed = entry;
+	this->last_time = now;
+}
+
+void ScriptProfiler::SwitchFunction(SQFunctionProto *func)
+{
+	Entry &entry = this->GetFunctionEntry(func);
+	this->_current = func;
+	this->_current_ops = &entry.ops;
+	this->SetTimed(&entry, std::chrono::steady_clock::now());
+}
+
+void ScriptProfiler::OnCall(SQFunctionProto *func)
+{
+	this->GetFunctionEntry(func).calls++;
+}
+
+void ScriptProfiler::OnNativeEnter(SQNativeClosure *closure)
+{
+	auto result = this->entries.try_emplace(closure);
+	Entry &entry = result.first->second;
+	if (result.second) {
+		entry.name = type(closure->_name) == OT_STRING ? _stringval(closure->_name) : "unnamed";
+		entry.is_native = true;
+	}
+	entry.calls++;
+
+	TimePoint now = std::chrono::steady_clock::now();
+	this->native_stack.push_back({ &entry, now, this->timed });
+	this->SetTimed(&entry, now);
+	/* Script functions called back by the API method have to switch the timed entry again. */
+	this->_current = nullptr;
+}
+
+void ScriptProfiler::OnNativeLeave(SQNativeClosure *closure)
+{
+	if (this->native_stack.empty()) return;
+
+	NativeFrame frame = this->native_stack.back();
+	this->native_stack.pop_back();
+
+	TimePoint now = std::chrono::steady_clock::now();
+	frame.entry->total_time += ElapsedNanoseconds(frame.start, now);
+	this->SetTimed(frame.caller, now);
+	this->_current = nullptr;
+}
+
+/**
+ * Mark the start of running the VM; time is only accounted while it runs.
+ */
+void ScriptProfiler::Begin()
+{
+	if (this->depth++ > 0) return;
+
+	this->begin_time = this->last_time = std::chrono::steady_clock::now();
+	this->timed = nullptr;
+	this->_current = nullptr;
+}
+
+/**
+ * Mark the end of running the VM.
+ */
+void ScriptProfiler::End()
+{
+	if (--this->depth > 0) return;
+
+	TimePoint now = std::chrono::steady_clock::now();
+	if (this->timed != nullptr) this->timed->self_time += ElapsedNanoseconds(this->last_time, now);
+	this->timed = nullptr;
+	this->run_time += ElapsedNanoseconds(this->begin_time, now);
+	this->native_stack.clear();
+	this->_current = nullptr;
+}
+
+/**
+ * Name the API methods by their class and method name, instead of just the method name.
+ * @param vm The VM the API is registered in.
+ */
+void ScriptProfiler::ResolveNativeNames(HSQUIRRELVM vm)
+{
+	SQInteger top = sq_gettop(vm);
+	sq_pushroottable(vm);
+	sq_pushnull(vm);
+	while (SQ_SUCCEEDED(sq_next(vm, -2))) {
+		const SQChar *class_name;
+		if (sq_gettype(vm, -1) == OT_CLASS && SQ_SUCCEEDED(sq_getstring(vm, -2, &class_name))) {
+			sq_pushnull(vm);
+			while (SQ_SUCCEEDED(sq_next(vm, -2))) {
+				HSQOBJECT method;
+				const SQChar *method_name;
+				sq_getstackobj(vm, -1, &method);
+				if (method._type == OT_NATIVECLOSURE && SQ_SUCCEEDED(sq_getstring(vm, -2, &method_name))) {
+					auto it = this->entries.find(method._unVal.pNativeClosure);
+					if (it != this->entries.end()) it->second.name = stdstr_fmt("%s.%s", class_name, method_name);
+				}
+				sq_pop(vm, 2);
+			}
+			sq_pop(vm, 1);
+		}
+		sq_pop(vm, 2);
+	}
+	sq_settop(vm, top);
+}
+
+/**
+ * Get all entries, most expensive first.
+ * @return The entries, sorted by decreasing self time.
+ */
+std::vector<const ScriptProfiler::Entry *> ScriptProfiler::GetSortedEntries() const
+{
+	std::vector<const Entry *> result;
+	result.reserve(this->entries.size());
+	for (const auto &it : this->entries) result.push_back(&it.second);
+	std::sort(result.begin(), result.end(), [](const Entry *a, const Entry *b) {
+		if (a->self_time != b->self_time) return a->self_time > b->self_time;
+		return a->ops > b->ops;
+	});
+	return result;
+}
+
+/**
+ * Print the most expensive entries to the console.
+ * @param count The maximum number of entries to print.
+ */
+void ScriptProfiler::PrintReport(uint count) const
+{
+	IConsolePrintF(CC_INFO, "Profiled run time: %.3f ms", this->run_time / 1000000.0);
+	IConsolePrint(CC_INFO, "    Self ms   Total ms       Opcodes     Calls  Function");
+	for (const Entry *entry : this->GetSortedEntries()) {
+		if (count-- == 0) break;
+		std::string ops = entry->is_native ? std::string() : std::to_string(entry->ops);
+		std::string total = entry->is_native ? stdstr_fmt("%.3f", entry->total_time / 1000000.0) : std::string();
+		IConsolePrintF(CC_DEFAULT, "%11.3f %10s %13s %9s  %s", entry->self_time / 1000000.0, total.c_str(), ops.c_str(), std::to_string(entry->calls).c_str(), entry->name.c_str());
+	}
+}
+
+/**
+ * Write all entries to a CSV file.
+ * @param filename The name of the file.
+ * @return True when the file was written.
+ */
+bool ScriptProfiler::WriteReport(const char *filename) const
+{
+	FILE *f = FioFOpenFile(filename, "wt", Subdirectory::NO_DIRECTORY);
+	if (f == nullptr) return false;
+	FileCloser fcloser(f);
+
+	fputs("Kind,Name,Calls,Opcodes,SelfMicroseconds,TotalMicroseconds\n", f);
+	for (const Entry *entry : this->GetSortedEntries()) {
+		std::string name = entry->name;
+		for (size_t pos = name.find('"'); pos != std::string::npos; pos = name.find('"', pos + 2)) name.insert(pos, 1, '"');
+		fprintf(f, "%s,\"%s\"," OTTD_PRINTF64U "," OTTD_PRINTF64U "," OTTD_PRINTF64U "," OTTD_PRINTF64U "\n", entry->is_native ? "api" : "script", name.c_str(),
+				entry->calls, (uint64)entry->ops, entry->self_time / 1000, entry->total_time / 1000);
+	}
+	return true;
+}
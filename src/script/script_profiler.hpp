@@ -0,0 +1,93 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file script_profiler.hpp Collection of per function statistics of a running script. */
+
+#ifndef SCRIPT_PROFILER_HPP
+#define SCRIPT_PROFILER_HPP
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <squirrel.h>
+#include <../squirrel/sqpcheader.h>
+#include <../squirrel/sqvm.h>
+
+/**
+ * Profiler of a squirrel VM, hooked into the instruction loop and native calls of the VM.
+ * Opcodes and self time are attributed to the script function being executed; the time spent
+ * in API calls is excluded from that and attributed to the API method instead.
+ */
+class ScriptProfiler : public SQProfiler {
+public:
+	/** Statistics of a single script function or API method. */
+	struct Entry {
+		std::string name;          ///< Name of the function, and where it was defined for script functions.
+		bool is_native = false;    ///< Whether this is an API method.
+		uint64 calls = 0;          ///< Number of calls.
+		SQUnsignedInteger ops = 0; ///< Number of opcodes executed.
+		uint64 self_time = 0;      ///< Time spent in the function itself, in nanoseconds.
+		uint64 total_time = 0;     ///< Time spent in the API method including any script callbacks, in nanoseconds; 0 for script functions.
+	};
+
+	void SwitchFunction(SQFunctionProto *func) override;
+	void OnCall(SQFunctionProto *func) override;
+	void OnNativeEnter(SQNativeClosure *closure) override;
+	void OnNativeLeave(SQNativeClosure *closure) override;
+
+	void Begin();
+	void End();
+
+	void ResolveNativeNames(HSQUIRRELVM vm);
+	std::vector<const Entry *> GetSortedEntries() const;
+	void PrintReport(uint count) const;
+	bool WriteReport(const char *filename) const;
+
+	/** Get the time the VM has run while profiling, in nanoseconds. */
+	uint64 GetRunTime() const { return this->run_time; }
+
+private:
+	typedef std::chrono::steady_clock::time_point TimePoint;
+
+	/** API method being executed. */
+	struct NativeFrame {
+		Entry *entry;     ///< Entry of the API method.
+		TimePoint start;  ///< Time the API method was entered.
+		Entry *caller;    ///< Entry which was being timed when the API method was entered.
+	};
+
+	std::unordered_map<const void *, Entry> entries; ///< Statistics, by function prototype or native closure.
+	std::vector<NativeFrame> native_stack; ///< API methods being executed.
+	Entry *timed = nullptr;  ///< Entry the time is currently attributed to, or nullptr.
+	TimePoint last_time;     ///< Time of the last switch of the timed entry.
+	uint depth = 0;          ///< Nesting depth of #Begin calls.
+	uint64 run_time = 0;     ///< Total time the VM ran while profiling, in nanoseconds.
+	TimePoint begin_time;    ///< Time of the outermost #Begin call.
+
+	Entry &GetFunctionEntry(SQFunctionProto *func);
+	void SetTimed(Entry *entry, TimePoint now);
+};
+
+/** Marks a run of the squirrel VM, for a possibly absent profiler. */
+class ScriptProfilerScope {
+	ScriptProfiler *profiler;
+
+public:
+	ScriptProfilerScope(ScriptProfiler *profiler) : profiler(profiler)
+	{
+		if (this->profiler != nullptr) this->profiler->Begin();
+	}
+
+	~ScriptProfilerScope()
+	{
+		if (this->profiler != nullptr) this->profiler->End();
+	}
+};
+
+#endif /* SCRIPT_PROFILER_HPP */
@@ -20,49 +20,76 @@
 #include "../network/network_content.h"
 #include "../3rdparty/md5/md5.h"
 #include "../tar_type.h"
+#include "../worker_thread.h"
 
 #include "../safeguards.h"
 
+/* static */ thread_local ScriptScanner::ScanJob *ScriptScanner::current_job = nullptr;
+
 bool ScriptScanner::AddFile(const std::string &filename, size_t basepath_length, const std::string &tar_filename)
 {
-	this->main_script = filename;
-	this->tar_file = tar_filename;
+	std::string main_script = filename;
 
-	auto p = this->main_script.rfind(PATHSEPCHAR);
-	this->main_script.erase(p != std::string::npos ? p + 1 : 0);
-	this->main_script += "main.nut";
+	auto p = main_script.rfind(PATHSEPCHAR);
+	main_script.erase(p != std::string::npos ? p + 1 : 0);
+	main_script += "main.nut";
 
-	if (!FioCheckFileExists(filename, this->subdir) || !FioCheckFileExists(this->main_script, this->subdir)) return false;
+	if (!FioCheckFileExists(filename, this->subdir) || !FioCheckFileExists(main_script, this->subdir)) return false;
 
-	this->ResetEngine();
-	try {
-		this->engine->LoadScript(filename.c_str());
-	} catch (Script_FatalError &e) {
-		DEBUG(script, 0, "Fatal error '%s' when trying to load the script '%s'.", e.GetErrorMessage().c_str(), filename.c_str());
-		return false;
-	}
+	/* The info file is run later on, together with those of the other scripts found. */
+	this->scan_jobs.push_back({ filename, std::move(main_script), tar_filename, {} });
 	return true;
 }
 
+/**
+ * Run the info files of the scripts found by the scan.
+ * The info files are run on the worker threads, each with its own engine, and
+ * the scripts are registered afterwards in the order they were found by the scan.
+ */
+void ScriptScanner::RunScanJobs()
+{
+	_general_worker_pool.ParallelFor(this->scan_jobs.size(), 1, [&](size_t begin, size_t end) {
+		Squirrel engine(this->engine_name);
+		for (size_t i = begin; i < end; i++) {
+			ScanJob &job = this->scan_jobs[i];
+			current_job = &job;
+			this->ResetEngine(&engine);
+			try {
+				engine.LoadScript(job.filename.c_str());
+			} catch (Script_FatalError &e) {
+				DEBUG(script, 0, "Fatal error '%s' when trying to load the script '%s'.", e.GetErrorMessage().c_str(), job.filename.c_str());
+			}
+			current_job = nullptr;
+		}
+	});
+
+	for (const ScanJob &job : this->scan_jobs) {
+		for (ScriptInfo *info : job.infos) this->RegisterScript(info);
+	}
+	this->scan_jobs.clear();
+}
+
 ScriptScanner::ScriptScanner() :
+	engine_name(nullptr),
 	engine(nullptr)
 {
 }
 
-void ScriptScanner::ResetEngine()
+void ScriptScanner::ResetEngine(Squirrel *engine)
 {
-	this->engine->Reset();
-	this->engine->SetGlobalPointer(this);
-	this->RegisterAPI(this->engine);
+	engine->Reset();
+	engine->SetGlobalPointer(this);
+	this->RegisterAPI(engine);
 }
 
 void ScriptScanner::Initialize(const char *name)
 {
+	this->engine_name = name;
 	this->engine = new Squirrel(name);
 
 	this->RescanDir();
 
-	this->ResetEngine();
+	this->ResetEngine(this->engine);
 }
 
 ScriptScanner::~ScriptScanner()
@@ -79,6 +106,7 @@ void ScriptScanner::RescanDir()
 
 	/* Scan for scripts */
 	this->Scan(this->GetFileName(), this->GetDirectory());
+	this->RunScanJobs();
 }
 
 void ScriptScanner::Reset()
@@ -97,6 +125,12 @@ void ScriptScanner::Reset()
 
 void ScriptScanner::RegisterScript(ScriptInfo *info)
 {
+	if (current_job != nullptr) {
+		/* Run on a worker thread, register it together with the other scripts of the scan. */
+		current_job->infos.push_back(info);
+		return;
+	}
+
 	char script_original_name[1024];
 	this->GetScriptName(info, script_original_name, lastof(script_original_name));
 	strtolower(script_original_name);
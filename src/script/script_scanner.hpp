@@ -11,6 +11,7 @@
 #define SCRIPT_SCANNER_HPP
 
 #include <map>
+#include <vector>
 #include "../fileio_func.h"
 #include "../core/string_compare_type.hpp"
 
@@ -32,12 +33,12 @@ public:
 	/**
 	 * Get the current main script the ScanDir is currently tracking.
 	 */
-	std::string GetMainScript() { return this->main_script; }
+	std::string GetMainScript() { return current_job != nullptr ? current_job->main_script : this->main_script; }
 
 	/**
 	 * Get the current tar file the ScanDir is currently tracking.
 	 */
-	std::string GetTarFile() { return this->tar_file; }
+	std::string GetTarFile() { return current_job != nullptr ? current_job->tar_file : this->tar_file; }
 
 	/**
 	 * Get the list of all registered scripts.
@@ -83,12 +84,24 @@ public:
 	void RescanDir();
 
 protected:
+	/** Script found by the scan, of which the info file still has to be run. */
+	struct ScanJob {
+		std::string filename;                  ///< The info file of the script.
+		std::string main_script;               ///< The full path of the script.
+		std::string tar_file;                  ///< If, which tar file the script was in.
+		std::vector<class ScriptInfo *> infos; ///< Scripts registered by the info file, in order.
+	};
+
+	static thread_local ScanJob *current_job; ///< Scan job of which the info file is being run on this thread, if any.
+
+	const char *engine_name; ///< The name of the engines we're scanning with.
 	class Squirrel *engine;  ///< The engine we're scanning with.
 	std::string main_script; ///< The full path of the script.
 	std::string tar_file;    ///< If, which tar file the script was in.
 
 	ScriptInfoList info_list;        ///< The list of all script.
 	ScriptInfoList info_single_list; ///< The list of all unique script. The best script (highest version) is shown.
+	std::vector<ScanJob> scan_jobs;  ///< Scripts found by the scan in progress.
 
 	/**
 	 * Initialize the scanner.
@@ -127,9 +140,11 @@ protected:
 	void Reset();
 
 	/**
-	 * Reset the engine to ensure a clean environment for further steps.
+	 * Reset an engine to ensure a clean environment for further steps.
 	 */
-	void ResetEngine();
+	void ResetEngine(class Squirrel *engine);
+
+	void RunScanJobs();
 };
 
 #endif /* SCRIPT_SCANNER_HPP */
@@ -17,6 +17,9 @@
 #include <sqstdaux.h>
 #include <../squirrel/sqpcheader.h>
 #include <../squirrel/sqvm.h>
+#include <../squirrel/sqclosure.h>
+#include <../squirrel/squserdata.h>
+#include "script_profiler.hpp"
 #include "../core/alloc_func.hpp"
 
 #include <stdarg.h>
@@ -49,6 +52,26 @@ struct ScriptAllocator {
 
 	static const size_t SAFE_LIMIT = 0x8000000; ///< 128 MiB, a safe choice for almost any situation
 
+	/*
+	 * Squirrel makes many small allocations for tables, arrays, closures and strings.
+	 * These are served from per-allocator pools of fixed size classes, which are carved
+	 * out of larger blocks and only returned to the OS when the script is uninitialised.
+	 */
+	static const size_t POOL_GRANULARITY = 16;                               ///< Size difference between two pool size classes.
+	static const size_t POOL_MAX_SIZE = 256;                                 ///< Largest allocation served from the pools.
+	static const size_t POOL_CLASSES = POOL_MAX_SIZE / POOL_GRANULARITY;     ///< Number of pool size classes.
+	static const size_t POOL_BLOCK_SIZE = 64 * 1024;                         ///< Size of the blocks the pools are carved out of.
+
+	/** Unused pool item, linked in the free list of its size class. */
+	struct PoolFreeItem {
+		PoolFreeItem *next;
+	};
+
+	PoolFreeItem *pool_free[POOL_CLASSES]; ///< Free list of each pool size class.
+	char *pool_block_pos;                  ///< Start of the unused part of the current pool block.
+	char *pool_block_end;                  ///< End of the current pool block.
+	std::vector<void *> pool_blocks;       ///< All pool blocks.
+
 #ifdef SCRIPT_DEBUG_ALLOCATIONS
 	std::map<void *, size_t> allocations;
 #endif
@@ -66,8 +89,9 @@ struct ScriptAllocator {
 	 * clean everything up.
 	 * @param requested_size The requested size that was requested to be allocated.
 	 * @param p              The pointer to the allocated object, or null if allocation failed.
+	 * @param alloc_size     The size \a p was allocated with.
 	 */
-	void CheckAllocation(size_t requested_size, void *p)
+	void CheckAllocation(size_t requested_size, void *p, size_t alloc_size)
 	{
 		if (this->allocated_size + requested_size > this->allocation_limit && !this->error_thrown) {
 			/* Do not allow allocating more than the allocation limit, except when an error is
@@ -78,7 +102,7 @@ struct ScriptAllocator {
 			seprintf(buff, lastof(buff), "Maximum memory allocation exceeded by " PRINTF_SIZE " bytes when allocating " PRINTF_SIZE " bytes",
 				this->allocated_size + requested_size - this->allocation_limit, requested_size);
 			/* Don't leak the rejected allocation. */
-			free(p);
+			this->RawFree(p, alloc_size);
 			throw Script_FatalError(buff);
 		}
 
@@ -99,13 +123,86 @@ struct ScriptAllocator {
 		}
 	}
 
+	/**
+	 * Get the amount of memory accounted for an allocation.
+	 * @param size The requested size.
+	 * @return The size including the rounding up to the pool size class.
+	 */
+	static size_t AccountedSize(size_t size)
+	{
+		if (size == 0 || size > POOL_MAX_SIZE) return size;
+		return Align(size, POOL_GRANULARITY);
+	}
+
+	/**
+	 * Allocate memory, from a pool if the size is small enough.
+	 * @param size The size to allocate.
+	 * @return The memory, or nullptr if the OS could not allocate it.
+	 */
+	void *RawMalloc(size_t size)
+	{
+		if (size == 0 || size > POOL_MAX_SIZE) return malloc(size);
+
+		const size_t cls = (size - 1) / POOL_GRANULARITY;
+		PoolFreeItem *item = this->pool_free[cls];
+		if (item != nullptr) {
+			this->pool_free[cls] = item->next;
+			return item;
+		}
+
+		const size_t item_size = (cls + 1) * POOL_GRANULARITY;
+		if ((size_t)(this->pool_block_end - this->pool_block_pos) < item_size) {
+			char *block = static_cast<char *>(malloc(POOL_BLOCK_SIZE));
+			if (block == nullptr) return nullptr;
+			this->pool_blocks.push_back(block);
+			this->pool_block_pos = block;
+			this->pool_block_end = block + POOL_BLOCK_SIZE;
+		}
+		void *p = this->pool_block_pos;
+		this->pool_block_pos += item_size;
+		return p;
+	}
+
+	/**
+	 * Free memory allocated by RawMalloc.
+	 * @param p The memory to free.
+	 * @param size The size it was allocated with.
+	 */
+	void RawFree(void *p, size_t size)
+	{
+		if (p == nullptr) return;
+		if (size == 0 || size > POOL_MAX_SIZE) {
+			free(p);
+			return;
+		}
+
+		const size_t cls = (size - 1) / POOL_GRANULARITY;
+		PoolFreeItem *item = static_cast<PoolFreeItem *>(p);
+		item->next = this->pool_free[cls];
+		this->pool_free[cls] = item;
+	}
+
+	/**
+	 * Return all pool blocks to the OS.
+	 * @pre Nothing is allocated from the pools any more.
+	 */
+	void ReleasePools()
+	{
+		for (void *block : this->pool_blocks) free(block);
+		this->pool_blocks.clear();
+		this->pool_blocks.shrink_to_fit();
+		std::fill(std::begin(this->pool_free), std::end(this->pool_free), nullptr);
+		this->pool_block_pos = nullptr;
+		this->pool_block_end = nullptr;
+	}
+
 	void *Malloc(SQUnsignedInteger size)
 	{
-		void *p = malloc(size);
+		void *p = this->RawMalloc(size);
 
-		this->CheckAllocation(size, p);
+		this->CheckAllocation(AccountedSize(size), p, size);
 
-		this->allocated_size += size;
+		this->allocated_size += AccountedSize(size);
 
 #ifdef SCRIPT_DEBUG_ALLOCATIONS
 		assert(p != nullptr);
@@ -126,6 +223,15 @@ struct ScriptAllocator {
 			return nullptr;
 		}
 
+		if (oldsize != 0 && oldsize <= POOL_MAX_SIZE && size <= POOL_MAX_SIZE && AccountedSize(oldsize) == AccountedSize(size)) {
+			/* Same pool size class, the allocation can stay where it is. */
+#ifdef SCRIPT_DEBUG_ALLOCATIONS
+			assert(this->allocations[p] == oldsize);
+			this->allocations[p] = size;
+#endif
+			return p;
+		}
+
 #ifdef SCRIPT_DEBUG_ALLOCATIONS
 		assert(this->allocations[p] == oldsize);
 		this->allocations.erase(p);
@@ -134,16 +240,16 @@ struct ScriptAllocator {
 		 * If memory exception is thrown, the old pointer is expected
 		 * to be valid for engine cleanup.
 		 */
-		void *new_p = malloc(size);
+		void *new_p = this->RawMalloc(size);
 
-		this->CheckAllocation(size - oldsize, new_p);
+		this->CheckAllocation(AccountedSize(size) - AccountedSize(oldsize), new_p, size);
 
 		/* Memory limit test passed, we can copy data and free old pointer. */
 		memcpy(new_p, p, std::min(oldsize, size));
-		free(p);
+		this->RawFree(p, oldsize);
 
-		this->allocated_size -= oldsize;
-		this->allocated_size += size;
+		this->allocated_size -= AccountedSize(oldsize);
+		this->allocated_size += AccountedSize(size);
 
 #ifdef SCRIPT_DEBUG_ALLOCATIONS
 		assert(new_p != nullptr);
@@ -157,8 +263,8 @@ struct ScriptAllocator {
 	void Free(void *p, SQUnsignedInteger size)
 	{
 		if (p == nullptr) return;
-		free(p);
-		this->allocated_size -= size;
+		this->RawFree(p, size);
+		this->allocated_size -= AccountedSize(size);
 
 #ifdef SCRIPT_DEBUG_ALLOCATIONS
 		assert(this->allocations.at(p) == size);
@@ -172,6 +278,9 @@ struct ScriptAllocator {
 		this->allocation_limit = static_cast<size_t>(_settings_game.script.script_max_memory_megabytes) << 20;
 		if (this->allocation_limit == 0) this->allocation_limit = SAFE_LIMIT; // in case the setting is somehow zero
 		this->error_thrown = false;
+		std::fill(std::begin(this->pool_free), std::end(this->pool_free), nullptr);
+		this->pool_block_pos = nullptr;
+		this->pool_block_end = nullptr;
 	}
 
 	~ScriptAllocator()
@@ -179,6 +288,7 @@ struct ScriptAllocator {
 #ifdef SCRIPT_DEBUG_ALLOCATIONS
 		assert(this->allocations.size() == 0);
 #endif
+		this->ReleasePools();
 	}
 };
 
@@ -190,7 +300,8 @@ struct ScriptAllocator {
  */
 #include "../safeguards.h"
 
-ScriptAllocator *_squirrel_allocator = nullptr;
+/* Per thread, as the script scanners run engines on several threads at once. */
+thread_local ScriptAllocator *_squirrel_allocator = nullptr;
 
 /* See 3rdparty/squirrel/squirrel/sqmem.cpp for the default allocator implementation, which this overrides */
 #ifndef SQUIRREL_DEFAULT_ALLOCATOR
@@ -406,6 +517,7 @@ bool Squirrel::Resume(int suspend)
 		suspend = -this->overdrawn_ops;
 	}
 
+	ScriptProfilerScope profiler_scope(this->profiler.get());
 	this->crashed = !sq_resumecatch(this->vm, suspend);
 	this->overdrawn_ops = -this->vm->_ops_till_suspend;
 	this->allocator->CheckLimit();
@@ -448,6 +560,7 @@ bool Squirrel::CallMethod(HSQOBJECT instance, const char *method_name, HSQOBJECT
 	}
 	/* Call the method */
 	sq_pushobject(this->vm, instance);
+	ScriptProfilerScope profiler_scope(this->profiler.get());
 	if (SQ_FAILED(sq_call(this->vm, 1, ret == nullptr ? SQFalse : SQTrue, SQTrue, suspend))) return false;
 	if (ret != nullptr) sq_getstackobj(vm, -1, ret);
 	/* Reset the top, but don't do so for the script main function, as we need
@@ -772,15 +885,45 @@ void Squirrel::Uninitialize()
 	ScriptAllocatorScope alloc_scope(this);
 
 	/* Clean up the stuff */
+	this->StopProfiling();
 	sq_pop(this->vm, 1);
 	sq_close(this->vm);
 
 	assert(this->allocator->allocated_size == 0);
+	this->allocator->ReleasePools();
 
 	/* Reset memory allocation errors. */
 	this->allocator->error_thrown = false;
 }
 
+void Squirrel::StartProfiling()
+{
+	this->profiler.reset(new ScriptProfiler());
+	this->vm->_profiler = this->profiler.get();
+}
+
+void Squirrel::StopProfiling()
+{
+	this->vm->_profiler = nullptr;
+	this->profiler.reset();
+}
+
+void Squirrel::PrintProfile(uint count)
+{
+	ScriptAllocatorScope alloc_scope(this);
+
+	this->profiler->ResolveNativeNames(this->vm);
+	this->profiler->PrintReport(count);
+}
+
+bool Squirrel::WriteProfile(const char *filename)
+{
+	ScriptAllocatorScope alloc_scope(this);
+
+	this->profiler->ResolveNativeNames(this->vm);
+	return this->profiler->WriteReport(filename);
+}
+
 void Squirrel::Reset()
 {
 	this->Uninitialize();
@@ -814,6 +957,19 @@ void Squirrel::InsertResult(int result)
 	vm->DecreaseOps(ops);
 }
 
+/* static */ const void *Squirrel::GetNativeClosureData(HSQUIRRELVM vm, int index, size_t size)
+{
+	const SQObjectPtr &o = stack_get(vm, index);
+	if (sq_type(o) != OT_NATIVECLOSURE) return nullptr;
+
+	const SQNativeClosure *closure = _nativeclosure(o);
+	if (closure->_outervalues.size() != 1) return nullptr;
+
+	const SQObjectPtr &data = closure->_outervalues[0];
+	if (sq_type(data) != OT_USERDATA || (size_t)_userdata(data)->_size != size) return nullptr;
+	return _userdataval(data);
+}
+
 bool Squirrel::IsSuspended()
 {
 	return this->vm->_suspended != 0;
@@ -19,6 +19,7 @@ enum ScriptType {
 };
 
 struct ScriptAllocator;
+class ScriptProfiler;
 
 class Squirrel {
 	friend class ScriptAllocatorScope;
@@ -33,6 +34,7 @@ private:
 	int overdrawn_ops;       ///< The amount of operations we have overdrawn.
 	const char *APIName;     ///< Name of the API used for this squirrel.
 	std::unique_ptr<ScriptAllocator> allocator; ///< Allocator object used by this script.
+	std::unique_ptr<ScriptProfiler> profiler;   ///< Profiler of this script, if profiling.
 
 	/**
 	 * The internal RunError handler. It looks up the real error and calls RunError with it.
@@ -225,6 +227,11 @@ public:
 	 */
 	static void *GetGlobalPointer(HSQUIRRELVM vm) { return ((Squirrel *)sq_getforeignptr(vm))->global_pointer; }
 
+	/**
+	 * Get the engine a VM belongs to.
+	 */
+	static Squirrel *Get(HSQUIRRELVM vm) { return (Squirrel *)sq_getforeignptr(vm); }
+
 	/**
 	 * Set a custom print function, so you can handle outputs from SQ yourself.
 	 */
@@ -245,6 +252,15 @@ public:
 	 */
 	static void DecreaseOps(HSQUIRRELVM vm, int amount);
 
+	/**
+	 * Get the data bound to a native function by #AddMethod, such as the C++ function pointer of an API method.
+	 * @param vm The VM to get the function from.
+	 * @param index The stack index of the function.
+	 * @param size The expected size of the bound data.
+	 * @return The bound data, or nullptr if the object is not a native function with bound data of exactly \a size bytes.
+	 */
+	static const void *GetNativeClosureData(HSQUIRRELVM vm, int index, size_t size);
+
 	/**
 	 * Did the squirrel code suspend or return normally.
 	 * @return True if the function suspended.
@@ -282,10 +298,40 @@ public:
 	size_t GetAllocatedMemory() const noexcept;
 
 	void SetMemoryAllocationLimit(size_t limit) noexcept;
+
+	/**
+	 * Start collecting per function statistics, discarding any previously collected ones.
+	 */
+	void StartProfiling();
+
+	/**
+	 * Stop collecting per function statistics and discard them.
+	 */
+	void StopProfiling();
+
+	/**
+	 * Are per function statistics being collected?
+	 */
+	bool IsProfiling() const { return this->profiler != nullptr; }
+
+	/**
+	 * Print the most expensive functions to the console.
+	 * @param count The maximum number of functions to print.
+	 * @pre IsProfiling()
+	 */
+	void PrintProfile(uint count);
+
+	/**
+	 * Write the statistics of all functions to a CSV file.
+	 * @param filename The name of the file.
+	 * @return True when the file was written.
+	 * @pre IsProfiling()
+	 */
+	bool WriteProfile(const char *filename);
 };
 
 
-extern ScriptAllocator *_squirrel_allocator;
+extern thread_local ScriptAllocator *_squirrel_allocator;
 
 class ScriptAllocatorScope {
 	ScriptAllocator *old_allocator;
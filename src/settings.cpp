@@ -92,6 +92,8 @@
 #include "table/settings.h"
 
 #include <algorithm>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include "safeguards.h"
@@ -928,6 +930,7 @@ static void RedrawSmallmap(int32 new_value)
 {
 	BuildLandLegend();
 	BuildOwnerLegend();
+	InvalidateSmallMapColourCache();
 	SetWindowClassesDirty(WC_SMALLMAP);
 
 	extern void MarkAllViewportMapLandscapesDirty();
@@ -1493,6 +1496,12 @@ static void RoadSideChanged(int32 new_value)
 	RecalculateRoadCachedOneWayStates();
 }
 
+static void AdjacentCrossingsChanged(int32 new_value)
+{
+	extern void UpdateAllLevelCrossings();
+	UpdateAllLevelCrossings();
+}
+
 /**
  * Conversion callback for _gameopt_settings_game.landscape
  * It converts (or try) between old values and the new ones,
@@ -2409,33 +2418,74 @@ void IntSettingDesc::ChangeValue(const void *object, int32 newval) const
 }
 
 /**
- * Given a name of setting, return a setting description from the table.
- * @param name Name of the setting to return a setting description of.
- * @param settings Table to look in for the setting.
- * @return Pointer to the setting description of setting \a name if it can be found,
- *         \c nullptr indicates failure to obtain the description.
+ * Index of setting names, including the short names without the group prefix.
+ * Each name maps to the candidate settings in the order a linear search of the tables would find them,
+ * as which of them is valid depends on the savegame version.
+ */
+typedef std::unordered_map<std::string_view, std::vector<const SettingDesc *>> SettingNameIndex;
+
+/**
+ * Add the names of the settings of a table to a setting name index.
+ * @param index The index.
+ * @param settings The table.
  */
-static const SettingDesc *GetSettingFromName(const char *name, const SettingTable &settings)
+static void AddSettingTableToNameIndex(SettingNameIndex &index, const SettingTable &settings)
 {
-	/* First check all full names */
+	/* Within a table full names take precedence over the shortcut variants of the names.
+	 * Placeholders of removed settings do not have a name. */
 	for (auto &sd : settings) {
-		if (!SlIsObjectCurrentlyValid(sd->save.version_from, sd->save.version_to, sd->save.ext_feature_test)) continue;
-		if (strcmp(sd->name, name) == 0) return sd.get();
+		if (sd->name == nullptr) continue;
+		index[sd->name].push_back(sd.get());
 	}
-
-	/* Then check the shortcut variant of the name. */
 	for (auto &sd : settings) {
-		if (!SlIsObjectCurrentlyValid(sd->save.version_from, sd->save.version_to, sd->save.ext_feature_test)) continue;
+		if (sd->name == nullptr) continue;
 		const char *short_name = strchr(sd->name, '.');
-		if (short_name != nullptr) {
-			short_name++;
-			if (strcmp(short_name, name) == 0) return sd.get();
-		}
+		if (short_name != nullptr) index[short_name + 1].push_back(sd.get());
 	}
+}
+
+/**
+ * Given a name of setting, return a setting description from an index.
+ * @param name Name of the setting to return a setting description of.
+ * @param index Index to look in for the setting.
+ * @return Pointer to the setting description of setting \a name if it can be found,
+ *         \c nullptr indicates failure to obtain the description.
+ */
+static const SettingDesc *GetSettingFromName(const char *name, const SettingNameIndex &index)
+{
+	auto iter = index.find(name);
+	if (iter == index.end()) return nullptr;
 
+	for (const SettingDesc *sd : iter->second) {
+		if (SlIsObjectCurrentlyValid(sd->save.version_from, sd->save.version_to, sd->save.ext_feature_test)) return sd;
+	}
 	return nullptr;
 }
 
+/** Get the name index of the company settings. */
+static const SettingNameIndex &GetCompanySettingNameIndex()
+{
+	static const SettingNameIndex index = []() {
+		SettingNameIndex index;
+		AddSettingTableToNameIndex(index, _company_settings);
+		return index;
+	}();
+	return index;
+}
+
+/** Get the name index of the generic, private and secrets settings, in that order of precedence. */
+static const SettingNameIndex &GetSettingNameIndex()
+{
+	static const SettingNameIndex index = []() {
+		SettingNameIndex index;
+		for (auto &table : _generic_setting_tables) AddSettingTableToNameIndex(index, table);
+		for (auto &table : _private_setting_tables) AddSettingTableToNameIndex(index, table);
+		for (auto &table : _secrets_setting_tables) AddSettingTableToNameIndex(index, table);
+		return index;
+	}();
+	return index;
+}
+
 /**
  * Given a name of setting, return a company setting description of it.
  * @param name  Name of the company setting to return a setting description of.
@@ -2445,7 +2495,7 @@ static const SettingDesc *GetSettingFromName(const char *name, const SettingTabl
 static const SettingDesc *GetCompanySettingFromName(const char *name)
 {
 	if (strncmp(name, "company.", 8) == 0) name += 8;
-	return GetSettingFromName(name, _company_settings);
+	return GetSettingFromName(name, GetCompanySettingNameIndex());
 }
 
 /**
@@ -2456,18 +2506,8 @@ static const SettingDesc *GetCompanySettingFromName(const char *name)
  */
 const SettingDesc *GetSettingFromName(const char *name)
 {
-	for (auto &table : _generic_setting_tables) {
-		auto sd = GetSettingFromName(name, table);
-		if (sd != nullptr) return sd;
-	}
-	for (auto &table : _private_setting_tables) {
-		auto sd = GetSettingFromName(name, table);
-		if (sd != nullptr) return sd;
-	}
-	for (auto &table : _secrets_setting_tables) {
-		auto sd = GetSettingFromName(name, table);
-		if (sd != nullptr) return sd;
-	}
+	const SettingDesc *sd = GetSettingFromName(name, GetSettingNameIndex());
+	if (sd != nullptr) return sd;
 
 	return GetCompanySettingFromName(name);
 }
@@ -2498,6 +2538,7 @@ CommandCost CmdChangeSetting(TileIndex tile, DoCommandFlag flags, uint32 p1, uin
 		SCOPE_INFO_FMT([=], "CmdChangeSetting: %s -> %d", sd->name, p2);
 
 		sd->AsIntSetting()->ChangeValue(&GetGameSettings(), p2);
+		_rail_state_generation++;
 	}
 
 	return CommandCost();
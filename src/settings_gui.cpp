@@ -571,6 +571,8 @@ struct GameOptionsWindow : Window {
 				break;
 
 			case WID_GO_LANG_DROPDOWN: // Change interface language
+				/* Reloading the current language would only repeat the expensive missing glyph check and window reinitialisation. */
+				if (&_languages[index] == _current_language) break;
 				ReadLanguagePack(&_languages[index]);
 				DeleteWindowByClass(WC_QUERY_STRING);
 				CheckForMissingGlyphs();
@@ -2193,6 +2195,7 @@ static SettingsContainer &GetSettingsTree()
 				towns->Add(new SettingEntry("economy.allow_town_level_crossings"));
 				towns->Add(new SettingEntry("economy.town_build_tunnels"));
 				towns->Add(new SettingEntry("economy.town_max_road_slope"));
+				towns->Add(new SettingEntry("economy.town_growth_frontier"));
 				towns->Add(new SettingEntry("economy.found_town"));
 				towns->Add(new SettingEntry("economy.town_cargogen_mode"));
 				towns->Add(new SettingEntry("economy.town_cargo_scale_factor"));
@@ -2233,6 +2236,7 @@ static SettingsContainer &GetSettingsTree()
 				cdist->Add(new SettingEntry("linkgraph.short_path_saturation"));
 				cdist->Add(new SettingEntry("linkgraph.recalc_not_scaled_by_daylength"));
 				cdist->Add(new SettingEntry("linkgraph.aircraft_link_scale"));
+				cdist->Add(new SettingEntry("linkgraph.demand_reuse_threshold"));
 			}
 			SettingsPage *treedist = environment->Add(new SettingsPage(STR_CONFIG_SETTING_ENVIRONMENT_TREES));
 			{
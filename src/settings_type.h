@@ -152,6 +152,7 @@ struct GUISettings : public TimeSettings {
 	uint16 autosave_custom_days;             ///< custom autosave interval in days
 	uint16 autosave_custom_minutes;          ///< custom autosave interval in real-time minutes
 	bool   threaded_saves;                   ///< should we do threaded saves?
+	bool   forked_saves;                     ///< should threaded saves be done by a forked process (POSIX only)?
 	bool   keep_all_autosave;                ///< name the autosave in a different way
 	bool   autosave_on_exit;                 ///< save an autosave when you quit the game, but do not ask "Do you really want to quit?"
 	bool   autosave_on_network_disconnect;   ///< save an autosave when you get disconnected from a network game with an error?
@@ -345,6 +346,9 @@ struct NewsSettings {
 struct NetworkSettings {
 	uint16      sync_freq;                                ///< how often do we check whether we are still in-sync
 	uint8       frame_freq;                               ///< how often do we send commands to the clients
+	bool        sync_state_checksum_parts;                ///< send the checksums of the parts of the game state with each sync, so clients can tell which part diverged
+	uint16      sampled_cache_check_budget;               ///< time budget in microseconds per tick for checking a rotating sample of the game caches, 0 = disabled
+	uint16      slow_tick_log_threshold;                  ///< duration in milliseconds of a game tick above which a slow tick log is written, 0 = disabled
 	uint16      commands_per_frame;                       ///< how many commands may be sent each frame_freq frames?
 	uint16      max_commands_in_queue;                    ///< how many commands may there be in the incoming queue before dropping the connection?
 	uint16      bytes_per_frame;                          ///< how many bytes may, over a long period, be received per frame?
@@ -352,6 +356,7 @@ struct NetworkSettings {
 	uint16      max_init_time;                            ///< maximum amount of time, in game ticks, a client may take to initiate joining
 	uint16      max_join_time;                            ///< maximum amount of time, in game ticks, a client may take to sync up during joining
 	uint16      max_download_time;                        ///< maximum amount of time, in game ticks, a client may take to download the map
+	uint8       max_map_transfer_clients;                 ///< maximum number of joining clients which are sent the same map dump
 	uint16      max_password_time;                        ///< maximum amount of time, in game ticks, a client may take to enter the password
 	uint16      max_lag_time;                             ///< maximum amount of time, in game ticks, a client may be lagging behind the server
 	bool        pause_on_join;                            ///< pause the game when people join
@@ -381,6 +386,8 @@ struct NetworkSettings {
 	Year        restart_game_year;                        ///< year the server restarts
 	uint8       min_active_clients;                       ///< minimum amount of active clients to unpause the game
 	bool        reload_cfg;                               ///< reload the config file before restarting
+	uint16      map_export_interval;                      ///< minutes in which the map images of a dedicated server are exported once, 0 = disabled
+	std::string map_export_dir;                           ///< directory to export the map images to, the screenshot directory if empty
 	std::string last_joined;                              ///< Last joined server
 	bool        no_http_content_downloads;                     ///< do not do content downloads over HTTP
 	UseRelayService use_relay_service;                    ///< Use relay service?
@@ -560,6 +567,7 @@ struct YAPFSettings {
 	uint32 rail_longer_platform_per_tile_penalty;  ///< penalty for longer  station platform than train (per tile)
 	uint32 rail_shorter_platform_penalty;          ///< penalty for shorter station platform than train
 	uint32 rail_shorter_platform_per_tile_penalty; ///< penalty for shorter station platform than train (per tile)
+	uint32 rail_destination_perimeter_nodes;       ///< number of track positions to search backwards from a rail destination for the cost estimate, 0 = disabled
 	uint32 ship_curve45_penalty;                   ///< penalty for 45-deg curve for ships
 	uint32 ship_curve90_penalty;                   ///< penalty for 90-deg curve for ships
 };
@@ -690,6 +698,7 @@ struct EconomySettings {
 	bool   allow_town_level_crossings;       ///< towns are allowed to build level crossings
 	TownTunnelMode town_build_tunnels;       ///< if/when towns are allowed to build road tunnels
 	uint8  town_max_road_slope;              ///< maximum number of consecutive sloped road tiles which towns are allowed to build
+	bool   town_growth_frontier;             ///< towns mostly grow from the road tiles at which they recently grew, instead of searching from the centre
 	int8   old_town_cargo_factor;            ///< old power-of-two multiplier for town (passenger, mail) generation. May be negative.
 	int16  town_cargo_scale_factor;          ///< scaled power-of-two multiplier for town (passenger, mail) generation. May be negative.
 	int16  industry_cargo_scale_factor;      ///< scaled power-of-two multiplier for primary industry generation. May be negative.
@@ -712,6 +721,7 @@ struct LinkGraphSettings {
 	uint8 demand_distance;                      ///< influence of distance between stations on the demand function
 	uint8 short_path_saturation;                ///< percentage up to which short paths are saturated before saturating most capacious paths
 	uint16 aircraft_link_scale;                 ///< scale effective distance of aircraft links
+	uint8 demand_reuse_threshold;               ///< maximum relative change (in percent) of a node's share of the supply for which the demands of its component are reused, 0 to always recalculate
 
 	inline DistributionType GetDistributionType(CargoID cargo) const {
 		if (this->distribution_per_cargo[cargo] != DT_PER_CARGO_DEFAULT) return this->distribution_per_cargo[cargo];
@@ -15,6 +15,7 @@
 #include "company_func.h"
 #include "pathfinder/npf/npf_func.h"
 #include "depot_base.h"
+#include "depot_kdtree.h"
 #include "station_base.h"
 #include "newgrf_engine.h"
 #include "pathfinder/yapf/yapf.h"
@@ -81,6 +82,8 @@ bool IsValidImageIndex<VEH_SHIP>(uint8 image_index)
 
 static inline TrackBits GetTileShipTrackStatus(TileIndex tile)
 {
+	/* Most tiles ships look at are water tiles, skip the tile type procs for those. */
+	if (IsTileType(tile, MP_WATER)) return GetWaterTileShipTrackBits(tile);
 	return TrackStatusToTrackBits(GetTileTrackStatus(tile, TRANSPORT_WATER, 0));
 }
 
@@ -154,27 +157,18 @@ void Ship::GetImage(Direction direction, EngineImageType image_type, VehicleSpri
 
 static const Depot *FindClosestShipDepot(const Vehicle *v, uint max_distance)
 {
-	/* Find the closest depot */
-	const Depot *best_depot = nullptr;
-	/* If we don't have a maximum distance, i.e. distance = 0,
-	 * we want to find any depot so the best distance of no
-	 * depot must be more than any correct distance. On the
-	 * other hand if we have set a maximum distance, any depot
-	 * further away than max_distance can safely be ignored. */
-	uint best_dist = max_distance == 0 ? UINT_MAX : max_distance + 1;
-
-	for (const Depot *depot : Depot::Iterate()) {
-		TileIndex tile = depot->xy;
-		if (IsShipDepotTile(tile) && IsInfraTileUsageAllowed(VEH_SHIP, v->owner, tile)) {
-			uint dist = DistanceManhattan(tile, v->tile);
-			if (dist < best_dist) {
-				best_dist = dist;
-				best_depot = depot;
-			}
-		}
-	}
-
-	return best_depot;
+	/* Find the closest depot.
+	 * If we don't have a maximum distance, i.e. distance = 0,
+	 * we want to find any depot. On the other hand if we have
+	 * set a maximum distance, any depot further away than
+	 * max_distance can safely be ignored. */
+	int limit = max_distance == 0 ? INT_MAX : (int)std::min<uint>(max_distance, INT_MAX - 1) + 1;
+
+	DepotID depot = _ship_depot_kdtree.FindNearestFiltered(TileX(v->tile), TileY(v->tile), [&](DepotID id) {
+		return IsInfraTileUsageAllowed(VEH_SHIP, v->owner, Depot::Get(id)->xy);
+	}, INVALID_DEPOT, limit);
+
+	return depot == INVALID_DEPOT ? nullptr : Depot::Get(depot);
 }
 
 static void CheckIfShipNeedsService(Vehicle *v)
@@ -583,7 +577,7 @@ static Track ChooseShipTrack(Ship *v, TileIndex tile, DiagDirection enterdir, Tr
 		}
 	}
 	DEBUG_UPDATESTATECHECKSUM("ChooseShipTrack: v: %u, path_found: %d, track: %d", v->index, path_found, track);
-	UpdateStateChecksum((((uint64) v->index) << 32) | (path_found << 16) | track);
+	UpdateStateChecksum((((uint64) v->index) << 32) | (path_found << 16) | track, SCP_VEHICLES);
 
 	v->HandlePathfindingResult(path_found);
 	return track;
@@ -1080,7 +1074,7 @@ direction_changed:
 bool Ship::Tick()
 {
 	DEBUG_UPDATESTATECHECKSUM("Ship::Tick: v: %u, x: %d, y: %d", this->index, this->x_pos, this->y_pos);
-	UpdateStateChecksum((((uint64) this->x_pos) << 32) | this->y_pos);
+	UpdateStateChecksum((((uint64) this->x_pos) << 32) | this->y_pos, SCP_VEHICLES);
 	if (!((this->vehstatus & VS_STOPPED) || this->IsWaitingInDepot())) this->running_ticks++;
 
 	ShipController(this);
@@ -1164,7 +1158,6 @@ CommandCost CmdBuildShip(TileIndex tile, DoCommandFlag flags, const Engine *e, u
 		v->InvalidateNewGRFCacheOfChain();
 
 		v->UpdatePosition();
-		InvalidateVehicleTickCaches();
 	}
 
 	return CommandCost();
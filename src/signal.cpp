@@ -47,8 +47,8 @@ static void MarkDependencidesForUpdate(SignalReference sig);
 /** these are the maximums used for updating signal blocks */
 static const uint SIG_TBU_SIZE    =  64; ///< number of signals entering to block
 static const uint SIG_TBD_SIZE    = 256; ///< number of intersections - open nodes in current block
-static const uint SIG_GLOB_SIZE   = 128; ///< number of open blocks (block can be opened more times until detected)
-static const uint SIG_GLOB_UPDATE =  64; ///< how many items need to be in _globset to force update
+static const uint SIG_GLOB_SIZE   = 512; ///< number of open blocks (block can be opened more times until detected)
+static const uint SIG_GLOB_UPDATE = 256; ///< how many items need to be in _globset to force update
 
 static_assert(SIG_GLOB_UPDATE <= SIG_GLOB_SIZE);
 
@@ -72,10 +72,15 @@ static const TrackdirBits _enterdir_to_trackdirbits[DIAGDIR_END] = {
  * Set containing 'items' items of 'tile and Tdir'
  * No tree structure is used because it would cause
  * slowdowns in most usual cases
+ * A small table of per-bucket item counts is used so that lookups of items which
+ * are not in the set (the usual case when exploring a block) can return without a linear search
  */
 template <typename Tdir, uint items>
 struct SmallSet {
 private:
+	static const uint FILTER_BITS = 8;
+	static const uint FILTER_SIZE = 1 << FILTER_BITS;
+
 	uint n;           // actual number of units
 	bool overflowed;  // did we try to overflow the set?
 	const char *name; // name, used for debugging purposes...
@@ -86,15 +91,26 @@ private:
 		Tdir dir;
 	} data[items];
 
+	uint16 filter[FILTER_SIZE]; ///< number of items in the set in each bucket
+
+	static inline uint FilterBucket(TileIndex tile, Tdir dir)
+	{
+		return ((((uint32)tile << 8) ^ (uint8)dir) * 0x9E3779B1U) >> (32 - FILTER_BITS);
+	}
+
 public:
 	/** Constructor - just set default values and 'name' */
-	SmallSet(const char *name) : n(0), overflowed(false), name(name) { }
+	SmallSet(const char *name) : n(0), overflowed(false), name(name)
+	{
+		std::fill(std::begin(this->filter), std::end(this->filter), 0);
+	}
 
 	/** Reset variables to default values */
 	void Reset()
 	{
 		this->n = 0;
 		this->overflowed = false;
+		std::fill(std::begin(this->filter), std::end(this->filter), 0);
 	}
 
 	/**
@@ -142,9 +158,13 @@ public:
 	 */
 	bool Remove(TileIndex tile, Tdir dir)
 	{
+		const uint bucket = FilterBucket(tile, dir);
+		if (this->filter[bucket] == 0) return false;
+
 		for (uint i = 0; i < this->n; i++) {
 			if (this->data[i].tile == tile && this->data[i].dir == dir) {
 				this->data[i] = this->data[--this->n];
+				this->filter[bucket]--;
 				return true;
 			}
 		}
@@ -160,6 +180,8 @@ public:
 	 */
 	bool IsIn(TileIndex tile, Tdir dir)
 	{
+		if (this->filter[FilterBucket(tile, dir)] == 0) return false;
+
 		for (uint i = 0; i < this->n; i++) {
 			if (this->data[i].tile == tile && this->data[i].dir == dir) return true;
 		}
@@ -185,6 +207,7 @@ public:
 		this->data[this->n].tile = tile;
 		this->data[this->n].dir = dir;
 		this->n++;
+		this->filter[FilterBucket(tile, dir)]++;
 
 		return true;
 	}
@@ -202,6 +225,7 @@ public:
 		this->n--;
 		*tile = this->data[this->n].tile;
 		*dir = this->data[this->n].dir;
+		this->filter[FilterBucket(*tile, *dir)]--;
 
 		return true;
 	}
@@ -556,16 +580,16 @@ static uint8 GetSignalledTunnelBridgeEntranceForwardAspect(TileIndex tile, TileI
 	const uint spacing = GetTunnelBridgeSignalSimulationSpacing(tile);
 	const uint signal_count = GetTunnelBridgeLength(tile, tile_exit) / spacing;
 	if (IsBridge(tile)) {
-		uint8 aspect = 0;
+		const uint max_aspect = GetMaximumSignalAspect();
+		uint aspect = 0;
 		for (uint i = 0; i < signal_count; i++) {
-			if (GetBridgeEntranceSimulatedSignalState(tile, i) == SIGNAL_STATE_GREEN) {
-				aspect++;
-			} else {
-				return std::min<uint>(aspect, GetMaximumSignalAspect());
-			}
+			if (GetBridgeEntranceSimulatedSignalState(tile, i) != SIGNAL_STATE_GREEN) return aspect;
+
+			/* Signals further along the bridge can't raise the aspect any more */
+			if (++aspect >= max_aspect) return max_aspect;
 		}
 		if (GetTunnelBridgeExitSignalState(tile_exit) == SIGNAL_STATE_GREEN) aspect += GetTunnelBridgeExitSignalAspect(tile_exit);
-		return std::min<uint>(aspect, GetMaximumSignalAspect());
+		return std::min<uint>(aspect, max_aspect);
 	} else {
 		int free_tiles = GetAvailableFreeTilesInSignalledTunnelBridge(tile, tile_exit, tile);
 		if (free_tiles == INT_MAX) {
@@ -26,6 +26,7 @@
 #include "zoom_func.h"
 #include "object_map.h"
 #include "newgrf_object.h"
+#include "core/mem_func.hpp"
 
 #include "smallmap_colours.h"
 #include "smallmap_gui.h"
@@ -619,6 +620,147 @@ static inline uint32 GetSmallMapOwnerPixels(TileIndex tile, TileType t)
 	return MKCOLOUR_XXXX(_legend_land_owners[_company_to_list_pos[o]].colour);
 }
 
+/**
+ * Cache of the tile colours shown by the smallmap window, for the current map type, zoom level and scroll alignment.
+ * Colours are stored per cell of zoom x zoom tiles, as returned by #SmallMapWindow::GetTileColours.
+ * The cells are grouped into chunks, which are only allocated once a cell of them is drawn.
+ * Cells are invalidated when their tiles are marked dirty, and a slice of the cache is
+ * invalidated at each refresh of the window, to pick up changes which are not marked dirty.
+ */
+struct SmallMapColourCache {
+	static const uint CHUNK_SHIFT = 6;
+	static const uint CHUNK_SIZE = 1 << CHUNK_SHIFT; ///< Width and height of a chunk in cells.
+	static const uint MAX_CHUNKS = 1024;             ///< Number of allocated chunks at which the cache is cleared.
+	static const uint SWEEP_SLICES = 16;             ///< Number of refreshes after which every chunk has been invalidated once.
+
+	/** Square of cells of the cache. */
+	struct Chunk {
+		uint64 valid[CHUNK_SIZE];                ///< Bit per cell, set when the colour of the cell is cached.
+		uint32 colours[CHUNK_SIZE * CHUNK_SIZE]; ///< Cached colours of the cells.
+
+		Chunk() { MemSetT(this->valid, 0, CHUNK_SIZE); }
+	};
+
+	std::vector<std::unique_ptr<Chunk>> chunks; ///< Chunks of the cache, by chunk position, nullptr when not allocated.
+	uint chunks_x = 0;     ///< Number of chunks in the X direction.
+	uint chunks_y = 0;     ///< Number of chunks in the Y direction.
+	uint allocated = 0;    ///< Number of allocated chunks.
+	uint sweep_pos = 0;    ///< Index of the next chunk to invalidate by #Sweep.
+	int zoom = 0;          ///< Zoom level of the cached cells, 0 when the cache is not in use.
+	int map_type = -1;     ///< Map type of the cached colours.
+	uint origin_x = 0;     ///< X coordinate of the first cell, cells start at tiles with X coordinate origin_x + n * zoom.
+	uint origin_y = 0;     ///< Y coordinate of the first cell, cells start at tiles with Y coordinate origin_y + n * zoom.
+
+	/** Drop all cached colours, and free the memory of the cache. */
+	void Clear()
+	{
+		this->chunks.clear();
+		this->chunks_x = 0;
+		this->chunks_y = 0;
+		this->allocated = 0;
+		this->sweep_pos = 0;
+		this->zoom = 0;
+	}
+
+	/**
+	 * Prepare the cache for drawing cells with the given properties, dropping the cached colours if they differ.
+	 * @param map_type Map type being drawn.
+	 * @param zoom Zoom level being drawn.
+	 * @param origin_x Position of the cells in X direction, modulo \a zoom.
+	 * @param origin_y Position of the cells in Y direction, modulo \a zoom.
+	 */
+	void Setup(int map_type, int zoom, uint origin_x, uint origin_y)
+	{
+		if (this->zoom == zoom && this->map_type == map_type && this->origin_x == origin_x && this->origin_y == origin_y && this->allocated < MAX_CHUNKS) return;
+
+		this->Clear();
+		this->zoom = zoom;
+		this->map_type = map_type;
+		this->origin_x = origin_x;
+		this->origin_y = origin_y;
+		this->chunks_x = (((MapSizeX() / zoom) + 1) >> CHUNK_SHIFT) + 1;
+		this->chunks_y = (((MapSizeY() / zoom) + 1) >> CHUNK_SHIFT) + 1;
+		this->chunks.resize(this->chunks_x * this->chunks_y);
+	}
+
+	/**
+	 * Get the cached colour of the cell starting at a tile, computing it if necessary.
+	 * @param xc X coordinate of the first tile of the cell.
+	 * @param yc Y coordinate of the first tile of the cell.
+	 * @param compute Function returning the colour of the cell.
+	 * @return The colour of the cell.
+	 */
+	template <typename F>
+	inline uint32 GetColour(uint xc, uint yc, F compute)
+	{
+		const uint cx = (xc - this->origin_x) / this->zoom;
+		const uint cy = (yc - this->origin_y) / this->zoom;
+		std::unique_ptr<Chunk> &chunk = this->chunks[(cy >> CHUNK_SHIFT) * this->chunks_x + (cx >> CHUNK_SHIFT)];
+		if (chunk == nullptr) {
+			chunk.reset(new Chunk());
+			this->allocated++;
+		}
+		const uint x = cx & (CHUNK_SIZE - 1);
+		const uint y = cy & (CHUNK_SIZE - 1);
+		uint32 &colour = chunk->colours[(y << CHUNK_SHIFT) + x];
+		if (!HasBit(chunk->valid[y], x)) {
+			colour = compute();
+			SetBit(chunk->valid[y], x);
+		}
+		return colour;
+	}
+
+	/**
+	 * Invalidate the cached colour of the cell containing a tile.
+	 * @param tile The tile.
+	 */
+	inline void InvalidateTile(TileIndex tile)
+	{
+		if (this->allocated == 0) return;
+
+		const uint tx = TileX(tile);
+		const uint ty = TileY(tile);
+		if (tx < this->origin_x || ty < this->origin_y) return;
+
+		const uint cx = (tx - this->origin_x) / this->zoom;
+		const uint cy = (ty - this->origin_y) / this->zoom;
+		Chunk *chunk = this->chunks[(cy >> CHUNK_SHIFT) * this->chunks_x + (cx >> CHUNK_SHIFT)].get();
+		if (chunk != nullptr) ClrBit(chunk->valid[cy & (CHUNK_SIZE - 1)], cx & (CHUNK_SIZE - 1));
+	}
+
+	/** Invalidate the next slice of chunks, such that the whole cache is refreshed every #SWEEP_SLICES calls. */
+	void Sweep()
+	{
+		if (this->allocated == 0) return;
+
+		const uint count = CeilDiv((uint)this->chunks.size(), SWEEP_SLICES);
+		for (uint i = 0; i < count; i++) {
+			if (this->sweep_pos >= this->chunks.size()) this->sweep_pos = 0;
+			Chunk *chunk = this->chunks[this->sweep_pos++].get();
+			if (chunk != nullptr) MemSetT(chunk->valid, 0, CHUNK_SIZE);
+		}
+	}
+};
+
+static SmallMapColourCache _smallmap_colour_cache; ///< Tile colour cache of the smallmap window.
+
+/**
+ * Invalidate the cached smallmap colour of a tile, after it changed.
+ * @param tile The tile.
+ */
+void InvalidateSmallMapTileColour(TileIndex tile)
+{
+	_smallmap_colour_cache.InvalidateTile(tile);
+}
+
+/**
+ * Invalidate all cached smallmap colours, e.g. after a change of the colour scheme.
+ */
+void InvalidateSmallMapColourCache()
+{
+	_smallmap_colour_cache.Clear();
+}
+
 /** Vehicle colours in #SMT_VEHICLES mode. Indexed by #VehicleType. */
 static const byte _vehicle_type_colours[6] = {
 	PC_RED, PC_YELLOW, PC_LIGHT_BLUE, PC_WHITE, PC_BLACK, PC_RED
@@ -863,9 +1005,10 @@ inline uint32 SmallMapWindow::GetTileColours(const TileArea &ta) const
  * @param start_pos Position of first pixel to draw.
  * @param end_pos Position of last pixel to draw (exclusive).
  * @param blitter current blitter
+ * @param use_cache Use and fill the smallmap colour cache.
  * @note If pixel position is below \c 0, skip drawing.
  */
-void SmallMapWindow::DrawSmallMapColumn(void *dst, uint xc, uint yc, int pitch, int reps, int start_pos, int end_pos, Blitter *blitter) const
+void SmallMapWindow::DrawSmallMapColumn(void *dst, uint xc, uint yc, int pitch, int reps, int start_pos, int end_pos, Blitter *blitter, bool use_cache) const
 {
 	void *dst_ptr_abs_end = blitter->MoveTo(_screen.dst_ptr, 0, _screen.height);
 	uint min_xy = _settings_game.construction.freeform_edges ? 1 : 0;
@@ -889,7 +1032,7 @@ void SmallMapWindow::DrawSmallMapColumn(void *dst, uint xc, uint yc, int pitch,
 		}
 		ta.ClampToMap(); // Clamp to map boundaries (may contain MP_VOID tiles!).
 
-		uint32 val = this->GetTileColours(ta);
+		uint32 val = use_cache ? _smallmap_colour_cache.GetColour(xc, yc, [&]() { return this->GetTileColours(ta); }) : this->GetTileColours(ta);
 		uint8 *val8 = (uint8 *)&val;
 		int idx = std::max(0, -start_pos);
 		for (int pos = std::max(0, start_pos); pos < end_pos; pos++) {
@@ -996,9 +1139,14 @@ void SmallMapWindow::DrawMapIndicators() const
  * <ol><li>The colours of tiles in the different modes.</li>
  * <li>Town names (optional)</li></ol>
  *
+ * The tile colours are taken from the smallmap colour cache, unless \a use_cache is false
+ * or a blinking industry is highlighted.
+ *
  * @param dpi pointer to pixel to write onto
+ * @param draw_indicators Draw the position of the main viewport.
+ * @param use_cache Use and fill the smallmap colour cache.
  */
-void SmallMapWindow::DrawSmallMap(DrawPixelInfo *dpi, bool draw_indicators) const
+void SmallMapWindow::DrawSmallMap(DrawPixelInfo *dpi, bool draw_indicators, bool use_cache) const
 {
 	Blitter *blitter = BlitterFactory::GetCurrentBlitter();
 	DrawPixelInfo *old_dpi;
@@ -1015,6 +1163,16 @@ void SmallMapWindow::DrawSmallMap(DrawPixelInfo *dpi, bool draw_indicators) cons
 	int tile_x = this->scroll_x / (int)TILE_SIZE + tile.x;
 	int tile_y = this->scroll_y / (int)TILE_SIZE + tile.y;
 
+	if (this->map_type == SMT_INDUSTRY && _smallmap_industry_highlight != INVALID_INDUSTRYTYPE) use_cache = false;
+	if (use_cache) {
+		/* All drawn cells start at tile coordinates which are congruent to the scroll position modulo the zoom level. */
+		auto cell_origin = [&](int32 scroll) -> uint {
+			int origin = (scroll / (int)TILE_SIZE) % this->zoom;
+			return origin < 0 ? origin + this->zoom : origin;
+		};
+		_smallmap_colour_cache.Setup(this->map_type, this->zoom, cell_origin(this->scroll_x), cell_origin(this->scroll_y));
+	}
+
 	void *ptr = blitter->MoveTo(dpi->dst_ptr, -dx - 4, 0);
 	int x = - dx - 4;
 	int y = 0;
@@ -1027,7 +1185,7 @@ void SmallMapWindow::DrawSmallMap(DrawPixelInfo *dpi, bool draw_indicators) cons
 			int end_pos = std::min(dpi->width, x + 4);
 			int reps = (dpi->height - y + 1) / 2; // Number of lines.
 			if (reps > 0) {
-				this->DrawSmallMapColumn(ptr, tile_x, tile_y, dpi->pitch * 2, reps, x, end_pos, blitter);
+				this->DrawSmallMapColumn(ptr, tile_x, tile_y, dpi->pitch * 2, reps, x, end_pos, blitter, use_cache);
 			}
 		}
 
@@ -1129,6 +1287,7 @@ SmallMapWindow::~SmallMapWindow()
 {
 	delete this->overlay;
 	this->BreakIndustryChainLink();
+	InvalidateSmallMapColourCache();
 }
 
 /**
@@ -1399,6 +1558,7 @@ void SmallMapWindow::SelectLegendItem(int click_pos, LegendAndColour *legend, in
 	}
 
 	if (this->map_type == SMT_INDUSTRY) this->BreakIndustryChainLink();
+	InvalidateSmallMapColourCache();
 }
 
 /**
@@ -1551,6 +1711,7 @@ int SmallMapWindow::GetPositionOnLegend(Point pt)
 				tbl->show_on_map = (widget == WID_SM_ENABLE_ALL);
 			}
 			if (this->map_type == SMT_LINKSTATS) this->SetOverlayCargoMask();
+			InvalidateSmallMapColourCache();
 			this->SetDirty();
 			break;
 		}
@@ -1559,6 +1720,7 @@ int SmallMapWindow::GetPositionOnLegend(Point pt)
 			_smallmap_show_heightmap = !_smallmap_show_heightmap;
 			this->SetWidgetLoweredState(WID_SM_SHOW_HEIGHT, _smallmap_show_heightmap);
 			NotifyAllViewports(VPMT_INDUSTRY);
+			InvalidateSmallMapColourCache();
 			this->SetDirty();
 			break;
 
@@ -1597,6 +1759,7 @@ int SmallMapWindow::GetPositionOnLegend(Point pt)
 
 		default: NOT_REACHED();
 	}
+	InvalidateSmallMapColourCache();
 	this->SetDirty();
 }
 
@@ -1637,6 +1800,7 @@ int SmallMapWindow::GetPositionOnLegend(Point pt)
 		}
 	}
 	_smallmap_industry_highlight_state = !_smallmap_industry_highlight_state;
+	_smallmap_colour_cache.Sweep();
 
 	this->refresh.SetInterval(this->GetRefreshPeriod());
 	this->SetDirty();
@@ -1814,7 +1978,7 @@ void SmallMapWindow::ScreenshotCallbackHandler(void *buf, uint y, uint pitch, ui
 	this->scroll_y = -pos;
 
 	/* make the screenshot */
-	this->DrawSmallMap(&dpi, false);
+	this->DrawSmallMap(&dpi, false, false);
 
 	_cur_dpi = old_dpi;
 
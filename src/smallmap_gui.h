@@ -51,6 +51,8 @@ void BuildIndustriesLegend();
 void ShowSmallMap();
 void BuildLandLegend();
 void BuildOwnerLegend();
+void InvalidateSmallMapTileColour(TileIndex tile);
+void InvalidateSmallMapColourCache();
 
 /** Structure for holding relevant data for legends in small map */
 struct LegendAndColour {
@@ -182,10 +184,10 @@ protected:
 	uint PausedAdjustRefreshTimeDelta(uint delta_ms) const;
 
 	void DrawMapIndicators() const;
-	void DrawSmallMapColumn(void *dst, uint xc, uint yc, int pitch, int reps, int start_pos, int end_pos, Blitter *blitter) const;
+	void DrawSmallMapColumn(void *dst, uint xc, uint yc, int pitch, int reps, int start_pos, int end_pos, Blitter *blitter, bool use_cache) const;
 	void DrawVehicles(const DrawPixelInfo *dpi, Blitter *blitter) const;
 	void DrawTowns(const DrawPixelInfo *dpi) const;
-	void DrawSmallMap(DrawPixelInfo *dpi, bool draw_indicators = true) const;
+	void DrawSmallMap(DrawPixelInfo *dpi, bool draw_indicators = true, bool use_cache = true) const;
 
 	Point RemapTile(int tile_x, int tile_y) const;
 	Point PixelToTile(int px, int py, int *sub, bool add_sub = true) const;
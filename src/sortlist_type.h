@@ -275,7 +275,12 @@ public:
 
 		const bool desc = (this->flags & VL_DESC) != 0;
 
-		std::sort(std::vector<T>::begin(), std::vector<T>::end(), [&](const T &a, const T &b) { return desc ? compare(b, a) : compare(a, b); });
+		auto comp = [&](const T &a, const T &b) { return desc ? compare(b, a) : compare(a, b); };
+
+		/* Lists are resorted periodically, and most of the time their order has not changed since. */
+		if (std::is_sorted(std::vector<T>::begin(), std::vector<T>::end(), comp)) return true;
+
+		std::sort(std::vector<T>::begin(), std::vector<T>::end(), comp);
 		return true;
 	}
 
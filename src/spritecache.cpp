@@ -20,6 +20,7 @@
 #include "core/mem_func.hpp"
 #include "video/video_driver.hpp"
 #include "scope_info.h"
+#include "worker_thread.h"
 
 #include "table/sprites.h"
 #include "table/strings.h"
@@ -29,14 +30,29 @@
 
 #include <vector>
 #include <algorithm>
+#include <chrono>
+#include <map>
+#include <tuple>
 
 #include "safeguards.h"
 
 /* Default of 4MB spritecache */
 uint _sprite_cache_size = 4;
 
+/** Number of sprites following a sprite cache miss in the same file, which are loaded ahead of their first use. */
+uint _sprite_prefetch_ahead = 8;
+
 static size_t _spritecache_bytes_used = 0;
-static uint32 _sprite_lru_counter;
+static size_t _spritecache_bytes_peak = 0; ///< Highest value of #_spritecache_bytes_used.
+SpriteCacheStatistics _sprite_cache_stats;
+
+static const uint32 SPRITE_LRU_NONE = UINT32_MAX; ///< End of the sprite LRU list.
+static uint32 _sprite_lru_head = SPRITE_LRU_NONE; ///< Most recently used sprite in the sprite LRU list.
+static uint32 _sprite_lru_tail = SPRITE_LRU_NONE; ///< Least recently used sprite in the sprite LRU list.
+
+static const size_t SPRITE_PREFETCH_QUEUE_MAX = 256; ///< Maximum number of sprite cache misses queued for prefetching.
+static const std::chrono::microseconds SPRITE_PREFETCH_TIME_BUDGET(1000); ///< Maximum time spent prefetching sprites per game loop.
+static std::vector<SpriteID> _sprite_prefetch_queue; ///< Sprite cache misses whose following sprites are still to be prefetched.
 
 PACK_N(class SpriteDataBuffer {
 	void *ptr = nullptr;
@@ -53,6 +69,7 @@ public:
 		this->ptr = MallocT<byte>(size);
 		this->size = size;
 		_spritecache_bytes_used += this->size;
+		_spritecache_bytes_peak = std::max(_spritecache_bytes_peak, _spritecache_bytes_used);
 	}
 
 	void Clear()
@@ -93,7 +110,8 @@ PACK_N(struct SpriteCache {
 	size_t file_pos;
 	SpriteDataBuffer buffer;
 	uint32 id;
-	uint32 lru;
+	uint32 lru_prev = SPRITE_LRU_NONE; ///< Next more recently used sprite in the sprite LRU list.
+	uint32 lru_next = SPRITE_LRU_NONE; ///< Next less recently used sprite in the sprite LRU list.
 	uint count;
 
 	SpriteType type;     ///< In some cases a single sprite is misused by two NewGRFs. Once as real sprite and once as recolour sprite. If the recolour sprite gets into the cache it might be drawn as real sprite which causes enormous trouble.
@@ -113,6 +131,22 @@ static std::vector<SpriteCache> _spritecache;
 static SpriteDataBuffer _last_sprite_allocation;
 static std::vector<std::unique_ptr<SpriteFile>> _sprite_files;
 
+/** Encoded sprite kept from before the sprites were reloaded, see GfxInitSpriteMem. */
+struct RetainedSprite {
+	SpriteDataBuffer buffer;
+	uint count;
+	byte flags;
+};
+
+/** Retained encoded sprites of a single sprite file, by file position. */
+typedef std::map<size_t, RetainedSprite> RetainedSpriteFileMap;
+
+/** Retained encoded sprites, by file name, file size and whether the file needs palette remapping. */
+static std::map<std::tuple<std::string, size_t, bool>, RetainedSpriteFileMap> _retained_sprites;
+static const SpriteFile *_retained_sprites_last_file = nullptr;      ///< File of the last lookup in #_retained_sprites.
+static RetainedSpriteFileMap *_retained_sprites_last_map = nullptr; ///< Result of the last lookup in #_retained_sprites.
+static uint _retained_sprites_reused = 0;                            ///< Number of retained sprites reused by the current reload.
+
 static inline SpriteCache *GetSpriteCache(uint index)
 {
 	return &_spritecache[index];
@@ -123,6 +157,74 @@ static inline bool IsMapgenSpriteID(SpriteID sprite)
 	return IsInsideMM(sprite, 4845, 4882);
 }
 
+/**
+ * Check whether a sprite is in the sprite LRU list.
+ * Only sprites whose data is in the sprite cache, other than recolour sprites, are in the list.
+ * @param index Sprite to check.
+ * @return Whether the sprite is in the list.
+ */
+static inline bool IsInSpriteLRU(uint index)
+{
+	return GetSpriteCache(index)->lru_prev != SPRITE_LRU_NONE || _sprite_lru_head == index;
+}
+
+/**
+ * Remove a sprite from the sprite LRU list.
+ * @param index Sprite to remove, this must be in the list.
+ */
+static void UnlinkSpriteLRU(uint index)
+{
+	SpriteCache *sc = GetSpriteCache(index);
+	if (sc->lru_prev != SPRITE_LRU_NONE) {
+		GetSpriteCache(sc->lru_prev)->lru_next = sc->lru_next;
+	} else {
+		_sprite_lru_head = sc->lru_next;
+	}
+	if (sc->lru_next != SPRITE_LRU_NONE) {
+		GetSpriteCache(sc->lru_next)->lru_prev = sc->lru_prev;
+	} else {
+		_sprite_lru_tail = sc->lru_prev;
+	}
+	sc->lru_prev = SPRITE_LRU_NONE;
+	sc->lru_next = SPRITE_LRU_NONE;
+}
+
+/**
+ * Mark a sprite as the most recently used one, adding it to the sprite LRU list if necessary.
+ * @param index Sprite to mark.
+ */
+static void TouchSpriteLRU(uint index)
+{
+	if (_sprite_lru_head == index) return;
+	if (IsInSpriteLRU(index)) UnlinkSpriteLRU(index);
+
+	SpriteCache *sc = GetSpriteCache(index);
+	sc->lru_next = _sprite_lru_head;
+	if (_sprite_lru_head != SPRITE_LRU_NONE) {
+		GetSpriteCache(_sprite_lru_head)->lru_prev = index;
+	} else {
+		_sprite_lru_tail = index;
+	}
+	_sprite_lru_head = index;
+}
+
+/**
+ * Add a sprite as the least recently used one to the sprite LRU list.
+ * This is used for prefetched sprites, so that these are the first to go if they are not used before the cache is trimmed.
+ * @param index Sprite to add, this must not be in the list.
+ */
+static void LinkSpriteLRUTail(uint index)
+{
+	SpriteCache *sc = GetSpriteCache(index);
+	sc->lru_prev = _sprite_lru_tail;
+	if (_sprite_lru_tail != SPRITE_LRU_NONE) {
+		GetSpriteCache(_sprite_lru_tail)->lru_next = index;
+	} else {
+		_sprite_lru_head = index;
+	}
+	_sprite_lru_tail = index;
+}
+
 static SpriteCache *AllocateSpriteCache(uint index)
 {
 	if (index >= _spritecache.size()) {
@@ -587,7 +689,13 @@ struct GrfSpriteOffset {
 };
 
 /** Map from sprite numbers to position in the GRF file. */
-static btree::btree_map<uint32, GrfSpriteOffset> _grf_sprite_offsets;
+typedef btree::btree_map<uint32, GrfSpriteOffset> GrfSpriteOffsetMap;
+
+/** Sprite section offsets of each GRF which has been parsed, these are kept until the sprite files are closed. */
+static std::map<const SpriteFile *, GrfSpriteOffsetMap> _grf_sprite_offset_maps;
+
+/** Sprite section offsets of the GRF currently being processed. */
+static const GrfSpriteOffsetMap *_grf_sprite_offsets = nullptr;
 
 /**
  * Get the file offset for a specific sprite in the sprite section of a GRF.
@@ -596,62 +704,106 @@ static btree::btree_map<uint32, GrfSpriteOffset> _grf_sprite_offsets;
  */
 size_t GetGRFSpriteOffset(uint32 id)
 {
-	auto iter = _grf_sprite_offsets.find(id);
-	return iter != _grf_sprite_offsets.end() ? iter->second.file_pos : SIZE_MAX;
+	if (_grf_sprite_offsets == nullptr) return SIZE_MAX;
+	auto iter = _grf_sprite_offsets->find(id);
+	return iter != _grf_sprite_offsets->end() ? iter->second.file_pos : SIZE_MAX;
 }
 
 /**
- * Parse the sprite section of GRFs.
- * @param container_version Container version of the GRF we're currently processing.
+ * Parse the sprite section of a GRF.
+ * The file must be positioned at the sprite section offset, after the header. The position is restored afterwards.
+ * @param file GRF to parse, this must have container version 2 or later.
+ * @param offsets Map to fill with the file offsets of each sprite.
  */
-void ReadGRFSpriteOffsets(SpriteFile &file)
+static void ParseGRFSpriteOffsets(SpriteFile &file, GrfSpriteOffsetMap &offsets)
 {
-	_grf_sprite_offsets.clear();
-
-	if (file.GetContainerVersion() >= 2) {
-		/* Seek to sprite section of the GRF. */
-		size_t data_offset = file.ReadDword();
-		size_t old_pos = file.GetPos();
-		file.SeekTo(data_offset, SEEK_CUR);
-
-		GrfSpriteOffset offset = { 0, 0, 0 };
-
-		/* Loop over all sprite section entries and store the file
-		 * offset for each newly encountered ID. */
-		uint32 id, prev_id = 0;
-		while ((id = file.ReadDword()) != 0) {
-			if (id != prev_id) {
-				_grf_sprite_offsets[prev_id] = offset;
-				offset.file_pos = file.GetPos() - 4;
-				offset.count = 0;
-				offset.control_flags = 0;
-			}
-			offset.count++;
-			prev_id = id;
-			uint length = file.ReadDword();
+	/* Seek to sprite section of the GRF. */
+	size_t data_offset = file.ReadDword();
+	size_t old_pos = file.GetPos();
+	file.SeekTo(data_offset, SEEK_CUR);
+
+	GrfSpriteOffset offset = { 0, 0, 0 };
+
+	/* Loop over all sprite section entries and store the file
+	 * offset for each newly encountered ID. */
+	uint32 id, prev_id = 0;
+	while ((id = file.ReadDword()) != 0) {
+		if (id != prev_id) {
+			offsets[prev_id] = offset;
+			offset.file_pos = file.GetPos() - 4;
+			offset.count = 0;
+			offset.control_flags = 0;
+		}
+		offset.count++;
+		prev_id = id;
+		uint length = file.ReadDword();
+		if (length > 0) {
+			byte colour = file.ReadByte() & SCC_MASK;
+			if (colour != SCC_PAL) SetBit(offset.control_flags, SCCF_HAS_NON_PALETTE);
+			length--;
 			if (length > 0) {
-				byte colour = file.ReadByte() & SCC_MASK;
-				if (colour != SCC_PAL) SetBit(offset.control_flags, SCCF_HAS_NON_PALETTE);
+				byte zoom = file.ReadByte();
 				length--;
-				if (length > 0) {
-					byte zoom = file.ReadByte();
-					length--;
-					if (colour != 0 && zoom == 0) { // ZOOM_LVL_OUT_4X (normal zoom)
-						SetBit(offset.control_flags, (colour != SCC_PAL) ? SCCF_ALLOW_ZOOM_MIN_1X_32BPP : SCCF_ALLOW_ZOOM_MIN_1X_PAL);
-						SetBit(offset.control_flags, (colour != SCC_PAL) ? SCCF_ALLOW_ZOOM_MIN_2X_32BPP : SCCF_ALLOW_ZOOM_MIN_2X_PAL);
-					}
-					if (colour != 0 && zoom == 2) { // ZOOM_LVL_OUT_2X (2x zoomed in)
-						SetBit(offset.control_flags, (colour != SCC_PAL) ? SCCF_ALLOW_ZOOM_MIN_2X_32BPP : SCCF_ALLOW_ZOOM_MIN_2X_PAL);
-					}
+				if (colour != 0 && zoom == 0) { // ZOOM_LVL_OUT_4X (normal zoom)
+					SetBit(offset.control_flags, (colour != SCC_PAL) ? SCCF_ALLOW_ZOOM_MIN_1X_32BPP : SCCF_ALLOW_ZOOM_MIN_1X_PAL);
+					SetBit(offset.control_flags, (colour != SCC_PAL) ? SCCF_ALLOW_ZOOM_MIN_2X_32BPP : SCCF_ALLOW_ZOOM_MIN_2X_PAL);
+				}
+				if (colour != 0 && zoom == 2) { // ZOOM_LVL_OUT_2X (2x zoomed in)
+					SetBit(offset.control_flags, (colour != SCC_PAL) ? SCCF_ALLOW_ZOOM_MIN_2X_32BPP : SCCF_ALLOW_ZOOM_MIN_2X_PAL);
 				}
 			}
-			file.SkipBytes(length);
 		}
-		if (prev_id != 0) _grf_sprite_offsets[prev_id] = offset;
+		file.SkipBytes(length);
+	}
+	if (prev_id != 0) offsets[prev_id] = offset;
+
+	/* Continue processing the data section. */
+	file.SeekTo(old_pos, SEEK_SET);
+}
+
+/**
+ * Parse the sprite section of GRFs.
+ * The offsets of each file are only parsed once, later calls for the same file reuse these.
+ * @param file GRF we're currently processing, positioned at the sprite section offset.
+ */
+void ReadGRFSpriteOffsets(SpriteFile &file)
+{
+	_grf_sprite_offsets = nullptr;
+
+	if (file.GetContainerVersion() >= 2) {
+		auto iter = _grf_sprite_offset_maps.find(&file);
+		if (iter != _grf_sprite_offset_maps.end()) {
+			/* Skip sprite section offset, the sprite section is already parsed. */
+			file.ReadDword();
+		} else {
+			iter = _grf_sprite_offset_maps.emplace(&file, GrfSpriteOffsetMap()).first;
+			ParseGRFSpriteOffsets(file, iter->second);
+		}
+		_grf_sprite_offsets = &(iter->second);
+	}
+}
 
-		/* Continue processing the data section. */
-		file.SeekTo(old_pos, SEEK_SET);
+/**
+ * Parse the sprite sections of all opened GRFs which have not been parsed yet, in parallel.
+ * The files are independent of each other, so this can be done ahead of the order dependent loading stages.
+ */
+void PrescanGRFSpriteOffsets()
+{
+	std::vector<std::pair<SpriteFile *, GrfSpriteOffsetMap *>> todo;
+	for (auto &file : _sprite_files) {
+		if (file->GetContainerVersion() < 2 || _grf_sprite_offset_maps.find(file.get()) != _grf_sprite_offset_maps.end()) continue;
+		todo.emplace_back(file.get(), &(_grf_sprite_offset_maps[file.get()]));
 	}
+	if (todo.empty()) return;
+
+	_general_worker_pool.ParallelFor(todo.size(), 1, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i != end; i++) {
+			todo[i].first->SeekToBegin();
+			ParseGRFSpriteOffsets(*todo[i].first, *todo[i].second);
+		}
+	});
+
+	DEBUG(grf, 2, "PrescanGRFSpriteOffsets: parsed the sprite sections of " PRINTF_SIZE " files", todo.size());
 }
 
 
@@ -694,11 +846,16 @@ bool LoadNextSprite(int load_index, SpriteFile &file, uint file_sprite_id)
 			return false;
 		}
 		/* It is not an error if no sprite with the provided ID is found in the sprite section. */
-		auto iter = _grf_sprite_offsets.find(file.ReadDword());
-		if (iter != _grf_sprite_offsets.end()) {
-			file_pos = iter->second.file_pos;
-			count = iter->second.count;
-			control_flags = iter->second.control_flags;
+		const uint32 id = file.ReadDword();
+		const GrfSpriteOffset *offset = nullptr;
+		if (_grf_sprite_offsets != nullptr) {
+			auto iter = _grf_sprite_offsets->find(id);
+			if (iter != _grf_sprite_offsets->end()) offset = &(iter->second);
+		}
+		if (offset != nullptr) {
+			file_pos = offset->file_pos;
+			count = offset->count;
+			control_flags = offset->control_flags;
 		} else {
 			file_pos = SIZE_MAX;
 		}
@@ -729,6 +886,7 @@ bool LoadNextSprite(int load_index, SpriteFile &file, uint file_sprite_id)
 	}
 
 	SpriteCache *sc = AllocateSpriteCache(load_index);
+	if (IsInSpriteLRU(load_index)) UnlinkSpriteLRU(load_index);
 	sc->file = &file;
 	sc->file_pos = file_pos;
 	if (data != nullptr) {
@@ -737,12 +895,30 @@ bool LoadNextSprite(int load_index, SpriteFile &file, uint file_sprite_id)
 	} else {
 		sc->buffer.Clear();
 	}
-	sc->lru = 0;
 	sc->id = file_sprite_id;
 	sc->count = count;
 	sc->SetType(type);
 	sc->flags = control_flags;
 
+	if (type == ST_NORMAL && data == nullptr && !_retained_sprites.empty()) {
+		if (_retained_sprites_last_file != &file) {
+			auto iter = _retained_sprites.find(std::make_tuple(file.GetFilename(), file.GetFileSize(), file.NeedsPaletteRemap()));
+			_retained_sprites_last_file = &file;
+			_retained_sprites_last_map = (iter != _retained_sprites.end()) ? &(iter->second) : nullptr;
+		}
+		if (_retained_sprites_last_map != nullptr) {
+			auto iter = _retained_sprites_last_map->find(file_pos);
+			if (iter != _retained_sprites_last_map->end()) {
+				if (iter->second.count == count && iter->second.flags == control_flags) {
+					sc->buffer = std::move(iter->second.buffer);
+					LinkSpriteLRUTail(load_index);
+					_retained_sprites_reused++;
+				}
+				_retained_sprites_last_map->erase(iter);
+			}
+		}
+	}
+
 	return true;
 }
 
@@ -760,101 +936,108 @@ void DupSprite(SpriteID old_spr, SpriteID new_spr)
 	scnew->SetWarned(false);
 }
 
-static size_t GetSpriteCacheUsage()
+/**
+ * Get the number of bytes of sprite data currently in the sprite cache.
+ * @return Bytes in use.
+ */
+size_t GetSpriteCacheUsage()
 {
 	return _spritecache_bytes_used;
 }
 
+/**
+ * Get the highest number of bytes of sprite data which has been in the sprite cache.
+ * @return Peak bytes in use.
+ */
+size_t GetSpriteCachePeakUsage()
+{
+	return _spritecache_bytes_peak;
+}
+
+/**
+ * Get the number of bytes of sprite data which the sprite cache is trimmed down to, see the sprite_cache_size_px setting.
+ * @return Target size in bytes.
+ */
+size_t GetSpriteCacheTargetSize()
+{
+	int bpp = BlitterFactory::GetCurrentBlitter()->GetScreenDepth();
+	return (size_t)(bpp > 0 ? _sprite_cache_size * bpp / 8 : 1) * 1024 * 1024;
+}
+
 /**
  * Delete a single entry from the sprite cache.
  * @param item Entry to delete.
  */
 static void DeleteEntryFromSpriteCache(uint item)
 {
+	if (IsInSpriteLRU(item)) UnlinkSpriteLRU(item);
 	GetSpriteCache(item)->buffer.Clear();
 }
 
+/**
+ * Delete the least recently used sprites from the sprite cache.
+ * @param target Number of bytes to free.
+ */
 static void DeleteEntriesFromSpriteCache(size_t target)
 {
 	const size_t initial_in_use = GetSpriteCacheUsage();
 
-	struct SpriteInfo {
-		uint32 lru;
-		SpriteID id;
-		uint32 size;
-
-		bool operator<(const SpriteInfo &other) const
-		{
-			return this->lru < other.lru;
-		}
-	};
-	std::vector<SpriteInfo> candidates;
-	size_t candidate_bytes = 0;
-
-	auto push = [&](SpriteInfo info) {
-		candidates.push_back(info);
-		std::push_heap(candidates.begin(), candidates.end());
-		candidate_bytes += info.size;
-	};
+	uint deleted = 0;
+	while (_sprite_lru_tail != SPRITE_LRU_NONE && initial_in_use - GetSpriteCacheUsage() < target) {
+		DeleteEntryFromSpriteCache(_sprite_lru_tail);
+		deleted++;
+	}
+	_sprite_cache_stats.evictions += deleted;
 
-	auto pop = [&]() {
-		candidate_bytes -= candidates.front().size;
-		std::pop_heap(candidates.begin(), candidates.end());
-		candidates.pop_back();
-	};
+	DEBUG(sprite, 3, "DeleteEntriesFromSpriteCache, deleted: %u, in use: " PRINTF_SIZE " --> " PRINTF_SIZE ", delta: " PRINTF_SIZE ", requested: " PRINTF_SIZE,
+			deleted, initial_in_use, GetSpriteCacheUsage(), initial_in_use - GetSpriteCacheUsage(), target);
+}
 
-	SpriteID i = 0;
-	for (; i != _spritecache.size() && candidate_bytes < target; i++) {
-		SpriteCache *sc = GetSpriteCache(i);
-		if (sc->GetType() != ST_RECOLOUR && sc->GetPtr() != nullptr) {
-			push({ sc->lru, i, sc->buffer.GetSize() });
-			if (candidate_bytes >= target) break;
-		}
-	}
-	for (; i != _spritecache.size(); i++) {
-		SpriteCache *sc = GetSpriteCache(i);
-		if (sc->GetType() != ST_RECOLOUR && sc->GetPtr() != nullptr && sc->lru <= candidates.front().lru) {
-			push({ sc->lru, i, sc->buffer.GetSize() });
-			while (!candidates.empty() && candidate_bytes - candidates.front().size >= target) {
-				pop();
-			}
+/**
+ * Load the sprites following recent sprite cache misses into the sprite cache, ahead of their first use.
+ * Sprites which are used together, such as the views and animation frames of a house or vehicle, are mostly stored consecutively in the same file.
+ * This is done from the game loop, to move the cost of reading and encoding the sprites out of viewport drawing.
+ * Prefetching stops when the time budget is used up, or when the sprite cache is full.
+ */
+void PrefetchQueuedSprites()
+{
+	if (_sprite_prefetch_queue.empty()) return;
+
+	const auto deadline = std::chrono::steady_clock::now() + SPRITE_PREFETCH_TIME_BUDGET;
+	const size_t target_size = GetSpriteCacheTargetSize();
+	size_t done = 0;
+	uint loaded = 0;
+	for (; done < _sprite_prefetch_queue.size(); done++) {
+		if (GetSpriteCacheUsage() >= target_size || std::chrono::steady_clock::now() >= deadline) break;
+
+		const SpriteID miss = _sprite_prefetch_queue[done];
+		if (miss >= _spritecache.size()) continue;
+		const SpriteFile *file = GetSpriteCache(miss)->file;
+		const SpriteID last = std::min<SpriteID>(miss + _sprite_prefetch_ahead, (SpriteID)_spritecache.size() - 1);
+		for (SpriteID id = miss + 1; id <= last; id++) {
+			SpriteCache *sc = GetSpriteCache(id);
+			if (sc->file != file) break;
+			if (sc->GetType() != ST_NORMAL || sc->GetPtr() != nullptr) continue;
+
+			void *ptr = ReadSprite(sc, id, ST_NORMAL, AllocSprite, nullptr);
+			if (ptr != _last_sprite_allocation.GetPtr()) continue;
+			sc->buffer = std::move(_last_sprite_allocation);
+			LinkSpriteLRUTail(id);
+			loaded++;
 		}
 	}
+	_sprite_prefetch_queue.erase(_sprite_prefetch_queue.begin(), _sprite_prefetch_queue.begin() + done);
+	_sprite_cache_stats.prefetches += loaded;
 
-	for (auto &it : candidates) {
-		DeleteEntryFromSpriteCache(it.id);
-	}
-
-	DEBUG(sprite, 3, "DeleteEntriesFromSpriteCache, deleted: " PRINTF_SIZE ", freed: " PRINTF_SIZE ", in use: " PRINTF_SIZE " --> " PRINTF_SIZE ", delta: " PRINTF_SIZE ", requested: " PRINTF_SIZE,
-			candidates.size(), candidate_bytes, initial_in_use, GetSpriteCacheUsage(), initial_in_use - GetSpriteCacheUsage(), target);
+	if (loaded > 0) DEBUG(sprite, 4, "PrefetchQueuedSprites, loaded: %u, remaining misses: " PRINTF_SIZE, loaded, _sprite_prefetch_queue.size());
 }
 
 void IncreaseSpriteLRU()
 {
-	int bpp = BlitterFactory::GetCurrentBlitter()->GetScreenDepth();
-	uint target_size = (bpp > 0 ? _sprite_cache_size * bpp / 8 : 1) * 1024 * 1024;
+	const size_t target_size = GetSpriteCacheTargetSize();
 	if (_spritecache_bytes_used > target_size) {
 		DeleteEntriesFromSpriteCache(_spritecache_bytes_used - target_size + 512 * 1024);
 	}
-
-	/* Increase all LRU values */
-	if (_sprite_lru_counter >= 0xC0000000) {
-		SpriteID i;
-
-		DEBUG(sprite, 3, "Fixing lru %u, inuse=" PRINTF_SIZE, _sprite_lru_counter, GetSpriteCacheUsage());
-
-		for (i = 0; i != _spritecache.size(); i++) {
-			SpriteCache *sc = GetSpriteCache(i);
-			if (sc->GetPtr() != nullptr) {
-				if (sc->lru > 0x80000000) {
-					sc->lru -= 0x80000000;
-				} else {
-					sc->lru = 0;
-				}
-			}
-		}
-		_sprite_lru_counter -= 0x80000000;
-	}
 }
 
 static void *AllocSprite(size_t mem_req)
@@ -945,16 +1128,22 @@ void *GetRawSprite(SpriteID sprite, SpriteType type, AllocatorProc *allocator, S
 	if (allocator == nullptr && encoder == nullptr) {
 		/* Load sprite into/from spritecache */
 
-		/* Update LRU */
-		sc->lru = ++_sprite_lru_counter;
-
 		/* Load the sprite, if it is not loaded, yet */
 		if (sc->GetPtr() == nullptr) {
 			void *ptr = ReadSprite(sc, sprite, type, AllocSprite, nullptr);
 			assert(ptr == _last_sprite_allocation.GetPtr());
 			sc->buffer = std::move(_last_sprite_allocation);
+			_sprite_cache_stats.misses++;
+			if (type == ST_NORMAL && _sprite_prefetch_ahead > 0 && _sprite_prefetch_queue.size() < SPRITE_PREFETCH_QUEUE_MAX) {
+				_sprite_prefetch_queue.push_back(sprite);
+			}
+		} else {
+			_sprite_cache_stats.hits++;
 		}
 
+		/* Update LRU, recolour sprites are never removed from the cache */
+		if (type != ST_RECOLOUR) TouchSpriteLRU(sprite);
+
 		return sc->GetPtr();
 	} else {
 		/* Do not use the spritecache, but a different allocator. */
@@ -1060,12 +1249,44 @@ uint32 GetSpriteMainColour(SpriteID sprite_id, PaletteID palette_id)
 	return 0;
 }
 
+/**
+ * Free the encoded sprites kept from before the sprites were reloaded, which were not reused.
+ */
+void GfxDiscardRetainedSprites()
+{
+	if (_retained_sprites.empty()) return;
+
+	size_t discarded = 0;
+	for (const auto &it : _retained_sprites) {
+		discarded += it.second.size();
+	}
+	DEBUG(sprite, 2, "Reused %u encoded sprites from before reloading sprites, discarded " PRINTF_SIZE, _retained_sprites_reused, discarded);
+
+	_retained_sprites.clear();
+	_retained_sprites_last_file = nullptr;
+	_retained_sprites_last_map = nullptr;
+	_retained_sprites_reused = 0;
+}
+
 void GfxInitSpriteMem()
 {
+	GfxDiscardRetainedSprites();
+
+	/* Keep the encoded normal sprites, so that sprites which are loaded again from the same file position need not be decoded and encoded again. */
+	for (SpriteCache &sc : _spritecache) {
+		if (sc.GetType() != ST_NORMAL || sc.GetPtr() == nullptr || sc.file == nullptr) continue;
+		RetainedSpriteFileMap &file_map = _retained_sprites[std::make_tuple(sc.file->GetFilename(), sc.file->GetFileSize(), sc.file->NeedsPaletteRemap())];
+		file_map.emplace((size_t)sc.file_pos, RetainedSprite{ std::move(sc.buffer), sc.count, (byte)(sc.flags & ~(1 << SCCF_WARNED)) });
+	}
+
 	/* Reset the spritecache 'pool' */
 	_spritecache.clear();
+	_grf_sprite_offset_maps.clear();
+	_grf_sprite_offsets = nullptr;
 	_sprite_files.clear();
-	assert(_spritecache_bytes_used == 0);
+	_sprite_lru_head = SPRITE_LRU_NONE;
+	_sprite_lru_tail = SPRITE_LRU_NONE;
+	_sprite_prefetch_queue.clear();
 }
 
 /**
@@ -1074,6 +1295,8 @@ void GfxInitSpriteMem()
  */
 void GfxClearSpriteCache()
 {
+	GfxDiscardRetainedSprites();
+
 	/* Clear sprite ptr for all cached items */
 	for (uint i = 0; i != _spritecache.size(); i++) {
 		SpriteCache *sc = GetSpriteCache(i);
@@ -32,6 +32,17 @@ enum SpriteCacheCtrlFlags {
 };
 
 extern uint _sprite_cache_size;
+extern uint _sprite_prefetch_ahead;
+
+/** Sprite cache access statistics, for the sprite_cache_stats console command and the framerate window. */
+struct SpriteCacheStatistics {
+	uint64 hits;      ///< Number of sprite requests for sprites which were already in the cache.
+	uint64 misses;    ///< Number of sprite requests which had to load and encode the sprite.
+	uint64 evictions; ///< Number of sprites removed from the cache to trim it to the configured size.
+	uint64 prefetches; ///< Number of sprites loaded into the cache ahead of their first use.
+};
+
+extern SpriteCacheStatistics _sprite_cache_stats;
 
 typedef void *AllocatorProc(size_t size);
 
@@ -60,11 +71,17 @@ static inline const byte *GetNonSprite(SpriteID sprite, SpriteType type)
 
 void GfxInitSpriteMem();
 void GfxClearSpriteCache();
+void GfxDiscardRetainedSprites();
+void PrefetchQueuedSprites();
 void IncreaseSpriteLRU();
+size_t GetSpriteCacheUsage();
+size_t GetSpriteCachePeakUsage();
+size_t GetSpriteCacheTargetSize();
 
 SpriteFile &OpenCachedSpriteFile(const std::string &filename, Subdirectory subdir, bool palette_remap);
 
 void ReadGRFSpriteOffsets(SpriteFile &file);
+void PrescanGRFSpriteOffsets();
 size_t GetGRFSpriteOffset(uint32 id);
 bool LoadNextSprite(int load_index, SpriteFile &file, uint file_sprite_id);
 bool SkipSpriteData(SpriteFile &file, byte type, uint16 num);
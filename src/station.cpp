@@ -54,6 +54,17 @@ void RebuildStationKdtree()
 	_station_kdtree.Build(stids.begin(), stids.end());
 }
 
+AirportKdtree _airport_kdtree(Kdtree_AirportXYFunc);
+
+void RebuildAirportKdtree()
+{
+	std::vector<StationID> stids;
+	for (const Station *st : Station::Iterate()) {
+		if (st->airport.tile != INVALID_TILE && st->airport.type != AT_OILRIG) stids.push_back(st->index);
+	}
+	_airport_kdtree.Build(stids.begin(), stids.end());
+}
+
 
 BaseStation::~BaseStation()
 {
@@ -117,7 +128,7 @@ Station::~Station()
 		for (NodeID node = 0; node < lg->Size(); ++node) {
 			Station *st = Station::Get((*lg)[node].Station());
 			st->goods[c].flows.erase(this->index);
-			if ((*lg)[node][this->goods[c].node].LastUpdate() != INVALID_DATE) {
+			if ((*lg)[node].HasEdgeTo(this->goods[c].node)) {
 				st->goods[c].flows.DeleteFlows(this->index);
 				RerouteCargo(st, c, this->index, st->index);
 			}
@@ -424,6 +435,7 @@ void Station::AddIndustryToDeliver(Industry *ind, TileIndex tile)
 		if (pos->distance > distance) {
 			this->industries_near.erase(pos);
 			this->industries_near.insert(IndustryListEntry{distance, ind});
+			this->IndustriesNearChanged();
 		}
 		return;
 	}
@@ -436,6 +448,7 @@ void Station::AddIndustryToDeliver(Industry *ind, TileIndex tile)
 	if (cargo_index >= lengthof(ind->accepts_cargo)) return;
 
 	this->industries_near.insert(IndustryListEntry{distance, ind});
+	this->IndustriesNearChanged();
 }
 
 /**
@@ -446,16 +459,49 @@ void Station::RemoveIndustryToDeliver(Industry *ind) {
 	auto pos = std::find_if(this->industries_near.begin(), this->industries_near.end(), [&](const IndustryListEntry &e) { return e.industry->index == ind->index; });
 	if (pos != this->industries_near.end()) {
 		this->industries_near.erase(pos);
+		this->IndustriesNearChanged();
 	}
 }
 
+/**
+ * Get the industries near the station which accept a cargo, in the order of industries_near.
+ * The per cargo lists are built from industries_near when it changed.
+ * @param cargo Cargo to get the accepting industries for.
+ * @return Range of the industries accepting the cargo.
+ */
+std::pair<std::vector<IndustryCargoListEntry>::const_iterator, std::vector<IndustryCargoListEntry>::const_iterator> Station::GetIndustriesNearAccepting(CargoID cargo) const
+{
+	if (!this->industries_near_cargo_valid) {
+		this->industries_near_cargo.clear();
+		for (const IndustryListEntry &entry : this->industries_near) {
+			Industry *ind = entry.industry;
+			for (uint cargo_index = 0; cargo_index < lengthof(ind->accepts_cargo); cargo_index++) {
+				CargoID c = ind->accepts_cargo[cargo_index];
+				if (c == CT_INVALID) continue;
+				/* Only the first slot accepting a cargo is used. */
+				if (std::find(ind->accepts_cargo, ind->accepts_cargo + cargo_index, c) != ind->accepts_cargo + cargo_index) continue;
+				this->industries_near_cargo.push_back({ c, (uint8)cargo_index, ind });
+			}
+		}
+		std::stable_sort(this->industries_near_cargo.begin(), this->industries_near_cargo.end(), [](const IndustryCargoListEntry &a, const IndustryCargoListEntry &b) {
+			return a.cargo < b.cargo;
+		});
+		this->industries_near_cargo_valid = true;
+	}
+
+	return std::equal_range(this->industries_near_cargo.begin(), this->industries_near_cargo.end(), IndustryCargoListEntry{ cargo, 0, nullptr },
+			[](const IndustryCargoListEntry &a, const IndustryCargoListEntry &b) { return a.cargo < b.cargo; });
+}
+
 
 /**
  * Remove this station from the nearby stations lists of all towns and industries.
  */
 void Station::RemoveFromAllNearbyLists()
 {
-	for (Town *t : Town::Iterate()) { t->stations_near.erase(this); }
+	for (Town *t : Town::Iterate()) {
+		if (t->stations_near.erase(this) != 0) t->InvalidateStationsNearBlocks();
+	}
 	for (Industry *i : Industry::Iterate()) { i->stations_near.erase(this); }
 }
 
@@ -481,7 +527,9 @@ bool Station::CatchmentCoversTown(TownID t) const
  */
 void Station::RecomputeCatchment(bool no_clear_nearby_lists)
 {
+	this->acceptance_cache_valid = false;
 	this->industries_near.clear();
+	this->IndustriesNearChanged();
 	if (!no_clear_nearby_lists) this->RemoveFromAllNearbyLists();
 
 	if (this->rect.IsEmpty()) {
@@ -538,7 +586,7 @@ void Station::RecomputeCatchment(bool no_clear_nearby_lists)
 	for (TileIndex tile = it; tile != INVALID_TILE; tile = ++it) {
 		if (IsTileType(tile, MP_HOUSE)) {
 			Town *t = Town::GetByTile(tile);
-			t->stations_near.insert(this);
+			if (t->stations_near.insert(this).second) t->InvalidateStationsNearBlocks();
 		}
 		if (IsTileType(tile, MP_INDUSTRY)) {
 			Industry *i = Industry::GetByTile(tile);
@@ -560,7 +608,10 @@ void Station::RecomputeCatchment(bool no_clear_nearby_lists)
  */
 /* static */ void Station::RecomputeCatchmentForAll()
 {
-	for (Town *t : Town::Iterate()) { t->stations_near.clear(); }
+	for (Town *t : Town::Iterate()) {
+		t->stations_near.clear();
+		t->InvalidateStationsNearBlocks();
+	}
 	for (Industry *i : Industry::Iterate()) { i->stations_near.clear(); }
 	for (Station *st : Station::Iterate()) { st->RecomputeCatchment(true); }
 }
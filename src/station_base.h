@@ -799,6 +799,13 @@ struct IndustryCompare {
 
 typedef btree::btree_set<IndustryListEntry, IndustryCompare> IndustryList;
 
+/** Entry of the industries near a station split up per accepted cargo, see Station::GetIndustriesNearAccepting. */
+struct IndustryCargoListEntry {
+	CargoID cargo;      ///< Cargo accepted by the industry.
+	uint8 cargo_index;  ///< Index of the cargo in the accepted cargoes of the industry.
+	Industry *industry; ///< The industry.
+};
+
 /** Station data structure */
 struct Station FINAL : SpecializedStation<Station, false> {
 public:
@@ -825,6 +832,12 @@ public:
 	BitmapTileArea catchment_tiles; ///< NOSAVE: Set of individual tiles covered by catchment area
 	uint station_tiles;             ///< NOSAVE: Count of station tiles owned by this station
 
+	CargoArray cached_acceptance;             ///< NOSAVE: Acceptance of the catchment tiles without acceptance callbacks when last calculated, see acceptance_cache_epoch
+	CargoTypes cached_always_accepted = 0;    ///< NOSAVE: Cargoes always accepted by the catchment tiles without acceptance callbacks when last calculated
+	std::vector<TileIndex> dynamic_acceptance_tiles; ///< NOSAVE: Catchment tiles with acceptance callbacks, which are evaluated on every calculation
+	uint64 acceptance_cache_epoch = 0;        ///< NOSAVE: Map change generation (MCC_ACCEPTANCE) at which the cached acceptance was calculated
+	bool acceptance_cache_valid = false;      ///< NOSAVE: Whether the cached acceptance may be used
+
 	StationHadVehicleOfType had_vehicle_of_type;
 
 	byte time_since_load;
@@ -835,6 +848,8 @@ public:
 	CargoTypes always_accepted;       ///< Bitmask of always accepted cargo types (by houses, HQs, industry tiles when industry doesn't accept cargo)
 
 	IndustryList industries_near; ///< Cached list of industries near the station that can accept cargo, @see DeliverGoodsToIndustry()
+	mutable std::vector<IndustryCargoListEntry> industries_near_cargo; ///< NOSAVE: industries_near per accepted cargo, sorted by cargo and then like industries_near
+	mutable bool industries_near_cargo_valid = false;                  ///< NOSAVE: Whether industries_near_cargo is up to date with industries_near
 	Industry *industry;           ///< NOSAVE: Associated industry for neutral stations. (Rebuilt on load from Industry->st)
 
 	CargoTypes station_cargo_history_cargoes;                                              ///< Bitmask of cargoes in station_cargo_history
@@ -873,6 +888,11 @@ public:
 	void RemoveIndustryToDeliver(Industry *ind);
 	void RemoveFromAllNearbyLists();
 
+	/** Note that industries_near was changed, so that the per cargo lists are built again when used. */
+	inline void IndustriesNearChanged() { this->industries_near_cargo_valid = false; }
+
+	std::pair<std::vector<IndustryCargoListEntry>::const_iterator, std::vector<IndustryCargoListEntry>::const_iterator> GetIndustriesNearAccepting(CargoID cargo) const;
+
 	inline bool TileIsInCatchment(TileIndex tile) const
 	{
 		return this->catchment_tiles.HasTile(tile);
@@ -931,6 +951,7 @@ public:
 };
 
 void RebuildStationKdtree();
+void RebuildAirportKdtree();
 
 /**
  * Call a function on all stations that have any part of the requested area within their catchment.
@@ -60,10 +60,13 @@
 #include "cheat_type.h"
 #include "newgrf_roadstop.h"
 #include "core/math_func.hpp"
+#include "core/checksum_func.hpp"
+#include "map_change_journal.h"
 
 #include "table/strings.h"
 
 #include "3rdparty/cpp-btree/btree_set.h"
+#include "trace.h"
 
 #include <bitset>
 
@@ -641,21 +644,93 @@ CargoArray GetAcceptanceAroundTiles(TileIndex center_tile, int w, int h, int rad
 	return acceptance;
 }
 
+/**
+ * Note that the cargo accepted by a tile may have changed, so that the cached acceptance
+ * of stations with this tile in their catchment is not used anymore.
+ * @param tile Changed tile.
+ */
+void MarkTileAcceptanceChanged(TileIndex tile)
+{
+	MarkMapRegionChanged(MCC_ACCEPTANCE, tile);
+}
+
+/** Note that the cargo accepted by any tile may have changed, e.g. because the NewGRFs were reloaded. */
+void MarkAllTileAcceptanceChanged()
+{
+	MarkAllMapRegionsChanged(MCC_ACCEPTANCE);
+}
+
+/**
+ * Check whether the cached acceptance of a station may be used.
+ * @param st Station to check.
+ * @return True if no tile in the catchment of the station changed since the acceptance was cached.
+ */
+static bool IsAcceptanceCacheValid(const Station *st)
+{
+	if (!st->acceptance_cache_valid) return false;
+
+	return !HasMapAreaChangedSince(MCC_ACCEPTANCE, st->catchment_tiles, st->acceptance_cache_epoch);
+}
+
+/**
+ * Check whether the cargo accepted by a tile can change without the tile itself changing,
+ * i.e. whether it is decided by NewGRF callbacks.
+ * @param tile Tile to check.
+ * @return True if the acceptance of the tile is dynamic.
+ */
+static bool HasDynamicAcceptance(TileIndex tile)
+{
+	switch (GetTileType(tile)) {
+		case MP_HOUSE: {
+			const uint16 mask = HouseSpec::Get(GetHouseType(tile))->callback_mask;
+			return HasBit(mask, CBM_HOUSE_ACCEPT_CARGO) || HasBit(mask, CBM_HOUSE_CARGO_ACCEPTANCE);
+		}
+
+		case MP_INDUSTRY: {
+			const uint8 mask = GetIndustryTileSpec(GetIndustryGfx(tile))->callback_mask;
+			return HasBit(mask, CBM_INDT_ACCEPT_CARGO) || HasBit(mask, CBM_INDT_CARGO_ACCEPTANCE);
+		}
+
+		default:
+			return false;
+	}
+}
+
 /**
  * Get the acceptance of cargoes around the station in.
+ * The acceptance of the tiles without acceptance callbacks is cached in the station, and only
+ * calculated again when a tile in its catchment changed. The tiles with acceptance callbacks
+ * are remembered, and only their callbacks are run again.
  * @param st Station to get acceptance of.
- * @param always_accepted bitmask of cargo accepted by houses and headquarters; can be nullptr
+ * @param always_accepted bitmask of cargo accepted by houses and headquarters
  */
-static CargoArray GetAcceptanceAroundStation(const Station *st, CargoTypes *always_accepted)
+static CargoArray GetAcceptanceAroundStation(Station *st, CargoTypes *always_accepted)
 {
-	CargoArray acceptance;
-	if (always_accepted != nullptr) *always_accepted = 0;
+	if (!IsAcceptanceCacheValid(st)) {
+		CargoArray static_acceptance;
+		CargoTypes static_always_accepted = 0;
+		st->dynamic_acceptance_tiles.clear();
 
-	BitmapTileIterator it(st->catchment_tiles);
-	for (TileIndex tile = it; tile != INVALID_TILE; tile = ++it) {
-		AddAcceptedCargo(tile, acceptance, always_accepted);
+		BitmapTileIterator it(st->catchment_tiles);
+		for (TileIndex tile = it; tile != INVALID_TILE; tile = ++it) {
+			if (HasDynamicAcceptance(tile)) {
+				st->dynamic_acceptance_tiles.push_back(tile);
+			} else {
+				AddAcceptedCargo(tile, static_acceptance, &static_always_accepted);
+			}
+		}
+
+		st->cached_acceptance = static_acceptance;
+		st->cached_always_accepted = static_always_accepted;
+		st->acceptance_cache_epoch = GetMapChangeGeneration(MCC_ACCEPTANCE);
+		st->acceptance_cache_valid = true;
 	}
 
+	CargoArray acceptance = st->cached_acceptance;
+	*always_accepted = st->cached_always_accepted;
+	for (TileIndex tile : st->dynamic_acceptance_tiles) {
+		AddAcceptedCargo(tile, acceptance, always_accepted);
+	}
 	return acceptance;
 }
 
@@ -2810,6 +2885,7 @@ CommandCost CmdBuildAirport(TileIndex tile, DoCommandFlag flags, uint32 p1, uint
 			}
 
 			st->rect.AfterRemoveRect(st, st->airport);
+			_airport_kdtree.Remove(st->index);
 			st->airport.Clear();
 		}
 
@@ -2831,6 +2907,7 @@ CommandCost CmdBuildAirport(TileIndex tile, DoCommandFlag flags, uint32 p1, uint
 
 			if (AirportTileSpec::Get(GetTranslatedAirportTileID(iter.GetStationGfx()))->animation.status != ANIM_STATUS_NO_ANIMATION) AddAnimatedTile(iter);
 		}
+		_airport_kdtree.Insert(st->index);
 
 		/* Only call the animation trigger after all tiles have been built */
 		for (AirportTileTableIterator iter(as->table[layout], tile); iter != INVALID_TILE; ++iter) {
@@ -2909,6 +2986,7 @@ static CommandCost RemoveAirport(TileIndex tile, DoCommandFlag flags)
 
 		st->rect.AfterRemoveRect(st, st->airport);
 
+		if (st->airport.type != AT_OILRIG) _airport_kdtree.Remove(st->index);
 		st->airport.Clear();
 		st->facilities &= ~FACIL_AIRPORT;
 
@@ -4216,6 +4294,38 @@ int GetTargetRating(const Station *st, const CargoSpec *cs, const GoodsEntry *ge
 	return Clamp(rating, 0, 255);
 }
 
+/**
+ * Calculate the target ratings of several cargoes at a station.
+ * The target rating of a cargo only depends on its own goods entry and on the station,
+ * so they can be calculated in one pass before any of the ratings or cargo are changed.
+ * Cargoes without a NewGRF rating callback take a fast path, which shares the terms
+ * depending on the station only; the others go through GetTargetRating.
+ * @param st Station to get the ratings for.
+ * @param cargoes Cargoes to get the ratings for.
+ * @param[out] target_ratings Target rating of each cargo, indexed by cargo ID.
+ */
+static void GetTargetRatings(const Station *st, CargoTypes cargoes, int *target_ratings)
+{
+	if (_extra_cheats.station_rating.value) {
+		for (CargoID c : SetCargoBitIterator(cargoes)) target_ratings[c] = 255;
+		return;
+	}
+
+	const int statue_rating = GetStatueRating(st);
+	for (CargoID c : SetCargoBitIterator(cargoes)) {
+		const CargoSpec *cs = CargoSpec::Get(c);
+		const GoodsEntry *ge = &st->goods[c];
+		if (HasBit(cs->callback_mask, CBM_CARGO_STATION_RATING_CALC)) {
+			target_ratings[c] = GetTargetRating(st, cs, ge);
+			continue;
+		}
+
+		int rating = GetSpeedRating(ge) + GetWaitTimeRating(cs, ge) + GetWaitingCargoRating(st, ge);
+		rating += statue_rating + GetVehicleAgeRating(ge);
+		target_ratings[c] = Clamp(rating, 0, 255);
+	}
+}
+
 static void UpdateStationRating(Station *st)
 {
 	bool waiting_changed = false;
@@ -4223,6 +4333,8 @@ static void UpdateStationRating(Station *st)
 	byte_inc_sat(&st->time_since_load);
 	byte_inc_sat(&st->time_since_unload);
 
+	/* First update the counters of all cargoes and find their target ratings. */
+	CargoTypes rated_cargoes = 0;
 	for (const CargoSpec *cs : CargoSpec::Iterate()) {
 		GoodsEntry *ge = &st->goods[cs->Index()];
 
@@ -4236,8 +4348,19 @@ static void UpdateStationRating(Station *st)
 		/* Only change the rating if we are moving this cargo */
 		if (ge->HasRating()) {
 			byte_inc_sat(&ge->time_since_pickup);
+			if (ge->time_since_pickup != 255 || !_settings_game.order.selectgoods) SetBit(rated_cargoes, cs->Index());
+		}
+	}
+
+	int target_ratings[NUM_CARGO];
+	GetTargetRatings(st, rated_cargoes, target_ratings);
+
+	/* Then apply the ratings and remove cargo, in cargo order as this uses the random generator. */
+	for (const CargoSpec *cs : CargoSpec::Iterate()) {
+		GoodsEntry *ge = &st->goods[cs->Index()];
 
-			if (ge->time_since_pickup == 255 && _settings_game.order.selectgoods) {
+		if (ge->HasRating()) {
+			if (!HasBit(rated_cargoes, cs->Index())) {
 				ClrBit(ge->status, GoodsEntry::GES_RATING);
 				ge->last_speed = 0;
 				TruncateCargo(cs, ge);
@@ -4246,7 +4369,7 @@ static void UpdateStationRating(Station *st)
 			}
 
 			{
-				int rating = GetTargetRating(st, cs, ge);
+				int rating = target_ratings[cs->Index()];
 
 				uint waiting = ge->cargo.AvailableCount();
 
@@ -4404,18 +4527,29 @@ void DeleteStaleLinks(Station *from)
 		GoodsEntry &ge = from->goods[c];
 		LinkGraph *lg = LinkGraph::GetIfValid(ge.link_graph);
 		if (lg == nullptr) continue;
-		Node node = (*lg)[ge.node];
-		for (EdgeIterator it(node.Begin()); it != node.End();) {
-			Edge edge = it->second;
-			Station *to = Station::Get((*lg)[it->first].Station());
-			assert(to->goods[c].node == it->first);
-			++it; // Do that before removing the edge. Anything else may crash.
-			assert(_date >= edge.LastUpdate());
+		/* Work on a copy of the destinations, as removing edges or refreshing links
+		 * may reallocate the edges (and the nodes) of the link graph. */
+		const LinkGraph *const_lg = lg;
+		std::vector<NodeID> dest_nodes;
+		{
+			ConstNode node = (*const_lg)[ge.node];
+			for (ConstEdgeIterator it(node.Begin()); it != node.End(); ++it) {
+				dest_nodes.push_back(it->first);
+			}
+		}
+		for (NodeID dest_node : dest_nodes) {
+			/* Only look up the edge for modification if it actually changes, as that copies
+			 * the node if it is shared with a running link graph job. The edge is looked up
+			 * again for every access, as refreshing links may reallocate the edges. */
+			auto edge = [&]() -> ConstEdge { return (*const_lg)[ge.node][dest_node]; };
+			Station *to = Station::Get((*lg)[dest_node].Station());
+			assert(to->goods[c].node == dest_node);
+			assert(_date >= edge().LastUpdate());
 			uint timeout = std::max<uint>((LinkGraph::MIN_TIMEOUT_DISTANCE + (DistanceManhattan(from->xy, to->xy) >> 3)) / _settings_game.economy.day_length_factor, 1);
-			if (edge.LastAircraftUpdate() != INVALID_DATE && (uint)(_date - edge.LastAircraftUpdate()) > timeout) {
-				edge.ClearAircraft();
+			if (edge().LastAircraftUpdate() != INVALID_DATE && (uint)(_date - edge().LastAircraftUpdate()) > timeout) {
+				(*lg)[ge.node][dest_node].ClearAircraft();
 			}
-			if ((uint)(_date - edge.LastUpdate()) > timeout) {
+			if ((uint)(_date - edge().LastUpdate()) > timeout) {
 				bool updated = false;
 
 				if (auto_distributed) {
@@ -4452,7 +4586,7 @@ void DeleteStaleLinks(Station *from)
 								LinkRefresher::Run(v, false); // Don't allow merging. Otherwise lg might get deleted.
 							}
 						}
-						if (edge.LastUpdate() == _date) {
+						if (edge().LastUpdate() == _date) {
 							updated = true;
 							break;
 						}
@@ -4471,16 +4605,16 @@ void DeleteStaleLinks(Station *from)
 
 				if (!updated) {
 					/* If it's still considered dead remove it. */
-					node.RemoveEdge(to->goods[c].node);
+					(*lg)[ge.node].RemoveEdge(dest_node);
 					ge.flows.DeleteFlows(to->index);
 					RerouteCargo(from, c, to->index, from->index);
 				}
-			} else if (edge.LastUnrestrictedUpdate() != INVALID_DATE && (uint)(_date - edge.LastUnrestrictedUpdate()) > timeout) {
-				edge.Restrict();
+			} else if (edge().LastUnrestrictedUpdate() != INVALID_DATE && (uint)(_date - edge().LastUnrestrictedUpdate()) > timeout) {
+				(*lg)[ge.node][dest_node].Restrict();
 				ge.flows.RestrictFlows(to->index);
 				RerouteCargo(from, c, to->index, from->index);
-			} else if (edge.LastRestrictedUpdate() != INVALID_DATE && (uint)(_date - edge.LastRestrictedUpdate()) > timeout) {
-				edge.Release();
+			} else if (edge().LastRestrictedUpdate() != INVALID_DATE && (uint)(_date - edge().LastRestrictedUpdate()) > timeout) {
+				(*lg)[ge.node][dest_node].Release();
 			}
 		}
 		assert(_date >= lg->LastCompression());
@@ -4567,6 +4701,8 @@ void UpdateAllStationRatings()
 
 void OnTick_Station()
 {
+	TRACE_ZONE("OnTick_Station");
+
 	if (_game_mode == GM_EDITOR) return;
 
 	ClearDeleteStaleLinksVehicleCache();
@@ -4585,6 +4721,14 @@ void OnTick_Station()
 		if ((_tick_counter + st->index) % STATION_ACCEPTANCE_TICKS == 0) {
 			/* Stop processing this station if it was deleted */
 			if (!StationHandleBigTick(st)) continue;
+			if (Station::IsExpected(st)) {
+				const Station *s = Station::From(st);
+				for (CargoID c = 0; c < NUM_CARGO; c++) {
+					const GoodsEntry &ge = s->goods[c];
+					if (!ge.HasRating()) continue;
+					UpdateStateSubChecksum((((uint64)s->index) << 48) | (((uint64)c) << 40) | (((uint64)ge.rating) << 32) | ge.cargo.TotalCount(), SCP_STATIONS);
+				}
+			}
 			TriggerStationAnimation(st, st->xy, SAT_250_TICKS);
 			TriggerRoadStopAnimation(st, st->xy, SAT_250_TICKS);
 			if (Station::IsExpected(st)) AirportAnimationTrigger(Station::From(st), AAT_STATION_250_TICKS);
@@ -4758,13 +4902,6 @@ CommandCost CmdSetStationCargoAllowedSupply(TileIndex tile, DoCommandFlag flags,
 	return CommandCost();
 }
 
-static void AddNearbyStationsByCatchment(TileIndex tile, StationList *stations, StationList &nearby)
-{
-	for (Station *st : nearby) {
-		if (st->TileIsInCatchment(tile)) stations->insert(st);
-	}
-}
-
 /**
  * Run a tile loop to find stations around a tile, on demand. Cache the result for further requests
  * @return pointer to a StationList containing all stations found
@@ -4773,9 +4910,14 @@ const StationList *StationFinder::GetStations()
 {
 	if (this->tile != INVALID_TILE) {
 		if (IsTileType(this->tile, MP_HOUSE)) {
-			/* Town nearby stations need to be filtered per tile. */
+			/* Town nearby stations need to be filtered per tile, only check those whose catchment overlaps the block of the tile. */
 			assert(this->w == 1 && this->h == 1);
-			AddNearbyStationsByCatchment(this->tile, &this->stations, Town::GetByTile(this->tile)->stations_near);
+			const std::vector<Station *> *nearby = Town::GetByTile(this->tile)->GetStationsNearBlock(this->tile);
+			if (nearby != nullptr) {
+				for (Station *st : *nearby) {
+					if (st->TileIsInCatchment(this->tile)) this->stations.insert(st);
+				}
+			}
 		} else {
 			ForAllStationsAroundTiles(*this, [this](Station *st, TileIndex tile) {
 				this->stations.insert(st);
@@ -38,6 +38,7 @@
 #include "roadveh.h"
 
 #include "widgets/station_widget.h"
+#include "3rdparty/cpp-btree/btree_map.h"
 
 #include "table/strings.h"
 
@@ -1700,29 +1701,36 @@ struct StationViewWindow : public Window {
 	 */
 	void BuildCargoList(CargoID i, const StationCargoList &packets, CargoDataEntry *cargo)
 	{
-		const CargoDataEntry *source_dest = this->cached_destinations.Retrieve(i);
+		/* Busy stations have many packets with the same source and next hop, sum those up before updating the tree. */
+		btree::btree_map<std::pair<StationID, StationID>, uint> source_next_counts;
+		std::pair<StationID, StationID> last_key(INVALID_STATION, INVALID_STATION);
 		for (StationCargoList::ConstIterator it = packets.Packets()->begin(); it != packets.Packets()->end(); it++) {
 			const CargoPacket *cp = *it;
-			StationID next = it.GetKey();
-
-			const CargoDataEntry *source_entry = source_dest->Retrieve(cp->SourceStation());
-			if (source_entry == nullptr) {
-				this->ShowCargo(cargo, i, cp->SourceStation(), next, INVALID_STATION, cp->Count());
-				continue;
-			}
+			last_key = std::make_pair(cp->SourceStation(), it.GetKey());
+			source_next_counts[last_key] += cp->Count();
+		}
 
-			const CargoDataEntry *via_entry = source_entry->Retrieve(next);
+		const CargoDataEntry *source_dest = this->cached_destinations.Retrieve(i);
+		auto show_cargo = [&](StationID source, StationID next, uint count) {
+			const CargoDataEntry *source_entry = source_dest->Retrieve(source);
+			const CargoDataEntry *via_entry = (source_entry != nullptr) ? source_entry->Retrieve(next) : nullptr;
 			if (via_entry == nullptr) {
-				this->ShowCargo(cargo, i, cp->SourceStation(), next, INVALID_STATION, cp->Count());
-				continue;
+				this->ShowCargo(cargo, i, source, next, INVALID_STATION, count);
+				return;
 			}
 
 			for (CargoDataSet::iterator dest_it = via_entry->Begin(); dest_it != via_entry->End(); ++dest_it) {
 				CargoDataEntry *dest_entry = *dest_it;
-				uint val = DivideApprox(cp->Count() * dest_entry->GetCount(), via_entry->GetCount());
-				this->ShowCargo(cargo, i, cp->SourceStation(), next, dest_entry->GetStation(), val);
+				uint val = (uint)((((uint64)count * dest_entry->GetCount()) + (via_entry->GetCount() / 2)) / via_entry->GetCount());
+				this->ShowCargo(cargo, i, source, next, dest_entry->GetStation(), val);
 			}
+		};
+		for (const auto &it : source_next_counts) {
+			/* The source of the last shown cargo determines whether the cargo row is shown as transfers. */
+			if (it.first != last_key) show_cargo(it.first.first, it.first.second, it.second);
 		}
+		if (!source_next_counts.empty()) show_cargo(last_key.first, last_key.second, source_next_counts[last_key]);
+
 		this->ShowCargo(cargo, i, NEW_STATION, NEW_STATION, NEW_STATION, packets.ReservedCount());
 	}
 
@@ -515,6 +515,7 @@ static inline void SetRailStationReservation(TileIndex t, bool b)
 {
 	assert_tile(HasStationRail(t), t);
 	SB(_me[t].m6, 2, 1, b ? 1 : 0);
+	_rail_state_generation++;
 }
 
 /**
@@ -171,6 +171,7 @@ void CopyOutDParam(uint64 *dst, const char **strings, StringID string, int num)
 }
 
 static char *StationGetSpecialString(char *buff, int x, const char *last);
+static char *FormatCachedStationName(char *buff, const BaseStation *st, StringID str, StringParameters *args, const char *last);
 static char *GetSpecialTownNameString(char *buff, int ind, uint32 seed, const char *last);
 static char *GetSpecialNameString(char *buff, int ind, StringParameters *args, const char *last);
 
@@ -298,6 +299,17 @@ std::string GetString(StringID string)
 	return buffer;
 }
 
+/**
+ * Get the string builder of this thread, for formatting strings which are only needed briefly.
+ * Any string previously formatted with it on this thread is overwritten.
+ * @return The string builder of this thread.
+ */
+StringBuilderBuffer<TEMP_STRING_BUFFER_SIZE> &GetTempStringBuilder()
+{
+	static thread_local StringBuilderBuffer<TEMP_STRING_BUFFER_SIZE> builder;
+	return builder;
+}
+
 /**
  * This function is used to "bind" a C string to a OpenTTD dparam slot.
  * @param n slot of the string
@@ -1806,7 +1818,7 @@ static char *FormatString(char *buff, const char *str_arg, StringParameters *arg
 					uint64 args_array[] = {STR_TOWN_NAME, st->town->index, st->index};
 					WChar types_array[] = {0, SCC_TOWN_NAME, SCC_NUM};
 					StringParameters tmp_params(args_array, 3, types_array);
-					buff = GetStringWithArgs(buff, str, &tmp_params, last);
+					buff = FormatCachedStationName(buff, st, str, &tmp_params, last);
 				}
 				break;
 			}
@@ -1820,7 +1832,7 @@ static char *FormatString(char *buff, const char *str_arg, StringParameters *arg
 					StringParameters tmp_params(args_array);
 					buff = GetStringWithArgs(buff, STR_JUST_RAW_STRING, &tmp_params, last);
 				} else {
-					buff = GetTownName(buff, t, last);
+					buff = strecpy(buff, t->GetCachedName(), last);
 				}
 				break;
 			}
@@ -1838,7 +1850,7 @@ static char *FormatString(char *buff, const char *str_arg, StringParameters *arg
 					StringParameters tmp_params(args_array);
 					StringID str = ((wp->string_id == STR_SV_STNAME_BUOY) ? STR_FORMAT_BUOY_NAME : STR_FORMAT_WAYPOINT_NAME);
 					if (wp->town_cn != 0) str++;
-					buff = GetStringWithArgs(buff, str, &tmp_params, last);
+					buff = FormatCachedStationName(buff, wp, str, &tmp_params, last);
 				}
 				break;
 			}
@@ -1932,6 +1944,30 @@ static char *FormatString(char *buff, const char *str_arg, StringParameters *arg
 }
 
 
+/**
+ * Format the default name of a station or waypoint, using and filling its name cache.
+ * The default name only depends on the station and its town, so the cache is
+ * cleared when either is renamed and when the language changes.
+ * @param buff The buffer to write to.
+ * @param st The station or waypoint without a custom name.
+ * @param str The string of the default name.
+ * @param args The parameters of \a str.
+ * @param last The last element of the buffer.
+ * @return Pointer to the final zero byte of the formatted string.
+ */
+static char *FormatCachedStationName(char *buff, const BaseStation *st, StringID str, StringParameters *args, const char *last)
+{
+	/* Gender scanning produces different output, which must not be cached. */
+	if (_scan_for_gender_data) return GetStringWithArgs(buff, str, args, last);
+
+	if (st->cached_name.empty()) {
+		char buf[MAX_LENGTH_STATION_NAME_CHARS * MAX_CHAR_LENGTH];
+		char *end = GetStringWithArgs(buf, str, args, lastof(buf));
+		st->cached_name.assign(buf, end);
+	}
+	return strecpy(buff, st->cached_name.c_str(), last);
+}
+
 static char *StationGetSpecialString(char *buff, int x, const char *last)
 {
 	if ((x & FACIL_TRAIN)      && (buff + Utf8CharLen(SCC_TRAIN) < last)) buff += Utf8Encode(buff, SCC_TRAIN);
@@ -14,6 +14,7 @@
 #include "string_type.h"
 #include "gfx_type.h"
 #include "core/bitmath_func.hpp"
+#include <string_view>
 
 /**
  * Extract the StringTab from a StringID.
@@ -175,6 +176,61 @@ char *GetStringWithArgs(char *buffr, StringID string, StringParameters *args, co
 const char *GetStringPtr(StringID string);
 uint32 GetStringGRFID(StringID string);
 
+/**
+ * Builder which formats strings into storage held inline, to avoid the heap allocation of std::string GetString().
+ * The formatted string remains valid until the builder is used to format the next string.
+ */
+template <size_t N>
+class StringBuilderBuffer {
+	char buffer[N];      ///< Storage of the formatted string.
+	char *end = buffer;  ///< Terminating zero byte of the formatted string.
+
+public:
+	StringBuilderBuffer() { this->buffer[0] = '\0'; }
+
+	/**
+	 * Format a string using the global string parameters.
+	 * @param string The string to format.
+	 * @return The formatted string.
+	 */
+	const char *Format(StringID string)
+	{
+		this->end = GetString(this->buffer, string, lastof(this->buffer));
+		return this->buffer;
+	}
+
+	/**
+	 * Format a string using the given string parameters.
+	 * @param string The string to format.
+	 * @param args The string parameters.
+	 * @param case_index The case index to use.
+	 * @return The formatted string.
+	 */
+	const char *FormatWithArgs(StringID string, StringParameters *args, uint case_index = 0)
+	{
+		this->end = GetStringWithArgs(this->buffer, string, args, lastof(this->buffer), case_index);
+		return this->buffer;
+	}
+
+	const char *c_str() const { return this->buffer; }
+	size_t size() const { return this->end - this->buffer; }
+	std::string_view view() const { return std::string_view(this->buffer, this->end - this->buffer); }
+};
+
+static const size_t TEMP_STRING_BUFFER_SIZE = 2048; ///< Size of the per-thread string builder of #GetTempStringBuilder.
+
+StringBuilderBuffer<TEMP_STRING_BUFFER_SIZE> &GetTempStringBuilder();
+
+/**
+ * Resolve the given StringID using the global string parameters, without allocating.
+ * @param string The string to format.
+ * @return The formatted string, valid until the next use of #GetTempStringBuilder on this thread.
+ */
+static inline const char *GetStringTemp(StringID string)
+{
+	return GetTempStringBuilder().Format(string);
+}
+
 uint ConvertKmhishSpeedToDisplaySpeed(uint speed);
 uint ConvertDisplaySpeedToKmhishSpeed(uint speed);
 
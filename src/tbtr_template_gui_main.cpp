@@ -598,6 +598,15 @@ public:
 		int y = r.top;
 		int max = std::min<int>(this->vscroll[0]->GetPosition() + this->vscroll[0]->GetCapacity(), (int)this->groups.size());
 
+		/* Count the trains needing replacement of all visible groups in one pass over the trains */
+		btree::btree_map<GroupID, const TemplateVehicle *> visible_templates;
+		for (int i = this->vscroll[0]->GetPosition(); i < max; ++i) {
+			const GroupID g_id = this->groups[i]->index;
+			const TemplateID tid = GetTemplateIDByGroupIDRecursive(g_id);
+			if (tid != INVALID_TEMPLATE) visible_templates[g_id] = TemplateVehicle::Get(tid);
+		}
+		const btree::btree_map<GroupID, int> replacement_counts = NumTrainsNeedTemplateReplacement(visible_templates);
+
 		/* Then treat all groups defined by/for the current company */
 		for (int i = this->vscroll[0]->GetPosition(); i < max; ++i) {
 			const Group *g = (this->groups)[i];
@@ -630,8 +639,8 @@ public:
 
 			/* Draw the number of trains that still need to be treated by the currently selected template replacement */
 			if (tid != INVALID_TEMPLATE) {
-				const TemplateVehicle *tv = TemplateVehicle::Get(tid);
-				const int num_trains = NumTrainsNeedTemplateReplacement(g_id, tv);
+				auto count_iter = replacement_counts.find(g_id);
+				const int num_trains = count_iter != replacement_counts.end() ? count_iter->second : 0;
 				// Draw number
 				SetDParam(0, num_trains);
 				int inner_right = DrawString(left, right - ScaleGUITrad(4), text_y, STR_JUST_INT, num_trains ? TC_ORANGE : TC_GREY, SA_RIGHT);
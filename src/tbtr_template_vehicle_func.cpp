@@ -373,17 +373,25 @@ void CopyWagonStatus(TemplateVehicle *from, Train *to)
 	to->cargo_subtype = from->cargo_subtype;
 }
 
-int NumTrainsNeedTemplateReplacement(GroupID g_id, const TemplateVehicle *tv)
+/**
+ * Count the trains which need template replacement for several groups at once, in a single pass over the trains.
+ * @param templates The template to check the trains of each group against.
+ * @return The number of trains of each group which need template replacement, groups without any such trains are omitted.
+ */
+btree::btree_map<GroupID, int> NumTrainsNeedTemplateReplacement(const btree::btree_map<GroupID, const TemplateVehicle *> &templates)
 {
-	int count = 0;
-	if (!tv) return count;
-
-	for (Train *t : Train::Iterate()) {
-		if (t->IsPrimaryVehicle() && t->group_id == g_id && (!TrainMatchesTemplate(t, tv) || !TrainMatchesTemplateRefit(t, tv))) {
-			count++;
+	btree::btree_map<GroupID, int> counts;
+	if (templates.empty()) return counts;
+
+	for (const Train *t : Train::Iterate()) {
+		if (!t->IsPrimaryVehicle()) continue;
+		auto iter = templates.find(t->group_id);
+		if (iter == templates.end()) continue;
+		if (!TrainMatchesTemplate(t, iter->second) || !TrainMatchesTemplateRefit(t, iter->second)) {
+			counts[t->group_id]++;
 		}
 	}
-	return count;
+	return counts;
 }
 // refit each vehicle in t as is in tv, assume t and tv contain the same types of vehicles
 CommandCost CmdRefitTrainFromTemplate(Train *t, TemplateVehicle *tv, DoCommandFlag flags)
@@ -504,16 +512,5 @@ void UpdateAllTemplateVehicleImages()
 
 int GetTemplateVehicleEstimatedMaxAchievableSpeed(const TemplateVehicle *tv, int mass, const int speed_cap)
 {
-	int max_speed = 0;
-	int acceleration;
-
-	if (mass < 1) mass = 1;
-
-	do
-	{
-		max_speed++;
-		acceleration = GetTrainRealisticAccelerationAtSpeed(max_speed, mass, tv->power, tv->max_te, tv->air_drag, tv->railtype);
-	} while (acceleration > 0 && max_speed < speed_cap);
-
-	return max_speed;
+	return GetTrainRealisticMaxAchievableSpeed(mass, tv->power, tv->max_te, tv->air_drag, tv->railtype, speed_cap);
 }
@@ -15,6 +15,8 @@
 
 #include "tbtr_template_vehicle.h"
 
+#include "3rdparty/cpp-btree/btree_map.h"
+
 Train* VirtualTrainFromTemplateVehicle(const TemplateVehicle* tv, StringID &err, uint32 user);
 
 void BuildTemplateGuiList(GUITemplateList*, Scrollbar*, Owner, RailType);
@@ -44,7 +46,7 @@ bool ChainContainsVehicle(Train*, Train*);
 Train* ChainContainsEngine(EngineID, Train*);
 Train* DepotContainsEngine(TileIndex, EngineID, Train*);
 
-int NumTrainsNeedTemplateReplacement(GroupID, const TemplateVehicle*);
+btree::btree_map<GroupID, int> NumTrainsNeedTemplateReplacement(const btree::btree_map<GroupID, const TemplateVehicle *> &templates);
 
 CommandCost TestBuyAllTemplateVehiclesInChain(TemplateVehicle *tv, TileIndex tile);
 
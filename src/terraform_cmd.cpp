@@ -17,25 +17,92 @@
 #include "company_base.h"
 #include "company_func.h"
 #include "core/backup_type.hpp"
+#include "water.h"
 
 #include "table/strings.h"
 
-#include "3rdparty/cpp-btree/btree_set.h"
-#include "3rdparty/cpp-btree/btree_map.h"
+#include <algorithm>
+#include <vector>
 
 #include "safeguards.h"
 
-/** Set of tiles. */
-typedef btree::btree_set<TileIndex> TileIndexSet;
-/** Mapping of tiles to their height. */
-typedef btree::btree_map<TileIndex, int> TileIndexToHeightMap;
-
 /** State of the terraforming. */
 struct TerraformerState {
-	TileIndexSet dirty_tiles;                ///< The tiles that need to be redrawn.
-	TileIndexToHeightMap tile_to_new_height; ///< The tiles for which the height has changed.
+	static constexpr int16 UNCHANGED = -1; ///< Value of #new_heights for tiles of which the height has not changed.
+	static const uint AREA_MARGIN = 8;   ///< Number of tiles by which #area is grown beyond the tile which did not fit.
+
+	std::vector<TileIndex> dirty_tiles;  ///< The tiles that need to be redrawn, may contain duplicates until #SortDirtyTiles is called.
+	std::vector<TileIndex> changed_tiles; ///< The tiles for which the height has changed.
+	TileArea area;                       ///< Area covered by #new_heights, empty until the first height is set.
+	std::vector<int16> new_heights;      ///< New heights of the tiles of #area, row by row, or #UNCHANGED.
+
+	/**
+	 * Get the index of a tile in #new_heights.
+	 * @param tile The tile, must be within #area.
+	 * @return The index.
+	 */
+	inline size_t GetIndex(TileIndex tile) const
+	{
+		return (size_t)(TileY(tile) - TileY(this->area.tile)) * this->area.w + (TileX(tile) - TileX(this->area.tile));
+	}
+
+	/**
+	 * Get the new height of a tile.
+	 * @param tile The tile.
+	 * @return The new height, or #UNCHANGED.
+	 */
+	inline int GetNewHeight(TileIndex tile) const
+	{
+		if (this->area.w == 0 || !IsInsideBS(TileX(tile), TileX(this->area.tile), this->area.w) || !IsInsideBS(TileY(tile), TileY(this->area.tile), this->area.h)) return UNCHANGED;
+		return this->new_heights[this->GetIndex(tile)];
+	}
+
+	void SetNewHeight(TileIndex tile, int height);
+
+	/** Sort the dirty tiles in map order and remove the duplicates. */
+	void SortDirtyTiles()
+	{
+		std::sort(this->dirty_tiles.begin(), this->dirty_tiles.end());
+		this->dirty_tiles.erase(std::unique(this->dirty_tiles.begin(), this->dirty_tiles.end()), this->dirty_tiles.end());
+	}
 };
 
+/**
+ * Set the new height of a tile, growing the covered area when needed.
+ * @param tile The tile.
+ * @param height The new height.
+ */
+void TerraformerState::SetNewHeight(TileIndex tile, int height)
+{
+	if (!this->area.Contains(tile)) {
+		/* Grow the area to include the tile, with some margin as terraforming spreads to the neighbouring corners. */
+		const uint x = TileX(tile);
+		const uint y = TileY(tile);
+		uint left = x > AREA_MARGIN ? x - AREA_MARGIN : 0;
+		uint top = y > AREA_MARGIN ? y - AREA_MARGIN : 0;
+		uint right = std::min(x + AREA_MARGIN, MapMaxX());
+		uint bottom = std::min(y + AREA_MARGIN, MapMaxY());
+		if (this->area.w != 0) {
+			left = std::min(left, TileX(this->area.tile));
+			top = std::min(top, TileY(this->area.tile));
+			right = std::max(right, TileX(this->area.tile) + this->area.w - 1);
+			bottom = std::max(bottom, TileY(this->area.tile) + this->area.h - 1);
+		}
+
+		TileArea new_area(TileXY(left, top), TileXY(right, bottom));
+		std::vector<int16> heights((size_t)new_area.w * new_area.h, UNCHANGED);
+		for (TileIndex t : this->changed_tiles) {
+			heights[(size_t)(TileY(t) - top) * new_area.w + (TileX(t) - left)] = this->new_heights[this->GetIndex(t)];
+		}
+		this->area = new_area;
+		this->new_heights = std::move(heights);
+	}
+
+	int16 &new_height = this->new_heights[this->GetIndex(tile)];
+	if (new_height == UNCHANGED) this->changed_tiles.push_back(tile);
+	new_height = height;
+}
+
 /**
  * Gets the TileHeight (height of north corner) of a tile as of current terraforming progress.
  *
@@ -45,8 +112,8 @@ struct TerraformerState {
  */
 static int TerraformGetHeightOfTile(const TerraformerState *ts, TileIndex tile)
 {
-	TileIndexToHeightMap::const_iterator it = ts->tile_to_new_height.find(tile);
-	return it != ts->tile_to_new_height.end() ? it->second : TileHeight(tile);
+	int height = ts->GetNewHeight(tile);
+	return height != TerraformerState::UNCHANGED ? height : TileHeight(tile);
 }
 
 /**
@@ -58,7 +125,7 @@ static int TerraformGetHeightOfTile(const TerraformerState *ts, TileIndex tile)
  */
 static void TerraformSetHeightOfTile(TerraformerState *ts, TileIndex tile, int height)
 {
-	ts->tile_to_new_height[tile] = height;
+	ts->SetNewHeight(tile, height);
 }
 
 /**
@@ -70,7 +137,7 @@ static void TerraformSetHeightOfTile(TerraformerState *ts, TileIndex tile, int h
  */
 static void TerraformAddDirtyTile(TerraformerState *ts, TileIndex tile)
 {
-	ts->dirty_tiles.insert(tile);
+	ts->dirty_tiles.push_back(tile);
 }
 
 /**
@@ -219,12 +286,13 @@ CommandCost CmdTerraformLand(TileIndex tile, DoCommandFlag flags, uint32 p1, uin
 		total_cost.AddCost(cost);
 	}
 
+	ts.SortDirtyTiles();
+
 	/* Check if the terraforming is valid wrt. tunnels, bridges and objects on the surface
 	 * Pass == 0: Collect tileareas which are caused to be auto-cleared.
 	 * Pass == 1: Collect the actual cost. */
 	for (int pass = 0; pass < 2; pass++) {
-		for (TileIndexSet::const_iterator it = ts.dirty_tiles.begin(); it != ts.dirty_tiles.end(); it++) {
-			TileIndex t = *it;
+		for (TileIndex t : ts.dirty_tiles) {
 
 			assert(t < MapSize());
 			/* MP_VOID tiles can be terraformed but as tunnels and bridges
@@ -303,29 +371,34 @@ CommandCost CmdTerraformLand(TileIndex tile, DoCommandFlag flags, uint32 p1, uin
 	}
 
 	Company *c = Company::GetIfValid(_current_company);
-	if (c != nullptr && GB(c->terraform_limit, 16, 16) < ts.tile_to_new_height.size()) {
+	if (c != nullptr && GB(c->terraform_limit, 16, 16) < ts.changed_tiles.size()) {
 		return_cmd_error(STR_ERROR_TERRAFORM_LIMIT_REACHED);
 	}
 
 	if (flags & DC_EXEC) {
 		/* Mark affected areas dirty. */
-		for (TileIndexSet::const_iterator it = ts.dirty_tiles.begin(); it != ts.dirty_tiles.end(); it++) {
-			MarkTileDirtyByTile(*it);
-			TileIndexToHeightMap::const_iterator new_height = ts.tile_to_new_height.find(*it);
-			if (new_height == ts.tile_to_new_height.end()) continue;
-			MarkTileDirtyByTile(*it, VMDF_NONE, 0, new_height->second);
+		for (TileIndex t : ts.dirty_tiles) {
+			MarkTileDirtyByTile(t);
+			int new_height = ts.GetNewHeight(t);
+			if (new_height == TerraformerState::UNCHANGED) continue;
+			MarkTileDirtyByTile(t, VMDF_NONE, 0, new_height);
 		}
 
 		/* change the height */
-		for (TileIndexToHeightMap::const_iterator it = ts.tile_to_new_height.begin();
-				it != ts.tile_to_new_height.end(); it++) {
-			TileIndex t = it->first;
-			int height = it->second;
+		for (TileIndex t : ts.changed_tiles) {
+			SetTileHeight(t, (uint)ts.GetNewHeight(t));
+		}
 
-			SetTileHeight(t, (uint)height);
+		/* Water tiles which settled next to land above sea level may be able to flood the tiles at the changed corners now. */
+		for (TileIndex changed : ts.changed_tiles) {
+			const uint x = TileX(changed);
+			const uint y = TileY(changed);
+			for (TileIndex t : TileArea(TileXY(x > 0 ? x - 1 : 0, y > 0 ? y - 1 : 0), changed)) {
+				ClearNeighbourNonFloodingStates(t);
+			}
 		}
 
-		if (c != nullptr) c->terraform_limit -= (uint32)ts.tile_to_new_height.size() << 16;
+		if (c != nullptr) c->terraform_limit -= (uint32)ts.changed_tiles.size() << 16;
 	}
 	return total_cost;
 }
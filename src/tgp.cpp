@@ -14,6 +14,7 @@
 #include "genworld.h"
 #include "core/random_func.hpp"
 #include "landscape_type.h"
+#include "worker_thread.h"
 
 #include "safeguards.h"
 
@@ -199,6 +200,9 @@ static HeightMap _height_map = { {}, 0, 0, 0 };
 /** Maximum number of TGP noise frequencies. */
 static const int MAX_TGP_FREQUENCIES = 10;
 
+static const size_t TGP_PARALLEL_GRAIN = 64;               ///< Number of rows or columns of the height map per chunk of work for the worker threads.
+static const size_t TGP_PARALLEL_HEIGHT_GRAIN = 64 * 256; ///< Number of heights of the height map per chunk of work for the worker threads.
+
 /** Desired water percentage (100% == 1024) - indexed by _settings_game.difficulty.quantity_sea_lakes */
 static const amplitude_t _water_percent[4] = {70, 170, 270, 420};
 
@@ -389,24 +393,28 @@ static void HeightMapGenerate()
 
 		/* It is regular iteration round.
 		 * Interpolate height values at odd x, even y tiles */
-		for (int y = 0; y <= _height_map.size_y; y += 2 * step) {
-			for (int x = 0; x <= _height_map.size_x - 2 * step; x += 2 * step) {
-				height_t h00 = _height_map.height(x + 0 * step, y);
-				height_t h02 = _height_map.height(x + 2 * step, y);
-				height_t h01 = (h00 + h02) / 2;
-				_height_map.height(x + 1 * step, y) = h01;
+		_general_worker_pool.ParallelFor(_height_map.size_y / (2 * step) + 1, TGP_PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+			for (int y = (int)begin * 2 * step; y < (int)end * 2 * step; y += 2 * step) {
+				for (int x = 0; x <= _height_map.size_x - 2 * step; x += 2 * step) {
+					height_t h00 = _height_map.height(x + 0 * step, y);
+					height_t h02 = _height_map.height(x + 2 * step, y);
+					height_t h01 = (h00 + h02) / 2;
+					_height_map.height(x + 1 * step, y) = h01;
+				}
 			}
-		}
+		});
 
 		/* Interpolate height values at odd y tiles */
-		for (int y = 0; y <= _height_map.size_y - 2 * step; y += 2 * step) {
-			for (int x = 0; x <= _height_map.size_x; x += step) {
-				height_t h00 = _height_map.height(x, y + 0 * step);
-				height_t h20 = _height_map.height(x, y + 2 * step);
-				height_t h10 = (h00 + h20) / 2;
-				_height_map.height(x, y + 1 * step) = h10;
+		_general_worker_pool.ParallelFor(_height_map.size_y / (2 * step), TGP_PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+			for (int y = (int)begin * 2 * step; y < (int)end * 2 * step; y += 2 * step) {
+				for (int x = 0; x <= _height_map.size_x; x += step) {
+					height_t h00 = _height_map.height(x, y + 0 * step);
+					height_t h20 = _height_map.height(x, y + 2 * step);
+					height_t h10 = (h00 + h20) / 2;
+					_height_map.height(x, y + 1 * step) = h10;
+				}
 			}
-		}
+		});
 
 		/* Add noise for next higher frequency (smaller steps) */
 		for (int y = 0; y <= _height_map.size_y; y += step) {
@@ -417,6 +425,20 @@ static void HeightMapGenerate()
 	}
 }
 
+/**
+ * Apply a transformation to all heights of the height map, using the worker threads.
+ * The new value of a height may only depend on the old value of that height.
+ * @param transform Function which transforms a height in place.
+ */
+template <typename F>
+static void HeightMapTransformHeights(F transform)
+{
+	height_t *heights = _height_map.h.data();
+	_general_worker_pool.ParallelFor(_height_map.h.size(), TGP_PARALLEL_HEIGHT_GRAIN, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) transform(heights[i]);
+	});
+}
+
 /** Returns min, max and average height from height map */
 static void HeightMapGetMinMaxAvg(height_t *min_ptr, height_t *max_ptr, height_t *avg_ptr)
 {
@@ -457,10 +479,10 @@ static int *HeightMapMakeHistogram(height_t h_min, height_t h_max, int *hist_buf
 /** Applies sine wave redistribution onto height map */
 static void HeightMapSineTransform(height_t h_min, height_t h_max)
 {
-	for (height_t &h : _height_map.h) {
+	HeightMapTransformHeights([&](height_t &h) {
 		double fheight;
 
-		if (h < h_min) continue;
+		if (h < h_min) return;
 
 		/* Transform height into 0..1 space */
 		fheight = (double)(h - h_min) / (double)(h_max - h_min);
@@ -526,7 +548,7 @@ static void HeightMapSineTransform(height_t h_min, height_t h_max)
 		h = (height_t)(fheight * (h_max - h_min) + h_min);
 		if (h < 0) h = I2H(0);
 		if (h >= h_max) h = h_max - 1;
-	}
+	});
 }
 
 /**
@@ -574,9 +596,6 @@ static void HeightMapCurves(uint level)
 		{ lengthof(curve_map_4), curve_map_4 },
 	};
 
-	height_t ht[lengthof(curve_maps)];
-	MemSetT(ht, 0, lengthof(ht));
-
 	/* Set up a grid to choose curve maps based on location; attempt to get a somewhat square grid */
 	float factor = sqrt((float)_height_map.size_x / (float)_height_map.size_y);
 	uint sx = Clamp((int)(((1 << level) * factor) + 0.5), 1, 128);
@@ -587,90 +606,95 @@ static void HeightMapCurves(uint level)
 		c[i] = Random() % lengthof(curve_maps);
 	}
 
-	/* Apply curves */
-	for (int x = 0; x < _height_map.size_x; x++) {
-
-		/* Get our X grid positions and bi-linear ratio */
-		float fx = (float)(sx * x) / _height_map.size_x + 1.0f;
-		uint x1 = (uint)fx;
-		uint x2 = x1;
-		float xr = 2.0f * (fx - x1) - 1.0f;
-		xr = sin(xr * M_PI_2);
-		xr = sin(xr * M_PI_2);
-		xr = 0.5f * (xr + 1.0f);
-		float xri = 1.0f - xr;
-
-		if (x1 > 0) {
-			x1--;
-			if (x2 >= sx) x2--;
-		}
-
-		for (int y = 0; y < _height_map.size_y; y++) {
-
-			/* Get our Y grid position and bi-linear ratio */
-			float fy = (float)(sy * y) / _height_map.size_y + 1.0f;
-			uint y1 = (uint)fy;
-			uint y2 = y1;
-			float yr = 2.0f * (fy - y1) - 1.0f;
-			yr = sin(yr * M_PI_2);
-			yr = sin(yr * M_PI_2);
-			yr = 0.5f * (yr + 1.0f);
-			float yri = 1.0f - yr;
-
-			if (y1 > 0) {
-				y1--;
-				if (y2 >= sy) y2--;
+	/* Apply curves, columns are independent of each other */
+	_general_worker_pool.ParallelFor(_height_map.size_x, TGP_PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+		height_t ht[lengthof(curve_maps)];
+		MemSetT(ht, 0, lengthof(ht));
+
+		for (int x = (int)begin; x < (int)end; x++) {
+
+			/* Get our X grid positions and bi-linear ratio */
+			float fx = (float)(sx * x) / _height_map.size_x + 1.0f;
+			uint x1 = (uint)fx;
+			uint x2 = x1;
+			float xr = 2.0f * (fx - x1) - 1.0f;
+			xr = sin(xr * M_PI_2);
+			xr = sin(xr * M_PI_2);
+			xr = 0.5f * (xr + 1.0f);
+			float xri = 1.0f - xr;
+
+			if (x1 > 0) {
+				x1--;
+				if (x2 >= sx) x2--;
 			}
 
-			uint corner_a = c[x1 + sx * y1];
-			uint corner_b = c[x1 + sx * y2];
-			uint corner_c = c[x2 + sx * y1];
-			uint corner_d = c[x2 + sx * y2];
-
-			/* Bitmask of which curve maps are chosen, so that we do not bother
-			 * calculating a curve which won't be used. */
-			uint corner_bits = 0;
-			corner_bits |= 1 << corner_a;
-			corner_bits |= 1 << corner_b;
-			corner_bits |= 1 << corner_c;
-			corner_bits |= 1 << corner_d;
-
-			height_t *h = &_height_map.height(x, y);
-
-			/* Do not touch sea level */
-			if (*h < I2H(1)) continue;
-
-			/* Only scale above sea level */
-			*h -= I2H(1);
-
-			/* Apply all curve maps that are used on this tile. */
-			for (uint t = 0; t < lengthof(curve_maps); t++) {
-				if (!HasBit(corner_bits, t)) continue;
-
-				[[maybe_unused]] bool found = false;
-				const control_point_t *cm = curve_maps[t].list;
-				for (uint i = 0; i < curve_maps[t].length - 1; i++) {
-					const control_point_t &p1 = cm[i];
-					const control_point_t &p2 = cm[i + 1];
-
-					if (*h >= p1.x && *h < p2.x) {
-						ht[t] = p1.y + (*h - p1.x) * (p2.y - p1.y) / (p2.x - p1.x);
-#ifdef WITH_ASSERT
-						found = true;
-#endif
-						break;
+			for (int y = 0; y < _height_map.size_y; y++) {
+
+				/* Get our Y grid position and bi-linear ratio */
+				float fy = (float)(sy * y) / _height_map.size_y + 1.0f;
+				uint y1 = (uint)fy;
+				uint y2 = y1;
+				float yr = 2.0f * (fy - y1) - 1.0f;
+				yr = sin(yr * M_PI_2);
+				yr = sin(yr * M_PI_2);
+				yr = 0.5f * (yr + 1.0f);
+				float yri = 1.0f - yr;
+
+				if (y1 > 0) {
+					y1--;
+					if (y2 >= sy) y2--;
+				}
+
+				uint corner_a = c[x1 + sx * y1];
+				uint corner_b = c[x1 + sx * y2];
+				uint corner_c = c[x2 + sx * y1];
+				uint corner_d = c[x2 + sx * y2];
+
+				/* Bitmask of which curve maps are chosen, so that we do not bother
+				 * calculating a curve which won't be used. */
+				uint corner_bits = 0;
+				corner_bits |= 1 << corner_a;
+				corner_bits |= 1 << corner_b;
+				corner_bits |= 1 << corner_c;
+				corner_bits |= 1 << corner_d;
+
+				height_t *h = &_height_map.height(x, y);
+
+				/* Do not touch sea level */
+				if (*h < I2H(1)) continue;
+
+				/* Only scale above sea level */
+				*h -= I2H(1);
+
+				/* Apply all curve maps that are used on this tile. */
+				for (uint t = 0; t < lengthof(curve_maps); t++) {
+					if (!HasBit(corner_bits, t)) continue;
+
+					[[maybe_unused]] bool found = false;
+					const control_point_t *cm = curve_maps[t].list;
+					for (uint i = 0; i < curve_maps[t].length - 1; i++) {
+						const control_point_t &p1 = cm[i];
+						const control_point_t &p2 = cm[i + 1];
+
+						if (*h >= p1.x && *h < p2.x) {
+							ht[t] = p1.y + (*h - p1.x) * (p2.y - p1.y) / (p2.x - p1.x);
+	#ifdef WITH_ASSERT
+							found = true;
+	#endif
+							break;
+						}
 					}
+					assert(found);
 				}
-				assert(found);
-			}
 
-			/* Apply interpolation of curve map results. */
-			*h = (height_t)((ht[corner_a] * yri + ht[corner_b] * yr) * xri + (ht[corner_c] * yri + ht[corner_d] * yr) * xr);
+				/* Apply interpolation of curve map results. */
+				*h = (height_t)((ht[corner_a] * yri + ht[corner_b] * yr) * xri + (ht[corner_c] * yri + ht[corner_d] * yr) * xr);
 
-			/* Readd sea level */
-			*h += I2H(1);
+				/* Readd sea level */
+				*h += I2H(1);
+			}
 		}
-	}
+	});
 }
 
 /** Adjusts heights in height map to contain required amount of water tiles */
@@ -702,18 +726,154 @@ static void HeightMapAdjustWaterLevel(amplitude_t water_percent, height_t h_max_
 	 *   values from range: h_water_level..h_max are transformed into 0..h_max_new
 	 *   where h_max_new is depending on terrain type and map size.
 	 */
-	for (height_t &h : _height_map.h) {
+	HeightMapTransformHeights([&](height_t &h) {
 		/* Transform height from range h_water_level..h_max into 0..h_max_new range */
 		h = (height_t)(((int)h_max_new) * (h - h_water_level) / (h_max - h_water_level)) + I2H(1);
 		/* Make sure all values are in the proper range (0..h_max_new) */
 		if (h < 0) h = I2H(0);
 		if (h >= h_max_new) h = h_max_new - 1;
-	}
+	});
 
 	free(hist_buf);
 }
 
-static double perlin_coast_noise_2D(const double x, const double y, const double p, const int prime);
+/** Number of octaves of the perlin noise of the coast lines. */
+static const int COAST_NOISE_OCTAVES = 6;
+
+/**
+ * This is a similar noise to the main perlin noise calculation, but uses
+ * the persistence p passed as a parameter rather than selected from the predefined
+ * sequences. It is used to create the indented coastline, which is just another
+ * perlin sequence.
+ */
+struct PerlinCoastNoise {
+	const int prime;                           ///< Prime to select the series of numbers of the noise.
+	const uint32 seed;                         ///< Generation seed of the noise.
+	double amplitudes[COAST_NOISE_OCTAVES];    ///< Amplitude of each octave.
+
+	/**
+	 * Create the noise.
+	 * @param p The persistence, the amplitude of octave i is p to the power i.
+	 * @param prime The prime, used to allow the generator to create useful random numbers from slightly different series.
+	 */
+	PerlinCoastNoise(const double p, const int prime) : prime(prime), seed(_settings_game.game_creation.generation_seed)
+	{
+		for (int i = 0; i < COAST_NOISE_OCTAVES; i++) {
+			this->amplitudes[i] = pow(p, (double)i);
+		}
+	}
+
+	/**
+	 * The Perlin Noise calculation using large primes
+	 * The initial number is adjusted by two values; the generation_seed, and the prime.
+	 */
+	inline double IntNoise(const long x, const long y) const
+	{
+		long n = x + y * this->prime + this->seed;
+
+		n = (n << 13) ^ n;
+
+		/* Pseudo-random number generator, using several large primes */
+		return 1.0 - (double)((n * (n * n * 15731 + 789221) + 1376312589) & 0x7fffffff) / 1073741824.0;
+	}
+
+	/**
+	 * This routine determines the interpolated value between a and b
+	 */
+	static inline double LinearInterpolate(const double a, const double b, const double x)
+	{
+		return a + x * (b - a);
+	}
+
+	/**
+	 * This routine returns the smoothed interpolated noise for an x and y, using
+	 * the values from the surrounding positions.
+	 */
+	double InterpolatedNoise(const double x, const double y) const
+	{
+		const int integer_X = (int)x;
+		const int integer_Y = (int)y;
+
+		const double fractional_X = x - (double)integer_X;
+		const double fractional_Y = y - (double)integer_Y;
+
+		const double v1 = this->IntNoise(integer_X,     integer_Y);
+		const double v2 = this->IntNoise(integer_X + 1, integer_Y);
+		const double v3 = this->IntNoise(integer_X,     integer_Y + 1);
+		const double v4 = this->IntNoise(integer_X + 1, integer_Y + 1);
+
+		const double i1 = LinearInterpolate(v1, v2, fractional_X);
+		const double i2 = LinearInterpolate(v3, v4, fractional_X);
+
+		return LinearInterpolate(i1, i2, fractional_Y);
+	}
+
+	/**
+	 * Get the noise at a position.
+	 * @param x X position.
+	 * @param y Y position.
+	 * @return The noise.
+	 */
+	double Get(const double x, const double y) const
+	{
+		double total = 0.0;
+
+		for (int i = 0; i < COAST_NOISE_OCTAVES; i++) {
+			const double frequency = (double)(1 << i);
+
+			total += this->InterpolatedNoise((x * frequency) / 64.0, (y * frequency) / 64.0) * this->amplitudes[i];
+		}
+
+		return total;
+	}
+
+	/**
+	 * Get the noise of a run of positions along the x axis, with the same results as #Get.
+	 * The integer noise of the surrounding positions only changes every few samples, so it is reused between them.
+	 * @param first_x X position of the first sample.
+	 * @param count Number of samples.
+	 * @param y Y position of the samples.
+	 * @param[out] out The noise of the samples.
+	 */
+	void GetRow(const int first_x, const int count, const double y, double *out) const
+	{
+		for (int n = 0; n < count; n++) out[n] = 0.0;
+
+		for (int i = 0; i < COAST_NOISE_OCTAVES; i++) {
+			const double frequency = (double)(1 << i);
+			const double amplitude = this->amplitudes[i];
+
+			const double fy = (y * frequency) / 64.0;
+			const int integer_Y = (int)fy;
+			const double fractional_Y = fy - (double)integer_Y;
+
+			int cached_X = 0;
+			double v1 = 0, v2 = 0, v3 = 0, v4 = 0;
+			for (int n = 0; n < count; n++) {
+				const double fx = ((double)(first_x + n) * frequency) / 64.0;
+				const int integer_X = (int)fx;
+				if (n == 0 || integer_X != cached_X) {
+					if (n > 0 && integer_X == cached_X + 1) {
+						v1 = v2;
+						v3 = v4;
+					} else {
+						v1 = this->IntNoise(integer_X, integer_Y);
+						v3 = this->IntNoise(integer_X, integer_Y + 1);
+					}
+					v2 = this->IntNoise(integer_X + 1, integer_Y);
+					v4 = this->IntNoise(integer_X + 1, integer_Y + 1);
+					cached_X = integer_X;
+				}
+
+				const double fractional_X = fx - (double)integer_X;
+				const double i1 = LinearInterpolate(v1, v2, fractional_X);
+				const double i2 = LinearInterpolate(v3, v4, fractional_X);
+
+				out[n] += LinearInterpolate(i1, i2, fractional_Y) * amplitude;
+			}
+		}
+	}
+};
 
 /**
  * This routine sculpts in from the edge a random amount, again a Perlin
@@ -739,55 +899,80 @@ static void HeightMapCoastLines(uint8 water_borders)
 {
 	int smallest_size = std::min(_settings_game.game_creation.map_x, _settings_game.game_creation.map_y);
 	const int margin = 4;
-	int y, x;
-	double max_x;
-	double max_y;
-
-	/* Lower to sea level */
-	for (y = 0; y <= _height_map.size_y; y++) {
-		if (HasBit(water_borders, BORDER_NE)) {
-			/* Top right */
-			max_x = abs((perlin_coast_noise_2D(_height_map.size_y - y, y, 0.9, 53) + 0.25) * 5 + (perlin_coast_noise_2D(y, y, 0.35, 179) + 1) * 12);
-			max_x = std::max((smallest_size * smallest_size / 64) + max_x, (smallest_size * smallest_size / 64) + margin - max_x);
-			if (smallest_size < 8 && max_x > 5) max_x /= 1.5;
-			for (x = 0; x < max_x; x++) {
-				_height_map.height(x, y) = 0;
+
+	const PerlinCoastNoise ne_1(0.9, 53), ne_2(0.35, 179);
+	const PerlinCoastNoise sw_1(0.85, 101), sw_2(0.45, 67);
+	const PerlinCoastNoise nw_1(0.9, 167), nw_2(0.4, 211);
+	const PerlinCoastNoise se_1(0.85, 71), se_2(0.35, 193);
+
+	/* Lower to sea level, rows are independent of each other */
+	_general_worker_pool.ParallelFor(_height_map.size_y + 1, TGP_PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+		for (int y = (int)begin; y < (int)end; y++) {
+			double max_x;
+			if (HasBit(water_borders, BORDER_NE)) {
+				/* Top right */
+				max_x = abs((ne_1.Get(_height_map.size_y - y, y) + 0.25) * 5 + (ne_2.Get(y, y) + 1) * 12);
+				max_x = std::max((smallest_size * smallest_size / 64) + max_x, (smallest_size * smallest_size / 64) + margin - max_x);
+				if (smallest_size < 8 && max_x > 5) max_x /= 1.5;
+				for (int x = 0; x < max_x; x++) {
+					_height_map.height(x, y) = 0;
+				}
 			}
-		}
 
-		if (HasBit(water_borders, BORDER_SW)) {
-			/* Bottom left */
-			max_x = abs((perlin_coast_noise_2D(_height_map.size_y - y, y, 0.85, 101) + 0.3) * 6 + (perlin_coast_noise_2D(y, y, 0.45,  67) + 0.75) * 8);
-			max_x = std::max((smallest_size * smallest_size / 64) + max_x, (smallest_size * smallest_size / 64) + margin - max_x);
-			if (smallest_size < 8 && max_x > 5) max_x /= 1.5;
-			for (x = _height_map.size_x; x > (_height_map.size_x - 1 - max_x); x--) {
-				_height_map.height(x, y) = 0;
+			if (HasBit(water_borders, BORDER_SW)) {
+				/* Bottom left */
+				max_x = abs((sw_1.Get(_height_map.size_y - y, y) + 0.3) * 6 + (sw_2.Get(y, y) + 0.75) * 8);
+				max_x = std::max((smallest_size * smallest_size / 64) + max_x, (smallest_size * smallest_size / 64) + margin - max_x);
+				if (smallest_size < 8 && max_x > 5) max_x /= 1.5;
+				for (int x = _height_map.size_x; x > (_height_map.size_x - 1 - max_x); x--) {
+					_height_map.height(x, y) = 0;
+				}
 			}
 		}
-	}
-
-	/* Lower to sea level */
-	for (x = 0; x <= _height_map.size_x; x++) {
+	});
+
+	/* Lower to sea level, columns are independent of each other */
+	_general_worker_pool.ParallelFor(_height_map.size_x + 1, TGP_PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+		/* The noise along the edges is calculated for the whole chunk at once. */
+		const int count = (int)(end - begin);
+		std::vector<double> noise(4 * count);
+		double *nw_noise_1 = noise.data();
+		double *nw_noise_2 = nw_noise_1 + count;
+		double *se_noise_1 = nw_noise_2 + count;
+		double *se_noise_2 = se_noise_1 + count;
 		if (HasBit(water_borders, BORDER_NW)) {
-			/* Top left */
-			max_y = abs((perlin_coast_noise_2D(x, _height_map.size_y / 2, 0.9, 167) + 0.4) * 5 + (perlin_coast_noise_2D(x, _height_map.size_y / 3, 0.4, 211) + 0.7) * 9);
-			max_y = std::max((smallest_size * smallest_size / 64) + max_y, (smallest_size * smallest_size / 64) + margin - max_y);
-			if (smallest_size < 8 && max_y > 5) max_y /= 1.5;
-			for (y = 0; y < max_y; y++) {
-				_height_map.height(x, y) = 0;
-			}
+			nw_1.GetRow((int)begin, count, _height_map.size_y / 2, nw_noise_1);
+			nw_2.GetRow((int)begin, count, _height_map.size_y / 3, nw_noise_2);
 		}
-
 		if (HasBit(water_borders, BORDER_SE)) {
-			/* Bottom right */
-			max_y = abs((perlin_coast_noise_2D(x, _height_map.size_y / 3, 0.85, 71) + 0.25) * 6 + (perlin_coast_noise_2D(x, _height_map.size_y / 3, 0.35, 193) + 0.75) * 12);
-			max_y = std::max((smallest_size * smallest_size / 64) + max_y, (smallest_size * smallest_size / 64) + margin - max_y);
-			if (smallest_size < 8 && max_y > 5) max_y /= 1.5;
-			for (y = _height_map.size_y; y > (_height_map.size_y - 1 - max_y); y--) {
-				_height_map.height(x, y) = 0;
+			se_1.GetRow((int)begin, count, _height_map.size_y / 3, se_noise_1);
+			se_2.GetRow((int)begin, count, _height_map.size_y / 3, se_noise_2);
+		}
+
+		for (int x = (int)begin; x < (int)end; x++) {
+			const int n = x - (int)begin;
+			double max_y;
+			if (HasBit(water_borders, BORDER_NW)) {
+				/* Top left */
+				max_y = abs((nw_noise_1[n] + 0.4) * 5 + (nw_noise_2[n] + 0.7) * 9);
+				max_y = std::max((smallest_size * smallest_size / 64) + max_y, (smallest_size * smallest_size / 64) + margin - max_y);
+				if (smallest_size < 8 && max_y > 5) max_y /= 1.5;
+				for (int y = 0; y < max_y; y++) {
+					_height_map.height(x, y) = 0;
+				}
+			}
+
+			if (HasBit(water_borders, BORDER_SE)) {
+				/* Bottom right */
+				max_y = abs((se_noise_1[n] + 0.25) * 6 + (se_noise_2[n] + 0.75) * 12);
+				max_y = std::max((smallest_size * smallest_size / 64) + max_y, (smallest_size * smallest_size / 64) + margin - max_y);
+				if (smallest_size < 8 && max_y > 5) max_y /= 1.5;
+				for (int y = _height_map.size_y; y > (_height_map.size_y - 1 - max_y); y--) {
+					_height_map.height(x, y) = 0;
+				}
 			}
 		}
-	}
+	});
 }
 
 /** Start at given point, move in given direction, find and Smooth coast in that direction */
@@ -900,78 +1085,6 @@ static void HeightMapNormalize()
 	HeightMapSmoothSlopes(I2H(1));
 }
 
-/**
- * The Perlin Noise calculation using large primes
- * The initial number is adjusted by two values; the generation_seed, and the
- * passed parameter; prime.
- * prime is used to allow the perlin noise generator to create useful random
- * numbers from slightly different series.
- */
-static double int_noise(const long x, const long y, const int prime)
-{
-	long n = x + y * prime + _settings_game.game_creation.generation_seed;
-
-	n = (n << 13) ^ n;
-
-	/* Pseudo-random number generator, using several large primes */
-	return 1.0 - (double)((n * (n * n * 15731 + 789221) + 1376312589) & 0x7fffffff) / 1073741824.0;
-}
-
-
-/**
- * This routine determines the interpolated value between a and b
- */
-static inline double linear_interpolate(const double a, const double b, const double x)
-{
-	return a + x * (b - a);
-}
-
-
-/**
- * This routine returns the smoothed interpolated noise for an x and y, using
- * the values from the surrounding positions.
- */
-static double interpolated_noise(const double x, const double y, const int prime)
-{
-	const int integer_X = (int)x;
-	const int integer_Y = (int)y;
-
-	const double fractional_X = x - (double)integer_X;
-	const double fractional_Y = y - (double)integer_Y;
-
-	const double v1 = int_noise(integer_X,     integer_Y,     prime);
-	const double v2 = int_noise(integer_X + 1, integer_Y,     prime);
-	const double v3 = int_noise(integer_X,     integer_Y + 1, prime);
-	const double v4 = int_noise(integer_X + 1, integer_Y + 1, prime);
-
-	const double i1 = linear_interpolate(v1, v2, fractional_X);
-	const double i2 = linear_interpolate(v3, v4, fractional_X);
-
-	return linear_interpolate(i1, i2, fractional_Y);
-}
-
-
-/**
- * This is a similar function to the main perlin noise calculation, but uses
- * the value p passed as a parameter rather than selected from the predefined
- * sequences. as you can guess by its title, i use this to create the indented
- * coastline, which is just another perlin sequence.
- */
-static double perlin_coast_noise_2D(const double x, const double y, const double p, const int prime)
-{
-	double total = 0.0;
-
-	for (int i = 0; i < 6; i++) {
-		const double frequency = (double)(1 << i);
-		const double amplitude = pow(p, (double)i);
-
-		total += interpolated_noise((x * frequency) / 64.0, (y * frequency) / 64.0, prime) * amplitude;
-	}
-
-	return total;
-}
-
-
 /** A small helper function to initialize the terrain */
 static void TgenSetTileHeight(TileIndex tile, int height)
 {
@@ -32,7 +32,7 @@ static inline uint TileHeight(TileIndex tile)
 #ifdef _DEBUG
 	assert_msg(tile < MapSize(), "tile: 0x%X, size: 0x%X", tile, MapSize());
 #endif
-	return _m[tile].height;
+	return _mth[tile].height;
 }
 
 /**
@@ -61,7 +61,7 @@ static inline void SetTileHeight(TileIndex tile, uint height)
 {
 	assert_msg(tile < MapSize(), "tile: 0x%X, size: 0x%X", tile, MapSize());
 	assert(height <= MAX_TILE_HEIGHT);
-	_m[tile].height = height;
+	_mth[tile].height = height;
 }
 
 /**
@@ -102,7 +102,7 @@ static inline TileType GetTileType(TileIndex tile)
 #ifdef _DEBUG
 	assert_msg(tile < MapSize(), "tile: 0x%X, size: 0x%X", tile, MapSize());
 #endif
-	return (TileType)GB(_m[tile].type, 4, 4);
+	return (TileType)GB(_mth[tile].type, 4, 4);
 }
 
 /**
@@ -122,6 +122,8 @@ static inline bool IsInnerTile(TileIndex tile)
 	return x < MapMaxX() && y < MapMaxY() && ((x > 0 && y > 0) || !_settings_game.construction.freeform_edges);
 }
 
+void MarkTileAcceptanceChanged(TileIndex tile);
+
 /**
  * Set the type of a tile
  *
@@ -141,7 +143,13 @@ static inline void SetTileType(TileIndex tile, TileType type)
 	 * edges of the map. If _settings_game.construction.freeform_edges is true,
 	 * the upper edges of the map are also VOID tiles. */
 	assert_msg(IsInnerTile(tile) == (type != MP_VOID), "tile: 0x%X (%d), type: %d", tile, IsInnerTile(tile), type);
-	SB(_m[tile].type, 4, 4, type);
+	/* Houses, industries and objects may accept cargo; stations cache the acceptance of their catchment. */
+	const TileType old_type = (TileType)GB(_mth[tile].type, 4, 4);
+	if (old_type != type && (old_type == MP_HOUSE || old_type == MP_INDUSTRY || old_type == MP_OBJECT ||
+			type == MP_HOUSE || type == MP_INDUSTRY || type == MP_OBJECT)) {
+		MarkTileAcceptanceChanged(tile);
+	}
+	SB(_mth[tile].type, 4, 4, type);
 }
 
 /**
@@ -230,7 +238,7 @@ static inline void SetTropicZone(TileIndex tile, TropicZone type)
 {
 	assert_msg(tile < MapSize(), "tile: 0x%X, size: 0x%X, type: %d", tile, MapSize(), type);
 	assert_msg(!IsTileType(tile, MP_VOID) || type == TROPICZONE_NORMAL, "tile: 0x%X (%d), type: %d", tile, GetTileType(tile), type);
-	SB(_m[tile].type, 0, 2, type);
+	SB(_mth[tile].type, 0, 2, type);
 }
 
 /**
@@ -242,7 +250,7 @@ static inline void SetTropicZone(TileIndex tile, TropicZone type)
 static inline TropicZone GetTropicZone(TileIndex tile)
 {
 	assert_msg(tile < MapSize(), "tile: 0x%X, size: 0x%X", tile, MapSize());
-	return (TropicZone)GB(_m[tile].type, 0, 2);
+	return (TropicZone)GB(_mth[tile].type, 0, 2);
 }
 
 /**
@@ -762,31 +762,12 @@ void UpdateSeparationOrder(Vehicle *v_start)
 
 DateTicksScaled GetScheduledDispatchTime(const DispatchSchedule &ds, DateTicksScaled leave_time)
 {
-	DateTicksScaled first_slot          = -1;
 	const DateTicksScaled begin_time    = ds.GetScheduledDispatchStartTick();
 	const int32 last_dispatched_offset  = ds.GetScheduledDispatchLastDispatch();
-	const uint32 dispatch_duration      = ds.GetScheduledDispatchDuration();
 	const int32 max_delay               = ds.GetScheduledDispatchDelay();
 
-	/* Find next available slots */
-	for (auto current_offset : ds.GetScheduledDispatch()) {
-		if (current_offset >= dispatch_duration) continue;
-		if (int32(current_offset) <= last_dispatched_offset) {
-			current_offset += dispatch_duration * ((last_dispatched_offset + dispatch_duration - current_offset) / dispatch_duration);
-		}
-
-		DateTicksScaled current_departure = begin_time + current_offset;
-		DateTicksScaled minimum = leave_time - max_delay;
-		if (current_departure < minimum) {
-			current_departure += dispatch_duration * ((minimum + dispatch_duration - current_departure - 1) / dispatch_duration);
-		}
-
-		if (first_slot == -1 || first_slot > current_departure) {
-			first_slot = current_departure;
-		}
-	}
-
-	return first_slot;
+	/* Find next available slot: after the last dispatched one, and not more than the maximum delay before leaving */
+	return ds.GetFirstDispatchSlotFrom(std::max<DateTicksScaled>(begin_time + last_dispatched_offset + 1, leave_time - max_delay));
 }
 
 /**
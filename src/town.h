@@ -21,6 +21,8 @@
 #include "core/tinystring_type.hpp"
 #include <list>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 template <typename T>
 struct BuildingCounts {
@@ -97,6 +99,8 @@ struct Town : TownPool::PoolItem<&_town_pool> {
 	inline byte GetPercentTransported(CargoID cid) const { return this->supplied[cid].old_act * 256 / (this->supplied[cid].old_max + 1); }
 
 	StationList stations_near;       ///< NOSAVE: List of nearby stations.
+	std::unordered_map<uint32, std::vector<Station *>> stations_near_blocks; ///< NOSAVE: Stations of #stations_near by block of tiles their catchment overlaps, see #GetStationsNearBlock.
+	bool stations_near_blocks_valid = false; ///< NOSAVE: Whether #stations_near_blocks is up to date with #stations_near.
 
 	uint16 time_until_rebuild;       ///< time until we rebuild a house
 
@@ -111,6 +115,8 @@ struct Town : TownPool::PoolItem<&_town_pool> {
 
 	bool show_zone;                  ///< NOSAVE: mark town to show the local authority zone in the viewports
 
+	std::vector<TileIndex> growth_frontier; ///< road tiles at which the town recently grew, used as starting points for growth
+
 	std::list<PersistentStorage *> psa_list;
 
 	/**
@@ -166,6 +172,11 @@ struct Town : TownPool::PoolItem<&_town_pool> {
 
 	void UpdateVirtCoord();
 
+	/** Mark #stations_near_blocks as out of date, after #stations_near or the catchment of one of its stations changed. */
+	inline void InvalidateStationsNearBlocks() { this->stations_near_blocks_valid = false; }
+
+	const std::vector<Station *> *GetStationsNearBlock(TileIndex tile);
+
 	inline const char *GetCachedName() const
 	{
 		if (!this->name.empty()) return this->name.c_str();
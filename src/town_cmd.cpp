@@ -45,6 +45,7 @@
 #include "townname_func.h"
 #include "core/random_func.hpp"
 #include "core/backup_type.hpp"
+#include "core/checksum_func.hpp"
 #include "depot_base.h"
 #include "object_map.h"
 #include "object_base.h"
@@ -53,6 +54,7 @@
 #include "zoom_func.h"
 #include "zoning.h"
 #include "scope.h"
+#include "trace.h"
 
 #include "table/strings.h"
 #include "table/town_land.h"
@@ -573,6 +575,38 @@ uint32 GetWorldPopulation()
 	return pop;
 }
 
+static const uint TOWN_STATIONS_NEAR_BLOCK_BITS = 4; ///< Size of the blocks of Town::stations_near_blocks, as a power of 2.
+
+/**
+ * Get the stations of #stations_near whose catchment area overlaps the block of tiles of a tile.
+ * The catchment of these stations still has to be checked for the tile itself.
+ * @param tile The tile, usually a house of the town.
+ * @return The stations, sorted by index, or nullptr if there are none.
+ */
+const std::vector<Station *> *Town::GetStationsNearBlock(TileIndex tile)
+{
+	if (!this->stations_near_blocks_valid) {
+		this->stations_near_blocks.clear();
+		for (Station *st : this->stations_near) {
+			const TileArea &area = st->catchment_tiles;
+			if (area.tile == INVALID_TILE) continue;
+			const uint x0 = TileX(area.tile) >> TOWN_STATIONS_NEAR_BLOCK_BITS;
+			const uint y0 = TileY(area.tile) >> TOWN_STATIONS_NEAR_BLOCK_BITS;
+			const uint x1 = (TileX(area.tile) + area.w - 1) >> TOWN_STATIONS_NEAR_BLOCK_BITS;
+			const uint y1 = (TileY(area.tile) + area.h - 1) >> TOWN_STATIONS_NEAR_BLOCK_BITS;
+			for (uint y = y0; y <= y1; y++) {
+				for (uint x = x0; x <= x1; x++) {
+					this->stations_near_blocks[(y << 16) | x].push_back(st);
+				}
+			}
+		}
+		this->stations_near_blocks_valid = true;
+	}
+
+	auto it = this->stations_near_blocks.find(((TileY(tile) >> TOWN_STATIONS_NEAR_BLOCK_BITS) << 16) | (TileX(tile) >> TOWN_STATIONS_NEAR_BLOCK_BITS));
+	return it != this->stations_near_blocks.end() ? &it->second : nullptr;
+}
+
 /**
  * Remove stations from nearby station list if a town is no longer in the catchment area of each.
  * To improve performance only checks stations that cover the provided house area (doesn't need to contain an actual house).
@@ -592,6 +626,7 @@ static void RemoveNearbyStations(Town *t, TileIndex tile, BuildingFlags flags)
 
 		if (covers_area && !st->CatchmentCoversTown(t->index)) {
 			it = t->stations_near.erase(it);
+			t->InvalidateStationsNearBlocks();
 		} else {
 			++it;
 		}
@@ -968,6 +1003,7 @@ static void TownTickHandler(Town *t)
 				/* If growth failed wait a bit before retrying */
 				i = std::min<uint16>(t->growth_rate, TOWN_GROWTH_TICKS - 1);
 			}
+			UpdateStateSubChecksum((((uint64)t->index) << 32) | t->cache.population, SCP_TOWNS);
 		}
 		t->grow_counter = i;
 	}
@@ -975,6 +1011,8 @@ static void TownTickHandler(Town *t)
 
 void OnTick_Town()
 {
+	TRACE_ZONE("OnTick_Town");
+
 	if (_game_mode == GM_EDITOR) return;
 
 	for (Town *t : Town::Iterate()) {
@@ -1825,13 +1863,47 @@ static bool CanFollowRoad(TileIndex tile, DiagDirection dir)
 	}
 }
 
+static const uint TOWN_GROWTH_FRONTIER_SIZE = 64;   ///< Maximum number of tiles in Town::growth_frontier.
+static const int TOWN_GROWTH_FRONTIER_SEARCH = 16;  ///< Number of times to search when growing from a tile of Town::growth_frontier.
+
+/**
+ * Check whether a tile can be used as a starting point for the growth of a town.
+ * @param t The town.
+ * @param tile The tile.
+ * @return true if the tile is a road tile of the town.
+ */
+static bool IsTownGrowthFrontierTile(const Town *t, TileIndex tile)
+{
+	return IsTileType(tile, MP_ROAD) && !IsRoadDepot(tile) && GetTownIndex(tile) == t->index && GetTownRoadBits(tile) != ROAD_NONE;
+}
+
+/**
+ * Remember a tile at which a town grew, as starting point for later growth.
+ * When the frontier is full, a random tile of it is replaced.
+ * @param t The town.
+ * @param tile The road tile at which the town grew.
+ */
+static void AddTownGrowthFrontierTile(Town *t, TileIndex tile)
+{
+	if (!IsTownGrowthFrontierTile(t, tile)) return;
+
+	std::vector<TileIndex> &frontier = t->growth_frontier;
+	if (std::find(frontier.begin(), frontier.end(), tile) != frontier.end()) return;
+	if (frontier.size() < TOWN_GROWTH_FRONTIER_SIZE) {
+		frontier.push_back(tile);
+	} else {
+		frontier[RandomRange(TOWN_GROWTH_FRONTIER_SIZE)] = tile;
+	}
+}
+
 /**
  * Returns "growth" if a house was built, or no if the build failed.
  * @param t town to inquiry
  * @param tile to inquiry
+ * @param from_frontier whether \a tile is a tile of the growth frontier of the town, which limits the search to the area around it
  * @return true if town expansion was possible
  */
-static bool GrowTownAtRoad(Town *t, TileIndex tile)
+static bool GrowTownAtRoad(Town *t, TileIndex tile, bool from_frontier = false)
 {
 	/* Special case.
 	 * @see GrowTownInTile Check the else if
@@ -1857,6 +1929,7 @@ static bool GrowTownAtRoad(Town *t, TileIndex tile)
 			_grow_town_result = 10 + t->cache.num_houses * 4 / 9;
 			break;
 	}
+	if (from_frontier) _grow_town_result = std::min<int>(_grow_town_result, TOWN_GROWTH_FRONTIER_SEARCH);
 
 	do {
 		RoadBits cur_rb = GetTownRoadBits(tile); // The RoadBits of the current tile
@@ -1865,7 +1938,10 @@ static bool GrowTownAtRoad(Town *t, TileIndex tile)
 
 		/* Try to grow the town from this point */
 		GrowTownInTile(&tile, cur_rb, target_dir, t);
-		if (_grow_town_result == GROWTH_SUCCEED) return true;
+		if (_grow_town_result == GROWTH_SUCCEED) {
+			if (_settings_game.economy.town_growth_frontier) AddTownGrowthFrontierTile(t, tile);
+			return true;
+		}
 
 		if (orig_tile == tile) {
 			/* Exclude the source position from the bitmask
@@ -1960,6 +2036,21 @@ static bool GrowTown(Town *t)
 	/* Current "company" is a town */
 	Backup<CompanyID> cur_company(_current_company, OWNER_TOWN, FILE_LINE);
 
+	if (_settings_game.economy.town_growth_frontier && !t->growth_frontier.empty() && Chance16(3, 4)) {
+		/* Grow from a tile at which the town recently grew, instead of searching all the way from the centre. */
+		uint index = RandomRange((uint)t->growth_frontier.size());
+		if (IsTownGrowthFrontierTile(t, t->growth_frontier[index]) && GrowTownAtRoad(t, t->growth_frontier[index], true)) {
+			cur_company.Restore();
+			return true;
+		}
+
+		/* The road is gone or does not lead anywhere anymore, forget it. */
+		t->growth_frontier[index] = t->growth_frontier.back();
+		t->growth_frontier.pop_back();
+		cur_company.Restore();
+		return false;
+	}
+
 	TileIndex tile = t->xy; // The tile we are working with ATM
 
 	/* Find a road that we can base the construction on. */
@@ -2622,7 +2713,7 @@ static void MakeTownHouse(TileIndex t, Town *town, byte counter, byte stage, Hou
 
 	if (!_generating_world) {
 		ForAllStationsAroundTiles(TileArea(t, (size & BUILDING_2_TILES_X) ? 2 : 1, (size & BUILDING_2_TILES_Y) ? 2 : 1), [town](Station *st, TileIndex tile) {
-			town->stations_near.insert(st);
+			if (town->stations_near.insert(st).second) town->InvalidateStationsNearBlocks();
 			return true;
 		});
 	}
@@ -3811,8 +3902,10 @@ static void UpdateTownRating(Town *t)
 		t->ratings[i] = Clamp(t->ratings[i], RATING_MINIMUM, RATING_MAXIMUM);
 	}
 
-	t->UpdateVirtCoord();
-	SetWindowDirty(WC_TOWN_AUTHORITY, t->index);
+	/* The sign only depends on the ratings through the label, the windows are marked dirty by TownsMonthlyLoop. */
+	const StringID old_label = t->town_label;
+	t->UpdateLabel();
+	if (t->town_label != old_label) t->UpdateVirtCoord();
 }
 
 
@@ -3968,8 +4061,6 @@ static void UpdateTownAmounts(Town *t)
 	for (CargoID i = 0; i < NUM_CARGO; i++) t->supplied[i].NewMonth();
 	for (int i = TE_BEGIN; i < TE_END; i++) t->received[i].NewMonth();
 	if (t->fund_buildings_months != 0) t->fund_buildings_months--;
-
-	SetWindowDirty(WC_TOWN_VIEW, t->index);
 }
 
 static void UpdateTownUnwanted(Town *t)
@@ -4218,6 +4309,9 @@ void TownsMonthlyLoop()
 		UpdateTownUnwanted(t);
 	}
 
+	/* Mark the windows of all towns dirty at once, instead of searching the windows of each town. */
+	SetWindowClassesDirty(WC_TOWN_VIEW);
+	SetWindowClassesDirty(WC_TOWN_AUTHORITY);
 }
 
 void TownsYearlyLoop()
@@ -70,6 +70,7 @@ static inline HouseID GetHouseType(TileIndex t)
 static inline void SetHouseType(TileIndex t, HouseID house_id)
 {
 	assert_tile(IsTileType(t, MP_HOUSE), t);
+	MarkTileAcceptanceChanged(t);
 	_m[t].m4 = GB(house_id, 0, 8);
 	SB(_m[t].m3, 5, 2, GB(house_id, 8, 2));
 }
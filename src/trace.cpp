@@ -0,0 +1,215 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file trace.cpp Tracing of named, nested zones of the game loop and drawing. */
+
+#include "stdafx.h"
+#include "trace.h"
+#include "thread.h"
+#include "fileio_func.h"
+#include "string_func.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "safeguards.h"
+
+std::atomic<bool> _trace_enabled; ///< Whether zones are currently recorded.
+
+/** A recorded zone. */
+struct TraceEvent {
+	const char *name; ///< Name of the zone.
+	uint64 start;     ///< Start time, in nanoseconds.
+	uint64 end;       ///< End time, in nanoseconds.
+};
+
+/** Ring buffer of the zones recorded by one thread. */
+struct TraceThreadBuffer {
+	std::mutex lock;                ///< Lock of the events, only contended while the trace is written or restarted.
+	uint tid;                       ///< Identifier of the thread in the trace.
+	std::string thread_name;        ///< Name of the thread.
+	std::vector<TraceEvent> events; ///< Ring buffer of the events.
+	size_t next = 0;                ///< Index of the next event to write.
+	uint64 total = 0;               ///< Number of events written since the trace was started.
+
+	void Reset(uint size)
+	{
+		this->events.assign(size, {});
+		this->next = 0;
+		this->total = 0;
+	}
+};
+
+static std::mutex _trace_buffers_mutex;                             ///< Lock of #_trace_buffers and #_trace_events_per_thread.
+static std::vector<std::unique_ptr<TraceThreadBuffer>> _trace_buffers; ///< The buffers of all threads which have recorded a zone.
+static uint _trace_events_per_thread = 0;                          ///< Size of the ring buffers.
+static thread_local TraceThreadBuffer *_trace_thread_buffer = nullptr; ///< Buffer of the current thread.
+
+/** Create the trace buffer of the current thread. */
+static TraceThreadBuffer *CreateTraceThreadBuffer()
+{
+	std::lock_guard<std::mutex> guard(_trace_buffers_mutex);
+	TraceThreadBuffer *buffer = _trace_buffers.emplace_back(new TraceThreadBuffer()).get();
+	buffer->tid = (uint)_trace_buffers.size();
+
+	char name[64] = "";
+	if (GetCurrentThreadName(name, lastof(name)) <= 0) seprintf(name, lastof(name), "thread %u", buffer->tid);
+	buffer->thread_name = name;
+	buffer->Reset(_trace_events_per_thread);
+	return buffer;
+}
+
+/**
+ * Record a zone of the trace in the buffer of the current thread.
+ * @param name Name of the zone, must outlive the trace.
+ * @param start Start time of the zone, from GetTraceTimestamp.
+ * @param end End time of the zone, from GetTraceTimestamp.
+ */
+void RecordTraceZone(const char *name, uint64 start, uint64 end)
+{
+	TraceThreadBuffer *buffer = _trace_thread_buffer;
+	if (buffer == nullptr) buffer = _trace_thread_buffer = CreateTraceThreadBuffer();
+
+	std::lock_guard<std::mutex> guard(buffer->lock);
+	if (buffer->events.empty()) return;
+	buffer->events[buffer->next] = { name, start, end };
+	buffer->next++;
+	if (buffer->next == buffer->events.size()) buffer->next = 0;
+	buffer->total++;
+}
+
+/**
+ * Clear the trace and start recording zones.
+ * @param events_per_thread Number of most recent events to keep for each thread.
+ */
+void StartTrace(uint events_per_thread)
+{
+	_trace_enabled = false;
+	{
+		std::lock_guard<std::mutex> guard(_trace_buffers_mutex);
+		_trace_events_per_thread = events_per_thread;
+		for (auto &buffer : _trace_buffers) {
+			std::lock_guard<std::mutex> buffer_guard(buffer->lock);
+			buffer->Reset(events_per_thread);
+		}
+	}
+	_trace_enabled = events_per_thread > 0;
+}
+
+/** Stop recording zones, the recorded zones are kept until the trace is started again. */
+void StopTrace()
+{
+	_trace_enabled = false;
+}
+
+/**
+ * Get the number of events in the trace.
+ * @return The number of events kept in the buffers of all threads.
+ */
+uint64 GetTraceEventCount()
+{
+	uint64 count = 0;
+	std::lock_guard<std::mutex> guard(_trace_buffers_mutex);
+	for (auto &buffer : _trace_buffers) {
+		std::lock_guard<std::mutex> buffer_guard(buffer->lock);
+		count += std::min<uint64>(buffer->total, buffer->events.size());
+	}
+	return count;
+}
+
+/**
+ * Write the total time and count of each zone recorded by the current thread within a period.
+ * @param buffer The begin where to write at.
+ * @param last The last position in the buffer to write to.
+ * @param start Start of the period, from GetTraceTimestamp.
+ * @param end End of the period, from GetTraceTimestamp.
+ * @return The position of the terminating zero byte.
+ */
+char *DumpTraceSummary(char *buffer, const char *last, uint64 start, uint64 end)
+{
+	TraceThreadBuffer *thread_buffer = _trace_thread_buffer;
+	if (thread_buffer == nullptr) {
+		buffer += seprintf(buffer, last, "No zones recorded by this thread\n");
+		return buffer;
+	}
+
+	struct ZoneSummary {
+		const char *name;
+		uint count;
+		uint64 total;
+	};
+	std::vector<ZoneSummary> zones;
+	{
+		std::lock_guard<std::mutex> guard(thread_buffer->lock);
+		size_t count = std::min<uint64>(thread_buffer->total, thread_buffer->events.size());
+		for (size_t i = 0; i < count; i++) {
+			const TraceEvent &ev = thread_buffer->events[i];
+			if (ev.start < start || ev.end > end) continue;
+			auto it = std::find_if(zones.begin(), zones.end(), [&](const ZoneSummary &z) { return z.name == ev.name; });
+			if (it == zones.end()) {
+				zones.push_back({ ev.name, 1, ev.end - ev.start });
+			} else {
+				it->count++;
+				it->total += ev.end - ev.start;
+			}
+		}
+	}
+	std::sort(zones.begin(), zones.end(), [](const ZoneSummary &a, const ZoneSummary &b) { return a.total > b.total; });
+
+	buffer += seprintf(buffer, last, "Zones (nested zones are included in the time of the enclosing zones):\n");
+	for (const ZoneSummary &z : zones) {
+		buffer += seprintf(buffer, last, "  %10.3f ms  %6u  %s\n", z.total / 1000000.0, z.count, z.name);
+	}
+	if (zones.empty()) buffer += seprintf(buffer, last, "  none\n");
+	return buffer;
+}
+
+/**
+ * Write the trace in the Chrome trace event format, which can also be opened by Perfetto.
+ * @param filename The name of the file.
+ * @return True when the file was written.
+ */
+bool WriteTrace(const char *filename)
+{
+	FILE *f = FioFOpenFile(filename, "wb", Subdirectory::NO_DIRECTORY);
+	if (f == nullptr) return false;
+	FileCloser fcloser(f);
+
+	std::lock_guard<std::mutex> guard(_trace_buffers_mutex);
+
+	/* Make the timestamps relative to the start of the earliest event, to keep them short. */
+	uint64 origin = UINT64_MAX;
+	for (auto &buffer : _trace_buffers) {
+		std::lock_guard<std::mutex> buffer_guard(buffer->lock);
+		size_t count = std::min<uint64>(buffer->total, buffer->events.size());
+		for (size_t i = 0; i < count; i++) origin = std::min(origin, buffer->events[i].start);
+	}
+
+	fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", f);
+	bool first = true;
+	for (auto &buffer : _trace_buffers) {
+		std::lock_guard<std::mutex> buffer_guard(buffer->lock);
+		fprintf(f, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}", first ? "" : ",\n", buffer->tid, buffer->thread_name.c_str());
+		first = false;
+
+		/* Write the events oldest first. */
+		size_t count = std::min<uint64>(buffer->total, buffer->events.size());
+		size_t index = (count < buffer->events.size()) ? 0 : buffer->next;
+		for (size_t i = 0; i < count; i++) {
+			const TraceEvent &ev = buffer->events[index];
+			fprintf(f, ",\n{\"ph\":\"X\",\"name\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+					ev.name, buffer->tid, (ev.start - origin) / 1000.0, (ev.end - ev.start) / 1000.0);
+			index++;
+			if (index == buffer->events.size()) index = 0;
+		}
+	}
+	fputs("\n]}\n", f);
+	return true;
+}
@@ -0,0 +1,61 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file trace.h Tracing of named, nested zones of the game loop and drawing. */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+
+extern std::atomic<bool> _trace_enabled;
+
+/**
+ * Get the current time of the trace clock.
+ * This is the clock of GetPerformanceTimer, in nanoseconds instead of microseconds.
+ * @return The time in nanoseconds.
+ */
+inline uint64 GetTraceTimestamp()
+{
+	using namespace std::chrono;
+	return (uint64)time_point_cast<nanoseconds>(high_resolution_clock::now()).time_since_epoch().count();
+}
+
+void RecordTraceZone(const char *name, uint64 start, uint64 end);
+void StartTrace(uint events_per_thread);
+void StopTrace();
+uint64 GetTraceEventCount();
+bool WriteTrace(const char *filename);
+char *DumpTraceSummary(char *buffer, const char *last, uint64 start, uint64 end);
+
+/**
+ * RAII class which records a zone of the trace, from its construction to its destruction.
+ * When tracing is not enabled this only costs checking #_trace_enabled.
+ */
+class TraceZone {
+	const char *name; ///< Name of the zone, must be a string literal or otherwise outlive the trace.
+	uint64 start;     ///< Start time of the zone, 0 when tracing was not enabled.
+
+public:
+	TraceZone(const char *name) : name(name), start(_trace_enabled ? GetTraceTimestamp() : 0) {}
+
+	TraceZone(const TraceZone &) = delete;
+
+	~TraceZone()
+	{
+		if (this->start != 0) RecordTraceZone(this->name, this->start, GetTraceTimestamp());
+	}
+};
+
+#define TRACE_ZONE_PASTE2(a, b) a ## b
+#define TRACE_ZONE_PASTE(a, b) TRACE_ZONE_PASTE2(a, b)
+
+/** Record the rest of the current scope as a zone of the trace. */
+#define TRACE_ZONE(name) TraceZone TRACE_ZONE_PASTE(_trace_zone_, __LINE__)(name)
+
+#endif /* TRACE_H */
@@ -152,6 +152,21 @@ static void HandleCondition(std::vector<TraceRestrictCondStackFlags> &condstack,
 	}
 }
 
+/**
+ * Check whether the result of a condition would be ignored by HandleCondition, given the current condition stack
+ */
+static bool IsTraceRestrictConditionResultUnused(const std::vector<TraceRestrictCondStackFlags> &condstack, TraceRestrictCondFlags condflags)
+{
+	if (condflags & (TRCF_OR | TRCF_ELSE)) {
+		/* or-if with an already active block, or else-if/or-if after a taken branch or in an inactive parent */
+		if ((condflags & TRCF_OR) && (condstack.back() & TRCSF_ACTIVE)) return true;
+		return condstack.back() & (TRCSF_DONE_IF | TRCSF_PARENT_INACTIVE);
+	} else {
+		/* nested if within an inactive parent */
+		return !condstack.empty() && !(condstack.back() & TRCSF_ACTIVE);
+	}
+}
+
 /**
  * Integer condition testing
  * Test value op condvalue
@@ -251,6 +266,15 @@ void TraceRestrictProgram::Execute(const Train* v, const TraceRestrictProgramInp
 	TileIndex previous_signal_tile[3];
 
 	size_t size = this->items.size();
+	const bool can_skip = (this->skip_targets.size() == size);
+
+	/* If the block following the conditional item at index i is now inactive, continue from the next item at the same level */
+	auto skip_inactive_block = [&](size_t &i) {
+		if (can_skip && !(condstack.back() & TRCSF_ACTIVE)) {
+			i = this->skip_targets[i] - 1;
+		}
+	};
+
 	for (size_t i = 0; i < size; i++) {
 		TraceRestrictItem item = this->items[i];
 		TraceRestrictItemType type = GetTraceRestrictType(item);
@@ -266,10 +290,16 @@ void TraceRestrictProgram::Execute(const Train* v, const TraceRestrictProgramInp
 					assert(!(condstack.back() & TRCSF_SEEN_ELSE));
 					HandleCondition(condstack, condflags, true);
 					condstack.back() |= TRCSF_SEEN_ELSE;
+					skip_inactive_block(i);
 				} else {
 					// end if
 					condstack.pop_back();
 				}
+			} else if (type == TRIT_COND_UNDEFINED || IsTraceRestrictConditionResultUnused(condstack, condflags)) {
+				/* The result of this condition cannot change the outcome, don't bother evaluating it */
+				if (IsTraceRestrictDoubleItem(item)) i++;
+				HandleCondition(condstack, condflags, false);
+				skip_inactive_block(i);
 			} else {
 				uint16 condvalue = GetTraceRestrictValue(item);
 				bool result = false;
@@ -616,6 +646,7 @@ void TraceRestrictProgram::Execute(const Train* v, const TraceRestrictProgramInp
 						NOT_REACHED();
 				}
 				HandleCondition(condstack, condflags, result);
+				skip_inactive_block(i);
 			}
 		} else {
 			if (condstack.empty() || condstack.back() & TRCSF_ACTIVE) {
@@ -863,6 +894,45 @@ void TraceRestrictProgram::Execute(const Train* v, const TraceRestrictProgramInp
 	assert(condstack.empty());
 }
 
+/**
+ * Rebuild skip_targets for the current item list
+ * If the item list does not have well-formed conditional blocks, skip_targets is left empty
+ */
+void TraceRestrictProgram::BuildSkipTargets()
+{
+	this->skip_targets.clear();
+
+	static std::vector<uint32> block_stack;
+	block_stack.clear();
+
+	std::vector<uint32> targets(this->items.size(), 0);
+	for (size_t i = 0; i < this->items.size(); i++) {
+		TraceRestrictItem item = this->items[i];
+		uint32 index = (uint32)i;
+		if (IsTraceRestrictDoubleItem(item)) i++;
+		if (!IsTraceRestrictConditional(item)) continue;
+
+		TraceRestrictCondFlags condflags = GetTraceRestrictCondFlags(item);
+		if (GetTraceRestrictType(item) == TRIT_COND_ENDIF && !(condflags & TRCF_ELSE)) {
+			// end if
+			if (block_stack.empty()) return;
+			targets[block_stack.back()] = index;
+			block_stack.pop_back();
+		} else if (condflags & (TRCF_OR | TRCF_ELSE)) {
+			// else, else if, or if
+			if (block_stack.empty()) return;
+			targets[block_stack.back()] = index;
+			block_stack.back() = index;
+		} else {
+			// if
+			block_stack.push_back(index);
+		}
+	}
+	if (!block_stack.empty()) return;
+
+	this->skip_targets = std::move(targets);
+}
+
 void TraceRestrictProgram::ClearRefIds()
 {
 	if (this->refcount > 4) free(this->ref_ids.ptr_ref_ids.buffer);
@@ -1817,6 +1887,7 @@ CommandCost CmdProgramSignalTraceRestrict(TileIndex tile, DoCommandFlag flags, u
 		// move in modified program
 		prog->items.swap(items);
 		prog->actions_used_flags = actions_used_flags;
+		prog->BuildSkipTargets();
 
 		if (prog->items.size() == 0 && prog->refcount == 1) {
 			// program is empty, and this tile is the only reference to it
@@ -2129,6 +2200,35 @@ void TraceRestrictUpdateCompanyID(CompanyID old_company, CompanyID new_company)
 
 static std::unordered_multimap<VehicleID, TraceRestrictSlotID> slot_vehicle_index;
 
+/**
+ * Test whether the occupants of this slot have temporary changes, which are not reflected in the slot vehicle index.
+ * @return whether there are temporary changes
+ */
+bool TraceRestrictSlot::HasTemporaryChanges() const
+{
+	if (veh_temporarily_added.empty() && veh_temporarily_removed.empty()) return false;
+	return find_index(veh_temporarily_added, this->index) >= 0 || find_index(veh_temporarily_removed, this->index) >= 0;
+}
+
+/**
+ * Test whether vehicle ID is already an occupant
+ * This uses the slot vehicle index, which only has as many entries for a vehicle as it has slots, instead of searching the occupants.
+ * @param id Vehicle ID
+ * @return whether vehicle ID is an occupant
+ */
+bool TraceRestrictSlot::IsOccupant(VehicleID id) const
+{
+	if (this->HasTemporaryChanges()) {
+		return std::find(this->occupants.begin(), this->occupants.end(), id) != this->occupants.end();
+	}
+
+	const auto range = slot_vehicle_index.equal_range(id);
+	for (auto it = range.first; it != range.second; ++it) {
+		if (it->second == this->index) return true;
+	}
+	return false;
+}
+
 /**
  * Add vehicle ID to occupants if possible and not already an occupant
  * @param id Vehicle ID
@@ -2185,6 +2285,8 @@ bool TraceRestrictSlot::OccupyDryRunUsingTemporaryState(VehicleID id)
  */
 void TraceRestrictSlot::Vacate(VehicleID id)
 {
+	/* Avoid searching the occupants for vehicles which are not in the slot. */
+	if (!this->IsOccupant(id)) return;
 	if (container_unordered_remove(this->occupants, id)) {
 		this->DeIndex(id);
 		this->UpdateSignals();
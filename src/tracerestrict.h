@@ -503,6 +503,13 @@ struct TraceRestrictProgram : TraceRestrictProgramPool::PoolItem<&_tracerestrict
 	uint32 refcount;
 	TraceRestrictProgramActionsUsedFlags actions_used_flags;
 
+	/**
+	 * For each conditional item, the array index of the next conditional item at the same nesting level (elif/orif/else/endif).
+	 * This is used by Execute to skip over inactive blocks without stepping through them.
+	 * This is empty if it has not been built for the current item list, see BuildSkipTargets.
+	 */
+	std::vector<uint32> skip_targets;
+
 private:
 
 	struct ptr_buffer {
@@ -535,6 +542,8 @@ public:
 
 	void Execute(const Train *v, const TraceRestrictProgramInput &input, TraceRestrictProgramResult &out) const;
 
+	void BuildSkipTargets();
+
 	inline const TraceRestrictRefId *GetRefIdsPtr() const { return const_cast<TraceRestrictProgram *>(this)->GetRefIdsPtr(); }
 
 	void IncrementRefCount(TraceRestrictRefId ref_id);
@@ -583,10 +592,12 @@ public:
 		return items.begin() + TraceRestrictProgram::InstructionOffsetToArrayOffset(items, instruction_offset);
 	}
 
-	/** Call validation function on current program instruction list and set actions_used_flags */
+	/** Call validation function on current program instruction list and set actions_used_flags, also rebuilds skip_targets */
 	CommandCost Validate()
 	{
-		return TraceRestrictProgram::Validate(items, actions_used_flags);
+		CommandCost result = TraceRestrictProgram::Validate(items, actions_used_flags);
+		this->BuildSkipTargets();
+		return result;
 	}
 };
 
@@ -1075,14 +1086,7 @@ struct TraceRestrictSlot : TraceRestrictSlotPool::PoolItem<&_tracerestrictslot_p
 		if (!CleaningPool()) this->Clear();
 	}
 
-	/** Test whether vehicle ID is already an occupant */
-	bool IsOccupant(VehicleID id) const {
-		for (size_t i = 0; i < occupants.size(); i++) {
-			if (occupants[i] == id) return true;
-		}
-		return false;
-	}
-
+	bool IsOccupant(VehicleID id) const;
 	bool Occupy(VehicleID id, bool force = false);
 	bool OccupyDryRun(VehicleID ids);
 	bool OccupyDryRunUsingTemporaryState(VehicleID id);
@@ -1092,6 +1096,7 @@ struct TraceRestrictSlot : TraceRestrictSlotPool::PoolItem<&_tracerestrictslot_p
 	void UpdateSignals();
 
 	private:
+	bool HasTemporaryChanges() const;
 	void DeIndex(VehicleID id);
 };
 
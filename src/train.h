@@ -124,6 +124,84 @@ struct TrainCache {
 	byte user_def_data;           ///< Cached property 0x25. Can be set by Callback 0x36.
 };
 
+/**
+ * Memoised results of the realistic braking curve functions of a consist.
+ * The braking curve functions are pure functions of the values in Inputs and their arguments,
+ * results are only reused whilst the inputs are unchanged.
+ */
+struct TrainBrakingCurveCache {
+	static const uint SIZE = 32; ///< Number of entries per curve, must be a power of two.
+
+	/** Values which the braking curves depend on, other than the function arguments. */
+	struct Inputs {
+		int deceleration_x2;
+		int uncapped_deceleration_x2;
+		uint32 weight;
+		uint32 power;
+		uint32 axle_resistance;
+		uint16 braking_length;
+		uint8 acceleration_model;
+		uint8 slope_steepness;
+		uint8 railtype_acceleration_type;
+
+		bool operator==(const Inputs &other) const
+		{
+			return this->deceleration_x2 == other.deceleration_x2 && this->uncapped_deceleration_x2 == other.uncapped_deceleration_x2 &&
+					this->weight == other.weight && this->power == other.power && this->axle_resistance == other.axle_resistance &&
+					this->braking_length == other.braking_length && this->acceleration_model == other.acceleration_model &&
+					this->slope_steepness == other.slope_steepness && this->railtype_acceleration_type == other.railtype_acceleration_type;
+		}
+		bool operator!=(const Inputs &other) const { return !(*this == other); }
+	};
+
+	/** A memoised result, key is INVALID_KEY when unused. */
+	struct Entry {
+		int32 key;
+		int32 end_speed;
+		int32 z_delta;
+		int64 result;
+	};
+
+	static const int32 INVALID_KEY = INT32_MIN;
+
+	Inputs inputs;
+	bool inputs_valid = false;
+	Entry distance_for_speed[SIZE]; ///< Keyed by start speed.
+	Entry speed_for_distance[SIZE]; ///< Keyed by distance.
+
+	TrainBrakingCurveCache() { this->Clear(); }
+
+	void Clear()
+	{
+		this->inputs_valid = false;
+		for (uint i = 0; i < SIZE; i++) {
+			this->distance_for_speed[i].key = INVALID_KEY;
+			this->speed_for_distance[i].key = INVALID_KEY;
+		}
+	}
+
+	static inline uint GetSlot(int32 key, int32 end_speed, int32 z_delta)
+	{
+		uint32 hash = ((uint32)key * 0x9E3779B1U) ^ ((uint32)end_speed * 0x85EBCA77U) ^ ((uint32)z_delta * 0xC2B2AE3DU);
+		return (hash >> 16) & (SIZE - 1);
+	}
+
+	static inline Entry *Find(Entry *table, int32 key, int32 end_speed, int32 z_delta)
+	{
+		Entry *e = &table[GetSlot(key, end_speed, z_delta)];
+		return (e->key == key && e->end_speed == end_speed && e->z_delta == z_delta) ? e : nullptr;
+	}
+
+	static inline void Store(Entry *table, int32 key, int32 end_speed, int32 z_delta, int64 result)
+	{
+		Entry *e = &table[GetSlot(key, end_speed, z_delta)];
+		e->key = key;
+		e->end_speed = end_speed;
+		e->z_delta = z_delta;
+		e->result = result;
+	}
+};
+
 /**
  * 'Train' is either a loco or a wagon.
  */
@@ -135,6 +213,8 @@ struct Train FINAL : public GroundVehicle<Train, VEH_TRAIN> {
 
 	std::unique_ptr<TrainReservationLookAhead> lookahead;
 
+	mutable std::unique_ptr<TrainBrakingCurveCache> braking_curve_cache; ///< Memoised realistic braking curves, allocated on first use
+
 	uint32 flags;
 
 	uint16 crash_anim_pos; ///< Crash animation counter, also used for realistic braking train brake overheating
@@ -194,6 +274,7 @@ struct Train FINAL : public GroundVehicle<Train, VEH_TRAIN> {
 	int UpdateSpeed(MaxSpeedInfo max_speed_info);
 
 	void UpdateAcceleration();
+	void InvalidateBrakingCurveCache();
 
 	bool ConsistNeedsRepair() const;
 
@@ -501,6 +582,7 @@ struct TrainDecelerationStats {
 	int uncapped_deceleration_x2;
 	int z_pos;
 	const Train *t;
+	TrainBrakingCurveCache *curve_cache;
 
 	TrainDecelerationStats(const Train *t, int z_pos);
 };
@@ -520,6 +602,7 @@ inline int GetTileMarginInFrontOfTrain(const Train *v)
 int GetTrainStopLocation(StationID station_id, TileIndex tile, Train *v, bool update_train_state, int *station_ahead, int *station_length);
 
 int GetTrainRealisticAccelerationAtSpeed(const int speed, const int mass, const uint32 cached_power, const uint32 max_te, const uint32 air_drag, const RailType railtype);
+int GetTrainRealisticMaxAchievableSpeed(int mass, const uint32 cached_power, const uint32 max_te, const uint32 air_drag, const RailType railtype, const int speed_cap);
 int GetTrainEstimatedMaxAchievableSpeed(const Train *train, int mass, const int speed_cap);
 
 #endif /* TRAIN_H */
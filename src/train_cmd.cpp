@@ -78,7 +78,7 @@ enum ChooseTrainTrackFlags {
 };
 DECLARE_ENUM_AS_BIT_SET(ChooseTrainTrackFlags)
 
-std::unordered_map<SignalSpeedKey, SignalSpeedValue, SignalSpeedKeyHashFunc> _signal_speeds(1 << 16);
+SignalSpeedMap _signal_speeds;
 
 static void TryLongReserveChooseTrainTrackFromReservationEnd(Train *v, bool no_reserve_vehicle_tile = false);
 static Track ChooseTrainTrack(Train *v, TileIndex tile, DiagDirection enterdir, TrackBits tracks, ChooseTrainTrackFlags flags, bool *p_got_reservation, ChooseTrainTrackLookAheadState lookahead_state = {});
@@ -125,21 +125,13 @@ void ClearAllSignalSpeedRestrictions()
 
 void AdjustAllSignalSpeedRestrictionTickValues(DateTicksScaled delta)
 {
-	for (auto &it : _signal_speeds) {
-		it.second.time_stamp += delta;
-	}
+	_signal_speeds.AdjustTimeStamps(delta);
 }
 
 /** Removes all speed restrictions which have passed their timeout from all signals */
 void ClearOutOfDateSignalSpeedRestrictions()
 {
-	for (auto key_value_pair = _signal_speeds.begin(); key_value_pair != _signal_speeds.end(); ) {
-		if (IsOutOfDate(key_value_pair->second)) {
-			key_value_pair = _signal_speeds.erase(key_value_pair);
-		} else {
-			++key_value_pair;
-		}
-	}
+	_signal_speeds.RemoveOutOfDate(_scaled_date_ticks);
 }
 
 inline void ClearLookAheadIfInvalid(Train *v)
@@ -814,9 +806,36 @@ TrainDecelerationStats::TrainDecelerationStats(const Train *t, int z_pos)
 	this->uncapped_deceleration_x2 = 2 * t->tcache.cached_uncapped_decel;
 	this->z_pos = z_pos;
 	this->t = t;
+
+	TrainBrakingCurveCache::Inputs inputs;
+	inputs.deceleration_x2 = this->deceleration_x2;
+	inputs.uncapped_deceleration_x2 = this->uncapped_deceleration_x2;
+	inputs.weight = t->gcache.cached_weight;
+	inputs.power = t->gcache.cached_power;
+	inputs.axle_resistance = t->gcache.cached_axle_resistance;
+	inputs.braking_length = t->tcache.cached_braking_length;
+	inputs.acceleration_model = _settings_game.vehicle.train_acceleration_model;
+	inputs.slope_steepness = _settings_game.vehicle.train_slope_steepness;
+	inputs.railtype_acceleration_type = GetRailTypeInfo(t->railtype)->acceleration_type;
+
+	if (t->braking_curve_cache == nullptr) t->braking_curve_cache.reset(new TrainBrakingCurveCache());
+	this->curve_cache = t->braking_curve_cache.get();
+	if (!this->curve_cache->inputs_valid || this->curve_cache->inputs != inputs) {
+		this->curve_cache->Clear();
+		this->curve_cache->inputs = inputs;
+		this->curve_cache->inputs_valid = true;
+	}
 }
 
-static int64 GetRealisticBrakingDistanceForSpeed(const TrainDecelerationStats &stats, int start_speed, int end_speed, int z_delta)
+/**
+ * Invalidate the memoised realistic braking curves of the train, the inputs of these have changed.
+ */
+void Train::InvalidateBrakingCurveCache()
+{
+	if (this->braking_curve_cache != nullptr) this->braking_curve_cache->Clear();
+}
+
+static int64 CalculateRealisticBrakingDistanceForSpeed(const TrainDecelerationStats &stats, int start_speed, int end_speed, int z_delta)
 {
 	/* v^2 = u^2 + 2as */
 
@@ -835,7 +854,17 @@ static int64 GetRealisticBrakingDistanceForSpeed(const TrainDecelerationStats &s
 	return dist;
 }
 
-static int GetRealisticBrakingSpeedForDistance(const TrainDecelerationStats &stats, int distance, int end_speed, int z_delta)
+static int64 GetRealisticBrakingDistanceForSpeed(const TrainDecelerationStats &stats, int start_speed, int end_speed, int z_delta)
+{
+	TrainBrakingCurveCache::Entry *e = TrainBrakingCurveCache::Find(stats.curve_cache->distance_for_speed, start_speed, end_speed, z_delta);
+	if (e != nullptr) return e->result;
+
+	int64 dist = CalculateRealisticBrakingDistanceForSpeed(stats, start_speed, end_speed, z_delta);
+	TrainBrakingCurveCache::Store(stats.curve_cache->distance_for_speed, start_speed, end_speed, z_delta, dist);
+	return dist;
+}
+
+static int CalculateRealisticBrakingSpeedForDistance(const TrainDecelerationStats &stats, int distance, int end_speed, int z_delta)
 {
 	/* v^2 = u^2 + 2as */
 
@@ -898,6 +927,16 @@ static int GetRealisticBrakingSpeedForDistance(const TrainDecelerationStats &sta
 	return IntSqrt((uint) speed_sqr);
 }
 
+static int GetRealisticBrakingSpeedForDistance(const TrainDecelerationStats &stats, int distance, int end_speed, int z_delta)
+{
+	TrainBrakingCurveCache::Entry *e = TrainBrakingCurveCache::Find(stats.curve_cache->speed_for_distance, distance, end_speed, z_delta);
+	if (e != nullptr) return (int)e->result;
+
+	int speed = CalculateRealisticBrakingSpeedForDistance(stats, distance, end_speed, z_delta);
+	TrainBrakingCurveCache::Store(stats.curve_cache->speed_for_distance, distance, end_speed, z_delta, speed);
+	return speed;
+}
+
 void LimitSpeedFromLookAhead(int &max_speed, const TrainDecelerationStats &stats, int current_position, int position, int end_speed, int z_delta)
 {
 	if (position <= current_position) {
@@ -1159,6 +1198,8 @@ void Train::UpdateAcceleration()
 {
 	assert(this->IsFrontEngine() || this->IsFreeWagon());
 
+	this->InvalidateBrakingCurveCache();
+
 	uint power = this->gcache.cached_power;
 	uint weight = this->gcache.cached_weight;
 	assert(weight != 0);
@@ -1489,8 +1530,6 @@ static CommandCost CmdBuildRailWagon(TileIndex tile, DoCommandFlag flags, const
 					}
 			}
 		}
-
-		InvalidateVehicleTickCaches();
 	}
 
 	return CommandCost();
@@ -1634,8 +1673,6 @@ CommandCost CmdBuildRailVehicle(TileIndex tile, DoCommandFlag flags, const Engin
 		}
 
 		CheckConsistencyOfArticulatedVehicle(v);
-
-		InvalidateVehicleTickCaches();
 	}
 
 	return CommandCost();
@@ -2246,8 +2283,6 @@ CommandCost CmdMoveRailVehicle(TileIndex tile, DoCommandFlag flags, uint32 p1, u
 		RestoreTrainBackup(original_dst);
 	}
 
-	InvalidateVehicleTickCaches();
-
 	return CommandCost();
 }
 
@@ -2671,6 +2706,10 @@ void UpdateLevelCrossing(TileIndex tile, bool sound, bool force_close)
 	}
 
 	UpdateLevelCrossingTile(tile, sound, adjacent_crossings || force_close, forced_state);
+
+	/* The state of other crossings only depends on this one when they are adjacent crossings. */
+	if (!adjacent_crossings) return;
+
 	for (TileIndex t = TileAddByDiagDir(tile, dir); t < MapSize() && IsLevelCrossingTile(t) && GetCrossingRoadAxis(t) == axis; t = TileAddByDiagDir(t, dir)) {
 		UpdateLevelCrossingTile(t, sound, adjacent_crossings, forced_state);
 	}
@@ -2679,6 +2718,16 @@ void UpdateLevelCrossing(TileIndex tile, bool sound, bool force_close)
 	}
 }
 
+/**
+ * Update the state of all level crossings, e.g. after changing whether adjacent crossings are barred together.
+ */
+void UpdateAllLevelCrossings()
+{
+	for (TileIndex tile = 0; tile < MapSize(); tile++) {
+		if (IsLevelCrossingTile(tile)) UpdateLevelCrossing(tile, false);
+	}
+}
+
 void MarkDirtyAdjacentLevelCrossingTilesOnAddRemove(TileIndex tile, Axis road_axis)
 {
 	if (!(_settings_game.vehicle.safer_crossings && _settings_game.vehicle.adjacent_crossings)) return;
@@ -4342,7 +4391,7 @@ static Track ChooseTrainTrack(Train *v, TileIndex tile, DiagDirection enterdir,
 
 		Track next_track = DoTrainPathfind(v, new_tile, dest_enterdir, tracks, path_found, do_track_reservation, &res_dest);
 		DEBUG_UPDATESTATECHECKSUM("ChooseTrainTrack: v: %u, path_found: %d, next_track: %d", v->index, path_found, next_track);
-		UpdateStateChecksum((((uint64) v->index) << 32) | (path_found << 16) | next_track);
+		UpdateStateChecksum((((uint64) v->index) << 32) | (path_found << 16) | next_track, SCP_VEHICLES);
 		if (new_tile == tile) best_track = next_track;
 		v->HandlePathfindingResult(path_found);
 	}
@@ -5826,7 +5875,7 @@ bool TrainController(Train *v, Vehicle *nomove, bool reverse)
 				v->x_pos = gp.x;
 				v->y_pos = gp.y;
 				v->UpdatePosition();
-				v->UpdateDeltaXY();
+				if (!_network_dedicated) v->UpdateDeltaXY();
 				DecreaseReverseDistance(v);
 				if (v->lookahead != nullptr) AdvanceLookAheadPosition(v);
 				if (HasBit(v->flags, VRF_PENDING_SPEED_RESTRICTION)) DecrementPendingSpeedRestrictions(v);
@@ -5853,7 +5902,7 @@ bool TrainController(Train *v, Vehicle *nomove, bool reverse)
 		}
 
 		/* update image of train, as well as delta XY */
-		v->UpdateDeltaXY();
+		if (!_network_dedicated) v->UpdateDeltaXY();
 
 		v->x_pos = gp.x;
 		v->y_pos = gp.y;
@@ -6611,7 +6660,7 @@ Money Train::GetRunningCost() const
 bool Train::Tick()
 {
 	DEBUG_UPDATESTATECHECKSUM("Train::Tick: v: %u, x: %d, y: %d, track: %d", this->index, this->x_pos, this->y_pos, this->track);
-	UpdateStateChecksum((((uint64) this->x_pos) << 32) | (this->y_pos << 16) | this->track);
+	UpdateStateChecksum((((uint64) this->x_pos) << 32) | (this->y_pos << 16) | this->track, SCP_VEHICLES);
 	if (this->IsFrontEngine()) {
 		if (!((this->vehstatus & VS_STOPPED) || this->IsWaitingInDepot()) || this->cur_speed > 0) this->running_ticks++;
 
@@ -6882,8 +6931,6 @@ Train* CmdBuildVirtualRailWagon(const Engine *e, uint32 user, bool no_consist_ch
 
 	CheckConsistencyOfArticulatedVehicle(v);
 
-	InvalidateVehicleTickCaches();
-
 	return v;
 }
 
@@ -6963,8 +7010,6 @@ Train* BuildVirtualRailVehicle(EngineID eid, StringID &error, uint32 user, bool
 
 	CheckConsistencyOfArticulatedVehicle(v);
 
-	InvalidateVehicleTickCaches();
-
 	return v;
 }
 
@@ -7330,20 +7375,37 @@ int GetTrainRealisticAccelerationAtSpeed(const int speed, const int mass, const
 	return acceleration;
 }
 
-int GetTrainEstimatedMaxAchievableSpeed(const Train *train, int mass, const int speed_cap)
+/**
+ * Get the speed up to which a train with the given properties can accelerate with realistic acceleration.
+ * The acceleration never increases with speed, so the first speed without positive acceleration is found by binary search.
+ * @param mass The mass of the train.
+ * @param cached_power The power of the train.
+ * @param max_te The maximum tractive effort of the train.
+ * @param air_drag The air drag of the train.
+ * @param railtype The rail type to run on.
+ * @param speed_cap The maximum speed to return.
+ * @return The first speed at which the train does not accelerate, or speed_cap (at least 1) when that is lower.
+ */
+int GetTrainRealisticMaxAchievableSpeed(int mass, const uint32 cached_power, const uint32 max_te, const uint32 air_drag, const RailType railtype, const int speed_cap)
 {
-	int max_speed = 0;
-	int acceleration;
-
 	if (mass < 1) mass = 1;
 
-	do
-	{
-		max_speed++;
-		acceleration = GetTrainRealisticAccelerationAtSpeed(max_speed, mass, train->gcache.cached_power, train->gcache.cached_max_te, train->gcache.cached_air_drag, train->railtype);
-	} while (acceleration > 0 && max_speed < speed_cap);
+	int low = 1;
+	int high = std::max(speed_cap, 1);
+	while (low < high) {
+		const int mid = low + (high - low) / 2;
+		if (GetTrainRealisticAccelerationAtSpeed(mid, mass, cached_power, max_te, air_drag, railtype) > 0) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return low;
+}
 
-	return max_speed;
+int GetTrainEstimatedMaxAchievableSpeed(const Train *train, int mass, const int speed_cap)
+{
+	return GetTrainRealisticMaxAchievableSpeed(mass, train->gcache.cached_power, train->gcache.cached_max_te, train->gcache.cached_air_drag, train->railtype, speed_cap);
 }
 
 void SetSignalTrainAdaptationSpeed(const Train *v, TileIndex tile, uint16 track)
@@ -7357,7 +7419,7 @@ void SetSignalTrainAdaptationSpeed(const Train *v, TileIndex tile, uint16 track)
 		speed_value.train_speed = v->First()->cur_speed,
 		speed_value.time_stamp = GetSpeedRestrictionTimeout(v->First())
 	};
-	_signal_speeds[speed_key] = speed_value;
+	_signal_speeds.Set(speed_key, speed_value);
 }
 
 void ApplySignalTrainAdaptationSpeed(Train *v, TileIndex tile, uint16 track)
@@ -7367,14 +7429,14 @@ void ApplySignalTrainAdaptationSpeed(Train *v, TileIndex tile, uint16 track)
 		speed_key.signal_track = track,
 		speed_key.last_passing_train_dir = v->GetVehicleTrackdir()
 	};
-	const auto found_speed_restriction = _signal_speeds.find(speed_key);
+	const SignalSpeedValue *found_speed_restriction = _signal_speeds.Find(speed_key);
 
-	if (found_speed_restriction != _signal_speeds.end()) {
-		if (IsOutOfDate(found_speed_restriction->second)) {
-			_signal_speeds.erase(found_speed_restriction);
+	if (found_speed_restriction != nullptr) {
+		if (IsOutOfDate(*found_speed_restriction)) {
+			_signal_speeds.Erase(speed_key);
 			v->signal_speed_restriction = 0;
 		} else {
-			v->signal_speed_restriction = std::max<uint16>(25, found_speed_restriction->second.train_speed);
+			v->signal_speed_restriction = std::max<uint16>(25, found_speed_restriction->train_speed);
 		}
 	} else {
 		v->signal_speed_restriction = 0;
@@ -0,0 +1,165 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file train_speed_adaptation.cpp Train speed adaptation data structures. */
+
+#include "stdafx.h"
+#include "train_speed_adaptation.h"
+
+#include <algorithm>
+
+#include "safeguards.h"
+
+/**
+ * Find the slot of a key, or the unused slot at which it would be inserted.
+ * @param key Key to find.
+ * @return Slot index.
+ */
+size_t SignalSpeedMap::FindSlot(const SignalSpeedKey &key) const
+{
+	const size_t mask = this->GetMask();
+	size_t slot = Hash(key) & mask;
+	while (IsUsed(this->slots[slot]) && !(this->slots[slot].first == key)) {
+		slot = (slot + 1) & mask;
+	}
+	return slot;
+}
+
+/**
+ * Remove the entry in a used slot.
+ * Following entries of the probe sequence are shifted back, so that no tombstones are required.
+ * @param slot Slot index.
+ */
+void SignalSpeedMap::EraseSlot(size_t slot)
+{
+	const size_t mask = this->GetMask();
+	size_t next = slot;
+	while (true) {
+		next = (next + 1) & mask;
+		if (!IsUsed(this->slots[next])) break;
+		size_t ideal = Hash(this->slots[next].first) & mask;
+		/* Move the entry at next back to slot, if slot is not between its ideal position and next (cyclically) */
+		if (((next - ideal) & mask) >= ((next - slot) & mask)) {
+			this->slots[slot] = this->slots[next];
+			slot = next;
+		}
+	}
+	this->slots[slot].first.signal_tile = INVALID_TILE;
+	this->count--;
+}
+
+/**
+ * Change the table capacity, and re-insert all entries.
+ * @param capacity New capacity, must be a power of two and larger than the number of entries.
+ */
+void SignalSpeedMap::Resize(size_t capacity)
+{
+	std::vector<Entry> old_slots;
+	old_slots.swap(this->slots);
+	Entry empty;
+	empty.first.signal_tile = INVALID_TILE;
+	this->slots.assign(capacity, empty);
+	for (const Entry &entry : old_slots) {
+		if (IsUsed(entry)) this->slots[this->FindSlot(entry.first)] = entry;
+	}
+}
+
+/** Remove all entries. */
+void SignalSpeedMap::clear()
+{
+	this->count = 0;
+	this->expiry.clear();
+	this->slots.clear();
+	this->Resize(MIN_CAPACITY);
+}
+
+/**
+ * Find the value of a key.
+ * @param key Key to find.
+ * @return Pointer to the value, or nullptr if not found. This is invalidated by subsequent changes to the map.
+ */
+SignalSpeedValue *SignalSpeedMap::Find(const SignalSpeedKey &key)
+{
+	Entry &slot = this->slots[this->FindSlot(key)];
+	return IsUsed(slot) ? &slot.second : nullptr;
+}
+
+/**
+ * Insert or replace the value of a key.
+ * @param key Key.
+ * @param value Value.
+ */
+void SignalSpeedMap::Set(const SignalSpeedKey &key, const SignalSpeedValue &value)
+{
+	assert(key.signal_tile != INVALID_TILE);
+
+	size_t slot = this->FindSlot(key);
+	if (!IsUsed(this->slots[slot])) {
+		if ((this->count + 1) * 2 > this->slots.size()) {
+			this->Resize(this->slots.size() * 2);
+			slot = this->FindSlot(key);
+		}
+		this->slots[slot].first = key;
+		this->count++;
+	} else if (this->slots[slot].second.time_stamp == value.time_stamp) {
+		/* Existing expiry item is still correct */
+		this->slots[slot].second = value;
+		return;
+	}
+	this->slots[slot].second = value;
+
+	this->expiry.push_back({ value.time_stamp, key });
+	std::push_heap(this->expiry.begin(), this->expiry.end());
+}
+
+/**
+ * Remove a key, if present.
+ * @param key Key to remove.
+ */
+void SignalSpeedMap::Erase(const SignalSpeedKey &key)
+{
+	size_t slot = this->FindSlot(key);
+	if (IsUsed(this->slots[slot])) this->EraseSlot(slot);
+}
+
+/**
+ * Remove all entries whose time stamp is before now.
+ * This only visits expired entries, and expiry heap items of entries which have since been changed or removed.
+ * @param now Current time.
+ */
+void SignalSpeedMap::RemoveOutOfDate(DateTicksScaled now)
+{
+	while (!this->expiry.empty() && this->expiry.front().time_stamp < now) {
+		const ExpiryItem item = this->expiry.front();
+		std::pop_heap(this->expiry.begin(), this->expiry.end());
+		this->expiry.pop_back();
+
+		size_t slot = this->FindSlot(item.key);
+		if (IsUsed(this->slots[slot]) && this->slots[slot].second.time_stamp == item.time_stamp) this->EraseSlot(slot);
+	}
+
+	if (this->count * 8 < this->slots.size() && this->slots.size() > MIN_CAPACITY) {
+		size_t capacity = this->slots.size();
+		while (this->count * 4 < capacity && capacity > MIN_CAPACITY) capacity /= 2;
+		this->Resize(capacity);
+	}
+}
+
+/**
+ * Add delta to the time stamps of all entries.
+ * @param delta Amount to add.
+ */
+void SignalSpeedMap::AdjustTimeStamps(DateTicksScaled delta)
+{
+	for (Entry &slot : this->slots) {
+		if (IsUsed(slot)) slot.second.time_stamp += delta;
+	}
+	/* A uniform shift does not change the heap ordering */
+	for (ExpiryItem &item : this->expiry) {
+		item.time_stamp += delta;
+	}
+}
@@ -14,7 +14,7 @@
 #include "track_type.h"
 #include "tile_type.h"
 
-#include <unordered_map>
+#include <vector>
 
 struct SignalSpeedKey
 {
@@ -36,19 +36,71 @@ struct SignalSpeedValue
 	DateTicksScaled time_stamp;
 };
 
-struct SignalSpeedKeyHashFunc
-{
-	std::size_t operator() (const SignalSpeedKey &key) const
+/**
+ * Map of signal speed restrictions.
+ * This is a flat open addressing (linear probing) hash table, with a min-heap of expiry time stamps
+ * so that removing out of date entries only visits expired entries.
+ * Heap items are not removed when the entry they refer to is changed or removed, these are skipped when popped.
+ */
+class SignalSpeedMap {
+public:
+	using Entry = std::pair<SignalSpeedKey, SignalSpeedValue>;
+
+private:
+	struct ExpiryItem {
+		DateTicksScaled time_stamp;
+		SignalSpeedKey key;
+
+		bool operator<(const ExpiryItem &other) const { return this->time_stamp > other.time_stamp; } ///< Reversed for a min-heap.
+	};
+
+	static const uint MIN_CAPACITY = 1 << 12;
+
+	std::vector<Entry> slots;          ///< Table slots, unused slots have a signal_tile of INVALID_TILE.
+	std::vector<ExpiryItem> expiry;    ///< Min-heap of entry time stamps.
+	size_t count = 0;                  ///< Number of used slots.
+
+	static inline bool IsUsed(const Entry &slot) { return slot.first.signal_tile != INVALID_TILE; }
+
+	inline size_t GetMask() const { return this->slots.size() - 1; }
+
+	static inline size_t Hash(const SignalSpeedKey &key)
 	{
-		const std::size_t h1 = std::hash<TileIndex>()(key.signal_tile);
-		const std::size_t h2 = std::hash<Trackdir>()(key.last_passing_train_dir);
-		const std::size_t h3 = std::hash<uint16>()(key.signal_track);
+		uint32 h = (key.signal_tile * 0x9E3779B1U) ^ (((uint32)key.signal_track << 8 | (uint32)key.last_passing_train_dir) * 0x85EBCA77U);
+		return h ^ (h >> 16);
+	}
+
+	size_t FindSlot(const SignalSpeedKey &key) const;
+	void EraseSlot(size_t slot);
+	void Resize(size_t capacity);
+
+public:
+	SignalSpeedMap() { this->Resize(MIN_CAPACITY); }
 
-		return (h1 ^ h2) ^ h3;
+	void clear();
+	size_t size() const { return this->count; }
+
+	SignalSpeedValue *Find(const SignalSpeedKey &key);
+	void Set(const SignalSpeedKey &key, const SignalSpeedValue &value);
+	void Erase(const SignalSpeedKey &key);
+	void RemoveOutOfDate(DateTicksScaled now);
+	void AdjustTimeStamps(DateTicksScaled delta);
+
+	/**
+	 * Call a function for each entry, in table order.
+	 * The function must not add or remove entries.
+	 * @param func Function taking a reference to an Entry.
+	 */
+	template <typename F>
+	void ForEach(F func)
+	{
+		for (Entry &slot : this->slots) {
+			if (IsUsed(slot)) func(slot);
+		}
 	}
 };
 
-extern std::unordered_map<SignalSpeedKey, SignalSpeedValue, SignalSpeedKeyHashFunc> _signal_speeds;
+extern SignalSpeedMap _signal_speeds;
 
 struct Train;
 void SetSignalTrainAdaptationSpeed(const Train *v, TileIndex tile, uint16 track);
@@ -23,6 +23,7 @@
 #include "core/random_func.hpp"
 #include "newgrf_generic.h"
 #include "date_func.h"
+#include "trace.h"
 
 #include "table/strings.h"
 #include "table/tree_land.h"
@@ -67,22 +68,25 @@ static const uint16 EDITOR_TREE_DIV = 5;                   ///< Game editor tree
  */
 static bool CanPlantTreesOnTile(TileIndex tile, bool allow_desert)
 {
-	if ((_settings_game.game_creation.tree_placer == TP_PERFECT) &&
-		(_settings_game.game_creation.landscape == LT_ARCTIC) &&
-		(GetTileZ(tile) > (HighestTreePlacementSnowLine() + _settings_game.construction.trees_around_snow_line_range))) {
-		return false;
-	}
-
+	/* Check the tile type first, most random tiles are rejected by it without having to look at the corner heights. */
 	switch (GetTileType(tile)) {
 		case MP_WATER:
-			return !IsBridgeAbove(tile) && IsCoast(tile) && !IsSlopeWithOneCornerRaised(GetTileSlope(tile));
+			if (IsBridgeAbove(tile) || !IsCoast(tile) || IsSlopeWithOneCornerRaised(GetTileSlope(tile))) return false;
+			break;
 
 		case MP_CLEAR:
-			return !IsBridgeAbove(tile) && !IsClearGround(tile, CLEAR_FIELDS) && GetRawClearGround(tile) != CLEAR_ROCKS &&
-			       (allow_desert || !IsClearGround(tile, CLEAR_DESERT));
+			if (IsBridgeAbove(tile) || IsClearGround(tile, CLEAR_FIELDS) || GetRawClearGround(tile) == CLEAR_ROCKS ||
+					(!allow_desert && IsClearGround(tile, CLEAR_DESERT))) {
+				return false;
+			}
+			break;
 
 		default: return false;
 	}
+
+	return !((_settings_game.game_creation.tree_placer == TP_PERFECT) &&
+		(_settings_game.game_creation.landscape == LT_ARCTIC) &&
+		(GetTileZ(tile) > (HighestTreePlacementSnowLine() + _settings_game.construction.trees_around_snow_line_range)));
 }
 
 /**
@@ -1059,6 +1063,8 @@ uint DecrementTreeCounter()
 
 void OnTick_Trees()
 {
+	TRACE_ZONE("OnTick_Trees");
+
 	/* Don't spread trees if that's not allowed */
 	if (_settings_game.construction.extra_tree_placement == ETP_NO_SPREAD || _settings_game.construction.extra_tree_placement == ETP_NO_GROWTH_NO_SPREAD) return;
 
@@ -482,6 +482,7 @@ static inline void SetTunnelBridgeEntranceSignalState(TileIndex t, SignalState s
 {
 	assert_tile(IsTunnelBridgeSignalSimulationEntrance(t), t);
 	SB(_me[t].m6, 0, 1, (state == SIGNAL_STATE_GREEN) ? 1 : 0);
+	_rail_state_generation++;
 }
 
 /**
@@ -494,6 +495,7 @@ static inline void SetTunnelBridgeExitSignalState(TileIndex t, SignalState state
 {
 	assert_tile(IsTunnelBridgeSignalSimulationExit(t), t);
 	SB(_me[t].m6, 7, 1, (state == SIGNAL_STATE_GREEN) ? 1 : 0);
+	_rail_state_generation++;
 }
 
 static inline bool IsTunnelBridgeSemaphore(TileIndex t)
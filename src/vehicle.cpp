@@ -54,12 +54,15 @@
 #include "linkgraph/linkgraph.h"
 #include "linkgraph/refresh.h"
 #include "framerate_type.h"
+#include "trace.h"
 #include "blitter/factory.hpp"
 #include "tbtr_template_vehicle_func.h"
 #include "string_func.h"
 #include "scope_info.h"
 #include "debug_settings.h"
+#include "worker_thread.h"
 #include "3rdparty/cpp-btree/btree_set.h"
+#include INCLUDE_FOR_PREFETCH_NTA
 
 #include "table/strings.h"
 
@@ -452,6 +455,8 @@ Vehicle::Vehicle(VehicleType type)
 	this->last_loading_station = INVALID_STATION;
 	this->cur_image_valid_dir  = INVALID_DIR;
 	this->vcache.cached_veh_flags = 0;
+
+	AddVehicleToTickCaches(this);
 }
 
 /**
@@ -463,25 +468,119 @@ byte VehicleRandomBits()
 	return GB(Random(), 0, 8);
 }
 
-/* Size of the hash, 6 = 64 x 64, 7 = 128 x 128. Larger sizes will (in theory) reduce hash
- * lookup times at the expense of memory usage. */
-const int HASH_BITS = 7;
-const int HASH_SIZE = 1 << HASH_BITS;
-const int HASH_MASK = HASH_SIZE - 1;
-const int TOTAL_HASH_SIZE = 1 << (HASH_BITS * 2);
-const int TOTAL_HASH_MASK = TOTAL_HASH_SIZE - 1;
+/*
+ * Vehicle tile hash.
+ * There is one hash table per vehicle type, each of (1 << (_vehicle_tile_hash_bits_x + _vehicle_tile_hash_bits_y)) buckets.
+ * Buckets have a resolution of 1 tile, and map tiles wrap around the table on each axis.
+ * The table size is chosen from the map size and grows with the number of vehicles, up to a limit,
+ * so that on large maps with many vehicles distant tiles rarely share a bucket.
+ *
+ * In addition, there is a per-tile, per-type occupancy bitmap, allowing lookups of a single tile to be
+ * rejected without walking a bucket's chain. Bits are set when a vehicle moves onto a tile, and cleared
+ * lazily when a lookup of that tile finds no vehicle there.
+ */
+
+/** Minimum number of bits per axis of the tile hash, unless the map is smaller. */
+static const uint VEHICLE_TILE_HASH_MIN_BITS = 7;
+/** Maximum total number of bits (both axes) of each per-type tile hash table. */
+static const uint VEHICLE_TILE_HASH_MAX_TOTAL_BITS = 18;
+
+static std::vector<Vehicle *> _vehicle_tile_hash;
+static uint _vehicle_tile_hash_bits_x;
+static uint _vehicle_tile_hash_bits_y;
+static uint _vehicle_tile_hash_mask_x;
+static uint _vehicle_tile_hash_mask_y;
+
+/** Tile occupancy bitmap, bit (tile * VEH_COMPANY_END + type) is set if there may be a vehicle of that type with that tile. */
+static std::vector<uint64> _vehicle_tile_occupancy;
+
+static inline size_t GetVehicleTileHashIndex(uint x, uint y, VehicleType type)
+{
+	return ((size_t)type << (_vehicle_tile_hash_bits_x + _vehicle_tile_hash_bits_y)) | ((y & _vehicle_tile_hash_mask_y) << _vehicle_tile_hash_bits_x) | (x & _vehicle_tile_hash_mask_x);
+}
+
+static inline Vehicle **GetVehicleTileHashBucket(TileIndex tile, VehicleType type)
+{
+	return &_vehicle_tile_hash[GetVehicleTileHashIndex(TileX(tile), TileY(tile), type)];
+}
+
+static inline size_t GetVehicleTileOccupancyBit(TileIndex tile, VehicleType type)
+{
+	return ((size_t)tile * VEH_COMPANY_END) + type;
+}
+
+static inline bool IsVehicleTileOccupancySet(TileIndex tile, VehicleType type)
+{
+	const size_t bit = GetVehicleTileOccupancyBit(tile, type);
+	return HasBit(_vehicle_tile_occupancy[bit / 64], bit % 64);
+}
+
+static inline void SetVehicleTileOccupancy(TileIndex tile, VehicleType type)
+{
+	const size_t bit = GetVehicleTileOccupancyBit(tile, type);
+	SetBit(_vehicle_tile_occupancy[bit / 64], bit % 64);
+}
+
+static inline void ClearVehicleTileOccupancy(TileIndex tile, VehicleType type)
+{
+	const size_t bit = GetVehicleTileOccupancyBit(tile, type);
+	ClrBit(_vehicle_tile_occupancy[bit / 64], bit % 64);
+}
+
+/**
+ * Get the total number of tile hash bits (both axes) to use for a per-type hash table.
+ * @param vehicles Number of vehicles to size the table for.
+ * @return Total number of bits.
+ */
+static uint GetVehicleTileHashTotalBits(size_t vehicles)
+{
+	const uint max_bits = std::min(MapLogX() + MapLogY(), VEHICLE_TILE_HASH_MAX_TOTAL_BITS);
+	uint bits = std::min(VEHICLE_TILE_HASH_MIN_BITS * 2, max_bits);
+	while (bits < max_bits && ((size_t)1 << bits) < vehicles * 2) bits++;
+	return bits;
+}
 
-/* Resolution of the hash, 0 = 1*1 tile, 1 = 2*2 tiles, 2 = 4*4 tiles, etc.
- * Profiling results show that 0 is fastest. */
-const int HASH_RES = 0;
+/**
+ * Set the tile hash size and clear the tile hash and occupancy bitmap.
+ * @param total_bits Total number of bits (both axes) of each per-type table.
+ */
+static void SetVehicleTileHashSize(uint total_bits)
+{
+	_vehicle_tile_hash_bits_x = std::min(MapLogX(), (total_bits + 1) / 2);
+	_vehicle_tile_hash_bits_y = std::min(MapLogY(), total_bits - _vehicle_tile_hash_bits_x);
+	_vehicle_tile_hash_bits_x = std::min(MapLogX(), total_bits - _vehicle_tile_hash_bits_y);
+	_vehicle_tile_hash_mask_x = (1 << _vehicle_tile_hash_bits_x) - 1;
+	_vehicle_tile_hash_mask_y = (1 << _vehicle_tile_hash_bits_y) - 1;
+
+	_vehicle_tile_hash.assign((size_t)VEH_COMPANY_END << (_vehicle_tile_hash_bits_x + _vehicle_tile_hash_bits_y), nullptr);
+	_vehicle_tile_occupancy.assign(((size_t)MapSize() * VEH_COMPANY_END + 63) / 64, 0);
+}
+
+void UpdateVehicleTileHash(Vehicle *v, bool remove);
+
+/**
+ * Grow the tile hash if the number of vehicles has outgrown it, rehashing all vehicles.
+ * The order of vehicles within a hash chain does not affect the game state.
+ */
+static void CheckVehicleTileHashSize()
+{
+	const uint total_bits = GetVehicleTileHashTotalBits(Vehicle::GetNumItems());
+	if (total_bits <= _vehicle_tile_hash_bits_x + _vehicle_tile_hash_bits_y) return;
 
-static Vehicle *_vehicle_tile_hash[TOTAL_HASH_SIZE * 4];
+	SetVehicleTileHashSize(total_bits);
+	for (Vehicle *v : Vehicle::Iterate()) {
+		v->hash_tile_current = nullptr;
+	}
+	for (Vehicle *v : Vehicle::Iterate()) {
+		if (v->type < VEH_COMPANY_END) UpdateVehicleTileHash(v, false);
+	}
+}
 
-static Vehicle *VehicleFromTileHash(int xl, int yl, int xu, int yu, VehicleType type, void *data, VehicleFromPosProc *proc, bool find_first)
+static Vehicle *VehicleFromTileHash(uint xl, uint yl, uint xu, uint yu, VehicleType type, void *data, VehicleFromPosProc *proc, bool find_first)
 {
-	for (int y = yl; ; y = (y + (1 << HASH_BITS)) & (HASH_MASK << HASH_BITS)) {
-		for (int x = xl; ; x = (x + 1) & HASH_MASK) {
-			Vehicle *v = _vehicle_tile_hash[((x + y) & TOTAL_HASH_MASK) + (TOTAL_HASH_SIZE * type)];
+	for (uint y = yl; ; y = (y + 1) & _vehicle_tile_hash_mask_y) {
+		for (uint x = xl; ; x = (x + 1) & _vehicle_tile_hash_mask_x) {
+			Vehicle *v = _vehicle_tile_hash[GetVehicleTileHashIndex(x, y, type)];
 			for (; v != nullptr; v = v->hash_tile_next) {
 				Vehicle *a = proc(v, data);
 				if (find_first && a != nullptr) return a;
@@ -495,6 +594,26 @@ static Vehicle *VehicleFromTileHash(int xl, int yl, int xu, int yu, VehicleType
 }
 
 
+/**
+ * Helper function for FindVehicleOnPosXYArea.
+ * @note Do not call this function directly!
+ * @param xl   The lowest X location on the map
+ * @param yl   The lowest Y location on the map
+ * @param xu   The highest X location on the map
+ * @param yu   The highest Y location on the map
+ * @param data Arbitrary data passed to proc
+ * @param proc The proc that determines whether a vehicle will be "found".
+ * @param find_first Whether to return on the first found or iterate over
+ *                   all vehicles
+ * @return the best matching or first vehicle (depending on find_first).
+ */
+Vehicle *VehicleFromPosXYArea(int xl, int yl, int xu, int yu, VehicleType type, void *data, VehicleFromPosProc *proc, bool find_first)
+{
+	/* Hash area to scan is from xl,yl to xu,yu */
+	return VehicleFromTileHash((xl / TILE_SIZE) & _vehicle_tile_hash_mask_x, (yl / TILE_SIZE) & _vehicle_tile_hash_mask_y,
+			(xu / TILE_SIZE) & _vehicle_tile_hash_mask_x, (yu / TILE_SIZE) & _vehicle_tile_hash_mask_y, type, data, proc, find_first);
+}
+
 /**
  * Helper function for FindVehicleOnPos/HasVehicleOnPos.
  * @note Do not call this function directly!
@@ -510,13 +629,7 @@ Vehicle *VehicleFromPosXY(int x, int y, VehicleType type, void *data, VehicleFro
 {
 	const int COLL_DIST = 6;
 
-	/* Hash area to scan is from xl,yl to xu,yu */
-	int xl = GB((x - COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS);
-	int xu = GB((x + COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS);
-	int yl = GB((y - COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS) << HASH_BITS;
-	int yu = GB((y + COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS) << HASH_BITS;
-
-	return VehicleFromTileHash(xl, yl, xu, yu, type, data, proc, find_first);
+	return VehicleFromPosXYArea(x - COLL_DIST, y - COLL_DIST, x + COLL_DIST, y + COLL_DIST, type, data, proc, find_first);
 }
 
 /**
@@ -531,17 +644,21 @@ Vehicle *VehicleFromPosXY(int x, int y, VehicleType type, void *data, VehicleFro
  */
 Vehicle *VehicleFromPos(TileIndex tile, VehicleType type, void *data, VehicleFromPosProc *proc, bool find_first)
 {
-	int x = GB(TileX(tile), HASH_RES, HASH_BITS);
-	int y = GB(TileY(tile), HASH_RES, HASH_BITS) << HASH_BITS;
+	if (!IsVehicleTileOccupancySet(tile, type)) return nullptr;
 
-	Vehicle *v = _vehicle_tile_hash[((x + y) & TOTAL_HASH_MASK) + (TOTAL_HASH_SIZE * type)];
+	bool found_on_tile = false;
+	Vehicle *v = *GetVehicleTileHashBucket(tile, type);
 	for (; v != nullptr; v = v->hash_tile_next) {
 		if (v->tile != tile) continue;
 
+		found_on_tile = true;
 		Vehicle *a = proc(v, data);
 		if (find_first && a != nullptr) return a;
 	}
 
+	/* No vehicle of this type is on the tile any more */
+	if (!found_on_tile) ClearVehicleTileOccupancy(tile, type);
+
 	return nullptr;
 }
 
@@ -833,9 +950,8 @@ void UpdateVehicleTileHash(Vehicle *v, bool remove)
 	if (remove || HasBit(v->subtype, GVSF_VIRTUAL)) {
 		new_hash = nullptr;
 	} else {
-		int x = GB(TileX(v->tile), HASH_RES, HASH_BITS);
-		int y = GB(TileY(v->tile), HASH_RES, HASH_BITS) << HASH_BITS;
-		new_hash = &_vehicle_tile_hash[((x + y) & TOTAL_HASH_MASK) + (TOTAL_HASH_SIZE * v->type)];
+		SetVehicleTileOccupancy(v->tile, v->type);
+		new_hash = GetVehicleTileHashBucket(v->tile, v->type);
 	}
 
 	if (old_hash == new_hash) return;
@@ -862,9 +978,7 @@ bool ValidateVehicleTileHash(const Vehicle *v)
 {
 	if ((v->type == VEH_TRAIN && Train::From(v)->IsVirtual()) || v->type >= VEH_COMPANY_END) return v->hash_tile_current == nullptr;
 
-	int x = GB(TileX(v->tile), HASH_RES, HASH_BITS);
-	int y = GB(TileY(v->tile), HASH_RES, HASH_BITS) << HASH_BITS;
-	return v->hash_tile_current == &_vehicle_tile_hash[((x + y) & TOTAL_HASH_MASK) + (TOTAL_HASH_SIZE * v->type)];
+	return v->hash_tile_current == GetVehicleTileHashBucket(v->tile, v->type) && IsVehicleTileOccupancySet(v->tile, v->type);
 }
 
 static Vehicle *_vehicle_viewport_hash[1 << (GEN_HASHX_BITS + GEN_HASHY_BITS)];
@@ -938,11 +1052,54 @@ static void ProcessDeferredUpdateVehicleViewportHashes()
 	_viewport_hash_deferred.clear();
 }
 
+/**
+ * Set when vehicle sprites, sprite bounds, bounding box offsets and the viewport hash have not been
+ * kept up to date because there is no screen (dedicated server). These are only rebuilt if something is actually drawn.
+ */
+bool _vehicle_viewport_state_stale = false;
+
+/**
+ * Rebuild the vehicle viewport state which is not maintained on dedicated servers, before drawing a viewport (e.g. for a screenshot).
+ */
+static void RebuildHeadlessVehicleViewportState()
+{
+	_vehicle_viewport_state_stale = false;
+
+	for (Vehicle *v : Vehicle::Iterate()) {
+		switch (v->type) {
+			case VEH_ROAD:
+			case VEH_TRAIN:
+			case VEH_SHIP:
+				v->GetImage(v->direction, EIT_ON_MAP, &v->sprite_seq);
+				break;
+
+			case VEH_AIRCRAFT:
+				if (Aircraft::From(v)->IsNormalAircraft()) {
+					v->GetImage(v->direction, EIT_ON_MAP, &v->sprite_seq);
+
+					/* The plane's shadow will have the same image as the plane, but no colour */
+					Vehicle *shadow = v->Next();
+					shadow->sprite_seq.CopyWithoutPalette(v->sprite_seq);
+
+					if (v->subtype == AIR_HELICOPTER) GetRotorImage(Aircraft::From(v), EIT_ON_MAP, &shadow->Next()->sprite_seq);
+				}
+				break;
+
+			default:
+				break;
+		}
+		v->sprite_seq_bounds = v->sprite_seq.GetBounds();
+		v->UpdateDeltaXY();
+		v->UpdateViewportDeferred();
+	}
+	ProcessDeferredUpdateVehicleViewportHashes();
+}
+
 void ResetVehicleHash()
 {
 	for (Vehicle *v : Vehicle::Iterate()) { v->hash_tile_current = nullptr; }
 	memset(_vehicle_viewport_hash, 0, sizeof(_vehicle_viewport_hash));
-	memset(_vehicle_tile_hash, 0, sizeof(_vehicle_tile_hash));
+	SetVehicleTileHashSize(GetVehicleTileHashTotalBits(Vehicle::GetNumItems()));
 }
 
 void ResetVehicleColourMap()
@@ -1165,7 +1322,8 @@ void Vehicle::PreDestructor()
 		OrderBackup::ClearVehicle(this);
 	}
 	InvalidateWindowClassesData(GetWindowClassForVehicleType(this->type), 0);
-	InvalidateWindowClassesData(WC_DEPARTURES_BOARD, 0);
+	/* Departure boards only list primary vehicles, don't rebuild them for each removed effect vehicle or wagon. */
+	if (this->IsPrimaryVehicle()) InvalidateWindowClassesData(WC_DEPARTURES_BOARD, 0);
 
 	this->cargo.Truncate();
 	DeleteVehicleOrders(this);
@@ -1181,6 +1339,9 @@ void Vehicle::PreDestructor()
 	if (this->IsDrawn()) this->MarkAllViewportsDirty();
 }
 
+/** Vehicles whose cargo is due to be aged at the end of the current vehicle type tick phase */
+static std::vector<Vehicle *> _tick_cargo_aging_pending;
+
 Vehicle::~Vehicle()
 {
 	if (CleaningPool()) {
@@ -1188,9 +1349,9 @@ Vehicle::~Vehicle()
 		return;
 	}
 
-	if (this->type != VEH_EFFECT) InvalidateVehicleTickCaches();
+	RemoveVehicleFromTickCaches(this);
 
-	if (this->type == VEH_DISASTER) RemoveFromOtherVehicleTickCache(this);
+	if (!_tick_cargo_aging_pending.empty()) container_unordered_remove(_tick_cargo_aging_pending, this);
 
 	if (this->breakdowns_since_last_service) _vehicles_to_pay_repair.erase(this->index);
 
@@ -1259,6 +1420,8 @@ void CallVehicleOnNewDay(Vehicle *v)
  */
 static void RunVehicleDayProc()
 {
+	TRACE_ZONE("RunVehicleDayProc");
+
 	if (_game_mode != GM_NORMAL) return;
 
 	/* Run the day_proc for every DAY_TICKS vehicle starting at _date_fract. */
@@ -1323,13 +1486,61 @@ static void ShowAutoReplaceAdviceMessage(const CommandCost &res, const Vehicle *
 	AddVehicleAdviceNewsItem(message, v->index);
 }
 
+/**
+ * Tick cache of vehicles of one category.
+ * Membership is maintained incrementally as an ordered set of vehicle IDs, so that vehicles are ticked in pool index order.
+ * The vector of vehicle pointers which is iterated each tick is only regenerated from the ID set when the membership has changed.
+ */
+template <typename T>
+struct VehicleTickCache {
+	btree::btree_set<VehicleID> ids;       ///< Members of the cache, in pool index order.
+	std::vector<VehicleID> vehicle_ids;    ///< IDs corresponding to the entries in vehicles.
+	std::vector<T *> vehicles;             ///< Vehicles to tick. Entries are set to nullptr if removed since the last refresh.
+	bool dirty = false;                    ///< Whether vehicles needs to be regenerated from ids.
+
+	void Clear()
+	{
+		this->ids.clear();
+		this->vehicle_ids.clear();
+		this->vehicles.clear();
+		this->dirty = false;
+	}
+
+	void Insert(VehicleID id)
+	{
+		if (this->ids.insert(id).second) this->dirty = true;
+	}
+
+	void Remove(VehicleID id)
+	{
+		if (this->ids.erase(id) == 0) return;
+		this->dirty = true;
+
+		/* The vehicle may be removed whilst vehicles is being iterated, remove it from there as well */
+		auto iter = std::lower_bound(this->vehicle_ids.begin(), this->vehicle_ids.end(), id);
+		if (iter != this->vehicle_ids.end() && *iter == id) this->vehicles[iter - this->vehicle_ids.begin()] = nullptr;
+	}
+
+	void Refresh()
+	{
+		if (!this->dirty) return;
+		this->vehicle_ids.assign(this->ids.begin(), this->ids.end());
+		this->vehicles.clear();
+		this->vehicles.reserve(this->vehicle_ids.size());
+		for (VehicleID id : this->vehicle_ids) {
+			this->vehicles.push_back(static_cast<T *>(Vehicle::Get(id)));
+		}
+		this->dirty = false;
+	}
+};
+
 bool _tick_caches_valid = false;
 std::vector<Train *> _tick_train_too_heavy_cache;
-std::vector<Train *> _tick_train_front_cache;
-std::vector<RoadVehicle *> _tick_road_veh_front_cache;
-std::vector<Aircraft *> _tick_aircraft_front_cache;
-std::vector<Ship *> _tick_ship_cache;
-std::vector<Vehicle *> _tick_other_veh_cache;
+static VehicleTickCache<Train> _tick_train_front_cache;
+static VehicleTickCache<RoadVehicle> _tick_road_veh_front_cache;
+static VehicleTickCache<Aircraft> _tick_aircraft_front_cache;
+static VehicleTickCache<Ship> _tick_ship_cache;
+static VehicleTickCache<Vehicle> _tick_other_veh_cache;
 
 std::vector<VehicleID> _remove_from_tick_effect_veh_cache;
 btree::btree_set<VehicleID> _tick_effect_veh_cache;
@@ -1337,19 +1548,68 @@ btree::btree_set<VehicleID> _tick_effect_veh_cache;
 void ClearVehicleTickCaches()
 {
 	_tick_train_too_heavy_cache.clear();
-	_tick_train_front_cache.clear();
-	_tick_road_veh_front_cache.clear();
-	_tick_aircraft_front_cache.clear();
-	_tick_ship_cache.clear();
+	_tick_train_front_cache.Clear();
+	_tick_road_veh_front_cache.Clear();
+	_tick_aircraft_front_cache.Clear();
+	_tick_ship_cache.Clear();
 	_tick_effect_veh_cache.clear();
 	_remove_from_tick_effect_veh_cache.clear();
-	_tick_other_veh_cache.clear();
+	_tick_other_veh_cache.Clear();
 }
 
-void RemoveFromOtherVehicleTickCache(const Vehicle *v)
+/**
+ * Add or remove a vehicle to/from the tick caches, according to its type and position in its chain.
+ * Effect vehicles are handled separately, see EffectVehicle::AddEffectVehicleToTickCache.
+ * @param v Vehicle.
+ * @param present Whether the vehicle is present in the pool, false if it is being deleted.
+ */
+static void UpdateVehicleTickCacheMembership(const Vehicle *v, bool present)
 {
-	for (auto &u : _tick_other_veh_cache) {
-		if (u == v) u = nullptr;
+	const bool front = present && v->Previous() == nullptr;
+	switch (v->type) {
+		case VEH_TRAIN:
+			if (front) {
+				_tick_train_front_cache.Insert(v->index);
+			} else {
+				_tick_train_front_cache.Remove(v->index);
+			}
+			break;
+
+		case VEH_ROAD:
+			if (front) {
+				_tick_road_veh_front_cache.Insert(v->index);
+			} else {
+				_tick_road_veh_front_cache.Remove(v->index);
+			}
+			break;
+
+		case VEH_AIRCRAFT:
+			if (front) {
+				_tick_aircraft_front_cache.Insert(v->index);
+			} else {
+				_tick_aircraft_front_cache.Remove(v->index);
+			}
+			break;
+
+		case VEH_SHIP:
+			if (present) {
+				_tick_ship_cache.Insert(v->index);
+			} else {
+				_tick_ship_cache.Remove(v->index);
+			}
+			break;
+
+		case VEH_EFFECT:
+		case VEH_INVALID:
+			break;
+
+		default:
+			if (present) {
+				_tick_other_veh_cache.Insert(v->index);
+			} else {
+				_tick_other_veh_cache.Remove(v->index);
+			}
+			break;
 	}
 }
 
@@ -1363,33 +1623,43 @@ void RebuildVehicleTickCaches()
 	for (Vehicle *v : Vehicle::Iterate()) {
 		si_v = v;
 		switch (v->type) {
-			default:
-				_tick_other_veh_cache.push_back(v);
-				break;
-
 			case VEH_TRAIN:
 				if (HasBit(Train::From(v)->flags, VRF_TOO_HEAVY)) _tick_train_too_heavy_cache.push_back(Train::From(v));
-				if (v->Previous() == nullptr) _tick_train_front_cache.push_back(Train::From(v));
-				break;
-
-			case VEH_ROAD:
-				if (v->Previous() == nullptr) _tick_road_veh_front_cache.push_back(RoadVehicle::From(v));
-				break;
-
-			case VEH_AIRCRAFT:
-				if (v->Previous() == nullptr) _tick_aircraft_front_cache.push_back(Aircraft::From(v));
-				break;
-
-			case VEH_SHIP:
-				_tick_ship_cache.push_back(Ship::From(v));
 				break;
 
 			case VEH_EFFECT:
 				_tick_effect_veh_cache.insert(v->index);
 				break;
+
+			default:
+				break;
 		}
+		UpdateVehicleTickCacheMembership(v, true);
 	}
 	_tick_caches_valid = true;
+
+	_tick_train_front_cache.Refresh();
+	_tick_road_veh_front_cache.Refresh();
+	_tick_aircraft_front_cache.Refresh();
+	_tick_ship_cache.Refresh();
+	_tick_other_veh_cache.Refresh();
+}
+
+/**
+ * Regenerate the iterated form of any tick caches whose membership has changed, or rebuild all tick caches if they are not valid.
+ */
+static void RefreshVehicleTickCaches()
+{
+	if (!_tick_caches_valid || HasChickenBit(DCBF_VEH_TICK_CACHE)) {
+		RebuildVehicleTickCaches();
+		return;
+	}
+
+	_tick_train_front_cache.Refresh();
+	_tick_road_veh_front_cache.Refresh();
+	_tick_aircraft_front_cache.Refresh();
+	_tick_ship_cache.Refresh();
+	_tick_other_veh_cache.Refresh();
 }
 
 void ValidateVehicleTickCaches()
@@ -1400,27 +1670,56 @@ void ValidateVehicleTickCaches()
 	std::sort(saved_tick_train_too_heavy_cache.begin(), saved_tick_train_too_heavy_cache.end(), [&](const Vehicle *a, const Vehicle *b) {
 		return a->index < b->index;
 	});
-    saved_tick_train_too_heavy_cache.erase(std::unique(saved_tick_train_too_heavy_cache.begin(), saved_tick_train_too_heavy_cache.end()), saved_tick_train_too_heavy_cache.end());
-	std::vector<Train *> saved_tick_train_front_cache = std::move(_tick_train_front_cache);
-	std::vector<RoadVehicle *> saved_tick_road_veh_front_cache = std::move(_tick_road_veh_front_cache);
-	std::vector<Aircraft *> saved_tick_aircraft_front_cache = std::move(_tick_aircraft_front_cache);
-	std::vector<Ship *> saved_tick_ship_cache = std::move(_tick_ship_cache);
+	saved_tick_train_too_heavy_cache.erase(std::unique(saved_tick_train_too_heavy_cache.begin(), saved_tick_train_too_heavy_cache.end()), saved_tick_train_too_heavy_cache.end());
+	btree::btree_set<VehicleID> saved_tick_train_front_cache = std::move(_tick_train_front_cache.ids);
+	btree::btree_set<VehicleID> saved_tick_road_veh_front_cache = std::move(_tick_road_veh_front_cache.ids);
+	btree::btree_set<VehicleID> saved_tick_aircraft_front_cache = std::move(_tick_aircraft_front_cache.ids);
+	btree::btree_set<VehicleID> saved_tick_ship_cache = std::move(_tick_ship_cache.ids);
 	btree::btree_set<VehicleID> saved_tick_effect_veh_cache = std::move(_tick_effect_veh_cache);
 	for (VehicleID id : _remove_from_tick_effect_veh_cache) {
 		saved_tick_effect_veh_cache.erase(id);
 	}
-	std::vector<Vehicle *> saved_tick_other_veh_cache = std::move(_tick_other_veh_cache);
-	saved_tick_other_veh_cache.erase(std::remove(saved_tick_other_veh_cache.begin(), saved_tick_other_veh_cache.end(), nullptr), saved_tick_other_veh_cache.end());
+	btree::btree_set<VehicleID> saved_tick_other_veh_cache = std::move(_tick_other_veh_cache.ids);
 
 	RebuildVehicleTickCaches();
 
 	assert(saved_tick_train_too_heavy_cache == _tick_train_too_heavy_cache);
-	assert(saved_tick_train_front_cache == saved_tick_train_front_cache);
-	assert(saved_tick_road_veh_front_cache == _tick_road_veh_front_cache);
-	assert(saved_tick_aircraft_front_cache == _tick_aircraft_front_cache);
-	assert(saved_tick_ship_cache == _tick_ship_cache);
+	assert(saved_tick_train_front_cache == _tick_train_front_cache.ids);
+	assert(saved_tick_road_veh_front_cache == _tick_road_veh_front_cache.ids);
+	assert(saved_tick_aircraft_front_cache == _tick_aircraft_front_cache.ids);
+	assert(saved_tick_ship_cache == _tick_ship_cache.ids);
 	assert(saved_tick_effect_veh_cache == _tick_effect_veh_cache);
-	assert(saved_tick_other_veh_cache == _tick_other_veh_cache);
+	assert(saved_tick_other_veh_cache == _tick_other_veh_cache.ids);
+}
+
+/**
+ * Add a newly constructed vehicle to the tick caches.
+ * @param v Vehicle.
+ */
+void AddVehicleToTickCaches(const Vehicle *v)
+{
+	if (!_tick_caches_valid) return;
+	UpdateVehicleTickCacheMembership(v, true);
+}
+
+/**
+ * Remove a vehicle which is being deleted from the tick caches.
+ * @param v Vehicle.
+ */
+void RemoveVehicleFromTickCaches(const Vehicle *v)
+{
+	if (!_tick_caches_valid) return;
+	UpdateVehicleTickCacheMembership(v, false);
+}
+
+/**
+ * Update the tick caches for a vehicle which may have become, or stopped being, the first vehicle in its chain.
+ * @param v Vehicle.
+ */
+void UpdateVehicleTickCacheFrontState(const Vehicle *v)
+{
+	if (!_tick_caches_valid) return;
+	UpdateVehicleTickCacheMembership(v, true);
 }
 
 void VehicleTickCargoAging(Vehicle *v)
@@ -1428,12 +1727,46 @@ void VehicleTickCargoAging(Vehicle *v)
 	if (v->vcache.cached_cargo_age_period != 0) {
 		v->cargo_age_counter = std::min(v->cargo_age_counter, v->vcache.cached_cargo_age_period);
 		if (--v->cargo_age_counter == 0) {
-			v->cargo.AgeCargo();
+			_tick_cargo_aging_pending.push_back(v);
 			v->cargo_age_counter = v->vcache.cached_cargo_age_period;
 		}
 	}
 }
 
+/**
+ * Age the cargo of all vehicles queued by VehicleTickCargoAging.
+ * This only increments a counter in the cargo list of each vehicle, the packets are aged lazily.
+ */
+static void FlushVehicleTickCargoAging()
+{
+	for (Vehicle *v : _tick_cargo_aging_pending) {
+		v->cargo.AgeCargo();
+	}
+	_tick_cargo_aging_pending.clear();
+}
+
+/** Number of entries ahead of the current position to prefetch when iterating a vehicle tick cache */
+static const size_t TICK_CACHE_PREFETCH_DISTANCE = 4;
+
+/**
+ * Prefetch the fields of an upcoming vehicle in a tick cache which are read first by the tick procs.
+ * The tick caches are contiguous arrays of pointers into the vehicle pool, so the next vehicles are known well in advance,
+ * and the pool accesses do not need to each wait for a cache miss.
+ * @param cache Tick cache.
+ * @param index Index of the entry in the tick cache to prefetch, this may be past the end of the cache.
+ */
+template <typename T>
+static inline void PrefetchVehicleTickCacheEntry(const std::vector<T *> &cache, size_t index)
+{
+	if (index >= cache.size()) return;
+	const T *v = cache[index];
+	if (v == nullptr) return;
+	PREFETCH_NTA(v)
+	PREFETCH_NTA(&v->vehstatus)
+	PREFETCH_NTA(&v->cur_speed)
+	PREFETCH_NTA(&v->vcache)
+}
+
 void VehicleTickMotion(Vehicle *v, Vehicle *front)
 {
 	/* Do not play any sound when crashed */
@@ -1458,6 +1791,8 @@ void VehicleTickMotion(Vehicle *v, Vehicle *front)
 
 void CallVehicleTicks()
 {
+	TRACE_ZONE("CallVehicleTicks");
+
 	_vehicles_to_autoreplace.clear();
 	_vehicles_to_templatereplace.clear();
 	_vehicles_to_pay_repair.clear();
@@ -1470,6 +1805,7 @@ void CallVehicleTicks()
 		 * Vehicle::OnPeriodic is decoupled from Vehicle::OnNewDay at day lengths >= 8
 		 * Use a fixed interval of 512 ticks (unscaled) instead
 		 */
+		TRACE_ZONE("CallVehicleTicks: OnPeriodic");
 
 		Vehicle *v = nullptr;
 		SCOPE_INFO_FMT([&v], "CallVehicleTicks -> OnPeriodic: %s", scope_dumper().VehicleInfo(v));
@@ -1507,11 +1843,19 @@ void CallVehicleTicks()
 		}
 	}
 
-	if (!_tick_caches_valid || HasChickenBit(DCBF_VEH_TICK_CACHE)) RebuildVehicleTickCaches();
+	{
+		TRACE_ZONE("CallVehicleTicks: refresh caches");
+		RefreshVehicleTickCaches();
+		CheckVehicleTileHashSize();
+	}
+
+	/* Vehicle movement marks many small overlapping areas dirty, merge these before marking the viewport dirty blocks */
+	BeginViewportDirtyBatch();
 
 	Vehicle *v = nullptr;
 	SCOPE_INFO_FMT([&v], "CallVehicleTicks: %s", scope_dumper().VehicleInfo(v));
 	{
+		TRACE_ZONE("CallVehicleTicks: effect vehicles");
 		for (VehicleID id : _remove_from_tick_effect_veh_cache) {
 			_tick_effect_veh_cache.erase(id);
 		}
@@ -1535,7 +1879,11 @@ void CallVehicleTicks()
 			}
 		}
 		_tick_train_too_heavy_cache.clear();
-		for (Train *front : _tick_train_front_cache) {
+		const std::vector<Train *> &cache = _tick_train_front_cache.vehicles;
+		for (size_t i = 0; i < cache.size(); i++) {
+			PrefetchVehicleTickCacheEntry(cache, i + TICK_CACHE_PREFETCH_DISTANCE);
+			Train *front = cache[i];
+			if (front == nullptr) continue;
 			v = front;
 			if (!front->Train::Tick()) continue;
 			for (Train *u = front; u != nullptr; u = u->Next()) {
@@ -1544,10 +1892,15 @@ void CallVehicleTicks()
 				if (!u->IsWagon() && !((front->vehstatus & VS_STOPPED) && front->cur_speed == 0)) VehicleTickMotion(u, front);
 			}
 		}
+		FlushVehicleTickCargoAging();
 	}
 	{
 		PerformanceMeasurer framerate(PFE_GL_ROADVEHS);
-		for (RoadVehicle *front : _tick_road_veh_front_cache) {
+		const std::vector<RoadVehicle *> &cache = _tick_road_veh_front_cache.vehicles;
+		for (size_t i = 0; i < cache.size(); i++) {
+			PrefetchVehicleTickCacheEntry(cache, i + TICK_CACHE_PREFETCH_DISTANCE);
+			RoadVehicle *front = cache[i];
+			if (front == nullptr) continue;
 			v = front;
 			if (!front->RoadVehicle::Tick()) continue;
 			for (RoadVehicle *u = front; u != nullptr; u = u->Next()) {
@@ -1556,10 +1909,15 @@ void CallVehicleTicks()
 			}
 			if (!(front->vehstatus & VS_STOPPED)) VehicleTickMotion(front, front);
 		}
+		FlushVehicleTickCargoAging();
 	}
 	{
 		PerformanceMeasurer framerate(PFE_GL_AIRCRAFT);
-		for (Aircraft *front : _tick_aircraft_front_cache) {
+		const std::vector<Aircraft *> &cache = _tick_aircraft_front_cache.vehicles;
+		for (size_t i = 0; i < cache.size(); i++) {
+			PrefetchVehicleTickCacheEntry(cache, i + TICK_CACHE_PREFETCH_DISTANCE);
+			Aircraft *front = cache[i];
+			if (front == nullptr) continue;
 			v = front;
 			if (!front->Aircraft::Tick()) continue;
 			for (Aircraft *u = front; u != nullptr; u = u->Next()) {
@@ -1567,18 +1925,25 @@ void CallVehicleTicks()
 			}
 			if (!(front->vehstatus & VS_STOPPED)) VehicleTickMotion(front, front);
 		}
+		FlushVehicleTickCargoAging();
 	}
 	{
 		PerformanceMeasurer framerate(PFE_GL_SHIPS);
-		for (Ship *s : _tick_ship_cache) {
+		const std::vector<Ship *> &cache = _tick_ship_cache.vehicles;
+		for (size_t i = 0; i < cache.size(); i++) {
+			PrefetchVehicleTickCacheEntry(cache, i + TICK_CACHE_PREFETCH_DISTANCE);
+			Ship *s = cache[i];
+			if (s == nullptr) continue;
 			v = s;
 			if (!s->Ship::Tick()) continue;
 			VehicleTickCargoAging(s);
 			if (!(s->vehstatus & VS_STOPPED)) VehicleTickMotion(s, s);
 		}
+		FlushVehicleTickCargoAging();
 	}
 	{
-		for (Vehicle *u : _tick_other_veh_cache) {
+		TRACE_ZONE("CallVehicleTicks: other vehicles");
+		for (Vehicle *u : _tick_other_veh_cache.vehicles) {
 			if (!u) continue;
 			v = u;
 			u->Tick();
@@ -1586,7 +1951,15 @@ void CallVehicleTicks()
 	}
 	v = nullptr;
 
+	{
+		TRACE_ZONE("CallVehicleTicks: mark dirty");
+		EndViewportDirtyBatch();
+	}
+
+	SettleSharingFees();
+
 	/* Handle vehicles marked for immediate sale */
+	TRACE_ZONE("CallVehicleTicks: sell, replace and repair");
 	Backup<CompanyID> sell_cur_company(_current_company, FILE_LINE);
 	for (VehicleID index : _vehicles_to_sell) {
 		Vehicle *v = Vehicle::Get(index);
@@ -1742,11 +2115,11 @@ void CallVehicleTicks()
 
 void RemoveVirtualTrainsOfUser(uint32 user)
 {
-	if (!_tick_caches_valid || HasChickenBit(DCBF_VEH_TICK_CACHE)) RebuildVehicleTickCaches();
+	RefreshVehicleTickCaches();
 
 	Backup<CompanyID> cur_company(_current_company, FILE_LINE);
-	for (const Train *front : _tick_train_front_cache) {
-		if (front->IsVirtual() && front->motion_counter == user) {
+	for (const Train *front : _tick_train_front_cache.vehicles) {
+		if (front != nullptr && front->IsVirtual() && front->motion_counter == user) {
 			cur_company.Change(front->owner);
 			DoCommandP(0, front->index, 0, CMD_DELETE_VIRTUAL_TRAIN);
 		}
@@ -1896,6 +2269,8 @@ void ViewportAddVehiclesIntl(DrawPixelInfo *dpi)
  */
 void ViewportAddVehicles(DrawPixelInfo *dpi, bool update_vehicles)
 {
+	if (unlikely(_vehicle_viewport_state_stale)) RebuildHeadlessVehicleViewportState();
+
 	if (update_vehicles) {
 		ViewportAddVehiclesIntl<true>(dpi);
 	} else {
@@ -1905,6 +2280,8 @@ void ViewportAddVehicles(DrawPixelInfo *dpi, bool update_vehicles)
 
 void ViewportMapDrawVehicles(DrawPixelInfo *dpi, Viewport *vp)
 {
+	if (unlikely(_vehicle_viewport_state_stale)) RebuildHeadlessVehicleViewportState();
+
 	/* The save rectangle */
 	const int l = vp->virtual_left;
 	const int r = vp->virtual_left + vp->virtual_width;
@@ -2624,7 +3001,10 @@ void VehicleEnterDepot(Vehicle *v)
 void Vehicle::UpdateViewport(bool dirty)
 {
 	/* Skip updating sprites on dedicated servers without screen */
-	if (_network_dedicated) return;
+	if (_network_dedicated) {
+		_vehicle_viewport_state_stale = true;
+		return;
+	}
 
 	Rect new_coord = ConvertRect<Rect16, Rect>(this->sprite_seq_bounds);
 
@@ -2683,6 +3063,7 @@ void Vehicle::UpdatePositionAndViewport()
  */
 void Vehicle::MarkAllViewportsDirty() const
 {
+	if (_network_dedicated) return;
 	::MarkAllViewportsDirty(this->coord.left, this->coord.top, this->coord.right, this->coord.bottom, VMDF_NOT_LANDSCAPE | (this->type != VEH_EFFECT ? VMDF_NONE : VMDF_NOT_MAP_MODE));
 }
 
@@ -4065,6 +4446,7 @@ void Vehicle::SetNext(Vehicle *next)
 			v->first = this->next;
 		}
 		this->next->previous = nullptr;
+		UpdateVehicleTickCacheFrontState(this->next);
 	}
 
 	this->next = next;
@@ -4076,6 +4458,7 @@ void Vehicle::SetNext(Vehicle *next)
 		for (Vehicle *v = this->next; v != nullptr; v = v->Next()) {
 			v->first = this->first;
 		}
+		UpdateVehicleTickCacheFrontState(this->next);
 	}
 }
 
@@ -4308,10 +4691,10 @@ void VehiclesYearlyLoop()
 			v->profit_last_year = v->profit_this_year;
 			v->profit_lifetime += v->profit_this_year;
 			v->profit_this_year = 0;
-			SetWindowDirty(WC_VEHICLE_DETAILS, v->index);
 		}
 	}
 	GroupStatistics::UpdateProfits();
+	SetWindowClassesDirty(WC_VEHICLE_DETAILS);
 	SetWindowClassesDirty(WC_TRAINS_LIST);
 	SetWindowClassesDirty(WC_TRACE_RESTRICT_SLOTS);
 	SetWindowClassesDirty(WC_SHIPS_LIST);
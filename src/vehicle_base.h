@@ -88,6 +88,29 @@ struct NewGRFCache {
 	uint8  cache_valid;               ///< Bitset that indicates which cache values are valid.
 };
 
+/** Cached result of a vehicle callback. */
+struct VehicleCallbackCacheEntry {
+	uint32 param1;   ///< First parameter of the callback.
+	uint32 param2;   ///< Second parameter of the callback.
+	EngineID engine; ///< Engine type the callback was evaluated for.
+	uint16 callback; ///< The callback, see #CallbackID.
+	uint16 result;   ///< Result of the callback.
+	CargoID cargo_type;  ///< Cargo type of the vehicle when the callback was evaluated, this may be changed temporarily without invalidating the cache.
+	byte cargo_subtype;  ///< Cargo subtype of the vehicle when the callback was evaluated.
+};
+
+static const uint VEHICLE_CALLBACK_CACHE_SIZE = 4; ///< Number of callback results cached per vehicle.
+
+/**
+ * Results of vehicle callbacks which only read variables which are constant until the NewGRF cache of the vehicle is invalidated.
+ * @see Vehicle::InvalidateNewGRFCache
+ */
+struct VehicleCallbackCache {
+	VehicleCallbackCacheEntry entries[VEHICLE_CALLBACK_CACHE_SIZE];
+	uint8 count; ///< Number of valid entries.
+	uint8 next;  ///< Entry to replace when adding to a full cache.
+};
+
 /** Meaning of the various bits of the visual effect. */
 enum VisualEffect {
 	VE_OFFSET_START        = 0, ///< First bit that contains the offset (0 = front, 8 = centre, 15 = rear)
@@ -230,6 +253,8 @@ extern std::unordered_multimap<VehicleID, PendingSpeedRestrictionChange> pending
 typedef Pool<Vehicle, VehicleID, 512, 0xFF000> VehiclePool;
 extern VehiclePool _vehicle_pool;
 
+extern bool _vehicle_viewport_state_stale;
+
 /* Some declarations of functions, so we can make them friendly */
 struct GroundVehicleCache;
 extern SaveLoadTable GetVehicleDescription(VehicleType vt);
@@ -378,6 +403,7 @@ public:
 	Direction cur_image_valid_dir;      ///< NOSAVE: direction for which cur_image does not need to be regenerated on the next tick
 
 	NewGRFCache grf_cache;              ///< Cache of often used calculated NewGRF values
+	VehicleCallbackCache callback_cache; ///< NOSAVE: Cache of NewGRF callback results, see #GetVehicleCallback
 	VehicleCache vcache;                ///< Cache of often used vehicle values.
 
 	Vehicle(VehicleType type = VEH_INVALID);
@@ -505,6 +531,8 @@ public:
 	inline void InvalidateNewGRFCache()
 	{
 		this->grf_cache.cache_valid = 0;
+		this->callback_cache.count = 0;
+		this->callback_cache.next = 0;
 	}
 
 	/**
@@ -1146,6 +1174,11 @@ public:
 
 	inline void UpdateSpriteSeqBound()
 	{
+		/* Skip sprite bounds on dedicated servers without screen, see RebuildHeadlessVehicleViewportState */
+		if (_network_dedicated) {
+			_vehicle_viewport_state_stale = true;
+			return;
+		}
 		this->sprite_seq_bounds = this->sprite_seq.GetBounds();
 	}
 
@@ -1435,7 +1468,10 @@ public:
 	inline void UpdateViewport(bool force_update, bool update_delta)
 	{
 		/* Skip updating sprites on dedicated servers without screen */
-		if (_network_dedicated) return;
+		if (_network_dedicated) {
+			_vehicle_viewport_state_stale = true;
+			return;
+		}
 
 		/* Explicitly choose method to call to prevent vtable dereference -
 		 * it gives ~3% runtime improvements in games with many vehicles */
@@ -1497,7 +1533,9 @@ inline void InvalidateVehicleTickCaches()
 }
 
 void ClearVehicleTickCaches();
-void RemoveFromOtherVehicleTickCache(const Vehicle *v);
+void AddVehicleToTickCaches(const Vehicle *v);
+void RemoveVehicleFromTickCaches(const Vehicle *v);
+void UpdateVehicleTickCacheFrontState(const Vehicle *v);
 void UpdateAllVehiclesIsDrawn();
 
 void ShiftVehicleDates(int interval);
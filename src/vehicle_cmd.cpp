@@ -1057,7 +1057,6 @@ void UpdateNewVirtualTrainFromSource(Train *v, const T *src)
 	}
 
 	v->First()->ConsistChanged(CCF_ARRANGE);
-	InvalidateVehicleTickCaches();
 }
 
 Train* VirtualTrainFromTemplateVehicle(const TemplateVehicle* tv, StringID &err, uint32 user)
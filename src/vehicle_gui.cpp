@@ -44,6 +44,7 @@
 
 #include <vector>
 #include <algorithm>
+#include <unordered_map>
 
 #include "safeguards.h"
 
@@ -477,17 +478,36 @@ DropDownList BaseVehicleListWindow::BuildActionDropdownList(bool show_autoreplac
 	return list;
 }
 
-/* cached values for VehicleNameSorter to spare many GetString() calls */
-static const Vehicle *_last_vehicle[2] = { nullptr, nullptr };
+/* Sort keys which are expensive to compute, cached for the duration of a single sort of a list.
+ * These are unordered maps as references to the keys must stay valid while other keys are inserted. */
+static std::unordered_map<VehicleID, std::string> _vehicle_sort_name;
+static std::unordered_map<VehicleID, CargoArray> _vehicle_sort_capacity;
+static std::unordered_map<VehicleID, Money> _vehicle_sort_value;
+static std::unordered_map<VehicleID, int> _vehicle_max_speed_loaded;
 
-static btree::btree_map<VehicleID, int> _vehicle_max_speed_loaded;
+/**
+ * Get a sort key of a vehicle, computing it only the first time during a sort.
+ * @param cache The cached keys of the sort key type.
+ * @param v The vehicle.
+ * @param compute Function computing the key of the vehicle.
+ * @return The sort key.
+ */
+template <typename T, typename F>
+static const T &GetVehicleSortKey(std::unordered_map<VehicleID, T> &cache, const Vehicle *v, F compute)
+{
+	auto res = cache.insert({ v->index, T() });
+	if (res.second) res.first->second = compute(v);
+	return res.first->second;
+}
 
 void BaseVehicleListWindow::SortVehicleList()
 {
-	if (this->vehgroups.Sort()) return;
+	if (!this->vehgroups.Sort()) return;
 
-	/* invalidate cached values for name sorter - vehicle names could change */
-	_last_vehicle[0] = _last_vehicle[1] = nullptr;
+	/* invalidate cached sort keys - vehicle names, capacities and values could change before the next sort */
+	_vehicle_sort_name.clear();
+	_vehicle_sort_capacity.clear();
+	_vehicle_sort_value.clear();
 	_vehicle_max_speed_loaded.clear();
 }
 
@@ -1485,21 +1505,12 @@ static bool VehicleNumberSorter(const Vehicle * const &a, const Vehicle * const
 /** Sort vehicles by their name */
 static bool VehicleNameSorter(const Vehicle * const &a, const Vehicle * const &b)
 {
-	static char last_name[2][64];
-
-	if (a != _last_vehicle[0]) {
-		_last_vehicle[0] = a;
-		SetDParam(0, a->index);
-		GetString(last_name[0], STR_VEHICLE_NAME, lastof(last_name[0]));
-	}
-
-	if (b != _last_vehicle[1]) {
-		_last_vehicle[1] = b;
-		SetDParam(0, b->index);
-		GetString(last_name[1], STR_VEHICLE_NAME, lastof(last_name[1]));
-	}
+	auto get_name = [](const Vehicle *v) -> std::string {
+		SetDParam(0, v->index);
+		return GetString(STR_VEHICLE_NAME);
+	};
 
-	int r = strnatcmp(last_name[0], last_name[1]); // Sort by name (natural sorting).
+	int r = strnatcmp(GetVehicleSortKey(_vehicle_sort_name, a, get_name).c_str(), GetVehicleSortKey(_vehicle_sort_name, b, get_name).c_str()); // Sort by name (natural sorting).
 	return (r != 0) ? r < 0: VehicleNumberSorter(a, b);
 }
 
@@ -1534,16 +1545,19 @@ static bool VehicleProfitLifetimeSorter(const Vehicle * const &a, const Vehicle
 /** Sort vehicles by their cargo */
 static bool VehicleCargoSorter(const Vehicle * const &a, const Vehicle * const &b)
 {
-	const Vehicle *v;
-	CargoArray diff;
+	auto get_capacity = [](const Vehicle *v) -> CargoArray {
+		/* Append the cargo of the connected waggons */
+		CargoArray capacity;
+		for (const Vehicle *u = v; u != nullptr; u = u->Next()) capacity[u->cargo_type] += u->cargo_cap;
+		return capacity;
+	};
 
-	/* Append the cargo of the connected waggons */
-	for (v = a; v != nullptr; v = v->Next()) diff[v->cargo_type] += v->cargo_cap;
-	for (v = b; v != nullptr; v = v->Next()) diff[v->cargo_type] -= v->cargo_cap;
+	const CargoArray &capacity_a = GetVehicleSortKey(_vehicle_sort_capacity, a, get_capacity);
+	const CargoArray &capacity_b = GetVehicleSortKey(_vehicle_sort_capacity, b, get_capacity);
 
 	int r = 0;
 	for (CargoID i = 0; i < NUM_CARGO; i++) {
-		r = diff[i];
+		r = capacity_a[i] - capacity_b[i];
 		if (r != 0) break;
 	}
 
@@ -1574,13 +1588,13 @@ static bool VehicleModelSorter(const Vehicle * const &a, const Vehicle * const &
 /** Sort vehicles by their value */
 static bool VehicleValueSorter(const Vehicle * const &a, const Vehicle * const &b)
 {
-	const Vehicle *u;
-	Money diff = 0;
-
-	for (u = a; u != nullptr; u = u->Next()) diff += u->value;
-	for (u = b; u != nullptr; u = u->Next()) diff -= u->value;
+	auto get_value = [](const Vehicle *v) -> Money {
+		Money value = 0;
+		for (const Vehicle *u = v; u != nullptr; u = u->Next()) value += u->value;
+		return value;
+	};
 
-	int r = ClampToI32(diff);
+	int r = ClampToI32(GetVehicleSortKey(_vehicle_sort_value, a, get_value) - GetVehicleSortKey(_vehicle_sort_value, b, get_value));
 	return (r != 0) ? r < 0 : VehicleNumberSorter(a, b);
 }
 
@@ -1615,23 +1629,16 @@ static bool VehicleAverageOrderOccupancySorter(const Vehicle * const &a, const V
 /** Sort vehicles by the max speed (fully loaded) */
 static bool VehicleMaxSpeedLoadedSorter(const Vehicle * const &a, const Vehicle * const &b)
 {
-	auto get_max_speed_loaded = [](const Train * const v) -> int {
-		auto res = _vehicle_max_speed_loaded.insert({ v->index, 0 });
-		if (!res.second) {
-			/* This vehicle's speed was already in _vehicle_max_speed_loaded */
-			return res.first->second;
-		}
+	auto get_max_speed_loaded = [](const Vehicle *v) -> int {
+		const Train *t = Train::From(v);
 		int loaded_weight = 0;
-		for (const Train *u = v; u != nullptr; u = u->Next()) {
+		for (const Train *u = t; u != nullptr; u = u->Next()) {
 			loaded_weight += u->GetWeightWithoutCargo() + u->GetCargoWeight(u->cargo_cap);
 		}
-
-		int loaded_max_speed = GetTrainEstimatedMaxAchievableSpeed(v, loaded_weight, v->GetDisplayMaxSpeed());
-		res.first->second = loaded_max_speed;
-		return loaded_max_speed;
+		return GetTrainEstimatedMaxAchievableSpeed(t, loaded_weight, t->GetDisplayMaxSpeed());
 	};
 
-	int r = get_max_speed_loaded(Train::From(a)) - get_max_speed_loaded(Train::From(b));
+	int r = GetVehicleSortKey(_vehicle_max_speed_loaded, a, get_max_speed_loaded) - GetVehicleSortKey(_vehicle_max_speed_loaded, b, get_max_speed_loaded);
 	return (r != 0) ? r < 0 : VehicleNumberSorter(a, b);
 }
 
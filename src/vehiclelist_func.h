@@ -0,0 +1,52 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file vehiclelist_func.h Functions for finding the vehicles of vehicle lists. */
+
+#ifndef VEHICLELIST_FUNC_H
+#define VEHICLELIST_FUNC_H
+
+#include "order_base.h"
+#include "vehicle_base.h"
+
+#include <algorithm>
+#include <vector>
+
+/**
+ * Find the vehicles which have an order matching a condition.
+ * The orders of each shared order list are only checked once, instead of once for each vehicle sharing them.
+ * @param veh_pred Condition the vehicles must match.
+ * @param ord_pred Condition which at least one of the orders of the vehicle must match.
+ * @param veh_func Function to call for each vehicle found, in order of vehicle index.
+ */
+template <typename VehiclePredicate, typename OrderPredicate, typename VehicleFunc>
+void FindVehiclesWithOrder(VehiclePredicate veh_pred, OrderPredicate ord_pred, VehicleFunc veh_func)
+{
+	std::vector<const Vehicle *> found;
+
+	for (OrderList *orderlist : OrderList::Iterate()) {
+		bool match = false;
+		for (const Order *order : Vehicle::IterateWrapper(orderlist)) {
+			if (ord_pred(order)) {
+				match = true;
+				break;
+			}
+		}
+		if (!match) continue;
+
+		for (const Vehicle *v = orderlist->GetFirstSharedVehicle(); v != nullptr; v = v->NextShared()) {
+			if (veh_pred(v)) found.push_back(v);
+		}
+	}
+
+	std::sort(found.begin(), found.end(), [](const Vehicle *a, const Vehicle *b) {
+		return a->index < b->index;
+	});
+	for (const Vehicle *v : found) veh_func(v);
+}
+
+#endif /* VEHICLELIST_FUNC_H */
@@ -13,10 +13,22 @@
 #include "../saveload/saveload.h"
 #include "../window_func.h"
 #include "../thread.h"
+#include "../framerate_type.h"
+#include "../fileio_func.h"
+#include "../core/checksum_func.hpp"
+#include "../core/random_func.hpp"
+#include "../date_func.h"
 #include "null_v.h"
 
 #include <atomic>
 
+#if defined(_WIN32)
+#	include <windows.h>
+#	include <psapi.h>
+#elif defined(UNIX)
+#	include <sys/resource.h>
+#endif
+
 #include "../safeguards.h"
 
 /** Factory for the null video driver. */
@@ -35,6 +47,9 @@ const char *VideoDriver_Null::Start(const StringList &parm)
 
 	this->ticks = GetDriverParamInt(parm, "ticks", 1000);
 	this->until_exit = GetDriverParamBool(parm, "until_exit");
+	const char *benchmark = GetDriverParam(parm, "benchmark");
+	this->benchmark = benchmark != nullptr;
+	this->benchmark_file = benchmark != nullptr ? benchmark : "";
 	_screen.width  = _screen.pitch = _cur_resolution.width;
 	_screen.height = _cur_resolution.height;
 	_screen.dst_ptr = nullptr;
@@ -50,23 +65,104 @@ void VideoDriver_Null::Stop() { }
 
 void VideoDriver_Null::MakeDirty(int left, int top, int width, int height) {}
 
+/**
+ * Get the peak resident memory use of the process.
+ * @return The peak memory use in KiB, or 0 if unknown.
+ */
+static uint64 GetPeakMemoryUse()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return counters.PeakWorkingSetSize / 1024;
+#elif defined(UNIX)
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(__APPLE__)
+		return usage.ru_maxrss / 1024;
+#else
+		return usage.ru_maxrss;
+#endif
+	}
+#endif
+	return 0;
+}
+
+/**
+ * Write the timings of the run, the statistics of the performance elements and the state of the simulation
+ * in a machine readable format, to compare the performance and the outcome of runs of the same savegame.
+ * @param load_us Time spent on the first game loop, which loads the savegame, in microseconds.
+ * @param run_us Time spent on the remaining game loops, in microseconds.
+ * @param ticks_run Number of game loops after the first one.
+ */
+void VideoDriver_Null::WriteBenchmarkReport(uint64 load_us, uint64 run_us, int ticks_run)
+{
+	/* Time a save of the final state; it is written to the autosave directory so it can be compared as well. */
+	TimingMeasurement save_start = GetPerformanceTimer();
+	bool saved = SaveOrLoad("benchmark.sav", SLO_SAVE, DFT_GAME_FILE, AUTOSAVE_DIR, false) == SL_OK;
+	uint64 save_us = GetPerformanceTimer() - save_start;
+
+	FILE *f = stdout;
+	if (!this->benchmark_file.empty()) {
+		f = FioFOpenFile(this->benchmark_file, "wt", Subdirectory::NO_DIRECTORY);
+		if (f == nullptr) {
+			DEBUG(misc, 0, "Could not open benchmark report file: %s", this->benchmark_file.c_str());
+			return;
+		}
+	}
+
+	fprintf(f, "benchmark ticks=%d load_ms=%.3f run_ms=%.3f ticks_per_sec=%.2f save_ms=%.3f peak_rss_kib=" OTTD_PRINTF64U "\n",
+			ticks_run, load_us / 1000.0, run_us / 1000.0, run_us > 0 ? ticks_run * 1000000.0 / run_us : 0.0,
+			saved ? save_us / 1000.0 : -1.0, GetPeakMemoryUse());
+	fprintf(f, "checksum date=%d date_fract=%d random=%08x:%08x state=" OTTD_PRINTFHEX64PAD "\n",
+			(int)_date, _date_fract, _random.state[0], _random.state[1], _state_checksum.state);
+	for (PerformanceElement e = PFE_FIRST; e < PFE_MAX; e++) {
+		PerformanceSummary summary;
+		if (!GetPerformanceSummary(e, GetPerformanceDataPointCount(), summary)) continue;
+		fprintf(f, "perf %s n=%u rate=%.2f avg=%.3f p50=%.3f p95=%.3f p99=%.3f max=%.3f\n",
+				GetPerformanceElementKey(e), summary.samples, summary.rate, summary.average, summary.p50, summary.p95, summary.p99, summary.max);
+	}
+
+	if (f != stdout) {
+		fclose(f);
+	} else {
+		fflush(f);
+	}
+}
+
 void VideoDriver_Null::MainLoop()
 {
 	SetSelfAsGameThread();
+
+	/* The first game loop switches to the requested mode, e.g. loads the savegame. */
+	TimingMeasurement load_start = GetPerformanceTimer();
+	bool loaded = false;
+	if (this->benchmark && !_exit_game && (this->until_exit || this->ticks > 0)) {
+		::GameLoop();
+		::InputLoop();
+		::UpdateWindows();
+		loaded = true;
+	}
+	TimingMeasurement run_start = GetPerformanceTimer();
+	int ticks_run = 0;
+
 	if (this->until_exit) {
 		while (!_exit_game) {
 			::GameLoop();
 			::InputLoop();
 			::UpdateWindows();
+			ticks_run++;
 		}
 	} else {
-		for (int i = 0; i < this->ticks; i++) {
+		for (int i = loaded ? 1 : 0; i < this->ticks; i++) {
 			::GameLoop();
 			::InputLoop();
 			::UpdateWindows();
+			ticks_run++;
 		}
 	}
 
+	if (this->benchmark) this->WriteBenchmarkReport(run_start - load_start, GetPerformanceTimer() - run_start, ticks_run);
+
 	/* If requested, make a save just before exit. The normal exit-flow is
 	 * not triggered from this driver, so we have to do this manually. */
 	if (_settings_client.gui.autosave_on_exit) {
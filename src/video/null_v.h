@@ -17,6 +17,10 @@ class VideoDriver_Null : public VideoDriver {
 private:
 	int ticks; ///< Amount of ticks to run.
 	bool until_exit;
+	bool benchmark;             ///< Whether to report the timings of the run.
+	std::string benchmark_file; ///< File to write the benchmark report to, empty for the standard output.
+
+	void WriteBenchmarkReport(uint64 load_us, uint64 run_us, int ticks_run);
 
 public:
 	const char *Start(const StringList &param) override;
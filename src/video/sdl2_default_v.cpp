@@ -125,14 +125,30 @@ void VideoDriver_SDL_Default::Paint()
 		this->local_palette.count_dirty = 0;
 	}
 
-	SDL_Rect r = { this->dirty_rect.left, this->dirty_rect.top, this->dirty_rect.right - this->dirty_rect.left, this->dirty_rect.bottom - this->dirty_rect.top };
+	if (IsEmptyRect(this->dirty_rect)) return;
+
+	/* Present the separate dirty areas if they are a good deal smaller than the rectangle encompassing them. */
+	SDL_Rect rects[VideoDirtyRects::MAX_RECTS];
+	int count = 0;
+	if (this->dirty_rects.UseRects(this->dirty_rect)) {
+		for (uint i = 0; i < this->dirty_rects.count; i++) {
+			const Rect &dr = this->dirty_rects.rects[i];
+			if (IsEmptyRect(dr)) continue;
+			rects[count++] = { dr.left, dr.top, dr.right - dr.left, dr.bottom - dr.top };
+		}
+	} else {
+		rects[count++] = { this->dirty_rect.left, this->dirty_rect.top, this->dirty_rect.right - this->dirty_rect.left, this->dirty_rect.bottom - this->dirty_rect.top };
+	}
 
 	if (_sdl_surface != _sdl_real_surface) {
-		SDL_BlitSurface(_sdl_surface, &r, _sdl_real_surface, &r);
+		for (int i = 0; i < count; i++) {
+			SDL_BlitSurface(_sdl_surface, &rects[i], _sdl_real_surface, &rects[i]);
+		}
 	}
-	SDL_UpdateWindowSurfaceRects(this->sdl_window, &r, 1);
+	SDL_UpdateWindowSurfaceRects(this->sdl_window, rects, count);
 
 	this->dirty_rect = {};
+	this->dirty_rects.Clear();
 }
 
 bool VideoDriver_SDL_Default::AllocateBackingStore(int w, int h, bool force)
@@ -165,6 +181,7 @@ bool VideoDriver_SDL_Default::AllocateBackingStore(int w, int h, bool force)
 	 * will mark the whole screen dirty again anyway, but this time with the
 	 * new dimensions. */
 	this->dirty_rect = {};
+	this->dirty_rects.Clear();
 
 	_screen.width = _sdl_surface->w;
 	_screen.height = _sdl_surface->h;
@@ -149,6 +149,7 @@ bool VideoDriver_SDL_OpenGL::AllocateBackingStore(int w, int h, bool force)
 	w = std::max(w, 64);
 	h = std::max(h, 64);
 	MemSetT(&this->dirty_rect, 0);
+	this->dirty_rects.Clear();
 
 	bool res = OpenGLBackend::Get()->Resize(w, h, force);
 	SDL_GL_SwapWindow(this->sdl_window);
@@ -175,6 +176,7 @@ void VideoDriver_SDL_OpenGL::ReleaseVideoPointer()
 	if (this->anim_buffer != nullptr) OpenGLBackend::Get()->ReleaseAnimBuffer(this->dirty_rect);
 	OpenGLBackend::Get()->ReleaseVideoBuffer(this->dirty_rect);
 	MemSetT(&this->dirty_rect, 0);
+	this->dirty_rects.Clear();
 	this->anim_buffer = nullptr;
 }
 
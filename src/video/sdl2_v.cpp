@@ -246,6 +246,7 @@ void VideoDriver_SDL_Base::MakeDirty(int left, int top, int width, int height)
 {
 	Rect r = {left, top, left + width, top + height};
 	this->dirty_rect = BoundingRect(this->dirty_rect, r);
+	this->dirty_rects.Add(r);
 }
 
 void VideoDriver_SDL_Base::CheckPaletteAnim()
@@ -254,7 +255,10 @@ void VideoDriver_SDL_Base::CheckPaletteAnim()
 
 	this->local_palette = _cur_palette;
 	_cur_palette.count_dirty = 0;
-	this->MakeDirty(0, 0, _screen.width, _screen.height);
+	/* Blitters doing the palette animation mark the pixels they changed dirty themselves. */
+	if (BlitterFactory::GetCurrentBlitter()->UsePaletteAnimation() != Blitter::PALETTE_ANIMATION_BLITTER) {
+		this->MakeDirty(0, 0, _screen.width, _screen.height);
+	}
 }
 
 static const Dimension default_resolutions[] = {
@@ -53,6 +53,7 @@ protected:
 	Palette local_palette; ///< Copy of _cur_palette.
 	bool buffer_locked; ///< Video buffer was locked by the main thread.
 	Rect dirty_rect; ///< Rectangle encompassing the dirty area of the video buffer.
+	VideoDirtyRects dirty_rects; ///< Separate dirty areas of the video buffer.
 	std::string driver_info; ///< Information string about selected driver.
 
 	Dimension GetScreenSize() const override;
@@ -36,6 +36,43 @@ extern bool _rightclick_emulate;
 extern bool _video_hw_accel;
 extern bool _video_vsync;
 
+/**
+ * Separate dirty areas of the video buffer, so drivers can present only those instead of the rectangle encompassing them.
+ * When there are too many areas, or they cover most of their encompassing rectangle, that rectangle should be presented instead.
+ */
+struct VideoDirtyRects {
+	static const uint MAX_RECTS = 32; ///< Maximum number of separately kept areas.
+
+	Rect rects[MAX_RECTS]; ///< The dirty areas, only valid if #count is at most #MAX_RECTS.
+	uint count = 0;        ///< Number of dirty areas.
+	uint64 area = 0;       ///< Sum of the sizes of the dirty areas, including overlaps.
+
+	void Add(const Rect &r)
+	{
+		if (this->count < MAX_RECTS) this->rects[this->count] = r;
+		this->count++;
+		this->area += (uint64)(r.right - r.left) * (r.bottom - r.top);
+	}
+
+	void Clear()
+	{
+		this->count = 0;
+		this->area = 0;
+	}
+
+	/**
+	 * Whether to present the separate areas instead of the encompassing rectangle.
+	 * @param bounds The rectangle encompassing all areas.
+	 * @return True if the areas are few and cover at most three quarters of  bounds.
+	 */
+	bool UseRects(const Rect &bounds) const
+	{
+		if (this->count > MAX_RECTS) return false;
+		uint64 bounds_area = (uint64)(bounds.right - bounds.left) * (bounds.bottom - bounds.top);
+		return this->area * 4 <= bounds_area * 3;
+	}
+};
+
 /** The base of all video drivers. */
 class VideoDriver : public Driver {
 	const uint DEFAULT_WINDOW_WIDTH = 640u;  ///< Default window width.
@@ -831,6 +831,7 @@ void VideoDriver_Win32Base::MakeDirty(int left, int top, int width, int height)
 {
 	Rect r = {left, top, left + width, top + height};
 	this->dirty_rect = BoundingRect(this->dirty_rect, r);
+	this->dirty_rects.Add(r);
 }
 
 void VideoDriver_Win32Base::CheckPaletteAnim()
@@ -839,7 +840,10 @@ void VideoDriver_Win32Base::CheckPaletteAnim()
 
 	_local_palette = _cur_palette;
 	_cur_palette.count_dirty = 0;
-	this->MakeDirty(0, 0, _screen.width, _screen.height);
+	/* Blitters doing the palette animation mark the pixels they changed dirty themselves. */
+	if (BlitterFactory::GetCurrentBlitter()->UsePaletteAnimation() != Blitter::PALETTE_ANIMATION_BLITTER) {
+		this->MakeDirty(0, 0, _screen.width, _screen.height);
+	}
 }
 
 void VideoDriver_Win32Base::InputLoop()
@@ -1153,7 +1157,7 @@ void VideoDriver_Win32GDI::Paint()
 {
 	PerformanceMeasurer framerate(PFE_VIDEO);
 
-	if (IsEmptyRect(this->dirty_rect)) return;
+	if (IsEmptyRect(this->dirty_rect) && _local_palette.count_dirty == 0) return;
 
 	HDC dc = GetDC(this->main_wnd);
 	HDC dc2 = CreateCompatibleDC(dc);
@@ -1183,7 +1187,18 @@ void VideoDriver_Win32GDI::Paint()
 		_local_palette.count_dirty = 0;
 	}
 
-	BitBlt(dc, 0, 0, this->width, this->height, dc2, 0, 0, SRCCOPY);
+	/* Copy the separate dirty areas if they are a good deal smaller than the rectangle encompassing them.
+	 * The dirty area can be empty if palette animation did not change any pixel. */
+	if (this->dirty_rects.UseRects(this->dirty_rect)) {
+		for (uint i = 0; i < this->dirty_rects.count; i++) {
+			const Rect &r = this->dirty_rects.rects[i];
+			if (IsEmptyRect(r)) continue;
+			BitBlt(dc, r.left, r.top, r.right - r.left, r.bottom - r.top, dc2, r.left, r.top, SRCCOPY);
+		}
+	} else if (!IsEmptyRect(this->dirty_rect)) {
+		const Rect &r = this->dirty_rect;
+		BitBlt(dc, r.left, r.top, r.right - r.left, r.bottom - r.top, dc2, r.left, r.top, SRCCOPY);
+	}
 	SelectPalette(dc, old_palette, TRUE);
 	SelectObject(dc2, old_bmp);
 	DeleteDC(dc2);
@@ -1191,6 +1206,7 @@ void VideoDriver_Win32GDI::Paint()
 	ReleaseDC(this->main_wnd, dc);
 
 	this->dirty_rect = {};
+	this->dirty_rects.Clear();
 }
 
 #ifdef _DEBUG
@@ -1477,6 +1493,7 @@ bool VideoDriver_Win32OpenGL::AllocateBackingStore(int w, int h, bool force)
 	if (_screen.dst_ptr != nullptr) this->ReleaseVideoPointer();
 
 	this->dirty_rect = {};
+	this->dirty_rects.Clear();
 	bool res = OpenGLBackend::Get()->Resize(w, h, force);
 	SwapBuffers(this->dc);
 	_screen.dst_ptr = this->GetVideoPointer();
@@ -1497,6 +1514,7 @@ void VideoDriver_Win32OpenGL::ReleaseVideoPointer()
 	if (this->anim_buffer != nullptr) OpenGLBackend::Get()->ReleaseAnimBuffer(this->dirty_rect);
 	OpenGLBackend::Get()->ReleaseVideoBuffer(this->dirty_rect);
 	this->dirty_rect = {};
+	this->dirty_rects.Clear();
 	_screen.dst_ptr = nullptr;
 	this->anim_buffer = nullptr;
 }
@@ -44,6 +44,7 @@ protected:
 	bool fullscreen;        ///< Whether to use (true) fullscreen mode.
 	bool has_focus = false; ///< Does our window have system focus?
 	Rect dirty_rect;        ///< Region of the screen that needs redrawing.
+	VideoDirtyRects dirty_rects; ///< Separate regions of the screen that need redrawing.
 	int width = 0;          ///< Width in pixels of our display surface.
 	int height = 0;         ///< Height in pixels of our display surface.
 	int width_org = 0;      ///< Original monitor resolution width, before we changed it.
@@ -113,11 +113,15 @@
 #include "newgrf_object.h"
 #include "infrastructure_func.h"
 #include "tracerestrict.h"
+#include "worker_thread.h"
+#include "date_func.h"
 
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <math.h>
 #include <algorithm>
+#include <iterator>
 #include <tuple>
 
 #include "table/strings.h"
@@ -236,6 +240,12 @@ struct BridgeSetYComparator {
 	}
 };
 
+/** Bridges found while rendering the viewport map, which are drawn on top of the map afterwards. */
+struct ViewportMapBridgeStorage {
+	btree::btree_map<TileIndex, TileIndex, BridgeSetXComparator> bridge_to_map_x;
+	btree::btree_map<TileIndex, TileIndex, BridgeSetYComparator> bridge_to_map_y;
+};
+
 /** Data structure storing rendering information */
 struct ViewportDrawer {
 	DrawPixelInfo dpi;
@@ -249,8 +259,7 @@ struct ViewportDrawer {
 	ChildScreenSpriteToDrawVector child_screen_sprites_to_draw;
 	TunnelToMapStorage tunnel_to_map_x;
 	TunnelToMapStorage tunnel_to_map_y;
-	btree::btree_map<TileIndex, TileIndex, BridgeSetXComparator> bridge_to_map_x;
-	btree::btree_map<TileIndex, TileIndex, BridgeSetYComparator> bridge_to_map_y;
+	ViewportMapBridgeStorage map_bridges;
 
 	int *last_child;
 
@@ -265,14 +274,46 @@ struct ViewportDrawer {
 	FoundationPart foundation_part;                  ///< Currently active foundation for ground sprite drawing.
 	int *last_foundation_child[FOUNDATION_PART_END]; ///< Tail of ChildSprite list of the foundations. (index into child_screen_sprites_to_draw)
 	Point foundation_offset[FOUNDATION_PART_END];    ///< Pixel offset for ground sprites on the foundations.
+
+	bool tile_draw_recording;                        ///< Whether the sprites of the current tile are being recorded for the tile draw cache.
+	bool tile_draw_uncacheable;                      ///< Whether the current tile emitted anything which cannot be replayed from the tile draw cache.
+	uint tile_draw_parent_base;                      ///< First parent sprite of the tile being recorded.
+	uint tile_draw_child_base;                       ///< First child sprite of the tile being recorded.
+	std::vector<Rect> tile_draw_cull_rects;          ///< Culling extents of the sprites of the tile being recorded.
+};
+
+/**
+ * Sprites which a tile's draw proc emitted, so that they can be replayed without calling the draw proc again.
+ * Child and foundation links are stored relative to the first sprite of the tile, see EncodeTileDrawCacheLink.
+ */
+struct ViewportTileDrawCacheEntry {
+	ZoomLevel zoom;                                  ///< Zoom level the sprites were recorded at.
+	std::vector<TileSpriteToDraw> tile_sprites;
+	std::vector<ParentSpriteToDraw> parent_sprites;
+	std::vector<ChildScreenSpriteToDraw> child_sprites;
+	std::vector<Rect> cull_rects;                    ///< Extents which the viewport culling tested, all of these must be visible to replay.
+
+	int foundation[FOUNDATION_PART_END];
+	FoundationPart foundation_part;
+	int last_foundation_child[FOUNDATION_PART_END];
+	Point foundation_offset[FOUNDATION_PART_END];
+	int last_child;
 };
 
+static const uint VIEWPORT_TILE_DRAW_CACHE_MAX_ENTRIES = 1 << 16; ///< Clear the tile draw cache when it gets larger than this.
+
+static const int TILE_DRAW_LINK_NONE = -1;           ///< Encoded tile draw cache link: no link.
+static const int TILE_DRAW_LINK_FOREIGN = INT_MIN;   ///< Encoded tile draw cache link: link to a sprite of another tile.
+
 static void MarkRouteStepDirty(RouteStepsMap::const_iterator cit);
 static void MarkRouteStepDirty(const TileIndex tile, uint order_nr);
 static void HideMeasurementTooltips();
 
 static DrawPixelInfo _dpi_for_text;
 static ViewportDrawer _vd;
+static thread_local ViewportMapBridgeStorage *_vp_map_bridges = nullptr; ///< Where the viewport map rendering on this thread stores the bridges it finds.
+static std::unordered_map<TileIndex, ViewportTileDrawCacheEntry> _vp_tile_draw_cache; ///< Recorded sprites of static tiles, see ViewportAddLandscape.
+static Date _vp_tile_draw_cache_date = INVALID_DATE; ///< Date at which the tile draw cache was last cleared.
 
 static std::vector<Viewport *> _viewport_window_cache;
 static std::vector<Rect> _viewport_coverage_rects;
@@ -312,6 +353,7 @@ std::vector<DrawnPathRouteTileLine> _vp_route_paths;
 std::vector<DrawnPathRouteTileLine> _vp_route_paths_last_mark_dirty;
 
 static void MarkRoutePathsDirty(const std::vector<DrawnPathRouteTileLine> &lines);
+static void MarkRoutePathsDifferenceDirty(const std::vector<DrawnPathRouteTileLine> &old_lines, const std::vector<DrawnPathRouteTileLine> &new_lines);
 
 TileHighlightData _thd;
 static TileInfo *_cur_ti;
@@ -339,6 +381,9 @@ enum ViewportDebugFlags {
 	VDF_DISABLE_DRAW_SPLIT,
 	VDF_SHOW_NO_LANDSCAPE_MAP_DRAW,
 	VDF_DISABLE_LANDSCAPE_CACHE,
+	VDF_DISABLE_THREADED_MAP_DRAW,
+	VDF_LEGACY_SPRITE_SORTER,
+	VDF_DISABLE_TILE_DRAW_CACHE,
 };
 uint32 _viewport_debug_flags;
 
@@ -382,6 +427,47 @@ void ClearViewportLandPixelCache(Viewport *vp)
 	vp->land_pixel_cache.assign(vp->land_pixel_cache.size(), 0xD7);
 }
 
+/**
+ * Move the contents of the land pixel cache of a map mode viewport after the viewport has been scrolled,
+ * such that the part of the landscape which remains in view does not need to be rendered again.
+ * The cached pixels only depend on their position in the world, not on their position in the viewport.
+ * @param vp The viewport.
+ * @param dx Number of pixels by which the contents move to the right.
+ * @param dy Number of pixels by which the contents move down.
+ */
+static void ScrollViewportLandPixelCache(Viewport *vp, int dx, int dy)
+{
+	if (vp->land_pixel_cache.empty()) return;
+	if (abs(dx) >= vp->width || abs(dy) >= vp->height) {
+		ClearViewportLandPixelCache(vp);
+		return;
+	}
+
+	const size_t bytes_per_pixel = vp->land_pixel_cache.size() / (vp->width * vp->height);
+	const size_t row_size = vp->width * bytes_per_pixel;
+	const size_t copy_size = (vp->width - abs(dx)) * bytes_per_pixel;
+	const size_t fill_size = abs(dx) * bytes_per_pixel;
+	const size_t src_offset = std::max(0, -dx) * bytes_per_pixel;
+	const size_t dst_offset = std::max(0, dx) * bytes_per_pixel;
+	const size_t fill_offset = (dx > 0) ? 0 : copy_size;
+	uint8 *data = vp->land_pixel_cache.data();
+
+	auto move_row = [&](int y) {
+		uint8 *row = data + (y * row_size);
+		memmove(row + dst_offset, data + ((y - dy) * row_size) + src_offset, copy_size);
+		memset(row + fill_offset, 0xD7, fill_size);
+	};
+
+	if (dy > 0) {
+		/* Moving down, start at the bottom so that source rows are read before they are overwritten. */
+		for (int y = vp->height - 1; y >= dy; y--) move_row(y);
+		memset(data, 0xD7, dy * row_size);
+	} else {
+		for (int y = 0; y < vp->height + dy; y++) move_row(y);
+		memset(data + ((vp->height + dy) * row_size), 0xD7, -dy * row_size);
+	}
+}
+
 void ClearViewportCache(Viewport *vp)
 {
 	if (vp->zoom >= ZOOM_LVL_DRAW_MAP) {
@@ -731,7 +817,7 @@ static void SetViewportPosition(Window *w, int x, int y, bool force_update_overl
 		if (i >= 0) height -= i;
 
 		if (height > 0 && (_vp_move_offs.x != 0 || _vp_move_offs.y != 0)) {
-			ClearViewportLandPixelCache(vp);
+			ScrollViewportLandPixelCache(vp, _vp_move_offs.x, _vp_move_offs.y);
 			SCOPE_INFO_FMT([&], "DoSetViewportPosition: %d, %d, %d, %d, %d, %d, %s", left, top, width, height, _vp_move_offs.x, _vp_move_offs.y, scope_dumper().WindowInfo(w));
 			w->viewport->update_vehicles = true;
 			DoSetViewportPosition((Window *) w->z_front, left, top, width, height);
@@ -841,6 +927,37 @@ void HandleZoomMessage(Window *w, const Viewport *vp, byte widget_zoom_in, byte
 	w->SetWidgetDirty(widget_zoom_out);
 }
 
+/**
+ * Encode a child sprite list link of the tile being recorded relative to the first sprites of that tile.
+ * @param link Pointer to a ParentSpriteToDraw::first_child or ChildScreenSpriteToDraw::next, or nullptr.
+ * @return Index of the parent sprite, -2 minus the index of the child sprite, TILE_DRAW_LINK_NONE or TILE_DRAW_LINK_FOREIGN.
+ */
+static int EncodeTileDrawCacheLink(const int *link)
+{
+	if (link == nullptr) return TILE_DRAW_LINK_NONE;
+	for (uint i = _vd.tile_draw_parent_base; i < _vd.parent_sprites_to_draw.size(); i++) {
+		if (link == &_vd.parent_sprites_to_draw[i].first_child) return i - _vd.tile_draw_parent_base;
+	}
+	for (uint i = _vd.tile_draw_child_base; i < _vd.child_screen_sprites_to_draw.size(); i++) {
+		if (link == &_vd.child_screen_sprites_to_draw[i].next) return -2 - (int)(i - _vd.tile_draw_child_base);
+	}
+	return TILE_DRAW_LINK_FOREIGN;
+}
+
+/**
+ * Decode a child sprite list link of a replayed tile.
+ * @param link Link as returned by EncodeTileDrawCacheLink.
+ * @param parent_base First parent sprite of the replayed tile.
+ * @param child_base First child sprite of the replayed tile.
+ * @return Pointer to the link, or nullptr.
+ */
+static int *DecodeTileDrawCacheLink(int link, uint parent_base, uint child_base)
+{
+	if (link == TILE_DRAW_LINK_NONE) return nullptr;
+	if (link >= 0) return &_vd.parent_sprites_to_draw[parent_base + link].first_child;
+	return &_vd.child_screen_sprites_to_draw[child_base - 2 - link].next;
+}
+
 /**
  * Schedules a tile sprite for drawing.
  *
@@ -986,9 +1103,12 @@ static void AddCombinedSprite(SpriteID image, PaletteID pal, int x, int y, int z
 	if (left >= _vd.dpi.left + _vd.dpi.width ||
 			right <= _vd.dpi.left ||
 			top >= _vd.dpi.top + _vd.dpi.height ||
-			bottom <= _vd.dpi.top)
+			bottom <= _vd.dpi.top) {
+		_vd.tile_draw_uncacheable = true;
 		return;
+	}
 
+	if (_vd.tile_draw_recording) _vd.tile_draw_cull_rects.push_back({ left, top, right, bottom });
 	AddChildSpriteScreen(image, pal, pt.x, pt.y, false, sub, false, false);
 	if (left < _vd.combine_left) _vd.combine_left = left;
 	if (right > _vd.combine_right) _vd.combine_right = right;
@@ -1075,9 +1195,12 @@ void AddSortableSpriteToDraw(SpriteID image, PaletteID pal, int x, int y, int w,
 	    right  <= _vd.dpi.left                 ||
 	    top    >= _vd.dpi.top + _vd.dpi.height ||
 	    bottom <= _vd.dpi.top) {
+		_vd.tile_draw_uncacheable = true;
 		return;
 	}
 
+	if (_vd.tile_draw_recording) _vd.tile_draw_cull_rects.push_back({ left, top, right, bottom });
+
 	ParentSpriteToDraw &ps = _vd.parent_sprites_to_draw.emplace_back();
 	ps.x = tmp_x;
 	ps.y = tmp_y;
@@ -1209,7 +1332,12 @@ void AddChildSpriteScreen(SpriteID image, PaletteID pal, int x, int y, bool tran
 	assert((image & SPRITE_MASK) < MAX_SPRITES);
 
 	/* If the ParentSprite was clipped by the viewport bounds, do not draw the ChildSprites either */
-	if (_vd.last_child == nullptr) return;
+	if (_vd.last_child == nullptr) {
+		_vd.tile_draw_uncacheable = true;
+		return;
+	}
+
+	if (_vd.tile_draw_recording && EncodeTileDrawCacheLink(_vd.last_child) == TILE_DRAW_LINK_FOREIGN) _vd.tile_draw_uncacheable = true;
 
 	/* make the sprites transparent with the right palette */
 	if (transparent) {
@@ -1571,6 +1699,155 @@ static int GetViewportY(Point tile)
 	return (tile.y * (int)(TILE_PIXELS / 2) + tile.x * (int)(TILE_PIXELS / 2) - TilePixelHeightOutsideMap(tile.x, tile.y)) << ZOOM_LVL_SHIFT;
 }
 
+/**
+ * Check whether the sprites of a tile may be kept in the tile draw cache.
+ * Only tile types whose appearance (almost) only changes when the tile itself or a neighbouring tile is marked dirty,
+ * and whose draw procs are comparatively expensive, are cached.
+ * @param tile_type Type of the tile.
+ * @param tile The tile.
+ * @return Whether the tile is cacheable.
+ */
+static bool IsTileDrawCacheable(TileType tile_type, TileIndex tile)
+{
+	switch (tile_type) {
+		case MP_HOUSE:
+		case MP_STATION:
+		case MP_INDUSTRY:
+		case MP_OBJECT:
+			return !IsBridgeAbove(tile);
+
+		default:
+			return false;
+	}
+}
+
+/**
+ * Replay the cached sprites of a tile, if these are identical to what its draw proc would emit into the current viewport area.
+ * @param tile The tile.
+ * @return Whether the cached sprites were replayed.
+ */
+static bool ReplayTileDrawCache(TileIndex tile)
+{
+	auto iter = _vp_tile_draw_cache.find(tile);
+	if (iter == _vp_tile_draw_cache.end()) return false;
+
+	const ViewportTileDrawCacheEntry &entry = iter->second;
+	if (entry.zoom != _vd.dpi.zoom) return false;
+	for (const Rect &r : entry.cull_rects) {
+		/* The sprite would be clipped by the viewport bounds this time */
+		if (r.left >= _vd.dpi.left + _vd.dpi.width || r.right <= _vd.dpi.left || r.top >= _vd.dpi.top + _vd.dpi.height || r.bottom <= _vd.dpi.top) return false;
+	}
+
+	const uint parent_base = (uint)_vd.parent_sprites_to_draw.size();
+	const uint child_base = (uint)_vd.child_screen_sprites_to_draw.size();
+
+	_vd.tile_sprites_to_draw.insert(_vd.tile_sprites_to_draw.end(), entry.tile_sprites.begin(), entry.tile_sprites.end());
+	for (const ParentSpriteToDraw &ps : entry.parent_sprites) {
+		ParentSpriteToDraw &out = _vd.parent_sprites_to_draw.emplace_back(ps);
+		if (out.first_child != -1) out.first_child += child_base;
+	}
+	for (const ChildScreenSpriteToDraw &cs : entry.child_sprites) {
+		ChildScreenSpriteToDraw &out = _vd.child_screen_sprites_to_draw.emplace_back(cs);
+		if (out.next != -1) out.next += child_base;
+	}
+
+	for (uint i = 0; i < FOUNDATION_PART_END; i++) {
+		_vd.foundation[i] = (entry.foundation[i] != -1) ? entry.foundation[i] + parent_base : -1;
+		_vd.last_foundation_child[i] = DecodeTileDrawCacheLink(entry.last_foundation_child[i], parent_base, child_base);
+		_vd.foundation_offset[i] = entry.foundation_offset[i];
+	}
+	_vd.foundation_part = entry.foundation_part;
+	_vd.last_child = DecodeTileDrawCacheLink(entry.last_child, parent_base, child_base);
+	return true;
+}
+
+/**
+ * Start recording the sprites emitted by the draw proc of a tile.
+ * @return Index of the first tile sprite of the tile, to pass to EndTileDrawCacheRecord.
+ */
+static uint BeginTileDrawCacheRecord()
+{
+	_vd.tile_draw_recording = true;
+	_vd.tile_draw_uncacheable = (_vd.combine_sprites != SPRITE_COMBINE_NONE);
+	_vd.tile_draw_parent_base = (uint)_vd.parent_sprites_to_draw.size();
+	_vd.tile_draw_child_base = (uint)_vd.child_screen_sprites_to_draw.size();
+	_vd.tile_draw_cull_rects.clear();
+	return (uint)_vd.tile_sprites_to_draw.size();
+}
+
+/**
+ * Stop recording the sprites emitted by the draw proc of a tile, and store them in the tile draw cache if they can be replayed.
+ * @param tile The tile.
+ * @param tile_sprite_base Index of the first tile sprite of the tile.
+ */
+static void EndTileDrawCacheRecord(TileIndex tile, uint tile_sprite_base)
+{
+	_vd.tile_draw_recording = false;
+
+	/* Some sprites were clipped, or attached to sprites of another tile */
+	if (_vd.tile_draw_uncacheable || _vd.combine_sprites != SPRITE_COMBINE_NONE) return;
+
+	int last_child = EncodeTileDrawCacheLink(_vd.last_child);
+	int last_foundation_child[FOUNDATION_PART_END];
+	for (uint i = 0; i < FOUNDATION_PART_END; i++) {
+		last_foundation_child[i] = EncodeTileDrawCacheLink(_vd.last_foundation_child[i]);
+		if (last_foundation_child[i] == TILE_DRAW_LINK_FOREIGN) return;
+	}
+	if (last_child == TILE_DRAW_LINK_FOREIGN) return;
+
+	if (_vp_tile_draw_cache.size() >= VIEWPORT_TILE_DRAW_CACHE_MAX_ENTRIES && _vp_tile_draw_cache.find(tile) == _vp_tile_draw_cache.end()) {
+		_vp_tile_draw_cache.clear();
+	}
+
+	ViewportTileDrawCacheEntry &entry = _vp_tile_draw_cache[tile];
+	entry.zoom = _vd.dpi.zoom;
+	entry.tile_sprites.assign(_vd.tile_sprites_to_draw.begin() + tile_sprite_base, _vd.tile_sprites_to_draw.end());
+	entry.parent_sprites.assign(_vd.parent_sprites_to_draw.begin() + _vd.tile_draw_parent_base, _vd.parent_sprites_to_draw.end());
+	for (ParentSpriteToDraw &ps : entry.parent_sprites) {
+		if (ps.first_child != -1) ps.first_child -= _vd.tile_draw_child_base;
+	}
+	entry.child_sprites.assign(_vd.child_screen_sprites_to_draw.begin() + _vd.tile_draw_child_base, _vd.child_screen_sprites_to_draw.end());
+	for (ChildScreenSpriteToDraw &cs : entry.child_sprites) {
+		if (cs.next != -1) cs.next -= _vd.tile_draw_child_base;
+	}
+	entry.cull_rects = _vd.tile_draw_cull_rects;
+
+	for (uint i = 0; i < FOUNDATION_PART_END; i++) {
+		entry.foundation[i] = (_vd.foundation[i] != -1) ? _vd.foundation[i] - _vd.tile_draw_parent_base : -1;
+		entry.last_foundation_child[i] = last_foundation_child[i];
+		entry.foundation_offset[i] = _vd.foundation_offset[i];
+	}
+	entry.foundation_part = _vd.foundation_part;
+	entry.last_child = last_child;
+}
+
+/**
+ * Remove a tile and its neighbours from the tile draw cache.
+ * The neighbours are included as their appearance may depend on the tile, e.g. catenary and foundations.
+ * @param tile The tile.
+ */
+static void InvalidateTileDrawCache(TileIndex tile)
+{
+	if (_vp_tile_draw_cache.empty()) return;
+
+	const int x = TileX(tile);
+	const int y = TileY(tile);
+	for (int dy = -1; dy <= 1; dy++) {
+		for (int dx = -1; dx <= 1; dx++) {
+			if (!IsInsideBS(x + dx, 0, MapSizeX()) || !IsInsideBS(y + dy, 0, MapSizeY())) continue;
+			_vp_tile_draw_cache.erase(TileXY(x + dx, y + dy));
+		}
+	}
+}
+
+/**
+ * Clear the tile draw cache, e.g. when the whole screen needs to be redrawn.
+ */
+void ClearViewportTileDrawCache()
+{
+	_vp_tile_draw_cache.clear();
+}
+
 /**
  * Add the landscape to the viewport, i.e. all ground tiles and buildings.
  */
@@ -1600,6 +1877,13 @@ static void ViewportAddLandscape()
 
 	int potential_bridge_height = ZOOM_LVL_BASE * TILE_HEIGHT * _settings_game.construction.max_bridge_height;
 
+	const bool use_tile_draw_cache = !HasBit(_viewport_debug_flags, VDF_DISABLE_TILE_DRAW_CACHE);
+	if (_vp_tile_draw_cache_date != _date) {
+		/* Drawing of NewGRF tiles may depend on the date */
+		_vp_tile_draw_cache.clear();
+		_vp_tile_draw_cache_date = _date;
+	}
+
 	/* Rows overlap with neighbouring rows by a half tile.
 	 * The first row that could possibly be visible is the row above upper_left (if it is at height 0).
 	 * Due to integer-division not rounding down for negative numbers, we need another decrement.
@@ -1682,7 +1966,15 @@ static void ViewportAddLandscape()
 				_vd.last_foundation_child[1] = nullptr;
 
 				bool no_ground_tiles = min_visible_height > 0;
-				_tile_type_procs[tile_type]->draw_tile_proc(&tile_info, { min_visible_height, no_ground_tiles });
+				if (use_tile_draw_cache && IsTileDrawCacheable(tile_type, tile_info.tile)) {
+					if (!ReplayTileDrawCache(tile_info.tile)) {
+						uint tile_sprite_base = BeginTileDrawCacheRecord();
+						_tile_type_procs[tile_type]->draw_tile_proc(&tile_info, { min_visible_height, no_ground_tiles });
+						EndTileDrawCacheRecord(tile_info.tile, tile_sprite_base);
+					}
+				} else {
+					_tile_type_procs[tile_type]->draw_tile_proc(&tile_info, { min_visible_height, no_ground_tiles });
+				}
 				if (tile_info.tile != INVALID_TILE && min_visible_height <= 0) {
 					DrawTileSelection(&tile_info);
 					DrawTileZoning(&tile_info);
@@ -1750,70 +2042,240 @@ static Rect ExpandRectWithViewportSignMargins(Rect r, ZoomLevel zoom)
 	return r;
 }
 
-static void ViewportAddKdtreeSigns(DrawPixelInfo *dpi, bool towns_only)
+/** Which kinds of viewport signs are shown, see ViewportAddKdtreeSigns. */
+struct ViewportSignFilter {
+	bool show_stations;
+	bool show_waypoints;
+	bool show_towns;
+	bool show_signs;
+	bool show_competitors;
+	bool hide_hidden_waypoints;
+
+	ViewportSignFilter(bool towns_only)
+	{
+		this->show_stations = HasBit(_display_opt, DO_SHOW_STATION_NAMES) && _game_mode != GM_MENU && !towns_only;
+		this->show_waypoints = HasBit(_display_opt, DO_SHOW_WAYPOINT_NAMES) && _game_mode != GM_MENU && !towns_only;
+		this->show_towns = HasBit(_display_opt, DO_SHOW_TOWN_NAMES) && _game_mode != GM_MENU;
+		this->show_signs = HasBit(_display_opt, DO_SHOW_SIGNS) && !IsInvisibilitySet(TO_SIGNS) && !towns_only;
+		this->show_competitors = HasBit(_display_opt, DO_SHOW_COMPETITOR_SIGNS) && !towns_only;
+		this->hide_hidden_waypoints = _settings_client.gui.allow_hiding_waypoint_labels && !HasBit(_extra_display_opt, XDO_SHOW_HIDDEN_SIGNS);
+	}
+
+	bool IsShown(const ViewportSignKdtreeItem &item) const
+	{
+		switch (item.type) {
+			case ViewportSignKdtreeItem::VKI_STATION: {
+				if (!this->show_stations) return false;
+				const BaseStation *st = BaseStation::Get(item.id.station);
+
+				/* Don't draw if station is owned by another company and competitor station names are hidden. Stations owned by none are never ignored. */
+				return this->show_competitors || _local_company == st->owner || st->owner == OWNER_NONE;
+			}
+
+			case ViewportSignKdtreeItem::VKI_WAYPOINT: {
+				if (!this->show_waypoints) return false;
+				const BaseStation *st = BaseStation::Get(item.id.station);
+
+				/* Don't draw if station is owned by another company and competitor station names are hidden. Stations owned by none are never ignored. */
+				if (!this->show_competitors && _local_company != st->owner && st->owner != OWNER_NONE) return false;
+				return !(this->hide_hidden_waypoints && HasBit(Waypoint::From(st)->waypoint_flags, WPF_HIDE_LABEL));
+			}
+
+			case ViewportSignKdtreeItem::VKI_TOWN:
+				return this->show_towns;
+
+			case ViewportSignKdtreeItem::VKI_SIGN:
+				if (!this->show_signs) return false;
+
+				/* Don't draw if sign is owned by another company and competitor signs should be hidden.
+				* Note: It is intentional that also signs owned by OWNER_NONE are hidden. Bankrupt
+				* companies can leave OWNER_NONE signs after them. */
+				return this->show_competitors || !Sign::Get(item.id.sign)->IsCompetitorOwned();
+
+			default:
+				NOT_REACHED();
+		}
+	}
+};
+
+/** Viewport sign gathered for all dirty areas of a viewport, see BeginViewportSignGather. */
+struct ViewportGatheredSign {
+	Rect rect;                    ///< Extent of the sign at the zoom level of the viewport, as tested by ViewportAddString.
+	ViewportSignKdtreeItem item;  ///< The sign.
+};
+
+/** Signs gathered once per frame for all dirty areas of a viewport. */
+static struct {
+	const Viewport *vp = nullptr;              ///< Viewport the signs were gathered for, nullptr when no gathering is active.
+	int sign_height = 0;                       ///< Height of all signs at the zoom level of the viewport.
+	std::vector<ViewportGatheredSign> signs;   ///< Shown signs intersecting the dirty areas, in the order of the kdtree.
+	std::vector<uint> by_top;                  ///< Indices into #signs, sorted by the top of the sign.
+	std::vector<uint> matches;                 ///< Indices into #signs of the signs in the current drawing area.
+} _vp_sign_gather;
+
+/**
+ * Get the viewport sign of a sign kdtree item.
+ * @param item The kdtree item.
+ * @return The viewport sign of the station, waypoint, town or sign.
+ */
+static const ViewportSign &GetViewportSignOfItem(const ViewportSignKdtreeItem &item)
 {
-	Rect search_rect{ dpi->left, dpi->top, dpi->left + dpi->width, dpi->top + dpi->height };
-	search_rect = ExpandRectWithViewportSignMargins(search_rect, dpi->zoom);
+	switch (item.type) {
+		case ViewportSignKdtreeItem::VKI_STATION:
+		case ViewportSignKdtreeItem::VKI_WAYPOINT:
+			return BaseStation::Get(item.id.station)->sign;
 
-	bool show_stations = HasBit(_display_opt, DO_SHOW_STATION_NAMES) && _game_mode != GM_MENU && !towns_only;
-	bool show_waypoints = HasBit(_display_opt, DO_SHOW_WAYPOINT_NAMES) && _game_mode != GM_MENU && !towns_only;
-	bool show_towns = HasBit(_display_opt, DO_SHOW_TOWN_NAMES) && _game_mode != GM_MENU;
-	bool show_signs = HasBit(_display_opt, DO_SHOW_SIGNS) && !IsInvisibilitySet(TO_SIGNS) && !towns_only;
-	bool show_competitors = HasBit(_display_opt, DO_SHOW_COMPETITOR_SIGNS) && !towns_only;
-	bool hide_hidden_waypoints = _settings_client.gui.allow_hiding_waypoint_labels && !HasBit(_extra_display_opt, XDO_SHOW_HIDDEN_SIGNS);
+		case ViewportSignKdtreeItem::VKI_TOWN:
+			return Town::Get(item.id.town)->cache.sign;
 
-	const BaseStation *st;
-	const Sign *si;
+		case ViewportSignKdtreeItem::VKI_SIGN:
+			return Sign::Get(item.id.sign)->sign;
 
+		default:
+			NOT_REACHED();
+	}
+}
+
+/**
+ * Gather the signs to draw in all dirty areas of a viewport, before these areas are drawn.
+ * This replaces a sign kdtree query for each dirty area by a single query for their bounding box.
+ * The signs are culled using their actual extent at the zoom level of the viewport,
+ * instead of the maximum sign width used for the kdtree query.
+ * @param vp The viewport, with its dirty blocks not yet cleared.
+ */
+void BeginViewportSignGather(const Viewport *vp)
+{
+	_vp_sign_gather.vp = nullptr;
+	_vp_sign_gather.signs.clear();
+	_vp_sign_gather.by_top.clear();
+
+	if (vp->zoom >= ZOOM_LVL_OUT_256X) return;
+
+	/* Bounding box of the dirty blocks */
+	const uint grid_w = vp->dirty_blocks_per_row;
+	const uint grid_h = vp->dirty_blocks_per_column;
+	uint min_x = UINT_MAX, max_x = 0, min_y = UINT_MAX, max_y = 0;
+	for (uint x = 0; x < grid_w; x++) {
+		if (!HasBit(vp->dirty_block_columns[x / 64], x % 64)) continue;
+		uint pos = x * grid_h;
+		for (uint y = 0; y < grid_h; y++, pos++) {
+			if (!vp->dirty_blocks[pos]) continue;
+			min_x = std::min(min_x, x);
+			max_x = std::max(max_x, x);
+			min_y = std::min(min_y, y);
+			max_y = std::max(max_y, y);
+		}
+	}
+	if (min_x == UINT_MAX) return;
+
+	const int px_left = (min_x == 0) ? 0 : vp->dirty_block_left_margin + (min_x << vp->GetDirtyBlockWidthShift());
+	const int px_right = std::min<int>(((max_x + 1) << vp->GetDirtyBlockWidthShift()) + vp->dirty_block_left_margin, vp->width);
+	const int px_top = min_y << vp->GetDirtyBlockHeightShift();
+	const int px_bottom = std::min<int>((max_y + 1) << vp->GetDirtyBlockHeightShift(), vp->height);
+
+	/* Pad by one pixel for the rounding of the drawing area in ViewportDoDraw. */
+	Rect area;
+	area.left = ScaleByZoom(px_left - 1, vp->zoom) + vp->virtual_left;
+	area.top = ScaleByZoom(px_top - 1, vp->zoom) + vp->virtual_top;
+	area.right = ScaleByZoom(px_right + 1, vp->zoom) + vp->virtual_left;
+	area.bottom = ScaleByZoom(px_bottom + 1, vp->zoom) + vp->virtual_top;
+
+	const ViewportSignFilter filter(vp->zoom >= ZOOM_LVL_DRAW_MAP);
+	const bool small = vp->zoom >= ZOOM_LVL_OUT_16X;
+	const int sign_height = ScaleByZoom(VPSM_TOP + FONT_HEIGHT_NORMAL + VPSM_BOTTOM, vp->zoom);
+
+	const Rect search_rect = ExpandRectWithViewportSignMargins(area, vp->zoom);
+	_viewport_sign_kdtree.FindContained(search_rect.left, search_rect.top, search_rect.right, search_rect.bottom, [&](const ViewportSignKdtreeItem &item) {
+		if (!filter.IsShown(item)) return;
+
+		const ViewportSign &sign = GetViewportSignOfItem(item);
+		const int sign_half_width = ScaleByZoom((small ? sign.width_small : sign.width_normal) / 2, vp->zoom);
+		Rect rect{ sign.center - sign_half_width, sign.top, sign.center + sign_half_width, sign.top + sign_height };
+		if (area.bottom < rect.top || area.top > rect.bottom || area.right < rect.left || area.left > rect.right) return;
+
+		_vp_sign_gather.signs.push_back({ rect, item });
+	});
+
+	/* Keep the signs in the order of the kdtree, which a kdtree query for a single drawing area would also use,
+	 * such that overlapping signs are layered the same way regardless of how the area is drawn. */
+	for (uint i = 0; i < (uint)_vp_sign_gather.signs.size(); i++) {
+		_vp_sign_gather.by_top.push_back(i);
+	}
+	std::sort(_vp_sign_gather.by_top.begin(), _vp_sign_gather.by_top.end(), [](uint a, uint b) {
+		return _vp_sign_gather.signs[a].rect.top < _vp_sign_gather.signs[b].rect.top;
+	});
+	_vp_sign_gather.sign_height = sign_height;
+	_vp_sign_gather.vp = vp;
+}
+
+/**
+ * Stop using the signs gathered by BeginViewportSignGather.
+ */
+void EndViewportSignGather()
+{
+	_vp_sign_gather.vp = nullptr;
+	_vp_sign_gather.signs.clear();
+	_vp_sign_gather.by_top.clear();
+}
+
+static void ViewportAddKdtreeSigns(const Viewport *vp, DrawPixelInfo *dpi, bool towns_only)
+{
 	/* Collect all the items first and draw afterwards, to ensure layering */
 	std::vector<const BaseStation *> stations;
 	std::vector<const Town *> towns;
 	std::vector<const Sign *> signs;
 
-	_viewport_sign_kdtree.FindContained(search_rect.left, search_rect.top, search_rect.right, search_rect.bottom, [&](const ViewportSignKdtreeItem & item) {
+	auto add_item = [&](const ViewportSignKdtreeItem &item) {
 		switch (item.type) {
 			case ViewportSignKdtreeItem::VKI_STATION:
-				if (!show_stations) break;
-				st = BaseStation::Get(item.id.station);
-
-				/* Don't draw if station is owned by another company and competitor station names are hidden. Stations owned by none are never ignored. */
-				if (!show_competitors && _local_company != st->owner && st->owner != OWNER_NONE) break;
-
-				stations.push_back(st);
-				break;
-
 			case ViewportSignKdtreeItem::VKI_WAYPOINT:
-				if (!show_waypoints) break;
-				st = BaseStation::Get(item.id.station);
-
-				/* Don't draw if station is owned by another company and competitor station names are hidden. Stations owned by none are never ignored. */
-				if (!show_competitors && _local_company != st->owner && st->owner != OWNER_NONE) break;
-				if (hide_hidden_waypoints && HasBit(Waypoint::From(st)->waypoint_flags, WPF_HIDE_LABEL)) break;
-
-				stations.push_back(st);
+				stations.push_back(BaseStation::Get(item.id.station));
 				break;
 
 			case ViewportSignKdtreeItem::VKI_TOWN:
-				if (!show_towns) break;
 				towns.push_back(Town::Get(item.id.town));
 				break;
 
 			case ViewportSignKdtreeItem::VKI_SIGN:
-				if (!show_signs) break;
-				si = Sign::Get(item.id.sign);
-
-				/* Don't draw if sign is owned by another company and competitor signs should be hidden.
-				* Note: It is intentional that also signs owned by OWNER_NONE are hidden. Bankrupt
-				* companies can leave OWNER_NONE signs after them. */
-				if (!show_competitors && si->IsCompetitorOwned()) break;
-
-				signs.push_back(si);
+				signs.push_back(Sign::Get(item.id.sign));
 				break;
 
 			default:
 				NOT_REACHED();
 		}
-	});
+	};
+
+	if (_vp_sign_gather.vp == vp && dpi->zoom == vp->zoom) {
+		/* Use the signs gathered for all dirty areas of the viewport */
+		const int left = dpi->left;
+		const int top = dpi->top;
+		const int right = left + dpi->width;
+		const int bottom = top + dpi->height;
+
+		const std::vector<ViewportGatheredSign> &gathered = _vp_sign_gather.signs;
+		std::vector<uint> &matches = _vp_sign_gather.matches;
+		matches.clear();
+		auto iter = std::lower_bound(_vp_sign_gather.by_top.begin(), _vp_sign_gather.by_top.end(), top - _vp_sign_gather.sign_height, [&](uint a, int b) {
+			return gathered[a].rect.top < b;
+		});
+		for (; iter != _vp_sign_gather.by_top.end() && gathered[*iter].rect.top <= bottom; ++iter) {
+			const Rect &r = gathered[*iter].rect;
+			if (bottom < r.top || top > r.bottom || right < r.left || left > r.right) continue;
+			matches.push_back(*iter);
+		}
+		std::sort(matches.begin(), matches.end());
+		for (uint i : matches) {
+			add_item(gathered[i].item);
+		}
+	} else {
+		Rect search_rect{ dpi->left, dpi->top, dpi->left + dpi->width, dpi->top + dpi->height };
+		search_rect = ExpandRectWithViewportSignMargins(search_rect, dpi->zoom);
+
+		const ViewportSignFilter filter(towns_only);
+		_viewport_sign_kdtree.FindContained(search_rect.left, search_rect.top, search_rect.right, search_rect.bottom, [&](const ViewportSignKdtreeItem &item) {
+			if (filter.IsShown(item)) add_item(item);
+		});
+	}
 
 	/* Layering order (bottom to top): Town names, signs, stations */
 
@@ -1974,6 +2436,105 @@ static void ViewportSortParentSprites(ParentSpriteToSortVector *psdv)
 	}
 }
 
+/**
+ * Sort parent sprites pointer array, using buckets of world positions.
+ * This produces the same order as ViewportSortParentSprites, without comparing each sprite with all of the sprites after it.
+ * A sprite can only be moved in front of the sprite being processed if its minimum X and Y world coordinates are not
+ * greater than the maximum X and Y coordinates of that sprite, so the sprites are kept sorted by the sum of their minimum
+ * X and Y coordinates, and only the range of sprites which can satisfy this is compared.
+ * The order of the sprites which have not yet been output is tracked using a stack, with an order number per sprite to
+ * sort the sprites which are moved in front of the sprite being processed in the same way as ViewportSortParentSprites.
+ */
+static void ViewportSortParentSpritesBucketed(ParentSpriteToSortVector *psdv)
+{
+	const size_t count = psdv->size();
+	if (count < 2) return;
+
+	static const uint64 ORDER_COMPARED = UINT64_MAX;     ///< Sprite has been compared, and is output after the sprites moved in front of it.
+	static const uint64 ORDER_RETURNED = UINT64_MAX - 1; ///< Sprite has been output.
+
+	struct SortKey {
+		int64 key;    ///< Sum of the minimum X and Y world coordinates.
+		uint32 index; ///< Index of the sprite in the input.
+	};
+
+	static ParentSpriteToSortVector input;
+	static std::vector<SortKey> by_key;
+	static std::vector<uint64> order;
+	static std::vector<uint32> stack;
+	static std::vector<uint32> preceding;
+
+	input.assign(psdv->begin(), psdv->end());
+	by_key.resize(count);
+	order.resize(count);
+	stack.resize(count);
+	for (size_t i = 0; i < count; i++) {
+		by_key[i] = { (int64)input[i]->xmin + input[i]->ymin, (uint32)i };
+		/* Sprites earlier in the input have a higher order, and are nearer the top of the stack. */
+		order[i] = count - 1 - i;
+		stack[i] = (uint32)(count - 1 - i);
+	}
+	std::sort(by_key.begin(), by_key.end(), [](const SortKey &a, const SortKey &b) {
+		return a.key < b.key || (a.key == b.key && a.index < b.index);
+	});
+	uint64 next_order = count;
+
+	size_t first_live = 0;
+	auto out = psdv->begin();
+	while (!stack.empty()) {
+		const uint32 s_index = stack.back();
+		stack.pop_back();
+
+		if (order[s_index] == ORDER_RETURNED) continue;
+		if (order[s_index] == ORDER_COMPARED) {
+			*(out++) = input[s_index];
+			order[s_index] = ORDER_RETURNED;
+			continue;
+		}
+
+		const ParentSpriteToDraw *ps = input[s_index];
+		order[s_index] = ORDER_COMPARED;
+
+		/* Find the sprites which ViewportSortParentSprites would move in front of this sprite. */
+		preceding.clear();
+		while (first_live < count && order[by_key[first_live].index] >= ORDER_RETURNED) first_live++;
+		const int64 max_key = (int64)ps->xmax + ps->ymax;
+		for (size_t i = first_live; i < count && by_key[i].key <= max_key; i++) {
+			const uint32 index = by_key[i].index;
+			if (order[index] >= ORDER_RETURNED) continue;
+
+			const ParentSpriteToDraw *ps2 = input[index];
+			if (ps->xmax < ps2->xmin || ps->ymax < ps2->ymin || ps->zmax < ps2->zmin) continue;
+			if (ps->xmin <= ps2->xmax && ps->ymin <= ps2->ymax && ps->zmin <= ps2->zmax) {
+				/* Bounding boxes overlap, see ViewportSortParentSprites */
+				if (ps->xmin + ps->xmax + ps->ymin + ps->ymax + ps->zmin + ps->zmax <=
+						ps2->xmin + ps2->xmax + ps2->ymin + ps2->ymax + ps2->zmin + ps2->zmax) {
+					continue;
+				}
+			}
+			preceding.push_back(index);
+		}
+
+		if (preceding.empty()) {
+			*(out++) = input[s_index];
+			order[s_index] = ORDER_RETURNED;
+			continue;
+		}
+
+		/* The sprites are moved in front in the order in which they are found in the current sprite order,
+		 * each in front of the previous one, so the last one ends up frontmost and is processed next. */
+		std::sort(preceding.begin(), preceding.end(), [](uint32 a, uint32 b) {
+			return order[a] > order[b];
+		});
+		stack.push_back(s_index);
+		for (uint32 index : preceding) {
+			order[index] = next_order++;
+			stack.push_back(index);
+		}
+	}
+	assert(out == psdv->end());
+}
+
 static void ViewportDrawParentSprites(const ParentSpriteToSortVector *psd, const ChildScreenSpriteToDrawVector *csstdv)
 {
 	for (const ParentSpriteToDraw *ps : *psd) {
@@ -2023,44 +2584,45 @@ static void ViewportMapStoreBridge(const Viewport * const vp, const TileIndex ti
 	const Owner o = GetTileOwner(tile);
 	if (o < MAX_COMPANIES && !_legend_land_owners[_company_to_list_pos[o]].show_on_map) return;
 
+	ViewportMapBridgeStorage &bridges = *_vp_map_bridges;
 	switch (GetTunnelBridgeDirection(tile)) {
 		case DIAGDIR_NE: {
 			/* X axis: tile at higher coordinate, facing towards lower coordinate */
-			auto iter = _vd.bridge_to_map_x.lower_bound(tile);
-			if (iter != _vd.bridge_to_map_x.begin()) {
+			auto iter = bridges.bridge_to_map_x.lower_bound(tile);
+			if (iter != bridges.bridge_to_map_x.begin()) {
 				auto prev = iter;
 				--prev;
 				if (prev->second == tile) return;
 			}
-			_vd.bridge_to_map_x.insert(iter, std::make_pair(GetOtherTunnelBridgeEnd(tile), tile));
+			bridges.bridge_to_map_x.insert(iter, std::make_pair(GetOtherTunnelBridgeEnd(tile), tile));
 			break;
 		}
 
 		case DIAGDIR_NW: {
 			/* Y axis: tile at higher coordinate, facing towards lower coordinate */
-			auto iter = _vd.bridge_to_map_y.lower_bound(tile);
-			if (iter != _vd.bridge_to_map_y.begin()) {
+			auto iter = bridges.bridge_to_map_y.lower_bound(tile);
+			if (iter != bridges.bridge_to_map_y.begin()) {
 				auto prev = iter;
 				--prev;
 				if (prev->second == tile) return;
 			}
-			_vd.bridge_to_map_y.insert(iter, std::make_pair(GetOtherTunnelBridgeEnd(tile), tile));
+			bridges.bridge_to_map_y.insert(iter, std::make_pair(GetOtherTunnelBridgeEnd(tile), tile));
 			break;
 		}
 
 		case DIAGDIR_SW: {
 			/* X axis: tile at lower coordinate, facing towards higher coordinate */
-			auto iter = _vd.bridge_to_map_x.lower_bound(tile);
-			if (iter != _vd.bridge_to_map_x.end() && iter->first == tile) return;
-			_vd.bridge_to_map_x.insert(iter, std::make_pair(tile, GetOtherTunnelBridgeEnd(tile)));
+			auto iter = bridges.bridge_to_map_x.lower_bound(tile);
+			if (iter != bridges.bridge_to_map_x.end() && iter->first == tile) return;
+			bridges.bridge_to_map_x.insert(iter, std::make_pair(tile, GetOtherTunnelBridgeEnd(tile)));
 			break;
 		}
 
 		case DIAGDIR_SE: {
 			/* Y axis: tile at lower coordinate, facing towards higher coordinate */
-			auto iter = _vd.bridge_to_map_y.lower_bound(tile);
-			if (iter != _vd.bridge_to_map_y.end() && iter->first == tile) return;
-			_vd.bridge_to_map_y.insert(iter, std::make_pair(tile, GetOtherTunnelBridgeEnd(tile)));
+			auto iter = bridges.bridge_to_map_y.lower_bound(tile);
+			if (iter != bridges.bridge_to_map_y.end() && iter->first == tile) return;
+			bridges.bridge_to_map_y.insert(iter, std::make_pair(tile, GetOtherTunnelBridgeEnd(tile)));
 			break;
 		}
 
@@ -2468,30 +3030,11 @@ void ViewportPrepareVehicleRoute()
 		}
 	}
 	if (_settings_client.gui.show_vehicle_route) {
-		if (!veh) {
-			if (!_vp_route_paths.empty()) {
-				// make sure we remove any leftover paths
-				MarkRoutePathsDirty(_vp_route_paths);
-				_vp_route_paths.clear();
-				_vp_route_paths_last_mark_dirty.clear();
-			}
-			return;
-		} else {
-			if (ViewportMapPrepareVehicleRoute(veh)) {
-				if (_vp_route_paths_last_mark_dirty != _vp_route_paths) {
-					// make sure we're not drawing a partial path
-					MarkRoutePathsDirty(_vp_route_paths);
-					_vp_route_paths_last_mark_dirty = _vp_route_paths;
-				}
-			} else {
-				if (!_vp_route_paths.empty()) {
-					// make sure we remove any leftover paths
-					MarkRoutePathsDirty(_vp_route_paths);
-					_vp_route_paths.clear();
-					_vp_route_paths_last_mark_dirty.clear();
-				}
-				return;
-			}
+		if (veh == nullptr || !ViewportMapPrepareVehicleRoute(veh)) _vp_route_paths.clear();
+		if (_vp_route_paths_last_mark_dirty != _vp_route_paths) {
+			/* Only redraw the lines which were added or removed since the last time, any leftover paths included. */
+			MarkRoutePathsDifferenceDirty(_vp_route_paths_last_mark_dirty, _vp_route_paths);
+			_vp_route_paths_last_mark_dirty = _vp_route_paths;
 		}
 	}
 }
@@ -2504,6 +3047,61 @@ static void ViewportDrawVehicleRouteSteps(const Viewport * const vp)
 	}
 }
 
+/** Bounds of the area being drawn, in sums and differences of the tile coordinates of the points of plan lines. */
+struct PlanLineCullingBounds {
+	int min_coord_delta; ///< Minimum of TileY - TileX.
+	int max_coord_delta; ///< Maximum of TileY - TileX.
+	int min_coord_sum;   ///< Minimum of TileY + TileX.
+	int max_coord_sum;   ///< Maximum of TileY + TileX.
+};
+
+/**
+ * Call a draw function for each segment of a plan line which may be within the area being drawn.
+ * Each point is only mapped to the screen once, as that includes looking up the height of the tile.
+ * @param vp The viewport.
+ * @param pl The plan line.
+ * @param culling Bounds of the area being drawn.
+ * @param draw_segment Function drawing a segment given the from and to points in screen coordinates.
+ */
+template <typename F>
+static void ViewportDrawPlanLineSegments(const Viewport *vp, const PlanLine *pl, const PlanLineCullingBounds &culling, F draw_segment)
+{
+	auto is_outside = [&](int from_delta, int from_sum, int to_delta, int to_sum) -> bool {
+		if (to_delta < culling.min_coord_delta && from_delta < culling.min_coord_delta) return true;
+		if (to_delta > culling.max_coord_delta && from_delta > culling.max_coord_delta) return true;
+		if (to_sum < culling.min_coord_sum && from_sum < culling.min_coord_sum) return true;
+		if (to_sum > culling.max_coord_sum && from_sum > culling.max_coord_sum) return true;
+		return false;
+	};
+	auto to_screen = [&](TileIndex tile) -> Point {
+		const Point pt = RemapCoords2(TileX(tile) * TILE_SIZE + TILE_SIZE / 2, TileY(tile) * TILE_SIZE + TILE_SIZE / 2);
+		return { UnScaleByZoom(pt.x, vp->zoom), UnScaleByZoom(pt.y, vp->zoom) };
+	};
+
+	TileIndex to_tile = pl->tiles[0];
+	int to_coord_delta = (int)TileY(to_tile) - (int)TileX(to_tile);
+	int to_coord_sum = (int)TileY(to_tile) + (int)TileX(to_tile);
+	Point to_pt = {};
+	bool have_to_pt = false;
+	for (uint i = 1; i < pl->tiles.size(); i++) {
+		const TileIndex from_tile = to_tile;
+		const int from_coord_delta = to_coord_delta;
+		const int from_coord_sum = to_coord_sum;
+		const Point from_pt = to_pt;
+		const bool have_from_pt = have_to_pt;
+		to_tile = pl->tiles[i];
+		to_coord_delta = (int)TileY(to_tile) - (int)TileX(to_tile);
+		to_coord_sum = (int)TileY(to_tile) + (int)TileX(to_tile);
+		have_to_pt = false;
+
+		if (is_outside(from_coord_delta, from_coord_sum, to_coord_delta, to_coord_sum)) continue;
+
+		to_pt = to_screen(to_tile);
+		have_to_pt = true;
+		draw_segment(have_from_pt ? from_pt : to_screen(from_tile), to_pt);
+	}
+}
+
 void ViewportDrawPlans(const Viewport *vp)
 {
 	if (Plan::GetNumItems() == 0 && !(_current_plan && _current_plan->temp_line->tiles.size() > 1)) return;
@@ -2518,76 +3116,39 @@ void ViewportDrawPlans(const Viewport *vp)
 		ScaleByZoom(_dpi_for_text.top + _dpi_for_text.height + 2, vp->zoom) + (int)(ZOOM_LVL_BASE * TILE_HEIGHT * _settings_game.construction.map_height_limit)
 	};
 
-	const int min_coord_delta = bounds.left / (int)(2 * ZOOM_LVL_BASE * TILE_SIZE);
-	const int max_coord_delta = (bounds.right / (int)(2 * ZOOM_LVL_BASE * TILE_SIZE)) + 1;
+	auto outside_bounds = [&](const Rect &extents) -> bool {
+		return bounds.left > extents.right || bounds.right < extents.left || bounds.top > extents.bottom || bounds.bottom < extents.top;
+	};
+
+	/* Points are drawn at or above their height 0 position, which is at the top of the tile area of the sum of the coordinates plus one. */
+	const PlanLineCullingBounds culling = {
+		bounds.left / (int)(2 * ZOOM_LVL_BASE * TILE_SIZE),
+		(bounds.right / (int)(2 * ZOOM_LVL_BASE * TILE_SIZE)) + 1,
+		(bounds.top / (int)(ZOOM_LVL_BASE * TILE_SIZE)) - 1,
+		(bounds.bottom / (int)(ZOOM_LVL_BASE * TILE_SIZE)) + 1,
+	};
 
 	for (Plan *p : Plan::Iterate()) {
 		if (!p->IsVisible()) continue;
+		if (outside_bounds(p->viewport_extents)) continue;
 		for (PlanLineVector::iterator it = p->lines.begin(); it != p->lines.end(); it++) {
 			PlanLine *pl = *it;
 			if (!pl->visible) continue;
+			if (outside_bounds(pl->viewport_extents)) continue;
 
-			if (
-				bounds.left   > pl->viewport_extents.right ||
-				bounds.right  < pl->viewport_extents.left ||
-				bounds.top    > pl->viewport_extents.bottom ||
-				bounds.bottom < pl->viewport_extents.top
-			) {
-				continue;
-			}
-
-			TileIndex to_tile = pl->tiles[0];
-			int to_coord_delta = (int)TileY(to_tile) - (int)TileX(to_tile);
-			for (uint i = 1; i < pl->tiles.size(); i++) {
-				const TileIndex from_tile = to_tile;
-				const int from_coord_delta = to_coord_delta;
-				to_tile = pl->tiles[i];
-				to_coord_delta = (int)TileY(to_tile) - (int)TileX(to_tile);
-
-				if (to_coord_delta < min_coord_delta && from_coord_delta < min_coord_delta) continue;
-				if (to_coord_delta > max_coord_delta && from_coord_delta > max_coord_delta) continue;
-
-				const Point from_pt = RemapCoords2(TileX(from_tile) * TILE_SIZE + TILE_SIZE / 2, TileY(from_tile) * TILE_SIZE + TILE_SIZE / 2);
-				const int from_x = UnScaleByZoom(from_pt.x, vp->zoom);
-				const int from_y = UnScaleByZoom(from_pt.y, vp->zoom);
-
-				const Point to_pt = RemapCoords2(TileX(to_tile) * TILE_SIZE + TILE_SIZE / 2, TileY(to_tile) * TILE_SIZE + TILE_SIZE / 2);
-				const int to_x = UnScaleByZoom(to_pt.x, vp->zoom);
-				const int to_y = UnScaleByZoom(to_pt.y, vp->zoom);
-
-				GfxDrawLine(from_x, from_y, to_x, to_y, PC_BLACK, 3);
-				if (pl->focused) {
-					GfxDrawLine(from_x, from_y, to_x, to_y, PC_RED, 1);
-				} else {
-					GfxDrawLine(from_x, from_y, to_x, to_y, _colour_value[p->colour], 1);
-				}
-			}
+			const uint8 colour = pl->focused ? PC_RED : _colour_value[p->colour];
+			ViewportDrawPlanLineSegments(vp, pl, culling, [&](const Point &from, const Point &to) {
+				GfxDrawLine(from.x, from.y, to.x, to.y, PC_BLACK, 3);
+				GfxDrawLine(from.x, from.y, to.x, to.y, colour, 1);
+			});
 		}
 	}
 
 	if (_current_plan && _current_plan->temp_line->tiles.size() > 1) {
-		PlanLine *pl = _current_plan->temp_line;
-		TileIndex to_tile = pl->tiles[0];
-		int to_coord_delta = (int)TileY(to_tile) - (int)TileX(to_tile);
-		for (uint i = 1; i < pl->tiles.size(); i++) {
-			const TileIndex from_tile = to_tile;
-			const int from_coord_delta = to_coord_delta;
-			to_tile = pl->tiles[i];
-			to_coord_delta = (int)TileY(to_tile) - (int)TileX(to_tile);
-
-			if (to_coord_delta < min_coord_delta && from_coord_delta < min_coord_delta) continue;
-			if (to_coord_delta > max_coord_delta && from_coord_delta > max_coord_delta) continue;
-
-			const Point from_pt = RemapCoords2(TileX(from_tile) * TILE_SIZE + TILE_SIZE / 2, TileY(from_tile) * TILE_SIZE + TILE_SIZE / 2);
-			const int from_x = UnScaleByZoom(from_pt.x, vp->zoom);
-			const int from_y = UnScaleByZoom(from_pt.y, vp->zoom);
-
-			const Point to_pt = RemapCoords2(TileX(to_tile) * TILE_SIZE + TILE_SIZE / 2, TileY(to_tile) * TILE_SIZE + TILE_SIZE / 2);
-			const int to_x = UnScaleByZoom(to_pt.x, vp->zoom);
-			const int to_y = UnScaleByZoom(to_pt.y, vp->zoom);
-
-			GfxDrawLine(from_x, from_y, to_x, to_y, _colour_value[_current_plan->colour], 3, 1);
-		}
+		const uint8 colour = _colour_value[_current_plan->colour];
+		ViewportDrawPlanLineSegments(vp, _current_plan->temp_line, culling, [&](const Point &from, const Point &to) {
+			GfxDrawLine(from.x, from.y, to.x, to.y, colour, 3, 1);
+		});
 	}
 
 	_cur_dpi = old_dpi;
@@ -3049,14 +3610,15 @@ static inline void ViewportMapStoreBridgeAboveTile(const Viewport * const vp, co
 	/* No need to bother for hidden things */
 	if (!_settings_client.gui.show_bridges_on_map) return;
 
+	ViewportMapBridgeStorage &bridges = *_vp_map_bridges;
 	if (GetBridgeAxis(tile) == AXIS_X) {
-		auto iter = _vd.bridge_to_map_x.lower_bound(tile);
-		if (iter != _vd.bridge_to_map_x.end() && iter->first < tile && iter->second > tile) return; /* already covered */
-		_vd.bridge_to_map_x.insert(iter, std::make_pair(GetNorthernBridgeEnd(tile), GetSouthernBridgeEnd(tile)));
+		auto iter = bridges.bridge_to_map_x.lower_bound(tile);
+		if (iter != bridges.bridge_to_map_x.end() && iter->first < tile && iter->second > tile) return; /* already covered */
+		bridges.bridge_to_map_x.insert(iter, std::make_pair(GetNorthernBridgeEnd(tile), GetSouthernBridgeEnd(tile)));
 	} else {
-		auto iter = _vd.bridge_to_map_y.lower_bound(tile);
-		if (iter != _vd.bridge_to_map_y.end() && iter->first < tile && iter->second > tile) return; /* already covered */
-		_vd.bridge_to_map_y.insert(iter, std::make_pair(GetNorthernBridgeEnd(tile), GetSouthernBridgeEnd(tile)));
+		auto iter = bridges.bridge_to_map_y.lower_bound(tile);
+		if (iter != bridges.bridge_to_map_y.end() && iter->first < tile && iter->second > tile) return; /* already covered */
+		bridges.bridge_to_map_y.insert(iter, std::make_pair(GetNorthernBridgeEnd(tile), GetSouthernBridgeEnd(tile)));
 	}
 }
 
@@ -3340,54 +3902,87 @@ void ViewportMapDraw(Viewport * const vp)
 	const  int sx = UnScaleByZoomLower(_vd.dpi.left, _vd.dpi.zoom);
 	const  int sy = UnScaleByZoomLower(_vd.dpi.top, _vd.dpi.zoom);
 	const uint line_padding = 2 * (sy & 1);
-	uint       colour_index_base = (sx + line_padding) & 3;
+	const uint colour_index_start = (sx + line_padding) & 3;
 
 	const  int incr_a = (1 << (vp->zoom - 2)) / ZOOM_LVL_BASE;
 	const  int incr_b = (1 << (vp->zoom - 1)) / ZOOM_LVL_BASE;
 	const  int a = (_vd.dpi.left >> 2) / ZOOM_LVL_BASE;
-	int        b = (_vd.dpi.top >> 1) / ZOOM_LVL_BASE;
+	const  int b_start = (_vd.dpi.top >> 1) / ZOOM_LVL_BASE;
 	const  int w = UnScaleByZoom(_vd.dpi.width, vp->zoom);
 	const  int h = UnScaleByZoom(_vd.dpi.height, vp->zoom);
-	int        j = 0;
 
 	const int land_cache_start = _vd.offset_x + (_vd.offset_y * vp->width);
-	uint32 *land_cache_ptr32 = reinterpret_cast<uint32 *>(vp->land_pixel_cache.data()) + land_cache_start;
-	uint8 *land_cache_ptr8 = reinterpret_cast<uint8 *>(vp->land_pixel_cache.data()) + land_cache_start;
 
-	bool cache_updated = false;
-
-	/* Render base map. */
-	do { // For each line
-		int i = w;
-		uint colour_index = colour_index_base;
-		colour_index_base ^= 2;
-		int c = b - a;
-		int d = b + a;
-		do { // For each pixel of a line
-			if (is_32bpp) {
-				if (*land_cache_ptr32 == 0xD7D7D7D7) {
-					*land_cache_ptr32 = ViewportMapGetColour<is_32bpp, show_slope>(vp, c, d, colour_index);
-					cache_updated = true;
+	/* Render lines [first, last) of the base map, returns whether the land pixel cache was updated. */
+	auto render_lines = [&](int first, int last) -> bool {
+		uint colour_index_base = colour_index_start ^ ((first & 1) << 1);
+		int b = b_start + (first * incr_b);
+		uint32 *land_cache_ptr32 = reinterpret_cast<uint32 *>(vp->land_pixel_cache.data()) + land_cache_start + (first * vp->width);
+		uint8 *land_cache_ptr8 = reinterpret_cast<uint8 *>(vp->land_pixel_cache.data()) + land_cache_start + (first * vp->width);
+		bool updated = false;
+
+		for (int j = first; j < last; j++) { // For each line
+			int i = w;
+			uint colour_index = colour_index_base;
+			colour_index_base ^= 2;
+			int c = b - a;
+			int d = b + a;
+			do { // For each pixel of a line
+				if (is_32bpp) {
+					if (*land_cache_ptr32 == 0xD7D7D7D7) {
+						*land_cache_ptr32 = ViewportMapGetColour<is_32bpp, show_slope>(vp, c, d, colour_index);
+						updated = true;
+					}
+					land_cache_ptr32++;
+				} else {
+					if (*land_cache_ptr8 == 0xD7) {
+						*land_cache_ptr8 = (uint8) ViewportMapGetColour<is_32bpp, show_slope>(vp, c, d, colour_index);
+						updated = true;
+					}
+					land_cache_ptr8++;
 				}
-				land_cache_ptr32++;
+				colour_index = (colour_index + 1) & 3;
+				c -= incr_a;
+				d += incr_a;
+			} while (--i);
+			if (is_32bpp) {
+				land_cache_ptr32 += (vp->width - w);
 			} else {
-				if (*land_cache_ptr8 == 0xD7) {
-					*land_cache_ptr8 = (uint8) ViewportMapGetColour<is_32bpp, show_slope>(vp, c, d, colour_index);
-					cache_updated = true;
-				}
-				land_cache_ptr8++;
+				land_cache_ptr8 += (vp->width - w);
 			}
-			colour_index = (colour_index + 1) & 3;
-			c -= incr_a;
-			d += incr_a;
-		} while (--i);
-		if (is_32bpp) {
-			land_cache_ptr32 += (vp->width - w);
-		} else {
-			land_cache_ptr8 += (vp->width - w);
+			b += incr_b;
+		}
+		return updated;
+	};
+
+	bool cache_updated = false;
+
+	/* Render base map.
+	 * Large areas are split into bands of lines, which are rendered by the worker threads into their own parts of the land pixel cache.
+	 * Each band collects the bridges it finds separately, these are merged afterwards. */
+	const int band_height = 32;
+	if (h > band_height && w * h >= 256 * 256 && !HasBit(_viewport_debug_flags, VDF_DISABLE_THREADED_MAP_DRAW) && _general_worker_pool.GetParallelism() > 1) {
+		const size_t bands = CeilDiv(h, band_height);
+		std::vector<ViewportMapBridgeStorage> band_bridges(bands);
+		std::vector<uint8> band_updated(bands, 0);
+		_general_worker_pool.ParallelFor(bands, 1, [&](size_t begin, size_t end) {
+			for (size_t band = begin; band < end; band++) {
+				_vp_map_bridges = &band_bridges[band];
+				const int first = (int)band * band_height;
+				band_updated[band] = render_lines(first, std::min<int>(first + band_height, h)) ? 1 : 0;
+			}
+			_vp_map_bridges = nullptr;
+		});
+		for (size_t band = 0; band < bands; band++) {
+			if (band_updated[band] != 0) cache_updated = true;
+			_vd.map_bridges.bridge_to_map_x.insert(band_bridges[band].bridge_to_map_x.begin(), band_bridges[band].bridge_to_map_x.end());
+			_vd.map_bridges.bridge_to_map_y.insert(band_bridges[band].bridge_to_map_y.begin(), band_bridges[band].bridge_to_map_y.end());
 		}
-		b += incr_b;
-	} while (++j < h);
+	} else {
+		_vp_map_bridges = &_vd.map_bridges;
+		cache_updated = render_lines(0, h);
+		_vp_map_bridges = nullptr;
+	}
 
 	auto draw_tunnels = [&](const int y_intercept_min, const int y_intercept_max, const TunnelToMapStorage &storage) {
 		auto iter = std::lower_bound(storage.tunnels.begin(), storage.tunnels.end(), y_intercept_min, [](const TunnelToMap &a, int b) -> bool {
@@ -3425,14 +4020,14 @@ void ViewportMapDraw(Viewport * const vp)
 		}
 
 		/* Render bridges */
-		if (_settings_client.gui.show_bridges_on_map && _vd.bridge_to_map_x.size() != 0) {
-			for (const auto &it : _vd.bridge_to_map_x) { // For each bridge
+		if (_settings_client.gui.show_bridges_on_map && _vd.map_bridges.bridge_to_map_x.size() != 0) {
+			for (const auto &it : _vd.map_bridges.bridge_to_map_x) { // For each bridge
 				TunnelBridgeToMap tbtm { it.first, it.second };
 				ViewportMapDrawBridgeTunnel<is_32bpp>(vp, &tbtm, (GetBridgeHeight(tbtm.from_tile) - 1) * TILE_HEIGHT, false, w, h, blitter);
 			}
 		}
-		if (_settings_client.gui.show_bridges_on_map && _vd.bridge_to_map_y.size() != 0) {
-			for (const auto &it : _vd.bridge_to_map_y) { // For each bridge
+		if (_settings_client.gui.show_bridges_on_map && _vd.map_bridges.bridge_to_map_y.size() != 0) {
+			for (const auto &it : _vd.map_bridges.bridge_to_map_y) { // For each bridge
 				TunnelBridgeToMap tbtm { it.first, it.second };
 				ViewportMapDrawBridgeTunnel<is_32bpp>(vp, &tbtm, (GetBridgeHeight(tbtm.from_tile) - 1) * TILE_HEIGHT, false, w, h, blitter);
 			}
@@ -3518,7 +4113,11 @@ static void ViewportProcessParentSprites()
 		}
 		_cur_dpi->dst_ptr = saved_dst_ptr;
 	} else {
-		_vp_sprite_sorter(&_vd.parent_sprites_to_sort);
+		if (HasBit(_viewport_debug_flags, VDF_LEGACY_SPRITE_SORTER)) {
+			_vp_sprite_sorter(&_vd.parent_sprites_to_sort);
+		} else {
+			ViewportSortParentSpritesBucketed(&_vd.parent_sprites_to_sort);
+		}
 		ViewportDrawParentSprites(&_vd.parent_sprites_to_sort, &_vd.child_screen_sprites_to_draw);
 
 		if (_draw_dirty_blocks && HasBit(_viewport_debug_flags, VDF_DIRTY_BLOCK_PER_SPLIT)) {
@@ -3572,13 +4171,13 @@ void ViewportDoDraw(Viewport *vp, int left, int top, int right, int bottom)
 		ViewportMapDrawVehicles(&_vd.dpi, vp);
 		if (_scrolling_viewport && _settings_client.gui.show_scrolling_viewport_on_map) ViewportMapDrawScrollingViewportBox(vp);
 		if (unlikely(_thd.place_mode == (HT_SPECIAL | HT_MAP) && (_thd.drawstyle & HT_DRAG_MASK) == HT_RECT && _thd.select_proc == DDSP_MEASURE)) ViewportMapDrawSelection(vp);
-		if (vp->zoom < ZOOM_LVL_OUT_256X) ViewportAddKdtreeSigns(&_vd.dpi, true);
+		if (vp->zoom < ZOOM_LVL_OUT_256X) ViewportAddKdtreeSigns(vp, &_vd.dpi, true);
 	} else {
 		/* Classic rendering. */
 		ViewportAddLandscape();
 		ViewportAddVehicles(&_vd.dpi, vp->update_vehicles);
 
-		ViewportAddKdtreeSigns(&_vd.dpi, false);
+		ViewportAddKdtreeSigns(vp, &_vd.dpi, false);
 
 		DrawTextEffects(&_vd.dpi);
 
@@ -3623,8 +4222,8 @@ void ViewportDoDraw(Viewport *vp, int left, int top, int right, int bottom)
 
 	_cur_dpi = old_dpi;
 
-	_vd.bridge_to_map_x.clear();
-	_vd.bridge_to_map_y.clear();
+	_vd.map_bridges.bridge_to_map_x.clear();
+	_vd.map_bridges.bridge_to_map_y.clear();
 	_vd.string_sprites_to_draw.clear();
 	_vd.tile_sprites_to_draw.clear();
 	_vd.parent_sprites_to_draw.clear();
@@ -3776,6 +4375,7 @@ void UpdateViewportSizeZoom(Viewport *vp)
 	vp->dirty_blocks_per_row = CeilDiv(vp->width, vp->GetDirtyBlockWidth());
 	uint size = vp->dirty_blocks_per_row * vp->dirty_blocks_per_column;
 	vp->dirty_blocks.assign(size, false);
+	vp->dirty_block_columns.assign(CeilDiv(vp->dirty_blocks_per_row, 64), 0);
 	UpdateViewportDirtyBlockLeftMargin(vp);
 	if (vp->zoom >= ZOOM_LVL_DRAW_MAP) {
 		memset(vp->map_draw_vehicles_cache.done_hash_bits, 0, sizeof(vp->map_draw_vehicles_cache.done_hash_bits));
@@ -3839,44 +4439,66 @@ void UpdateActiveScrollingViewport(Window *w)
 	}
 }
 
+/** Area of a viewport in dirty block units, the right and bottom edges are exclusive. */
+struct ViewportDirtyBlockRect {
+	uint left;
+	uint top;
+	uint right;
+	uint bottom;
+
+	inline uint Area() const { return (this->right - this->left) * (this->bottom - this->top); }
+};
+
 /**
- * Marks a viewport as dirty for repaint if it displays (a part of) the area the needs to be repainted.
- * @param vp     The viewport to mark as dirty
- * @param left   Left edge of area to repaint
- * @param top    Top edge of area to repaint
- * @param right  Right edge of area to repaint
- * @param bottom Bottom edge of area to repaint
- * @ingroup dirty
+ * Clip an area to a viewport and convert it to viewport pixel and dirty block coordinates.
+ * @param vp     The viewport
+ * @param left   Left edge of area, updated to the clipped virtual offset from the viewport position
+ * @param top    Top edge of area, updated to the clipped virtual offset from the viewport position
+ * @param right  Right edge of area, updated to the clipped virtual offset from the viewport position
+ * @param bottom Bottom edge of area, updated to the clipped virtual offset from the viewport position
+ * @param blocks Dirty block area output
+ * @return true if any part of the area is within the viewport
  */
-void MarkViewportDirty(Viewport * const vp, int left, int top, int right, int bottom, ViewportMarkDirtyFlags flags)
+static bool GetViewportDirtyBlockRect(const Viewport * const vp, int &left, int &top, int &right, int &bottom, ViewportDirtyBlockRect &blocks)
 {
 	/* Rounding wrt. zoom-out level */
 	right  += (1 << vp->zoom) - 1;
 	bottom += (1 << vp->zoom) - 1;
 
 	right -= vp->virtual_left;
-	if (right <= 0) return;
+	if (right <= 0) return false;
 	right = std::min(right, vp->virtual_width);
 
 	bottom -= vp->virtual_top;
-	if (bottom <= 0) return;
+	if (bottom <= 0) return false;
 	bottom = std::min(bottom, vp->virtual_height);
 
 	left = std::max(0, left - vp->virtual_left);
 
-	if (left >= vp->virtual_width) return;
+	if (left >= vp->virtual_width) return false;
 
 	top = std::max(0, top - vp->virtual_top);
 
-	if (top >= vp->virtual_height) return;
+	if (top >= vp->virtual_height) return false;
 
-	uint x = std::max<int>(0, UnScaleByZoomLower(left, vp->zoom) - vp->dirty_block_left_margin) >> vp->GetDirtyBlockWidthShift();
-	uint y = UnScaleByZoomLower(top, vp->zoom) >> vp->GetDirtyBlockHeightShift();
-	uint w = (std::max<int>(0, UnScaleByZoomLower(right, vp->zoom) - 1 - vp->dirty_block_left_margin) >> vp->GetDirtyBlockWidthShift()) + 1 - x;
-	uint h = ((UnScaleByZoom(bottom, vp->zoom) - 1) >> vp->GetDirtyBlockHeightShift()) + 1 - y;
+	blocks.left = std::max<int>(0, UnScaleByZoomLower(left, vp->zoom) - vp->dirty_block_left_margin) >> vp->GetDirtyBlockWidthShift();
+	blocks.top = UnScaleByZoomLower(top, vp->zoom) >> vp->GetDirtyBlockHeightShift();
+	blocks.right = (std::max<int>(0, UnScaleByZoomLower(right, vp->zoom) - 1 - vp->dirty_block_left_margin) >> vp->GetDirtyBlockWidthShift()) + 1;
+	blocks.bottom = ((UnScaleByZoom(bottom, vp->zoom) - 1) >> vp->GetDirtyBlockHeightShift()) + 1;
+	return true;
+}
 
+/**
+ * Mark an area of dirty blocks of a viewport as dirty.
+ * @param vp     The viewport
+ * @param blocks Dirty block area to mark
+ */
+static void MarkViewportDirtyBlocks(Viewport * const vp, const ViewportDirtyBlockRect &blocks)
+{
+	const uint w = blocks.right - blocks.left;
+	const uint h = blocks.bottom - blocks.top;
 	uint column_skip = vp->dirty_blocks_per_column - h;
-	uint pos = (x * vp->dirty_blocks_per_column) + y;
+	uint pos = (blocks.left * vp->dirty_blocks_per_column) + blocks.top;
 	for (uint i = 0; i < w; i++) {
 		for (uint j = 0; j < h; j++) {
 			vp->dirty_blocks[pos] = true;
@@ -3884,7 +4506,25 @@ void MarkViewportDirty(Viewport * const vp, int left, int top, int right, int bo
 		}
 		pos += column_skip;
 	}
+	vp->MarkDirtyBlockColumns(blocks.left, blocks.right);
 	vp->is_dirty = true;
+}
+
+/**
+ * Marks a viewport as dirty for repaint if it displays (a part of) the area the needs to be repainted.
+ * @param vp     The viewport to mark as dirty
+ * @param left   Left edge of area to repaint
+ * @param top    Top edge of area to repaint
+ * @param right  Right edge of area to repaint
+ * @param bottom Bottom edge of area to repaint
+ * @ingroup dirty
+ */
+void MarkViewportDirty(Viewport * const vp, int left, int top, int right, int bottom, ViewportMarkDirtyFlags flags)
+{
+	ViewportDirtyBlockRect blocks;
+	if (!GetViewportDirtyBlockRect(vp, left, top, right, bottom, blocks)) return;
+
+	MarkViewportDirtyBlocks(vp, blocks);
 
 	if (unlikely(vp->zoom >= ZOOM_LVL_DRAW_MAP && !(flags & VMDF_NOT_LANDSCAPE))) {
 		uint l = UnScaleByZoomLower(left, vp->zoom);
@@ -3900,6 +4540,107 @@ void MarkViewportDirty(Viewport * const vp, int left, int top, int right, int bo
 	}
 }
 
+/** Area queued by MarkAllViewportsDirty whilst a dirty batch is active. */
+struct ViewportDirtyBatchItem {
+	Rect rect;
+	ViewportMarkDirtyFlags flags;
+};
+
+static std::vector<ViewportDirtyBatchItem> _viewport_dirty_batch;
+static std::vector<ViewportDirtyBlockRect> _viewport_dirty_batch_blocks;
+static uint _viewport_dirty_batch_depth = 0;
+ViewportDirtyBatchStats _viewport_dirty_batch_stats;
+ViewportDirtyAreaStats _viewport_dirty_area_stats;
+
+/**
+ * Start batching viewport dirty areas which do not affect the map mode landscape.
+ * Until the matching EndViewportDirtyBatch, such areas passed to MarkAllViewportsDirty are queued
+ * and then merged per viewport before marking the dirty blocks.
+ * Batches may be nested, only the outermost batch flushes.
+ */
+void BeginViewportDirtyBatch()
+{
+	_viewport_dirty_batch_depth++;
+}
+
+/**
+ * Merge queued block areas of a viewport which overlap or nearly overlap.
+ * Two areas are merged when their bounding box contains no more blocks than the two areas would mark separately.
+ * The areas are sorted so that areas from neighbouring vehicles are close together, each area is then only
+ * compared with a small window of the most recently output areas.
+ * @param blocks Block areas, replaced with the merged areas
+ */
+static void MergeViewportDirtyBlockRects(std::vector<ViewportDirtyBlockRect> &blocks)
+{
+	static const size_t MERGE_WINDOW = 8;
+
+	std::sort(blocks.begin(), blocks.end(), [](const ViewportDirtyBlockRect &a, const ViewportDirtyBlockRect &b) {
+		if (a.left != b.left) return a.left < b.left;
+		return a.top < b.top;
+	});
+
+	size_t out = 0;
+	for (size_t i = 0; i < blocks.size(); i++) {
+		const ViewportDirtyBlockRect &r = blocks[i];
+		bool merged = false;
+		for (size_t j = out; j > 0 && j + MERGE_WINDOW > out; j--) {
+			ViewportDirtyBlockRect &o = blocks[j - 1];
+			ViewportDirtyBlockRect u;
+			u.left = std::min(o.left, r.left);
+			u.top = std::min(o.top, r.top);
+			u.right = std::max(o.right, r.right);
+			u.bottom = std::max(o.bottom, r.bottom);
+			if (u.Area() <= o.Area() + r.Area()) {
+				o = u;
+				merged = true;
+				break;
+			}
+		}
+		if (!merged) blocks[out++] = r;
+	}
+	blocks.resize(out);
+}
+
+/**
+ * End a dirty batch started with BeginViewportDirtyBatch.
+ * When the outermost batch ends, the queued areas are merged and marked dirty.
+ */
+void EndViewportDirtyBatch()
+{
+	assert(_viewport_dirty_batch_depth > 0);
+	if (--_viewport_dirty_batch_depth > 0) return;
+
+	uint rects_in = 0;
+	uint rects_out = 0;
+	if (!_viewport_dirty_batch.empty()) {
+		for (uint i = 0; i < _viewport_window_cache.size(); i++) {
+			Viewport *vp = _viewport_window_cache[i];
+			const Rect &cover = _viewport_coverage_rects[i];
+			_viewport_dirty_batch_blocks.clear();
+			for (const ViewportDirtyBatchItem &item : _viewport_dirty_batch) {
+				if (item.flags & VMDF_NOT_MAP_MODE && vp->zoom >= ZOOM_LVL_DRAW_MAP) continue;
+				if (item.flags & VMDF_NOT_MAP_MODE_NON_VEG && vp->zoom >= ZOOM_LVL_DRAW_MAP && vp->map_type != VPMT_VEGETATION) continue;
+				int left = item.rect.left;
+				int top = item.rect.top;
+				int right = item.rect.right;
+				int bottom = item.rect.bottom;
+				if (left >= cover.right || right <= cover.left || top >= cover.bottom || bottom <= cover.top) continue;
+				ViewportDirtyBlockRect blocks;
+				if (GetViewportDirtyBlockRect(vp, left, top, right, bottom, blocks)) _viewport_dirty_batch_blocks.push_back(blocks);
+			}
+			rects_in += (uint)_viewport_dirty_batch_blocks.size();
+			MergeViewportDirtyBlockRects(_viewport_dirty_batch_blocks);
+			rects_out += (uint)_viewport_dirty_batch_blocks.size();
+			for (const ViewportDirtyBlockRect &blocks : _viewport_dirty_batch_blocks) {
+				MarkViewportDirtyBlocks(vp, blocks);
+			}
+		}
+		_viewport_dirty_batch.clear();
+	}
+	_viewport_dirty_batch_stats.rects_in = rects_in;
+	_viewport_dirty_batch_stats.rects_out = rects_out;
+}
+
 /**
  * Mark all viewports that display an area as dirty (in need of repaint).
  * @param left   Left   edge of area to repaint. (viewport coordinates, that is wrt. #ZOOM_LVL_NORMAL)
@@ -3911,6 +4652,11 @@ void MarkViewportDirty(Viewport * const vp, int left, int top, int right, int bo
  */
 void MarkAllViewportsDirty(int left, int top, int right, int bottom, ViewportMarkDirtyFlags flags)
 {
+	if (_viewport_dirty_batch_depth > 0 && (flags & VMDF_NOT_LANDSCAPE)) {
+		if (!_viewport_window_cache.empty()) _viewport_dirty_batch.push_back({ { left, top, right, bottom }, flags });
+		return;
+	}
+
 	for (uint i = 0; i < _viewport_window_cache.size(); i++) {
 		if (flags & VMDF_NOT_MAP_MODE && _viewport_window_cache[i]->zoom >= ZOOM_LVL_DRAW_MAP) continue;
 		if (flags & VMDF_NOT_MAP_MODE_NON_VEG && _viewport_window_cache[i]->zoom >= ZOOM_LVL_DRAW_MAP && _viewport_window_cache[i]->map_type != VPMT_VEGETATION) continue;
@@ -3986,6 +4732,7 @@ void MarkAllViewportMapLandscapesDirty()
 
 void MarkWholeNonMapViewportsDirty()
 {
+	ClearViewportTileDrawCache();
 	for (Window *w : Window::IterateFromBack()) {
 		Viewport *vp = w->viewport;
 		if (vp != nullptr && vp->zoom < ZOOM_LVL_DRAW_MAP) {
@@ -4032,6 +4779,8 @@ void ConstrainAllViewportsZoom()
  */
 void MarkTileDirtyByTile(TileIndex tile, ViewportMarkDirtyFlags flags, int bridge_level_offset, int tile_height_override)
 {
+	InvalidateTileDrawCache(tile);
+	if (!(flags & VMDF_NOT_MAP_MODE)) InvalidateSmallMapTileColour(tile);
 	Point pt = RemapCoords(TileX(tile) * TILE_SIZE, TileY(tile) * TILE_SIZE, tile_height_override * TILE_HEIGHT);
 	MarkAllViewportsDirty(
 			pt.x - 31  * ZOOM_LVL_BASE,
@@ -4044,6 +4793,8 @@ void MarkTileDirtyByTile(TileIndex tile, ViewportMarkDirtyFlags flags, int bridg
 
 void MarkTileGroundDirtyByTile(TileIndex tile, ViewportMarkDirtyFlags flags)
 {
+	InvalidateTileDrawCache(tile);
+	if (!(flags & VMDF_NOT_MAP_MODE)) InvalidateSmallMapTileColour(tile);
 	int x = TileX(tile) * TILE_SIZE;
 	int y = TileY(tile) * TILE_SIZE;
 	Point top = RemapCoords(x, y, GetTileMaxPixelZ(tile));
@@ -4140,20 +4891,27 @@ static void MarkRoutePathsDirty(const std::vector<DrawnPathRouteTileLine> &lines
 	}
 }
 
+/**
+ * Mark the lines which only occur in one of two sorted lists of route lines dirty.
+ * @param old_lines The lines which were drawn.
+ * @param new_lines The lines which are to be drawn.
+ */
+static void MarkRoutePathsDifferenceDirty(const std::vector<DrawnPathRouteTileLine> &old_lines, const std::vector<DrawnPathRouteTileLine> &new_lines)
+{
+	std::vector<DrawnPathRouteTileLine> changed_lines;
+	std::set_symmetric_difference(old_lines.begin(), old_lines.end(), new_lines.begin(), new_lines.end(), std::back_inserter(changed_lines));
+	MarkRoutePathsDirty(changed_lines);
+}
+
+/**
+ * Rebuild the route lines of the focused vehicle before the screen is next drawn, e.g. because its orders changed.
+ * The lines which are added or removed are marked dirty by ViewportPrepareVehicleRoute at that time.
+ * @param veh The vehicle.
+ */
 void MarkAllRoutePathsDirty(const Vehicle *veh)
 {
-	switch (_settings_client.gui.show_vehicle_route) {
-		case 0: // No
-			return;
+	if (_settings_client.gui.show_vehicle_route == 0) return;
 
-		case 1: // Simple
-			ViewportMapPrepareVehicleRoute(veh);
-			break;
-	}
-	for (const auto &iter : _vp_route_paths) {
-		MarkTileLineDirty(iter.from_tile, iter.to_tile, VMDF_NOT_LANDSCAPE);
-	}
-	_vp_route_paths_last_mark_dirty.swap(_vp_route_paths);
 	_vp_route_paths.clear();
 }
 
@@ -6064,6 +6822,20 @@ void InitializeSpriteSorter()
 	assert(_vp_sprite_sorter != nullptr);
 }
 
+/**
+ * Sort parent sprites with one of the sprite sorters, for timing them.
+ * @param psdv The sprites to sort.
+ * @param legacy Whether to use the legacy sprite sorter instead of the bucketed one.
+ */
+void ViewportSortParentSpritesForBenchmark(ParentSpriteToSortVector *psdv, bool legacy)
+{
+	if (legacy) {
+		_vp_sprite_sorter(psdv);
+	} else {
+		ViewportSortParentSpritesBucketed(psdv);
+	}
+}
+
 /**
  * Scroll players main viewport.
  * @param tile tile to center viewport on
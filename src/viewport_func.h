@@ -26,6 +26,7 @@ void SetSelectionRed(bool);
 void ClearViewportCache(Viewport *vp);
 void ClearViewportLandPixelCache(Viewport *vp);
 void ClearViewportCaches();
+void ClearViewportTileDrawCache();
 void DeleteWindowViewport(Window *w);
 void InitializeWindowViewport(Window *w, int x, int y, int width, int height, uint32 follow_flags, ZoomLevel zoom);
 Viewport *IsPtInWindowViewport(const Window *w, int x, int y);
@@ -36,6 +37,8 @@ void UpdateViewportSizeZoom(Viewport *vp);
 
 void MarkViewportDirty(Viewport * const vp, int left, int top, int right, int bottom, ViewportMarkDirtyFlags flags);
 void MarkAllViewportsDirty(int left, int top, int right, int bottom, ViewportMarkDirtyFlags flags = VMDF_NONE);
+void BeginViewportDirtyBatch();
+void EndViewportDirtyBatch();
 void MarkAllViewportMapsDirty(int left, int top, int right, int bottom);
 void MarkAllViewportMapLandscapesDirty();
 void MarkWholeNonMapViewportsDirty();
@@ -88,6 +91,8 @@ void SetTileSelectSize(int w, int h);
 void SetTileSelectBigSize(int ox, int oy, int sx, int sy);
 
 void ViewportDoDraw(Viewport *vp, int left, int top, int right, int bottom);
+void BeginViewportSignGather(const Viewport *vp);
+void EndViewportSignGather();
 
 bool ScrollWindowToTile(TileIndex tile, Window *w, bool instant = false);
 bool ScrollWindowTo(int x, int y, int z, Window *w, bool instant = false);
@@ -105,6 +110,24 @@ void ClearAllCachedNames();
 
 extern Point _tile_fract_coords;
 
+/** Statistics of the most recently flushed viewport dirty batch. */
+struct ViewportDirtyBatchStats {
+	uint rects_in = 0;  ///< Number of viewport dirty areas queued, summed over all viewports.
+	uint rects_out = 0; ///< Number of viewport dirty areas remaining after merging, summed over all viewports.
+};
+
+extern ViewportDirtyBatchStats _viewport_dirty_batch_stats;
+
+/** Statistics of the viewport areas redrawn by the last call of DrawDirtyBlocks. */
+struct ViewportDirtyAreaStats {
+	uint rects = 0;           ///< Number of coalesced dirty areas drawn, summed over all viewports.
+	uint64 pixels = 0;        ///< Number of screen pixels covered by the drawn dirty areas.
+	uint columns_scanned = 0; ///< Number of dirty block columns which were flagged in the column summaries and scanned.
+	uint columns_total = 0;   ///< Number of dirty block columns of the redrawn viewports.
+};
+
+extern ViewportDirtyAreaStats _viewport_dirty_area_stats;
+
 void MarkTileDirtyByTile(const TileIndex tile, ViewportMarkDirtyFlags flags, int bridge_level_offset, int tile_height_override);
 
 /**
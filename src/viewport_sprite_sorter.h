@@ -63,5 +63,6 @@ void ViewportSortParentSpritesSSE41(ParentSpriteToSortVector *psdv);
 #endif
 
 void InitializeSpriteSorter();
+void ViewportSortParentSpritesForBenchmark(ParentSpriteToSortVector *psdv, bool legacy);
 
 #endif /* VIEWPORT_SPRITE_SORTER_H */
@@ -55,6 +55,7 @@ struct Viewport {
 	LinkGraphOverlay *overlay;
 
 	std::vector<bool> dirty_blocks;
+	std::vector<uint64> dirty_block_columns; ///< Summary bit per column of #dirty_blocks, set when the column may contain dirty blocks.
 	uint dirty_blocks_per_column;
 	uint dirty_blocks_per_row;
 	uint8 dirty_block_left_margin;
@@ -69,10 +70,23 @@ struct Viewport {
 	uint GetDirtyBlockWidth() const { return 1 << this->GetDirtyBlockWidthShift(); }
 	uint GetDirtyBlockHeight() const { return 1 << this->GetDirtyBlockHeightShift(); }
 
+	/**
+	 * Mark a range of dirty block columns as possibly containing dirty blocks.
+	 * @param left First column.
+	 * @param right One past the last column.
+	 */
+	void MarkDirtyBlockColumns(uint left, uint right)
+	{
+		for (uint x = left; x < right; x++) {
+			this->dirty_block_columns[x / 64] |= (uint64)1 << (x % 64);
+		}
+	}
+
 	void ClearDirty()
 	{
 		if (this->is_dirty) {
 			this->dirty_blocks.assign(this->dirty_blocks.size(), false);
+			this->dirty_block_columns.assign(this->dirty_block_columns.size(), 0);
 			this->is_dirty = false;
 		}
 		this->is_drawn = false;
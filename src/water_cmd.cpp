@@ -16,6 +16,7 @@
 #include "news_func.h"
 #include "depot_base.h"
 #include "depot_func.h"
+#include "depot_kdtree.h"
 #include "water.h"
 #include "industry_map.h"
 #include "newgrf_canal.h"
@@ -157,6 +158,7 @@ CommandCost CmdBuildShipDepot(TileIndex tile, DoCommandFlag flags, uint32 p1, ui
 
 		MakeShipDepot(tile,  _current_company, depot->index, DEPOT_PART_NORTH, axis, wc1);
 		MakeShipDepot(tile2, _current_company, depot->index, DEPOT_PART_SOUTH, axis, wc2);
+		_ship_depot_kdtree.Insert(depot->index);
 		CheckForDockingTile(tile);
 		CheckForDockingTile(tile2);
 		MarkTileDirtyByTile(tile);
@@ -285,7 +287,9 @@ static CommandCost RemoveShipDepot(TileIndex tile, DoCommandFlag flags)
 	}
 
 	if (flags & DC_EXEC) {
-		delete Depot::GetByTile(tile);
+		Depot *depot = Depot::GetByTile(tile);
+		_ship_depot_kdtree.Remove(depot->index);
+		delete depot;
 
 		Company *c = Company::GetIfValid(GetTileOwner(tile));
 		if (c != nullptr) {
@@ -1318,14 +1322,18 @@ void TileLoop_Water(TileIndex tile)
 
 	switch (GetFloodingBehaviour(tile)) {
 		case FLOOD_ACTIVE: {
-			int non_water_neighbours = 0;
+			int floodable_neighbours = 0;
 			for (Direction dir = DIR_BEGIN; dir < DIR_END; dir++) {
 				TileIndex dest = tile + TileOffsByDir(dir);
 				if (!IsValidTile(dest)) continue;
 				/* do not try to flood water tiles - increases performance a lot */
 				if (IsTileType(dest, MP_WATER)) continue;
 
-				non_water_neighbours++;
+				/* Land above sea level can never be flooded, a foundation only raises it further.
+				 * Only terraforming can change this, which clears the non-flooding state of the water tiles around it. */
+				if (GetTileZ(dest) > 0) continue;
+
+				floodable_neighbours++;
 
 				/* TREE_GROUND_SHORE is the sign of a previous flood. */
 				if (IsTileType(dest, MP_TREES) && GetTreeGround(dest) == TREE_GROUND_SHORE) continue;
@@ -1339,7 +1347,7 @@ void TileLoop_Water(TileIndex tile)
 
 				DoFloodTile(dest);
 			}
-			if (non_water_neighbours == 0 && IsTileType(tile, MP_WATER)) SetNonFloodingWaterTile(tile, true);
+			if (floodable_neighbours == 0 && IsTileType(tile, MP_WATER)) SetNonFloodingWaterTile(tile, true);
 			break;
 		}
 
@@ -1399,29 +1407,9 @@ void ConvertGroundTilesIntoWaterTiles()
 
 static TrackStatus GetTileTrackStatus_Water(TileIndex tile, TransportType mode, uint sub_mode, DiagDirection side)
 {
-	static const TrackBits coast_tracks[] = {TRACK_BIT_NONE, TRACK_BIT_RIGHT, TRACK_BIT_UPPER, TRACK_BIT_NONE, TRACK_BIT_LEFT, TRACK_BIT_NONE, TRACK_BIT_NONE,
-		TRACK_BIT_NONE, TRACK_BIT_LOWER, TRACK_BIT_NONE, TRACK_BIT_NONE, TRACK_BIT_NONE, TRACK_BIT_NONE, TRACK_BIT_NONE, TRACK_BIT_NONE, TRACK_BIT_NONE};
-
-	TrackBits ts;
-
 	if (mode != TRANSPORT_WATER) return 0;
 
-	switch (GetWaterTileType(tile)) {
-		case WATER_TILE_CLEAR: ts = IsTileFlat(tile) ? TRACK_BIT_ALL : TRACK_BIT_NONE; break;
-		case WATER_TILE_COAST: ts = coast_tracks[GetTileSlope(tile) & 0xF]; break;
-		case WATER_TILE_LOCK:  ts = DiagDirToDiagTrackBits(GetLockDirection(tile)); break;
-		case WATER_TILE_DEPOT: ts = AxisToTrackBits(GetShipDepotAxis(tile)); break;
-		default: return 0;
-	}
-	if (TileX(tile) == 0) {
-		/* NE border: remove tracks that connects NE tile edge */
-		ts &= ~(TRACK_BIT_X | TRACK_BIT_UPPER | TRACK_BIT_RIGHT);
-	}
-	if (TileY(tile) == 0) {
-		/* NW border: remove tracks that connects NW tile edge */
-		ts &= ~(TRACK_BIT_Y | TRACK_BIT_LEFT | TRACK_BIT_UPPER);
-	}
-	return CombineTrackStatus(TrackBitsToTrackdirBits(ts), TRACKDIR_BIT_NONE);
+	return CombineTrackStatus(TrackBitsToTrackdirBits(GetWaterTileShipTrackBits(tile)), TRACKDIR_BIT_NONE);
 }
 
 static bool ClickTile_Water(TileIndex tile)
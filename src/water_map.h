@@ -12,6 +12,7 @@
 
 #include "depot_type.h"
 #include "tile_map.h"
+#include "track_func.h"
 
 /**
  * Bit field layout of m5 for water tiles.
@@ -524,4 +525,35 @@ static inline bool IsNonFloodingWaterTile(TileIndex t)
 	return IsTileType(t, MP_WATER) && HasBit(_m[t].m3, 0);
 }
 
+/**
+ * Get the tracks ships can use on a water tile.
+ * This is the track status of water tiles, without going through the tile type procs.
+ * @param t the tile
+ * @pre IsTileType(t, MP_WATER)
+ * @return the usable tracks, not including those leaving the map at the north edges
+ */
+static inline TrackBits GetWaterTileShipTrackBits(TileIndex t)
+{
+	static const TrackBits coast_tracks[] = {TRACK_BIT_NONE, TRACK_BIT_RIGHT, TRACK_BIT_UPPER, TRACK_BIT_NONE, TRACK_BIT_LEFT, TRACK_BIT_NONE, TRACK_BIT_NONE,
+		TRACK_BIT_NONE, TRACK_BIT_LOWER, TRACK_BIT_NONE, TRACK_BIT_NONE, TRACK_BIT_NONE, TRACK_BIT_NONE, TRACK_BIT_NONE, TRACK_BIT_NONE, TRACK_BIT_NONE};
+
+	TrackBits ts;
+	switch (GetWaterTileType(t)) {
+		case WATER_TILE_CLEAR: ts = IsTileFlat(t) ? TRACK_BIT_ALL : TRACK_BIT_NONE; break;
+		case WATER_TILE_COAST: ts = coast_tracks[GetTileSlope(t) & 0xF]; break;
+		case WATER_TILE_LOCK:  ts = DiagDirToDiagTrackBits(GetLockDirection(t)); break;
+		case WATER_TILE_DEPOT: ts = AxisToTrackBits(GetShipDepotAxis(t)); break;
+		default: return TRACK_BIT_NONE;
+	}
+	if (TileX(t) == 0) {
+		/* NE border: remove tracks that connects NE tile edge */
+		ts &= ~(TRACK_BIT_X | TRACK_BIT_UPPER | TRACK_BIT_RIGHT);
+	}
+	if (TileY(t) == 0) {
+		/* NW border: remove tracks that connects NW tile edge */
+		ts &= ~(TRACK_BIT_Y | TRACK_BIT_LEFT | TRACK_BIT_UPPER);
+	}
+	return ts;
+}
+
 #endif /* WATER_MAP_H */
@@ -625,6 +625,7 @@ CommandCost CmdRenameWaypoint(TileIndex tile, DoCommandFlag flags, uint32 p1, ui
 	}
 
 	if (flags & DC_EXEC) {
+		wp->cached_name.clear();
 		if (reset) {
 			wp->name.clear();
 		} else {
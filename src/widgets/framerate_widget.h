@@ -16,6 +16,10 @@ enum FramerateWindowWidgets {
 	WID_FRW_RATE_GAMELOOP,
 	WID_FRW_RATE_DRAWING,
 	WID_FRW_RATE_FACTOR,
+	WID_FRW_RATE_DIRTY_RECTS,
+	WID_FRW_RATE_DIRTY_AREA,
+	WID_FRW_RATE_SPRITE_CACHE,
+	WID_FRW_RATE_NEWGRF_SAMPLES,
 	WID_FRW_INFO_DATA_POINTS,
 	WID_FRW_TIMES_NAMES,
 	WID_FRW_TIMES_CURRENT,
@@ -35,10 +35,13 @@
 #include "game/game.hpp"
 #include "video/video_driver.hpp"
 #include "framerate_type.h"
+#include "trace.h"
 #include "network/network_func.h"
 #include "guitimer_func.h"
 #include "news_func.h"
 
+#include <array>
+
 #include "safeguards.h"
 
 /** Values for _settings_client.gui.auto_scrolling */
@@ -55,6 +58,45 @@ static Window *_last_scroll_window = nullptr; ///< Window of the last scroll eve
 
 /** List of windows opened at the screen sorted from the front. */
 WindowBase *_z_front_window = nullptr;
+
+/**
+ * Number of windows of each class, including closed windows which are not yet freed.
+ * This allows invalidating and finding windows of classes which are not open without walking the window list.
+ */
+static std::array<uint, WC_END> _open_window_class_count;
+
+/**
+ * Check whether there may be a window of the given class.
+ * @param cls Window class
+ * @return False if there is definitely no window of that class.
+ */
+static inline bool MayHaveWindowOfClass(WindowClass cls)
+{
+	return cls >= WC_END || _open_window_class_count[cls] != 0;
+}
+
+/**
+ * Count a window as being open under its current class.
+ * @param w The window.
+ */
+static void CountOpenWindow(WindowBase *w)
+{
+	w->counted_class = w->window_class;
+	if (w->counted_class < WC_END) _open_window_class_count[w->counted_class]++;
+}
+
+/**
+ * Stop counting a window as being open.
+ * @param w The window.
+ */
+static void UncountOpenWindow(WindowBase *w)
+{
+	if (w->counted_class < WC_END) {
+		assert(_open_window_class_count[w->counted_class] > 0);
+		_open_window_class_count[w->counted_class]--;
+	}
+	w->counted_class = WC_INVALID;
+}
 /** List of windows opened at the screen sorted from the back. */
 WindowBase *_z_back_window  = nullptr;
 /** List of windows in an arbitrary order, that is not instantaneously changed by bringing windows to the front. */
@@ -890,17 +932,20 @@ static void DispatchMouseWheelEvent(Window *w, NWidgetCore *nwid, int wheel)
  *
  * The function goes recursively upwards in the window stack, and splits the rectangle
  * into multiple pieces at the window edges, so obscured parts are not redrawn.
+ * The pieces are only tested against the windows from the one at whose edge they were split,
+ * as the windows in between do not intersect the whole rectangle either.
  *
  * @param w Window that needs to be repainted
+ * @param start First window in front of w which may intersect the rectangle
  * @param left Left edge of the rectangle that should be repainted
  * @param top Top edge of the rectangle that should be repainted
  * @param right Right edge of the rectangle that should be repainted
  * @param bottom Bottom edge of the rectangle that should be repainted
  * @param flags Whether to mark gfx dirty, etc.
  */
-void DrawOverlappedWindow(Window *w, int left, int top, int right, int bottom, DrawOverlappedWindowFlags flags)
+static void DrawOverlappedWindowFrom(Window *w, WindowBase *start, int left, int top, int right, int bottom, DrawOverlappedWindowFlags flags)
 {
-	for (const Window *v : Window::IterateFromBack(w->z_front)) {
+	for (Window *v : Window::IterateFromBack(start)) {
 		if (MayBeShown(v) &&
 				right > v->left &&
 				bottom > v->top &&
@@ -910,26 +955,26 @@ void DrawOverlappedWindow(Window *w, int left, int top, int right, int bottom, D
 			int x;
 
 			if (left < (x = v->left)) {
-				DrawOverlappedWindow(w, left, top, x, bottom, flags);
-				DrawOverlappedWindow(w, x, top, right, bottom, flags);
+				DrawOverlappedWindowFrom(w, v, left, top, x, bottom, flags);
+				DrawOverlappedWindowFrom(w, v, x, top, right, bottom, flags);
 				return;
 			}
 
 			if (right > (x = v->left + v->width)) {
-				DrawOverlappedWindow(w, left, top, x, bottom, flags);
-				DrawOverlappedWindow(w, x, top, right, bottom, flags);
+				DrawOverlappedWindowFrom(w, v, left, top, x, bottom, flags);
+				DrawOverlappedWindowFrom(w, v, x, top, right, bottom, flags);
 				return;
 			}
 
 			if (top < (x = v->top)) {
-				DrawOverlappedWindow(w, left, top, right, x, flags);
-				DrawOverlappedWindow(w, left, x, right, bottom, flags);
+				DrawOverlappedWindowFrom(w, v, left, top, right, x, flags);
+				DrawOverlappedWindowFrom(w, v, left, x, right, bottom, flags);
 				return;
 			}
 
 			if (bottom > (x = v->top + v->height)) {
-				DrawOverlappedWindow(w, left, top, right, x, flags);
-				DrawOverlappedWindow(w, left, x, right, bottom, flags);
+				DrawOverlappedWindowFrom(w, v, left, top, right, x, flags);
+				DrawOverlappedWindowFrom(w, v, left, x, right, bottom, flags);
 				return;
 			}
 
@@ -957,6 +1002,21 @@ void DrawOverlappedWindow(Window *w, int left, int top, int right, int bottom, D
 	}
 }
 
+/**
+ * Generate repaint events for the visible part of window w within the rectangle.
+ * @param w Window that needs to be repainted
+ * @param left Left edge of the rectangle that should be repainted
+ * @param top Top edge of the rectangle that should be repainted
+ * @param right Right edge of the rectangle that should be repainted
+ * @param bottom Bottom edge of the rectangle that should be repainted
+ * @param flags Whether to mark gfx dirty, etc.
+ * @see DrawOverlappedWindowFrom
+ */
+void DrawOverlappedWindow(Window *w, int left, int top, int right, int bottom, DrawOverlappedWindowFlags flags)
+{
+	DrawOverlappedWindowFrom(w, w->z_front, left, top, right, bottom, flags);
+}
+
 /**
  * From a rectangle that needs redrawing, find the windows that intersect with the rectangle.
  * These windows should be re-painted.
@@ -1157,6 +1217,8 @@ Window::~Window()
  */
 Window *FindWindowById(WindowClass cls, WindowNumber number)
 {
+	if (!MayHaveWindowOfClass(cls)) return nullptr;
+
 	for (Window *w : Window::IterateFromBack()) {
 		if (w->window_class == cls && w->window_number == number) return w;
 	}
@@ -1172,6 +1234,8 @@ Window *FindWindowById(WindowClass cls, WindowNumber number)
  */
 Window *FindWindowByClass(WindowClass cls)
 {
+	if (!MayHaveWindowOfClass(cls)) return nullptr;
+
 	for (Window *w : Window::IterateFromBack()) {
 		if (w->window_class == cls) return w;
 	}
@@ -1525,6 +1589,7 @@ void Window::InitializeData(WindowNumber window_number)
 
 	/* Insert the window into the correct location in the z-ordering. */
 	AddWindowToZOrdering(this);
+	CountOpenWindow(this);
 	this->next_window = _first_window;
 	_first_window = this;
 }
@@ -1882,6 +1947,17 @@ void Window::FinishInitNested(WindowNumber window_number)
 	this->FindWindowPlacementAndResize(this->window_desc->GetDefaultWidth(), this->window_desc->GetDefaultHeight());
 }
 
+/**
+ * Change the class of an initialised window, which differs from the class of its window description.
+ * @param cls New window class
+ */
+void Window::ChangeWindowClass(WindowClass cls)
+{
+	UncountOpenWindow(this);
+	this->window_class = cls;
+	CountOpenWindow(this);
+}
+
 /**
  * Perform complete initialization of the #Window with nested widgets, to allow use.
  * @param window_number Number of the new window.
@@ -1959,6 +2035,7 @@ void UnInitWindowSystem()
 	_z_front_window = nullptr;
 	_z_back_window = nullptr;
 	_first_window = nullptr;
+	_open_window_class_count.fill(0);
 }
 
 /**
@@ -3190,6 +3267,7 @@ void InputLoop()
 		if (w->window_class != WC_INVALID) continue;
 
 		RemoveWindowFromZOrdering(w);
+		UncountOpenWindow(w);
 		free(w);
 		reset_window_nexts = true;
 	}
@@ -3309,6 +3387,8 @@ void UpdateWindows()
  */
 void SetWindowDirty(WindowClass cls, WindowNumber number)
 {
+	if (!MayHaveWindowOfClass(cls)) return;
+
 	for (Window *w : Window::IterateFromBack()) {
 		if (w->window_class == cls && w->window_number == number) w->SetDirty();
 	}
@@ -3322,6 +3402,8 @@ void SetWindowDirty(WindowClass cls, WindowNumber number)
  */
 void SetWindowWidgetDirty(WindowClass cls, WindowNumber number, byte widget_index)
 {
+	if (!MayHaveWindowOfClass(cls)) return;
+
 	for (Window *w : Window::IterateFromBack()) {
 		if (w->window_class == cls && w->window_number == number) {
 			w->SetWidgetDirty(widget_index);
@@ -3335,6 +3417,8 @@ void SetWindowWidgetDirty(WindowClass cls, WindowNumber number, byte widget_inde
  */
 void SetWindowClassesDirty(WindowClass cls)
 {
+	if (!MayHaveWindowOfClass(cls)) return;
+
 	for (Window *w : Window::IterateFromBack()) {
 		if (w->window_class == cls) w->SetDirty();
 	}
@@ -3409,6 +3493,8 @@ void Window::ProcessHighlightedInvalidations()
  */
 void InvalidateWindowData(WindowClass cls, WindowNumber number, int data, bool gui_scope)
 {
+	if (!MayHaveWindowOfClass(cls)) return;
+
 	for (Window *w : Window::IterateFromBack()) {
 		if (w->window_class == cls && w->window_number == number) {
 			w->InvalidateData(data, gui_scope);
@@ -3426,6 +3512,8 @@ void InvalidateWindowData(WindowClass cls, WindowNumber number, int data, bool g
  */
 void InvalidateWindowClassesData(WindowClass cls, int data, bool gui_scope)
 {
+	if (!MayHaveWindowOfClass(cls)) return;
+
 	for (Window *w : Window::IterateFromBack()) {
 		if (w->window_class == cls) {
 			w->InvalidateData(data, gui_scope);
@@ -3438,6 +3526,8 @@ void InvalidateWindowClassesData(WindowClass cls, int data, bool gui_scope)
  */
 void CallWindowGameTickEvent()
 {
+	TRACE_ZONE("CallWindowGameTickEvent");
+
 	for (Window *w : Window::IterateFromFront()) {
 		w->OnGameTick();
 	}
@@ -303,6 +303,7 @@ struct WindowBase {
 	WindowBase *z_back;              ///< The window behind us in z-order.
 	WindowBase *next_window;         ///< The next window in arbitrary iteration order.
 	WindowClass window_class;        ///< Window class
+	WindowClass counted_class;       ///< Window class under which the window is counted in #_open_window_class_count, until it is freed.
 
 	virtual ~WindowBase() {}
 
@@ -424,6 +425,7 @@ public:
 	void InitNested(WindowNumber number = 0);
 	void CreateNestedTree(bool fill_nested = true);
 	void FinishInitNested(WindowNumber window_number = 0);
+	void ChangeWindowClass(WindowClass cls);
 
 	/**
 	 * Set the timeout flag of the window and initiate the timer.
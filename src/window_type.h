@@ -779,6 +779,7 @@ enum WindowClass {
 	 */
 	WC_MODIFIER_KEY_TOGGLE,
 
+	WC_END,              ///< End of valid window classes.
 	WC_INVALID = 0xFFFF, ///< Invalid window.
 };
 
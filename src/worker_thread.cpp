@@ -0,0 +1,172 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file worker_thread.cpp Worker thread pool for data-parallel work. */
+
+#include "stdafx.h"
+#include "worker_thread.h"
+#include "thread.h"
+
+#include <algorithm>
+
+#include "safeguards.h"
+
+uint8 _config_worker_threads = 0;  ///< Configured number of worker threads, 0 = automatic.
+WorkerThreadPool _general_worker_pool;
+
+/** Maximum number of worker threads which will be started in automatic mode. */
+static const uint MAX_AUTO_WORKER_THREADS = 8;
+
+WorkerThreadPool::~WorkerThreadPool()
+{
+	this->Stop();
+}
+
+uint WorkerThreadPool::GetParallelism()
+{
+#ifdef NO_THREADS
+	return 1;
+#else
+	uint threads = _config_worker_threads;
+	if (threads == 0) {
+		uint hw = std::thread::hardware_concurrency();
+		threads = std::min<uint>(std::max<uint>(hw, 1), MAX_AUTO_WORKER_THREADS);
+	}
+	return threads;
+#endif
+}
+
+/**
+ * Start worker threads to match the configured parallelism.
+ * Threads are only ever started here, surplus threads are left idle until Stop().
+ * This may be called from several threads at once, e.g. the main thread and link graph threads.
+ * @return Number of worker threads which may be used, not including the calling thread.
+ */
+uint WorkerThreadPool::EnsureThreads()
+{
+	uint wanted = this->GetParallelism() - 1;
+
+	std::lock_guard<std::mutex> guard(this->lock);
+	this->target_threads = wanted;
+	if (this->threads.size() >= wanted) return wanted;
+
+	this->exit = false;
+	while (this->threads.size() < wanted) {
+		std::thread t;
+		if (!StartNewThread(&t, "ottd:worker", &WorkerThreadPool::Run, this)) {
+			this->target_threads = (uint)this->threads.size();
+			break;
+		}
+		this->threads.push_back(std::move(t));
+	}
+	return this->target_threads;
+}
+
+/**
+ * Process chunks of a batch until none are left.
+ * @param batch Batch to process.
+ * @return true if any chunk was processed by this call.
+ */
+bool WorkerThreadPool::ProcessBatch(Batch *batch)
+{
+	bool did_work = false;
+	while (true) {
+		size_t start = batch->next.fetch_add(batch->grain, std::memory_order_relaxed);
+		if (start >= batch->end) break;
+		(*batch->func)(start, std::min(start + batch->grain, batch->end));
+		did_work = true;
+	}
+	return did_work;
+}
+
+void WorkerThreadPool::Run(WorkerThreadPool *pool)
+{
+	std::unique_lock<std::mutex> lk(pool->lock);
+	while (true) {
+		pool->work_cv.wait(lk, [&]() { return pool->exit || !pool->pending.empty(); });
+		if (pool->pending.empty()) return;
+
+		Batch *batch = pool->pending.front();
+		pool->pending.pop_front();
+		lk.unlock();
+		ProcessBatch(batch);
+		lk.lock();
+		batch->outstanding--;
+		if (batch->outstanding == 0) pool->done_cv.notify_all();
+	}
+}
+
+/**
+ * Call func over the range [0, count), split into chunks of at most grain items.
+ * The calling thread also processes chunks, and this does not return until all chunks are done.
+ * func is called with (start, end) for each chunk, chunks may be processed concurrently and in any order.
+ * @param count Number of items.
+ * @param grain Maximum number of items per chunk.
+ * @param func Function to call for each chunk.
+ */
+void WorkerThreadPool::ParallelFor(size_t count, size_t grain, const RangeFunc &func)
+{
+	if (count == 0) return;
+	grain = std::max<size_t>(grain, 1);
+
+	if (count <= grain) {
+		func(0, count);
+		return;
+	}
+
+	uint available = this->EnsureThreads();
+	uint helpers = std::min<size_t>(available, ((count + grain - 1) / grain) - 1);
+	if (helpers == 0) {
+		func(0, count);
+		return;
+	}
+
+	Batch batch;
+	batch.func = &func;
+	batch.next.store(0, std::memory_order_relaxed);
+	batch.end = count;
+	batch.grain = grain;
+	batch.outstanding = helpers;
+
+	{
+		std::lock_guard<std::mutex> guard(this->lock);
+		for (uint i = 0; i < helpers; i++) {
+			this->pending.push_back(&batch);
+		}
+	}
+	if (helpers == 1) {
+		this->work_cv.notify_one();
+	} else {
+		this->work_cv.notify_all();
+	}
+
+	ProcessBatch(&batch);
+
+	std::unique_lock<std::mutex> lk(this->lock);
+	/* Withdraw any helper jobs which were not picked up by a worker in the meantime, there is nothing left for them to do */
+	auto removed_start = std::remove(this->pending.begin(), this->pending.end(), &batch);
+	batch.outstanding -= (uint)std::distance(removed_start, this->pending.end());
+	this->pending.erase(removed_start, this->pending.end());
+	this->done_cv.wait(lk, [&]() { return batch.outstanding == 0; });
+}
+
+/**
+ * Stop and join all worker threads.
+ */
+void WorkerThreadPool::Stop()
+{
+	{
+		std::lock_guard<std::mutex> guard(this->lock);
+		this->exit = true;
+	}
+	this->work_cv.notify_all();
+	for (std::thread &t : this->threads) {
+		if (t.joinable()) t.join();
+	}
+	this->threads.clear();
+	this->target_threads = 0;
+}
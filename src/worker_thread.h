@@ -0,0 +1,68 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file worker_thread.h Worker thread pool for data-parallel work. */
+
+#ifndef WORKER_THREAD_H
+#define WORKER_THREAD_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+extern uint8 _config_worker_threads;
+
+/**
+ * Pool of worker threads, used to split up work which can be performed independently per item.
+ * Work submitted via ParallelFor must only modify state which is private to each item, the ordering of
+ * execution between items is unspecified. Any shared state changes must be collected and applied
+ * by the caller afterwards, in a fixed order, to keep the game state deterministic.
+ * ParallelFor may be called from several threads at the same time, but not from within a work item.
+ */
+class WorkerThreadPool {
+	using RangeFunc = std::function<void(size_t, size_t)>;
+
+	struct Batch {
+		const RangeFunc *func;
+		std::atomic<size_t> next;
+		size_t end;
+		size_t grain;
+		uint outstanding; ///< Number of jobs of this batch which have not yet finished, guarded by lock.
+	};
+
+	std::vector<std::thread> threads;
+	std::mutex lock;
+	std::condition_variable work_cv;
+	std::condition_variable done_cv;
+	std::deque<Batch *> pending;
+	uint target_threads = 0; ///< Number of worker threads which may be used, guarded by lock.
+	bool exit = false;
+
+	static void Run(WorkerThreadPool *pool);
+	static bool ProcessBatch(Batch *batch);
+	uint EnsureThreads();
+
+public:
+	~WorkerThreadPool();
+
+	/**
+	 * Get the number of threads which ParallelFor may use, including the calling thread.
+	 * @return Degree of parallelism.
+	 */
+	uint GetParallelism();
+
+	void ParallelFor(size_t count, size_t grain, const RangeFunc &func);
+	void Stop();
+};
+
+extern WorkerThreadPool _general_worker_pool;
+
+#endif /* WORKER_THREAD_H */
@@ -28,13 +28,85 @@
 #include "road_map.h"
 #include "debug_settings.h"
 #include "animated_tile.h"
-#include "3rdparty/cpp-btree/btree_set.h"
+
+#include <unordered_map>
 
 Zoning _zoning;
 static const SpriteID ZONING_INVALID_SPRITE_ID = UINT_MAX;
 
-static btree::btree_set<uint32> _zoning_cache_inner;
-static btree::btree_set<uint32> _zoning_cache_outer;
+/**
+ * Cache of the evaluation of a zoning mode, in square regions of tiles.
+ * Regions are created when first drawn and stay valid until the stations around them change,
+ * so redrawing a static map does not evaluate any tiles.
+ */
+struct ZoningCache {
+	static const uint REGION_SHIFT = 4;                   ///< Log2 of the width and height of a region in tiles.
+	static const uint REGION_SIZE = 1 << REGION_SHIFT;    ///< Width and height of a region in tiles.
+	static const uint8 NOT_CACHED = 0xFF;                 ///< Value of a tile which has not been evaluated.
+
+	/** Evaluations of the tiles of a region. */
+	struct Region {
+		uint8 values[REGION_SIZE * REGION_SIZE];
+
+		Region() { memset(this->values, NOT_CACHED, sizeof(this->values)); }
+	};
+
+	std::unordered_map<uint32, Region> regions; ///< Regions by RegionKey, references stay valid on insertion.
+	uint32 last_key = UINT32_MAX;               ///< Key of the most recently used region, tiles are usually drawn in runs.
+	Region *last_region = nullptr;              ///< The most recently used region.
+
+	static uint32 RegionKey(uint x, uint y) { return ((y >> REGION_SHIFT) << 16) | (x >> REGION_SHIFT); }
+	static uint RegionOffset(uint x, uint y) { return ((y & (REGION_SIZE - 1)) << REGION_SHIFT) | (x & (REGION_SIZE - 1)); }
+
+	/**
+	 * Get the cached value of a tile, the region is created if necessary.
+	 * @param tile The tile.
+	 * @return Reference to the value, #NOT_CACHED if the tile has not been evaluated.
+	 */
+	uint8 &Get(TileIndex tile)
+	{
+		const uint x = TileX(tile);
+		const uint y = TileY(tile);
+		const uint32 key = RegionKey(x, y);
+		if (key != this->last_key) {
+			this->last_key = key;
+			this->last_region = &this->regions[key];
+		}
+		return this->last_region->values[RegionOffset(x, y)];
+	}
+
+	/**
+	 * Invalidate the tiles within a rectangle.
+	 * @param rect The rectangle, in tile coordinates.
+	 */
+	void Invalidate(const Rect &rect)
+	{
+		for (uint ry = rect.top >> REGION_SHIFT; ry <= (uint)rect.bottom >> REGION_SHIFT; ry++) {
+			for (uint rx = rect.left >> REGION_SHIFT; rx <= (uint)rect.right >> REGION_SHIFT; rx++) {
+				auto iter = this->regions.find((ry << 16) | rx);
+				if (iter == this->regions.end()) continue;
+
+				const uint left = std::max<uint>(rect.left, rx << REGION_SHIFT);
+				const uint right = std::min<uint>(rect.right, ((rx + 1) << REGION_SHIFT) - 1);
+				const uint top = std::max<uint>(rect.top, ry << REGION_SHIFT);
+				const uint bottom = std::min<uint>(rect.bottom, ((ry + 1) << REGION_SHIFT) - 1);
+				for (uint y = top; y <= bottom; y++) {
+					memset(iter->second.values + RegionOffset(left, y), NOT_CACHED, right - left + 1);
+				}
+			}
+		}
+	}
+
+	void Clear()
+	{
+		this->regions.clear();
+		this->last_key = UINT32_MAX;
+		this->last_region = nullptr;
+	}
+};
+
+static ZoningCache _zoning_cache_inner;
+static ZoningCache _zoning_cache_outer;
 
 /**
  * Draw the zoning sprites.
@@ -377,31 +449,27 @@ inline SpriteID TileZoningSpriteEvaluationCached(TileIndex tile, Owner owner, Zo
 	if (ev_mode == ZEM_IND_UNSER && !IsTileType(tile, MP_INDUSTRY)) return ZONING_INVALID_SPRITE_ID;
 	if (ev_mode >= ZEM_STA_CATCH && ev_mode <= ZEM_IND_UNSER) {
 		// cacheable
-		btree::btree_set<uint32> &cache = is_inner ? _zoning_cache_inner : _zoning_cache_outer;
-		auto iter = cache.lower_bound(tile << 3);
-		if (iter != cache.end() && *iter >> 3 == tile) {
-			switch (*iter & 7) {
-				case 0: return ZONING_INVALID_SPRITE_ID;
-				case 1: return SPR_ZONING_INNER_HIGHLIGHT_RED;
-				case 2: return SPR_ZONING_INNER_HIGHLIGHT_ORANGE;
-				case 3: return SPR_ZONING_INNER_HIGHLIGHT_BLACK;
-				case 4: return SPR_ZONING_INNER_HIGHLIGHT_LIGHT_BLUE;
-				default: NOT_REACHED();
-			}
-		} else {
-			SpriteID s = TileZoningSpriteEvaluation(tile, owner, ev_mode);
-			uint val = tile << 3;
-			switch (s) {
-				case ZONING_INVALID_SPRITE_ID:              val |= 0; break;
-				case SPR_ZONING_INNER_HIGHLIGHT_RED:        val |= 1; break;
-				case SPR_ZONING_INNER_HIGHLIGHT_ORANGE:     val |= 2; break;
-				case SPR_ZONING_INNER_HIGHLIGHT_BLACK:      val |= 3; break;
-				case SPR_ZONING_INNER_HIGHLIGHT_LIGHT_BLUE: val |= 4; break;
-				default: NOT_REACHED();
-			}
-			cache.insert(iter, val);
-			return s;
+		uint8 &val = (is_inner ? _zoning_cache_inner : _zoning_cache_outer).Get(tile);
+		switch (val) {
+			case 0: return ZONING_INVALID_SPRITE_ID;
+			case 1: return SPR_ZONING_INNER_HIGHLIGHT_RED;
+			case 2: return SPR_ZONING_INNER_HIGHLIGHT_ORANGE;
+			case 3: return SPR_ZONING_INNER_HIGHLIGHT_BLACK;
+			case 4: return SPR_ZONING_INNER_HIGHLIGHT_LIGHT_BLUE;
+			case ZoningCache::NOT_CACHED: break;
+			default: NOT_REACHED();
+		}
+
+		SpriteID s = TileZoningSpriteEvaluation(tile, owner, ev_mode);
+		switch (s) {
+			case ZONING_INVALID_SPRITE_ID:              val = 0; break;
+			case SPR_ZONING_INNER_HIGHLIGHT_RED:        val = 1; break;
+			case SPR_ZONING_INNER_HIGHLIGHT_ORANGE:     val = 2; break;
+			case SPR_ZONING_INNER_HIGHLIGHT_BLACK:      val = 3; break;
+			case SPR_ZONING_INNER_HIGHLIGHT_LIGHT_BLUE: val = 4; break;
+			default: NOT_REACHED();
 		}
+		return s;
 	} else {
 		return TileZoningSpriteEvaluation(tile, owner, ev_mode);
 	}
@@ -488,17 +556,8 @@ void ZoningMarkDirtyStationCoverageArea(const Station *st, ZoningModeMask mask)
 				MarkTileDirtyByTile(TileXY(x, y), VMDF_NOT_MAP_MODE);
 			}
 		}
-		auto invalidate_cache_rect = [&](btree::btree_set<uint32> &cache) {
-			for (int y = rect.top; y <= rect.bottom; y++) {
-				auto iter = cache.lower_bound(TileXY(rect.left, y) << 3);
-				auto end_iter = iter;
-				uint end = (TileXY(rect.right, y) + 1) << 3;
-				while (end_iter != cache.end() && *end_iter < end) ++end_iter;
-				cache.erase(iter, end_iter);
-			}
-		};
-		if (outer_radius) invalidate_cache_rect(_zoning_cache_outer);
-		if (inner_radius) invalidate_cache_rect(_zoning_cache_inner);
+		if (outer_radius) _zoning_cache_outer.Invalidate(rect);
+		if (inner_radius) _zoning_cache_inner.Invalidate(rect);
 	}
 }
 
@@ -522,19 +581,19 @@ void ZoningTownAuthorityRatingChange()
 
 void ClearZoningCaches()
 {
-	_zoning_cache_inner.clear();
-	_zoning_cache_outer.clear();
+	_zoning_cache_inner.Clear();
+	_zoning_cache_outer.Clear();
 }
 
 void SetZoningMode(bool inner, ZoningEvaluationMode mode)
 {
 	ZoningEvaluationMode &current_mode = inner ? _zoning.inner : _zoning.outer;
-	btree::btree_set<uint32> &cache = inner ? _zoning_cache_inner : _zoning_cache_outer;
+	ZoningCache &cache = inner ? _zoning_cache_inner : _zoning_cache_outer;
 
 	if (current_mode == mode) return;
 
 	current_mode = mode;
-	cache.clear();
+	cache.Clear();
 	MarkWholeNonMapViewportsDirty();
 	PostZoningModeChange();
 }